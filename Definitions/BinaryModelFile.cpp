@@ -0,0 +1,504 @@
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <DirectXPackedVector.h>
+#include "BinaryModelFile.h"
+#include "MemoryMappedFile.h"
+#include "ModelData.h"
+
+#ifdef RJ_MODULE_RJ
+#	include "../RJ/Logging.h"
+#endif
+
+const char BinaryModelFile::FILE_IDENTIFIER[8] = { 'R', 'j', 'G', 'e', 'o', 'B', 'i', 'n' };
+
+
+// Serializes one or more meshes, along with the LOD chain of each, into a single binary model file.  Mesh data can optionally
+// be compressed, at the cost of quantising vertex attributes and of expanding the data on load
+ByteString BinaryModelFile::Serialize(const std::vector<const ModelData*> & input_models, bool include_checksums, bool compress)
+{
+	static_assert(sizeof(INDEX_BUFFER_TYPE) == sizeof(uint32_t), "Index compression requires 32-bit index data");
+
+	// Each mesh is immediately followed by its LOD meshes
+	std::vector<const ModelData*> models;
+	std::vector<uint16_t> lod_levels;
+	for (const ModelData *model : input_models)
+	{
+		models.push_back(model);
+		lod_levels.push_back(0U);
+		for (size_t i = 0U; i < model->Lods.size(); ++i)
+		{
+			if (!model->Lods[i]) continue;
+			models.push_back(model->Lods[i].get());
+			lod_levels.push_back((uint16_t)(lod_levels.back() + 1U));
+		}
+	}
+
+	// Determine the layout of the file before writing any data
+	uint32_t mesh_count = (uint32_t)models.size();
+	uint64_t offset = Align(sizeof(FileHeader) + (sizeof(MeshEntry) * mesh_count));
+
+	// Source of the data written for each mesh.  Compressed data is encoded up front so that the size of each block is known
+	struct MeshData { const void *Vertices; uint64_t VertexBytes; const void *Indices; uint64_t IndexBytes; };
+	std::vector<MeshData> mesh_data(mesh_count);
+	std::vector<std::vector<uint8_t>> compressed_vertices(compress ? mesh_count : 0U), compressed_indices(compress ? mesh_count : 0U);
+
+	std::vector<MeshEntry> table(mesh_count);
+	for (uint32_t i = 0U; i < mesh_count; ++i)
+	{
+		const ModelData *m = models[i];
+		MeshEntry & entry = table[i];
+		memset(&entry, 0, sizeof(MeshEntry));
+
+		entry.ModelMaterialIndex = m->ModelMaterialIndex;
+		entry.LodLevel = lod_levels[i];
+		entry.LodError = (uint16_t)((std::min)((std::max)(m->LodError, 0.0f), 1.0f) * (float)LOD_ERROR_SCALE + 0.5f);
+		entry.VertexCount = (m->VertexData ? m->VertexCount : 0U);
+		entry.IndexCount = (m->IndexData ? m->IndexCount : 0U);
+		entry.VertexStride = sizeof(ModelData::TVertex);
+		entry.IndexStride = sizeof(INDEX_BUFFER_TYPE);
+		entry.MinBounds = m->SizeProperties.MinBounds;
+		entry.MaxBounds = m->SizeProperties.MaxBounds;
+		entry.ModelSize = m->SizeProperties.ModelSize;
+		entry.CentrePoint = m->SizeProperties.CentrePoint;
+
+		MeshData & mesh = mesh_data[i];
+		mesh = { m->VertexData, ((uint64_t)entry.VertexCount * entry.VertexStride), m->IndexData, ((uint64_t)entry.IndexCount * entry.IndexStride) };
+
+		if (compress)
+		{
+			CompressedMeshHeader mesh_header;
+			memset(&mesh_header, 0, sizeof(CompressedMeshHeader));
+			CompressIndices(m->IndexData, entry.IndexCount, compressed_indices[i]);
+			mesh_header.IndexDataSize = (uint32_t)compressed_indices[i].size();
+
+			std::vector<uint8_t> & vertices = compressed_vertices[i];
+			vertices.resize(sizeof(CompressedMeshHeader) + (sizeof(CompressedVertex) * entry.VertexCount));
+			CompressVertices(m, mesh_header, (CompressedVertex *)&(vertices[sizeof(CompressedMeshHeader)]));
+			memcpy(vertices.data(), &mesh_header, sizeof(CompressedMeshHeader));
+
+			entry.VertexStride = sizeof(CompressedVertex);
+			entry.IndexStride = 0U;
+			mesh = { vertices.data(), vertices.size(), compressed_indices[i].data(), compressed_indices[i].size() };
+		}
+
+		entry.VertexDataOffset = offset;
+		offset = Align(offset + mesh.VertexBytes);
+		entry.IndexDataOffset = offset;
+		offset = Align(offset + mesh.IndexBytes);
+
+		if (include_checksums)
+		{
+			entry.VertexChecksum = Checksum(mesh.Vertices, (size_t)mesh.VertexBytes);
+			entry.IndexChecksum = Checksum(mesh.Indices, (size_t)mesh.IndexBytes);
+		}
+	}
+
+	// Populate the file header
+	FileHeader header;
+	memset(&header, 0, sizeof(FileHeader));
+	memcpy(header.Identifier, FILE_IDENTIFIER, sizeof(FILE_IDENTIFIER));
+	header.Version = CURRENT_VERSION;
+	header.HeaderSize = sizeof(FileHeader);
+	header.Flags = ((include_checksums ? FileFlags::HasChecksums : FileFlags::None) | (compress ? FileFlags::CompressedData : FileFlags::None));
+	header.MeshCount = mesh_count;
+	header.MeshTableOffset = sizeof(FileHeader);
+	header.FileSize = offset;
+	header.MeshTableChecksum = (include_checksums ? Checksum(table.data(), sizeof(MeshEntry) * mesh_count) : 0U);
+
+	// Write all data directly into a buffer of the final size; padding is left zeroed
+	ByteString b;
+	b.resize((size_t)offset, 0);
+	memcpy(&(b[0]), &header, sizeof(FileHeader));
+	if (mesh_count != 0U) memcpy(&(b[(size_t)header.MeshTableOffset]), table.data(), sizeof(MeshEntry) * mesh_count);
+
+	for (uint32_t i = 0U; i < mesh_count; ++i)
+	{
+		const MeshEntry & entry = table[i];
+		const MeshData & mesh = mesh_data[i];
+		if (mesh.VertexBytes != 0U) memcpy(&(b[(size_t)entry.VertexDataOffset]), mesh.Vertices, (size_t)mesh.VertexBytes);
+		if (mesh.IndexBytes != 0U) memcpy(&(b[(size_t)entry.IndexDataOffset]), mesh.Indices, (size_t)mesh.IndexBytes);
+	}
+
+	return b;
+}
+
+// Tests whether the given data begins with a binary model file header
+bool BinaryModelFile::IsBinaryModelData(const void *data, size_t size)
+{
+	return (data != NULL && size >= sizeof(FileHeader) && memcmp(data, FILE_IDENTIFIER, sizeof(FILE_IDENTIFIER)) == 0);
+}
+
+// Loads every mesh from a mapped file.  Vertex and index data are referenced in place within the mapping, which will
+// remain open for as long as any of the returned models exist.  Returns no models if the file is invalid
+std::vector<std::unique_ptr<ModelData>> BinaryModelFile::Load(const std::shared_ptr<MemoryMappedFile> & file, bool verify_checksums)
+{
+	if (!file) return std::vector<std::unique_ptr<ModelData>>();
+
+	return Parse(file->GetData(), file->GetSize(), verify_checksums, file);
+}
+
+// Maps and loads every mesh from the given file
+std::vector<std::unique_ptr<ModelData>> BinaryModelFile::Load(const std::string & filename, bool verify_checksums)
+{
+	std::shared_ptr<MemoryMappedFile> file = MemoryMappedFile::Open(filename);
+	if (!file)
+	{
+#		ifdef LOGGING_AVAILABLE
+			Game::Log << LOG_ERROR << "Could not map binary model file \"" << filename << "\"\n";
+#		endif
+		return std::vector<std::unique_ptr<ModelData>>();
+	}
+
+	return Load(file, verify_checksums);
+}
+
+// Loads every mesh from data in memory.  Vertex and index data are copied, since the source data is not owned
+std::vector<std::unique_ptr<ModelData>> BinaryModelFile::Load(const void *data, size_t size, bool verify_checksums)
+{
+	return Parse((const char *)data, size, verify_checksums, NULL);
+}
+
+// Validates the file structure and populates a model for each mesh.  Data is referenced within 'storage' if it is
+// provided, or otherwise copied
+std::vector<std::unique_ptr<ModelData>> BinaryModelFile::Parse(const char *data, size_t size, bool verify_checksums, const std::shared_ptr<MemoryMappedFile> & storage)
+{
+	std::vector<std::unique_ptr<ModelData>> models;
+
+	if (!IsBinaryModelData(data, size))
+	{
+#		ifdef LOGGING_AVAILABLE
+			Game::Log << LOG_ERROR << "Binary model data is invalid, cannot process further\n";
+#		endif
+		return models;
+	}
+
+	// Validate the header.  Later versions may extend the header, but must retain the layout of this version
+	FileHeader header;
+	memcpy(&header, data, sizeof(FileHeader));
+	if (header.Version > CURRENT_VERSION || header.HeaderSize < sizeof(FileHeader) || header.FileSize > size ||
+		header.MeshCount > MESH_COUNT_LIMIT || header.MeshTableOffset < header.HeaderSize ||
+		(header.MeshTableOffset + ((uint64_t)header.MeshCount * sizeof(MeshEntry))) > header.FileSize)
+	{
+#		ifdef LOGGING_AVAILABLE
+			Game::Log << LOG_ERROR << "Binary model data has an invalid or unsupported header (v" << header.Version << ", " << header.MeshCount << " meshes, "
+				<< header.FileSize << "/" << size << " bytes), cannot process further\n";
+#		endif
+		return models;
+	}
+
+	// Compressed data is only supported from version 3, and is always expanded rather than referenced in place
+	bool compressed = ((header.Flags & FileFlags::CompressedData) != 0);
+	if (compressed && header.Version < 3U)
+	{
+#		ifdef LOGGING_AVAILABLE
+			Game::Log << LOG_ERROR << "Binary model data (v" << header.Version << ") does not support compressed data, cannot process further\n";
+#		endif
+		return models;
+	}
+
+	bool verify = (verify_checksums && (header.Flags & FileFlags::HasChecksums) != 0);
+	const MeshEntry *table = (const MeshEntry *)&(data[header.MeshTableOffset]);
+	if (verify && Checksum(table, sizeof(MeshEntry) * header.MeshCount) != header.MeshTableChecksum)
+	{
+#		ifdef LOGGING_AVAILABLE
+			Game::Log << LOG_ERROR << "Binary model data mesh table failed checksum verification, cannot process further\n";
+#		endif
+		return models;
+	}
+
+	// Validate every mesh before any data is referenced, so that a partially-loaded model is never returned
+	uint16_t previous_lod = 0U;
+	for (uint32_t i = 0U; i < header.MeshCount; ++i)
+	{
+		MeshEntry entry;
+		memcpy(&entry, &(table[i]), sizeof(MeshEntry));
+
+		// LOD fields were reserved prior to version 2.  Each LOD must directly follow the previous level of the same mesh
+		if (header.Version < 2U) entry.LodLevel = entry.LodError = 0U;
+		if (entry.LodLevel != 0U && (i == 0U || entry.LodLevel != (previous_lod + 1U)))
+		{
+#			ifdef LOGGING_AVAILABLE
+				Game::Log << LOG_ERROR << "Binary model data mesh " << i << " has an invalid LOD level (" << entry.LodLevel << "), cannot process further\n";
+#			endif
+			return models;
+		}
+		previous_lod = entry.LodLevel;
+
+		uint64_t vertex_bytes = ((uint64_t)entry.VertexCount * entry.VertexStride) + (compressed ? sizeof(CompressedMeshHeader) : 0U);
+		uint64_t index_bytes = (uint64_t)entry.IndexCount * entry.IndexStride;
+
+		bool valid = (entry.VertexStride == (compressed ? sizeof(CompressedVertex) : sizeof(ModelData::TVertex)) &&
+					  entry.IndexStride == (compressed ? 0U : sizeof(INDEX_BUFFER_TYPE)) &&
+					  entry.VertexCount <= ModelData::VERTEX_COUNT_LIMIT && entry.IndexCount <= ModelData::INDEX_COUNT_LIMIT &&
+					  (entry.VertexDataOffset % DATA_ALIGNMENT) == 0U && (entry.IndexDataOffset % DATA_ALIGNMENT) == 0U &&
+					  entry.VertexDataOffset <= header.FileSize && vertex_bytes <= (header.FileSize - entry.VertexDataOffset));
+
+		// The size of compressed index data is held in the header preceding the vertex data
+		if (valid && compressed)
+		{
+			CompressedMeshHeader mesh_header;
+			memcpy(&mesh_header, &(data[entry.VertexDataOffset]), sizeof(CompressedMeshHeader));
+			index_bytes = mesh_header.IndexDataSize;
+		}
+
+		if (!valid || entry.IndexDataOffset > header.FileSize || index_bytes > (header.FileSize - entry.IndexDataOffset))
+		{
+#			ifdef LOGGING_AVAILABLE
+				Game::Log << LOG_ERROR << "Binary model data mesh " << i << " has an invalid layout, cannot process further\n";
+#			endif
+			return models;
+		}
+
+		if (verify && (Checksum(&(data[entry.VertexDataOffset]), (size_t)vertex_bytes) != entry.VertexChecksum ||
+					   Checksum(&(data[entry.IndexDataOffset]), (size_t)index_bytes) != entry.IndexChecksum))
+		{
+#			ifdef LOGGING_AVAILABLE
+				Game::Log << LOG_ERROR << "Binary model data mesh " << i << " failed checksum verification, cannot process further\n";
+#			endif
+			return models;
+		}
+	}
+
+	// The file is valid, so populate a model for each mesh
+	models.reserve(header.MeshCount);
+	for (uint32_t i = 0U; i < header.MeshCount; ++i)
+	{
+		MeshEntry entry;
+		memcpy(&entry, &(table[i]), sizeof(MeshEntry));
+		if (header.Version < 2U) entry.LodLevel = entry.LodError = 0U;
+
+		std::unique_ptr<ModelData> m = std::make_unique<ModelData>();
+		m->ModelMaterialIndex = entry.ModelMaterialIndex;
+		m->LodError = ((float)entry.LodError / (float)LOD_ERROR_SCALE);
+		m->SizeProperties.MinBounds = entry.MinBounds;
+		m->SizeProperties.MaxBounds = entry.MaxBounds;
+		m->SizeProperties.ModelSize = entry.ModelSize;
+		m->SizeProperties.CentrePoint = entry.CentrePoint;
+
+		if (compressed)
+		{
+			// Compressed data is expanded into newly-allocated storage
+			CompressedMeshHeader mesh_header;
+			memcpy(&mesh_header, &(data[entry.VertexDataOffset]), sizeof(CompressedMeshHeader));
+
+			if (!m->AllocateVertexData(entry.VertexCount) || !m->AllocateIndexData(entry.IndexCount) ||
+				!DecompressIndices((const uint8_t *)&(data[entry.IndexDataOffset]), mesh_header.IndexDataSize, entry.IndexCount, m->IndexData))
+			{
+#				ifdef LOGGING_AVAILABLE
+					Game::Log << LOG_ERROR << "Binary model data mesh " << i << " could not be decompressed, cannot process further\n";
+#				endif
+				models.clear();
+				return models;
+			}
+
+			m->VertexCount = entry.VertexCount;
+			m->IndexCount = entry.IndexCount;
+			DecompressVertices(mesh_header, (const CompressedVertex *)&(data[entry.VertexDataOffset + sizeof(CompressedMeshHeader)]), entry.VertexCount, m.get());
+		}
+		else if (storage)
+		{
+			// Reference data in place; the mapping is copy-on-write so the model remains free to modify its own data
+			char *base = storage->GetData();
+			m->AssignExternalData(storage,
+				(entry.VertexCount != 0U ? (ModelData::TVertex *)&(base[entry.VertexDataOffset]) : NULL), entry.VertexCount,
+				(entry.IndexCount != 0U ? (INDEX_BUFFER_TYPE *)&(base[entry.IndexDataOffset]) : NULL), entry.IndexCount);
+		}
+		else
+		{
+			// Source data is not owned, so allocate and copy each block in bulk
+			if (!m->AllocateVertexData(entry.VertexCount) || !m->AllocateIndexData(entry.IndexCount))
+			{
+				models.clear();
+				return models;
+			}
+
+			m->VertexCount = entry.VertexCount;
+			m->IndexCount = entry.IndexCount;
+			if (entry.VertexCount != 0U) memcpy(m->VertexData, &(data[entry.VertexDataOffset]), sizeof(ModelData::TVertex) * entry.VertexCount);
+			if (entry.IndexCount != 0U) memcpy(m->IndexData, &(data[entry.IndexDataOffset]), sizeof(INDEX_BUFFER_TYPE) * entry.IndexCount);
+		}
+
+		// LOD meshes are attached to the full-detail mesh which precedes them
+		if (entry.LodLevel != 0U)	models.back()->Lods.push_back(std::move(m));
+		else						models.push_back(std::move(m));
+	}
+
+	return models;
+}
+
+// Vertex compression.  Positions are quantised over the bounds of the vertex data, which are recorded in the header
+void BinaryModelFile::CompressVertices(const ModelData *model, CompressedMeshHeader & header, CompressedVertex *out_vertices)
+{
+	unsigned int count = (model->VertexData ? model->VertexCount : 0U);
+
+	// Quantisation bounds are taken from the vertex data itself, since model size properties are not guaranteed to be current
+	XMFLOAT3 min_bounds = (count != 0U ? model->VertexData[0].position : XMFLOAT3(0.0f, 0.0f, 0.0f));
+	XMFLOAT3 max_bounds = min_bounds;
+	for (unsigned int i = 1U; i < count; ++i)
+	{
+		const XMFLOAT3 & p = model->VertexData[i].position;
+		min_bounds = XMFLOAT3((std::min)(min_bounds.x, p.x), (std::min)(min_bounds.y, p.y), (std::min)(min_bounds.z, p.z));
+		max_bounds = XMFLOAT3((std::max)(max_bounds.x, p.x), (std::max)(max_bounds.y, p.y), (std::max)(max_bounds.z, p.z));
+	}
+
+	header.PositionMin = min_bounds;
+	header.PositionExtent = XMFLOAT3(max_bounds.x - min_bounds.x, max_bounds.y - min_bounds.y, max_bounds.z - min_bounds.z);
+
+	const float min[3] = { min_bounds.x, min_bounds.y, min_bounds.z };
+	const float extent[3] = { header.PositionExtent.x, header.PositionExtent.y, header.PositionExtent.z };
+	for (unsigned int i = 0U; i < count; ++i)
+	{
+		const ModelData::TVertex & v = model->VertexData[i];
+		CompressedVertex & out = out_vertices[i];
+		memset(&out, 0, sizeof(CompressedVertex));
+
+		const float p[3] = { v.position.x, v.position.y, v.position.z };
+		for (int k = 0; k < 3; ++k)
+		{
+			float t = (extent[k] > 0.0f ? ((p[k] - min[k]) / extent[k]) : 0.0f);
+			out.Position[k] = (uint16_t)((std::min)((std::max)(t, 0.0f), 1.0f) * 65535.0f + 0.5f);
+		}
+
+		OctahedralEncode(v.normal, out.Normal);
+		OctahedralEncode(v.tangent, out.Tangent);
+		OctahedralEncode(v.binormal, out.Binormal);
+		out.Tex[0] = PackedVector::XMConvertFloatToHalf(v.tex.x);
+		out.Tex[1] = PackedVector::XMConvertFloatToHalf(v.tex.y);
+	}
+}
+
+// Expands compressed vertices into the full-precision vertex data of the given model
+void BinaryModelFile::DecompressVertices(const CompressedMeshHeader & header, const CompressedVertex *vertices, uint32_t count, ModelData *model)
+{
+	const float scale[3] = { header.PositionExtent.x / 65535.0f, header.PositionExtent.y / 65535.0f, header.PositionExtent.z / 65535.0f };
+	for (uint32_t i = 0U; i < count; ++i)
+	{
+		CompressedVertex v;
+		memcpy(&v, &(vertices[i]), sizeof(CompressedVertex));
+		ModelData::TVertex & out = model->VertexData[i];
+
+		out.position = XMFLOAT3(header.PositionMin.x + (v.Position[0] * scale[0]), header.PositionMin.y + (v.Position[1] * scale[1]),
+								header.PositionMin.z + (v.Position[2] * scale[2]));
+		out.normal = OctahedralDecode(v.Normal);
+		out.tangent = OctahedralDecode(v.Tangent);
+		out.binormal = OctahedralDecode(v.Binormal);
+		out.tex = XMFLOAT2(PackedVector::XMConvertHalfToFloat(v.Tex[0]), PackedVector::XMConvertHalfToFloat(v.Tex[1]));
+	}
+}
+
+// Index compression.  Each index is stored as the zigzag-encoded delta from the previous index, in a little-endian base-128
+// varint.  Cache- and fetch-optimised index data typically requires one or two bytes per index
+void BinaryModelFile::CompressIndices(const uint32_t *indices, uint32_t count, std::vector<uint8_t> & out_data)
+{
+	out_data.clear();
+	if (!indices) return;
+
+	out_data.reserve(count * 2U);
+	int64_t previous = 0;
+	for (uint32_t i = 0U; i < count; ++i)
+	{
+		int64_t delta = ((int64_t)indices[i] - previous);
+		uint64_t value = (((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63));
+		previous = (int64_t)indices[i];
+
+		do
+		{
+			uint8_t byte = (uint8_t)(value & 0x7FU);
+			value >>= 7;
+			out_data.push_back(value != 0U ? (uint8_t)(byte | 0x80U) : byte);
+		} while (value != 0U);
+	}
+}
+
+// Decodes delta-encoded indices.  Fails if the data does not contain exactly the expected number of indices
+bool BinaryModelFile::DecompressIndices(const uint8_t *data, size_t size, uint32_t count, uint32_t *out_indices)
+{
+	size_t position = 0U;
+	int64_t previous = 0;
+	for (uint32_t i = 0U; i < count; ++i)
+	{
+		uint64_t value = 0U;
+		for (unsigned int shift = 0U; ; shift += 7U)
+		{
+			if (position >= size || shift > 35U) return false;
+			uint8_t byte = data[position++];
+			value |= ((uint64_t)(byte & 0x7FU) << shift);
+			if ((byte & 0x80U) == 0U) break;
+		}
+
+		int64_t index = previous + ((int64_t)(value >> 1) ^ -(int64_t)(value & 1U));
+		if (index < 0 || index > (int64_t)UINT32_MAX) return false;
+
+		out_indices[i] = (uint32_t)index;
+		previous = index;
+	}
+
+	return (position == size);
+}
+
+// Octahedral encoding of unit vectors into two snorm16 components, based on "A Survey of Efficient Representations for Independent
+// Unit Vectors" (Cigolle et al., 2014).  Zero vectors, e.g. where no tangent data is present, are preserved using a reserved value
+void BinaryModelFile::OctahedralEncode(const XMFLOAT3 & v, int16_t out[2])
+{
+	float l1 = (std::fabs(v.x) + std::fabs(v.y) + std::fabs(v.z));
+	if (l1 <= 1e-12f)
+	{
+		out[0] = out[1] = ZERO_VECTOR_ENCODING;
+		return;
+	}
+
+	float x = (v.x / l1), y = (v.y / l1);
+	if (v.z < 0.0f)
+	{
+		float fx = x, fy = y;
+		x = (1.0f - std::fabs(fy)) * (fx >= 0.0f ? 1.0f : -1.0f);
+		y = (1.0f - std::fabs(fx)) * (fy >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	out[0] = (int16_t)std::lround((std::min)((std::max)(x, -1.0f), 1.0f) * 32767.0f);
+	out[1] = (int16_t)std::lround((std::min)((std::max)(y, -1.0f), 1.0f) * 32767.0f);
+}
+
+// Decodes an octahedral-encoded unit vector
+XMFLOAT3 BinaryModelFile::OctahedralDecode(const int16_t v[2])
+{
+	if (v[0] == ZERO_VECTOR_ENCODING && v[1] == ZERO_VECTOR_ENCODING) return XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+	float x = (std::max)(v[0] / 32767.0f, -1.0f), y = (std::max)(v[1] / 32767.0f, -1.0f);
+	float z = (1.0f - std::fabs(x) - std::fabs(y));
+	float t = (std::max)(-z, 0.0f);
+	x += (x >= 0.0f ? -t : t);
+	y += (y >= 0.0f ? -t : t);
+
+	float length = std::sqrt((x * x) + (y * y) + (z * z));
+	return XMFLOAT3(x / length, y / length, z / length);
+}
+
+// CRC-32 checksum of the given data
+uint32_t BinaryModelFile::Checksum(const void *data, size_t size)
+{
+	// Lookup table for the standard reflected polynomial, generated on first use
+	static const struct CrcTable
+	{
+		uint32_t values[256];
+		CrcTable(void)
+		{
+			for (uint32_t i = 0U; i < 256U; ++i)
+			{
+				uint32_t c = i;
+				for (int k = 0; k < 8; ++k) c = ((c & 1U) ? (0xEDB88320U ^ (c >> 1)) : (c >> 1));
+				values[i] = c;
+			}
+		}
+	} table;
+
+	const unsigned char *p = (const unsigned char *)data;
+	uint32_t crc = 0xFFFFFFFFU;
+	for (size_t i = 0U; i < size; ++i)
+	{
+		crc = table.values[(crc ^ p[i]) & 0xFFU] ^ (crc >> 8);
+	}
+
+	return (crc ^ 0xFFFFFFFFU);
+}
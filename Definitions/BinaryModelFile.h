@@ -0,0 +1,148 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <DirectXMath.h>
+#include "../Definitions/ByteString.h"
+class ModelData;
+class MemoryMappedFile;
+using namespace DirectX;
+
+
+// Versioned binary model format.  Files consist of a fixed header, a table with one entry per mesh, and then the vertex
+// and index data for each mesh.  Every data block is aligned so that it can be used in place once the file is mapped
+// into memory, with no per-element processing.  Checksums of the mesh table and each data block are optional
+//
+//   [ FileHeader ][ MeshEntry x MeshCount ][ pad ][ Vertices 0 ][ pad ][ Indices 0 ][ pad ] ... [ Indices N-1 ]
+//
+// From version 2, the level-of-detail chain of a mesh immediately follows it in the mesh table, with LodLevel 1..N.  LOD 
+// meshes are attached to their full-detail mesh on loading rather than returned as separate meshes
+//
+// From version 3, files may instead hold compressed mesh data (FileFlags::CompressedData).  Each vertex block then begins with 
+// a CompressedMeshHeader followed by one CompressedVertex per vertex, and each index block holds delta-encoded indices.  
+// Compressed data is expanded to the full-precision formats on loading, so cannot be referenced in place
+//
+//   [ CompressedMeshHeader ][ CompressedVertex x VertexCount ] ... [ Index deltas; zigzag varint, IndexDataSize bytes ]
+//
+class BinaryModelFile
+{
+public:
+
+	static const char					FILE_IDENTIFIER[8];
+	static const uint32_t				CURRENT_VERSION = 3U;
+	static const uint32_t				DATA_ALIGNMENT = 16U;
+	static const uint32_t				MESH_COUNT_LIMIT = 4096U;
+	static const uint32_t				LOD_ERROR_SCALE = 0xFFFFU;		// LOD error is quantised over [0.0 1.0]
+
+	enum FileFlags
+	{
+		None = 0,
+		HasChecksums = (1 << 0),
+		CompressedData = (1 << 1)
+	};
+
+	struct FileHeader
+	{
+		char							Identifier[8];
+		uint32_t						Version;
+		uint32_t						HeaderSize;				// Allows later versions to extend the header while remaining readable
+		uint32_t						Flags;
+		uint32_t						MeshCount;
+		uint64_t						MeshTableOffset;
+		uint64_t						FileSize;				// Expected file size, so that truncated files can be rejected
+		uint32_t						MeshTableChecksum;
+		uint32_t						Reserved[5];
+	};
+
+	struct MeshEntry
+	{
+		uint32_t						ModelMaterialIndex;
+		uint32_t						VertexCount;
+		uint32_t						IndexCount;
+		uint32_t						VertexStride;			// Must match the size of ModelData::TVertex, or CompressedVertex if compressed
+		uint32_t						IndexStride;			// Must match the size of INDEX_BUFFER_TYPE, or zero if compressed
+		uint32_t						VertexChecksum;
+		uint32_t						IndexChecksum;
+		uint16_t						LodLevel;				// Zero for a full-detail mesh; always zero prior to version 2
+		uint16_t						LodError;				// Quantised ModelData::LodError, over LOD_ERROR_SCALE
+		uint64_t						VertexDataOffset;
+		uint64_t						IndexDataOffset;
+		XMFLOAT3						MinBounds;
+		XMFLOAT3						MaxBounds;
+		XMFLOAT3						ModelSize;
+		XMFLOAT3						CentrePoint;
+	};
+
+	// Precedes the vertex data of each mesh in a compressed file
+	struct CompressedMeshHeader
+	{
+		XMFLOAT3						PositionMin;			// Positions are quantised over [PositionMin, PositionMin + PositionExtent]
+		XMFLOAT3						PositionExtent;
+		uint32_t						IndexDataSize;			// Size of the encoded index block in bytes
+		uint32_t						Reserved;
+	};
+
+	// Compressed equivalent of ModelData::TVertex
+	struct CompressedVertex
+	{
+		uint16_t						Position[3];			// Unorm16 within the mesh quantisation bounds
+		int16_t							Normal[2];				// Octahedral-encoded snorm16 unit vectors; a zero vector is held as 
+		int16_t							Tangent[2];				// ZERO_VECTOR_ENCODING in both components
+		int16_t							Binormal[2];
+		uint16_t						Tex[2];					// Half-precision float
+		uint16_t						Padding;
+	};
+
+	static const int16_t				ZERO_VECTOR_ENCODING = -32768;
+
+public:
+
+	// Serializes one or more meshes, along with the LOD chain of each, into a single binary model file.  Mesh data can optionally
+	// be compressed, at the cost of quantising vertex attributes and of expanding the data on load
+	static ByteString									Serialize(const std::vector<const ModelData*> & models, bool include_checksums = true, bool compress = false);
+
+	// Tests whether the given data begins with a binary model file header
+	static bool											IsBinaryModelData(const void *data, size_t size);
+
+	// Loads every mesh from a mapped file.  Vertex and index data are referenced in place within the mapping, which will
+	// remain open for as long as any of the returned models exist.  Returns no models if the file is invalid
+	static std::vector<std::unique_ptr<ModelData>>		Load(const std::shared_ptr<MemoryMappedFile> & file, bool verify_checksums);
+
+	// Maps and loads every mesh from the given file
+	static std::vector<std::unique_ptr<ModelData>>		Load(const std::string & filename, bool verify_checksums);
+
+	// Loads every mesh from data in memory.  Vertex and index data are copied, since the source data is not owned
+	static std::vector<std::unique_ptr<ModelData>>		Load(const void *data, size_t size, bool verify_checksums);
+
+	// CRC-32 checksum of the given data
+	static uint32_t										Checksum(const void *data, size_t size);
+
+private:
+
+	// Validates the file structure and populates a model for each mesh.  Data is referenced within 'storage' if it is
+	// provided, or otherwise copied
+	static std::vector<std::unique_ptr<ModelData>>		Parse(const char *data, size_t size, bool verify_checksums, const std::shared_ptr<MemoryMappedFile> & storage);
+
+	static inline uint64_t								Align(uint64_t offset)		{ return ((offset + (DATA_ALIGNMENT - 1U)) & ~(uint64_t)(DATA_ALIGNMENT - 1U)); }
+
+	// Vertex compression.  Positions are quantised over the bounds of the vertex data, which are recorded in the header
+	static void											CompressVertices(const ModelData *model, CompressedMeshHeader & header, CompressedVertex *out_vertices);
+	static void											DecompressVertices(const CompressedMeshHeader & header, const CompressedVertex *vertices, uint32_t count, ModelData *model);
+
+	// Index compression.  Each index is stored as the zigzag-encoded delta from the previous index, in a little-endian base-128
+	// varint.  Decompression fails if the data does not contain exactly the expected number of indices
+	static void											CompressIndices(const uint32_t *indices, uint32_t count, std::vector<uint8_t> & out_data);
+	static bool											DecompressIndices(const uint8_t *data, size_t size, uint32_t count, uint32_t *out_indices);
+
+	// Octahedral encoding of unit vectors into two snorm16 components
+	static void											OctahedralEncode(const XMFLOAT3 & v, int16_t out[2]);
+	static XMFLOAT3										OctahedralDecode(const int16_t v[2]);
+
+};
+
+static_assert(sizeof(BinaryModelFile::FileHeader) == 64U, "Binary model file header layout must not change without a version change");
+static_assert(sizeof(BinaryModelFile::MeshEntry) == 96U, "Binary model mesh entry layout must not change without a version change");
+static_assert(sizeof(BinaryModelFile::CompressedMeshHeader) == 32U, "Binary model compressed mesh header layout must not change without a version change");
+static_assert(sizeof(BinaryModelFile::CompressedVertex) == 24U, "Binary model compressed vertex layout must not change without a version change");
@@ -48,6 +48,16 @@ public:
 	template <typename T>
 	void					ReadObject(T & object);
 
+	// Read a block of bytes from the current read buffer pointer.  Returns false, with no data read, if insufficient data remains
+	inline bool				ReadBytes(void *dest, size_t count)
+	{
+		if ((m_readpoint + count) > size()) return false;
+
+		memcpy(dest, (const void*)&(data()[m_readpoint]), count);
+		m_readpoint += count;
+		return true;
+	}
+
 
 	// Attempt to read a file identifier from the byte string and validate it against the given required value
 	inline bool				ReadAndVerifyIdentifier(const std::string & expected)
@@ -0,0 +1,92 @@
+#include "MemoryMappedFile.h"
+
+#ifdef _WIN32
+#	ifndef WIN32_LEAN_AND_MEAN
+#		define WIN32_LEAN_AND_MEAN
+#	endif
+#	include <Windows.h>
+#else
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#endif
+
+
+MemoryMappedFile::MemoryMappedFile(void)
+	:
+	m_data(NULL),
+	m_size(0U)
+#ifdef _WIN32
+	, m_file(INVALID_HANDLE_VALUE),
+	m_mapping(NULL)
+#endif
+{
+}
+
+std::shared_ptr<MemoryMappedFile> MemoryMappedFile::Open(const std::string & filename)
+{
+	std::shared_ptr<MemoryMappedFile> file(new MemoryMappedFile());
+
+#ifdef _WIN32
+
+	file->m_file = ::CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (file->m_file == INVALID_HANDLE_VALUE) return NULL;
+
+	LARGE_INTEGER size;
+	if (!::GetFileSizeEx(file->m_file, &size) || size.QuadPart <= 0) return NULL;
+	file->m_size = (size_t)size.QuadPart;
+
+	// Copy-on-write protection allows the data to be modified in place without affecting the file itself
+	file->m_mapping = ::CreateFileMappingA(file->m_file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	if (!file->m_mapping) return NULL;
+
+	file->m_data = (char *)::MapViewOfFile(file->m_mapping, FILE_MAP_COPY, 0, 0, 0);
+	if (!file->m_data) return NULL;
+
+#else
+
+	int fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0) return NULL;
+
+	struct stat st;
+	if (::fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return NULL; }
+	file->m_size = (size_t)st.st_size;
+
+	// Private mapping allows the data to be modified in place without affecting the file itself
+	void *data = ::mmap(NULL, file->m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED) return NULL;
+
+	file->m_data = (char *)data;
+
+#endif
+
+	return file;
+}
+
+void MemoryMappedFile::Close(void)
+{
+#ifdef _WIN32
+
+	if (m_data) ::UnmapViewOfFile(m_data);
+	if (m_mapping) ::CloseHandle(m_mapping);
+	if (m_file != INVALID_HANDLE_VALUE) ::CloseHandle(m_file);
+
+	m_mapping = NULL;
+	m_file = INVALID_HANDLE_VALUE;
+
+#else
+
+	if (m_data) ::munmap(m_data, m_size);
+
+#endif
+
+	m_data = NULL;
+	m_size = 0U;
+}
+
+MemoryMappedFile::~MemoryMappedFile(void)
+{
+	Close();
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <string>
+#include <memory>
+
+
+// File mapped directly into the address space of the process.  Pages are only loaded by the OS when first accessed, so
+// opening a file costs little more than the page faults for the data that is actually used.  The mapping is copy-on-write;
+// any modified pages become private to the process and are never written back to the file
+class MemoryMappedFile
+{
+public:
+
+	// Maps the given file, returning NULL if it cannot be opened or is empty
+	static std::shared_ptr<MemoryMappedFile>	Open(const std::string & filename);
+
+	inline const char *							GetData(void) const				{ return m_data; }
+	inline char *								GetData(void)					{ return m_data; }
+	inline size_t								GetSize(void) const				{ return m_size; }
+
+	~MemoryMappedFile(void);
+
+private:
+
+	MemoryMappedFile(void);
+	MemoryMappedFile(const MemoryMappedFile & other) = delete;
+	MemoryMappedFile & operator=(const MemoryMappedFile & other) = delete;
+
+	void										Close(void);
+
+private:
+
+	char *										m_data;
+	size_t										m_size;
+
+#ifdef _WIN32
+	void *										m_file;				// Held as void* to avoid exposing windows.h via this header
+	void *										m_mapping;
+#endif
+
+};
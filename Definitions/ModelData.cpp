@@ -1,5 +1,6 @@
 #include <sstream>
 #include "ModelData.h"
+#include "BinaryModelFile.h"
 
 #ifdef RJ_MODULE_RJ
 #	include "../RJ/Logging.h"
@@ -13,7 +14,11 @@ ModelData::ModelData(void)
 	VertexData(NULL),
 	IndexData(NULL), 
 	VertexCount(0U),
-	ModelMaterialIndex(0U)
+	IndexCount(0U),
+	ModelMaterialIndex(0U),
+	LodError(0.0f), 
+	m_external_vertex_data(false),
+	m_external_index_data(false)
 {
 }
 
@@ -44,9 +49,12 @@ void ModelData::DeallocateVertexData(void)
 {
 	if (VertexData)
 	{
-		delete[] VertexData;
+		if (!m_external_vertex_data) delete[] VertexData;
 		VertexData = NULL;
 	}
+
+	m_external_vertex_data = false;
+	if (!m_external_index_data) m_external_storage.reset();
 }
 
 bool ModelData::AllocateIndexData(unsigned int index_count)
@@ -70,42 +78,49 @@ void ModelData::DeallocateIndexData(void)
 {
 	if (IndexData)
 	{
-		delete[] IndexData;
+		if (!m_external_index_data) delete[] IndexData;
 		IndexData = NULL;
 	}
+
+	m_external_index_data = false;
+	if (!m_external_vertex_data) m_external_storage.reset();
 }
 
-ByteString ModelData::Serialize(void) const
+void ModelData::AssignExternalData(std::shared_ptr<void> storage, TVertex *vertex_data, unsigned int vertex_count, INDEX_BUFFER_TYPE *index_data, unsigned int index_count)
 {
-	// Header data
-	ByteString b;
-	b.WriteString(ModelData::GEOMETRY_FILE_IDENTIFIER);
-	b.WriteObject(this->ModelMaterialIndex);
-	b.WriteObject(this->SizeProperties.MinBounds);
-	b.WriteObject(this->SizeProperties.MaxBounds);
-	b.WriteObject(this->SizeProperties.ModelSize);
-	b.WriteObject(this->SizeProperties.CentrePoint);
-	b.WriteObject(this->VertexCount);
-	b.WriteObject(this->IndexCount);
-
-	// Vertex data
-	for (unsigned int i = 0U; i < VertexCount; ++i)
-	{
-		b.WriteObject(VertexData[i]);
-	}
+	DeallocateVertexData();
+	DeallocateIndexData();
 
-	// Index data
-	for (unsigned int i = 0U; i < IndexCount; ++i)
-	{
-		b.WriteObject(IndexData[i]);
-	}
+	m_external_storage = storage;
+	VertexData = vertex_data;
+	VertexCount = vertex_count;
+	IndexData = index_data;
+	IndexCount = index_count;
+	m_external_vertex_data = m_external_index_data = true;
+}
 
-	return b;
+ByteString ModelData::Serialize(bool compress) const
+{
+	// Models are always written in the binary model format, optionally with compressed mesh data; see BinaryModelFile.h
+	return BinaryModelFile::Serialize({ this }, true, compress);
 }
 
 std::unique_ptr<ModelData> ModelData::Deserialize(ByteString & data)
 {
-	// Start reading from buffer start and make sure file identifier is present
+	// Binary model data can be loaded directly.  Where data is already held in memory the vertex and index blocks are 
+	// copied in bulk; use BinaryModelFile::Load on a mapped file to reference the data in place instead
+	if (BinaryModelFile::IsBinaryModelData(data.data(), data.size()))
+	{
+		auto models = BinaryModelFile::Load(data.data(), data.size(), true);
+		if (models.empty()) return NULL;
+
+#		ifdef LOGGING_AVAILABLE
+			if (models.size() > 1U) Game::Log << LOG_WARN << "Model data contains " << models.size() << " meshes; only the first will be deserialized\n";
+#		endif
+		return std::move(models[0]);
+	}
+
+	// Otherwise this should be data in the legacy format.  Start reading from buffer start and make sure file identifier is present
 	data.ResetRead();
 	if (!data.ReadAndVerifyIdentifier(ModelData::GEOMETRY_FILE_IDENTIFIER))
 	{
@@ -132,10 +147,11 @@ std::unique_ptr<ModelData> ModelData::Deserialize(ByteString & data)
 		return NULL;
 	}
 	
-	// Vertex data
-	for (unsigned int i = 0U; i < m->VertexCount; ++i)
+	// Vertex data is read as a single block
+	if (!data.ReadBytes(m->VertexData, sizeof(TVertex) * m->VertexCount))
 	{
-		data.ReadObject(m->VertexData[i]);
+		delete(m);
+		return NULL;
 	}
 
 	// Attempt to allocate index data
@@ -145,13 +161,13 @@ std::unique_ptr<ModelData> ModelData::Deserialize(ByteString & data)
 		return NULL;
 	}
 
-	// Index data
-	for (unsigned int i = 0U; i < m->IndexCount; ++i)
+	// Index data is read as a single block
+	if (!data.ReadBytes(m->IndexData, sizeof(INDEX_BUFFER_TYPE) * m->IndexCount))
 	{
-		data.ReadObject(m->IndexData[i]);
+		delete(m);
+		return NULL;
 	}
 
-
 	return std::unique_ptr<ModelData>(m);
 }
 
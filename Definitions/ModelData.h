@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>	
+#include <vector>
 #include <DirectXMath.h>
 #include "../Definitions/ByteString.h"
 #include "ModelSizeProperties.h"
@@ -31,6 +32,13 @@ public:
 	// Index data; structured to map directly into the trianglelist primitive topology (i.e. face -> { v1, v2, v3})
 	INDEX_BUFFER_TYPE *					IndexData;				// Will always be IndexCount elements of type INDEX_BUFFER_TYPE
 
+	// Simplified level-of-detail meshes derived from this model, in order of decreasing detail.  Each is an independent mesh
+	std::vector<std::unique_ptr<ModelData>>	Lods;
+
+	// Maximum geometric error of this mesh relative to its full-detail source, as a proportion of the source bounding radius.
+	// Zero for full-detail meshes
+	float								LodError;
+
 	std::string							str(void) const;
 
 public:
@@ -38,9 +46,15 @@ public:
 	ModelData(void);
 	~ModelData(void);
 
-	ByteString							Serialize(void) const;
+	ByteString							Serialize(bool compress = false) const;
 	static std::unique_ptr<ModelData>	Deserialize(ByteString & data);
 
+	// Reference vertex and index data held in external storage, for example a mapped model file, rather than allocating
+	// and copying it.  The storage is retained until the data is deallocated or replaced
+	void								AssignExternalData(std::shared_ptr<void> storage, TVertex *vertex_data, unsigned int vertex_count, 
+														   INDEX_BUFFER_TYPE *index_data, unsigned int index_count);
+	inline bool							HasExternalData(void) const { return (m_external_storage.get() != NULL); }
+
 	bool								AllocateVertexData(unsigned int vertex_count);
 	void								DeallocateVertexData(void);
 
@@ -55,5 +69,9 @@ public:
 
 private:
 
+	// External storage referenced by the vertex and/or index data, if applicable
+	std::shared_ptr<void>				m_external_storage;
+	bool								m_external_vertex_data;
+	bool								m_external_index_data;
 
 };
\ No newline at end of file
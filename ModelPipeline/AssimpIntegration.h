@@ -4,6 +4,7 @@
 #include <DirectXMath.h>
 #include "../Definitions/ModelData.h"
 #include "CustomPostProcess.h"
+#include "PipelineLog.h"
 
 #include <assimp\Importer.hpp>
 #include <assimp\scene.h>
@@ -26,9 +27,9 @@ private:
 	static XMFLOAT3							GetFloat3(const aiVector3D & vector);
 	
 
-#	define MODEL_INST_INFO(msg)				{ std::cout << "Info [Model instantiation]: " << msg << "\n"; }
-#	define MODEL_INST_DEBUG(msg)			{ if (debug_info) { std::cout << "Debug [Model instantiation]: " << msg << "\n"; } }
-#	define MODEL_INST_ERROR(msg)			{ std::cerr << "Error [Model instantiation]: " << msg << "\n"; return {}; }
-#	define MODEL_INST_PER_MESH_ERROR(msg)	{ std::cerr << "Error [Model instantiation]: " << msg << "\n"; continue; }
+#	define MODEL_INST_INFO(msg)				{ PipelineLog::Info() << "Info [Model instantiation]: " << msg << "\n"; }
+#	define MODEL_INST_DEBUG(msg)			{ if (debug_info) { PipelineLog::Info() << "Debug [Model instantiation]: " << msg << "\n"; } }
+#	define MODEL_INST_ERROR(msg)			{ PipelineLog::Error() << "Error [Model instantiation]: " << msg << "\n"; return {}; }
+#	define MODEL_INST_PER_MESH_ERROR(msg)	{ PipelineLog::Error() << "Error [Model instantiation]: " << msg << "\n"; continue; }
 
 };
\ No newline at end of file
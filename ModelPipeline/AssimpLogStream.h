@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <assimp\LogStream.hpp>
+#include "PipelineLog.h"
 
 
 class AssimpLogStream : public Assimp::LogStream
@@ -14,7 +15,7 @@ public:
 	// Stream method to retrieve internal Assimp logging data
 	inline void write(const char *message)
 	{
-		std::cout << "Transform [Assimp]: " << message << "\n";
+		PipelineLog::Info() << "Transform [Assimp]: " << message << "\n";
 	}
 
 };
\ No newline at end of file
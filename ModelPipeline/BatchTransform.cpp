@@ -0,0 +1,188 @@
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include "PipelineUtil.h"
+#include "PipelineLog.h"
+#include "BatchTransform.h"
+
+
+// Constructor.  A thread count of zero will use one thread per hardware thread
+BatchTransform::BatchTransform(unsigned int thread_count)
+	:
+	m_thread_count(thread_count),
+	m_duration(0.0)
+{
+	if (m_thread_count == 0U) m_thread_count = std::max(1U, std::thread::hardware_concurrency());
+}
+
+// Transforms every input file, returning once all are complete
+TransformResult BatchTransform::Execute(const std::vector<std::string> & input, const FileTransform & transform)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	size_t count = input.size();
+	m_results = std::vector<FileResult>(count);
+	for (size_t i = 0U; i < count; ++i) m_results[i].Input = input[i];
+
+	unsigned int threads = (unsigned int)std::min((size_t)m_thread_count, count);
+	PipelineLog::Info() << "Performing batch transformation of " << count << " files across " << threads << " threads\n";
+
+	// Files are claimed in order by each worker as it becomes available; the calling thread also acts as a worker
+	std::atomic<size_t> next(0U);
+	auto worker = [&](void)
+	{
+		for (size_t i = next++; i < count; i = next++)
+		{
+			ExecuteFile(i, count, transform);
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned int i = 1U; i < threads; ++i) workers.emplace_back(worker);
+	worker();
+	for (auto & thread : workers) thread.join();
+
+	m_duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// Aggregate results in input order
+	TransformResult result;
+	for (const auto & file : m_results) result.Add(file.Success);
+	return result;
+}
+
+void BatchTransform::ExecuteFile(size_t index, size_t count, const FileTransform & transform)
+{
+	FileResult & result = m_results[index];
+	auto start = std::chrono::steady_clock::now();
+
+	PipelineLog::BeginCapture();
+	PipelineLog::Info() << "\nProcessing file " << (index + 1U) << " of " << count << " (" << fs::absolute(result.Input).string() << ")\n";
+
+	try
+	{
+		result.Success = transform(result.Input, result.Metadata, result.UpToDate);
+	}
+	catch (const std::exception & ex)
+	{
+		PipelineLog::Error() << "Error: Unhandled exception during transformation (" << ex.what() << ")\n";
+		result.Success = false;
+	}
+
+	std::string output = PipelineLog::EndCapture(result.Errors);
+	PipelineLog::Write(output);
+
+	result.Duration = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Generates a summary of the batch results, optionally including model metadata for each file
+std::string BatchTransform::GenerateSummary(bool include_metadata) const
+{
+	TransformResult result;
+	unsigned int up_to_date = 0U;
+	double total_file_time = 0.0;
+	for (const auto & file : m_results)
+	{
+		result.Add(file.Success);
+		if (file.UpToDate) ++up_to_date;
+		total_file_time += file.Duration;
+	}
+
+	std::ostringstream ss;
+	ss << std::fixed << std::setprecision(3);
+	ss << "Batch summary: " << result.Total() << " Total, " << result.Success << " Success, " << result.Failure << " Failed, " << up_to_date << " Up to date\n";
+	ss << "Completed in " << m_duration << "s using " << m_thread_count << " threads (" << total_file_time << "s total transform time)\n";
+
+	// Report every failure along with the errors that it generated
+	if (result.Failure != 0U)
+	{
+		ss << "\nFailures:\n";
+		for (const auto & file : m_results)
+		{
+			if (file.Success) continue;
+
+			ss << "  " << file.Input << "\n";
+			std::vector<std::string> errors;
+			PipelineUtil::SplitString(file.Errors, '\n', true, errors);
+			for (const auto & error : errors) ss << "      " << error << "\n";
+		}
+	}
+
+	if (include_metadata)
+	{
+		ss << "\nModel metadata:\n";
+		for (const auto & file : m_results)
+		{
+			ss << "  " << file.Input << " [" << (file.Success ? (file.UpToDate ? "UP TO DATE" : "OK") : "FAILED") << ", " << file.Duration << "s]";
+			if (file.Metadata.HasData())
+			{
+				ss << " size = " << FLOAT3_STR(file.Metadata.ModelSize) << ", centre = " << FLOAT3_STR(file.Metadata.CentrePoint)
+				   << ", bounds = " << FLOAT3_STR(file.Metadata.MinBounds) << " to " << FLOAT3_STR(file.Metadata.MaxBounds);
+			}
+			ss << "\n";
+		}
+	}
+
+	return ss.str();
+}
+
+// Reads a manifest of input files, one per line.  Empty lines and lines beginning with '#' are ignored.  Relative
+// paths are resolved against the directory of the manifest
+std::vector<std::string> BatchTransform::ReadManifest(fs::path manifest)
+{
+	std::vector<std::string> files;
+	if (!fs::exists(manifest))
+	{
+		PipelineLog::Error() << "Cannot read batch manifest \"" << fs::absolute(manifest).string() << "\"; file does not exist\n";
+		return files;
+	}
+
+	std::ifstream in(manifest);
+	fs::path base = fs::absolute(manifest).parent_path();
+	std::string line;
+	while (std::getline(in, line))
+	{
+		// Trim whitespace and any quotes surrounding the path
+		auto start = line.find_first_not_of(" \t\r\"");
+		if (start == std::string::npos) continue;
+		auto end = line.find_last_not_of(" \t\r\"");
+		line = line.substr(start, end - start + 1U);
+		if (line[0] == '#') continue;
+
+		fs::path file(line);
+		files.push_back((file.is_absolute() ? file : (base / file)).string());
+	}
+
+	PipelineLog::Info() << "Loaded " << files.size() << " input files from batch manifest \"" << fs::absolute(manifest).string() << "\"\n";
+	return files;
+}
+
+// Returns all files within the directory hierarchy with the given extension, e.g. ".obj"
+std::vector<std::string> BatchTransform::FindInputFiles(fs::path directory, const std::string & extension)
+{
+	std::vector<std::string> files;
+	if (!fs::is_directory(directory))
+	{
+		PipelineLog::Error() << "Cannot locate batch input directory \"" << fs::absolute(directory).string() << "\"\n";
+		return files;
+	}
+
+	for (auto & entry : fs::recursive_directory_iterator(directory, fs::directory_options::follow_directory_symlink))
+	{
+		const fs::path & file = entry.path();
+		if (fs::is_directory(file)) continue;
+		if (file.has_extension() && file.extension().string() == extension)
+		{
+			files.push_back(fs::absolute(file).string());
+		}
+	}
+
+	// Sort for a deterministic processing order and summary
+	std::sort(files.begin(), files.end());
+
+	PipelineLog::Info() << "Found " << files.size() << " \"" << extension << "\" input files in \"" << fs::absolute(directory).string() << "\"\n";
+	return files;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <filesystem>
+#include "../Definitions/ModelSizeProperties.h"
+#include "TransformResult.h"
+namespace fs = std::filesystem;
+
+
+// Executes a transform independently for each file in a batch, distributing files across a set of worker threads.  Each
+// transform must construct its own pipeline, since pipeline components are not safe for concurrent use.  Output from each
+// file is captured and written as one block on completion, and per-file results are retained for the batch summary
+class BatchTransform
+{
+public:
+
+	// Result of transforming a single file within the batch
+	struct FileResult
+	{
+		std::string							Input;
+		bool								Success;
+		bool								UpToDate;			// Indicates that existing outputs were still valid, so no transform was required
+		ModelSizeProperties					Metadata;			// Combined metadata for all meshes in the file, if available
+		std::string							Errors;				// All error output generated while transforming the file
+		double								Duration;			// Seconds
+
+		FileResult(void) : Success(false), UpToDate(false), Duration(0.0) { }
+	};
+
+	// Transform applied to each file.  Returns true if successful and populates model metadata where it is available.  Sets
+	// 'out_up_to_date' if the file was skipped since its existing outputs remain valid
+	typedef std::function<bool(const std::string & input, ModelSizeProperties & out_metadata, bool & out_up_to_date)>		FileTransform;
+
+	// Constructor.  A thread count of zero will use one thread per hardware thread
+	BatchTransform(unsigned int thread_count = 0U);
+
+	// Transforms every input file, returning once all are complete
+	TransformResult							Execute(const std::vector<std::string> & input, const FileTransform & transform);
+
+	// Results for each input file, in the order the files were supplied
+	inline const std::vector<FileResult> &	GetResults(void) const { return m_results; }
+	inline unsigned int						GetThreadCount(void) const { return m_thread_count; }
+
+	// Generates a summary of the batch results, optionally including model metadata for each file
+	std::string								GenerateSummary(bool include_metadata) const;
+
+	// Reads a manifest of input files, one per line.  Empty lines and lines beginning with '#' are ignored.  Relative
+	// paths are resolved against the directory of the manifest
+	static std::vector<std::string>			ReadManifest(fs::path manifest);
+
+	// Returns all files within the directory hierarchy with the given extension, e.g. ".obj"
+	static std::vector<std::string>			FindInputFiles(fs::path directory, const std::string & extension);
+
+private:
+
+	void									ExecuteFile(size_t index, size_t count, const FileTransform & transform);
+
+private:
+
+	unsigned int							m_thread_count;
+	std::vector<FileResult>					m_results;
+	double									m_duration;
+
+};
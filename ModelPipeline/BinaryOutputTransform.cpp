@@ -3,12 +3,18 @@
 #include "TransformPipelineOutput.h"
 #include "BinaryOutputTransform.h"
 
+BinaryOutputTransform::BinaryOutputTransform(bool compress)
+	:
+	m_compress(compress)
+{
+}
+
 ByteString BinaryOutputTransform::ExecuteTransform(std::unique_ptr<ModelData> model) const
 { 
 	ModelData *m = model.get();
 	if (!m) return ByteString();
 
-	return m->Serialize();
+	return m->Serialize(m_compress);
 }
 
 void BinaryOutputTransform::ExecuteTransform(std::unique_ptr<ModelData> model, fs::path output_file) const
@@ -19,7 +25,7 @@ void BinaryOutputTransform::ExecuteTransform(std::unique_ptr<ModelData> model, f
 		return;
 	}
 
-	TRANSFORM_INFO << "Serializing model data\n";
+	TRANSFORM_INFO << "Serializing " << (m_compress ? "compressed " : "") << "model data\n";
 	ByteString output = ExecuteTransform(std::move(model));
 
 	TRANSFORM_INFO << "Writing serialized data to file [" << output.size() << " bytes / " << (output.size() / 1024U) << "kb]\n";
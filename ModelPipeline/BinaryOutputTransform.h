@@ -3,17 +3,23 @@
 #include "../Definitions/ModelData.h"
 #include "TransformPipelineOutput.h"
 #include "../Definitions/ByteString.h"
+#include "../Definitions/BinaryModelFile.h"
 
 class BinaryOutputTransform : public TransformPipelineOutput
 {
 public:
 
+	// Output can optionally use compressed mesh data, with quantised vertex attributes and delta-encoded indices
+	BinaryOutputTransform(bool compress = false);
+
 	inline std::string	GetName(void) const { return "BinaryOutputTransform"; }
+	inline std::string	GetConfiguration(void) const { return std::to_string(BinaryModelFile::CURRENT_VERSION) + (m_compress ? ",compressed" : ""); }
 
 	ByteString			ExecuteTransform(std::unique_ptr<ModelData> model) const;
 	void				ExecuteTransform(std::unique_ptr<ModelData> model, fs::path output_file) const;
 
 private:
 
+	bool				m_compress;
 
 };
\ No newline at end of file
@@ -0,0 +1,272 @@
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cstdlib>
+#include <cerrno>
+#include <cctype>
+#include <cmath>
+#include "PipelineLog.h"
+#include "BuildCache.h"
+
+
+// Constructor; the cache is not loaded until requested
+BuildCache::BuildCache(fs::path cache_file)
+	:
+	m_file(cache_file),
+	m_modified(false)
+{
+}
+
+// Load all entries from the cache file.  A missing, incompatible or corrupt cache file results in an empty cache
+void BuildCache::Load(void)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_entries.clear();
+	m_modified = false;
+
+	if (!fs::exists(m_file))
+	{
+		PipelineLog::Info() << "No build cache found at \"" << fs::absolute(m_file).string() << "\"; all models will be rebuilt\n";
+		return;
+	}
+
+	std::ifstream in(m_file);
+	std::string line, tag;
+	unsigned int version = 0U;
+	if (!std::getline(in, line) || !(std::istringstream(line) >> tag >> version) || tag != "RJBuildCache" || version != CACHE_VERSION)
+	{
+		PipelineLog::Info() << "Build cache \"" << fs::absolute(m_file).string() << "\" is not compatible with this version; all models will be rebuilt\n";
+		m_modified = true;
+		return;
+	}
+
+	// Each entry is given by an "E" record, followed by one "O" record per output file.  Fields are tab-delimited
+	Entry *current = NULL;
+	while (std::getline(in, line))
+	{
+		std::vector<std::string> fields;
+		std::istringstream ss(line);
+		std::string field;
+		while (std::getline(ss, field, '\t')) fields.push_back(field);
+
+		bool valid = true;
+		if (fields.size() == 15U && fields[0] == "E")
+		{
+			Entry entry;
+			valid = ParseHash(fields[2], entry.Key);
+
+			float v[12];
+			for (int i = 0; i < 12 && valid; ++i) valid = ParseFloat(fields[3 + i], v[i]);
+			if (valid)
+			{
+				entry.Metadata = ModelSizeProperties(XMFLOAT3(v[0], v[1], v[2]), XMFLOAT3(v[3], v[4], v[5]), XMFLOAT3(v[6], v[7], v[8]), XMFLOAT3(v[9], v[10], v[11]));
+				current = &(m_entries[fields[1]] = entry);
+			}
+		}
+		else if (fields.size() == 3U && fields[0] == "O" && current)
+		{
+			HashValue hash;
+			valid = ParseHash(fields[2], hash);
+			if (valid) current->Outputs.push_back({ fields[1], hash });
+		}
+		else if (!line.empty())
+		{
+			valid = false;
+		}
+
+		// A corrupt cache cannot be partially trusted, so is discarded and rewritten in its entirety
+		if (!valid)
+		{
+			PipelineLog::Info() << "Build cache \"" << fs::absolute(m_file).string() << "\" is corrupt; all models will be rebuilt\n";
+			m_entries.clear();
+			m_modified = true;
+			return;
+		}
+	}
+
+	PipelineLog::Info() << "Loaded " << m_entries.size() << " entries from build cache \"" << fs::absolute(m_file).string() << "\"\n";
+}
+
+// Saves all entries to the cache file, if they have been modified since the cache was loaded
+void BuildCache::Save(void) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_modified) return;
+
+	std::ofstream out(m_file, std::ios::trunc);
+	if (out.fail())
+	{
+		PipelineLog::Error() << "Error: Cannot write build cache \"" << fs::absolute(m_file).string() << "\"\n";
+		return;
+	}
+
+	out << "RJBuildCache " << CACHE_VERSION << "\n";
+	out << std::setprecision(9);
+	for (const auto & item : m_entries)
+	{
+		const Entry & entry = item.second;
+		const ModelSizeProperties & m = entry.Metadata;
+		out << "E\t" << item.first << "\t" << std::hex << entry.Key << std::dec;
+		for (const XMFLOAT3 & v : { m.MinBounds, m.MaxBounds, m.ModelSize, m.CentrePoint })
+		{
+			out << "\t" << v.x << "\t" << v.y << "\t" << v.z;
+		}
+		out << "\n";
+
+		for (const auto & output : entry.Outputs)
+		{
+			out << "O\t" << output.first << "\t" << std::hex << output.second << std::dec << "\n";
+		}
+	}
+
+	m_modified = false;
+	PipelineLog::Info() << "Saved " << m_entries.size() << " entries to build cache \"" << fs::absolute(m_file).string() << "\"\n";
+}
+
+// Removes all entries from the cache
+void BuildCache::Clear(void)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_entries.clear();
+	m_modified = true;
+}
+
+// Determines the cache key for an input file being transformed by the given pipeline configuration into the given target
+BuildCache::HashValue BuildCache::CalculateKey(fs::path input, const std::string & configuration, fs::path output_file)
+{
+	HashValue key = Hash(configuration);
+	key = Hash(fs::absolute(output_file).string(), key);
+
+	// An input which cannot be read can never be up to date
+	if (!HashFile(input, key, key)) return 0U;
+	return key;
+}
+
+// Determines whether the outputs recorded for this input are still valid for the given key.  Model metadata
+// recorded for the input is returned if so
+bool BuildCache::IsUpToDate(fs::path input, HashValue key, ModelSizeProperties & out_metadata) const
+{
+	if (key == 0U) return false;
+
+	// Take a copy of the entry so that output files can be verified without holding the lock
+	Entry entry;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		auto it = m_entries.find(GetEntryName(input));
+		if (it == m_entries.end()) return false;
+		entry = it->second;
+	}
+
+	if (entry.Key != key || entry.Outputs.empty()) return false;
+
+	// Outputs which have been removed or modified since they were generated are stale
+	for (const auto & output : entry.Outputs)
+	{
+		HashValue hash;
+		if (!HashFile(fs::path(output.first), hash) || hash != output.second)
+		{
+			PipelineLog::Info() << "Output \"" << output.first << "\" is stale and will be rebuilt\n";
+			return false;
+		}
+	}
+
+	out_metadata = entry.Metadata;
+	return true;
+}
+
+// Records the outputs generated from an input file following a successful transformation
+void BuildCache::Record(fs::path input, HashValue key, const std::vector<fs::path> & outputs, const ModelSizeProperties & metadata)
+{
+	if (key == 0U) { Invalidate(input); return; }
+
+	Entry entry;
+	entry.Key = key;
+	entry.Metadata = metadata;
+	for (const auto & output : outputs)
+	{
+		HashValue hash;
+		if (!HashFile(output, hash)) { Invalidate(input); return; }
+		entry.Outputs.push_back({ fs::absolute(output).string(), hash });
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_entries[GetEntryName(input)] = entry;
+	m_modified = true;
+}
+
+// Removes any entry for the given input, e.g. following a failed transformation
+void BuildCache::Invalidate(fs::path input)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (m_entries.erase(GetEntryName(input)) != 0U) m_modified = true;
+}
+
+// Returns the number of entries currently held in the cache
+size_t BuildCache::GetEntryCount(void) const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_entries.size();
+}
+
+// 64-bit FNV-1a hash, optionally continuing from the result of a previous hash
+BuildCache::HashValue BuildCache::Hash(const void *data, size_t size, HashValue seed)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+	HashValue hash = seed;
+	for (size_t i = 0U; i < size; ++i)
+	{
+		hash ^= (HashValue)bytes[i];
+		hash *= HASH_PRIME;
+	}
+
+	return hash;
+}
+
+// Returns the hash of all data in the given file, or false if the file cannot be read
+bool BuildCache::HashFile(fs::path file, HashValue & out_hash, HashValue seed)
+{
+	std::ifstream in(file, std::ios::binary);
+	if (!in.is_open()) return false;
+
+	// Stream through the file in blocks rather than loading it in its entirety
+	static const size_t BLOCK_SIZE = 64U * 1024U;
+	std::vector<char> buffer(BLOCK_SIZE);
+
+	HashValue hash = seed;
+	while (in)
+	{
+		in.read(buffer.data(), BLOCK_SIZE);
+		hash = Hash(buffer.data(), (size_t)in.gcount(), hash);
+	}
+
+	out_hash = hash;
+	return true;
+}
+
+// Parses a hexadecimal hash value from a cache record.  Returns false if the field is not entirely a valid value
+bool BuildCache::ParseHash(const std::string & field, HashValue & out_value)
+{
+	if (field.empty() || !isxdigit((unsigned char)field[0])) return false;
+
+	char *end = NULL;
+	errno = 0;
+	out_value = strtoull(field.c_str(), &end, 16);
+	return (errno == 0 && end == (field.c_str() + field.size()));
+}
+
+// Parses a floating-point value from a cache record.  Returns false if the field is not entirely a valid, finite value
+bool BuildCache::ParseFloat(const std::string & field, float & out_value)
+{
+	if (field.empty() || isspace((unsigned char)field[0])) return false;
+
+	char *end = NULL;
+	errno = 0;
+	out_value = strtof(field.c_str(), &end);
+	return (errno == 0 && end == (field.c_str() + field.size()) && std::isfinite(out_value));
+}
+
+// Entries are stored against the absolute path of their input file
+std::string BuildCache::GetEntryName(fs::path input)
+{
+	return fs::absolute(input).lexically_normal().string();
+}
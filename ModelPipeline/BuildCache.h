@@ -0,0 +1,92 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <unordered_map>
+#include <filesystem>
+#include "../Definitions/ModelSizeProperties.h"
+namespace fs = std::filesystem;
+
+
+// Persistent record of previous pipeline outputs, allowing unchanged models to be skipped during a rebuild.  Each entry is
+// keyed by a hash of the input file contents, the full pipeline configuration and the output target, and records a hash of
+// every output file so that outputs which have been modified or removed since the last build are detected and rebuilt.
+// Entries may be queried and recorded concurrently by the threads of a batch transform
+class BuildCache
+{
+public:
+
+	typedef unsigned long long								HashValue;
+
+	// Cache files with a different version are discarded in their entirety
+	static const unsigned int								CACHE_VERSION = 1U;
+
+	// Constructor; the cache is not loaded until requested
+	BuildCache(fs::path cache_file);
+
+	// Load all entries from the cache file.  A missing, incompatible or corrupt cache file results in an empty cache
+	void													Load(void);
+
+	// Saves all entries to the cache file, if they have been modified since the cache was loaded
+	void													Save(void) const;
+
+	// Removes all entries from the cache
+	void													Clear(void);
+
+	// Determines the cache key for an input file being transformed by the given pipeline configuration into the given target
+	static HashValue										CalculateKey(fs::path input, const std::string & configuration, fs::path output_file);
+
+	// Determines whether the outputs recorded for this input are still valid for the given key.  Model metadata
+	// recorded for the input is returned if so
+	bool													IsUpToDate(fs::path input, HashValue key, ModelSizeProperties & out_metadata) const;
+
+	// Records the outputs generated from an input file following a successful transformation
+	void													Record(fs::path input, HashValue key, const std::vector<fs::path> & outputs, const ModelSizeProperties & metadata);
+
+	// Removes any entry for the given input, e.g. following a failed transformation
+	void													Invalidate(fs::path input);
+
+	// Returns the number of entries currently held in the cache
+	size_t													GetEntryCount(void) const;
+
+	inline fs::path											GetCacheFile(void) const { return m_file; }
+
+	// 64-bit FNV-1a hash, optionally continuing from the result of a previous hash
+	static HashValue										Hash(const void *data, size_t size, HashValue seed = HASH_OFFSET_BASIS);
+	static inline HashValue									Hash(const std::string & data, HashValue seed = HASH_OFFSET_BASIS) { return Hash(data.data(), data.size(), seed); }
+
+	// Returns the hash of all data in the given file, or false if the file cannot be read
+	static bool												HashFile(fs::path file, HashValue & out_hash, HashValue seed = HASH_OFFSET_BASIS);
+
+private:
+
+	static const HashValue									HASH_OFFSET_BASIS = 14695981039346656037ULL;
+	static const HashValue									HASH_PRIME = 1099511628211ULL;
+
+	// Record of a single input file
+	struct Entry
+	{
+		HashValue											Key;
+		std::vector<std::pair<std::string, HashValue>>		Outputs;			// Path and content hash of each output file
+		ModelSizeProperties									Metadata;
+
+		Entry(void) : Key(0U) { }
+	};
+
+	// Entries are stored against the absolute path of their input file
+	static std::string										GetEntryName(fs::path input);
+
+	// Parse numeric fields of a cache record.  Return false if the field is not entirely a valid value
+	static bool												ParseHash(const std::string & field, HashValue & out_value);
+	static bool												ParseFloat(const std::string & field, float & out_value);
+
+private:
+
+	fs::path												m_file;
+	std::unordered_map<std::string, Entry>					m_entries;
+	mutable bool											m_modified;
+
+	mutable std::mutex										m_mutex;
+
+};
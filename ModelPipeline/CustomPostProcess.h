@@ -8,12 +8,15 @@ typedef unsigned long PostProcess;
 // Assimp post-processing constants end with a final value of "aiProcess_Debone = 0x4000000".  Custom constants
 // will therefore begin from 0x8000000
 
-enum class CustomPostProcess
+enum class CustomPostProcess : PostProcess
 {
 	InvertU					= 0x8000000,		// Replace U coords of UV mapping with (1.0f - U) 
 	InvertV					= 0x10000000,		// Replace V coords of UV mapping with (1.0f - V)
 
-	CustomTransform			= 0x20000000		// Apply the transform matrix given in <modelfile>.transform to all model geometry
+	CustomTransform			= 0x20000000,		// Apply the transform matrix given in <modelfile>.transform to all model geometry
+
+	OptimiseVertexCache		= 0x40000000,		// Reorder triangles for post-transform vertex cache efficiency, then vertices for fetch locality
+	OptimiseOverdraw		= 0x80000000		// Reorder triangles to reduce overdraw, then vertices for fetch locality
 
 
 };
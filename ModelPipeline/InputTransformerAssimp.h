@@ -12,6 +12,7 @@ public:
 	InputTransformerAssimp(unsigned int operations);
 
 	inline std::string									GetName(void) const { return "InputTransformAssimp"; }
+	inline std::string									GetConfiguration(void) const { return std::to_string(m_operations); }
 
 	virtual std::vector<std::unique_ptr<ModelData>>		ExecuteTransform(fs::path file) const;
 	virtual std::vector<std::unique_ptr<ModelData>>		ExecuteTransform(const std::string & data) const;
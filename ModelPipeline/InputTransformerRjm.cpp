@@ -1,6 +1,7 @@
 #include <iostream>
 #include "InputTransformerRjm.h"
 #include "PipelineUtil.h"
+#include "../Definitions/BinaryModelFile.h"
 
 
 std::vector<std::unique_ptr<ModelData>> InputTransformerRjm::ExecuteTransform(fs::path file) const
@@ -17,6 +18,30 @@ std::vector<std::unique_ptr<ModelData>> InputTransformerRjm::ExecuteTransform(fs
 		return {};
 	}
 
+	// Binary model files may contain several meshes, all of which are returned.  Data is copied rather than mapped, since the 
+	// source may be a temporary file that is deleted once the transform completes
+	if (BinaryModelFile::IsBinaryModelData(data.data(), data.size()))
+	{
+		TRANSFORM_INFO << "Attempting to load binary model data\n";
+		auto meshes = BinaryModelFile::Load(data.data(), data.size(), true);
+		if (meshes.empty())
+		{
+			TRANSFORM_ERROR << "Failed to load binary model data; file may be invalid or corrupt\n";
+			return {};
+		}
+
+		// LOD chains are derived from the full-detail mesh, so are discarded here and regenerated by the pipeline if required.  
+		// Otherwise they would no longer match a full-detail mesh modified by later pipeline stages
+		for (auto & mesh : meshes)
+		{
+			if (!mesh->Lods.empty()) TRANSFORM_INFO << "Discarding " << mesh->Lods.size() << " existing LOD meshes\n";
+			mesh->Lods.clear();
+		}
+
+		TRANSFORM_INFO << "Successfully loaded binary model data (" << meshes.size() << " meshes)\n";
+		return meshes;
+	}
+
 	// Deserialise into the target model data structure
 	TRANSFORM_INFO << "Attempting to deserialise loaded model data\n";
 	auto geometry = ModelData::Deserialize(data);
@@ -0,0 +1,376 @@
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "PipelineUtil.h"
+#include "MeshOptimisation.h"
+
+// Initialise static data
+const float MeshOptimisation::DEFAULT_OVERDRAW_THRESHOLD = 1.05f;
+
+
+// Simulates a FIFO post-transform cache of the given size over the index data
+MeshOptimisation::CacheMetrics MeshOptimisation::CalculateCacheMetrics(const INDEX_BUFFER_TYPE *indices, unsigned int index_count, unsigned int vertex_count, unsigned int cache_size)
+{
+	CacheMetrics metrics;
+	if (!indices || index_count < 3U || vertex_count == 0U || cache_size == 0U) return metrics;
+
+	// A vertex is present in the FIFO cache if fewer than 'cache_size' vertices have been added since it was itself added.  All
+	// timestamps start far enough in the past that no vertex is initially present
+	std::vector<unsigned int> timestamps(vertex_count, 0U);
+	std::vector<bool> referenced(vertex_count, false);
+	unsigned int time = cache_size + 1U;
+	unsigned int referenced_count = 0U;
+
+	for (unsigned int i = 0U; i < index_count; ++i)
+	{
+		INDEX_BUFFER_TYPE v = indices[i];
+		if (v >= vertex_count) continue;
+
+		if (time - timestamps[v] > cache_size)
+		{
+			timestamps[v] = time++;
+			++metrics.Misses;
+		}
+
+		if (!referenced[v]) { referenced[v] = true; ++referenced_count; }
+	}
+
+	metrics.ACMR = (float)metrics.Misses / (float)(index_count / 3U);
+	metrics.ATVR = (referenced_count == 0U ? 0.0f : (float)metrics.Misses / (float)referenced_count);
+	return metrics;
+}
+
+// Forsyth vertex score for a vertex at the given LRU cache position (or -1 if not in the cache) with the given number of remaining triangles
+float MeshOptimisation::CalculateVertexScore(int cache_position, unsigned int remaining_triangles, unsigned int cache_size)
+{
+	static const float CACHE_DECAY_POWER = 1.5f;
+	static const float LAST_TRIANGLE_SCORE = 0.75f;
+	static const float VALENCE_BOOST_SCALE = 2.0f;
+	static const float VALENCE_BOOST_POWER = 0.5f;
+
+	// Vertices with no remaining triangles will never be selected again
+	if (remaining_triangles == 0U) return -1.0f;
+
+	float score = 0.0f;
+	if (cache_position >= 0)
+	{
+		// Vertices used by the most recent triangle receive a fixed score, so that no triangle is favoured for sharing an edge
+		// with the previous triangle over any other; remaining cache positions decay with age
+		if (cache_position < 3)
+		{
+			score = LAST_TRIANGLE_SCORE;
+		}
+		else
+		{
+			float scaler = 1.0f / (float)(cache_size - 3U);
+			score = std::pow(1.0f - ((float)(cache_position - 3) * scaler), CACHE_DECAY_POWER);
+		}
+	}
+
+	// Boost vertices with few remaining triangles, so that isolated vertices are cleared rather than left until the end
+	score += VALENCE_BOOST_SCALE * std::pow((float)remaining_triangles, -VALENCE_BOOST_POWER);
+	return score;
+}
+
+// Reorders triangles for post-transform cache efficiency, based on "Linear-Speed Vertex Cache Optimisation" (Forsyth, 2006).
+// Triangles are emitted greedily in order of score, where vertex scores favour vertices recently added to a simulated LRU
+// cache and vertices with few remaining triangles
+void MeshOptimisation::OptimiseVertexCache(INDEX_BUFFER_TYPE *indices, unsigned int index_count, unsigned int vertex_count, unsigned int cache_size)
+{
+	if (!IsValidTriangleList(indices, index_count, vertex_count) || cache_size <= 3U) return;
+	unsigned int triangle_count = (index_count / 3U);
+
+	// Build vertex -> triangle adjacency.  The live triangles of each vertex are held at the start of its range, and
+	// emitted triangles are swapped out beyond the 'remaining' count
+	std::vector<unsigned int> remaining(vertex_count, 0U);
+	for (unsigned int i = 0U; i < index_count; ++i) ++remaining[indices[i]];
+
+	std::vector<unsigned int> offsets(vertex_count, 0U);
+	for (unsigned int v = 1U; v < vertex_count; ++v) offsets[v] = offsets[v - 1U] + remaining[v - 1U];
+
+	std::vector<unsigned int> adjacency(index_count);
+	std::vector<unsigned int> fill(offsets);
+	for (unsigned int i = 0U; i < index_count; ++i) adjacency[fill[indices[i]]++] = (i / 3U);
+
+	// Initial scores; no vertices are in the cache
+	std::vector<int> cache_position(vertex_count, -1);
+	std::vector<float> vertex_score(vertex_count);
+	for (unsigned int v = 0U; v < vertex_count; ++v) vertex_score[v] = CalculateVertexScore(-1, remaining[v], cache_size);
+
+	std::vector<float> triangle_score(triangle_count);
+	std::vector<bool> emitted(triangle_count, false);
+	unsigned int best_triangle = 0U;
+	for (unsigned int t = 0U; t < triangle_count; ++t)
+	{
+		const INDEX_BUFFER_TYPE *tri = &(indices[t * 3U]);
+		triangle_score[t] = vertex_score[tri[0]] + vertex_score[tri[1]] + vertex_score[tri[2]];
+		if (triangle_score[t] > triangle_score[best_triangle]) best_triangle = t;
+	}
+
+	// Cache holds up to three additional entries while being updated, before it is truncated
+	std::vector<INDEX_BUFFER_TYPE> cache, new_cache;
+	cache.reserve(cache_size + 3U);
+	new_cache.reserve(cache_size + 3U);
+
+	std::vector<INDEX_BUFFER_TYPE> output(index_count);
+	unsigned int output_triangle = 0U;
+	unsigned int input_cursor = 0U;
+
+	while (true)
+	{
+		// Emit the selected triangle
+		const INDEX_BUFFER_TYPE *tri = &(indices[best_triangle * 3U]);
+		memcpy(&(output[output_triangle * 3U]), tri, sizeof(INDEX_BUFFER_TYPE) * 3U);
+		emitted[best_triangle] = true;
+		if (++output_triangle == triangle_count) break;
+
+		// Remove the triangle from the live adjacency of each vertex
+		for (int i = 0; i < 3; ++i)
+		{
+			INDEX_BUFFER_TYPE v = tri[i];
+			unsigned int *begin = &(adjacency[offsets[v]]);
+			unsigned int *end = begin + remaining[v];
+			std::iter_swap(std::find(begin, end, best_triangle), end - 1);
+			--remaining[v];
+		}
+
+		// Move the triangle vertices to the front of the LRU cache
+		new_cache.assign(tri, tri + 3);
+		for (INDEX_BUFFER_TYPE v : cache)
+		{
+			if (v != tri[0] && v != tri[1] && v != tri[2]) new_cache.push_back(v);
+		}
+
+		// Vertices pushed out of the cache lose their cache score
+		for (size_t i = cache_size; i < new_cache.size(); ++i)
+		{
+			INDEX_BUFFER_TYPE v = new_cache[i];
+			cache_position[v] = -1;
+			vertex_score[v] = CalculateVertexScore(-1, remaining[v], cache_size);
+		}
+		if (new_cache.size() > cache_size) new_cache.resize(cache_size);
+		cache.swap(new_cache);
+
+		for (size_t i = 0U; i < cache.size(); ++i)
+		{
+			INDEX_BUFFER_TYPE v = cache[i];
+			cache_position[v] = (int)i;
+			vertex_score[v] = CalculateVertexScore((int)i, remaining[v], cache_size);
+		}
+
+		// Rescore all live triangles referencing a cached vertex, and select the best as the next triangle.  Triangles
+		// referencing evicted vertices can only have decreased in score, so need not be considered as candidates
+		float best_score = -1.0f;
+		for (INDEX_BUFFER_TYPE v : cache)
+		{
+			for (unsigned int i = 0U; i < remaining[v]; ++i)
+			{
+				unsigned int t = adjacency[offsets[v] + i];
+				const INDEX_BUFFER_TYPE *adj = &(indices[t * 3U]);
+				triangle_score[t] = vertex_score[adj[0]] + vertex_score[adj[1]] + vertex_score[adj[2]];
+				if (triangle_score[t] > best_score) { best_score = triangle_score[t]; best_triangle = t; }
+			}
+		}
+
+		// If no cached vertex has any live triangles, continue from the next unemitted triangle in input order
+		if (best_score < 0.0f)
+		{
+			while (emitted[input_cursor]) ++input_cursor;
+			best_triangle = input_cursor;
+		}
+	}
+
+	memcpy(indices, output.data(), sizeof(INDEX_BUFFER_TYPE) * index_count);
+}
+
+// Returns a per-triangle flag indicating whether each triangle would be a complete cache miss for the FIFO cache
+std::vector<bool> MeshOptimisation::DetermineHardBoundaries(const INDEX_BUFFER_TYPE *indices, unsigned int index_count, unsigned int vertex_count, unsigned int cache_size)
+{
+	unsigned int triangle_count = (index_count / 3U);
+	std::vector<bool> boundaries(triangle_count, false);
+
+	std::vector<unsigned int> timestamps(vertex_count, 0U);
+	unsigned int time = cache_size + 1U;
+
+	for (unsigned int t = 0U; t < triangle_count; ++t)
+	{
+		unsigned int misses = 0U;
+		for (int i = 0; i < 3; ++i)
+		{
+			INDEX_BUFFER_TYPE v = indices[t * 3U + i];
+			if (time - timestamps[v] > cache_size)
+			{
+				timestamps[v] = time++;
+				++misses;
+			}
+		}
+
+		boundaries[t] = (misses == 3U);
+	}
+
+	return boundaries;
+}
+
+// Reorders triangles to reduce overdraw, based on "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" (Sander
+// et al., 2007).  Cache-optimised index data is split into clusters at points where the cache is effectively flushed, or where
+// doing so keeps ACMR within the given threshold, and clusters are then sorted so that those facing outwards from the mesh
+// centre are drawn first.  Should be run after vertex cache optimisation
+void MeshOptimisation::OptimiseOverdraw(INDEX_BUFFER_TYPE *indices, unsigned int index_count, const ModelData::TVertex *vertices, unsigned int vertex_count, float threshold, unsigned int cache_size)
+{
+	if (!vertices || !IsValidTriangleList(indices, index_count, vertex_count) || cache_size == 0U) return;
+	unsigned int triangle_count = (index_count / 3U);
+
+	// Triangles which are a complete cache miss can begin a new cluster without any loss of cache efficiency
+	std::vector<bool> hard_boundaries = DetermineHardBoundaries(indices, index_count, vertex_count, cache_size);
+	std::vector<unsigned int> hard_clusters;
+	for (unsigned int t = 0U; t < triangle_count; ++t)
+	{
+		if (t == 0U || hard_boundaries[t]) hard_clusters.push_back(t);
+	}
+
+	// Subdivide each hard cluster wherever the ACMR of the cluster so far, with a flushed cache, is within the threshold
+	// of the ACMR of the hard cluster as a whole
+	std::vector<unsigned int> timestamps(vertex_count, 0U);
+	unsigned int time = cache_size + 1U;
+	auto simulate_triangle = [&](unsigned int t) -> unsigned int
+	{
+		unsigned int misses = 0U;
+		for (int i = 0; i < 3; ++i)
+		{
+			INDEX_BUFFER_TYPE v = indices[t * 3U + i];
+			if (time - timestamps[v] > cache_size) { timestamps[v] = time++; ++misses; }
+		}
+		return misses;
+	};
+
+	std::vector<unsigned int> clusters;
+	for (size_t c = 0U; c < hard_clusters.size(); ++c)
+	{
+		unsigned int start = hard_clusters[c];
+		unsigned int end = (c + 1U < hard_clusters.size() ? hard_clusters[c + 1U] : triangle_count);
+
+		// Flushing the cache is equivalent to advancing time beyond the lifetime of every current entry
+		time += (cache_size + 1U);
+		unsigned int cluster_misses = 0U;
+		for (unsigned int t = start; t < end; ++t) cluster_misses += simulate_triangle(t);
+		float cluster_threshold = threshold * ((float)cluster_misses / (float)(end - start));
+
+		unsigned int soft_start = start;
+		unsigned int misses = 0U;
+		time += (cache_size + 1U);
+		for (unsigned int t = start; t < end; ++t)
+		{
+			misses += simulate_triangle(t);
+			if ((float)misses / (float)(t - soft_start + 1U) <= cluster_threshold)
+			{
+				clusters.push_back(soft_start);
+				soft_start = t + 1U;
+				misses = 0U;
+				time += (cache_size + 1U);
+			}
+		}
+
+		if (soft_start < end) clusters.push_back(soft_start);
+	}
+
+	// Determine the area-weighted centroid and normal of each cluster, and of the mesh as a whole
+	struct Cluster
+	{
+		unsigned int		Start, End;
+		XMFLOAT3			Centroid, Normal;
+		float				SortKey;
+	};
+
+	std::vector<Cluster> cluster_data(clusters.size());
+	XMFLOAT3 mesh_centroid(0.0f, 0.0f, 0.0f);
+	float mesh_area = 0.0f;
+	for (size_t c = 0U; c < clusters.size(); ++c)
+	{
+		Cluster & cluster = cluster_data[c];
+		cluster.Start = clusters[c];
+		cluster.End = (c + 1U < clusters.size() ? clusters[c + 1U] : triangle_count);
+		cluster.Centroid = cluster.Normal = XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+		float cluster_area = 0.0f;
+		for (unsigned int t = cluster.Start; t < cluster.End; ++t)
+		{
+			const XMFLOAT3 & p0 = vertices[indices[t * 3U + 0U]].position;
+			const XMFLOAT3 & p1 = vertices[indices[t * 3U + 1U]].position;
+			const XMFLOAT3 & p2 = vertices[indices[t * 3U + 2U]].position;
+
+			XMFLOAT3 e0 = PipelineUtil::Float3Subtract(p1, p0), e1 = PipelineUtil::Float3Subtract(p2, p0);
+			XMFLOAT3 n(e0.y * e1.z - e0.z * e1.y, e0.z * e1.x - e0.x * e1.z, e0.x * e1.y - e0.y * e1.x);
+			float area = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+
+			XMFLOAT3 centre = PipelineUtil::Float3ScalarMultiply(PipelineUtil::Float3Add(PipelineUtil::Float3Add(p0, p1), p2), 1.0f / 3.0f);
+			cluster.Centroid = PipelineUtil::Float3Add(cluster.Centroid, PipelineUtil::Float3ScalarMultiply(centre, area));
+			cluster.Normal = PipelineUtil::Float3Add(cluster.Normal, n);
+			cluster_area += area;
+		}
+
+		mesh_centroid = PipelineUtil::Float3Add(mesh_centroid, cluster.Centroid);
+		mesh_area += cluster_area;
+		if (cluster_area > 0.0f) cluster.Centroid = PipelineUtil::Float3ScalarMultiply(cluster.Centroid, 1.0f / cluster_area);
+	}
+	if (mesh_area > 0.0f) mesh_centroid = PipelineUtil::Float3ScalarMultiply(mesh_centroid, 1.0f / mesh_area);
+
+	// Clusters facing away from the mesh centre are most likely to occlude others, so are drawn first
+	for (auto & cluster : cluster_data)
+	{
+		const XMFLOAT3 & n = cluster.Normal;
+		float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+		XMFLOAT3 offset = PipelineUtil::Float3Subtract(cluster.Centroid, mesh_centroid);
+		cluster.SortKey = (length > 0.0f ? (offset.x * n.x + offset.y * n.y + offset.z * n.z) / length : 0.0f);
+	}
+
+	std::stable_sort(cluster_data.begin(), cluster_data.end(), [](const Cluster & c0, const Cluster & c1) { return (c0.SortKey > c1.SortKey); });
+
+	std::vector<INDEX_BUFFER_TYPE> output;
+	output.reserve(index_count);
+	for (const auto & cluster : cluster_data)
+	{
+		output.insert(output.end(), indices + (cluster.Start * 3U), indices + (cluster.End * 3U));
+	}
+
+	memcpy(indices, output.data(), sizeof(INDEX_BUFFER_TYPE) * index_count);
+}
+
+// Reorders vertices into the order in which they are first referenced by the index data, remapping indices accordingly.  Any
+// unreferenced vertices are removed.  Returns the new vertex count
+unsigned int MeshOptimisation::OptimiseVertexFetch(ModelData::TVertex *vertices, unsigned int vertex_count, INDEX_BUFFER_TYPE *indices, unsigned int index_count)
+{
+	if (!vertices || !IsValidTriangleList(indices, index_count, vertex_count)) return vertex_count;
+
+	static const unsigned int UNMAPPED = std::numeric_limits<unsigned int>::max();
+	std::vector<unsigned int> remap(vertex_count, UNMAPPED);
+	std::vector<ModelData::TVertex> reordered;
+	reordered.reserve(vertex_count);
+
+	for (unsigned int i = 0U; i < index_count; ++i)
+	{
+		INDEX_BUFFER_TYPE v = indices[i];
+		if (remap[v] == UNMAPPED)
+		{
+			remap[v] = (unsigned int)reordered.size();
+			reordered.push_back(vertices[v]);
+		}
+
+		indices[i] = (INDEX_BUFFER_TYPE)remap[v];
+	}
+
+	memcpy(vertices, reordered.data(), sizeof(ModelData::TVertex) * reordered.size());
+	return (unsigned int)reordered.size();
+}
+
+// Returns a flag indicating whether the index data describes a valid triangle list over the given vertices
+bool MeshOptimisation::IsValidTriangleList(const INDEX_BUFFER_TYPE *indices, unsigned int index_count, unsigned int vertex_count)
+{
+	if (!indices || index_count < 3U || (index_count % 3U) != 0U) return false;
+
+	for (unsigned int i = 0U; i < index_count; ++i)
+	{
+		if (indices[i] >= vertex_count) return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+#include "../Definitions/ModelData.h"
+
+
+// Offline optimisation of triangle-list geometry for GPU vertex processing.  Index data is reordered to improve post-transform
+// vertex cache efficiency and reduce overdraw, and vertex data is reordered to improve vertex fetch locality
+class MeshOptimisation
+{
+public:
+
+	// Cache size used when reporting efficiency metrics.  A FIFO of this size approximates most current hardware
+	static const unsigned int					DEFAULT_METRIC_CACHE_SIZE = 16U;
+
+	// Cache size assumed when optimising for the post-transform cache.  An LRU of this size is used as per the Forsyth algorithm
+	static const unsigned int					DEFAULT_OPTIMISE_CACHE_SIZE = 32U;
+
+	// Default allowable increase in ACMR when reordering for overdraw, e.g. 1.05 allows an ACMR up to 5% above the current value
+	static const float							DEFAULT_OVERDRAW_THRESHOLD;
+
+	// Result of simulating the post-transform vertex cache over a set of indices
+	struct CacheMetrics
+	{
+		unsigned int							Misses;				// Total number of vertex shader invocations
+		float									ACMR;				// Average cache miss ratio; transformed vertices per triangle.  Range [0.5 3.0]
+		float									ATVR;				// Average transformed vertex ratio; transformed vertices per vertex referenced.  Best = 1.0
+
+		CacheMetrics(void) : Misses(0U), ACMR(0.0f), ATVR(0.0f) { }
+	};
+
+	// Simulates a FIFO post-transform cache of the given size over the index data
+	static CacheMetrics							CalculateCacheMetrics(const INDEX_BUFFER_TYPE *indices, unsigned int index_count, unsigned int vertex_count,
+																	  unsigned int cache_size = DEFAULT_METRIC_CACHE_SIZE);
+
+	// Reorders triangles for post-transform cache efficiency, based on "Linear-Speed Vertex Cache Optimisation" (Forsyth, 2006).
+	// Triangles are emitted greedily in order of score, where vertex scores favour vertices recently added to a simulated LRU
+	// cache and vertices with few remaining triangles
+	static void									OptimiseVertexCache(INDEX_BUFFER_TYPE *indices, unsigned int index_count, unsigned int vertex_count,
+																	unsigned int cache_size = DEFAULT_OPTIMISE_CACHE_SIZE);
+
+	// Reorders triangles to reduce overdraw, based on "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw" (Sander
+	// et al., 2007).  Cache-optimised index data is split into clusters at points where the cache is effectively flushed, or where
+	// doing so keeps ACMR within the given threshold, and clusters are then sorted so that those facing outwards from the mesh
+	// centre are drawn first.  Should be run after vertex cache optimisation
+	static void									OptimiseOverdraw(INDEX_BUFFER_TYPE *indices, unsigned int index_count, const ModelData::TVertex *vertices,
+																 unsigned int vertex_count, float threshold = DEFAULT_OVERDRAW_THRESHOLD,
+																 unsigned int cache_size = DEFAULT_METRIC_CACHE_SIZE);
+
+	// Reorders vertices into the order in which they are first referenced by the index data, remapping indices accordingly.  Any
+	// unreferenced vertices are removed.  Returns the new vertex count
+	static unsigned int							OptimiseVertexFetch(ModelData::TVertex *vertices, unsigned int vertex_count, INDEX_BUFFER_TYPE *indices,
+																	unsigned int index_count);
+
+	// Returns a flag indicating whether the index data describes a valid triangle list over the given vertices
+	static bool									IsValidTriangleList(const INDEX_BUFFER_TYPE *indices, unsigned int index_count, unsigned int vertex_count);
+
+private:
+
+	// Forsyth vertex score for a vertex at the given LRU cache position (or -1 if not in the cache) with the given number of remaining triangles
+	static float								CalculateVertexScore(int cache_position, unsigned int remaining_triangles, unsigned int cache_size);
+
+	// Returns a per-triangle flag indicating whether each triangle would be a complete cache miss for the FIFO cache
+	static std::vector<bool>					DetermineHardBoundaries(const INDEX_BUFFER_TYPE *indices, unsigned int index_count, unsigned int vertex_count,
+																		unsigned int cache_size);
+
+};
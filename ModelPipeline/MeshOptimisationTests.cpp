@@ -0,0 +1,165 @@
+#include "CppUnitTest.h"
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#include <vector>
+#include <array>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include "../Definitions/ModelData.h"
+#include "MeshOptimisation.h"
+
+namespace UnitTests
+{
+	TEST_CLASS(MeshOptimisationTests)
+	{
+	private:
+
+		typedef std::array<INDEX_BUFFER_TYPE, 3U> Triangle;
+
+		// Generates a grid of (rows x columns) quads over an undulating surface, with triangles in a random order so that
+		// there is scope for optimisation
+		static void GenerateGrid(unsigned int rows, unsigned int columns, std::vector<ModelData::TVertex> & out_vertices, std::vector<INDEX_BUFFER_TYPE> & out_indices)
+		{
+			out_vertices.clear(); out_indices.clear();
+			for (unsigned int r = 0U; r <= rows; ++r)
+			{
+				for (unsigned int c = 0U; c <= columns; ++c)
+				{
+					ModelData::TVertex v;
+					memset(&v, 0, sizeof(ModelData::TVertex));
+					v.position = XMFLOAT3((float)c, std::sin(c * 0.5f) * std::cos(r * 0.5f), (float)r);
+					v.normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+					v.tex = XMFLOAT2((float)c / (float)columns, (float)r / (float)rows);
+					out_vertices.push_back(v);
+				}
+			}
+
+			std::vector<Triangle> triangles;
+			for (unsigned int r = 0U; r < rows; ++r)
+			{
+				for (unsigned int c = 0U; c < columns; ++c)
+				{
+					INDEX_BUFFER_TYPE v0 = (r * (columns + 1U)) + c, v1 = v0 + 1U, v2 = v0 + (columns + 1U), v3 = v2 + 1U;
+					triangles.push_back({ v0, v2, v1 });
+					triangles.push_back({ v1, v2, v3 });
+				}
+			}
+
+			std::shuffle(triangles.begin(), triangles.end(), std::mt19937(12345U));
+			for (const Triangle & t : triangles) out_indices.insert(out_indices.end(), t.begin(), t.end());
+		}
+
+		// Returns the set of triangles in the index data, each rotated to begin at its lowest index so that triangles are
+		// compared independently of their starting vertex but not of their winding
+		static std::vector<Triangle> SortedTriangles(const std::vector<INDEX_BUFFER_TYPE> & indices)
+		{
+			std::vector<Triangle> triangles;
+			for (size_t i = 0U; i + 2U < indices.size(); i += 3U)
+			{
+				Triangle t = { indices[i], indices[i + 1U], indices[i + 2U] };
+				std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+				triangles.push_back(t);
+			}
+
+			std::sort(triangles.begin(), triangles.end());
+			return triangles;
+		}
+
+	public:
+
+		TEST_METHOD(VertexCacheOptimisationPreservesTriangles)
+		{
+			std::vector<ModelData::TVertex> vertices;
+			std::vector<INDEX_BUFFER_TYPE> indices;
+			GenerateGrid(40U, 40U, vertices, indices);
+
+			std::vector<INDEX_BUFFER_TYPE> optimised = indices;
+			MeshOptimisation::OptimiseVertexCache(optimised.data(), (unsigned int)optimised.size(), (unsigned int)vertices.size());
+
+			Assert::IsTrue(MeshOptimisation::IsValidTriangleList(optimised.data(), (unsigned int)optimised.size(), (unsigned int)vertices.size()),
+				L"Vertex cache optimisation did not produce a valid triangle list");
+			Assert::IsTrue(SortedTriangles(optimised) == SortedTriangles(indices), L"Vertex cache optimisation output is not a permutation of the input triangles");
+		}
+
+		TEST_METHOD(VertexCacheOptimisationDoesNotIncreaseACMR)
+		{
+			std::vector<ModelData::TVertex> vertices;
+			std::vector<INDEX_BUFFER_TYPE> indices;
+			GenerateGrid(40U, 40U, vertices, indices);
+			unsigned int index_count = (unsigned int)indices.size(), vertex_count = (unsigned int)vertices.size();
+
+			MeshOptimisation::CacheMetrics before = MeshOptimisation::CalculateCacheMetrics(indices.data(), index_count, vertex_count);
+			MeshOptimisation::OptimiseVertexCache(indices.data(), index_count, vertex_count);
+			MeshOptimisation::CacheMetrics after = MeshOptimisation::CalculateCacheMetrics(indices.data(), index_count, vertex_count);
+			Assert::IsTrue(after.ACMR <= before.ACMR, L"Vertex cache optimisation increased ACMR");
+
+			// Optimising data which is already optimised should not make it worse
+			MeshOptimisation::OptimiseVertexCache(indices.data(), index_count, vertex_count);
+			MeshOptimisation::CacheMetrics repeated = MeshOptimisation::CalculateCacheMetrics(indices.data(), index_count, vertex_count);
+			Assert::IsTrue(repeated.ACMR <= after.ACMR, L"Repeated vertex cache optimisation increased ACMR");
+		}
+
+		TEST_METHOD(OverdrawOptimisationPreservesTrianglesWithinThreshold)
+		{
+			std::vector<ModelData::TVertex> vertices;
+			std::vector<INDEX_BUFFER_TYPE> indices;
+			GenerateGrid(40U, 40U, vertices, indices);
+			unsigned int index_count = (unsigned int)indices.size(), vertex_count = (unsigned int)vertices.size();
+
+			MeshOptimisation::OptimiseVertexCache(indices.data(), index_count, vertex_count);
+			MeshOptimisation::CacheMetrics before = MeshOptimisation::CalculateCacheMetrics(indices.data(), index_count, vertex_count);
+
+			std::vector<INDEX_BUFFER_TYPE> optimised = indices;
+			MeshOptimisation::OptimiseOverdraw(optimised.data(), index_count, vertices.data(), vertex_count);
+			MeshOptimisation::CacheMetrics after = MeshOptimisation::CalculateCacheMetrics(optimised.data(), index_count, vertex_count);
+
+			Assert::IsTrue(SortedTriangles(optimised) == SortedTriangles(indices), L"Overdraw optimisation output is not a permutation of the input triangles");
+			Assert::IsTrue(after.ACMR <= (before.ACMR * MeshOptimisation::DEFAULT_OVERDRAW_THRESHOLD) + 1e-5f,
+				L"Overdraw optimisation increased ACMR beyond the permitted threshold");
+		}
+
+		TEST_METHOD(VertexFetchOptimisationPreservesTriangles)
+		{
+			std::vector<ModelData::TVertex> vertices;
+			std::vector<INDEX_BUFFER_TYPE> indices;
+			GenerateGrid(20U, 30U, vertices, indices);
+
+			// Drop the triangle at the grid corner, so that one vertex is no longer referenced and should be removed
+			std::vector<Triangle> triangles;
+			for (size_t i = 0U; i < indices.size(); i += 3U)
+			{
+				if (indices[i] != 0U && indices[i + 1U] != 0U && indices[i + 2U] != 0U) triangles.push_back({ indices[i], indices[i + 1U], indices[i + 2U] });
+			}
+			indices.clear();
+			for (const Triangle & t : triangles) indices.insert(indices.end(), t.begin(), t.end());
+
+			std::vector<ModelData::TVertex> remapped_vertices = vertices;
+			std::vector<INDEX_BUFFER_TYPE> remapped_indices = indices;
+			unsigned int vertex_count = MeshOptimisation::OptimiseVertexFetch(remapped_vertices.data(), (unsigned int)remapped_vertices.size(),
+																			   remapped_indices.data(), (unsigned int)remapped_indices.size());
+
+			Assert::AreEqual((unsigned int)vertices.size() - 1U, vertex_count, L"Unreferenced vertex was not removed by vertex fetch optimisation");
+
+			// Every index should reference identical vertex data, in the same triangle order and winding
+			bool identical = true;
+			for (size_t i = 0U; i < indices.size() && identical; ++i)
+			{
+				identical = (remapped_indices[i] < vertex_count &&
+							 memcmp(&(remapped_vertices[remapped_indices[i]]), &(vertices[indices[i]]), sizeof(ModelData::TVertex)) == 0);
+			}
+			Assert::IsTrue(identical, L"Vertex fetch optimisation changed the vertex data referenced by the index data");
+
+			// Vertices should be stored in order of first use
+			INDEX_BUFFER_TYPE next = 0U;
+			bool ordered = true;
+			for (INDEX_BUFFER_TYPE index : remapped_indices)
+			{
+				if (index == next) ++next;
+				else if (index > next) ordered = false;
+			}
+			Assert::IsTrue(ordered && next == vertex_count, L"Vertex fetch optimisation did not order vertices by first use");
+		}
+
+	};
+}
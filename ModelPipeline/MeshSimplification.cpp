@@ -0,0 +1,274 @@
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+#include <unordered_map>
+#include "MeshSimplification.h"
+
+
+void MeshSimplification::Quadric::AddPlane(double a, double b, double c, double d, double weight)
+{
+	a2 += weight * a * a;	ab += weight * a * b;	ac += weight * a * c;	ad += weight * a * d;
+	b2 += weight * b * b;	bc += weight * b * c;	bd += weight * b * d;
+	c2 += weight * c * c;	cd += weight * c * d;
+	d2 += weight * d * d;
+	w += weight;
+}
+
+void MeshSimplification::Quadric::Add(const Quadric & q)
+{
+	a2 += q.a2;	ab += q.ab;	ac += q.ac;	ad += q.ad;
+	b2 += q.b2;	bc += q.bc;	bd += q.bd;
+	c2 += q.c2;	cd += q.cd;
+	d2 += q.d2;
+	w += q.w;
+}
+
+// Returns the weighted mean squared distance from the given point to each plane in the quadric
+double MeshSimplification::Quadric::Error(const XMFLOAT3 & p) const
+{
+	double x = p.x, y = p.y, z = p.z;
+	double e = (a2 * x * x) + (b2 * y * y) + (c2 * z * z) + 2.0 * ((ab * x * y) + (ac * x * z) + (bc * y * z)) +
+			   2.0 * ((ad * x) + (bd * y) + (cd * z)) + d2;
+
+	return (w > 0.0 ? (std::max)(e / w, 0.0) : 0.0);
+}
+
+// Simplifies the index data towards the target index count, without exceeding the given error.  Returns the maximum error
+// of the simplified mesh, as an absolute distance in model space.  Simplified indices reference the original vertex data
+float MeshSimplification::Simplify(const INDEX_BUFFER_TYPE *indices, unsigned int index_count, const ModelData::TVertex *vertices,
+								   unsigned int vertex_count, unsigned int target_index_count, float target_error,
+								   std::vector<INDEX_BUFFER_TYPE> & out_indices)
+{
+	out_indices.assign(indices, indices + index_count);
+	if (!indices || !vertices || index_count < 3U || (index_count % 3U) != 0U || index_count <= target_index_count) return 0.0f;
+
+	static const unsigned int NONE = std::numeric_limits<unsigned int>::max();
+	unsigned int triangle_count = (index_count / 3U);
+
+	// Weld vertices by position.  Each position is represented by the first vertex found at that position, and all
+	// vertices at the position are retained so that attributes can be resolved following a collapse
+	struct PositionHash
+	{
+		size_t operator()(const XMFLOAT3 & p) const
+		{
+			unsigned int h[3]; memcpy(h, &p, sizeof(h));
+			return (size_t)((h[0] * 73856093U) ^ (h[1] * 19349663U) ^ (h[2] * 83492791U));
+		}
+	};
+	struct PositionEqual
+	{
+		bool operator()(const XMFLOAT3 & p0, const XMFLOAT3 & p1) const { return (memcmp(&p0, &p1, sizeof(XMFLOAT3)) == 0); }
+	};
+
+	std::unordered_map<XMFLOAT3, unsigned int, PositionHash, PositionEqual> positions;
+	std::vector<unsigned int> position_of(vertex_count);
+	std::vector<std::vector<unsigned int>> wedges(vertex_count);
+	for (unsigned int v = 0U; v < vertex_count; ++v)
+	{
+		auto it = positions.insert({ vertices[v].position, v }).first;
+		position_of[v] = it->second;
+		wedges[it->second].push_back(v);
+	}
+
+	// Per-triangle state; 'tri' holds vertex indices which are remapped as collapses are applied
+	std::vector<INDEX_BUFFER_TYPE> tri(indices, indices + index_count);
+	std::vector<bool> dead(triangle_count, false);
+	unsigned int live_triangles = triangle_count;
+
+	// Accumulate the area-weighted plane quadric of each triangle at each of its positions
+	std::vector<Quadric> quadrics(vertex_count);
+	for (unsigned int t = 0U; t < triangle_count; ++t)
+	{
+		const XMFLOAT3 & p0 = vertices[tri[t * 3U + 0U]].position;
+		const XMFLOAT3 & p1 = vertices[tri[t * 3U + 1U]].position;
+		const XMFLOAT3 & p2 = vertices[tri[t * 3U + 2U]].position;
+
+		double e0[3] = { (double)p1.x - p0.x, (double)p1.y - p0.y, (double)p1.z - p0.z };
+		double e1[3] = { (double)p2.x - p0.x, (double)p2.y - p0.y, (double)p2.z - p0.z };
+		double n[3] = { e0[1] * e1[2] - e0[2] * e1[1], e0[2] * e1[0] - e0[0] * e1[2], e0[0] * e1[1] - e0[1] * e1[0] };
+		double length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+		if (length <= 0.0) continue;
+
+		n[0] /= length; n[1] /= length; n[2] /= length;
+		double d = -(n[0] * p0.x + n[1] * p0.y + n[2] * p0.z);
+		double area = (length * 0.5);
+		for (int i = 0; i < 3; ++i) quadrics[position_of[tri[t * 3U + i]]].AddPlane(n[0], n[1], n[2], d, area);
+	}
+
+	// Lock every position on an open border, i.e. on an edge used by only one triangle, so that mesh outlines are preserved
+	std::vector<bool> locked(vertex_count, false);
+	{
+		std::unordered_map<unsigned long long, unsigned int> edge_use;
+		for (unsigned int t = 0U; t < triangle_count; ++t)
+		{
+			for (int i = 0; i < 3; ++i)
+			{
+				unsigned int a = position_of[tri[t * 3U + i]], b = position_of[tri[t * 3U + ((i + 1) % 3)]];
+				unsigned long long key = ((unsigned long long)(std::min)(a, b) << 32) | (unsigned long long)(std::max)(a, b);
+				++edge_use[key];
+			}
+		}
+
+		for (const auto & edge : edge_use)
+		{
+			if (edge.second != 1U) continue;
+			locked[(unsigned int)(edge.first >> 32)] = true;
+			locked[(unsigned int)(edge.first & 0xFFFFFFFFULL)] = true;
+		}
+	}
+
+	// Returns the vertex at the target position whose attributes most closely match the given vertex
+	auto resolve_wedge = [&](unsigned int v, unsigned int target_position) -> unsigned int
+	{
+		const auto & candidates = wedges[target_position];
+		if (candidates.size() == 1U) return candidates[0];
+
+		unsigned int best = candidates[0];
+		float best_distance = std::numeric_limits<float>::max();
+		const ModelData::TVertex & src = vertices[v];
+		for (unsigned int c : candidates)
+		{
+			const ModelData::TVertex & dst = vertices[c];
+			float dn[3] = { src.normal.x - dst.normal.x, src.normal.y - dst.normal.y, src.normal.z - dst.normal.z };
+			float dt[2] = { src.tex.x - dst.tex.x, src.tex.y - dst.tex.y };
+			float distance = (dn[0] * dn[0] + dn[1] * dn[1] + dn[2] * dn[2] + dt[0] * dt[0] + dt[1] * dt[1]);
+			if (distance < best_distance) { best_distance = distance; best = c; }
+		}
+		return best;
+	};
+
+	// Returns the unnormalised normal of the triangle, optionally with one position substituted
+	auto triangle_normal = [&](unsigned int t, unsigned int from, const XMFLOAT3 *to) -> XMFLOAT3
+	{
+		XMFLOAT3 p[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			INDEX_BUFFER_TYPE v = tri[t * 3U + i];
+			p[i] = ((to && position_of[v] == from) ? *to : vertices[v].position);
+		}
+		XMFLOAT3 e0(p[1].x - p[0].x, p[1].y - p[0].y, p[1].z - p[0].z), e1(p[2].x - p[0].x, p[2].y - p[0].y, p[2].z - p[0].z);
+		return XMFLOAT3(e0.y * e1.z - e0.z * e1.y, e0.z * e1.x - e0.x * e1.z, e0.x * e1.y - e0.y * e1.x);
+	};
+
+	struct Collapse
+	{
+		unsigned int		From, To;
+		double				Cost;
+	};
+
+	double max_cost = (double)target_error * (double)target_error;
+	double result_cost = 0.0;
+	std::vector<unsigned int> adjacency_offset(vertex_count + 1U), adjacency;
+	std::vector<Collapse> collapses;
+	std::vector<bool> touched(vertex_count);
+
+	// Each pass collapses the cheapest edges, with no position involved in more than one collapse per pass
+	while (live_triangles * 3U > target_index_count)
+	{
+		// Position -> live triangle adjacency for this pass
+		std::fill(adjacency_offset.begin(), adjacency_offset.end(), 0U);
+		for (unsigned int t = 0U; t < triangle_count; ++t)
+		{
+			if (dead[t]) continue;
+			for (int i = 0; i < 3; ++i) ++adjacency_offset[position_of[tri[t * 3U + i]] + 1U];
+		}
+		for (unsigned int v = 0U; v < vertex_count; ++v) adjacency_offset[v + 1U] += adjacency_offset[v];
+
+		adjacency.resize(adjacency_offset[vertex_count]);
+		std::vector<unsigned int> fill(adjacency_offset.begin(), adjacency_offset.end() - 1);
+		for (unsigned int t = 0U; t < triangle_count; ++t)
+		{
+			if (dead[t]) continue;
+			for (int i = 0; i < 3; ++i) adjacency[fill[position_of[tri[t * 3U + i]]]++] = t;
+		}
+
+		// Determine the cheapest direction of collapse for every edge.  Each edge is considered from both of its triangles,
+		// so only the instance with a < b is evaluated
+		collapses.clear();
+		for (unsigned int t = 0U; t < triangle_count; ++t)
+		{
+			if (dead[t]) continue;
+			for (int i = 0; i < 3; ++i)
+			{
+				unsigned int a = position_of[tri[t * 3U + i]], b = position_of[tri[t * 3U + ((i + 1) % 3)]];
+				if (a > b) std::swap(a, b);
+				if (locked[a] && locked[b]) continue;
+
+				Quadric q = quadrics[a];
+				q.Add(quadrics[b]);
+				double cost_ab = (locked[a] ? std::numeric_limits<double>::max() : q.Error(vertices[b].position));
+				double cost_ba = (locked[b] ? std::numeric_limits<double>::max() : q.Error(vertices[a].position));
+
+				if (cost_ab <= cost_ba)		collapses.push_back({ a, b, cost_ab });
+				else						collapses.push_back({ b, a, cost_ba });
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse & c0, const Collapse & c1) { return (c0.Cost < c1.Cost); });
+		collapses.erase(std::unique(collapses.begin(), collapses.end(), [](const Collapse & c0, const Collapse & c1)
+			{ return (c0.From == c1.From && c0.To == c1.To); }), collapses.end());
+
+		// Apply collapses in order of cost until the target is reached
+		std::fill(touched.begin(), touched.end(), false);
+		unsigned int applied = 0U;
+		for (const Collapse & collapse : collapses)
+		{
+			if (collapse.Cost > max_cost || live_triangles * 3U <= target_index_count) break;
+			if (touched[collapse.From] || touched[collapse.To]) continue;
+
+			// Reject any collapse which would flip the orientation of a remaining triangle
+			const XMFLOAT3 & target = vertices[collapse.To].position;
+			bool valid = true;
+			for (unsigned int i = adjacency_offset[collapse.From]; i < adjacency_offset[collapse.From + 1U] && valid; ++i)
+			{
+				unsigned int t = adjacency[i];
+				if (dead[t]) continue;
+
+				bool contains_target = false;
+				for (int k = 0; k < 3; ++k) contains_target |= (position_of[tri[t * 3U + k]] == collapse.To);
+				if (contains_target) continue;
+
+				XMFLOAT3 n0 = triangle_normal(t, collapse.From, NULL), n1 = triangle_normal(t, collapse.From, &target);
+				valid = ((n0.x * n1.x + n0.y * n1.y + n0.z * n1.z) > 0.0f);
+			}
+			if (!valid) continue;
+
+			// Move every triangle at the collapsed position onto the target position, removing those which become degenerate
+			for (unsigned int i = adjacency_offset[collapse.From]; i < adjacency_offset[collapse.From + 1U]; ++i)
+			{
+				unsigned int t = adjacency[i];
+				if (dead[t]) continue;
+
+				for (int k = 0; k < 3; ++k)
+				{
+					INDEX_BUFFER_TYPE & v = tri[t * 3U + k];
+					if (position_of[v] == collapse.From) v = resolve_wedge(v, collapse.To);
+				}
+
+				unsigned int p0 = position_of[tri[t * 3U]], p1 = position_of[tri[t * 3U + 1U]], p2 = position_of[tri[t * 3U + 2U]];
+				if (p0 == p1 || p1 == p2 || p0 == p2)
+				{
+					dead[t] = true;
+					--live_triangles;
+				}
+			}
+
+			quadrics[collapse.To].Add(quadrics[collapse.From]);
+			touched[collapse.From] = touched[collapse.To] = true;
+			result_cost = (std::max)(result_cost, collapse.Cost);
+			++applied;
+		}
+
+		if (applied == 0U) break;
+	}
+
+	out_indices.clear();
+	out_indices.reserve(live_triangles * 3U);
+	for (unsigned int t = 0U; t < triangle_count; ++t)
+	{
+		if (!dead[t]) out_indices.insert(out_indices.end(), tri.begin() + (t * 3U), tri.begin() + (t * 3U + 3U));
+	}
+
+	return (float)std::sqrt(result_cost);
+}
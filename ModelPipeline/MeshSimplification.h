@@ -0,0 +1,35 @@
+#pragma once
+
+#include <vector>
+#include "../Definitions/ModelData.h"
+
+
+// Offline simplification of triangle-list geometry by quadric error edge collapse, based on "Surface Simplification Using
+// Quadric Error Metrics" (Garland & Heckbert, 1997).  Vertices are only ever collapsed onto an existing vertex, so that the
+// result can index the original vertex data directly.  Vertices sharing a position are simplified together, with each
+// collapsed vertex taking the attributes of the closest matching vertex at its new position.  Open mesh borders are preserved
+class MeshSimplification
+{
+public:
+
+	// Simplifies the index data towards the target index count, without exceeding the given error.  Returns the maximum error
+	// of the simplified mesh, as an absolute distance in model space.  Simplified indices reference the original vertex data
+	static float								Simplify(const INDEX_BUFFER_TYPE *indices, unsigned int index_count, const ModelData::TVertex *vertices,
+														 unsigned int vertex_count, unsigned int target_index_count, float target_error,
+														 std::vector<INDEX_BUFFER_TYPE> & out_indices);
+
+private:
+
+	// Symmetric 4x4 matrix representing the sum of squared distances to a set of planes, normalised by their total weight
+	struct Quadric
+	{
+		double									a2, ab, ac, ad, b2, bc, bd, c2, cd, d2, w;
+
+		Quadric(void) : a2(0.0), ab(0.0), ac(0.0), ad(0.0), b2(0.0), bc(0.0), bd(0.0), c2(0.0), cd(0.0), d2(0.0), w(0.0) { }
+
+		void									AddPlane(double a, double b, double c, double d, double weight);
+		void									Add(const Quadric & other);
+		double									Error(const XMFLOAT3 & p) const;
+	};
+
+};
@@ -0,0 +1,166 @@
+#include "CppUnitTest.h"
+using namespace Microsoft::VisualStudio::CppUnitTestFramework;
+
+#include <vector>
+#include <set>
+#include <map>
+#include <memory>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include "../Definitions/ModelData.h"
+#include "MeshSimplification.h"
+#include "PipelineStageGenerateLods.h"
+
+namespace UnitTests
+{
+	TEST_CLASS(MeshSimplificationTests)
+	{
+	private:
+
+		// Generates a grid of (rows x columns) quads over a surface of the given height amplitude, with an open border
+		static std::unique_ptr<ModelData> GenerateGrid(unsigned int rows, unsigned int columns, float amplitude)
+		{
+			std::unique_ptr<ModelData> model = std::make_unique<ModelData>();
+			unsigned int vertex_count = ((rows + 1U) * (columns + 1U)), index_count = (rows * columns * 6U);
+			model->AllocateVertexData(vertex_count);
+			model->AllocateIndexData(index_count);
+			model->VertexCount = vertex_count;
+			model->IndexCount = index_count;
+
+			for (unsigned int r = 0U; r <= rows; ++r)
+			{
+				for (unsigned int c = 0U; c <= columns; ++c)
+				{
+					ModelData::TVertex & v = model->VertexData[(r * (columns + 1U)) + c];
+					v.position = XMFLOAT3((float)c, amplitude * std::sin(c * 0.4f) * std::cos(r * 0.3f), (float)r);
+					v.normal = XMFLOAT3(0.0f, 1.0f, 0.0f);
+					v.tex = XMFLOAT2((float)c / (float)columns, (float)r / (float)rows);
+				}
+			}
+
+			// Triangles are wound so that their normals face +y
+			for (unsigned int r = 0U, i = 0U; r < rows; ++r)
+			{
+				for (unsigned int c = 0U; c < columns; ++c)
+				{
+					INDEX_BUFFER_TYPE v0 = (r * (columns + 1U)) + c, v1 = v0 + 1U, v2 = v0 + (columns + 1U), v3 = v2 + 1U;
+					model->IndexData[i++] = v0; model->IndexData[i++] = v2; model->IndexData[i++] = v1;
+					model->IndexData[i++] = v1; model->IndexData[i++] = v2; model->IndexData[i++] = v3;
+				}
+			}
+
+			model->RecalculateDerivedData();
+			return model;
+		}
+
+		static std::vector<INDEX_BUFFER_TYPE> Simplify(const ModelData & model, unsigned int target_index_count, float target_error, float *out_error = NULL)
+		{
+			std::vector<INDEX_BUFFER_TYPE> indices;
+			float error = MeshSimplification::Simplify(model.IndexData, model.IndexCount, model.VertexData, model.VertexCount, target_index_count, target_error, indices);
+			if (out_error) *out_error = error;
+			return indices;
+		}
+
+		static XMFLOAT3 TriangleNormal(const ModelData & model, const INDEX_BUFFER_TYPE *triangle)
+		{
+			const XMFLOAT3 & p0 = model.VertexData[triangle[0]].position, & p1 = model.VertexData[triangle[1]].position, & p2 = model.VertexData[triangle[2]].position;
+			XMFLOAT3 e0(p1.x - p0.x, p1.y - p0.y, p1.z - p0.z), e1(p2.x - p0.x, p2.y - p0.y, p2.z - p0.z);
+			return XMFLOAT3(e0.y * e1.z - e0.z * e1.y, e0.z * e1.x - e0.x * e1.z, e0.x * e1.y - e0.y * e1.x);
+		}
+
+		// Returns every edge which is used by only one triangle, as an ordered pair of vertex indices
+		static std::set<std::pair<INDEX_BUFFER_TYPE, INDEX_BUFFER_TYPE>> DetermineBorderEdges(const std::vector<INDEX_BUFFER_TYPE> & indices)
+		{
+			std::map<std::pair<INDEX_BUFFER_TYPE, INDEX_BUFFER_TYPE>, unsigned int> edge_use;
+			for (size_t t = 0U; t < indices.size(); t += 3U)
+			{
+				for (size_t i = 0U; i < 3U; ++i)
+				{
+					INDEX_BUFFER_TYPE a = indices[t + i], b = indices[t + ((i + 1U) % 3U)];
+					++edge_use[{ (std::min)(a, b), (std::max)(a, b) }];
+				}
+			}
+
+			std::set<std::pair<INDEX_BUFFER_TYPE, INDEX_BUFFER_TYPE>> border;
+			for (const auto & edge : edge_use)
+			{
+				if (edge.second == 1U) border.insert(edge.first);
+			}
+			return border;
+		}
+
+	public:
+
+		TEST_METHOD(SimplificationReachesTargetTriangleCount)
+		{
+			std::unique_ptr<ModelData> model = GenerateGrid(32U, 32U, 1.0f);
+			const unsigned int targets[] = { model->IndexCount / 2U / 3U * 3U, model->IndexCount / 4U / 3U * 3U };
+			for (unsigned int target : targets)
+			{
+				std::vector<INDEX_BUFFER_TYPE> indices = Simplify(*model, target, 1000.0f);
+				Assert::IsTrue(!indices.empty() && (indices.size() % 3U) == 0U, L"Simplification did not produce a valid triangle list");
+				Assert::IsTrue(indices.size() <= target, L"Simplification did not reach the target triangle count");
+			}
+
+			// A mesh already within the target should be returned unchanged
+			std::vector<INDEX_BUFFER_TYPE> unchanged = Simplify(*model, model->IndexCount, 1000.0f);
+			Assert::IsTrue(unchanged.size() == model->IndexCount && std::equal(unchanged.begin(), unchanged.end(), model->IndexData),
+				L"Mesh within target triangle count was modified by simplification");
+		}
+
+		TEST_METHOD(SimplificationPreservesBorderVertices)
+		{
+			std::unique_ptr<ModelData> model = GenerateGrid(24U, 24U, 1.0f);
+			std::vector<INDEX_BUFFER_TYPE> source(model->IndexData, model->IndexData + model->IndexCount);
+			std::vector<INDEX_BUFFER_TYPE> indices = Simplify(*model, model->IndexCount / 8U / 3U * 3U, 1000.0f);
+			Assert::IsTrue(indices.size() < model->IndexCount, L"Mesh was not simplified");
+
+			// Every vertex on the open border of the grid must remain in place, joined by the same border edges
+			Assert::IsTrue(DetermineBorderEdges(indices) == DetermineBorderEdges(source), L"Open mesh border was modified by simplification");
+		}
+
+		TEST_METHOD(SimplificationDoesNotFlipTriangles)
+		{
+			// Simplify a planar grid aggressively, where every collapse has zero error, so that only the orientation test
+			// prevents triangles from folding over
+			std::unique_ptr<ModelData> model = GenerateGrid(24U, 24U, 0.0f);
+			std::vector<INDEX_BUFFER_TYPE> indices = Simplify(*model, 0U, 1000.0f);
+			Assert::IsTrue(!indices.empty() && indices.size() < model->IndexCount, L"Mesh was not simplified");
+
+			unsigned int flipped = 0U;
+			for (size_t t = 0U; t < indices.size(); t += 3U)
+			{
+				if (TriangleNormal(*model, &(indices[t])).y <= 0.0f) ++flipped;
+			}
+			Assert::AreEqual(0U, flipped, L"Simplification flipped or collapsed the orientation of triangles");
+
+			// The simplified mesh should cover the same area as the source
+			float area = 0.0f;
+			for (size_t t = 0U; t < indices.size(); t += 3U) area += (0.5f * TriangleNormal(*model, &(indices[t])).y);
+			Assert::AreEqual(24.0f * 24.0f, area, 1e-2f, L"Simplified planar mesh does not cover the source area");
+		}
+
+		TEST_METHOD(LodErrorIncreasesAlongChain)
+		{
+			std::unique_ptr<ModelData> model = GenerateGrid(32U, 32U, 2.0f);
+			model = PipelineStageGenerateLods(3U, 0.5f, 1.0f).Transform(std::move(model));
+
+			Assert::AreEqual((size_t)3U, model->Lods.size(), L"Incorrect number of LODs generated");
+			Assert::AreEqual(0.0f, model->LodError, L"Full-detail mesh should have no LOD error");
+
+			float previous_error = 0.0f;
+			unsigned int previous_count = model->IndexCount;
+			for (const auto & lod : model->Lods)
+			{
+				Assert::IsTrue(lod->IndexCount < previous_count, L"LOD does not have fewer triangles than the previous level");
+				Assert::IsTrue(lod->LodError > previous_error, L"LOD error does not increase along the LOD chain");
+				Assert::IsTrue(lod->LodError <= 1.0f, L"LOD error exceeds the configured maximum");
+
+				previous_error = lod->LodError;
+				previous_count = lod->IndexCount;
+			}
+		}
+
+	};
+}
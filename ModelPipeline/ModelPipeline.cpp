@@ -1,5 +1,6 @@
 #include "targetver.h"
 #include <vector>
+#include <algorithm>
 #include <tuple>
 #include <stdio.h>
 #include <iostream>
@@ -7,6 +8,9 @@
 #include <assimp\postprocess.h>
 #include <assimp\DefaultLogger.hpp>
 #include "PipelineUtil.h"
+#include "PipelineLog.h"
+#include "BatchTransform.h"
+#include "BuildCache.h"
 #include "AssimpLogStream.h"
 #include "TransformResult.h"
 #include "ModelPipelineConstants.h"
@@ -22,6 +26,10 @@
 #include "PipelineStageCentreModel.h"
 #include "PipelineStageAssimpTransform.h"
 #include "PipelineStageDirectPostprocess.h"
+#include "PipelineStageOptimiseVertexCache.h"
+#include "PipelineStageOptimiseOverdraw.h"
+#include "PipelineStageOptimiseVertexFetch.h"
+#include "PipelineStageGenerateLods.h"
 
 
 static const std::vector<std::tuple<std::string, std::string, PostProcess>> MESH_OPERATIONS 
@@ -52,7 +60,9 @@ static const std::vector<std::tuple<std::string, std::string, PostProcess>> MESH
 	{ "validation", "Perform validation of model data during transformation; enabled by default", (PostProcess)aiPostProcessSteps::aiProcess_ValidateDataStructure }, 
 	{ "invert-u", "Invert all U coordinates of the mesh UV mapping (i.e. u' = (1.0f - u)", (PostProcess)CustomPostProcess::InvertU },
 	{ "invert-v", "Invert all V coordinates of the mesh UV mapping (i.e. v' = (1.0f - v)", (PostProcess)CustomPostProcess::InvertV }, 
-	{ "custom-transform", "Apply a custom transformation given in \"<modelfile>.transform\" to the model geometry", (PostProcess)CustomPostProcess::CustomTransform }
+	{ "custom-transform", "Apply a custom transformation given in \"<modelfile>.transform\" to the model geometry", (PostProcess)CustomPostProcess::CustomTransform },
+	{ "optimise-vertex-cache", "Reorder triangles for vertex cache efficiency (Forsyth) and vertices for fetch locality", (PostProcess)CustomPostProcess::OptimiseVertexCache },
+	{ "optimise-overdraw", "Reorder triangles to reduce overdraw; implies \"optimise-vertex-cache\"", (PostProcess)CustomPostProcess::OptimiseOverdraw }
 };
 
 
@@ -108,7 +118,7 @@ void ReadArgsFromFile(const std::string & file, std::vector<std::string> & argsv
 	fs::path argfile(file);
 	if (!fs::exists(argfile))
 	{
-		std::cerr << "Cannot load args from external file \"" << fs::absolute(argfile) << "\"; file does not exist\n";
+		PipelineLog::Error() << "Cannot load args from external file \"" << fs::absolute(argfile) << "\"; file does not exist\n";
 		return;
 	}
 
@@ -132,7 +142,7 @@ void ReadArgsFromFile(const std::string & file, std::vector<std::string> & argsv
 		argsvector.insert(argsvector.end(), args.begin(), args.end());
 	}
 
-	std::cout << "Loaded " << args.size() << " arguments from file \"" << fs::absolute(argfile) << "\"\n";
+	PipelineLog::Info() << "Loaded " << args.size() << " arguments from file \"" << fs::absolute(argfile) << "\"\n";
 }
 
 PostProcess AddModelSpecificOperations(fs::path model_file, PostProcess current_operations)
@@ -141,7 +151,7 @@ PostProcess AddModelSpecificOperations(fs::path model_file, PostProcess current_
 
 	fs::path config_file = fs::path(fs::absolute(model_file).string() + ".pipeline");
 	if (!fs::exists(config_file)) return 0U;
-	std::cout << "Model \"" << model_file.filename().string() << "\" has model-specific operation config\n";
+	PipelineLog::Info() << "Model \"" << model_file.filename().string() << "\" has model-specific operation config\n";
 
 	std::vector<std::string> args;
 	ReadArgsFromFile(fs::absolute(config_file).string(), args);
@@ -160,12 +170,12 @@ PostProcess AddModelSpecificOperations(fs::path model_file, PostProcess current_
 			{
 				if (add_next)
 				{
-					std::cout << "Adding model-specific operation for \"" << model_file.filename().string() << "\" of \"" << arg << "\" (" << op << ")\n";
+					PipelineLog::Info() << "Adding model-specific operation for \"" << model_file.filename().string() << "\" of \"" << arg << "\" (" << op << ")\n";
 					operations |= op;
 				}
 				else if (skip_next)
 				{
-					std::cout << "Excluding model-specific operation for \"" << model_file.filename().string() << "\" of \"" << arg << "\" (" << op << ")\n";
+					PipelineLog::Info() << "Excluding model-specific operation for \"" << model_file.filename().string() << "\" of \"" << arg << "\" (" << op << ")\n";
 					operations &= ~op;
 				}
 			}
@@ -173,29 +183,58 @@ PostProcess AddModelSpecificOperations(fs::path model_file, PostProcess current_
 		}
 	}
 
-	if (operations != current_operations)		std::cout << "Operations set updated from " << current_operations << " to " << operations << " by model-specific config\n";
-	else										std::cout << "Operation set remains unchanged at " << operations << " after applying model-specific config\n";
+	if (operations != current_operations)		PipelineLog::Info() << "Operations set updated from " << current_operations << " to " << operations << " by model-specific config\n";
+	else										PipelineLog::Info() << "Operation set remains unchanged at " << operations << " after applying model-specific config\n";
 
 	return operations;
 }
 
-TransformResult ObjToRjm(const std::string & input, const std::string & target, PostProcess operations)
+// Appends mesh optimisation stages as required by the operation set.  Overdraw ordering operates on cache-optimised index 
+// data, and vertex data is always reordered to follow any change in index order
+TransformPipelineBuilder & WithMeshOptimisation(TransformPipelineBuilder & builder, PostProcess operations)
+{
+	bool overdraw = ((operations & (PostProcess)CustomPostProcess::OptimiseOverdraw) == (PostProcess)CustomPostProcess::OptimiseOverdraw);
+	bool vertex_cache = overdraw || ((operations & (PostProcess)CustomPostProcess::OptimiseVertexCache) == (PostProcess)CustomPostProcess::OptimiseVertexCache);
+	if (!vertex_cache) return builder;
+
+	builder.WithPipelineStage(std::move(std::make_unique<PipelineStageOptimiseVertexCache>()));
+	if (overdraw) builder.WithPipelineStage(std::move(std::make_unique<PipelineStageOptimiseOverdraw>()));
+	builder.WithPipelineStage(std::move(std::make_unique<PipelineStageOptimiseVertexFetch>()));
+
+	return builder;
+}
+
+// Appends generation of the given number of LOD levels, if any.  Must precede mesh optimisation so that each LOD is also optimised
+TransformPipelineBuilder & WithLodGeneration(TransformPipelineBuilder & builder, unsigned int lods)
+{
+	if (lods == 0U) return builder;
+
+	return builder.WithPipelineStage(std::move(std::make_unique<PipelineStageGenerateLods>(lods)));
+}
+
+TransformResult ObjToRjm(const std::string & input, const std::string & target, PostProcess operations, unsigned int lods = 0U, bool compress = false, ModelSizeProperties *out_metadata = NULL, BuildCache *cache = NULL, bool *out_up_to_date = NULL)
 {
 	// Append any model-specific operations if they exist
 	operations = AddModelSpecificOperations(fs::path(input), operations);
 
-	// Basic pipeline configuration
-	std::unique_ptr<TransformPipeline> pipeline = TransformPipelineBuilder()
+	// Basic pipeline configuration, with LOD generation and mesh optimisation stages if required
+	TransformPipelineBuilder builder;
+	builder
 		.WithInputTransformer(std::move(std::make_unique<InputTransformerAssimp>(operations)))
 		.WithPipelineStage(std::move(std::make_unique<PipelineStageDirectPostprocess>(operations, input)))
 		.WithPipelineStage(std::move(std::make_unique<PipelineStageCentreModel>()))
-		.WithPipelineStage(std::move(std::make_unique<PipelineStageUnitScaleModel>()))
+		.WithPipelineStage(std::move(std::make_unique<PipelineStageUnitScaleModel>()));
+
+	std::unique_ptr<TransformPipeline> pipeline = WithMeshOptimisation(WithLodGeneration(builder, lods), operations)
 		.WithPipelineStage(std::move(std::make_unique<PipelineStageOutputModelInfo>()))
-		.WithOutputTransformer(std::move(std::make_unique<BinaryOutputTransform>()))
+		.WithOutputTransformer(std::move(std::make_unique<BinaryOutputTransform>(compress)))
+		.WithBuildCache(cache)
 		.Build();
 
 	// Execute the transformation pipeline
 	pipeline->Transform(fs::path(input), fs::path(target));
+	if (out_metadata) *out_metadata = pipeline->GetModelMetadata();
+	if (out_up_to_date) *out_up_to_date = pipeline->WasUpToDate();
 	
 	// For testing
 	// auto m = ModelData::Deserialize(PipelineUtil::ReadBinaryFile(fs::path("C:\\Users\\robje\\Downloads\\capsule.out")));
@@ -204,26 +243,18 @@ TransformResult ObjToRjm(const std::string & input, const std::string & target,
 	return TransformResult::Single(!pipeline.get()->HasErrors());
 }
 
-TransformResult ObjToRjmBulk(std::vector<std::string> & input, PostProcess operations)
+TransformResult ObjToRjmBulk(std::vector<std::string> & input, PostProcess operations, unsigned int lods, bool compress, BatchTransform & batch, BuildCache *cache = NULL)
 {
-	TransformResult result;
-
-	// Execute the transformation pipeline
-	std::cout << "Performing bulk transformation\n";
-	int index = 0;
-	for (const std::string & in : input)
+	// Execute the transformation pipeline for each file in parallel
+	return batch.Execute(input, [operations, lods, compress, cache](const std::string & in, ModelSizeProperties & metadata, bool & up_to_date)
 	{
 		fs::path in_path(in);
-		std::cout << "\nProcessing file " << ++index << " of " << input.size() << " (" << fs::absolute(in) << ")\n";
-
 		fs::path target(fs::absolute(in_path.parent_path()).string() + "/" + in_path.stem().string() + ".rjm");
-		result += ObjToRjm(in, target.string(), operations);
-	}
-
-	return result;
+		return (ObjToRjm(in, target.string(), operations, lods, compress, &metadata, cache, &up_to_date).Failure == 0U);
+	});
 }
 
-TransformResult RjmToObj(const std::string & input, const std::string & target, const std::string & generate_material, PostProcess operations)
+TransformResult RjmToObj(const std::string & input, const std::string & target, const std::string & generate_material, PostProcess operations, ModelSizeProperties *out_metadata = NULL, BuildCache *cache = NULL, bool *out_up_to_date = NULL)
 {
 	// Basic pipeline configuration
 	std::unique_ptr<TransformPipeline> pipeline = TransformPipelineBuilder()
@@ -233,51 +264,51 @@ TransformResult RjmToObj(const std::string & input, const std::string & target,
 		.WithPipelineStage(std::move(std::make_unique<PipelineStageUnitScaleModel>()))
 		.WithPipelineStage(std::move(std::make_unique<PipelineStageOutputModelInfo>()))
 		.WithOutputTransformer(std::move(std::make_unique<ObjFormatOutputTransform>(generate_material)))
+		.WithBuildCache(cache)
 		.Build();
 
 	// Execute the transformation pipeline
 	pipeline->Transform(fs::path(input), fs::path(target));
+	if (out_metadata) *out_metadata = pipeline->GetModelMetadata();
+	if (out_up_to_date) *out_up_to_date = pipeline->WasUpToDate();
 
 	// Return the overall transform result
 	return TransformResult::Single(!pipeline.get()->HasErrors());
 }
 
-TransformResult RjmToObjBulk(std::vector<std::string> & input, const std::string & generate_material, PostProcess operations)
+TransformResult RjmToObjBulk(std::vector<std::string> & input, const std::string & generate_material, PostProcess operations, BatchTransform & batch, BuildCache *cache = NULL)
 {
-	TransformResult result;
-
-	// Exectute the transformation pipeline
-	std::cout << "Performing bulk transformation\n";
-	int index = 0;
-	for (const std::string & in : input)
+	// Execute the transformation pipeline for each file in parallel
+	return batch.Execute(input, [&generate_material, operations, cache](const std::string & in, ModelSizeProperties & metadata, bool & up_to_date)
 	{
 		fs::path in_path(in);
-		std::cout << "\nProcessing file " << ++index << " of " << input.size() << " (" << fs::absolute(in) << ")\n";
-
 		fs::path target(fs::absolute(in_path.parent_path()).string() + "/" + in_path.stem().string() + ".out");
-		result += RjmToObj(in, target.string(), generate_material, operations);
-	}
-
-	return result;
+		return (RjmToObj(in, target.string(), generate_material, operations, &metadata, cache, &up_to_date).Failure == 0U);
+	});
 }
 
-TransformResult ProcessRjm(const std::string & input, const std::string & target, PostProcess operations, bool in_place = false, bool in_place_backup = true)
+// Build cache is only applicable to transforms with a separate target, since in-place transforms modify their own input
+TransformResult ProcessRjm(const std::string & input, const std::string & target, PostProcess operations, unsigned int lods = 0U, bool compress = false, bool in_place = false, bool in_place_backup = true, ModelSizeProperties *out_metadata = NULL, BuildCache *cache = NULL, bool *out_up_to_date = NULL)
 {
 	TransformResult result;
 
 	// Append any model-specific operations if they exist
 	operations = AddModelSpecificOperations(fs::path(input), operations);
 
-	// Basic pipeline configuration
-	std::unique_ptr<TransformPipeline> pipeline = TransformPipelineBuilder()
+	// Basic pipeline configuration, with LOD generation and mesh optimisation stages if required.  Model info is reported before and after transformation
+	TransformPipelineBuilder builder;
+	builder
 		.WithInputTransformer(std::move(std::make_unique<InputTransformerRjm>()))
 		.WithPipelineStage(std::move(std::make_unique<PipelineStageDirectPostprocess>(operations, input)))
 		.WithPipelineStage(std::move(std::make_unique<PipelineStageOutputModelInfo>()))
 		.WithPipelineStage(std::move(std::make_unique<PipelineStageCentreModel>()))
 		.WithPipelineStage(std::move(std::make_unique<PipelineStageUnitScaleModel>()))
-		.WithPipelineStage(std::move(std::make_unique<PipelineStageAssimpTransform>(operations)))
+		.WithPipelineStage(std::move(std::make_unique<PipelineStageAssimpTransform>(operations)));
+
+	std::unique_ptr<TransformPipeline> pipeline = WithMeshOptimisation(WithLodGeneration(builder, lods), operations)
 		.WithPipelineStage(std::move(std::make_unique<PipelineStageOutputModelInfo>()))
-		.WithOutputTransformer(std::move(std::make_unique<BinaryOutputTransform>()))
+		.WithOutputTransformer(std::move(std::make_unique<BinaryOutputTransform>(compress)))
+		.WithBuildCache(in_place ? NULL : cache)
 		.Build();
 
 	// Target depends on whether this is in-place or not
@@ -286,6 +317,8 @@ TransformResult ProcessRjm(const std::string & input, const std::string & target
 		// Exectute the transformation pipeline
 		pipeline->Transform(fs::path(input), fs::path(target));
 		result = TransformResult::Single(!pipeline.get()->HasErrors());
+		if (out_metadata) *out_metadata = pipeline->GetModelMetadata();
+		if (out_up_to_date) *out_up_to_date = pipeline->WasUpToDate();
 	}
 	else
 	{
@@ -296,11 +329,12 @@ TransformResult ProcessRjm(const std::string & input, const std::string & target
 		// Transform
 		pipeline->Transform(in, out);
 		result = TransformResult::Single(!pipeline.get()->HasErrors());
+		if (out_metadata) *out_metadata = pipeline->GetModelMetadata();
 
 		// Check whether the transformation succeeded
 		if (!fs::exists(out))
 		{
-			std::cerr << "RJM transformation failed\n";
+			PipelineLog::Error() << "RJM transformation failed\n";
 			result = TransformResult::SingleFailure();
 		}
 		else
@@ -323,24 +357,16 @@ TransformResult ProcessRjm(const std::string & input, const std::string & target
 	return result;
 }
 
-TransformResult ProcessRjmBulk(std::vector<std::string> & input, PostProcess operations, bool in_place = false, bool in_place_backup = true)
+TransformResult ProcessRjmBulk(std::vector<std::string> & input, PostProcess operations, unsigned int lods, bool compress, BatchTransform & batch, bool in_place = false, bool in_place_backup = true, BuildCache *cache = NULL)
 {
-	TransformResult result;
-
-	// Exectute the transformation pipeline
-	std::cout << "Performing bulk transformation\n";
-	int index = 0;
-	for (const std::string & in : input)
+	// Execute the transformation pipeline for each file in parallel
+	return batch.Execute(input, [operations, lods, compress, in_place, in_place_backup, cache](const std::string & in, ModelSizeProperties & metadata, bool & up_to_date)
 	{
-		fs::path in_path(in);
-		std::cout << "\nProcessing file " << ++index << " of " << input.size() << " (" << fs::absolute(in) << ")\n";
-
 		// Target is only relevant if this is not an in-place swap
+		fs::path in_path(in);
 		std::string target = (in_place ? "" : (fs::absolute(in_path.parent_path()).string() + "/" + in_path.stem().string() + ".out"));
-		result += ProcessRjm(in, target, operations, in_place, in_place_backup);
-	}
-
-	return result;
+		return (ProcessRjm(in, target, operations, lods, compress, in_place, in_place_backup, &metadata, cache, &up_to_date).Failure == 0U);
+	});
 }
 
 
@@ -457,6 +483,17 @@ void PrintUsage()
 
 	std::cout << "   -skip <operation>\tSkip the given operation, where <operation> may be any value available to \"-op\"\n";
 	std::cout << "   -args <file>\t\tArguments will be read from the given external file\n";
+	std::cout << "   -manifest <file>\tAdds every input file listed in the given manifest, one per line.  Implies n=bulk\n";
+	std::cout << "   -dir <path>\t\tAdds every applicable input file within the given directory hierarchy.  Implies n=bulk\n";
+	std::cout << "   -threads <count>\tNumber of files transformed concurrently if n=bulk.  Default=0 (one per hardware thread)\n";
+	std::cout << "   -summary <file>\tWrites a summary of all bulk results, including model metadata, to the given file\n";
+	std::cout << "   -cache <file>\t\tSkips any model whose input, pipeline configuration and outputs are unchanged since the\n";
+	std::cout << "\t\t\tbuild recorded in the given cache file.  Not applicable if ot=inplace\n";
+	std::cout << "   -rebuild <bool>\tIgnores all existing entries in the build cache, rebuilding every model.  Default=false\n";
+	std::cout << "   -lods <count>\tGenerates up to the given number of simplified LOD meshes for each model.  Not applicable\n";
+	std::cout << "\t\t\tif -type=rjm-to-obj.  Default=0\n";
+	std::cout << "   -compress <bool>\tWrites compressed mesh data, with quantised vertex attributes and delta-encoded\n";
+	std::cout << "\t\t\tindices.  Not applicable if -type=rjm-to-obj.  Default=false\n";
 	std::cout << "\n";
 }
 
@@ -476,6 +513,13 @@ int main(int argc, const char *argv[])
 	bool inplace = false;
 	bool inplace_backup = true;
 	bool bulk = false;
+	unsigned int threads = 0U;
+	std::string summary_file = "";
+	std::string cache_file = "";
+	bool rebuild = false;
+	unsigned int lods = 0U;
+	bool compress = false;
+	std::vector<std::string> manifests, directories;
 	PostProcess operations = AssimpIntegration::DefaultOperations();
 
 	// Arguments vector
@@ -496,6 +540,14 @@ int main(int argc, const char *argv[])
 		else if (key == "-mat")					gen_mat = val;
 		else if (key == "-log")					SetLogging(val);
 		else if (key == "-args")				ReadArgsFromFile(val, args, i + 2U);
+		else if (key == "-manifest")			{ manifests.push_back(val); bulk = true; }
+		else if (key == "-dir")					{ directories.push_back(val); bulk = true; }
+		else if (key == "-threads")				threads = (unsigned int)std::max(0, std::atoi(val.c_str()));
+		else if (key == "-summary")				summary_file = val;
+		else if (key == "-cache")				cache_file = val;
+		else if (key == "-rebuild")				rebuild = (val == "true");
+		else if (key == "-lods")				lods = (unsigned int)std::max(0, std::atoi(val.c_str()));
+		else if (key == "-compress")			compress = (val == "true");
 		else if (key == "-op" || key == "-skip")
 		{
 			auto op = GetOperation(val);
@@ -520,6 +572,26 @@ int main(int argc, const char *argv[])
 		else std::cerr << "Unrecognised argument \"" << key << "\"; ignoring\n";
 	}
 
+	// Collect any batch inputs; directory searches depend on the input type of the requested operation
+	for (const auto & manifest : manifests)
+	{
+		auto files = BatchTransform::ReadManifest(fs::path(manifest));
+		input.insert(input.end(), files.begin(), files.end());
+	}
+	for (const auto & dir : directories)
+	{
+		auto files = BatchTransform::FindInputFiles(fs::path(dir), (type == "obj-to-rjm" ? ".obj" : ".rjm"));
+		input.insert(input.end(), files.begin(), files.end());
+	}
+
+	// Assimp logging is not thread-safe, so batches must be executed serially when it is enabled
+	if (bulk && threads != 1U && ModelPipelineConstants::LogLevel != ModelPipelineConstants::LoggingType::Normal)
+	{
+		std::cout << "Verbose logging is enabled; bulk transformation will be single-threaded\n";
+		threads = 1U;
+	}
+	BatchTransform batch(threads);
+
 	// Validate inputs
 	if (input.empty()) {								std::cerr << "No input file(s) provided (use -i)\n"; exit(1); }
 	else if (output.empty() && !(inplace || bulk)) {	std::cerr << "Ouptut file must be specified unless -ot=inplace or -n=bulk\n"; exit(1); }
@@ -527,22 +599,45 @@ int main(int argc, const char *argv[])
 	// Output current operation set for info
 	std::cout << "Consolidated operation set: " << operations << "\n";
 
+	// Load the build cache, if one is in use
+	std::unique_ptr<BuildCache> cache;
+	if (!cache_file.empty())
+	{
+		cache = std::make_unique<BuildCache>(fs::path(cache_file));
+		if (rebuild)	{ std::cout << "Full rebuild requested; ignoring existing build cache\n"; cache->Clear(); }
+		else			cache->Load();
+	}
+
 	// Perform the requested operation
 	TransformResult result;
 	if (type == "process-rjm")
 	{
-		if (bulk)		result = ProcessRjmBulk(input, operations, inplace, inplace_backup);
-		else			result = ProcessRjm(input.at(0), output, operations, inplace, inplace_backup);
+		if (bulk)		result = ProcessRjmBulk(input, operations, lods, compress, batch, inplace, inplace_backup, cache.get());
+		else			result = ProcessRjm(input.at(0), output, operations, lods, compress, inplace, inplace_backup, NULL, cache.get());
 	}
 	else if (type == "obj-to-rjm")
 	{
-		if (bulk)		result = ObjToRjmBulk(input, operations);
-		else			result = ObjToRjm(input.at(0), output, operations);
+		if (bulk)		result = ObjToRjmBulk(input, operations, lods, compress, batch, cache.get());
+		else			result = ObjToRjm(input.at(0), output, operations, lods, compress, NULL, cache.get());
 	}
 	else if (type == "rjm-to-obj")
 	{
-		if (bulk)		result = RjmToObjBulk(input, gen_mat, operations);
-		else			result = RjmToObj(input.at(0), output, gen_mat, operations);
+		if (bulk)		result = RjmToObjBulk(input, gen_mat, operations, batch, cache.get());
+		else			result = RjmToObj(input.at(0), output, gen_mat, operations, NULL, cache.get());
+	}
+
+	// Persist any changes to the build cache
+	if (cache) cache->Save();
+
+	// Report a summary of all bulk results.  Model metadata for every file is only included if the summary is written to file
+	if (bulk)
+	{
+		std::cout << "\n" << batch.GenerateSummary(false);
+		if (!summary_file.empty())
+		{
+			PipelineUtil::WriteDataTofile(fs::path(summary_file), batch.GenerateSummary(true));
+			std::cout << "Batch summary written to \"" << fs::absolute(summary_file).string() << "\"\n";
+		}
 	}
 
 	// Report a status and any errors that occurred
@@ -8,6 +8,7 @@ class ObjFormatOutputTransform : public TransformPipelineOutput
 public:
 
 	inline std::string	GetName(void) const { return "ObjFormatOutputTransform"; }
+	inline std::string	GetConfiguration(void) const { return m_material; }
 
 	ObjFormatOutputTransform(const std::string & material_texture = "");
 
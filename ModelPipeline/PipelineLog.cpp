@@ -0,0 +1,46 @@
+#include <mutex>
+#include "PipelineLog.h"
+
+// Initialise static data
+thread_local bool PipelineLog::m_capturing = false;
+thread_local std::ostringstream PipelineLog::m_info;
+thread_local std::ostringstream PipelineLog::m_error;
+
+// Console writes are serialised so that blocks of captured output are never interleaved
+static std::mutex PipelineLogConsoleLock;
+
+
+std::ostream & PipelineLog::Info(void)
+{
+	return (m_capturing ? (std::ostream &)m_info : std::cout);
+}
+
+std::ostream & PipelineLog::Error(void)
+{
+	return (m_capturing ? (std::ostream &)m_error : std::cerr);
+}
+
+void PipelineLog::BeginCapture(void)
+{
+	m_info.str(""); m_info.clear();
+	m_error.str(""); m_error.clear();
+	m_capturing = true;
+}
+
+// Captured errors are appended after all other output, so that they are grouped at the end of the block
+std::string PipelineLog::EndCapture(std::string & out_errors)
+{
+	m_capturing = false;
+	out_errors = m_error.str();
+
+	std::string output = m_info.str() + out_errors;
+	m_info.str(""); m_error.str("");
+	return output;
+}
+
+void PipelineLog::Write(const std::string & output)
+{
+	std::lock_guard<std::mutex> lock(PipelineLogConsoleLock);
+	std::cout << output;
+	std::cout.flush();
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+
+// Destination for all pipeline output.  Output is written directly to the console by default.  A thread may instead 
+// capture its output, e.g. while transforming one file of a parallel batch, so that it can be written as one block once 
+// the file is complete rather than interleaved with the output of other threads
+class PipelineLog
+{
+public:
+
+	// Streams for informational and error output from the current thread
+	static std::ostream &				Info(void);
+	static std::ostream &				Error(void);
+
+	// Begin capturing all output from the current thread
+	static void							BeginCapture(void);
+
+	// Stop capturing output from the current thread.  Returns all captured output, with any errors also returned separately
+	// in 'out_errors'
+	static std::string					EndCapture(std::string & out_errors);
+
+	// Writes a block of output to the console in a single operation
+	static void							Write(const std::string & output);
+
+private:
+
+	// Capture buffers for the current thread; only valid while capture is active
+	static thread_local bool					m_capturing;
+	static thread_local std::ostringstream		m_info;
+	static thread_local std::ostringstream		m_error;
+
+};
@@ -10,6 +10,7 @@ public:
 	PipelineStageAssimpTransform(unsigned int operations = AssimpIntegration::DefaultOperations());
 
 	inline std::string						GetName(void) const { return "PipelineStageAssimpTransform"; }
+	inline std::string						GetConfiguration(void) const { return std::to_string(m_operations); }
 
 	std::unique_ptr<ModelData>				ExecuteTransform(std::unique_ptr<ModelData> model) const;
 
@@ -22,6 +22,19 @@ PipelineStageDirectPostprocess::PipelineStageDirectPostprocess(PostProcess opera
 {
 }
 
+// Custom transforms are read from a file alongside the model, so the transform data itself forms part of the configuration
+std::string PipelineStageDirectPostprocess::GetConfiguration(void) const
+{
+	std::string config = std::to_string(m_operations);
+	if ((m_operations & (PostProcess)CustomPostProcess::CustomTransform) == (PostProcess)CustomPostProcess::CustomTransform)
+	{
+		fs::path transform_file(m_modelpath + ".transform");
+		config += ";" + (fs::exists(transform_file) ? PipelineUtil::ReadFileToString(transform_file) : std::string("<none>"));
+	}
+
+	return config;
+}
+
 std::unique_ptr<ModelData> PipelineStageDirectPostprocess::ExecuteTransform(std::unique_ptr<ModelData> model) const
 {
 	ModelData *m = model.get();
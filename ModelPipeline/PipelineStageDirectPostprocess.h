@@ -16,6 +16,7 @@ public:
 
 
 	inline std::string						GetName(void) const { return "PipelineStageDirectPostprocess"; }
+	std::string								GetConfiguration(void) const;
 
 	std::unique_ptr<ModelData>				ExecuteTransform(std::unique_ptr<ModelData> model) const;
 
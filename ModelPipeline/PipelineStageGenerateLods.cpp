@@ -0,0 +1,98 @@
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <sstream>
+#include "MeshOptimisation.h"
+#include "MeshSimplification.h"
+#include "PipelineStageGenerateLods.h"
+
+const float PipelineStageGenerateLods::DEFAULT_REDUCTION = 0.5f;
+const float PipelineStageGenerateLods::DEFAULT_MAX_ERROR = 0.1f;
+const float PipelineStageGenerateLods::MIN_LEVEL_REDUCTION = 0.1f;
+
+
+PipelineStageGenerateLods::PipelineStageGenerateLods(unsigned int lod_count, float reduction, float max_error)
+	:
+	m_lod_count(lod_count),
+	m_reduction(reduction),
+	m_max_error(max_error)
+{
+}
+
+std::string PipelineStageGenerateLods::GetConfiguration(void) const
+{
+	std::ostringstream ss;
+	ss << m_lod_count << "," << m_reduction << "," << m_max_error;
+	return ss.str();
+}
+
+std::unique_ptr<ModelData> PipelineStageGenerateLods::ExecuteTransform(std::unique_ptr<ModelData> model) const
+{
+	ModelData *m = model.get();
+	if (!m) return model;
+
+	if (!m->VertexData || !MeshOptimisation::IsValidTriangleList(m->IndexData, m->IndexCount, m->VertexCount))
+	{
+		TRANSFORM_INFO << "Model does not contain valid triangle list data, no LODs generated\n";
+		return model;
+	}
+
+	// Errors are expressed relative to the model bounding radius so that they can be scaled by projected size at runtime
+	XMFLOAT3 size = m->SizeProperties.ModelSize;
+	float radius = 0.5f * std::sqrt((size.x * size.x) + (size.y * size.y) + (size.z * size.z));
+	if (radius <= 0.0f)
+	{
+		TRANSFORM_INFO << "Model has no spatial extent, no LODs generated\n";
+		return model;
+	}
+
+	// Each level is simplified directly from the full-detail mesh, so that error does not accumulate between levels
+	m->Lods.clear();
+	unsigned int previous_count = m->IndexCount;
+	float target = 1.0f;
+	for (unsigned int level = 1U; level <= m_lod_count; ++level)
+	{
+		target *= m_reduction;
+		unsigned int target_count = (unsigned int)(m->IndexCount * target) / 3U * 3U;
+
+		std::vector<INDEX_BUFFER_TYPE> indices;
+		float error = MeshSimplification::Simplify(m->IndexData, m->IndexCount, m->VertexData, m->VertexCount, 
+												   target_count, m_max_error * radius, indices) / radius;
+
+		if (indices.empty() || indices.size() > (size_t)(previous_count * (1.0f - MIN_LEVEL_REDUCTION)))
+		{
+			TRANSFORM_INFO << "Cannot simplify model beyond " << (previous_count / 3U) << " triangles within error limit of " 
+						   << m_max_error << "; generated " << m->Lods.size() << " LODs\n";
+			break;
+		}
+
+		// Each level holds a compacted copy of the vertices it references
+		std::vector<ModelData::TVertex> vertices(m->VertexData, m->VertexData + m->VertexCount);
+		unsigned int vertex_count = MeshOptimisation::OptimiseVertexFetch(vertices.data(), m->VertexCount, indices.data(), (unsigned int)indices.size());
+
+		std::unique_ptr<ModelData> lod = std::make_unique<ModelData>();
+		if (!lod->AllocateVertexData(vertex_count) || !lod->AllocateIndexData((unsigned int)indices.size()))
+		{
+			TRANSFORM_ERROR << "Failed to allocate data for LOD " << level << "\n";
+			break;
+		}
+
+		memcpy(lod->VertexData, vertices.data(), sizeof(ModelData::TVertex) * vertex_count);
+		memcpy(lod->IndexData, indices.data(), sizeof(INDEX_BUFFER_TYPE) * indices.size());
+		lod->VertexCount = vertex_count;
+		lod->IndexCount = (unsigned int)indices.size();
+		lod->ModelMaterialIndex = m->ModelMaterialIndex;
+		lod->LodError = error;
+
+		// Levels retain the bounds of the full-detail mesh so that model placement is unaffected by LOD selection
+		lod->SizeProperties = m->SizeProperties;
+
+		TRANSFORM_INFO << "Generated LOD " << level << " with " << (lod->IndexCount / 3U) << " triangles (" 
+					   << (100.0f * lod->IndexCount / m->IndexCount) << "%), " << vertex_count << " vertices, relative error " << error << "\n";
+
+		previous_count = lod->IndexCount;
+		m->Lods.push_back(std::move(lod));
+	}
+
+	return model;
+}
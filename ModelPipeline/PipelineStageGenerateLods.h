@@ -0,0 +1,32 @@
+#pragma once
+
+#include "../Definitions/ModelData.h"
+#include "PipelineStage.h"
+
+// Generates a chain of simplified level-of-detail meshes from the model geometry, each targeting a fixed proportion of the 
+// triangles in the previous level.  Generation stops early once the mesh cannot be simplified further within the error limit
+class PipelineStageGenerateLods : public PipelineStage
+{
+public:
+
+	static const unsigned int				DEFAULT_LOD_COUNT = 3U;
+	static const float						DEFAULT_REDUCTION;			// Proportion of triangles retained at each successive level
+	static const float						DEFAULT_MAX_ERROR;			// Maximum error at any level, relative to the model bounding radius
+
+	PipelineStageGenerateLods(unsigned int lod_count = DEFAULT_LOD_COUNT, float reduction = DEFAULT_REDUCTION, float max_error = DEFAULT_MAX_ERROR);
+
+	inline std::string						GetName(void) const { return "PipelineStageGenerateLods"; }
+	std::string								GetConfiguration(void) const;
+
+	std::unique_ptr<ModelData>				ExecuteTransform(std::unique_ptr<ModelData> model) const;
+
+private:
+
+	// Levels which do not remove at least this proportion of the previous level's triangles are discarded
+	static const float						MIN_LEVEL_REDUCTION;
+
+	unsigned int							m_lod_count;
+	float									m_reduction;
+	float									m_max_error;
+
+};
@@ -0,0 +1,39 @@
+#include "PipelineStageOptimiseOverdraw.h"
+
+
+PipelineStageOptimiseOverdraw::PipelineStageOptimiseOverdraw(float threshold)
+	:
+	m_threshold(threshold)
+{
+}
+
+std::unique_ptr<ModelData> PipelineStageOptimiseOverdraw::ExecuteTransform(std::unique_ptr<ModelData> model) const
+{
+	ModelData *m = model.get();
+	if (!m) return model;
+
+	// Any LOD meshes are optimised independently of the full-detail mesh
+	OptimiseMesh(m, "Model");
+	for (size_t i = 0U; i < m->Lods.size(); ++i)
+	{
+		OptimiseMesh(m->Lods[i].get(), "LOD " + std::to_string(i + 1U));
+	}
+
+	return model;
+}
+
+void PipelineStageOptimiseOverdraw::OptimiseMesh(ModelData *m, const std::string & name) const
+{
+	if (!m->VertexData || !MeshOptimisation::IsValidTriangleList(m->IndexData, m->IndexCount, m->VertexCount))
+	{
+		TRANSFORM_INFO << name << " does not contain valid triangle list data, no modifications applied\n";
+		return;
+	}
+
+	auto before = MeshOptimisation::CalculateCacheMetrics(m->IndexData, m->IndexCount, m->VertexCount);
+	MeshOptimisation::OptimiseOverdraw(m->IndexData, m->IndexCount, m->VertexData, m->VertexCount, m_threshold);
+	auto after = MeshOptimisation::CalculateCacheMetrics(m->IndexData, m->IndexCount, m->VertexCount);
+
+	TRANSFORM_INFO << name << " triangles reordered to reduce overdraw with ACMR threshold " << m_threshold << "; ACMR " << before.ACMR << " -> " << after.ACMR
+				   << ", ATVR " << before.ATVR << " -> " << after.ATVR << "\n";
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "../Definitions/ModelData.h"
+#include "PipelineStage.h"
+#include "MeshOptimisation.h"
+
+// Reorders clusters of triangles to reduce overdraw, while keeping vertex cache efficiency within the given threshold of its 
+// current value.  Should follow vertex cache optimisation
+class PipelineStageOptimiseOverdraw : public PipelineStage
+{
+public:
+
+	PipelineStageOptimiseOverdraw(float threshold = MeshOptimisation::DEFAULT_OVERDRAW_THRESHOLD);
+
+	inline std::string						GetName(void) const { return "PipelineStageOptimiseOverdraw"; }
+	inline std::string						GetConfiguration(void) const { return std::to_string(m_threshold); }
+
+	std::unique_ptr<ModelData>				ExecuteTransform(std::unique_ptr<ModelData> model) const;
+
+private:
+
+	void									OptimiseMesh(ModelData *m, const std::string & name) const;
+
+	float									m_threshold;
+
+};
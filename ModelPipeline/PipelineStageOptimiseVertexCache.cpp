@@ -0,0 +1,39 @@
+#include "PipelineStageOptimiseVertexCache.h"
+
+
+PipelineStageOptimiseVertexCache::PipelineStageOptimiseVertexCache(unsigned int cache_size)
+	:
+	m_cache_size(cache_size)
+{
+}
+
+std::unique_ptr<ModelData> PipelineStageOptimiseVertexCache::ExecuteTransform(std::unique_ptr<ModelData> model) const
+{
+	ModelData *m = model.get();
+	if (!m) return model;
+
+	// Any LOD meshes are optimised independently of the full-detail mesh
+	OptimiseMesh(m, "Model");
+	for (size_t i = 0U; i < m->Lods.size(); ++i)
+	{
+		OptimiseMesh(m->Lods[i].get(), "LOD " + std::to_string(i + 1U));
+	}
+
+	return model;
+}
+
+void PipelineStageOptimiseVertexCache::OptimiseMesh(ModelData *m, const std::string & name) const
+{
+	if (!MeshOptimisation::IsValidTriangleList(m->IndexData, m->IndexCount, m->VertexCount))
+	{
+		TRANSFORM_INFO << name << " does not contain valid triangle list data, no modifications applied\n";
+		return;
+	}
+
+	auto before = MeshOptimisation::CalculateCacheMetrics(m->IndexData, m->IndexCount, m->VertexCount);
+	MeshOptimisation::OptimiseVertexCache(m->IndexData, m->IndexCount, m->VertexCount, m_cache_size);
+	auto after = MeshOptimisation::CalculateCacheMetrics(m->IndexData, m->IndexCount, m->VertexCount);
+
+	TRANSFORM_INFO << name << " triangles reordered for vertex cache size " << m_cache_size << "; ACMR " << before.ACMR << " -> " << after.ACMR 
+				   << ", ATVR " << before.ATVR << " -> " << after.ATVR << "\n";
+}
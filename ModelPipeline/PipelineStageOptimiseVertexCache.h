@@ -0,0 +1,25 @@
+#pragma once
+
+#include "../Definitions/ModelData.h"
+#include "PipelineStage.h"
+#include "MeshOptimisation.h"
+
+// Reorders triangles for post-transform vertex cache efficiency
+class PipelineStageOptimiseVertexCache : public PipelineStage
+{
+public:
+
+	PipelineStageOptimiseVertexCache(unsigned int cache_size = MeshOptimisation::DEFAULT_OPTIMISE_CACHE_SIZE);
+
+	inline std::string						GetName(void) const { return "PipelineStageOptimiseVertexCache"; }
+	inline std::string						GetConfiguration(void) const { return std::to_string(m_cache_size); }
+
+	std::unique_ptr<ModelData>				ExecuteTransform(std::unique_ptr<ModelData> model) const;
+
+private:
+
+	void									OptimiseMesh(ModelData *m, const std::string & name) const;
+
+	unsigned int							m_cache_size;
+
+};
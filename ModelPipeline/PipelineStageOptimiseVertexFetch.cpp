@@ -0,0 +1,49 @@
+#include <vector>
+#include "MeshOptimisation.h"
+#include "PipelineStageOptimiseVertexFetch.h"
+
+
+std::unique_ptr<ModelData> PipelineStageOptimiseVertexFetch::ExecuteTransform(std::unique_ptr<ModelData> model) const
+{
+	ModelData *m = model.get();
+	if (!m) return model;
+
+	// Any LOD meshes are optimised independently of the full-detail mesh
+	OptimiseMesh(m, "Model");
+	for (size_t i = 0U; i < m->Lods.size(); ++i)
+	{
+		OptimiseMesh(m->Lods[i].get(), "LOD " + std::to_string(i + 1U));
+	}
+
+	return model;
+}
+
+void PipelineStageOptimiseVertexFetch::OptimiseMesh(ModelData *m, const std::string & name) const
+{
+	if (!m->VertexData || !MeshOptimisation::IsValidTriangleList(m->IndexData, m->IndexCount, m->VertexCount))
+	{
+		TRANSFORM_INFO << name << " does not contain valid triangle list data, no modifications applied\n";
+		return;
+	}
+
+	unsigned int vertex_count = MeshOptimisation::OptimiseVertexFetch(m->VertexData, m->VertexCount, m->IndexData, m->IndexCount);
+
+	// Reallocate vertex storage if any unreferenced vertices were removed
+	if (vertex_count != m->VertexCount)
+	{
+		TRANSFORM_INFO << name << ": removed " << (m->VertexCount - vertex_count) << " unreferenced vertices\n";
+
+		std::vector<ModelData::TVertex> vertices(m->VertexData, m->VertexData + vertex_count);
+		if (!m->AllocateVertexData(vertex_count))
+		{
+			TRANSFORM_ERROR << "Failed to reallocate vertex data for " << vertex_count << " vertices\n";
+			return;
+		}
+
+		memcpy(m->VertexData, vertices.data(), sizeof(ModelData::TVertex) * vertex_count);
+		m->VertexCount = vertex_count;
+		m->RecalculateDerivedData();
+	}
+
+	TRANSFORM_INFO << name << " vertex data reordered for fetch locality; " << m->str() << "\n";
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "../Definitions/ModelData.h"
+#include "PipelineStage.h"
+
+// Reorders vertex data into first-use order for vertex fetch locality, removing any unreferenced vertices.  Should follow 
+// any stage which reorders index data
+class PipelineStageOptimiseVertexFetch : public PipelineStage
+{
+public:
+
+	inline std::string						GetName(void) const { return "PipelineStageOptimiseVertexFetch"; }
+
+	std::unique_ptr<ModelData>				ExecuteTransform(std::unique_ptr<ModelData> model) const;
+
+private:
+
+	void									OptimiseMesh(ModelData *m, const std::string & name) const;
+
+};
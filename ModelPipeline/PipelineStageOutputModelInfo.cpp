@@ -1,5 +1,6 @@
 #include <iostream>
 #include "PipelineUtil.h"
+#include "MeshOptimisation.h"
 #include "PipelineStageOutputModelInfo.h"
 
 std::unique_ptr<ModelData> PipelineStageOutputModelInfo::ExecuteTransform(std::unique_ptr<ModelData> model) const
@@ -12,6 +13,21 @@ std::unique_ptr<ModelData> PipelineStageOutputModelInfo::ExecuteTransform(std::u
 	TRANSFORM_INFO << "Model size = " << FLOAT3_STR(m->SizeProperties.ModelSize) << "\n";
 	TRANSFORM_INFO << "Model bounds = " << FLOAT3_STR(m->SizeProperties.MinBounds) << " to " << FLOAT3_STR(m->SizeProperties.MaxBounds) << "\n";
 
+	// Vertex processing efficiency, for comparison before and after any mesh optimisation stages
+	if (MeshOptimisation::IsValidTriangleList(m->IndexData, m->IndexCount, m->VertexCount))
+	{
+		auto metrics = MeshOptimisation::CalculateCacheMetrics(m->IndexData, m->IndexCount, m->VertexCount);
+		TRANSFORM_INFO << "Model vertex cache efficiency (cache size " << MeshOptimisation::DEFAULT_METRIC_CACHE_SIZE << ") = " 
+					   << metrics.ACMR << " ACMR, " << metrics.ATVR << " ATVR\n";
+	}
+
+	for (size_t i = 0U; i < m->Lods.size(); ++i)
+	{
+		const ModelData *lod = m->Lods[i].get();
+		TRANSFORM_INFO << "Model LOD " << (i + 1U) << " vertex count = " << lod->VertexCount << ", index count = " << lod->IndexCount
+					   << ", relative error = " << lod->LodError << "\n";
+	}
+
 	// No change to the model data itself; this is a simple read-only 'transformation'
 	return model;
 }
\ No newline at end of file
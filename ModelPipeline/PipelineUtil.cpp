@@ -4,6 +4,7 @@
 #include <ios>
 #include <iomanip>
 #include <filesystem>
+#include <atomic>
 #include <DirectXMath.h>
 #include "../Definitions/ByteString.h"
 using namespace DirectX;
@@ -129,10 +130,13 @@ void PipelineUtil::WriteDataTofile(fs::path file, const std::string & data)
 
 fs::path PipelineUtil::NewTemporaryFile(const std::string & extension)
 {
+	// Each candidate name is only ever issued once per process, so that concurrent transforms cannot select the same file
+	static std::atomic<unsigned int> next_index(0U);
 	fs::path tmp = fs::temp_directory_path();
 	
-	for (unsigned int i = 0; i < 1000U; ++i)
+	for (unsigned int attempt = 0; attempt < 1000U; ++attempt)
 	{
+		unsigned int i = next_index++;
 		std::string tmp_file_name = (fs::absolute(tmp).string() + "/rj_modelpipeline_tmp_" + std::to_string(i) + (extension.empty() ? "" : (std::string(".") + extension)));
 		fs::path tmp_file = fs::path(tmp_file_name);
 		if (!fs::exists(tmp_file))
@@ -6,6 +6,8 @@
 #include "TransformPipelineInput.h"
 #include "TransformPipelineOutput.h"
 #include "PipelineStage.h"
+#include "PipelineLog.h"
+#include "BuildCache.h"
 
 namespace fs = std::filesystem;
 
@@ -19,14 +21,16 @@ TransformPipeline::TransformPipeline(
 	m_stages(std::move(transforms)), 
 	m_output(std::move(output_transform)), 
 
-	m_has_errors(false)
+	m_has_errors(false), 
+	m_cache(NULL), 
+	m_up_to_date(false)
 {
-	std::cout << "Verifying transform pipeline\n";
+	PipelineLog::Info() << "Verifying transform pipeline\n";
 	
 	// Register input transform
 	if (!m_input.get())
 	{
-		std::cerr << "Error: No input transformer detected\n";
+		PipelineLog::Error() << "Error: No input transformer detected\n";
 		exit(1);
 	}
 	m_input.get()->RegisterParent(this);
@@ -37,7 +41,7 @@ TransformPipeline::TransformPipeline(
 	{
 		if (!stage)
 		{
-			std::cerr << "Error: Pipeline stage " << stage_index << " is invalid\n";
+			PipelineLog::Error() << "Error: Pipeline stage " << stage_index << " is invalid\n";
 			exit(1);
 		}
 		stage.get()->RegisterParent(this);
@@ -47,29 +51,52 @@ TransformPipeline::TransformPipeline(
 	// Register output transform
 	if (!m_output.get())
 	{
-		std::cerr << "Error: No output transformer detected\n";
+		PipelineLog::Error() << "Error: No output transformer detected\n";
 		exit(1);
 	}
 	m_output.get()->RegisterParent(this);
 
-	std::cout << "Transform pipeline initialised\n";
-	std::cout << "Pipeline configuration: \"" << m_input.get()->GetName() << "\" -> ";
+	PipelineLog::Info() << "Transform pipeline initialised\n";
+	PipelineLog::Info() << "Pipeline configuration: \"" << m_input.get()->GetName() << "\" -> ";
 	for (const auto & stage : m_stages)
 	{
-		std::cout << "\"" << stage->GetName() << "\" -> ";
+		PipelineLog::Info() << "\"" << stage->GetName() << "\" -> ";
 	}
-	std::cout << "\"" << m_output.get()->GetName() << "\"\n\n";
+	PipelineLog::Info() << "\"" << m_output.get()->GetName() << "\"\n\n";
 }
 
 
+// Transform from file to file.  If a build cache is registered, the transform is skipped when its recorded outputs remain valid
 void TransformPipeline::Transform(fs::path file, fs::path output_file) const
 {
 	ResetPipelineState();
 
+	BuildCache::HashValue key = 0U;
+	if (m_cache)
+	{
+		key = BuildCache::CalculateKey(file, GetConfiguration(), output_file);
+
+		ModelSizeProperties metadata;
+		if (m_cache->IsUpToDate(file, key, metadata))
+		{
+			PipelineLog::Info() << "Outputs are up to date; skipping transformation\n";
+			StoreModelMetadata(metadata);
+			m_up_to_date = true;
+			return;
+		}
+	}
+
 	auto models = m_input.get()->Transform(file);
 	if (m_input.get()->HasErrors()) ReportError();
 
 	ExecuteTransform(std::move(models), output_file);
+
+	// Only successful transforms are recorded, so that any failure will be reattempted by the next build
+	if (m_cache)
+	{
+		if (!m_has_errors && !m_output_files.empty())	m_cache->Record(file, key, m_output_files, m_metadata);
+		else											m_cache->Invalidate(file);
+	}
 }
 
 void TransformPipeline::Transform(std::string input_data, fs::path output_file) const
@@ -114,6 +141,7 @@ void TransformPipeline::ExecuteTransform(std::vector<std::unique_ptr<ModelData>>
 		// Output through the designated output transformer
 		m_output.get()->Transform(std::move(model), output_file);
 		if (m_output.get()->HasErrors()) ReportError();
+		m_output_files.push_back(output_file);
 	}
 }
 
@@ -126,8 +154,8 @@ ByteString TransformPipeline::Transform(std::string input_data) const
 	auto models = m_input.get()->Transform(input_data);
 	if (m_input.get()->HasErrors()) ReportError();
 
-	if (models.empty()) { std::cerr << "Error: No model data loaded\n"; ReportError(); return ByteString(); }
-	if (models.size() != 1U) { std::cout << "Warning: Model contains " << models.size() << "meshes; in-memory pipeline will process and return only the first mesh\n"; ReportError(); }
+	if (models.empty()) { PipelineLog::Error() << "Error: No model data loaded\n"; ReportError(); return ByteString(); }
+	if (models.size() != 1U) { PipelineLog::Info() << "Warning: Model contains " << models.size() << "meshes; in-memory pipeline will process and return only the first mesh\n"; ReportError(); }
 
 	return ExecuteTransformInMemory(std::move(models.at(0)));
 }
@@ -141,8 +169,8 @@ ByteString TransformPipeline::Transform(fs::path file) const
 	auto models = m_input.get()->Transform(file);
 	if (m_input.get()->HasErrors()) ReportError();
 
-	if (models.empty()) { std::cerr << "Error: No model data loaded\n"; ReportError(); return ByteString(); }
-	if (models.size() != 1U) { std::cout << "Warning: Model contains " << models.size() << "meshes; in-memory pipeline will process and return only the first mesh\n"; ReportError(); }
+	if (models.empty()) { PipelineLog::Error() << "Error: No model data loaded\n"; ReportError(); return ByteString(); }
+	if (models.size() != 1U) { PipelineLog::Info() << "Warning: Model contains " << models.size() << "meshes; in-memory pipeline will process and return only the first mesh\n"; ReportError(); }
 
 	return ExecuteTransformInMemory(std::move(models.at(0)));
 }
@@ -161,6 +189,20 @@ ByteString TransformPipeline::ExecuteTransformInMemory(std::unique_ptr<ModelData
 	return output;
 }
 
+// Description of every component in the pipeline along with its parameters
+std::string TransformPipeline::GetConfiguration(void) const
+{
+	std::ostringstream ss;
+	ss << m_input.get()->GetName() << "(" << m_input.get()->GetConfiguration() << ")";
+	for (const auto & stage : m_stages)
+	{
+		ss << " -> " << stage->GetName() << "(" << stage->GetConfiguration() << ")";
+	}
+	ss << " -> " << m_output.get()->GetName() << "(" << m_output.get()->GetConfiguration() << ")";
+
+	return ss.str();
+}
+
 void TransformPipeline::StoreModelMetadata(const ModelSizeProperties & metadata) const
 {
 	m_metadata = metadata;
@@ -170,4 +212,6 @@ void TransformPipeline::ResetPipelineState(void) const
 {
 	m_has_errors = false;
 	m_metadata = ModelSizeProperties();
+	m_up_to_date = false;
+	m_output_files.clear();
 }
@@ -9,6 +9,7 @@
 class TransformPipelineInput;
 class TransformPipelineOutput;
 class PipelineStage;
+class BuildCache;
 namespace fs = std::filesystem;
 
 class TransformPipeline
@@ -23,6 +24,7 @@ public:
 
 
 
+	// Transform from file to file.  If a build cache is registered, the transform is skipped when its recorded outputs remain valid
 	void Transform(fs::path file, fs::path output_file) const;
 	void Transform(std::string input_data, fs::path output_file) const;
 	ByteString Transform(std::string input_data) const;
@@ -30,6 +32,13 @@ public:
 
 	CMPINLINE bool									HasErrors(void) const { return m_has_errors; }
 
+	// Optional cache of previous outputs; not owned by the pipeline, and may be shared between pipelines
+	CMPINLINE void									SetBuildCache(BuildCache *cache) { m_cache = cache; }
+	CMPINLINE bool									WasUpToDate(void) const { return m_up_to_date; }
+
+	// Description of every component in the pipeline along with its parameters
+	std::string										GetConfiguration(void) const;
+
 	CMPINLINE const ModelSizeProperties &			GetModelMetadata(void) const { return m_metadata; }
 	CMPINLINE bool									HasModelMetadata(void) const { return (m_metadata.HasData()); }
 
@@ -51,6 +60,10 @@ private:
 	mutable bool									m_has_errors;
 	mutable ModelSizeProperties						m_metadata;
 
+	BuildCache *									m_cache;
+	mutable bool									m_up_to_date;
+	mutable std::vector<fs::path>					m_output_files;
+
 	void											StoreModelMetadata(const ModelSizeProperties & metadata) const;
 
 };
\ No newline at end of file
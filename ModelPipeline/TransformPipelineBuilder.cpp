@@ -2,6 +2,8 @@
 
 
 TransformPipelineBuilder::TransformPipelineBuilder(void)
+	:
+	m_cache(NULL)
 {
 }
 
@@ -23,9 +25,17 @@ TransformPipelineBuilder & TransformPipelineBuilder::WithPipelineStage(std::uniq
 	return *this;
 }
 
+// Cache is optional and not owned by the pipeline
+TransformPipelineBuilder & TransformPipelineBuilder::WithBuildCache(BuildCache *cache)
+{
+	m_cache = cache;
+	return *this;
+}
+
 std::unique_ptr<TransformPipeline> TransformPipelineBuilder::Build(void)
 {
 	auto pipeline = std::make_unique<TransformPipeline>(std::move(m_input), std::move(m_output), std::move(m_stages));
+	pipeline->SetBuildCache(m_cache);
 	return pipeline;
 }
 
@@ -16,6 +16,7 @@ public:
 	TransformPipelineBuilder &			WithInputTransformer(std::unique_ptr<TransformPipelineInput> transformer);
 	TransformPipelineBuilder &			WithOutputTransformer(std::unique_ptr<TransformPipelineOutput> transformer);
 	TransformPipelineBuilder &			WithPipelineStage(std::unique_ptr<PipelineStage> transformer);
+	TransformPipelineBuilder &			WithBuildCache(BuildCache *cache);
 
 	std::unique_ptr<TransformPipeline>	Build(void);
 
@@ -26,5 +27,6 @@ private:
 	std::unique_ptr<TransformPipelineInput>					m_input;
 	std::unique_ptr<TransformPipelineOutput>				m_output;
 	std::vector<std::unique_ptr<PipelineStage>>				m_stages;
+	BuildCache *											m_cache;
 
 };
\ No newline at end of file
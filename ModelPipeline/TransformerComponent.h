@@ -3,6 +3,7 @@
 #include <string>
 #include <iostream>
 #include <sstream>
+#include "PipelineLog.h"
 class TransformPipeline;
 
 
@@ -10,8 +11,8 @@ class TransformerComponent
 {
 public:
 
-#	define TRANSFORM_INFO std::cout << "Info [" << GetName() << "]: " 
-#	define TRANSFORM_ERROR std::cerr << "Error [" << GetName() << "]: " << ReportError()
+#	define TRANSFORM_INFO PipelineLog::Info() << "Info [" << GetName() << "]: " 
+#	define TRANSFORM_ERROR PipelineLog::Error() << "Error [" << GetName() << "]: " << ReportError()
 
 	// Default constructor
 	TransformerComponent(void)
@@ -23,6 +24,10 @@ public:
 	// Implemented by each transformer component subclass
 	virtual std::string							GetName(void) const = 0;
 
+	// Returns a description of every parameter that affects the output of this component.  Used to determine whether 
+	// previous pipeline output remains valid, so must change whenever the component would produce different output
+	virtual std::string							GetConfiguration(void) const { return ""; }
+
 	// Components maintain a pointer back to their parent pipeline, e.g. to retrieve pipeline-global data on the current model execution
 	inline void									RegisterParent(const TransformPipeline *parent) { m_parent = parent; }
 
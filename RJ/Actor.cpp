@@ -282,6 +282,9 @@ Order::OrderResult Actor::MoveToTarget(Order_ActorMoveToTarget & order)
 // Order: Travels to a destination using the environment nav network.  Spawns multiple child orders to get there.
 Order::OrderResult Actor::TravelToPosition(Order_ActorTravelToPosition & order)
 {
+	// If the travel path has not yet been calculated, resolve it now along with all other travel orders issued since the last batch
+	if (order.IsTravelPathPending()) Order_ActorTravelToPosition::CalculatePendingTravelPaths();
+
 	// Test whether we have traversed all the nodes in the travel path.  If so, return a complete status
 	if (order.PathIndex == order.PathLength)
 	{
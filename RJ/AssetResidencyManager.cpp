@@ -0,0 +1,413 @@
+#include <algorithm>
+#include "GameVarsExtern.h"
+#include "Logging.h"
+#include "Utility.h"
+#include "WorkerThreadPool.h"
+#include "MaterialDX11.h"
+#include "TextureDX11.h"
+#include "SpaceSystem.h"
+#include "iSpaceObject.h"
+#include "AssetResidencyManager.h"
+
+
+// Default constructor
+AssetResidencyManager::AssetResidencyManager(void)
+	:
+	m_outstanding(0),
+	m_frame(1U),
+	m_budget(AssetResidencyManager::DEFAULT_MEMORY_BUDGET),
+	m_texture_loads_per_frame(AssetResidencyManager::DEFAULT_TEXTURE_LOADS_PER_FRAME)
+{
+}
+
+// Registers a model for streaming.  The model geometry should be loaded but not yet compiled
+void AssetResidencyManager::RegisterModel(Model *model)
+{
+	if (!model || model->GetResidencyID() != Model::NO_RESIDENCY_ID) return;
+
+	model->SetResidencyID((int)m_models.size());
+	m_models.push_back(ModelEntry(model));
+
+	// The model may already have been compiled outside of the residency manager
+	ModelEntry & entry = m_models.back();
+	if (model->IsCompiled())
+	{
+		entry.State = ResidencyState::Resident;
+		entry.Size = model->CalculateCompiledDataSize();
+		m_stats[(int)AssetType::Model].ResidentBytes += entry.Size;
+	}
+}
+
+// Registers a texture for streaming.  No texture data is loaded until the texture is requested
+void AssetResidencyManager::RegisterTexture(TextureDX11 *texture, const std::string & filename, Texture::Dimension dimension)
+{
+	if (!texture || m_texture_index.find(texture) != m_texture_index.end()) return;
+
+	// Texture data is stored in a GPU-ready format, so the file size is a reasonable estimate of resident size
+	std::error_code err;
+	uintmax_t size = fs::file_size(fs::path(filename), err);
+	if (err) size = 0U;
+
+	m_texture_index[texture] = m_textures.size();
+	m_textures.push_back(TextureEntry(texture, filename, dimension, (size_t)size));
+}
+
+// Requests that a texture be made resident, if it is being managed by the residency manager
+void AssetResidencyManager::RequestTexture(const TextureDX11 *texture)
+{
+	auto it = m_texture_index.find(texture);
+	if (it != m_texture_index.end()) TouchTexture(it->second);
+}
+
+// Marks any streamed textures used by a material as used in the current frame
+void AssetResidencyManager::RequestMaterialTextures(const MaterialDX11 *material)
+{
+	for (const TextureDX11 *texture : material->GetTextures())
+	{
+		if (!texture) continue;
+
+		auto it = m_texture_index.find(texture);
+		if (it != m_texture_index.end() && m_textures[it->second].LastUsed != m_frame) TouchTexture(it->second);
+	}
+}
+
+// Requests residency of all assets used by objects in the given system, ahead of them being rendered
+void AssetResidencyManager::PrefetchSystem(SpaceSystem & system)
+{
+	unsigned int requested = 0U;
+	for (auto & object : *(system.GetObjects()))
+	{
+		iSpaceObject *obj = object();
+		if (!obj) continue;
+
+		Model *model = obj->GetModel();
+		if (model && model->GetResidencyID() != Model::NO_RESIDENCY_ID)
+		{
+			RequestModel(model);
+			++requested;
+		}
+	}
+
+	Game::Log << LOG_INFO << "Requested residency of " << requested << " object models for system \"" << system.GetCode() << "\"\n";
+}
+
+// Marks a model as used in the current frame and begins loading it if required
+void AssetResidencyManager::TouchModel(size_t id)
+{
+	ModelEntry & entry = m_models[id];
+	entry.LastUsed = m_frame;
+
+	// Textures used by a model remain in use for as long as the model does
+	for (size_t texture : entry.Textures)
+	{
+		TouchTexture(texture);
+	}
+
+	if (entry.State == ResidencyState::NotResident)
+	{
+		// Models may be compiled directly, e.g. following a runtime reload, in which case we only need to record their residency
+		if (entry.Asset->IsCompiled())
+		{
+			entry.State = ResidencyState::Resident;
+			entry.Size = entry.Asset->CalculateCompiledDataSize();
+			m_stats[(int)AssetType::Model].ResidentBytes += entry.Size;
+		}
+		else
+		{
+			BeginModelLoad(id);
+		}
+	}
+}
+
+// Marks a texture as used in the current frame and queues it for loading if required
+void AssetResidencyManager::TouchTexture(size_t id)
+{
+	TextureEntry & entry = m_textures[id];
+	entry.LastUsed = m_frame;
+
+	if (entry.State == ResidencyState::NotResident)
+	{
+		entry.State = ResidencyState::Loading;
+		m_texture_queue.push_back(id);
+	}
+}
+
+// Begins an asynchronous load of the given model
+void AssetResidencyManager::BeginModelLoad(size_t id)
+{
+	ModelEntry & entry = m_models[id];
+	entry.State = ResidencyState::Loading;
+
+	// Materials are resolved on the main thread, since this may require logging and access to the engine asset collections
+	std::vector<const MaterialDX11*> materials = entry.Asset->ResolveComponentMaterials();
+	if (!entry.DependenciesResolved)
+	{
+		ResolveModelDependencies(entry, materials);
+		for (size_t texture : entry.Textures) TouchTexture(texture);
+	}
+
+	// Buffer creation only requires the device, which is free-threaded, so the load can be executed on any worker
+	Model *model = entry.Asset;
+	auto load = [this, id, model, materials](void)
+	{
+		CompletedModelLoad completed;
+		completed.ID = id;
+		completed.LoadResult = model->BuildCompiledData(materials, completed.Data);
+
+		{
+			std::lock_guard<std::mutex> lock(m_completed_lock);
+			m_completed.push_back(std::move(completed));
+		}
+		--m_outstanding;
+	};
+
+	++m_outstanding;
+	if (Game::WorkerThreads.GetWorkerCount() != 0U)
+	{
+		Game::WorkerThreads.Submit(std::move(load));
+	}
+	else
+	{
+		load();
+	}
+}
+
+// Determines the streamed textures which are required by the materials of a model
+void AssetResidencyManager::ResolveModelDependencies(ModelEntry & entry, const std::vector<const MaterialDX11*> & materials)
+{
+	entry.Textures.clear();
+	for (const MaterialDX11 *material : materials)
+	{
+		if (!material) continue;
+		for (const TextureDX11 *texture : material->GetTextures())
+		{
+			if (!texture) continue;
+
+			auto it = m_texture_index.find(texture);
+			if (it != m_texture_index.end() && std::find(entry.Textures.begin(), entry.Textures.end(), it->second) == entry.Textures.end())
+			{
+				entry.Textures.push_back(it->second);
+			}
+		}
+	}
+
+	entry.DependenciesResolved = true;
+}
+
+// Per-frame update; installs any completed loads, processes queued texture loads and evicts assets if over budget.  Should
+// be called at the start of the frame, before any rendering data is submitted
+void AssetResidencyManager::Update(void)
+{
+	// Advance the frame counter first, so that all assets used in the prior frame are considered as in-use
+	++m_frame;
+
+	InstallCompletedModelLoads();
+	ProcessTextureQueue();
+	EvictToBudget();
+}
+
+// Installs all completed model loads.  Returns the number of models installed
+unsigned int AssetResidencyManager::InstallCompletedModelLoads(void)
+{
+	std::vector<CompletedModelLoad> completed;
+	{
+		std::lock_guard<std::mutex> lock(m_completed_lock);
+		if (m_completed.empty()) return 0U;
+		completed.swap(m_completed);
+	}
+
+	unsigned int installed = 0U;
+	for (auto & load : completed)
+	{
+		ModelEntry & entry = m_models[load.ID];
+		if (entry.State != ResidencyState::Loading) continue;
+
+		if (load.LoadResult != ErrorCodes::NoError)
+		{
+			Game::Log << LOG_ERROR << "Failed to load streamed model \"" << entry.Asset->GetCode() << "\" (" << load.LoadResult << ")\n";
+			entry.State = ResidencyState::Failed;
+			continue;
+		}
+
+		entry.Asset->InstallCompiledData(std::move(load.Data));
+		entry.State = ResidencyState::Resident;
+		entry.Size = entry.Asset->CalculateCompiledDataSize();
+
+		m_stats[(int)AssetType::Model].ResidentBytes += entry.Size;
+		++m_stats[(int)AssetType::Model].LoadCount;
+		++installed;
+	}
+
+	return installed;
+}
+
+// Loads queued textures, up to the per-frame limit
+void AssetResidencyManager::ProcessTextureQueue(void)
+{
+	unsigned int loaded = 0U;
+	while (!m_texture_queue.empty() && loaded < m_texture_loads_per_frame)
+	{
+		TextureEntry & entry = m_textures[m_texture_queue.front()];
+		m_texture_queue.pop_front();
+		if (entry.State != ResidencyState::Loading) continue;
+
+		if (!entry.Asset->LoadTexture(ConvertStringToWString(entry.Filename), entry.Dimension))
+		{
+			Game::Log << LOG_WARN << "Failed to load streamed texture \"" << entry.Asset->GetCode() << "\" from \"" << entry.Filename << "\"\n";
+			entry.State = ResidencyState::Failed;
+			continue;
+		}
+
+		entry.State = ResidencyState::Resident;
+		m_stats[(int)AssetType::Texture].ResidentBytes += entry.Size;
+		++m_stats[(int)AssetType::Texture].LoadCount;
+		++loaded;
+	}
+}
+
+// Evicts least-recently-used assets until resident data is within the memory budget, or no further assets are eligible
+void AssetResidencyManager::EvictToBudget(void)
+{
+	if (GetResidentBytes() <= m_budget) return;
+
+	// Collect all assets eligible for eviction, ordered by the frame in which they were last used
+	struct EvictionCandidate { size_t LastUsed; AssetType Type; size_t ID; };
+	std::vector<EvictionCandidate> candidates;
+
+	for (size_t i = 0U; i < m_models.size(); ++i)
+	{
+		const ModelEntry & entry = m_models[i];
+		if (entry.State == ResidencyState::Resident && (entry.LastUsed + EVICTION_DELAY_FRAMES) < m_frame)
+		{
+			candidates.push_back({ entry.LastUsed, AssetType::Model, i });
+		}
+	}
+
+	for (size_t i = 0U; i < m_textures.size(); ++i)
+	{
+		const TextureEntry & entry = m_textures[i];
+		if (entry.State == ResidencyState::Resident && (entry.LastUsed + EVICTION_DELAY_FRAMES) < m_frame)
+		{
+			candidates.push_back({ entry.LastUsed, AssetType::Texture, i });
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end(), [](const EvictionCandidate & lhs, const EvictionCandidate & rhs) { return (lhs.LastUsed < rhs.LastUsed); });
+
+	// Evict in LRU order until we are back within budget
+	for (const auto & candidate : candidates)
+	{
+		if (GetResidentBytes() <= m_budget) break;
+
+		if (candidate.Type == AssetType::Model)		EvictModelEntry(m_models[candidate.ID]);
+		else										EvictTextureEntry(m_textures[candidate.ID]);
+	}
+}
+
+// Releases the rendering data for a single model
+void AssetResidencyManager::EvictModelEntry(ModelEntry & entry)
+{
+	if (entry.State != ResidencyState::Resident) return;
+
+	entry.Asset->ReleaseCompiledData();
+	entry.State = ResidencyState::NotResident;
+
+	m_stats[(int)AssetType::Model].ResidentBytes -= entry.Size;
+	++m_stats[(int)AssetType::Model].EvictionCount;
+	entry.Size = 0U;
+}
+
+// Releases the rendering data for a single texture
+void AssetResidencyManager::EvictTextureEntry(TextureEntry & entry)
+{
+	if (entry.State != ResidencyState::Resident) return;
+
+	entry.Asset->ReleaseResources();
+	entry.State = ResidencyState::NotResident;
+
+	m_stats[(int)AssetType::Texture].ResidentBytes -= entry.Size;
+	++m_stats[(int)AssetType::Texture].EvictionCount;
+}
+
+// Immediately releases the rendering data for a model, for example before it is reloaded.  Waits for any outstanding
+// asynchronous loads before doing so.  The model will be reloaded when next requested
+void AssetResidencyManager::EvictModel(Model *model)
+{
+	if (!model || model->GetResidencyID() == Model::NO_RESIDENCY_ID) return;
+
+	WaitForOutstandingLoads();
+	InstallCompletedModelLoads();
+
+	ModelEntry & entry = m_models[model->GetResidencyID()];
+	EvictModelEntry(entry);
+
+	entry.State = ResidencyState::NotResident;
+	entry.DependenciesResolved = false;
+}
+
+// Returns residency statistics for the given type of asset
+AssetResidencyManager::Statistics AssetResidencyManager::GetStatistics(AssetType type) const
+{
+	Statistics stats = m_stats[(int)type];
+
+	auto count = [&stats](ResidencyState state)
+	{
+		switch (state)
+		{
+			case ResidencyState::Resident:		++stats.Resident;	break;
+			case ResidencyState::Loading:		++stats.Loading;	break;
+			case ResidencyState::Failed:		++stats.Failed;		break;
+		}
+	};
+
+	if (type == AssetType::Model)
+	{
+		stats.Registered = (unsigned int)m_models.size();
+		for (const auto & entry : m_models) count(entry.State);
+	}
+	else
+	{
+		stats.Registered = (unsigned int)m_textures.size();
+		for (const auto & entry : m_textures) count(entry.State);
+	}
+
+	return stats;
+}
+
+// Blocks until all outstanding asynchronous loads have completed
+void AssetResidencyManager::WaitForOutstandingLoads(void)
+{
+	if (m_outstanding.load() != 0)
+	{
+		Game::WorkerThreads.WaitForCompletion(m_outstanding);
+	}
+}
+
+// Waits for any outstanding loads and releases all residency data.  Registered assets are not themselves deallocated.  Must
+// be called before model data is terminated and before the worker thread pool is shut down
+void AssetResidencyManager::Shutdown(void)
+{
+	WaitForOutstandingLoads();
+
+	{
+		std::lock_guard<std::mutex> lock(m_completed_lock);
+		m_completed.clear();
+	}
+
+	for (auto & entry : m_models)
+	{
+		entry.Asset->SetResidencyID(Model::NO_RESIDENCY_ID);
+	}
+
+	m_models.clear();
+	m_textures.clear();
+	m_texture_index.clear();
+	m_texture_queue.clear();
+
+	for (auto & stats : m_stats) stats = Statistics();
+}
+
+// Default destructor
+AssetResidencyManager::~AssetResidencyManager(void)
+{
+}
@@ -0,0 +1,210 @@
+#pragma once
+
+#ifndef __AssetResidencyManagerH__
+#define __AssetResidencyManagerH__
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include "CompilerSettings.h"
+#include "ErrorCodes.h"
+#include "Texture.h"
+#include "Model.h"
+class TextureDX11;
+class MaterialDX11;
+class SpaceSystem;
+
+
+// Maintains the set of streamed assets that are resident in GPU memory.  Assets are registered as lightweight handles when
+// game data is loaded, and their rendering resources are only created on first use, or predictively when a system is entered.
+// Model buffers are built asynchronously on the worker thread pool and installed at the start of a frame; textures are loaded
+// on the main thread in small per-frame batches, since loading may require the immediate device context.  When resident data
+// exceeds the memory budget, the least-recently-used assets that have not been used for several frames are evicted
+// Class has no special alignment requirements
+class AssetResidencyManager
+{
+public:
+
+	// Default memory budget for resident streamed assets, in bytes
+	static const size_t						DEFAULT_MEMORY_BUDGET = (256U * 1024U * 1024U);
+
+	// Default maximum number of textures that will be loaded in a single frame
+	static const unsigned int				DEFAULT_TEXTURE_LOADS_PER_FRAME = 4U;
+
+	// Number of frames since last use before an asset becomes eligible for eviction.  Ensures that assets are not evicted while
+	// still referenced by the current frame, and avoids repeated eviction & reload of assets that are used intermittently
+	static const unsigned int				EVICTION_DELAY_FRAMES = 60U;
+
+	// Types of asset managed by the residency manager
+	enum class AssetType { Model = 0, Texture, _COUNT };
+
+	// Residency state of a single asset
+	enum class ResidencyState { NotResident = 0, Loading, Resident, Failed };
+
+	// Residency statistics for one type of asset
+	struct Statistics
+	{
+		unsigned int						Registered;
+		unsigned int						Resident;
+		unsigned int						Loading;
+		unsigned int						Failed;
+		size_t								ResidentBytes;
+		unsigned int						LoadCount;
+		unsigned int						EvictionCount;
+
+		Statistics(void) : Registered(0U), Resident(0U), Loading(0U), Failed(0U), ResidentBytes(0U), LoadCount(0U), EvictionCount(0U) { }
+	};
+
+	// Default constructor
+	AssetResidencyManager(void);
+
+	// Registers a model for streaming.  The model geometry should be loaded but not yet compiled
+	void									RegisterModel(Model *model);
+
+	// Registers a texture for streaming.  No texture data is loaded until the texture is requested
+	void									RegisterTexture(TextureDX11 *texture, const std::string & filename, Texture::Dimension dimension);
+
+	// Indicates that a model is being used this frame, and requests that it be made resident if it is not already.  Called for
+	// every model submitted for rendering, so returns immediately if the model is unmanaged or has already been used this frame
+	CMPINLINE void							RequestModel(const Model *model)
+	{
+		int id = model->GetResidencyID();
+		if (id != Model::NO_RESIDENCY_ID && m_models[id].LastUsed != m_frame) TouchModel((size_t)id);
+	}
+
+	// Requests that a texture be made resident, if it is being managed by the residency manager
+	void									RequestTexture(const TextureDX11 *texture);
+
+	// Indicates that a material is being used this frame, and requests that any streamed textures it uses be made resident.  Called 
+	// for every override material submitted for rendering, so returns immediately if no textures are being streamed
+	CMPINLINE void							RequestMaterial(const MaterialDX11 *material)
+	{
+		if (!m_textures.empty()) RequestMaterialTextures(material);
+	}
+
+	// Requests residency of all assets used by objects in the given system, ahead of them being rendered
+	void									PrefetchSystem(SpaceSystem & system);
+
+	// Per-frame update; installs any completed loads, processes queued texture loads and evicts assets if over budget.  Should
+	// be called at the start of the frame, before any rendering data is submitted
+	void									Update(void);
+
+	// Immediately releases the rendering data for a model, for example before it is reloaded.  Waits for any outstanding
+	// asynchronous loads before doing so.  The model will be reloaded when next requested
+	void									EvictModel(Model *model);
+
+	// Memory budget for resident streamed assets, in bytes
+	CMPINLINE size_t						GetMemoryBudget(void) const						{ return m_budget; }
+	CMPINLINE void							SetMemoryBudget(size_t budget)					{ m_budget = budget; }
+
+	// Maximum number of textures that will be loaded in a single frame
+	CMPINLINE unsigned int					GetTextureLoadsPerFrame(void) const				{ return m_texture_loads_per_frame; }
+	CMPINLINE void							SetTextureLoadsPerFrame(unsigned int count)		{ m_texture_loads_per_frame = count; }
+
+	// Returns residency statistics for the given type of asset
+	Statistics								GetStatistics(AssetType type) const;
+
+	// Total size of all resident streamed assets, in bytes
+	CMPINLINE size_t						GetResidentBytes(void) const					{ return (m_stats[(int)AssetType::Model].ResidentBytes + m_stats[(int)AssetType::Texture].ResidentBytes); }
+
+	// Waits for any outstanding loads and releases all residency data.  Registered assets are not themselves deallocated.  Must
+	// be called before model data is terminated and before the worker thread pool is shut down
+	void									Shutdown(void);
+
+	// Default destructor
+	~AssetResidencyManager(void);
+
+private:
+
+	// Residency data for a streamed model
+	struct ModelEntry
+	{
+		Model *								Asset;
+		ResidencyState						State;
+		size_t								Size;
+		size_t								LastUsed;
+		bool								DependenciesResolved;
+		std::vector<size_t>					Textures;			// Indices of any streamed textures used by the model materials
+
+		ModelEntry(Model *model) : Asset(model), State(ResidencyState::NotResident), Size(0U), LastUsed(0U), DependenciesResolved(false) { }
+	};
+
+	// Residency data for a streamed texture
+	struct TextureEntry
+	{
+		TextureDX11 *						Asset;
+		std::string							Filename;
+		Texture::Dimension					Dimension;
+		ResidencyState						State;
+		size_t								Size;
+		size_t								LastUsed;
+
+		TextureEntry(TextureDX11 *texture, const std::string & filename, Texture::Dimension dimension, size_t size)
+			: Asset(texture), Filename(filename), Dimension(dimension), State(ResidencyState::NotResident), Size(size), LastUsed(0U) { }
+	};
+
+	// Model data built asynchronously and awaiting installation
+	struct CompletedModelLoad
+	{
+		size_t								ID;
+		Result								LoadResult;
+		Model::CompiledComponents			Data;
+	};
+
+	// Marks a model as used in the current frame and begins loading it if required
+	void									TouchModel(size_t id);
+
+	// Marks a texture as used in the current frame and queues it for loading if required
+	void									TouchTexture(size_t id);
+
+	// Marks any streamed textures used by a material as used in the current frame
+	void									RequestMaterialTextures(const MaterialDX11 *material);
+
+	// Begins an asynchronous load of the given model
+	void									BeginModelLoad(size_t id);
+
+	// Determines the streamed textures which are required by the materials of a model
+	void									ResolveModelDependencies(ModelEntry & entry, const std::vector<const MaterialDX11*> & materials);
+
+	// Installs all completed model loads.  Returns the number of models installed
+	unsigned int							InstallCompletedModelLoads(void);
+
+	// Loads queued textures, up to the per-frame limit
+	void									ProcessTextureQueue(void);
+
+	// Evicts least-recently-used assets until resident data is within the memory budget, or no further assets are eligible
+	void									EvictToBudget(void);
+
+	// Releases the rendering data for a single asset
+	void									EvictModelEntry(ModelEntry & entry);
+	void									EvictTextureEntry(TextureEntry & entry);
+
+	// Blocks until all outstanding asynchronous loads have completed
+	void									WaitForOutstandingLoads(void);
+
+private:
+
+	std::vector<ModelEntry>								m_models;
+	std::vector<TextureEntry>							m_textures;
+	std::unordered_map<const TextureDX11*, size_t>		m_texture_index;
+
+	// Queue of textures awaiting loading on the main thread
+	std::deque<size_t>									m_texture_queue;
+
+	// Completed asynchronous model loads, populated by worker threads
+	std::vector<CompletedModelLoad>						m_completed;
+	std::mutex											m_completed_lock;
+	std::atomic<int>									m_outstanding;
+
+	Statistics											m_stats[(int)AssetType::_COUNT];
+
+	size_t												m_frame;
+	size_t												m_budget;
+	unsigned int										m_texture_loads_per_frame;
+};
+
+
+#endif
@@ -1,8 +1,17 @@
+#include <algorithm>
+#include <functional>
 #include "GameVarsExtern.h"
+#include "GameObjects.h"
 #include "ObjectSearch.h"
+#include "SpatialQueryKernels.h"
+#include "WorkerThreadPool.h"
+#include "iObject.h"
 
 #include "BasicProjectileSet.h"
 
+// Initialise static data
+BasicProjectileSet::SimulationMode BasicProjectileSet::m_simulation_mode = BasicProjectileSet::SimulationMode::Batched;
+
 // Initialisation method
 void BasicProjectileSet::Initialise(void)
 {
@@ -127,6 +136,25 @@ void BasicProjectileSet::SimulateProjectiles(Octree<iObject*> *sp_tree)
 	// Make sure this collection is active and that we have been passed a valid SP tree
 	if (!Active || !sp_tree) return;
 
+	switch (m_simulation_mode)
+	{
+		case SimulationMode::Batched:
+			SimulateProjectilesBatched(sp_tree, false);
+			break;
+
+		case SimulationMode::Parallel:
+			SimulateProjectilesBatched(sp_tree, true);
+			break;
+
+		default:
+			SimulateProjectilesIndividually(sp_tree);
+			break;
+	}
+}
+
+// Simulates each projectile individually, performing a separate collision search for each
+void BasicProjectileSet::SimulateProjectilesIndividually(Octree<iObject*> *sp_tree)
+{
 	// Define variables required later in the method
 	Octree<iObject*> *leaf = NULL;
 	std::vector<iObject*> contacts;
@@ -212,6 +240,304 @@ void BasicProjectileSet::SimulateProjectiles(Octree<iObject*> *sp_tree)
 	}
 }
 
+// Simulates all projectiles in spatial bins, with one collision search per bin and SIMD path tests within each bin.  If 'parallel'
+// is set, all per-projectile passes are distributed across the worker thread pool.  Collision searches and impact handling are
+// always performed serially, and results do not depend on the number of threads or the order in which tasks execute
+void BasicProjectileSet::SimulateProjectilesBatched(Octree<iObject*> *sp_tree, bool parallel)
+{
+	// Determine the number of tasks to create; a single task will be executed directly on this thread
+	size_t live = (LiveIndex + 1U);
+	unsigned int task_count = 1U;
+	if (parallel && Game::WorkerThreads.GetWorkerCount() != 0U && live >= PARALLEL_MINIMUM_PROJECTILES)
+	{
+		task_count = ((Game::WorkerThreads.GetWorkerCount() + 1U) * PARALLEL_TASKS_PER_THREAD);
+	}
+
+	if (m_tasks.size() < task_count) m_tasks.resize(task_count);
+	for (unsigned int t = 0U; t < task_count; ++t) m_tasks[t].Clear();
+
+	/* 1. Identify expired projectiles, and bin all others by the spatial partitioning node that contains them */
+	ExecuteTasks(task_count, [this, sp_tree, live, task_count](unsigned int t)
+	{
+		ClassifyProjectiles(sp_tree, TaskRangeStart(live, t, task_count), TaskRangeStart(live, t + 1U, task_count), m_tasks[t]);
+	});
+
+	// Merge task results in task order, so that expirations remain in index order
+	m_batch.Keys.clear();
+	m_removals.clear();
+	for (unsigned int t = 0U; t < task_count; ++t)
+	{
+		m_batch.Keys.insert(m_batch.Keys.end(), m_tasks[t].Keys.begin(), m_tasks[t].Keys.end());
+		m_removals.insert(m_removals.end(), m_tasks[t].Expired.begin(), m_tasks[t].Expired.end());
+	}
+
+	// Sort into bin order.  Projectiles remain in index order within each bin
+	std::sort(m_batch.Keys.begin(), m_batch.Keys.end());
+
+	/* 2. Populate the SoA projectile streams in bin order */
+	size_t count = m_batch.Keys.size();
+	m_batch.Reset(count);
+	ExecuteTasks(task_count, [this, count, task_count](unsigned int t)
+	{
+		PopulateBatchData(TaskRangeStart(count, t, task_count), TaskRangeStart(count, t + 1U, task_count));
+	});
+
+	/* 3. Perform a single collision search for each bin */
+	BuildSimulationBins();
+
+	/* 4. Test every projectile in each bin against the bin collision candidates */
+	size_t bin_count = m_bins.size();
+	ExecuteTasks(task_count, [this, bin_count, task_count](unsigned int t)
+	{
+		size_t end = TaskRangeStart(bin_count, t + 1U, task_count);
+		for (size_t b = TaskRangeStart(bin_count, t, task_count); b < end; ++b)
+		{
+			TestBinCollisions(m_bins[b], m_tasks[t]);
+		}
+	});
+
+	/* 5. Move all projectiles which did not collide with an object */
+	ExecuteTasks(task_count, [this, count, task_count](unsigned int t)
+	{
+		MoveProjectiles(TaskRangeStart(count, t, task_count), TaskRangeStart(count, t + 1U, task_count));
+	});
+
+	/* 6. Apply all impacts and removals */
+	ApplyBatchResults(task_count);
+}
+
+// Executes the given function once for each task index in [0, task_count), across the worker thread pool if there is more than one task
+void BasicProjectileSet::ExecuteTasks(unsigned int task_count, const std::function<void(unsigned int)> & fn)
+{
+	if (task_count == 1U)
+	{
+		fn(0U);
+		return;
+	}
+
+	Game::WorkerThreads.ParallelFor((int)task_count, 1, [&fn](int begin, int end)
+	{
+		for (int t = begin; t < end; ++t) fn((unsigned int)t);
+	});
+}
+
+// Identifies expired projectiles in the given index range, and determines the spatial node containing each of the others
+void BasicProjectileSet::ClassifyProjectiles(Octree<iObject*> *sp_tree, size_t start, size_t end, TaskResults & results)
+{
+	Octree<iObject*> *leaf = NULL;
+	for (size_t i = start; i < end; ++i)
+	{
+		const BasicProjectile & proj = Items[i];
+		if (Game::ClockMs > proj.Expiration) { results.Expired.push_back(i); continue; }
+
+		// Projectiles are not simulated in the frame they are launched, so they render from their starting location
+		if (Game::ClockMs == proj.LaunchTime) continue;
+
+		// Test the last node that was used as a first approximation, since many projectiles may exist in the same general area
+		if (!leaf || !leaf->ContainsPoint(proj.Position))
+		{
+			leaf = sp_tree->GetNodeContainingPoint(proj.Position);
+		}
+
+		results.Keys.push_back(BatchData::BinKey(leaf, i));
+	}
+}
+
+// Populates the SoA projectile streams for the given range of (sorted) batch entries
+void BasicProjectileSet::PopulateBatchData(size_t start, size_t end)
+{
+	XMFLOAT3 pos, delta;
+	for (size_t k = start; k < end; ++k)
+	{
+		const BasicProjectile & proj = Items[m_batch.Keys[k].second];
+
+		// Determine the position delta vector for this frame; this is the velocity/sec * the timefactor
+		XMVECTOR delta_pos = XMVectorMultiply(proj.Velocity, Game::TimeFactorV);
+		XMStoreFloat3(&pos, proj.Position);
+		XMStoreFloat3(&delta, delta_pos);
+
+		float lengthsq = XMVectorGetX(XMVector3LengthSq(delta_pos));
+		m_batch.X[k] = pos.x; m_batch.Y[k] = pos.y; m_batch.Z[k] = pos.z;
+		m_batch.DX[k] = delta.x; m_batch.DY[k] = delta.y; m_batch.DZ[k] = delta.z;
+		m_batch.InvLengthSq[k] = (lengthsq > Game::C_EPSILON ? (1.0f / lengthsq) : 0.0f);
+	}
+}
+
+// Identifies each bin in the sorted batch, and performs the collision search for each.  Executed serially, since object searches
+// make use of shared search state.  All candidate OBB hierarchies are brought up-to-date so that they can be tested concurrently
+void BasicProjectileSet::BuildSimulationBins(void)
+{
+	m_bins.clear();
+	m_candidates.clear();
+
+	size_t count = m_batch.Keys.size();
+	size_t start = 0U;
+	while (start < count)
+	{
+		Octree<iObject*> *node = m_batch.Keys[start].first;
+		size_t end = start + 1U;
+		while (end < count && m_batch.Keys[end].first == node) ++end;
+
+		// Projectiles outside of the spatial partitioning tree have nothing to collide with
+		if (node)
+		{
+			// Determine a search that encompasses the individual search (of radius 'Speed') around every projectile in the bin
+			XMVECTOR bmin = XMVectorSet(m_batch.X[start], m_batch.Y[start], m_batch.Z[start], 0.0f), bmax = bmin;
+			for (size_t k = start + 1U; k < end; ++k)
+			{
+				XMVECTOR pos = XMVectorSet(m_batch.X[k], m_batch.Y[k], m_batch.Z[k], 0.0f);
+				bmin = XMVectorMin(bmin, pos); bmax = XMVectorMax(bmax, pos);
+			}
+
+			XMVECTOR centre = XMVectorScale(XMVectorAdd(bmin, bmax), 0.5f);
+			float radius = 0.0f;
+			for (size_t k = start; k < end; ++k)
+			{
+				float dist = XMVectorGetX(XMVector3Length(XMVectorSubtract(XMVectorSet(m_batch.X[k], m_batch.Y[k], m_batch.Z[k], 0.0f), centre)));
+				radius = max(radius, dist + Items[m_batch.Keys[k].second].Speed);
+			}
+
+			// The bin centre lies within the bounds of all its projectiles, and therefore within the (convex) node
+			int found = Game::Search<iObject>().GetAllObjectsWithinDistance(centre, node, radius,
+							m_search_results, Game::ObjectSearchOptions::OnlyCollidingObjects);
+
+			if (found != 0)
+			{
+				size_t candidate_start = m_candidates.size();
+				for (iObject *obj : m_search_results)
+				{
+					obj->CollisionOBB.UpdateIfRequired();
+					m_candidates.push_back(obj);
+				}
+
+				m_bins.push_back(SimulationBin(start, end, candidate_start, m_candidates.size()));
+			}
+		}
+
+		start = end;
+	}
+}
+
+// Tests all projectiles in a bin against its collision candidates, recording any impacts
+void BasicProjectileSet::TestBinCollisions(const SimulationBin & bin, TaskResults & results)
+{
+	const size_t width = SpatialQueryKernels::BATCH_WIDTH;
+	GamePhysicsEngine::OBBIntersectionData impact;
+
+	for (size_t c = bin.CandidateStart; c < bin.CandidateEnd; ++c)
+	{
+		iObject *obj = m_candidates[c];
+
+		// Replicate the candidate bounding sphere across all lanes
+		XMFLOAT3 objpos; XMStoreFloat3(&objpos, obj->GetPosition());
+		XMVECTOR cx = XMVectorReplicate(objpos.x), cy = XMVectorReplicate(objpos.y), cz = XMVectorReplicate(objpos.z);
+		XMVECTOR radiussq = XMVectorReplicate(obj->GetCollisionSphereRadius() * obj->GetCollisionSphereRadius());
+
+		for (size_t k = bin.Start; k < bin.End; k += width)
+		{
+			// Swept-sphere test for four projectiles.  Determine the point on each path segment closest to the 
+			// sphere centre, at t = clamp(((c - p) . d) / |d|^2, 0, 1), and test its distance from the centre
+			XMVECTOR wx = XMVectorSubtract(cx, XMLoadFloat4((const XMFLOAT4*)&(m_batch.X[k])));
+			XMVECTOR wy = XMVectorSubtract(cy, XMLoadFloat4((const XMFLOAT4*)&(m_batch.Y[k])));
+			XMVECTOR wz = XMVectorSubtract(cz, XMLoadFloat4((const XMFLOAT4*)&(m_batch.Z[k])));
+			XMVECTOR dx = XMLoadFloat4((const XMFLOAT4*)&(m_batch.DX[k]));
+			XMVECTOR dy = XMLoadFloat4((const XMFLOAT4*)&(m_batch.DY[k]));
+			XMVECTOR dz = XMLoadFloat4((const XMFLOAT4*)&(m_batch.DZ[k]));
+
+			XMVECTOR t = XMVectorMultiplyAdd(wx, dx, XMVectorMultiplyAdd(wy, dy, XMVectorMultiply(wz, dz)));
+			t = XMVectorSaturate(XMVectorMultiply(t, XMLoadFloat4((const XMFLOAT4*)&(m_batch.InvLengthSq[k]))));
+
+			XMVECTOR qx = XMVectorSubtract(XMVectorMultiply(t, dx), wx);
+			XMVECTOR qy = XMVectorSubtract(XMVectorMultiply(t, dy), wy);
+			XMVECTOR qz = XMVectorSubtract(XMVectorMultiply(t, dz), wz);
+			XMVECTOR distsq = XMVectorMultiplyAdd(qx, qx, XMVectorMultiplyAdd(qy, qy, XMVectorMultiply(qz, qz)));
+
+			int bits = SpatialQueryKernels::GetLaneMask(XMVectorLessOrEqual(distsq, radiussq));
+			if (bits == 0) continue;
+
+			// Confirm each potential (broadphase) collision with a precise test against the object OBB hierarchy
+			size_t lanes = min(width, bin.End - k);
+			for (size_t lane = 0U; lane < lanes; ++lane)
+			{
+				size_t p = k + lane;
+				if (!(bits & (1 << lane)) || m_batch.Collided[p]) continue;
+
+				// Prevent the projectile from colliding with its owner
+				std::vector<BasicProjectile>::size_type index = m_batch.Keys[p].second;
+				if (obj->GetID() == Items[index].Owner) continue;
+
+				XMVECTOR pos = XMVectorSet(m_batch.X[p], m_batch.Y[p], m_batch.Z[p], 0.0f);
+				XMVECTOR delta = XMVectorSet(m_batch.DX[p], m_batch.DY[p], m_batch.DZ[p], 0.0f);
+				if (Game::PhysicsEngine.DetermineLineVectorVsOBBHierarchyIntersection(pos, delta, obj->CollisionOBB, impact, results.OBBSearch))
+				{
+					// Record the impact; we cannot collide with more than one object
+					results.Impacts.push_back(ProjectileImpact(index, obj->GetID(), pos, delta));
+					m_batch.Collided[p] = 1;
+				}
+			}
+		}
+	}
+}
+
+// Moves every projectile in the given range of batch entries that did not collide with an object
+void BasicProjectileSet::MoveProjectiles(size_t start, size_t end)
+{
+	for (size_t k = start; k < end; ++k)
+	{
+		if (m_batch.Collided[k]) continue;
+
+		BasicProjectile & proj = Items[m_batch.Keys[k].second];
+		proj.Position = XMVectorAdd(proj.Position, XMVectorMultiply(proj.Velocity, Game::TimeFactorV));
+	}
+}
+
+// Handles all impacts in projectile index order, and then removes all expired or impacted projectiles from the collection
+void BasicProjectileSet::ApplyBatchResults(unsigned int task_count)
+{
+	m_impacts.clear();
+	for (unsigned int t = 0U; t < task_count; ++t)
+	{
+		m_impacts.insert(m_impacts.end(), m_tasks[t].Impacts.begin(), m_tasks[t].Impacts.end());
+	}
+
+	// Handle all impacts in projectile order.  An earlier impact may have removed the object or rebuilt its OBB hierarchy, so the
+	// object is resolved again by ID and the impact is determined again against its current hierarchy, as it would be in the 
+	// per-projectile simulation.  A projectile whose path is no longer obstructed continues along its path
+	std::sort(m_impacts.begin(), m_impacts.end(), [](const ProjectileImpact & lhs, const ProjectileImpact & rhs) { return (lhs.Index < rhs.Index); });
+	for (const auto & impact : m_impacts)
+	{
+		BasicProjectile & proj = Items[impact.Index];
+		iObject *obj = Game::GetObjectByID(impact.Object);
+		if (obj && Game::PhysicsEngine.DetermineLineVectorVsOBBHierarchyIntersection(impact.Position, impact.Delta, obj->CollisionOBB))
+		{
+			obj->HandleProjectileImpact(proj, Game::PhysicsEngine.OBBIntersectionResult);
+			m_removals.push_back(impact.Index);
+		}
+		else
+		{
+			proj.Position = XMVectorAdd(proj.Position, impact.Delta);
+		}
+	}
+
+	// Remove projectiles in descending index order, so that each removal only ever swaps in a projectile that is being retained
+	std::sort(m_removals.begin(), m_removals.end(), std::greater<std::vector<BasicProjectile>::size_type>());
+	for (auto index : m_removals)
+	{
+		if (!Active) break;
+		RemoveProjectile(index);
+	}
+}
+
+// Resets and sizes all streams for the given number of projectiles
+void BasicProjectileSet::BatchData::Reset(size_t count)
+{
+	size_t padded = (count + SpatialQueryKernels::BATCH_WIDTH);
+	X.assign(padded, 0.0f); Y.assign(padded, 0.0f); Z.assign(padded, 0.0f);
+	DX.assign(padded, 0.0f); DY.assign(padded, 0.0f); DZ.assign(padded, 0.0f);
+	InvLengthSq.assign(padded, 0.0f);
+	Collided.assign(count, 0);
+}
+
 
 
 
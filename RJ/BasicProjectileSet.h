@@ -4,7 +4,12 @@
 #define __BasicProjectileSetH__
 
 #include <vector>
+#include <functional>
+#include "AlignedAllocator.h"
+#include "Octree.h"
+#include "GamePhysicsEngine.h"
 #include "BasicProjectile.h"
+class iObject;
 
 // Extends the vector class
 // This class has no special alignment requirements
@@ -19,6 +24,21 @@ public:
 																								// time (ms) we can shrink the item collection
 	static const float										COLLISION_SEARCH_RADIUS;			// Distance within which we will perform projectile collision queries
 	static const float										COLLISION_COMMON_OBJECT_RADIUS_SQ;	// If projectiles are within this same sq-distance of each
+
+	// Methods available for simulating the projectile set.  In batched mode, projectiles are binned by spatial partitioning node
+	// each frame, a single collision search is performed per bin, and projectile paths are tested against each candidate in SIMD.
+	// Parallel mode executes the batched classification, collision testing and movement passes across the worker thread pool
+	enum class SimulationMode { PerProjectile = 0, Batched, Parallel };
+
+	// Number of parallel simulation tasks created per thread.  More tasks than threads helps to balance uneven bin sizes
+	static const unsigned int								PARALLEL_TASKS_PER_THREAD = 4U;
+
+	// Minimum number of live projectiles for which work will be distributed across threads in parallel mode
+	static const std::vector<BasicProjectile>::size_type	PARALLEL_MINIMUM_PROJECTILES = 256U;
+
+	// Returns or sets the method used to simulate all projectile sets.  Default: batched
+	CMPINLINE static SimulationMode							GetSimulationMode(void)						{ return m_simulation_mode; }
+	CMPINLINE static void									SetSimulationMode(SimulationMode mode)		{ m_simulation_mode = mode; }
 	
 	// Primary item collection
 	std::vector<BasicProjectile>							Items;
@@ -55,8 +75,6 @@ public:
 	// Accepts a pointer to the spatial partitioning tree for the current area as input
 	void													SimulateProjectiles(Octree<iObject*> *sp_tree);
 
-	// 
-
 	// Returns the number of projectiles currently active in the set
 	CMPINLINE std::vector<BasicProjectile>::size_type		GetActiveProjectileCount(void) const
 	{
@@ -65,6 +83,110 @@ public:
 
 protected:
 
+	// Simulates each projectile individually, performing a separate collision search for each
+	void													SimulateProjectilesIndividually(Octree<iObject*> *sp_tree);
+
+	// Simulates all projectiles in spatial bins, with one collision search per bin and SIMD path tests within each bin.  If 'parallel'
+	// is set, all per-projectile passes are distributed across the worker thread pool.  Collision searches and impact handling are
+	// always performed serially, and results do not depend on the number of threads or the order in which tasks execute
+	void													SimulateProjectilesBatched(Octree<iObject*> *sp_tree, bool parallel);
+
+	// Projectiles being simulated in the current frame, in SoA form and ordered by spatial bin.  Streams are padded by 
+	// one full batch so that tests can always load four lanes at once.  Retained between frames to avoid reallocation
+	// Class has no special alignment requirements
+	struct BatchData
+	{
+		typedef std::vector<float, AlignedAllocator<float, 16U>>						FloatStream;
+		typedef std::pair<Octree<iObject*>*, std::vector<BasicProjectile>::size_type>	BinKey;
+
+		std::vector<BinKey>									Keys;				// Spatial node & projectile index, sorted into bin order
+		FloatStream											X, Y, Z;			// Projectile position
+		FloatStream											DX, DY, DZ;			// Position delta for this frame
+		FloatStream											InvLengthSq;		// 1 / |delta|^2, or zero for a stationary projectile
+		std::vector<int>									Collided;			// Flag per projectile indicating that an impact was found
+
+		// Resets and sizes all streams for the given number of projectiles
+		void												Reset(size_t count);
+	};
+
+	// Contiguous range of projectiles within the batch that share a spatial node, and the range of their collision candidates
+	// Class has no special alignment requirements
+	struct SimulationBin
+	{
+		size_t												Start, End;
+		size_t												CandidateStart, CandidateEnd;
+
+		SimulationBin(size_t start, size_t end, size_t candidate_start, size_t candidate_end)
+			: Start(start), End(end), CandidateStart(candidate_start), CandidateEnd(candidate_end) { }
+	};
+
+	// Impact between a projectile and object, recorded during batched simulation and applied once all tests are complete.  Only
+	// the object ID and projectile path are recorded, since an earlier impact may remove the object or rebuild its OBB hierarchy
+	// Class is 16-bit aligned to allow use of SIMD member variables
+	__declspec(align(16))
+	struct ProjectileImpact : public ALIGN16<ProjectileImpact>
+	{
+		std::vector<BasicProjectile>::size_type				Index;				// Index of the impacting projectile
+		Game::ID_TYPE										Object;				// ID of the object being impacted
+		AXMVECTOR											Position;			// Projectile position at the start of the frame
+		AXMVECTOR											Delta;				// Projectile position delta for this frame
+
+		ProjectileImpact(std::vector<BasicProjectile>::size_type index, Game::ID_TYPE object, const FXMVECTOR position, const FXMVECTOR delta)
+			: Index(index), Object(object), Position(position), Delta(delta) { }
+	};
+
+	// Results recorded by a single simulation task.  Each task writes only to its own results, which are merged serially in task order
+	// Class has no special alignment requirements
+	struct TaskResults
+	{
+		std::vector<BatchData::BinKey>						Keys;				// Projectiles to be simulated, with their spatial node
+		std::vector<std::vector<BasicProjectile>::size_type>	Expired;		// Projectiles which have expired
+		std::vector<ProjectileImpact>						Impacts;			// Projectile impacts identified by the task
+		std::vector<OrientedBoundingBox*>					OBBSearch;			// Working storage for OBB hierarchy tests
+
+		CMPINLINE void										Clear(void)			{ Keys.clear(); Expired.clear(); Impacts.clear(); }
+	};
+
+	// Executes the given function once for each task index in [0, task_count), across the worker thread pool if there is more than one task
+	void													ExecuteTasks(unsigned int task_count, const std::function<void(unsigned int)> & fn);
+
+	// Returns the start of the given task's share of a range of 'count' items.  The task range is [start(task), start(task + 1))
+	CMPINLINE static size_t									TaskRangeStart(size_t count, unsigned int task, unsigned int task_count)
+	{
+		return ((count * task) / task_count);
+	}
+
+	// Identifies expired projectiles in the given index range, and determines the spatial node containing each of the others
+	void													ClassifyProjectiles(Octree<iObject*> *sp_tree, size_t start, size_t end, TaskResults & results);
+
+	// Populates the SoA projectile streams for the given range of (sorted) batch entries
+	void													PopulateBatchData(size_t start, size_t end);
+
+	// Identifies each bin in the sorted batch, and performs the collision search for each.  Executed serially, since object searches
+	// make use of shared search state.  All candidate OBB hierarchies are brought up-to-date so that they can be tested concurrently
+	void													BuildSimulationBins(void);
+
+	// Tests all projectiles in a bin against its collision candidates, recording any impacts
+	void													TestBinCollisions(const SimulationBin & bin, TaskResults & results);
+
+	// Moves every projectile in the given range of batch entries that did not collide with an object
+	void													MoveProjectiles(size_t start, size_t end);
+
+	// Handles all impacts in projectile index order, and then removes all expired or impacted projectiles from the collection
+	void													ApplyBatchResults(unsigned int task_count);
+
+	// Working data for batched simulation
+	BatchData												m_batch;
+	std::vector<SimulationBin>								m_bins;
+	std::vector<iObject*>									m_candidates;
+	std::vector<iObject*>									m_search_results;
+	std::vector<TaskResults>								m_tasks;
+	std::vector<ProjectileImpact>							m_impacts;
+	std::vector<std::vector<BasicProjectile>::size_type>	m_removals;
+
+	// Method currently used to simulate all projectile sets
+	static SimulationMode									m_simulation_mode;
+
 	// Record the half-item threshold that we use to determine when to possibly shrink the item vector
 	std::vector<BasicProjectile>::size_type					m_half_threshold;
 
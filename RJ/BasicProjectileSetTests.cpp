@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <cmath>
+#include "GameVarsExtern.h"
+#include "GameObjects.h"
+#include "ComplexShip.h"
+#include "ComplexShipSection.h"
+#include "ComplexShipElement.h"
+#include "BasicProjectileDefinition.h"
+#include "Damage.h"
+
+#include "BasicProjectileSetTests.h"
+
+
+// Dimensions of the test environment.  Grid y is aligned with the world z axis, so the environment is one element thick along z
+static const INTVECTOR3 PROJ_TEST_SIZE = INTVECTOR3(8, 1, 8);
+
+// Size of the spatial partitioning tree containing the test environment, which is centred on the origin
+static const float PROJ_TEST_TREE_SIZE = 2000.0f;
+
+// Time factor for each simulated frame.  Projectiles at the default speed will travel 25 units per frame
+static const float PROJ_TEST_FRAME_TIME = 0.25f;
+
+// Starting z coordinate of projectiles which will impact the environment (which has a z extent of 5) during their first frame
+static const float PROJ_TEST_START_Z = -15.0f;
+
+// Offset from the environment of projectiles which should miss it entirely
+static const float PROJ_TEST_MISS_OFFSET = 200.0f;
+
+
+TestResult BasicProjectileSetTests::MultipleEnvironmentImpactTests()
+{
+	TestResult result = NewResult();
+	BasicProjectileSet::SimulationMode mode = BasicProjectileSet::GetSimulationMode();
+	unsigned int clock = Game::ClockMs;
+	float timefactor = Game::TimeFactor;
+	XMVECTOR timefactorv = Game::TimeFactorV;
+
+	BasicProjectileSet::SetSimulationMode(BasicProjectileSet::SimulationMode::Batched);
+	Game::TimeFactor = PROJ_TEST_FRAME_TIME;
+	Game::TimeFactorV = XMVectorReplicate(PROJ_TEST_FRAME_TIME);
+
+	Octree<iObject*> sp_tree(XMVectorReplicate(PROJ_TEST_TREE_SIZE * -0.5f), PROJ_TEST_TREE_SIZE);
+	ComplexShip *env = GenerateTestEnvironment(sp_tree);
+
+	BasicProjectileDefinition def;
+	def.AddDamageType(Damage(DamageType::Kinetic, 1.0f));
+	BasicProjectileSet projectiles;
+	projectiles.Initialise();
+
+	// Two projectiles impact different elements in the same frame.  The first impact destroys its element and rebuilds the
+	// environment OBB hierarchy, which must not affect the second.  A third projectile follows the first along the same path,
+	// and should pass through the element that the first projectile destroyed
+	const INTVECTOR3 targets[] = { INTVECTOR3(2, 0, 3), INTVECTOR3(5, 0, 4), INTVECTOR3(2, 0, 3) };
+	for (const INTVECTOR3 & target : targets)
+	{
+		projectiles.AddProjectile(&def, 0U, DetermineElementTargetPosition(env, target, PROJ_TEST_START_Z), ID_QUATERNION, NULL_VECTOR);
+	}
+
+	SimulateFrame(projectiles, sp_tree);
+
+	result.AssertTrue(env->GetElement(targets[0])->IsDestroyed(), ERR("First impacted element was not destroyed"));
+	result.AssertTrue(env->GetElement(targets[1])->IsDestroyed(), ERR("Second impacted element was not destroyed after the first impact rebuilt the OBB hierarchy"));
+	result.AssertEqual(DetermineDestroyedElementCount(env), 3, ERR("Incorrect number of elements destroyed by projectile impacts"));
+	result.AssertEqual(projectiles.GetActiveProjectileCount(), (std::vector<BasicProjectile>::size_type)1U, ERR("Incorrect number of projectiles remaining after impacts"));
+
+	if (projectiles.GetActiveProjectileCount() == 1U)
+	{
+		XMVECTOR expected = XMVectorAdd(DetermineElementTargetPosition(env, targets[2], PROJ_TEST_START_Z), XMVectorSet(0.0f, 0.0f, def.Speed * PROJ_TEST_FRAME_TIME, 0.0f));
+		result.AssertTrue(XMVector3NearEqual(projectiles.Items[0].Position, expected, XMVectorReplicate(0.01f)),
+			ERR("Projectile did not continue through the element destroyed by an earlier impact"));
+	}
+
+	ReleaseTestEnvironment(env);
+
+	BasicProjectileSet::SetSimulationMode(mode);
+	Game::ClockMs = clock;
+	Game::TimeFactor = timefactor;
+	Game::TimeFactorV = timefactorv;
+	return result;
+}
+
+TestResult BasicProjectileSetTests::SimulationModeEquivalenceTests()
+{
+	TestResult result = NewResult();
+	BasicProjectileSet::SimulationMode mode = BasicProjectileSet::GetSimulationMode();
+	unsigned int clock = Game::ClockMs;
+	float timefactor = Game::TimeFactor;
+	XMVECTOR timefactorv = Game::TimeFactorV;
+
+	Game::TimeFactor = PROJ_TEST_FRAME_TIME;
+	Game::TimeFactorV = XMVectorReplicate(PROJ_TEST_FRAME_TIME);
+
+	// Per-projectile simulation is the reference for all other modes
+	std::vector<bool> expected_destroyed;
+	std::vector<XMFLOAT3> expected_positions;
+	RunEquivalenceScenario(BasicProjectileSet::SimulationMode::PerProjectile, expected_destroyed, expected_positions);
+
+	// Every element is destroyed by the end of the scenario.  Projectiles remain if they followed another through an element 
+	// which it destroyed (including the corner element, which is destroyed beforehand), or if they missed the environment
+	result.AssertEqual((int)std::count(expected_destroyed.begin(), expected_destroyed.end(), true), (PROJ_TEST_SIZE.x * PROJ_TEST_SIZE.y * PROJ_TEST_SIZE.z),
+		ERR("Per-projectile simulation did not destroy all elements in the scenario"));
+	result.AssertEqual(expected_positions.size(), (size_t)193U, ERR("Incorrect number of projectiles remaining after per-projectile simulation"));
+
+	const BasicProjectileSet::SimulationMode modes[] = { BasicProjectileSet::SimulationMode::Batched, BasicProjectileSet::SimulationMode::Parallel };
+	for (BasicProjectileSet::SimulationMode test_mode : modes)
+	{
+		std::string name = (test_mode == BasicProjectileSet::SimulationMode::Batched ? "Batched" : "Parallel");
+		std::vector<bool> destroyed;
+		std::vector<XMFLOAT3> positions;
+		RunEquivalenceScenario(test_mode, destroyed, positions);
+
+		result.AssertTrue(destroyed == expected_destroyed, ERR(concat(name)(" simulation destroyed different elements to per-projectile simulation").str()));
+		result.AssertEqual(positions.size(), expected_positions.size(), ERR(concat(name)(" simulation left a different number of projectiles to per-projectile simulation").str()));
+
+		bool identical = (positions.size() == expected_positions.size());
+		for (size_t i = 0U; i < positions.size() && identical; ++i)
+		{
+			identical = (fabs(positions[i].x - expected_positions[i].x) < 0.01f && fabs(positions[i].y - expected_positions[i].y) < 0.01f &&
+						 fabs(positions[i].z - expected_positions[i].z) < 0.01f);
+		}
+		result.AssertTrue(identical, ERR(concat(name)(" simulation left projectiles in different positions to per-projectile simulation").str()));
+	}
+
+	BasicProjectileSet::SetSimulationMode(mode);
+	Game::ClockMs = clock;
+	Game::TimeFactor = timefactor;
+	Game::TimeFactorV = timefactorv;
+	return result;
+}
+
+ComplexShip * BasicProjectileSetTests::GenerateTestEnvironment(Octree<iObject*> & sp_tree)
+{
+	ComplexShipSection *sec = new ComplexShipSection();
+	sec->ResizeSection(PROJ_TEST_SIZE);
+	sec->DefaultElementState.ApplyDefaultElementState(ElementStateDefinition::ElementState(ComplexShipElement::PROPERTY::PROP_ACTIVE));
+
+	ComplexShip *env = new ComplexShip();
+	env->InitialiseElements(PROJ_TEST_SIZE);
+	env->AddShipSection(sec);
+	env->UpdateEnvironment();
+
+	int n = env->GetElementCount();
+	for (int i = 0; i < n; ++i)
+		env->GetElementDirect(i).SetProperty(ComplexShipElement::PROPERTY::PROP_ACTIVE);
+
+	// Destroy one corner element so that the OBB hierarchy is subdivided
+	env->GetElementDirect(0).SetHealth(0.0f);
+	env->UpdateEnvironment();
+
+	env->SetPosition(NULL_VECTOR);
+	env->SetOrientation(ID_QUATERNION);
+	env->RefreshPositionImmediate();
+
+	// Impacts are resolved by object ID, so the environment must be registered
+	env->SetSimulationState(iObject::ObjectSimulationState::FullSimulation);
+	sp_tree.AddItem(env, env->GetPosition());
+
+	return env;
+}
+
+void BasicProjectileSetTests::ReleaseTestEnvironment(ComplexShip *env)
+{
+	if (!env) return;
+	if (env->GetSpatialTreeNode()) env->GetSpatialTreeNode()->RemoveItem(env);
+
+	Game::UnregisterObject(env);
+}
+
+XMVECTOR BasicProjectileSetTests::DetermineElementTargetPosition(ComplexShip *env, const INTVECTOR3 & element, float z)
+{
+	// Element positions are relative to the environment centre
+	XMVECTOR pos = XMVectorSubtract(XMVectorAdd(Game::ElementLocationToPhysicalPosition(element), Game::C_CS_ELEMENT_MIDPOINT_V),
+									XMVectorScale(env->GetSize(), 0.5f));
+
+	return XMVectorSetZ(XMVectorAdd(env->GetPosition(), pos), z);
+}
+
+void BasicProjectileSetTests::SimulateFrame(BasicProjectileSet & projectiles, Octree<iObject*> & sp_tree)
+{
+	// Projectiles are not simulated in the frame they are launched, so the clock must always advance
+	++Game::ClockMs;
+	projectiles.SimulateProjectiles(&sp_tree);
+}
+
+void BasicProjectileSetTests::RunEquivalenceScenario(BasicProjectileSet::SimulationMode mode, std::vector<bool> & outDestroyed, std::vector<XMFLOAT3> & outPositions)
+{
+	BasicProjectileSet::SetSimulationMode(mode);
+
+	Octree<iObject*> sp_tree(XMVectorReplicate(PROJ_TEST_TREE_SIZE * -0.5f), PROJ_TEST_TREE_SIZE);
+	ComplexShip *env = GenerateTestEnvironment(sp_tree);
+
+	BasicProjectileDefinition def;
+	def.AddDamageType(Damage(DamageType::Kinetic, 1.0f));
+	BasicProjectileSet projectiles;
+	projectiles.Initialise();
+
+	// For each element in a checkerboard pattern, two projectiles impact in the first frame; the second follows the first through
+	// the element that it destroys.  One projectile per element impacts in the second frame, once half of the elements have been 
+	// destroyed.  Two projectiles per element miss the environment.  This provides enough projectiles to distribute the first 
+	// frame across worker threads in parallel mode
+	float far_z = (PROJ_TEST_START_Z - (def.Speed * PROJ_TEST_FRAME_TIME));
+	XMVECTOR miss_x = XMVectorSet(PROJ_TEST_MISS_OFFSET, 0.0f, 0.0f, 0.0f), miss_y = XMVectorSet(0.0f, PROJ_TEST_MISS_OFFSET, 0.0f, 0.0f);
+	for (int z = 0; z < PROJ_TEST_SIZE.z; ++z)
+	{
+		for (int x = 0; x < PROJ_TEST_SIZE.x; ++x)
+		{
+			INTVECTOR3 element(x, 0, z);
+			XMVECTOR near_pos = DetermineElementTargetPosition(env, element, PROJ_TEST_START_Z);
+			if ((x + z) % 2 == 0)
+			{
+				projectiles.AddProjectile(&def, 0U, near_pos, ID_QUATERNION, NULL_VECTOR);
+				projectiles.AddProjectile(&def, 0U, near_pos, ID_QUATERNION, NULL_VECTOR);
+			}
+
+			projectiles.AddProjectile(&def, 0U, DetermineElementTargetPosition(env, element, far_z), ID_QUATERNION, NULL_VECTOR);
+			projectiles.AddProjectile(&def, 0U, XMVectorAdd(near_pos, miss_x), ID_QUATERNION, NULL_VECTOR);
+			projectiles.AddProjectile(&def, 0U, XMVectorAdd(near_pos, miss_y), ID_QUATERNION, NULL_VECTOR);
+		}
+	}
+
+	SimulateFrame(projectiles, sp_tree);
+	SimulateFrame(projectiles, sp_tree);
+
+	outDestroyed.clear();
+	int n = env->GetElementCount();
+	for (int i = 0; i < n; ++i) outDestroyed.push_back(env->GetElementDirect(i).IsDestroyed());
+
+	// Projectiles are reordered differently by each mode as they are removed, so positions are compared in sorted order
+	outPositions.clear();
+	std::vector<BasicProjectile>::size_type count = projectiles.GetActiveProjectileCount();
+	for (std::vector<BasicProjectile>::size_type i = 0U; i < count; ++i)
+	{
+		XMFLOAT3 pos; XMStoreFloat3(&pos, projectiles.Items[i].Position);
+		outPositions.push_back(pos);
+	}
+
+	std::sort(outPositions.begin(), outPositions.end(), [](const XMFLOAT3 & lhs, const XMFLOAT3 & rhs)
+	{
+		return (lhs.x != rhs.x ? (lhs.x < rhs.x) : (lhs.y != rhs.y ? (lhs.y < rhs.y) : (lhs.z < rhs.z)));
+	});
+
+	ReleaseTestEnvironment(env);
+}
+
+int BasicProjectileSetTests::DetermineDestroyedElementCount(ComplexShip *env)
+{
+	int count = 0;
+	int n = env->GetElementCount();
+	for (int i = 0; i < n; ++i)
+	{
+		if (env->GetElementDirect(i).IsDestroyed()) ++count;
+	}
+
+	return count;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <vector>
+#include "CompilerSettings.h"
+#include "TestBase.h"
+#include "IntVector.h"
+#include "Octree.h"
+#include "BasicProjectileSet.h"
+class iObject;
+class ComplexShip;
+
+class BasicProjectileSetTests : public TestBase
+{
+public:
+
+	CMPINLINE TestResult RunTests(void)
+	{
+		TestResult result = NewNamedResult(BasicProjectileSetTests);
+
+		result += MultipleEnvironmentImpactTests();
+		result += SimulationModeEquivalenceTests();
+
+		return result;
+	}
+
+
+private:
+
+	TestResult MultipleEnvironmentImpactTests();
+	TestResult SimulationModeEquivalenceTests();
+
+	// Generates an environment which is one element thick along the world z axis, with one destroyed corner element so that its
+	// OBB hierarchy contains child nodes.  The environment is registered and added to the given spatial partitioning tree
+	ComplexShip * GenerateTestEnvironment(Octree<iObject*> & sp_tree);
+
+	// Removes a test environment from its spatial partitioning tree and unregisters it, which also deallocates the environment
+	void ReleaseTestEnvironment(ComplexShip *env);
+
+	// Returns a world position in line with the centre of the given element along the z axis, at the specified z coordinate
+	XMVECTOR DetermineElementTargetPosition(ComplexShip *env, const INTVECTOR3 & element, float z);
+
+	// Advances the game clock and simulates all projectiles for a single frame
+	void SimulateFrame(BasicProjectileSet & projectiles, Octree<iObject*> & sp_tree);
+
+	// Simulates a fixed scenario of projectiles impacting, following and missing an environment in the given simulation mode.
+	// Returns the final destruction state of each element, and the positions of all remaining projectiles in sorted order
+	void RunEquivalenceScenario(BasicProjectileSet::SimulationMode mode, std::vector<bool> & outDestroyed, std::vector<XMFLOAT3> & outPositions);
+
+	// Returns the number of destroyed elements in the environment
+	int DetermineDestroyedElementCount(ComplexShip *env);
+
+};
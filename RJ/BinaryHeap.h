@@ -171,6 +171,23 @@ public:
 		}
 	}
 
+	/**************************************************************************
+	  DecreaseItemValue: Assigns a new (lower) value to an existing item, and moves it to the correct
+	  position in the heap.  No action is taken if the item is not in the heap
+	 **************************************************************************/
+	void DecreaseItemValue(TItem item, TVal value)
+	{
+		for (int i = 1; i <= Size; ++i)
+		{
+			if (Items[i].Item == item)
+			{
+				Items[i].Value = value;
+				ReorderElement(i);
+				return;
+			}
+		}
+	}
+
 	/**************************************************************************
 	  ReorderElement: Reorders an existing element, if required due to a change in its value
 	 **************************************************************************/
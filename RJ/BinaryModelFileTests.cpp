@@ -0,0 +1,344 @@
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include "ModelData.h"
+#include "BinaryModelFile.h"
+
+#include "BinaryModelFileTests.h"
+
+
+TestResult BinaryModelFileTests::SingleMeshRoundTripTests()
+{
+	TestResult result = NewResult();
+
+	std::unique_ptr<ModelData> model = GenerateTestModel(12U, 9U, 3U);
+	ByteString data = BinaryModelFile::Serialize({ model.get() });
+	result.AssertTrue(BinaryModelFile::IsBinaryModelData(data.data(), data.size()), ERR("Serialized data is not recognised as a binary model file"));
+
+	// Loading from memory should return a single mesh with identical data
+	std::vector<std::unique_ptr<ModelData>> loaded = BinaryModelFile::Load(data.data(), data.size(), true);
+	result.AssertEqual(loaded.size(), (size_t)1U, ERR("Incorrect number of meshes loaded from single-mesh file"));
+	if (loaded.size() != 1U) return result;
+
+	result.AssertTrue(ModelDataMatches(*model, *loaded[0]), ERR("Single mesh data does not match source following round trip"));
+	result.AssertFalse(loaded[0]->HasExternalData(), ERR("Mesh loaded from unowned memory should hold its own copy of the data"));
+	result.AssertTrue(loaded[0]->Lods.empty(), ERR("Mesh with no LOD chain was loaded with LOD meshes"));
+
+	// Serializing without checksums should load identically, with or without verification requested
+	ByteString unchecked = BinaryModelFile::Serialize({ model.get() }, false);
+	loaded = BinaryModelFile::Load(unchecked.data(), unchecked.size(), true);
+	result.AssertEqual(loaded.size(), (size_t)1U, ERR("Incorrect number of meshes loaded from file without checksums"));
+	if (!loaded.empty()) result.AssertTrue(ModelDataMatches(*model, *loaded[0]), ERR("Mesh data without checksums does not match source"));
+
+	return result;
+}
+
+TestResult BinaryModelFileTests::MultipleMeshRoundTripTests()
+{
+	TestResult result = NewResult();
+
+	// Meshes of varying sizes, including an empty mesh, should each be returned in their original order
+	std::vector<std::unique_ptr<ModelData>> models;
+	models.push_back(GenerateTestModel(4U, 4U, 0U));
+	models.push_back(GenerateTestModel(31U, 7U, 1U));
+	models.push_back(GenerateTestModel(0U, 0U, 2U));
+	models.push_back(GenerateTestModel(1U, 1U, 5U));
+
+	std::vector<const ModelData*> source;
+	for (const auto & model : models) source.push_back(model.get());
+
+	ByteString data = BinaryModelFile::Serialize(source);
+	std::vector<std::unique_ptr<ModelData>> loaded = BinaryModelFile::Load(data.data(), data.size(), true);
+	result.AssertEqual(loaded.size(), models.size(), ERR("Incorrect number of meshes loaded from multi-mesh file"));
+	if (loaded.size() != models.size()) return result;
+
+	for (size_t i = 0U; i < models.size(); ++i)
+	{
+		result.AssertTrue(ModelDataMatches(*models[i], *loaded[i]), ERR(concat("Mesh ")(i)(" does not match source following multi-mesh round trip").str()));
+	}
+
+	return result;
+}
+
+TestResult BinaryModelFileTests::InvalidFileRejectionTests()
+{
+	TestResult result = NewResult();
+
+	std::unique_ptr<ModelData> first = GenerateTestModel(10U, 10U, 0U), second = GenerateTestModel(6U, 3U, 1U);
+	ByteString data = BinaryModelFile::Serialize({ first.get(), second.get() });
+	result.AssertEqual(BinaryModelFile::Load(data.data(), data.size(), true).size(), (size_t)2U, ERR("Valid file was not loaded"));
+
+	// Truncated files should be rejected, wherever the truncation occurs
+	const size_t truncated_sizes[] = { 0U, sizeof(BinaryModelFile::FileHeader) - 1U, sizeof(BinaryModelFile::FileHeader), data.size() / 2U, data.size() - 1U };
+	for (size_t size : truncated_sizes)
+	{
+		result.AssertTrue(BinaryModelFile::Load(data.data(), size, true).empty(), ERR(concat("File truncated to ")(size)(" bytes was not rejected").str()));
+	}
+
+	// Data which does not begin with the file identifier should be rejected
+	ByteString invalid_id = data;
+	invalid_id[0] = (invalid_id[0] ^ 0xFF);
+	result.AssertTrue(BinaryModelFile::Load(invalid_id.data(), invalid_id.size(), true).empty(), ERR("File with invalid identifier was not rejected"));
+
+	// Corruption of the mesh table, vertex data or index data should be detected via checksum.  The final mesh in the
+	// file is corrupted so that a partially-loaded set of meshes would be detected
+	BinaryModelFile::MeshEntry entry;
+	memcpy(&entry, &(data[sizeof(BinaryModelFile::FileHeader) + sizeof(BinaryModelFile::MeshEntry)]), sizeof(BinaryModelFile::MeshEntry));
+	const size_t corrupt_offsets[] = { (size_t)sizeof(BinaryModelFile::FileHeader), (size_t)entry.VertexDataOffset + 5U, (size_t)entry.IndexDataOffset + 1U };
+	const char *corrupt_regions[] = { "mesh table", "vertex data", "index data" };
+	for (int i = 0; i < 3; ++i)
+	{
+		ByteString corrupt = data;
+		corrupt[corrupt_offsets[i]] = (corrupt[corrupt_offsets[i]] ^ 0x01);
+		result.AssertTrue(BinaryModelFile::Load(corrupt.data(), corrupt.size(), true).empty(),
+			ERR(concat("Checksum mismatch in ")(corrupt_regions[i])(" was not rejected").str()));
+	}
+
+	// Verification is optional; data corruption cannot be detected if checksums are not verified
+	ByteString corrupt = data;
+	corrupt[(size_t)entry.IndexDataOffset + 1U] = (corrupt[(size_t)entry.IndexDataOffset + 1U] ^ 0x01);
+	result.AssertEqual(BinaryModelFile::Load(corrupt.data(), corrupt.size(), false).size(), (size_t)2U, ERR("File was not loaded when checksum verification was disabled"));
+
+	return result;
+}
+
+TestResult BinaryModelFileTests::LodChainTests()
+{
+	TestResult result = NewResult();
+
+	// First mesh has a chain of two LODs; second mesh has none
+	std::unique_ptr<ModelData> first = GenerateTestModel(16U, 16U, 0U), second = GenerateTestModel(5U, 8U, 1U);
+	first->Lods.push_back(GenerateTestModel(8U, 8U, 0U));
+	first->Lods.back()->LodError = 0.125f;
+	first->Lods.push_back(GenerateTestModel(3U, 3U, 0U));
+	first->Lods.back()->LodError = 0.5f;
+
+	ByteString data = BinaryModelFile::Serialize({ first.get(), second.get() });
+	BinaryModelFile::FileHeader header;
+	memcpy(&header, data.data(), sizeof(BinaryModelFile::FileHeader));
+	result.AssertEqual(header.MeshCount, 4U, ERR("LOD meshes were not written to the mesh table"));
+
+	// LOD meshes should be attached to the full-detail mesh which precedes them, rather than returned separately
+	std::vector<std::unique_ptr<ModelData>> loaded = BinaryModelFile::Load(data.data(), data.size(), true);
+	result.AssertEqual(loaded.size(), (size_t)2U, ERR("LOD meshes were returned as separate meshes"));
+	if (loaded.size() != 2U) return result;
+
+	result.AssertTrue(ModelDataMatches(*first, *loaded[0]), ERR("Full-detail mesh does not match source"));
+	result.AssertTrue(ModelDataMatches(*second, *loaded[1]), ERR("Mesh following LOD chain does not match source"));
+	result.AssertEqual(loaded[0]->Lods.size(), (size_t)2U, ERR("Incorrect number of LOD meshes attached to full-detail mesh"));
+	result.AssertTrue(loaded[1]->Lods.empty(), ERR("LOD meshes were attached to the wrong mesh"));
+	for (size_t i = 0U; i < loaded[0]->Lods.size() && i < first->Lods.size(); ++i)
+	{
+		result.AssertTrue(ModelDataMatches(*first->Lods[i], *loaded[0]->Lods[i]), ERR(concat("LOD ")(i + 1U)(" does not match source").str()));
+		result.AssertTrue(std::fabs(loaded[0]->Lods[i]->LodError - first->Lods[i]->LodError) <= (1.0f / (float)BinaryModelFile::LOD_ERROR_SCALE),
+			ERR(concat("LOD ")(i + 1U)(" error was not preserved within quantisation tolerance").str()));
+	}
+
+	// Each LOD must directly follow the previous level of the same mesh; an out-of-sequence level should be rejected
+	ByteString invalid = BinaryModelFile::Serialize({ first.get(), second.get() }, false);
+	BinaryModelFile::MeshEntry entry;
+	size_t entry_offset = (sizeof(BinaryModelFile::FileHeader) + sizeof(BinaryModelFile::MeshEntry));
+	memcpy(&entry, &(invalid[entry_offset]), sizeof(BinaryModelFile::MeshEntry));
+	entry.LodLevel = 2U;
+	memcpy(&(invalid[entry_offset]), &entry, sizeof(BinaryModelFile::MeshEntry));
+	result.AssertTrue(BinaryModelFile::Load(invalid.data(), invalid.size(), true).empty(), ERR("File with out-of-sequence LOD level was not rejected"));
+
+	return result;
+}
+
+TestResult BinaryModelFileTests::CompressedRoundTripTests()
+{
+	TestResult result = NewResult();
+
+	// Swap the first and last triangles so that the index deltas include large jumps in both directions, which require
+	// multi-byte encodings
+	std::unique_ptr<ModelData> model = GenerateTestModel(100U, 100U, 2U);
+	for (unsigned int i = 0U; i < 3U; ++i)
+	{
+		std::swap(model->IndexData[i], model->IndexData[model->IndexCount - 3U + i]);
+	}
+
+	ByteString data = BinaryModelFile::Serialize({ model.get() }, true, true);
+	ByteString uncompressed = BinaryModelFile::Serialize({ model.get() }, true, false);
+	result.AssertTrue(data.size() < uncompressed.size(), ERR("Compressed file is not smaller than uncompressed equivalent"));
+
+	std::vector<std::unique_ptr<ModelData>> loaded = BinaryModelFile::Load(data.data(), data.size(), true);
+	result.AssertEqual(loaded.size(), (size_t)1U, ERR("Incorrect number of meshes loaded from compressed file"));
+	if (loaded.size() != 1U) return result;
+
+	const ModelData & m = *loaded[0];
+	result.AssertEqual(m.VertexCount, model->VertexCount, ERR("Vertex count was not preserved through compression"));
+	result.AssertEqual(m.IndexCount, model->IndexCount, ERR("Index count was not preserved through compression"));
+	if (m.VertexCount != model->VertexCount || m.IndexCount != model->IndexCount) return result;
+
+	// Index compression is lossless
+	result.AssertTrue(memcmp(m.IndexData, model->IndexData, sizeof(INDEX_BUFFER_TYPE) * model->IndexCount) == 0, ERR("Indices were not preserved exactly through compression"));
+
+	// Positions should be within one quantisation step of the source, on each axis
+	BinaryModelFile::MeshEntry entry;
+	BinaryModelFile::CompressedMeshHeader mesh_header;
+	memcpy(&entry, &(data[sizeof(BinaryModelFile::FileHeader)]), sizeof(BinaryModelFile::MeshEntry));
+	memcpy(&mesh_header, &(data[(size_t)entry.VertexDataOffset]), sizeof(BinaryModelFile::CompressedMeshHeader));
+	const float step[3] = { mesh_header.PositionExtent.x / 65535.0f, mesh_header.PositionExtent.y / 65535.0f, mesh_header.PositionExtent.z / 65535.0f };
+
+	unsigned int position_errors = 0U, normal_errors = 0U, tex_errors = 0U;
+	for (unsigned int i = 0U; i < m.VertexCount; ++i)
+	{
+		const ModelData::TVertex & expected = model->VertexData[i], & actual = m.VertexData[i];
+		if (std::fabs(actual.position.x - expected.position.x) > step[0] || std::fabs(actual.position.y - expected.position.y) > step[1] ||
+			std::fabs(actual.position.z - expected.position.z) > step[2]) ++position_errors;
+
+		float dot = (actual.normal.x * expected.normal.x) + (actual.normal.y * expected.normal.y) + (actual.normal.z * expected.normal.z);
+		if (dot < 0.9999f) ++normal_errors;
+
+		if (std::fabs(actual.tex.x - expected.tex.x) > (1.0f / 1024.0f) || std::fabs(actual.tex.y - expected.tex.y) > (1.0f / 1024.0f)) ++tex_errors;
+	}
+
+	result.AssertEqual(position_errors, 0U, ERR("Vertex positions were not preserved within the quantisation step"));
+	result.AssertEqual(normal_errors, 0U, ERR("Vertex normals were not preserved within tolerance"));
+	result.AssertEqual(tex_errors, 0U, ERR("Texture coordinates were not preserved within half-precision tolerance"));
+
+	return result;
+}
+
+TestResult BinaryModelFileTests::CompressedZeroVectorTests()
+{
+	TestResult result = NewResult();
+
+	// Model has no tangent-space data, and a single vertex with no normal
+	std::unique_ptr<ModelData> model = GenerateTestModel(4U, 4U, 0U);
+	for (unsigned int i = 0U; i < model->VertexCount; ++i)
+	{
+		model->VertexData[i].tangent = model->VertexData[i].binormal = XMFLOAT3(0.0f, 0.0f, 0.0f);
+	}
+	model->VertexData[0].normal = XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+	// Zero vectors should be encoded with the reserved value, rather than as an arbitrary unit vector
+	ByteString data = BinaryModelFile::Serialize({ model.get() }, true, true);
+	BinaryModelFile::MeshEntry entry;
+	memcpy(&entry, &(data[sizeof(BinaryModelFile::FileHeader)]), sizeof(BinaryModelFile::MeshEntry));
+
+	unsigned int encoding_errors = 0U;
+	for (unsigned int i = 0U; i < model->VertexCount; ++i)
+	{
+		BinaryModelFile::CompressedVertex v;
+		memcpy(&v, &(data[(size_t)entry.VertexDataOffset + sizeof(BinaryModelFile::CompressedMeshHeader) + (i * sizeof(BinaryModelFile::CompressedVertex))]), sizeof(BinaryModelFile::CompressedVertex));
+
+		bool zero_normal = (v.Normal[0] == BinaryModelFile::ZERO_VECTOR_ENCODING && v.Normal[1] == BinaryModelFile::ZERO_VECTOR_ENCODING);
+		if (zero_normal != (i == 0U)) ++encoding_errors;
+		if (v.Tangent[0] != BinaryModelFile::ZERO_VECTOR_ENCODING || v.Tangent[1] != BinaryModelFile::ZERO_VECTOR_ENCODING) ++encoding_errors;
+		if (v.Binormal[0] != BinaryModelFile::ZERO_VECTOR_ENCODING || v.Binormal[1] != BinaryModelFile::ZERO_VECTOR_ENCODING) ++encoding_errors;
+	}
+	result.AssertEqual(encoding_errors, 0U, ERR("Zero vectors were not encoded using the reserved zero-vector encoding"));
+
+	// Zero vectors should be restored exactly on load
+	std::vector<std::unique_ptr<ModelData>> loaded = BinaryModelFile::Load(data.data(), data.size(), true);
+	result.AssertEqual(loaded.size(), (size_t)1U, ERR("Compressed file with zero vectors was not loaded"));
+	if (loaded.size() != 1U) return result;
+
+	result.AssertFalse(loaded[0]->DetermineIfTangentSpaceDataPresent(), ERR("Tangent-space data was not restored as zero vectors"));
+	result.AssertTrue(loaded[0]->VertexData[0].normal.x == 0.0f && loaded[0]->VertexData[0].normal.y == 0.0f && loaded[0]->VertexData[0].normal.z == 0.0f,
+		ERR("Zero normal was not restored as a zero vector"));
+	result.AssertTrue(loaded[0]->DetemineIfNormalDataPresent(), ERR("Non-zero normals were lost alongside zero vectors"));
+
+	return result;
+}
+
+TestResult BinaryModelFileTests::CompressedIndexRejectionTests()
+{
+	TestResult result = NewResult();
+
+	// Checksums are omitted, so that an inconsistent index block must be detected by the decoder itself
+	std::unique_ptr<ModelData> first = GenerateTestModel(12U, 12U, 0U), second = GenerateTestModel(7U, 5U, 1U);
+	ByteString data = BinaryModelFile::Serialize({ first.get(), second.get() }, false, true);
+	result.AssertEqual(BinaryModelFile::Load(data.data(), data.size(), true).size(), (size_t)2U, ERR("Valid compressed file was not loaded"));
+
+	size_t entry_offset = sizeof(BinaryModelFile::FileHeader);
+	BinaryModelFile::MeshEntry entry;
+	memcpy(&entry, &(data[entry_offset]), sizeof(BinaryModelFile::MeshEntry));
+
+	// Index blocks which are shorter or longer than the encoded indices should be rejected
+	const int size_changes[] = { -1, 1 };
+	for (int change : size_changes)
+	{
+		ByteString invalid = data;
+		BinaryModelFile::CompressedMeshHeader mesh_header;
+		memcpy(&mesh_header, &(invalid[(size_t)entry.VertexDataOffset]), sizeof(BinaryModelFile::CompressedMeshHeader));
+		mesh_header.IndexDataSize = (uint32_t)((int)mesh_header.IndexDataSize + change);
+		memcpy(&(invalid[(size_t)entry.VertexDataOffset]), &mesh_header, sizeof(BinaryModelFile::CompressedMeshHeader));
+
+		result.AssertTrue(BinaryModelFile::Load(invalid.data(), invalid.size(), true).empty(),
+			ERR(concat("Compressed index block with incorrect size (")(change > 0 ? "+" : "")(change)(" bytes) was not rejected").str()));
+	}
+
+	// Index blocks which hold a different number of indices than the mesh table describes should be rejected
+	const int count_changes[] = { -1, 1 };
+	for (int change : count_changes)
+	{
+		ByteString invalid = data;
+		BinaryModelFile::MeshEntry invalid_entry = entry;
+		invalid_entry.IndexCount = (uint32_t)((int)invalid_entry.IndexCount + change);
+		memcpy(&(invalid[entry_offset]), &invalid_entry, sizeof(BinaryModelFile::MeshEntry));
+
+		result.AssertTrue(BinaryModelFile::Load(invalid.data(), invalid.size(), true).empty(),
+			ERR(concat("Compressed index block with incorrect index count (")(change > 0 ? "+" : "")(change)(") was not rejected").str()));
+	}
+
+	return result;
+}
+
+std::unique_ptr<ModelData> BinaryModelFileTests::GenerateTestModel(unsigned int rows, unsigned int columns, unsigned int material)
+{
+	std::unique_ptr<ModelData> model = std::make_unique<ModelData>();
+	model->ModelMaterialIndex = material;
+
+	unsigned int vertex_count = ((rows == 0U || columns == 0U) ? 0U : ((rows + 1U) * (columns + 1U)));
+	unsigned int index_count = (rows * columns * 6U);
+	model->AllocateVertexData(vertex_count);
+	model->AllocateIndexData(index_count);
+	model->VertexCount = vertex_count;
+	model->IndexCount = index_count;
+
+	// Vertices form an undulating grid, so that every attribute varies across the mesh
+	for (unsigned int r = 0U; r <= rows && vertex_count != 0U; ++r)
+	{
+		for (unsigned int c = 0U; c <= columns; ++c)
+		{
+			ModelData::TVertex & v = model->VertexData[(r * (columns + 1U)) + c];
+			float x = (float)c - (columns * 0.5f), z = (float)r * 1.5f, y = std::sin(x * 0.7f) * std::cos(z * 0.3f);
+			v.position = XMFLOAT3(x, y, z);
+
+			float nx = -std::cos(x * 0.7f) * 0.7f * std::cos(z * 0.3f), nz = std::sin(x * 0.7f) * std::sin(z * 0.3f) * 0.3f;
+			float length = std::sqrt((nx * nx) + 1.0f + (nz * nz));
+			v.normal = XMFLOAT3(nx / length, 1.0f / length, nz / length);
+			v.tangent = XMFLOAT3(1.0f, 0.0f, 0.0f);
+			v.binormal = XMFLOAT3(0.0f, 0.0f, 1.0f);
+			v.tex = XMFLOAT2((float)c / (float)columns, (float)r / (float)rows);
+		}
+	}
+
+	for (unsigned int r = 0U, i = 0U; r < rows; ++r)
+	{
+		for (unsigned int c = 0U; c < columns; ++c)
+		{
+			INDEX_BUFFER_TYPE v0 = (r * (columns + 1U)) + c, v1 = v0 + 1U, v2 = v0 + (columns + 1U), v3 = v2 + 1U;
+			model->IndexData[i++] = v0; model->IndexData[i++] = v2; model->IndexData[i++] = v1;
+			model->IndexData[i++] = v1; model->IndexData[i++] = v2; model->IndexData[i++] = v3;
+		}
+	}
+
+	model->RecalculateDerivedData();
+	return model;
+}
+
+bool BinaryModelFileTests::ModelDataMatches(const ModelData & expected, const ModelData & actual)
+{
+	if (expected.ModelMaterialIndex != actual.ModelMaterialIndex || expected.VertexCount != actual.VertexCount || expected.IndexCount != actual.IndexCount) return false;
+	if (memcmp(&(expected.SizeProperties.MinBounds), &(actual.SizeProperties.MinBounds), sizeof(XMFLOAT3)) != 0 ||
+		memcmp(&(expected.SizeProperties.MaxBounds), &(actual.SizeProperties.MaxBounds), sizeof(XMFLOAT3)) != 0) return false;
+
+	if (expected.VertexCount != 0U && memcmp(expected.VertexData, actual.VertexData, sizeof(ModelData::TVertex) * expected.VertexCount) != 0) return false;
+	if (expected.IndexCount != 0U && memcmp(expected.IndexData, actual.IndexData, sizeof(INDEX_BUFFER_TYPE) * expected.IndexCount) != 0) return false;
+
+	return true;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <memory>
+#include "CompilerSettings.h"
+#include "TestBase.h"
+class ModelData;
+
+class BinaryModelFileTests : public TestBase
+{
+public:
+
+	CMPINLINE TestResult RunTests(void)
+	{
+		TestResult result = NewNamedResult(BinaryModelFileTests);
+
+		result += SingleMeshRoundTripTests();
+		result += MultipleMeshRoundTripTests();
+		result += InvalidFileRejectionTests();
+		result += LodChainTests();
+		result += CompressedRoundTripTests();
+		result += CompressedZeroVectorTests();
+		result += CompressedIndexRejectionTests();
+
+		return result;
+	}
+
+
+private:
+
+	TestResult SingleMeshRoundTripTests();
+	TestResult MultipleMeshRoundTripTests();
+	TestResult InvalidFileRejectionTests();
+	TestResult LodChainTests();
+	TestResult CompressedRoundTripTests();
+	TestResult CompressedZeroVectorTests();
+	TestResult CompressedIndexRejectionTests();
+
+	// Generates a grid mesh of the given dimensions, with distinct position, normal, tangent and texture data per vertex
+	std::unique_ptr<ModelData> GenerateTestModel(unsigned int rows, unsigned int columns, unsigned int material);
+
+	// Tests whether two models hold identical header, vertex and index data
+	bool ModelDataMatches(const ModelData & expected, const ModelData & actual);
+
+};
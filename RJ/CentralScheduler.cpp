@@ -1,8 +1,11 @@
 #include <vector>
 #include <algorithm>
+#include <typeinfo>
 #include "Utility.h"
 #include "GameDataExtern.h"
+#include "GameVarsExtern.h"
 #include "ScheduledObject.h"
+#include "WorkerThreadPool.h"
 
 #include "CentralScheduler.h"
 
@@ -15,42 +18,88 @@ CentralScheduler::_ScheduleIDComparator CentralScheduler::ScheduleIDComparator =
 // Default constructor
 CentralScheduler::CentralScheduler(void)
 {
-	// Initialise all values to their defaults
+	// Initialise all values to their defaults.  Every item currently scheduled requires the main thread, so updates are 
+	// executed serially by default; parallel mode only gives any benefit once items are scheduled with AnyThread affinity
 	m_lastinfrequentupdate = 0U;
+	m_mode = SchedulerMode::Serial;
 }
 
-CentralScheduler::ID_TYPE CentralScheduler::ScheduleFrequentUpdates(ScheduledObject *object, int interval_ms)	
+// Add an item for frequent (once per frame) evaluation
+CentralScheduler::ID_TYPE CentralScheduler::ScheduleFrequentUpdates(ScheduledObject *object, int interval_ms, ExecutionAffinity affinity)
 {
 	// Parameter check
 	if (!object) return 0UL;
 
 	// Schedule the task
-	m_schedule_frequent.push_back(ScheduledItemDetails(object, max(interval_ms, 1UL)));
+	m_schedule_frequent.push_back(ScheduledItemDetails(object, max(interval_ms, 1UL), affinity));
 	return CentralScheduler::CurrentSchedulerID;								// This will be the ID just assigned
 }
 
 // Add an item for infrequent (every "InfrequentUpdateEvaluationFrequency" ms) evaluation
-CentralScheduler::ID_TYPE CentralScheduler::ScheduleInfrequentUpdates(ScheduledObject *object, int interval_ms)	
+CentralScheduler::ID_TYPE CentralScheduler::ScheduleInfrequentUpdates(ScheduledObject *object, int interval_ms, ExecutionAffinity affinity)
 {
 	// Parameter check
 	if (!object) return 0UL;
 
 	// Schedule the task
-	m_schedule_infrequent.push_back(ScheduledItemDetails(object, max(interval_ms, 1UL)));
+	m_schedule_infrequent.push_back(ScheduledItemDetails(object, max(interval_ms, 1UL), affinity));
 	return CentralScheduler::CurrentSchedulerID;								// This will be the ID just assigned
 }
 
 
+// Declares that the 'job' item may not be updated until 'prerequisite' has completed its update
+bool CentralScheduler::AddDependency(ID_TYPE job, ID_TYPE prerequisite)
+{
+	ScheduledItemDetails *item = FindItem(job);
+	if (!item || job == prerequisite || !FindItem(prerequisite)) return false;
+
+	// Reject any dependency that would create a cycle, since the affected items could then never be updated
+	if (DependsOn(prerequisite, job)) return false;
+
+	if (std::find(item->Dependencies.begin(), item->Dependencies.end(), prerequisite) == item->Dependencies.end())
+	{
+		item->Dependencies.push_back(prerequisite);
+	}
+	return true;
+}
+
+// Declares that the 'job' item may not be updated until 'prerequisite' has completed its update
+bool CentralScheduler::AddDependency(ScheduledObject *job, ScheduledObject *prerequisite)
+{
+	ScheduledItemDetails *item = FindItem(job);
+	ScheduledItemDetails *prereq = FindItem(prerequisite);
+	if (!item || !prereq) return false;
+
+	return AddDependency(item->ID, prereq->ID);
+}
+
+// Tests whether 'item' depends, directly or indirectly, on 'prerequisite'
+bool CentralScheduler::DependsOn(ID_TYPE item, ID_TYPE prerequisite)
+{
+	const ScheduledItemDetails *details = FindItem(item);
+	if (!details) return false;
+
+	for (ID_TYPE dependency : details->Dependencies)
+	{
+		if (dependency == prerequisite || DependsOn(dependency, prerequisite)) return true;
+	}
+	return false;
+}
+
 // Central scheduling method.  Updates refresh counters and calls update methods where appropriate
 void CentralScheduler::RunScheduler(void)
 {
-	// Check all frequently-scheduled objects, which are evaluated every frame
+	// Check all frequently-scheduled objects, which are evaluated every frame.  Also record whether any due item could 
+	// be executed off the main thread
+	bool concurrent = false;
+	m_due.clear();
 	it_end = m_schedule_frequent.end();
 	for (it = m_schedule_frequent.begin(); it != it_end; ++it)
 	{
 		if ((it->TimeSinceLastUpdate += Game::ClockDelta) >= it->UpdateInterval)
 		{
-			it->Object->Update();
+			m_due.push_back(DueItem(&(*it), false));
+			concurrent |= (it->Affinity == ExecutionAffinity::AnyThread);
 			it->TimeSinceLastUpdate = 0U;
 		}
 	}
@@ -63,12 +112,142 @@ void CentralScheduler::RunScheduler(void)
 		{
 			if ((it->TimeSinceLastUpdate += m_lastinfrequentupdate) >= it->UpdateInterval)
 			{
-				it->Object->UpdateInfrequent();
+				m_due.push_back(DueItem(&(*it), true));
+				concurrent |= (it->Affinity == ExecutionAffinity::AnyThread);
 				it->TimeSinceLastUpdate = 0U;
 			}
 		}
 		m_lastinfrequentupdate = 0U;
 	}
+
+	// Execute all due items.  There is no benefit to building a job graph if there is nothing that could run concurrently, 
+	// since main-thread items would simply be chained in their serial order
+	if (m_due.empty()) return;
+	if (m_mode == SchedulerMode::Serial || !concurrent || m_due.size() == 1U || Game::WorkerThreads.GetWorkerCount() == 0U)
+	{
+		ExecuteSerial();
+	}
+	else
+	{
+		ExecuteParallel();
+	}
+}
+
+// Executes all due items serially on the main thread, in scheduling order
+void CentralScheduler::ExecuteSerial(void)
+{
+	std::vector<DueItem>::iterator due_end = m_due.end();
+	for (std::vector<DueItem>::iterator due = m_due.begin(); due != due_end; ++due)
+	{
+		Timers::HRClockTime start = Timers::GetHRClockTime();
+		if (due->Infrequent)	due->Item->Object->UpdateInfrequent();
+		else					due->Item->Object->Update();
+		RecordExecutionTime(*(due->Item), Timers::GetMillisecondDuration(start, Timers::GetHRClockTime()));
+	}
+}
+
+// Executes all due items as a job graph on the worker thread pool.  Main-thread items are implicitly chained in scheduling 
+// order, which preserves the existing serial behaviour for any item that has not opted in to concurrent execution.  Items 
+// must not be scheduled or removed from within an update while the graph is executing
+void CentralScheduler::ExecuteParallel(void)
+{
+	m_graph.Clear();
+
+	// Add a job for each due item
+	JobGraph::JobID last_main_thread_job = JobGraph::INVALID_JOB;
+	std::vector<DueItem>::iterator due_end = m_due.end();
+	for (std::vector<DueItem>::iterator due = m_due.begin(); due != due_end; ++due)
+	{
+		ScheduledObject *object = due->Item->Object;
+		bool main_thread = (due->Item->Affinity == ExecutionAffinity::MainThread);
+
+		if (due->Infrequent)	due->Job = m_graph.AddJob([object]() { object->UpdateInfrequent(); }, (main_thread ? JobGraph::JobAffinity::CallingThread : JobGraph::JobAffinity::AnyThread));
+		else					due->Job = m_graph.AddJob([object]() { object->Update(); }, (main_thread ? JobGraph::JobAffinity::CallingThread : JobGraph::JobAffinity::AnyThread));
+
+		if (main_thread)
+		{
+			m_graph.AddDependency(due->Job, last_main_thread_job);
+			last_main_thread_job = due->Job;
+		}
+	}
+
+	// Add all declared dependencies between items which are both due this cycle.  Any prerequisite which is not due 
+	// in this cycle is treated as already satisfied
+	for (std::vector<DueItem>::iterator due = m_due.begin(); due != due_end; ++due)
+	{
+		for (ID_TYPE dependency : due->Item->Dependencies)
+		{
+			for (std::vector<DueItem>::iterator other = m_due.begin(); other != due_end; ++other)
+			{
+				if (other->Item->ID == dependency) { m_graph.AddDependency(due->Job, other->Job); break; }
+			}
+		}
+	}
+
+	// Execute the graph and record timing for each item
+	m_graph.Execute(Game::WorkerThreads);
+	for (std::vector<DueItem>::iterator due = m_due.begin(); due != due_end; ++due)
+	{
+		RecordExecutionTime(*(due->Item), m_graph.GetJobExecutionTime(due->Job));
+	}
+}
+
+// Updates the timing statistics for an item following its execution
+void CentralScheduler::RecordExecutionTime(ScheduledItemDetails & item, Timers::HRClockDuration time)
+{
+	item.LastExecutionTime = time;
+	item.TotalExecutionTime += time;
+	++item.ExecutionCount;
+}
+
+// Locates an item in either schedule based on its ID.  Returns NULL if no such item exists
+CentralScheduler::ScheduledItemDetails * CentralScheduler::FindItem(ID_TYPE id)
+{
+	// Both schedules are sorted by ID so we can binary search each in turn
+	std::vector<ScheduledItemDetails>::iterator item = std::lower_bound(m_schedule_frequent.begin(), m_schedule_frequent.end(), id, CentralScheduler::ScheduleIDComparator);
+	if (item != m_schedule_frequent.end() && item->ID == id) return &(*item);
+
+	item = std::lower_bound(m_schedule_infrequent.begin(), m_schedule_infrequent.end(), id, CentralScheduler::ScheduleIDComparator);
+	if (item != m_schedule_infrequent.end() && item->ID == id) return &(*item);
+
+	return NULL;
+}
+
+// Locates an item in either schedule based on its object.  Returns NULL if no such item exists
+CentralScheduler::ScheduledItemDetails * CentralScheduler::FindItem(ScheduledObject *object)
+{
+	for (ScheduledItemDetails & item : m_schedule_frequent) if (item.Object == object) return &item;
+	for (ScheduledItemDetails & item : m_schedule_infrequent) if (item.Object == object) return &item;
+	return NULL;
+}
+
+// Returns a report of the per-item execution times, ordered by total time spent in each item
+std::string CentralScheduler::GetTimingReport(void) const
+{
+	std::vector<const ScheduledItemDetails*> items;
+	for (const ScheduledItemDetails & item : m_schedule_frequent) items.push_back(&item);
+	for (const ScheduledItemDetails & item : m_schedule_infrequent) items.push_back(&item);
+	std::sort(items.begin(), items.end(), [](const ScheduledItemDetails *lhs, const ScheduledItemDetails *rhs) 
+		{ return (lhs->TotalExecutionTime > rhs->TotalExecutionTime); });
+
+	std::ostringstream ss;
+	ss << "Scheduler timing (" << (m_mode == SchedulerMode::Parallel ? "parallel" : "serial") << " mode, " << items.size() << " items):\n";
+	for (const ScheduledItemDetails *item : items)
+	{
+		ss << "  [" << item->ID << "] " << typeid(*(item->Object)).name()
+		   << (item->Affinity == ExecutionAffinity::AnyThread ? " (any thread)" : " (main thread)")
+		   << ": count=" << item->ExecutionCount << ", total=" << item->TotalExecutionTime << "ms, last=" << item->LastExecutionTime
+		   << "ms, mean=" << (item->ExecutionCount == 0U ? 0.0 : (item->TotalExecutionTime / (double)item->ExecutionCount)) << "ms\n";
+	}
+
+	return ss.str();
+}
+
+// Resets the accumulated timing statistics for all items
+void CentralScheduler::ResetTimingStatistics(void)
+{
+	for (ScheduledItemDetails & item : m_schedule_frequent) { item.TotalExecutionTime = item.LastExecutionTime = Timers::GetZeroDuration(); item.ExecutionCount = 0U; }
+	for (ScheduledItemDetails & item : m_schedule_infrequent) { item.TotalExecutionTime = item.LastExecutionTime = Timers::GetZeroDuration(); item.ExecutionCount = 0U; }
 }
 
 // Remove an item based on its schedule ID
@@ -4,6 +4,10 @@
 #define __CentralSchedulerH__
 
 #include <vector>
+#include <string>
+#include "CompilerSettings.h"
+#include "Timers.h"
+#include "JobGraph.h"
 class ScheduledObject;
 
 // This class has no special alignment requirements
@@ -20,6 +24,20 @@ public:
 	// Interval between evaluations of infrequently-updated objects (frequently updated objects are checked once per frame)
 	static const unsigned int	InfrequentUpdateEvaluationFrequency = 2000;
 
+	// Determines how due updates are executed each cycle
+	enum SchedulerMode
+	{
+		Serial = 0,				// All updates are executed on the main thread, in the order they were scheduled
+		Parallel				// Updates are executed as a job graph, with independent concurrent updates spread across the worker pool
+	};
+
+	// Determines where an individual scheduled object may be updated
+	enum ExecutionAffinity
+	{
+		MainThread = 0,			// Updated on the main thread, in scheduling order relative to all other main-thread items
+		AnyThread				// May be updated on any worker thread, concurrently with any item it does not depend on
+	};
+
 	// Structure of scheduling information for an object
 	struct ScheduledItemDetails
 	{
@@ -27,26 +45,49 @@ public:
 		ScheduledObject *		Object;					// The object being scheduled
 		unsigned int			UpdateInterval;			// Time (ms) between update of the object.  Set to zero to check every frame.
 		unsigned int			TimeSinceLastUpdate;	// Time (ms) since the object was last checked
+		ExecutionAffinity		Affinity;				// Threads on which the object may be updated
+		std::vector<ID_TYPE>	Dependencies;			// Items which must complete their update first, if also due in the same cycle
 
-		ScheduledItemDetails(ScheduledObject *object, int interval_ms)
+		Timers::HRClockDuration	LastExecutionTime;		// Time (ms) taken by the most recent update
+		Timers::HRClockDuration	TotalExecutionTime;		// Total time (ms) taken by all updates since timing statistics were last reset
+		unsigned int			ExecutionCount;			// Number of updates since timing statistics were last reset
+
+		ScheduledItemDetails(ScheduledObject *object, int interval_ms, ExecutionAffinity affinity)
 		{
 			ID = ++CentralScheduler::CurrentSchedulerID;								// Assign next sequential unique ID
-			Object = object; UpdateInterval = interval_ms; TimeSinceLastUpdate = 0U;
+			Object = object; UpdateInterval = interval_ms; TimeSinceLastUpdate = 0U; Affinity = affinity;
+			LastExecutionTime = TotalExecutionTime = Timers::GetZeroDuration(); ExecutionCount = 0U;
 		}
 	};
 
 	// Default constructor
 	CentralScheduler(void);
 
-	// Add an item for frequent (once per frame) evaluation
-	ID_TYPE						ScheduleFrequentUpdates(ScheduledObject *object, int interval_ms);	
+	// Add an item for frequent (once per frame) evaluation.  Items should only be scheduled with AnyThread affinity if their
+	// update is safe to run concurrently with every other AnyThread item, and with all main-thread items, that it does not depend on
+	ID_TYPE						ScheduleFrequentUpdates(ScheduledObject *object, int interval_ms, ExecutionAffinity affinity = ExecutionAffinity::MainThread);
 	
 	// Add an item for infrequent (every "InfrequentUpdateEvaluationFrequency" ms) evaluation
-	ID_TYPE						ScheduleInfrequentUpdates(ScheduledObject *object, int interval_ms)	;
+	ID_TYPE						ScheduleInfrequentUpdates(ScheduledObject *object, int interval_ms, ExecutionAffinity affinity = ExecutionAffinity::MainThread);
+
+	// Declares that the 'job' item may not be updated until 'prerequisite' has completed its update, in any cycle where both 
+	// are due.  Items may be frequent or infrequent.  Returns false if either item does not exist, or the dependency would form a cycle
+	bool						AddDependency(ID_TYPE job, ID_TYPE prerequisite);
+	bool						AddDependency(ScheduledObject *job, ScheduledObject *prerequisite);
 
 	// Central scheduling method.  Updates refresh counters and calls update methods where appropriate
 	void						RunScheduler(void);
 
+	// Get or set the mode used to execute due updates
+	CMPINLINE SchedulerMode		GetSchedulerMode(void) const					{ return m_mode; }
+	CMPINLINE void				SetSchedulerMode(SchedulerMode mode)			{ m_mode = mode; }
+
+	// Returns a report of the per-item execution times, ordered by total time spent in each item
+	std::string					GetTimingReport(void) const;
+
+	// Resets the accumulated timing statistics for all items
+	void						ResetTimingStatistics(void);
+
 	// Remove an item based on its schedule ID
 	void						RemoveFrequentUpdate(ID_TYPE id);
 	void						RemoveInfrequentUpdate(ID_TYPE id);
@@ -59,6 +100,34 @@ public:
 	// Default destructor
 	~CentralScheduler(void);
 
+private:
+
+	// Reference to a scheduled item which is due for update in the current cycle
+	struct DueItem
+	{
+		ScheduledItemDetails *	Item;
+		bool					Infrequent;				// Determines whether UpdateInfrequent() or Update() is called
+		JobGraph::JobID			Job;					// Job representing this item, when executing in parallel mode
+
+		DueItem(ScheduledItemDetails *item, bool infrequent) : Item(item), Infrequent(infrequent), Job(JobGraph::INVALID_JOB) { }
+	};
+
+	// Executes all due items serially on the main thread, in scheduling order
+	void						ExecuteSerial(void);
+
+	// Executes all due items as a job graph on the worker thread pool
+	void						ExecuteParallel(void);
+
+	// Updates the timing statistics for an item following its execution
+	void						RecordExecutionTime(ScheduledItemDetails & item, Timers::HRClockDuration time);
+
+	// Locates an item in either schedule based on its ID or object.  Returns NULL if no such item exists
+	ScheduledItemDetails *		FindItem(ID_TYPE id);
+	ScheduledItemDetails *		FindItem(ScheduledObject *object);
+
+	// Tests whether 'item' depends, directly or indirectly, on 'prerequisite'
+	bool						DependsOn(ID_TYPE item, ID_TYPE prerequisite);
+
 private:
 
 	// Vector of items to be checked every frame.  Used for frequently-updated items, e.g. those updating every few frames.  Calls Update()
@@ -69,6 +138,14 @@ private:
 
 	// Keep track of time since the last infrequent update
 	unsigned int									m_lastinfrequentupdate;
+
+	// Mode used to execute due updates
+	SchedulerMode									m_mode;
+
+	// Items due for update in the current cycle, and the job graph used to execute them in parallel mode.  Both 
+	// retain their storage between cycles
+	std::vector<DueItem>							m_due;
+	JobGraph										m_graph;
 	
 	// Temporary iterators used for evaluating items each frame.  Allocated one here for efficiency
 	std::vector<ScheduledItemDetails>::iterator		it, it_end;
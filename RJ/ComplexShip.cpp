@@ -527,12 +527,10 @@ void ComplexShip::UpdatePerimeterBeacons(void)
 			node = beacon->GetSpatialTreeNode();
 			if (node)
 			{
-				// If the item has moved then refresh its position for safety
-				if (!node->ContainsPoint(pos))
-				{ 
-					node->ItemMoved(beacon, pos); 
-					node = beacon->GetSpatialTreeNode();
-				}
+				// Refresh the beacon in its node; this will move it to a new node if required, and otherwise updates the
+				// search data it holds on behalf of the ship
+				node->ItemMoved(beacon, pos); 
+				node = beacon->GetSpatialTreeNode();
 			}
 			else
 			{
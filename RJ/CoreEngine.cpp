@@ -93,7 +93,6 @@ template void CoreEngine::ProcessRenderQueue<ShaderRenderPredicate::RenderUI, Mo
 CoreEngine::CoreEngine(void)
 	:
 	m_renderdevice(NULL),
-	m_rq_optimiser(m_renderqueue), 
 	m_camera(NULL),
 	LightingManager(NULL), 
 	m_lightshader(NULL),
@@ -122,6 +121,8 @@ CoreEngine::CoreEngine(void)
 	m_vsync( false ), 
 	m_gbuffer(NULL), 
 	m_render_device_failure_count(0U), 
+	r_viewposition(NULL_VECTOR), 
+	r_lod_error_scale(0.0f), 
 	m_screen_space_adjustment(NULL_VECTOR), 
 	m_screen_space_adjustment_f(NULL_FLOAT2), 
 	m_screenspace_quad_vb(NULL)
@@ -392,8 +393,7 @@ Result CoreEngine::InitialiseRenderQueue(void)
 	m_instancedstride[1] = sizeof(RM_Instance);						// Buffer[1] is the instance buffer
 	m_instancedoffset[0] = 0; m_instancedoffset[1] = 0;				// No offsets in either buffer
 
-	// Initialise the render queue with a blank map for each shader in scope
-	m_renderqueue = RenderQueue(RenderQueueShader::RM_RENDERQUEUESHADERCOUNT);
+	// Initialise the definition of each shader in scope
 	m_renderqueueshaders = RM_ShaderCollection(RenderQueueShader::RM_RENDERQUEUESHADERCOUNT);
 
 	// Set the reference and parameters for each shader in turn
@@ -419,12 +419,8 @@ Result CoreEngine::InitialiseRenderQueue(void)
 	m_renderqueueshaders[RenderQueueShader::RM_LightFadeShader] = m_renderqueueshaders[RenderQueueShader::RM_LightShader];
 	m_renderqueueshaders[RenderQueueShader::RM_LightHighlightFadeShader] = m_renderqueueshaders[RenderQueueShader::RM_LightShader];*/
 
-	// Initialise render queue slots with this data
-	// TODO: a little redundant to have both...?
-	for (int i = 0; i < (int)RenderQueueShader::RM_RENDERQUEUESHADERCOUNT; ++i)
-	{
-		m_renderqueue[i].SetShaderDetails(m_renderqueueshaders[i]);
-	}
+	// Initialise the render queue with a section for each shader
+	m_renderqueue.Initialise(m_renderqueueshaders);
 
 
 	// Set an initial primitive topology as a default
@@ -844,6 +840,9 @@ void CoreEngine::SetSystemCursorVisibility(bool cursor_visible)
 // Pre-frame initialisation for the engine and its components
 void CoreEngine::BeginFrame(void)
 {
+	// Install any newly-streamed assets and evict if required, before any rendering data is submitted for the frame
+	m_assetresidency.Update();
+
 	// Delegate to engine components as required
 	GetRenderDevice()->BeginFrame();
 	GetDecalRenderer()->BeginFrame();
@@ -906,8 +905,7 @@ void CoreEngine::Render(void)
 	/* Present the scene once all rendering is complete */
 	m_renderdevice->PresentFrame();
 
-	// Activate the render queue optimiser here if it is ready for its next cycle, then clear the render queue ready for Frame+1
-	if (m_rq_optimiser.Ready()) m_rq_optimiser.Run();
+	// Clear the render queue ready for Frame+1
 	ClearRenderQueue();
 	
 	// Run any post-render debug processes
@@ -953,6 +951,11 @@ void CoreEngine::RetrieveRenderCycleData(void)
 	XMStoreFloat4x4(&r_viewproj_f, r_viewproj);
 	XMStoreFloat4x4(&r_viewproj_unjittered_f, r_viewproj_unjittered);
 	XMStoreFloat4x4(&r_invviewproj_f, r_invviewproj);
+
+	// Projected size of one world unit at unit distance, in pixels, is (0.5 * screen height * projection[1][1]).  LOD selection
+	// compares against this scaled by the permitted pixel error, so that a LOD is acceptable wherever its scaled error is <= 1
+	r_viewposition = m_camera->GetPosition();
+	r_lod_error_scale = (0.5f * (float)Game::ScreenHeight * r_projection_f._22) / LOD_PIXEL_ERROR_THRESHOLD;
 }
 
 // Submits a model to the render queue manager for rendering this frame.  Will iterate through all model components
@@ -961,11 +964,23 @@ void RJ_XM_CALLCONV	CoreEngine::SubmitForRendering(RenderQueueShader shader, Mod
 {
 	if (!model) return;
 
+	// Streamed models will have no rendering data until resident; components will be skipped until then
+	m_assetresidency.RequestModel(model);
+
+	// Determine the projected error scale for LOD selection, based on the instance bounding sphere and distance from the camera.  
+	// Instances with no bounding sphere, or which contain the viewer, are always rendered at full detail
+	float lod_scale = Model::FULL_DETAIL_LOD_SCALE;
+	if (model->HasLods() && metadata.BoundingSphereRadius > 0.0f)
+	{
+		float distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(metadata.Position, r_viewposition)));
+		if (distance > metadata.BoundingSphereRadius) lod_scale = (metadata.BoundingSphereRadius * r_lod_error_scale / distance);
+	}
+
 	// Single-component optimisation (TODO: probably; unless branch cost > loop & instance copy-cons cost)
 	size_t n = model->GetComponentCount();
 	if (n == 1U)
 	{
-		SubmitForRendering(shader, (model->Components[0].Data.get()), material, std::move(instance), std::move(metadata));
+		SubmitForRendering(shader, model->Components[0].SelectLod(lod_scale), material, std::move(instance), std::move(metadata));
 		return;
 	}
 
@@ -973,7 +988,7 @@ void RJ_XM_CALLCONV	CoreEngine::SubmitForRendering(RenderQueueShader shader, Mod
 	// TODO: optimisation; loop through 1 to N-1, then std::move() the actual instance data for [0] directly.  Saves copying once
 	for (size_t i = 0U; i < n; ++i)
 	{
-		SubmitForRendering(shader, (model->Components[i].Data.get()), material, std::move(RM_Instance(instance)), std::move(RM_InstanceMetadata(metadata)));
+		SubmitForRendering(shader, model->Components[i].SelectLod(lod_scale), material, std::move(RM_Instance(instance)), std::move(RM_InstanceMetadata(metadata)));
 	}
 }
 
@@ -985,21 +1000,18 @@ void RJ_XM_CALLCONV CoreEngine::SubmitForRendering(RenderQueueShader shader, Mod
 	// Exclude any null-geometry objects
 	if (!model) return;
 
-	// Retrieve the most appropriate render slot and move this instance into it
-	size_t render_slot = model->GetAssignedRenderSlot(shader);
-	if (render_slot == ModelBuffer::NO_RENDER_SLOT)
-	{
-		render_slot = m_renderqueue[shader].NewRenderSlot();
-		m_renderqueue.RegisterModelBuffer(shader, render_slot, model);
-	}
+	// Override materials may use streamed textures, which will not be bound until they are resident
+	if (material) m_assetresidency.RequestMaterial(material);
 
-	m_renderqueue[shader].ModelData[render_slot].GetInstances(material).NewInstance(std::move(instance), std::move(metadata));
+	// Move this instance into the render queue; it will be sorted into render order when the queue is processed
+	m_renderqueue.Submit(shader, model, material, std::move(instance), std::move(metadata));
 }
 
 // Submit a model for z-sorted rendering.  Will dispatch each model component to the render queue in turn
 void RJ_XM_CALLCONV CoreEngine::SubmitForZSortedRendering(RenderQueueShader shader, Model *model, RM_Instance && instance, const CXMVECTOR position)
 {
 	if (!model) return;
+	m_assetresidency.RequestModel(model);
 
 	// Single-component optimisation (TODO: probably; unless branch cost > loop & instance copy-cons cost)
 	size_t n = model->GetComponentCount();
@@ -1101,7 +1113,7 @@ DeferredGBuffer * CoreEngine::GetGBufferReference(void)
 template <class TShaderRenderPredicate, class TModelRenderPredicate>
 void CoreEngine::ProcessRenderQueue(PipelineStateDX11 *pipeline)
 {
-	size_t model_count, material_count, instancecount, inst;
+	size_t instancecount, inst;
 	UINT batch_size;
 	TShaderRenderPredicate render_shader;
 	TModelRenderPredicate render_model;
@@ -1109,52 +1121,45 @@ void CoreEngine::ProcessRenderQueue(PipelineStateDX11 *pipeline)
 
 	if (!pipeline) return;
 
-	// Iterate through each shader in the render queue (though not currently required; all will be mapped to 0)
-	for (auto i = 0; i < RenderQueueShader::RM_RENDERQUEUESHADERCOUNT; ++i)
+	// Sort and batch the queue contents, if this has not already been done since the last submission
+	m_renderqueue.Prepare();
+
+	// Iterate through each shader in the render queue
+	for (size_t i = 0U; i < m_renderqueue.GetShaderCount(); ++i)
 	{
 		// Verfy against the shader rendering predicate before proceeding
-		RM_ModelDataCollection & rq_shader = m_renderqueue[i];
+		const RM_ShaderQueue & rq_shader = m_renderqueue.GetShaderQueue(i);
 		if (!render_shader(rq_shader)) continue;
 
 		// Early-exit for empty shader queues, before changing any state below
-		model_count = rq_shader.CurrentSlotCount;
-		if (model_count == 0U) continue;
+		if (rq_shader.Empty()) continue;
 
 		// Set the type of primitive that should be rendered through this shader, if it needs to be changed
 		ChangePrimitiveTopologyIfRequired(rq_shader.PrimitiveTopology);
 
-		// Process each model separately
-		for (size_t mi = 0U; mi < model_count; ++mi)
+		// Process each batch in turn; batches are in sorted { material, model } order, so consecutive draw calls share as 
+		// much state as possible
+		for (size_t b = rq_shader.BatchStart; b < rq_shader.BatchEnd; ++b)
 		{
 			// Early-exit if this model has no compiled geometry or fails the model rendering predicate
-			RM_ModelData & model = rq_shader.ModelData[mi];
-			modelbuffer = model.ModelBufferInstance;
+			const RM_RenderBatch & batch = m_renderqueue.GetBatch(b);
+			modelbuffer = batch.Model;
 			if (!modelbuffer || !modelbuffer->VertexBuffer.GetCompiledBuffer()) continue;
 			if (!render_model(modelbuffer)) continue;
 
-			// Process each material that will be used to render the instances
-			material_count = model.CurrentMaterialCount;
-			for (size_t mat = 0U; mat < material_count; ++mat)
+			// Loop through the instances in batches, if the total count is larger than our limit
+			instancecount = batch.InstanceCount;
+			for (inst = 0U; inst < instancecount; inst += Game::C_INSTANCED_RENDER_LIMIT)
 			{
-				auto & model_data = model.Data[mat];
-
-				/// TODO: Sort instances here?
-
-				// Loop through the instances in batches, if the total count is larger than our limit
-				instancecount = model_data.InstanceCollection.CurrentInstanceCount;
-				for (inst = 0U; inst < instancecount; inst += Game::C_INSTANCED_RENDER_LIMIT)
-				{
-					// Determine the number of instances to render; either the per-batch limit, or fewer if we do not have that many
-					batch_size = static_cast<UINT>(min(instancecount - inst, Game::C_INSTANCED_RENDER_LIMIT));
-
-					// Pass control to the core instanced rendering method to issue a draw call
-					RenderInstanced(*pipeline, *modelbuffer, model_data.Material, model_data.InstanceCollection.InstanceData[inst], batch_size);
+				// Determine the number of instances to render; either the per-batch limit, or fewer if we do not have that many
+				batch_size = static_cast<UINT>(min(instancecount - inst, Game::C_INSTANCED_RENDER_LIMIT));
 
-				} /// per-instance
+				// Pass control to the core instanced rendering method to issue a draw call
+				RenderInstanced(*pipeline, *modelbuffer, batch.Material, m_renderqueue.GetInstance(batch.InstanceStart + inst), batch_size);
 
-			} /// per-material
+			} /// per-instance
 
-		} /// per-model
+		} /// per-batch
 
 	} /// per-shader
 
@@ -1165,6 +1170,8 @@ void CoreEngine::ProcessRenderQueue(PipelineStateDX11 *pipeline)
 // the material specified in the model buffer; a null material will fall back to the default model buffer material
 void CoreEngine::RenderInstanced(const PipelineStateDX11 & pipeline, const Model & model, const MaterialDX11 * material, const RM_Instance & instance_data, UINT instance_count)
 {
+	m_assetresidency.RequestModel(&model);
+
 	for (const auto & component : model.Components)
 	{
 		const auto buffer = component.Data.get();
@@ -1230,25 +1237,8 @@ void CoreEngine::RenderFullScreenQuad(void)
 // queue items multiple times through e.g. different shader pipelines
 void CoreEngine::ClearRenderQueue(void)
 {
-	// For each shader in the render queue
-	for (size_t i = 0U; i < (size_t)RenderQueueShader::RM_RENDERQUEUESHADERCOUNT; ++i)
-	{
-		auto & modelqueue = m_renderqueue[i];
-		auto model_count = modelqueue.CurrentSlotCount;
-
-		// For each model being rendered by this shader
-		for (size_t mi = 0U; mi < model_count; ++mi)
-		{
-			// Unregister this model from the given render queue slot
-			m_renderqueue.UnregisterModelBuffer(i, mi);
-
-			// Reset the per-material data back to default state
-			m_renderqueue[i].ModelData[mi].Reset();
-		}
-
-		// Reset this render queue shader ready for the next frame
-		m_renderqueue[i].CurrentSlotCount = 0U;
-	}
+	// Unregister all models from the render queue and reset it ready for the next frame
+	m_renderqueue.Clear();
 }
 
 void CoreEngine::ChangePrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY primitive_topology)
@@ -2680,38 +2670,8 @@ RJ_PROFILED(void CoreEngine::ProcessQueuedActorRendering, void)
 // Not reuired at shutdown since all resources are automatically deallocated; only for debug purposes
 void CoreEngine::DeallocateRenderingQueue(void)
 {
-	// Iterate through each shader in the render queue
-	size_t count = m_renderqueue.size();
-	for (size_t shader = 0U; shader < count; ++shader)
-	{
-		// Iterate through each model currently registered with the shader
-		auto model_count = m_renderqueue[shader].CurrentSlotCount;
-		for (auto model = 0U; model < model_count; ++model)
-		{
-			// Iterate through each material registered for this model
-			for (auto & material : m_renderqueue[shader].ModelData[model].Data)
-			{
-				// Clear all instance data
-				material.InstanceCollection.InstanceData.clear();
-				material.InstanceCollection.InstanceData.shrink_to_fit();
-
-			} /// per-material
-
-			// Unregister any model buffer associated with this entry
-			if (m_renderqueue[shader].ModelData[model].ModelBufferInstance != NULL)
-			{
-				m_renderqueue.UnregisterModelBuffer(shader, model);
-			}
-		
-		} /// per-model
-
-		m_renderqueue[shader].ModelData.clear();
-		m_renderqueue[shader].ModelData.shrink_to_fit();
-
-	} /// per-shader
-
-	m_renderqueue.clear();
-	m_renderqueue.shrink_to_fit();
+	// Unregister all models and release the instance storage held by the queue
+	m_renderqueue.Deallocate();
 }
 
 // Pre-render debug processes; only active in debug builds
@@ -3152,6 +3112,9 @@ XMVECTOR CoreEngine::GetScreenLocationForObjectWithWorldOffset(const OrientedBou
 	return XMVectorLerpV(smin, smax, XMVectorSet(offset.x + 0.5f, offset.y + 0.5f, 0.5f, 0.5f));
 }
 
+// Maximum projected geometric error, in pixels, permitted when selecting a model LOD for rendering
+const float CoreEngine::LOD_PIXEL_ERROR_THRESHOLD = 1.0f;
+
 // Initialise static collection of basic colour data
 const std::array<BasicColourDefinition, 8> CoreEngine::BASIC_COLOURS =
 {
@@ -3395,6 +3358,22 @@ bool CoreEngine::ProcessConsoleCommand(GameConsoleCommand & command)
 		}
 		return true;
 	}
+	else if (command.InputCommand == "asset_residency")
+	{
+		if (command.Parameter(0) == "budget" && command.ParameterAsInt(1) > 0)
+		{
+			m_assetresidency.SetMemoryBudget((size_t)command.ParameterAsInt(1) * 1024U * 1024U);
+		}
+
+		auto models = m_assetresidency.GetStatistics(AssetResidencyManager::AssetType::Model);
+		auto textures = m_assetresidency.GetStatistics(AssetResidencyManager::AssetType::Texture);
+		command.SetSuccessOutput(concat("Models: ")(models.Resident)("/")(models.Registered)(" resident, ")(models.Loading)(" loading, ")(models.Failed)(" failed, ")
+			(models.ResidentBytes / 1024U)("KB, ")(models.LoadCount)(" loads, ")(models.EvictionCount)(" evictions | Textures: ")
+			(textures.Resident)("/")(textures.Registered)(" resident, ")(textures.Loading)(" loading, ")(textures.Failed)(" failed, ")
+			(textures.ResidentBytes / 1024U)("KB, ")(textures.LoadCount)(" loads, ")(textures.EvictionCount)(" evictions | Budget: ")
+			(m_assetresidency.GetMemoryBudget() / (1024U * 1024U))("MB").str());
+		return true;
+	}
 
 	// We did not recognise the command
 	return false;
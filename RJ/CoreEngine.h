@@ -18,7 +18,7 @@
 #include "iAcceptsConsoleCommands.h"
 #include "RenderQueue.h"
 #include "RenderQueueShaders.h"
-#include "RenderQueueOptimiser.h"
+#include "AssetResidencyManager.h"
 #include "ShaderManager.h"
 #include "Model.h"
 #include "ModelBuffer.h"
@@ -176,6 +176,9 @@ public:
 	// Pass-through accessor for engine assets, since they are used so frequently
 	CMPINLINE RenderAssetsDX11 &						GetAssets(void) { return m_renderdevice->Assets; }
 
+	// Residency manager for streamed model and texture data
+	CMPINLINE AssetResidencyManager &					GetAssetResidency(void) { return m_assetresidency; }
+
 	// Validation method to determine whether the engine has all critical frame-generatation components available
 	CMPINLINE bool			Operational()				{ return (m_renderdevice && m_renderdevice->GetDevice() ); }
 
@@ -372,8 +375,8 @@ public:
 	void RJ_XM_CALLCONV						RenderMaterialToScreen(	MaterialDX11 & material, const XMFLOAT2 & position, const XMFLOAT2 size, 
 																	float rotation = 0.0f, float opacity = 1.0f, float zorder = 0.0f);
 
-	// Return a constant reference to the primary render queue
-	CMPINLINE const RenderQueue &			GetRenderQueue(void) const { return m_renderqueue; }
+	// Return a constant reference to the primary render queue, sorted and batched ready for processing
+	CMPINLINE const RenderQueue &			GetRenderQueue(void) { m_renderqueue.Prepare(); return m_renderqueue; }
 
 	// Primitive topology is managed by the render queue in an attempt to minimise state changes
 	CMPINLINE D3D_PRIMITIVE_TOPOLOGY		GetCurrentPrimitiveTopology(void) const { return m_current_topology; }
@@ -632,6 +635,8 @@ private:
 	XMFLOAT4X4				r_viewproj_f;			// Local float representation of the current frame (view * proj) matrix
 	XMFLOAT4X4				r_viewproj_unjittered_f;	// Local float representation of the current frame unjittered (view * proj) matrix
 	XMFLOAT4X4				r_invviewproj_f;		// Local float representation of the current frame inverse (view * proj) matrix
+	AXMVECTOR				r_viewposition;			// Camera position for the current render cycle
+	float					r_lod_error_scale;		// Converts (relative LOD error * bounding radius / distance) into units of the LOD pixel error threshold
 
 	// TODO: Define render matrices within struct, then maintain a "Current" and "PriorFrame" instance
 	XMFLOAT4X4				r_priorframe_viewproj_f;	// Prior frame; local float representation of view projection matrix
@@ -645,8 +650,8 @@ private:
 	unsigned int				m_instancedstride[2], m_instancedoffset[2];
 	D3D_PRIMITIVE_TOPOLOGY		m_current_topology;
 
-	// Optimiser performs periodic maintenance on the engine render queue
-	RenderQueueOptimiser		m_rq_optimiser;
+	// Maintains residency of streamed model and texture data within the GPU memory budget
+	AssetResidencyManager		m_assetresidency;
 
 	// Cached reference to unit quad model, used for direct screen-space rendering of materials
 	Model *						m_unit_quad_model;
@@ -792,6 +797,9 @@ private:
 	unsigned int				m_render_device_failure_count;
 	static const unsigned int	ALLOWABLE_RENDER_DEVICE_FAILURE_COUNT = 10U;
 
+	// Maximum projected geometric error, in pixels, permitted when selecting a model LOD for rendering
+	static const float			LOD_PIXEL_ERROR_THRESHOLD;
+
 	// Enumeration of possible debug terain render modes
 	enum DebugTerrainRenderMode { Normal = 0, Solid };
 
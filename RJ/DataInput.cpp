@@ -3,6 +3,7 @@
 #include <fstream>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <Windows.h>
 
 #include "GameDataExtern.h"
@@ -12,6 +13,7 @@
 #include "Logging.h"
 #include "FileSystem.h"
 #include "FileInput.h"
+#include "WorkerThreadPool.h"
 #include "Attachment.h"
 #include "Model.h"
 #include "ModelLoadingData.h"
@@ -112,6 +114,46 @@ HashVal IO::Data::ReloadOnlyType;
 std::string IO::Data::ReloadOnlyCode;
 
 std::vector<ComplexShipSection*> IO::Data::__TemporaryCSSLoadingBuffer;
+GameDataCache IO::Data::Cache;
+std::unordered_map<std::string, TiXmlDocument*> IO::Data::PrefetchedDocuments;
+
+// Loaders for each standard top-level game data node type, keyed by compile-time hash of the lowercase node name
+std::unordered_map<HashVal, IO::Data::GameDataNodeLoader> IO::Data::GameDataNodeLoaders = 
+{
+	{ HashedStrings::CH_Include,						&IO::Data::LoadXMLFileIndex },
+	{ HashedStrings::CH_SimpleShip,						&IO::Data::LoadSimpleShip },
+	{ HashedStrings::CH_SimpleShipLoadout,				&IO::Data::LoadSimpleShipLoadout },
+	{ HashedStrings::CH_ComplexShip,					&IO::Data::LoadComplexShip },
+	{ HashedStrings::CH_ComplexShipSection,				&IO::Data::LoadComplexShipSection },
+	{ HashedStrings::CH_Engine,							&IO::Data::LoadEngine },
+	{ HashedStrings::CH_System,							&IO::Data::LoadSystem },
+	{ HashedStrings::CH_FireEffect,						&IO::Data::LoadFireEffect },
+	{ HashedStrings::CH_ParticleEmitter,				&IO::Data::LoadParticleEmitter },
+	{ HashedStrings::CH_UILayout,						&IO::Data::LoadUILayout },
+	{ HashedStrings::CH_Model,							&IO::Data::LoadModelData },
+	{ HashedStrings::CH_ArticulatedModel,				&IO::Data::LoadArticulatedModel },
+	{ HashedStrings::CH_UIManagedControlDefinition,		&IO::Data::LoadUIManagedControlDefinition },
+	{ HashedStrings::CH_ComplexShipTileClass,			&IO::Data::LoadComplexShipTileClass },
+	{ HashedStrings::CH_ComplexShipTileDefinition,		&IO::Data::LoadComplexShipTileDefinition },
+	{ HashedStrings::CH_Resource,						&IO::Data::LoadResource },
+	{ HashedStrings::CH_SkinnedModel,					&IO::Data::LoadSkinnedModel },
+	{ HashedStrings::CH_ActorAttributeGeneration,		&IO::Data::LoadActorAttributeGenerationData },
+	{ HashedStrings::CH_ActorBase,						&IO::Data::LoadActor },
+	{ HashedStrings::CH_TerrainDefinition,				&IO::Data::LoadTerrainDefinition },
+	{ HashedStrings::CH_DynamicTerrainDefinition,		&IO::Data::LoadDynamicTerrainDefinition },
+	{ HashedStrings::CH_Faction,						&IO::Data::LoadFaction },
+	{ HashedStrings::CH_Turret,							&IO::Data::LoadTurret },
+	{ HashedStrings::CH_ProjectileLauncher,				&IO::Data::LoadProjectileLauncher },
+	{ HashedStrings::CH_BasicProjectileDefinition,		&IO::Data::LoadBasicProjectileDefinition },
+	{ HashedStrings::CH_SpaceProjectileDefinition,		&IO::Data::LoadSpaceProjectileDefinition },
+	{ HashedStrings::CH_DynamicTileSet,					&IO::Data::LoadDynamicTileSet },
+	{ HashedStrings::CH_ModifierDetails,				&IO::Data::LoadModifier },
+	{ HashedStrings::CH_Audio,							&IO::Data::LoadAudioItem },
+	{ HashedStrings::CH_Texture,						&IO::Data::LoadTextureData },
+	{ HashedStrings::CH_Material,						&IO::Data::LoadMaterialData },
+	{ HashedStrings::CH_Font,							&IO::Data::LoadFont },
+	{ HashedStrings::CH_NoiseResource,					&IO::Data::LoadNoiseResource }
+};
 
 
 TiXmlDocument *IO::Data::LoadXMLDocument(const std::string &filename)
@@ -169,7 +211,8 @@ Result IO::Data::LoadGameDataFile(const std::string &file, bool follow_indices)
 	{
 		// This is a file.  Attempt to load the XML data file
 		Result res = ErrorCodes::NoError;
-		TiXmlDocument *doc = IO::Data::LoadXMLDocument(filename);
+		TiXmlDocument *doc = IO::Data::TakePrefetchedDocument(filename);
+		if (doc == NULL) doc = IO::Data::Cache.LoadDocument(filename);
 		if (doc == NULL) return ErrorCodes::CannotLoadXMLDocument;
 
 		// The first (and only) root note should be a "GameData" node; if not then stop
@@ -191,80 +234,18 @@ Result IO::Data::LoadGameDataFile(const std::string &file, bool follow_indices)
 			// Perform early-rejection if we have a reload restriction currently in place and this is not the desired entity type
 			if (ReloadOnlyType != 0U && hash != ReloadOnlyType) continue;
 
-			// Test the type of this node
-			// TODO: Add error handling if a function returns =/= 0
-			if (hash == HashedStrings::H_Include) {
-				res = IO::Data::LoadXMLFileIndex(child);
+			// Dispatch the node to the loader registered for this type
+			GameDataNodeLoader loader = GetGameDataNodeLoader(hash);
+			if (loader)
+			{
+				res = loader(child);
 
 				// If we caught and terminated an infinite file loop we need to propogate the error backwards to stop it simply repeating
 				if (res == ErrorCodes::ForceTerminatedInfiniteCircularFileIndices)
 					return ErrorCodes::ForceTerminatedInfiniteCircularFileIndices;
 			}
-			else if (hash == HashedStrings::H_SimpleShip) {
-				res = IO::Data::LoadSimpleShip(child);
-			} else if (hash == HashedStrings::H_SimpleShipLoadout) {
-				res = IO::Data::LoadSimpleShipLoadout(child);
-			} else if (hash == HashedStrings::H_ComplexShip) {
-				res = IO::Data::LoadComplexShip(child);
-			} else if (hash == HashedStrings::H_ComplexShipSection) {
-				res = IO::Data::LoadComplexShipSection(child);
-			} else if (hash == HashedStrings::H_Engine) {
-				res = IO::Data::LoadEngine(child);
-			} else if (hash == HashedStrings::H_System) {
-				res = IO::Data::LoadSystem(child);
-			} else if (hash == HashedStrings::H_FireEffect) {
-				res = IO::Data::LoadFireEffect(child);
-			} else if (hash == HashedStrings::H_ParticleEmitter) {
-				res = IO::Data::LoadParticleEmitter(child);
-			} else if (hash == HashedStrings::H_UILayout) {
-				res = IO::Data::LoadUILayout(child);
-			} else if (hash == HashedStrings::H_Model) {
-				res = IO::Data::LoadModelData(child);
-			} else if (hash == HashedStrings::H_ArticulatedModel) {
-				res = IO::Data::LoadArticulatedModel(child);
-			} else if (hash == HashedStrings::H_UIManagedControlDefinition) {
-				res = IO::Data::LoadUIManagedControlDefinition(child);
-			} else if (hash == HashedStrings::H_ComplexShipTileClass) {
-				res = IO::Data::LoadComplexShipTileClass(child);
-			} else if (hash == HashedStrings::H_ComplexShipTileDefinition) {
-				res = IO::Data::LoadComplexShipTileDefinition(child);
-			} else if (hash == HashedStrings::H_Resource) {
-				res = IO::Data::LoadResource(child);
-			} else if (hash == HashedStrings::H_SkinnedModel) {
-				res = IO::Data::LoadSkinnedModel(child);
-			} else if (hash == HashedStrings::H_ActorAttributeGeneration) {
-				res = IO::Data::LoadActorAttributeGenerationData(child);
-			} else if (hash == HashedStrings::H_ActorBase) {
-				res = IO::Data::LoadActor(child);
-			} else if (hash == HashedStrings::H_TerrainDefinition) {
-				res = IO::Data::LoadTerrainDefinition(child);
-			} else if (hash == HashedStrings::H_DynamicTerrainDefinition) {
-				res = IO::Data::LoadDynamicTerrainDefinition(child);
-			} else if (hash == HashedStrings::H_Faction) {
-				res = IO::Data::LoadFaction(child);
-			} else if (hash == HashedStrings::H_Turret) {
-				res = IO::Data::LoadTurret(child);
-			} else if (hash == HashedStrings::H_ProjectileLauncher) {
-				res = IO::Data::LoadProjectileLauncher(child);
-			} else if (hash == HashedStrings::H_BasicProjectileDefinition) {
-				res = IO::Data::LoadBasicProjectileDefinition(child);
-			} else if (hash == HashedStrings::H_SpaceProjectileDefinition) {
-				res = IO::Data::LoadSpaceProjectileDefinition(child);
-			} else if (hash == HashedStrings::H_DynamicTileSet) {
-				res = IO::Data::LoadDynamicTileSet(child);
-			} else if (hash == HashedStrings::H_ModifierDetails) {
-				res = IO::Data::LoadModifier(child);
-			} else if (hash == HashedStrings::H_Audio) {
-				res = IO::Data::LoadAudioItem(child);
-			} else if (hash == HashedStrings::H_Texture) {
-				res = IO::Data::LoadTextureData(child);
-			} else if (hash == HashedStrings::H_Material) {
-				res = IO::Data::LoadMaterialData(child);
-			} else if (hash == HashedStrings::H_Font) {
-				res = IO::Data::LoadFont(child);
-			} else if (hash == HashedStrings::H_NoiseResource) { 
-				res = IO::Data::LoadNoiseResource(child);
-			} else {
+			else
+			{
 				// Unknown level one node type
 				res = ErrorCodes::UnknownDataNodeType;
 			}
@@ -289,6 +270,126 @@ Result IO::Data::LoadGameDataFile(const std::string &file, bool follow_indices)
 	return ErrorCodes::NoError;
 }
 
+Result IO::Data::PrefetchGameDataFiles(const std::string &file)
+{
+	if (file == NullString) return ErrorCodes::NullFilenamePointer;
+
+	// Record the time taken to prefetch all files
+	unsigned int processtime = (unsigned int)timeGetTime();
+
+	// Process one level of file indices at a time.  Directories are expanded to their files serially, since this is cheap
+	// and matches the order in which LoadGameDataFile will later visit them.  Each file is only prefetched once, even if 
+	// referenced multiple times, which also guards against circular indices
+	std::unordered_set<std::string> visited;
+	std::vector<std::string> pending = { file };
+	std::vector<std::string> files;
+	int level = 0;
+
+	while (!pending.empty())
+	{
+		if (++level > Game::C_DATA_LOAD_RECURSION_LIMIT)
+		{
+			Game::Log << LOG_WARN << "Game data prefetch exceeded the maximum file index depth; remaining files will be loaded on demand\n";
+			break;
+		}
+
+		files.clear();
+		for (const std::string & item : pending)
+		{
+			std::string filename = (D::DATA_S + "\\" + item);
+			FileSystem::FileSystemObjectType fso_type = FileSystem::GetFileSystemObjectType(filename.c_str());
+
+			if (fso_type == FileSystem::FileSystemObjectType::FSO_Directory)
+			{
+				std::vector<std::string> contents;
+				FileSystem::GetFileSystemObjects(filename, true, false, contents);
+				for (const std::string & f : contents)
+				{
+					std::string path = concat(item)("\\")(f).str();
+					if (visited.insert(D::DATA_S + "\\" + path).second) files.push_back(path);
+				}
+			}
+			else if (fso_type == FileSystem::FileSystemObjectType::FSO_File)
+			{
+				if (visited.insert(filename).second) files.push_back(item);
+			}
+		}
+
+		// Read and parse all files at this level in parallel.  Each job writes only to its own document slot
+		std::vector<TiXmlDocument*> docs(files.size(), NULL);
+		Game::WorkerThreads.ParallelFor((int)files.size(), 1, [&files, &docs](int begin, int end)
+		{
+			for (int i = begin; i < end; ++i)
+			{
+				docs[i] = IO::Data::Cache.LoadDocument(D::DATA_S + "\\" + files[i]);
+			}
+		});
+
+		// Store each document and collect the file indices it contains, in document order, for the next level
+		pending.clear();
+		for (size_t i = 0U; i < files.size(); ++i)
+		{
+			if (!docs[i]) continue;
+
+			PrefetchedDocuments[D::DATA_S + "\\" + files[i]] = docs[i];
+
+			TiXmlElement *root = docs[i]->FirstChildElement();
+			if (!root) continue;
+
+			for (TiXmlElement *child = root->FirstChildElement(); child; child = child->NextSiblingElement())
+			{
+				std::string name = child->Value(); StrLowerC(name);
+				if (!(HashString(name) == HashedStrings::H_Include)) continue;
+
+				for (TiXmlAttribute *attr = child->FirstAttribute(); attr; attr = attr->Next())
+				{
+					std::string attr_name = attr->Name(); StrLowerC(attr_name);
+					if (attr_name == "file") pending.push_back(attr->Value());
+				}
+			}
+		}
+	}
+
+	// Log the total number of files prefetched and the time taken
+	processtime = ((unsigned int)timeGetTime() - processtime);
+	Game::Log << LOG_INFO << "Prefetched " << PrefetchedDocuments.size() << " game data files using " << (Game::WorkerThreads.GetWorkerCount() + 1U) 
+		<< " threads [" << processtime << "ms]\n";
+
+	return ErrorCodes::NoError;
+}
+
+void IO::Data::RegisterGameDataNodeLoader(HashVal type, GameDataNodeLoader loader)
+{
+	if (loader)		GameDataNodeLoaders[type] = loader;
+	else			GameDataNodeLoaders.erase(type);
+}
+
+IO::Data::GameDataNodeLoader IO::Data::GetGameDataNodeLoader(HashVal type)
+{
+	auto it = GameDataNodeLoaders.find(type);
+	return (it != GameDataNodeLoaders.end() ? it->second : NULL);
+}
+
+TiXmlDocument *IO::Data::TakePrefetchedDocument(const std::string &filename)
+{
+	auto it = PrefetchedDocuments.find(filename);
+	if (it == PrefetchedDocuments.end()) return NULL;
+
+	TiXmlDocument *doc = it->second;
+	PrefetchedDocuments.erase(it);
+	return doc;
+}
+
+void IO::Data::ReleasePrefetchedDocuments(void)
+{
+	for (auto & entry : PrefetchedDocuments)
+	{
+		if (entry.second) SafeDelete(entry.second);
+	}
+
+	PrefetchedDocuments.clear();
+}
+
 Result IO::Data::LoadXMLFileIndex(TiXmlElement *node) 
 {
 	// Maintain an invocation counter to catch infinite circular links between data files
@@ -419,6 +520,10 @@ Result IO::Data::LoadModelData(TiXmlElement *node)
 	// Set defaults before loading the model
 	code = NullString;
 
+	// Models are streamed on demand unless they are required to be permanently resident, e.g. for direct use by the engine
+	const char *cresident = node->Attribute("resident");
+	bool streamed = !(cresident && strcmp(cresident, "true") == 0);
+
 	// Look at each child element in turn and pull data from them
 	TiXmlElement *child = node->FirstChildElement();
 	for (child; child; child=child->NextSiblingElement())
@@ -466,7 +571,7 @@ Result IO::Data::LoadModelData(TiXmlElement *node)
 
 	// Otherwise create a new model here
 	model = new Model();
-	Result result = model->Initialise(code, components);
+	Result result = model->Initialise(code, components, !streamed);
 
 	// Terminate if initialisation was not successful
 	if (result != ErrorCodes::NoError)
@@ -481,6 +586,7 @@ Result IO::Data::LoadModelData(TiXmlElement *node)
 
 	// Add this model to the relevant static collection and return success
 	Model::AddModel(model);
+	if (streamed) Game::Engine->GetAssetResidency().RegisterModel(model);
 
 	Game::Log << LOG_INFO << "Loaded model \"" << code << "\"\n";
 	return ErrorCodes::NoError;
@@ -518,8 +624,17 @@ Result IO::Data::LoadTextureData(TiXmlElement *node)
 		return ErrorCodes::CannotInstantiateTexture;
 	}
 
-	// Now attempt to load the texture data
+	// Streamed textures are registered with the residency manager and not loaded until first use
 	std::string filename = D::IMAGE_DATA_S + "\\" + cfilename;
+	const char *cstreaming = node->Attribute("streaming");
+	if (cstreaming && strcmp(cstreaming, "true") == 0)
+	{
+		Game::Engine->GetAssetResidency().RegisterTexture(texture, filename, dimension);
+		Game::Log << LOG_INFO << "Registered streamed texture \"" << ccode << "\"\n";
+		return ErrorCodes::NoError;
+	}
+
+	// Otherwise attempt to load the texture data immediately
 	bool loadresult = texture->LoadTexture(ConvertStringToWString(filename), dimension);
 	if (!loadresult)
 	{
@@ -623,75 +738,68 @@ Result IO::Data::LoadMaterialData(TiXmlElement *node)
 bool IO::Data::LoadObjectData(TiXmlElement *node, HashVal hash, iObject *object)
 {
 	// Compare the hash against all iObject-related fields
-	if		(hash == HashedStrings::H_Code)							object->SetCode(GetLCString(node));
-	else if (hash == HashedStrings::H_Name)							object->SetName(node->GetText());
-	else if (hash == HashedStrings::H_StandardObject)				object->SetIsStandardObject(GetBoolValue(node));
-	else if (hash == HashedStrings::H_Position)						object->SetPosition(IO::GetVector3FromAttr(node));
-	else if (hash == HashedStrings::H_Orientation)					object->SetOrientation(IO::GetQuaternionFromAttr(node));
-	else if (hash == HashedStrings::H_Model)
-	{
-		std::string modelcode = node->GetText(); StrLowerC(modelcode);
-		object->SetModel(Model::GetModel(modelcode));
+	switch (hash)
+	{
+		case HashedStrings::CH_Code:						object->SetCode(GetLCString(node)); return true;
+		case HashedStrings::CH_Name:						object->SetName(node->GetText()); return true;
+		case HashedStrings::CH_StandardObject:				object->SetIsStandardObject(GetBoolValue(node)); return true;
+		case HashedStrings::CH_Position:					object->SetPosition(IO::GetVector3FromAttr(node)); return true;
+		case HashedStrings::CH_Orientation:					object->SetOrientation(IO::GetQuaternionFromAttr(node)); return true;
+		case HashedStrings::CH_Model:
+		{
+			std::string modelcode = node->GetText(); StrLowerC(modelcode);
+			object->SetModel(Model::GetModel(modelcode));
+			return true;
+		}
+		case HashedStrings::CH_Size:						IO::Data::LoadSizeValue(node).ApplyToObject(object); return true;
+		case HashedStrings::CH_Visible:						object->SetIsVisible(GetBoolValue(node)); return true;
+		//case HashedStrings::CH_VisibilityTestingMode:		object->SetVisibilityTestingMode(TranslateVisibilityModeFromString(node->GetText())); return true;
+		case HashedStrings::CH_SimulationState:				object->SetSimulationState(iObject::TranslateSimulationStateFromString(node->GetText())); return true;	// Takes immediate effect
+		case HashedStrings::CH_CollisionMode:				object->SetCollisionMode(Game::TranslateCollisionModeFromString(node->GetText())); return true;
+		case HashedStrings::CH_CollisionOBB:				LoadCollisionOBB(object, node, object->CollisionOBB, true); return true;
+		case HashedStrings::CH_AmbientAudio:				object->SetAmbientAudio(LoadAudioParameters(node)); return true;
 	}
-	else if (hash == HashedStrings::H_Size)							IO::Data::LoadSizeValue(node).ApplyToObject(object);
-	else if (hash == HashedStrings::H_Visible)						object->SetIsVisible(GetBoolValue(node));
-	//else if (hash == HashedStrings::H_VisibilityTestingMode)		object->SetVisibilityTestingMode(TranslateVisibilityModeFromString(node->GetText()));
-	else if (hash == HashedStrings::H_SimulationState)				object->SetSimulationState(iObject::TranslateSimulationStateFromString(node->GetText()));	// Takes immediate effect
-	else if (hash == HashedStrings::H_CollisionMode)				object->SetCollisionMode(Game::TranslateCollisionModeFromString(node->GetText()));
-	else if (hash == HashedStrings::H_CollisionOBB)					LoadCollisionOBB(object, node, object->CollisionOBB, true);
-	else if (hash == HashedStrings::H_AmbientAudio)					object->SetAmbientAudio(LoadAudioParameters(node));
 
-
-	// Otherwise check against any superclasses
-	else if (LoadDamageableEntityData(node, hash, object))			return true;
-
-	// 'Else' case - none of the fields matched this hash, so return false now
-	else															return false;
-
-	// If we didn't hit the "else" clause, and return false, we must have matched one of the fields.  So return true here.
-	return true;
+	// Otherwise check against any superclasses; returns false if none of the fields matched this hash
+	return LoadDamageableEntityData(node, hash, object);
 }
 
 // Loads iTakesDamage class data, returning true if the value was loaded
 bool IO::Data::LoadDamageableEntityData(TiXmlElement *node, HashVal hash, iObject *object)
 {
 	// Compare the hash against all iTakesDamage-related fields
-	if (hash == HashedStrings::H_MaxHealth)
+	switch (hash)
 	{
-		float health = GetFloatValue(node);
-		object->SetMaxHealth(health);
-		object->SetHealth(health);
+		case HashedStrings::CH_MaxHealth:
+		{
+			float health = GetFloatValue(node);
+			object->SetMaxHealth(health);
+			object->SetHealth(health);
+			return true;
+		}
+		case HashedStrings::CH_Health:						object->SetHealth(GetFloatValue(node)); return true;		// Note: should be set AFTER max health if Health > Old_MaxHealth
+		case HashedStrings::CH_IsInvulnerable:				object->SetInvulnerabilityFlag(GetBoolValue(node)); return true;
+		case HashedStrings::CH_DamageResistanceSet:			LoadDamageResistanceSet(node, object->DamageResistanceData()); return true;
 	}
-	else if (hash == HashedStrings::H_Health)						object->SetHealth(GetFloatValue(node));		// Note: should be set AFTER max health if Health > Old_MaxHealth
-	else if (hash == HashedStrings::H_IsInvulnerable)				object->SetInvulnerabilityFlag(GetBoolValue(node));
-	else if (hash == HashedStrings::H_DamageResistanceSet)			LoadDamageResistanceSet(node, object->DamageResistanceData());
 
 	// Otherwise check against any superclasses
 	/* No superclasses */
 
-	// 'Else' case - none of the fields matched this hash, so return false now
-	else															return false;
-
-	// If we didn't hit the "else" clause, and return false, we must have matched one of the fields.  So return true here.
-	return true;
+	// None of the fields matched this hash, so return false
+	return false;
 }
 
-
 // Loads iActiveObject class data, returning true if the value was loaded
 bool IO::Data::LoadActiveObjectData(TiXmlElement *node, HashVal hash, iActiveObject *object)
 {	
 	// Compare the hash against all iActiveObject-related fields
-	if (hash == HashedStrings::H_Mass)								object->SetMass(GetFloatValue(node));
+	switch (hash)
+	{
+		case HashedStrings::CH_Mass:						object->SetMass(GetFloatValue(node)); return true;
+	}
 
 	/* Now pass to each direct superclass if we didn't match any field in this class */
-	else if (LoadObjectData(node, hash, object))					return true;
-
-	// 'Else' case - none of the fields matched this hash, so return false now
-	else															return false;
-
-	// If we didn't hit the "else" clause, and return false, we must have matched one of the direct class fields.  So return true here.
-	return true;
-	
+	return LoadObjectData(node, hash, object);
 }
 
 // Loads iStaticObject class data, returning true if the value was loaded
@@ -746,56 +854,57 @@ bool IO::Data::LoadSpaceObjectEnvironmentData(TiXmlElement *node, HashVal hash,
 	// (No direct superclasses)
 
 	// Compare the hash against all iContainsComplexShipElements-related fields
-	if (hash == HashedStrings::H_ElementSize)
-	{
-		// Initialise all elements when the element size is set.  This means element size MUST be set before elements are defined
-		object->InitialiseElements(IO::GetInt3CoordinatesFromAttr(node), false);
-	}
-	else if (hash == HashedStrings::H_ComplexShipElement)			LoadComplexShipElement(node, object);
-	else if (hash == HashedStrings::H_Terrain)
+	switch (hash)
 	{
-		Terrain *t = LoadTerrain(node);
-		if (t) object->AddTerrainObject(t);
-	}
-	else if (hash == HashedStrings::H_DynamicTerrain)
-	{
-		DynamicTerrain *t = LoadDynamicTerrain(node);
-		if (t) object->AddTerrainObject(t);
+		case HashedStrings::CH_ElementSize:
+			// Initialise all elements when the element size is set.  This means element size MUST be set before elements are defined
+			object->InitialiseElements(IO::GetInt3CoordinatesFromAttr(node), false);
+			return true;
+
+		case HashedStrings::CH_ComplexShipElement:			
+			LoadComplexShipElement(node, object);
+			return true;
+
+		case HashedStrings::CH_Terrain:
+		{
+			Terrain *t = LoadTerrain(node);
+			if (t) object->AddTerrainObject(t);
+			return true;
+		}
+
+		case HashedStrings::CH_DynamicTerrain:
+		{
+			DynamicTerrain *t = LoadDynamicTerrain(node);
+			if (t) object->AddTerrainObject(t);
+			return true;
+		}
 	}
 
 	/* Now pass to each direct superclass if we didn't match any field in this class */
 	// (No direct superclasses for the element container class)
 
-	// 'Else' case - none of the fields matched this hash, so return false now
-	else															return false;
-
-	// If we didn't hit the "else" clause, and return false, we must have matched one of the direct class fields.  So return true here.
-	return true;
-	
+	// None of the fields matched this hash, so return false
+	return false;
 }
 
 bool IO::Data::LoadShipData(TiXmlElement *node, HashVal hash, Ship *object)
 {
 	// Compare the hash against all ship-related fields
-	if		(hash == HashedStrings::H_VelocityLimit)				object->VelocityLimit.BaseValue = GetFloatValue(node);
-	else if (hash == HashedStrings::H_AngularVelocityLimit)			object->AngularVelocityLimit.BaseValue = GetFloatValue(node);
-	else if (hash == HashedStrings::H_BrakeFactor)					object->BrakeFactor.BaseValue = GetFloatValue(node);
-	else if (hash == HashedStrings::H_TurnAngle)					object->TurnAngle.BaseValue = GetFloatValue(node);
-	else if (hash == HashedStrings::H_TurnRate)						object->TurnRate.BaseValue = GetFloatValue(node);
-	else if (hash == HashedStrings::H_BankRate)						object->BankRate.BaseValue = GetFloatValue(node);
-	else if (hash == HashedStrings::H_BankExtent)					object->SetBankExtent(IO::GetVector3FromAttr(node));
-	else if (hash == HashedStrings::H_DefaultLoadout)				object->SetDefaultLoadout(GetLCString(node));
-	else if (hash == HashedStrings::H_Mass)							object->SetBaseMass(GetFloatValue(node));	// Overrides the iActiveObject behaviour, since ships have base & overall mass
+	switch (hash)
+	{
+		case HashedStrings::CH_VelocityLimit:				object->VelocityLimit.BaseValue = GetFloatValue(node); return true;
+		case HashedStrings::CH_AngularVelocityLimit:		object->AngularVelocityLimit.BaseValue = GetFloatValue(node); return true;
+		case HashedStrings::CH_BrakeFactor:					object->BrakeFactor.BaseValue = GetFloatValue(node); return true;
+		case HashedStrings::CH_TurnAngle:					object->TurnAngle.BaseValue = GetFloatValue(node); return true;
+		case HashedStrings::CH_TurnRate:					object->TurnRate.BaseValue = GetFloatValue(node); return true;
+		case HashedStrings::CH_BankRate:					object->BankRate.BaseValue = GetFloatValue(node); return true;
+		case HashedStrings::CH_BankExtent:					object->SetBankExtent(IO::GetVector3FromAttr(node)); return true;
+		case HashedStrings::CH_DefaultLoadout:				object->SetDefaultLoadout(GetLCString(node)); return true;
+		case HashedStrings::CH_Mass:						object->SetBaseMass(GetFloatValue(node)); return true;	// Overrides the iActiveObject behaviour, since ships have base & overall mass
+	}
 
 	/* Now pass to each direct superclass if we didn't match any field in this class */
-	else if (LoadSpaceObjectData(node, hash, object))				return true;
-
-	// 'Else' case - none of the fields matched this hash, so return false now
-	else															return false;
-
-	// If we didn't hit the "else" clause, and return false, we must have matched one of the fields.  So return true here.
-	return true;
-
+	return LoadSpaceObjectData(node, hash, object);
 }
 
 // Loads data for an object implementing iContainsTurrets
@@ -1989,37 +2098,35 @@ DynamicTerrain * IO::Data::LoadDynamicTerrain(TiXmlElement *node)
 bool IO::Data::LoadDynamicTerrainInstanceData(TiXmlElement *node, HashVal hash, DynamicTerrain *terrain)
 {
 	// Compare the hash against all DynamicTerrain-related fields
-	if (hash == HashedStrings::H_Position)
-	{
-		terrain->SetPosition(IO::GetVector3FromAttr(node));
-	}
-	else if (hash == HashedStrings::H_Orientation)
+	switch (hash)
 	{
-		terrain->SetOrientation(IO::GetVector4FromAttr(node));
-	}
-	else if (hash == HashedStrings::H_Extent)
-	{
-		terrain->SetExtent(IO::GetVector3FromAttr(node));
-	}
-	else if (hash == HashedStrings::H_State)
-	{
-		terrain->SetState(node->GetText());
-	}
-	else if (hash == HashedStrings::H_Property)
-	{
-		const char *key = node->Attribute("key");
-		const char *value = node->Attribute("value");
-		if (key && value) terrain->SetProperty(std::string(key), std::string(value));
-	}
+		case HashedStrings::CH_Position:
+			terrain->SetPosition(IO::GetVector3FromAttr(node));
+			return true;
 
-	// Now pass to each direct superclass if we didn't match any field in this class 
-	else if (LoadUsableObjectData(node, hash, static_cast<UsableObject*>(terrain))) return true;
+		case HashedStrings::CH_Orientation:
+			terrain->SetOrientation(IO::GetVector4FromAttr(node));
+			return true;
 
-	// 'Else' case - none of the fields matched this hash, so return false now
-	else return false;
+		case HashedStrings::CH_Extent:
+			terrain->SetExtent(IO::GetVector3FromAttr(node));
+			return true;
 
-	// If we didn't hit the "else" clause, and return false, we must have matched one of the direct class fields.  So return true here.
-	return true;
+		case HashedStrings::CH_State:
+			terrain->SetState(node->GetText());
+			return true;
+
+		case HashedStrings::CH_Property:
+		{
+			const char *key = node->Attribute("key");
+			const char *value = node->Attribute("value");
+			if (key && value) terrain->SetProperty(std::string(key), std::string(value));
+			return true;
+		}
+	}
+
+	// Now pass to each direct superclass if we didn't match any field in this class 
+	return LoadUsableObjectData(node, hash, static_cast<UsableObject*>(terrain));
 }
 
 // Loads a dynamic terrain definition and stores it in the global collection
@@ -17,6 +17,7 @@
 #include "VariableSizeValue.h"
 #include "AudioParameters.h"
 #include "InstanceFlags.h"
+#include "GameDataCache.h"
 class iStaticObject;
 class iActiveObject;
 class iSpaceObject;
@@ -62,6 +63,33 @@ namespace IO { namespace Data
 	Result LoadGameDataFile(const std::string &filename);
 	Result LoadXMLFileIndex(TiXmlElement *node);
 	Result LoadConfigFile(const std::string &filename);
+
+	// Function which loads a single top-level game data node of a particular type
+	typedef Result(*GameDataNodeLoader)(TiXmlElement *node);
+
+	// Registry of loaders for each top-level game data node type, keyed by the hash of the lowercase node name.  Holds all
+	// standard node types by default.  Registering a NULL loader will remove any existing loader for the type
+	extern std::unordered_map<HashVal, GameDataNodeLoader> GameDataNodeLoaders;
+	void RegisterGameDataNodeLoader(HashVal type, GameDataNodeLoader loader);
+	GameDataNodeLoader GetGameDataNodeLoader(HashVal type);
+
+	// Locates every game data file reachable from the given file via directories and file indices, and reads and parses
+	// them in parallel on the worker thread pool.  Files are discovered one level of indices at a time, since the includes
+	// of a file are only known once it has been parsed.  Object construction is not affected; LoadGameDataFile will still
+	// process each file serially and in the same order, but will use the prefetched document where one is available.
+	// Definitions are not built in parallel.  Creating device resources is not the obstacle, since the device is free-threaded
+	// (see AssetResidencyManager).  Rather, the node loaders register directly into the unsynchronised global definition 
+	// collections, resolve references to previously-loaded definitions by code as they go (e.g. projectile materials, noise 
+	// textures, launcher projectiles) and so depend on the serial file order, and report errors via the game log, which is 
+	// only written from the main thread.  Each loader would need its lookups deferred to a serial commit phase
+	Result PrefetchGameDataFiles(const std::string &file);
+
+	// Removes and returns the prefetched document for the given full filename, or NULL if it was not prefetched.  The
+	// caller takes ownership of the document
+	TiXmlDocument *TakePrefetchedDocument(const std::string &filename);
+
+	// Releases any prefetched documents which were not consumed during game data loading
+	void ReleasePrefetchedDocuments(void);
 	
 	// Common methods to load intermediate class data
 	bool LoadObjectData(TiXmlElement *node, HashVal hash, iObject *object);									// Loads iObject class data
@@ -227,6 +255,13 @@ namespace IO { namespace Data
 	extern std::vector<ComplexShipSection*> __TemporaryCSSLoadingBuffer;
 	ComplexShipSection *FindInTemporaryCSSBuffer(const std::string & code);
 
+	// Binary cache of parsed game data files.  Disabled unless explicitly loaded, in which case game data files are
+	// loaded from the cache where their source is unchanged
+	extern GameDataCache Cache;
+
+	// Game data documents which have been parsed ahead of time, indexed by full filename
+	extern std::unordered_map<std::string, TiXmlDocument*> PrefetchedDocuments;
+
 	// Data input logic will always maintain a record of the file currently being processed
 	extern std::string FileBeingProcessed;
 	CMPINLINE std::string GetFileCurrentlyBeingProcessed(void) { return FileBeingProcessed; }
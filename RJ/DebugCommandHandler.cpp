@@ -8,10 +8,15 @@
 #include "GameUniverse.h"
 #include "SpaceSystem.h"
 #include "Order_MoveToPosition.h"
+#include "Order_ActorTravelToPosition.h"
 #include "RJMain.h"
 #include "UserInterface.h"
 #include "Logging.h"
 #include "FrameProfiler.h"
+#include "SpatialQueryKernels.h"
+#include "ObjectSearch.h"
+#include "WorkerThreadPool.h"
+#include "NavNetwork.h"
 
 // Debug command handler needs to include the full object & tile hierarchies to support per-object command handling
 #include "Actor.h"
@@ -23,6 +28,8 @@
 #include "Ship.h"
 #include "SimpleShip.h"
 #include "SpaceEmitter.h"
+#include "ParticleEmitter.h"
+#include "RenderQueue.h"
 
 #include "ComplexShipTile.h"
 #include "CSCorridorTile.h"
@@ -203,6 +210,180 @@ bool DebugCommandHandler::ProcessConsoleCommand(GameConsoleCommand & command)
 		return true;
 	}
 
+	/* Benchmark the scalar and vectorised object search kernels */
+	else if (command.InputCommand == "benchmark_object_search")
+	{
+		int queries = (command.Parameter(0) == "" ? 100 : command.ParameterAsInt(0));
+		float distance = (command.Parameter(1) == "" ? 10000.0f : command.ParameterAsFloat(1));
+		SpatialQueryKernels::RunBenchmark({ 1000U, 10000U, 100000U }, queries);
+		Game::Search<iObject>().RunBenchmark(Game::Universe->GetCurrentSystem().SpatialPartitioningTree, queries, distance);
+		command.SetSuccessOutput("Object search benchmark completed; results written to debug log");
+		return true;
+	}
+
+	/* Benchmark the particle emitter update and billboard expansion passes */
+	else if (command.InputCommand == "benchmark_particles")
+	{
+		int frames = (command.Parameter(0) == "" ? 100 : command.ParameterAsInt(0));
+		ParticleEmitter::RunBenchmark({ 1000, 10000, 50000 }, frames);
+		command.SetSuccessOutput("Particle emitter benchmark completed; results written to debug log");
+		return true;
+	}
+
+	/* Benchmark the render queue sort against a comparison sort */
+	else if (command.InputCommand == "benchmark_render_queue")
+	{
+		int iterations = (command.Parameter(0) == "" ? 100 : command.ParameterAsInt(0));
+		RenderQueue::RunBenchmark({ 1000U, 10000U, 100000U }, iterations);
+		command.SetSuccessOutput("Render queue sort benchmark completed; results written to debug log");
+		return true;
+	}
+
+	/* Get or set the method used to simulate basic projectiles */
+	else if (command.InputCommand == "projectile_simulation")
+	{
+		std::string mode = StrLower(command.Parameter(0));
+		if (mode == "individual")		BasicProjectileSet::SetSimulationMode(BasicProjectileSet::SimulationMode::PerProjectile);
+		else if (mode == "batched")		BasicProjectileSet::SetSimulationMode(BasicProjectileSet::SimulationMode::Batched);
+		else if (mode == "parallel")	BasicProjectileSet::SetSimulationMode(BasicProjectileSet::SimulationMode::Parallel);
+		else if (mode != NullString) {
+			command.SetOutput(GameConsoleCommand::CommandResult::Failure, ErrorCodes::InvalidParameters,
+				"Invalid parameters.  Usage: \"projectile_simulation [individual | batched | parallel]\"");
+			return true;
+		}
+
+		BasicProjectileSet::SimulationMode current = BasicProjectileSet::GetSimulationMode();
+		command.SetSuccessOutput(concat("Projectile simulation mode: ")
+			(current == BasicProjectileSet::SimulationMode::Parallel ? concat("parallel (")(Game::WorkerThreads.GetWorkerCount())(" worker threads)").str() :
+			(current == BasicProjectileSet::SimulationMode::Batched ? "batched" : "individual"))
+			(" (")(Game::Universe->GetCurrentSystem().Projectiles.GetActiveProjectileCount())(" active projectiles in current system)").str());
+		return true;
+	}
+
+	/* Get or set the mode used by the central scheduler to execute due updates */
+	else if (command.InputCommand == "scheduler_mode")
+	{
+		std::string mode = StrLower(command.Parameter(0));
+		if (mode == "serial")			Game::Scheduler.SetSchedulerMode(CentralScheduler::SchedulerMode::Serial);
+		else if (mode == "parallel")	Game::Scheduler.SetSchedulerMode(CentralScheduler::SchedulerMode::Parallel);
+		else if (mode != NullString) {
+			command.SetOutput(GameConsoleCommand::CommandResult::Failure, ErrorCodes::InvalidParameters,
+				"Invalid parameters.  Usage: \"scheduler_mode [serial | parallel]\"");
+			return true;
+		}
+
+		command.SetSuccessOutput(Game::Scheduler.GetSchedulerMode() == CentralScheduler::SchedulerMode::Parallel ?
+			concat("Scheduler mode: parallel (")(Game::WorkerThreads.GetWorkerCount())(" worker threads)").str() :
+			"Scheduler mode: serial");
+		return true;
+	}
+
+	/* Report or reset the per-item execution timing collected by the central scheduler */
+	else if (command.InputCommand == "scheduler_timing")
+	{
+		if (StrLower(command.Parameter(0)) == "reset")
+		{
+			Game::Scheduler.ResetTimingStatistics();
+			command.SetSuccessOutput("Scheduler timing statistics reset");
+			return true;
+		}
+
+		Game::Log << LOG_INFO << Game::Scheduler.GetTimingReport();
+		command.SetSuccessOutput("Scheduler timing report written to debug log");
+		return true;
+	}
+
+	/* Get or set the mode used to simulate environment interiors */
+	else if (command.InputCommand == "environment_simulation")
+	{
+		std::string mode = StrLower(command.Parameter(0));
+		if (mode == "serial")			iSpaceObjectEnvironment::SetInteriorSimulationMode(iSpaceObjectEnvironment::InteriorSimulationMode::Serial);
+		else if (mode == "parallel")	iSpaceObjectEnvironment::SetInteriorSimulationMode(iSpaceObjectEnvironment::InteriorSimulationMode::Parallel);
+		else if (mode != NullString) {
+			command.SetOutput(GameConsoleCommand::CommandResult::Failure, ErrorCodes::InvalidParameters,
+				"Invalid parameters.  Usage: \"environment_simulation [serial | parallel]\"");
+			return true;
+		}
+
+		command.SetSuccessOutput(iSpaceObjectEnvironment::GetInteriorSimulationMode() == iSpaceObjectEnvironment::InteriorSimulationMode::Parallel ?
+			concat("Environment interior simulation: parallel (")(Game::WorkerThreads.GetWorkerCount())(" worker threads, ")
+				(Game::Universe->GetCurrentSystem().GetLastEnvironmentBatchSize())(" environments in last batch)").str() :
+			"Environment interior simulation: serial");
+		return true;
+	}
+
+	/* Get or set the kernel used to update environment oxygen and power maps */
+	else if (command.InputCommand == "environment_map_kernel")
+	{
+		std::string kernel = StrLower(command.Parameter(0));
+		if (kernel == "propagation")	Oxygen::USE_STENCIL_KERNEL = Power::USE_STENCIL_KERNEL = false;
+		else if (kernel == "stencil")	Oxygen::USE_STENCIL_KERNEL = Power::USE_STENCIL_KERNEL = true;
+		else if (kernel != NullString) {
+			command.SetOutput(GameConsoleCommand::CommandResult::Failure, ErrorCodes::InvalidParameters,
+				"Invalid parameters.  Usage: \"environment_map_kernel [propagation | stencil]\"");
+			return true;
+		}
+
+		command.SetSuccessOutput(concat("Environment map kernel: oxygen = ")(Oxygen::USE_STENCIL_KERNEL ? "stencil" : "propagation")
+			(", power = ")(Power::USE_STENCIL_KERNEL ? "stencil" : "propagation").str());
+		return true;
+	}
+
+	/* Select the method used to resolve navigation network paths */
+	else if (command.InputCommand == "nav_pathfinding")
+	{
+		std::string method = StrLower(command.Parameter(0));
+		if (method == "flat")				NavNetwork::USE_HIERARCHICAL_PATHFINDING = false;
+		else if (method == "hierarchical")	NavNetwork::USE_HIERARCHICAL_PATHFINDING = true;
+		else if (method != NullString) {
+			command.SetOutput(GameConsoleCommand::CommandResult::Failure, ErrorCodes::InvalidParameters,
+				"Invalid parameters.  Usage: \"nav_pathfinding [flat | hierarchical]\"");
+			return true;
+		}
+
+		command.SetSuccessOutput(concat("Nav network pathfinding: ")(NavNetwork::USE_HIERARCHICAL_PATHFINDING ? "hierarchical" : "flat").str());
+		return true;
+	}
+	else if (command.InputCommand == "nav_path_cache")
+	{
+		std::string state = StrLower(command.Parameter(0));
+		if (state == "on")					NavNetwork::USE_PATH_CACHE = true;
+		else if (state == "off")			NavNetwork::USE_PATH_CACHE = false;
+		else if (state != NullString) {
+			command.SetOutput(GameConsoleCommand::CommandResult::Failure, ErrorCodes::InvalidParameters,
+				"Invalid parameters.  Usage: \"nav_path_cache [on | off]\"");
+			return true;
+		}
+
+		command.SetSuccessOutput(concat("Nav network path cache: ")(NavNetwork::USE_PATH_CACHE ? "on" : "off").str());
+		return true;
+	}
+
+	/* Order every actor in the player's environment to travel to the specified position.  Paths are resolved as a single batch on first execution */
+	else if (command.InputCommand == "actors_travel_to")
+	{
+		iSpaceObjectEnvironment *env = Game::CurrentPlayer->GetParentEnvironment();
+		if (!env || !env->GetNavNetwork()) { command.SetOutput(GameConsoleCommand::CommandResult::Failure, ErrorCodes::ObjectIsNotEnvironment,
+				"Player is not currently within a navigable environment"); return true; }
+		if (command.Parameter(2) == NullString) { command.SetOutput(GameConsoleCommand::CommandResult::Failure, ErrorCodes::InvalidParameters,
+				"Invalid parameters.  Usage: \"actors_travel_to <x> <y> <z>\""); return true; }
+
+		XMVECTOR target = XMVectorSet(command.ParameterAsFloat(0), command.ParameterAsFloat(1), command.ParameterAsFloat(2), 0.0f);
+		size_t issued = 0U;
+		for (const auto & obj : env->Objects)
+		{
+			if (!obj() || obj()->GetObjectType() != iObject::ObjectType::ActorObject || obj() == Game::CurrentPlayer->GetActor()) continue;
+
+			Actor *actor = (Actor*)obj();
+			Order_ActorTravelToPosition *order = new Order_ActorTravelToPosition(env, actor->GetEnvironmentPosition(), target, 1.0f, 1.0f, false);
+			if (actor->AssignNewOrder(order) == 0) { delete order; continue; }
+			++issued;
+		}
+
+		command.SetSuccessOutput(concat("Issued travel orders to ")(issued)(" actors").str());
+		return true;
+	}
+
 	/* Adjust various oxygen simulation parameters */
 	else if (command.InputCommand == "get_oxygen_falloff") { command.SetSuccessOutput(concat("Oxygen falloff rate = ")(Oxygen::BASE_OXYGEN_FALLOFF)(" units\\sec").str().c_str()); return true; }
 	else if (command.InputCommand == "set_oxygen_falloff")
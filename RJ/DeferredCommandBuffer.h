@@ -0,0 +1,51 @@
+#pragma once
+
+#ifndef __DeferredCommandBufferH__
+#define __DeferredCommandBufferH__
+
+#include <vector>
+#include <functional>
+#include "CompilerSettings.h"
+
+
+// Ordered buffer of commands whose execution is deferred until a later synchronisation point.  Used to hold side-effects
+// raised during parallel work that cannot be applied until every parallel task has completed.  The buffer itself is not
+// synchronised; each buffer should only be written by one thread at a time
+// Class has no special alignment requirements
+class DeferredCommandBuffer
+{
+public:
+
+	// A single deferred command
+	typedef std::function<void(void)>					Command;
+
+	// Adds a command to the end of the buffer
+	CMPINLINE void										Defer(Command && command)			{ m_commands.push_back(std::move(command)); }
+
+	// Returns the number of commands currently held in the buffer
+	CMPINLINE size_t									GetCommandCount(void) const			{ return m_commands.size(); }
+	CMPINLINE bool										IsEmpty(void) const					{ return m_commands.empty(); }
+
+	// Executes every command in the order it was deferred, then clears the buffer.  Commands may themselves defer
+	// further commands to the same buffer, which will be executed within the same call
+	CMPINLINE void										Execute(void)
+	{
+		for (std::vector<Command>::size_type i = 0U; i < m_commands.size(); ++i)
+		{
+			// Take ownership before executing, since the command may append to (and reallocate) the buffer
+			Command command = std::move(m_commands[i]);
+			command();
+		}
+		m_commands.clear();
+	}
+
+	// Discards all commands without executing them
+	CMPINLINE void										Clear(void)							{ m_commands.clear(); }
+
+protected:
+
+	std::vector<Command>								m_commands;
+};
+
+
+#endif
@@ -9,6 +9,8 @@
 #include "EnvironmentMapFalloffMethod.h"
 #include "ComplexShipElement.h"
 #include "PrecalculatedRandomSequence.h"
+#include "WorkerThreadPool.h"
+#include "GameVarsExtern.h"
 
 // Compiler flag which can be set to enable output of map-related debug information during each update
 //#define ENV_MAP_DEBUG_OUTPUT
@@ -33,6 +35,13 @@ public:
 	enum EmissionBehaviour { EmissionRemainsInSource = 0, EmissionRemovedFromSource };
 	enum TransferProfile { NormalTransferProfile = 0, ManhattanAdjacencyTransferProfile };
 
+	// Kernel used to propogate value through the map.  'Propagation' performs a flood-fill outwards from each source
+	// cell in turn.  'Stencil' instead iterates a double-buffered, vectorised stencil over the entire map using per-cell
+	// transmission masks that are precalculated once per layout change.  Under the stencil kernel, value diffuses between
+	// adjacent cells if emission is removed from the source, or spreads as a falloff-attenuated maximum if emission 
+	// remains in the source.  Blend modes are not applied by the stencil kernel
+	enum ExecutionKernel { PropagationKernel = 0, StencilKernel };
+
 	// Map data
 	std::vector<T>									Data;
 
@@ -64,6 +73,14 @@ public:
 	// Sets the maximum amount of value that can be transferred in the current cycle
 	EnvironmentMap &								WithTransferLimit(T transfer_limit);
 
+	// Specifies that only the connected regions of the map affected by changes since the last update will be recalculated.  
+	// Changes include any added, removed or modified source cells, any cells set via SetCellValue(), and any change in the
+	// transmission state of elements.  All other regions retain their existing values
+	EnvironmentMap &								WithDirtyRegionUpdate(void);
+
+	// Specifies that a dirty-region update should also recalculate every connected region which currently holds any value
+	EnvironmentMap &								WithNonZeroRegionsUpdated(void);
+
 	// Executes an update of the map.  Accepts a reference to the underlying element collection as a mandatory parameter
 	Result											Execute(const ComplexShipElement *elements);
 
@@ -71,7 +88,18 @@ public:
 	CMPINLINE T										GetCellValue(int index) const { return Data[index]; }
 
 	// Sets the value of a specific map cell
-	CMPINLINE void									SetCellValue(int index, T value) { Data[index] = value; }
+	CMPINLINE void									SetCellValue(int index, T value) { Data[index] = value; MarkCellDirty(index); }
+
+	// Marks cells as requiring recalculation in the next dirty-region update.  Only required if map data is modified
+	// directly, since changes made via SetCellValue() are tracked automatically
+	CMPINLINE void									MarkCellDirty(int index) { m_dirty_cells.push_back(index); }
+	CMPINLINE void									MarkAllCellsDirty(void) { m_all_cells_dirty = true; }
+
+	// Returns the number of cells recalculated in the last update
+	CMPINLINE size_t								GetLastUpdateCellCount(void) const { return m_last_update_cell_count; }
+
+	// Returns the number of connected regions in the map, as of the last dirty-region update
+	CMPINLINE int									GetConnectedRegionCount(void) const { return (int)m_region_totals.size(); }
 
 	// Returns the properties that allow transmission of value through the map
 	CMPINLINE bitstring								GetTransmissionProperties(void) const { return m_transmission_properties; }
@@ -104,10 +132,27 @@ public:
 	// while being propogated (less any falloff) to the destination cell
 	void											SetEmissionBehaviour(EmissionBehaviour behaviour);
 
+	// Returns or sets the kernel used to propogate value through the map
+	CMPINLINE ExecutionKernel						GetExecutionKernel(void) const { return m_kernel; }
+	CMPINLINE void									SetExecutionKernel(ExecutionKernel kernel) { m_kernel = kernel; }
+
+	// Sets the number of diffusion iterations performed in each update by the stencil kernel.  The transfer limit
+	// is divided evenly between iterations
+	CMPINLINE void									SetStencilDiffusionIterations(unsigned int iterations) { m_stencil_diffusion_iterations = max(iterations, 1U); }
+
+	// Maps with at least this many elements will split each stencil iteration across the worker thread pool, by z-slice.
+	// A threshold of zero disables threading
+	CMPINLINE void									SetParallelSliceThreshold(size_t threshold) { m_parallel_slice_threshold = threshold; }
+
+	// Invalidates the per-cell transmission data used by the stencil kernel and dirty-region updates.  Should be called 
+	// whenever the properties of the underlying elements change; data will be recalculated on the next update
+	CMPINLINE void									InvalidateTransmissionData(void) { m_transmission_masks_valid = false; m_regions_valid = false; }
+
 	// Immediately set the value of every cell to the specified value
 	CMPINLINE void									InitialiseCellValues(T value)
 	{
 		for (std::vector<T>::size_type i = 0; i < m_elementcount; ++i) Data[i] = value;
+		MarkAllCellsDirty();
 	}
 
 	// Immediately set the value of every cell to a value within the specified range
@@ -115,6 +160,7 @@ public:
 	{
 		float value_range = (float)(max_value - min_value);		// Store as float to avoid recasting in each operation
 		for (std::vector<T>::size_type i = 0; i < m_elementcount; ++i) Data[i] = (min_value + (T)(frand() * value_range));
+		MarkAllCellsDirty();
 	}
 
 	// Returns the total amount of value currently present in the map
@@ -132,6 +178,10 @@ public:
 	static const bitstring							DEFAULT_TRANSMISSION_PROPERTIES;
 	static const bitstring							DEFAULT_BLOCKING_PROPERTIES;	
 
+	// Default parameters for the stencil kernel
+	static const unsigned int						DEFAULT_STENCIL_DIFFUSION_ITERATIONS = 4U;
+	static const size_t								DEFAULT_PARALLEL_SLICE_THRESHOLD = 65536U;
+
 	
 
 protected:
@@ -212,13 +262,125 @@ protected:
 	// Store a local copy of T-zero for efficiency / cache coherency during tight loop updates
 	T												m_zero;
 
+
+	// Executes the propogation of source values through the map, using the selected kernel
+	void											ExecutePropagationKernel(const ComplexShipElement *elements);
+	void											ExecuteStencilKernel(const ComplexShipElement *elements);
+
+	// Precalculates the per-cell transmission masks used by the stencil kernel
+	void											BuildTransmissionMasks(const ComplexShipElement *elements);
+
+	// Indicates whether value can be transmitted into the given element
+	CMPINLINE bool									IsTransmissive(const ComplexShipElement & element) const
+	{
+		bitstring properties = element.GetProperties();
+		return !(CheckBit_All_NotSet(properties, m_transmission_properties) || CheckBit_Any(properties, m_blocking_properties));
+	}
+
+	// Returns the value of a cell after applying any pre-processing, or any post-processing value constraints
+	T												PreProcessedCellValue(T value) const;
+	T												ConstrainedCellValue(T value) const;
+
+	// Determines the set of cells to be recalculated in a dirty-region update, and removes any source cells which cannot
+	// affect them.  Returns false if no cells need to be recalculated
+	bool											PrepareDirtyRegionUpdate(const ComplexShipElement *elements);
+
+	// Labels each connected region of transmissive cells, and marks any cells whose transmission state has changed as dirty
+	void											BuildConnectedRegions(const ComplexShipElement *elements);
+
+	// Determines the set of connected regions which value at the given cell can propogate into
+	void											GetAffectedRegions(const ComplexShipElement *elements, int index, std::vector<int> & outRegions) const;
+
+	// Recalculates the total value held in each region updated in the last cycle
+	void											UpdateRegionTotals(void);
+
+	// Returns a new generation value for the per-cell visit stamps, so that all cells are considered unvisited
+	unsigned int									NextVisitGeneration(void);
+
+	// Performs one stencil iteration over the full map, then swaps the front and back buffers.  Returns a flag
+	// indicating whether any cell value changed
+	bool											ExecuteStencilIteration(bool diffusion);
+
+	// Evaluates the stencil over the cell range [begin, end), reading from 'src' and writing to 'dest'.  Returns a flag
+	// indicating whether any cell value changed
+	bool											StencilDiffusionRange(const float *src, float *dest, int begin, int end) const;
+	bool											StencilMaximumRange(const float *src, float *dest, int begin, int end) const;
+
+	// Scalar evaluation of the stencil for a single cell, used for any cells not covered by the vectorised path
+	float											StencilDiffusionCell(const float *src, int index) const;
+	float											StencilMaximumCell(const float *src, int index) const;
+
+	// Bits within each transmission mask.  The low bits indicate that value may flow into the cell from the neighbour
+	// in each direction; the high bits indicate that value may flow out of the cell to the neighbour in each direction
+	static CMPINLINE uint32_t						InflowBit(int direction) { return (1U << direction); }
+	static CMPINLINE uint32_t						OutflowBit(int direction) { return (1U << (16 + direction)); }
+
+	// Kernel used to propogate value through the map
+	ExecutionKernel									m_kernel;
+
+	// Per-cell visit stamps, used to track visited cells without clearing a full-map array on each traversal
+	std::vector<unsigned int>						m_visit_stamp;
+	unsigned int									m_visit_generation;
+
+	// Changes since the last update, which determine the cells recalculated in a dirty-region update
+	std::vector<int>								m_dirty_cells;
+	bool											m_all_cells_dirty;
+	std::vector<MapCell>							m_previous_sources;
+
+	// Flags determining whether this update is a dirty-region update, and whether it is currently restricted to 'm_update_cells'
+	bool											m_dirty_region_update;
+	bool											m_update_nonzero_regions;
+	bool											m_restricted_update;
+	std::vector<int>								m_update_cells;
+	size_t											m_last_update_cell_count;
+
+	// Connected regions of transmissive cells, between which value can never pass.  Cells of each region are held 
+	// contiguously in 'm_region_cells', beginning at the offset for that region.  Non-transmissive cells have region -1
+	std::vector<int>								m_region_ids;
+	std::vector<int>								m_region_offsets;
+	std::vector<int>								m_region_cells;
+	std::vector<T>									m_region_totals;
+	std::vector<unsigned char>						m_region_dirty;
+	std::vector<unsigned char>						m_transmissive;
+	bool											m_regions_valid;
+	const ComplexShipElement *						m_region_elements;
+
+	// Per-cell transmission masks, and the element collection they were last calculated against
+	std::vector<uint32_t>							m_transmission_masks;
+	bool											m_transmission_masks_valid;
+	const ComplexShipElement *						m_transmission_mask_elements;
+
+	// Set of directions which value can propogate in under the current transfer profile
+	std::vector<int>								m_stencil_directions;
+
+	// Double-buffered working data for the stencil kernel.  Each buffer is padded by 'm_stencil_padding' zero-value cells
+	// at either end, so that neighbour reads for all cells (including whole vectors at the map boundary) remain in bounds
+	std::vector<float>								m_stencil_buffer[2];
+	int												m_stencil_front;
+	int												m_stencil_padding;
+
+	// Stencil kernel parameters
+	unsigned int									m_stencil_diffusion_iterations;
+	size_t											m_parallel_slice_threshold;
+
+	// Per-update stencil parameters.  Falloff is expressed as (value * multiplier) + modifier in each direction
+	float											m_stencil_falloff_mul[Direction::_Count];
+	float											m_stencil_falloff_add[Direction::_Count];
+	float											m_stencil_rate;
+	float											m_stencil_limit;
+	float											m_stencil_threshold;
+
 };
 
 // Constructor; accepts dimensions of the area to to represented
 template <typename T, template<typename> class TBlendMode>
 EnvironmentMap<T, TBlendMode>::EnvironmentMap(const INTVECTOR3 & element_size)
 	: 
-	m_zero(DefaultValues<T>::NullValue())
+	m_zero(DefaultValues<T>::NullValue()), m_kernel(ExecutionKernel::PropagationKernel), m_visit_generation(0U), 
+	m_all_cells_dirty(true), m_dirty_region_update(false), m_update_nonzero_regions(false), m_restricted_update(false), 
+	m_last_update_cell_count(0U), m_regions_valid(false), m_region_elements(NULL), 
+	m_transmission_masks_valid(false), m_transmission_mask_elements(NULL), m_stencil_front(0), m_stencil_padding(0), 
+	m_stencil_diffusion_iterations(DEFAULT_STENCIL_DIFFUSION_ITERATIONS), m_parallel_slice_threshold(DEFAULT_PARALLEL_SLICE_THRESHOLD)
 {
 	// Determine element space size and dimensions
 	SetElementSize(element_size);
@@ -252,6 +414,13 @@ void EnvironmentMap<T, TBlendMode>::SetElementSize(const INTVECTOR3 & element_si
 
 	// Initialise the data array for this map
 	Data = std::vector<T>(m_elementcount);
+
+	// Any precalculated transmission data is no longer valid, and all cells must be recalculated
+	InvalidateTransmissionData();
+	m_transmissive.clear();
+	m_previous_sources.clear();
+	m_dirty_cells.clear();
+	MarkAllCellsDirty();
 }
 
 // Initialises all update-relevant fields to their default starting values, before they are potentially
@@ -269,6 +438,9 @@ void EnvironmentMap<T, TBlendMode>::InitialiseUpdateParameters(void)
 	m_initial_value_max = DefaultValues<T>::NullValue();
 
 	m_transfer_limit = DefaultValues<T>::MaxValue();
+
+	m_dirty_region_update = false;
+	m_update_nonzero_regions = false;
 }
 
 // Begins an update of the environment map
@@ -362,6 +534,22 @@ EnvironmentMap<T, TBlendMode> & EnvironmentMap<T, TBlendMode>::WithTransferLimit
 	return *this;
 }
 
+// Specifies that only the connected regions of the map affected by changes since the last update will be recalculated
+template <typename T, template<typename> class TBlendMode>
+EnvironmentMap<T, TBlendMode> & EnvironmentMap<T, TBlendMode>::WithDirtyRegionUpdate(void)
+{
+	m_dirty_region_update = true;
+	return *this;
+}
+
+// Specifies that a dirty-region update should also recalculate every connected region which currently holds any value
+template <typename T, template<typename> class TBlendMode>
+EnvironmentMap<T, TBlendMode> & EnvironmentMap<T, TBlendMode>::WithNonZeroRegionsUpdated(void)
+{
+	m_update_nonzero_regions = true;
+	return *this;
+}
+
 
 // Initialise transmission-relevant property constants
 template <typename T, template<typename> class TBlendMode> 
@@ -393,6 +581,8 @@ void EnvironmentMap<T, TBlendMode>::PropertyParametersUpdated(void)
 		(m_transmission_properties != DEFAULT_TRANSMISSION_PROPERTIES) ||
 		(m_blocking_properties != DEFAULT_BLOCKING_PROPERTIES)
 	);
+
+	InvalidateTransmissionData();
 }
 
 
@@ -420,6 +610,15 @@ void EnvironmentMap<T, TBlendMode>::SetTransferProfile(TransferProfile transfer_
 		m_direction_sequence_data = PrecalculatedRandomSequence<int>(0, (int)Direction::_Count, (int)Direction::_Count, 100, true);
 		m_direction_sequence_length = (unsigned int)Direction::_Count;
 	}
+
+	// Store the same set of directions for use by the stencil kernel
+	m_stencil_directions.clear();
+	if (m_transferprofile == TransferProfile::ManhattanAdjacencyTransferProfile)
+		m_stencil_directions.insert(m_stencil_directions.end(), ManhattanDirections, ManhattanDirections + ManhattanDirectionCount);
+	else
+		for (int i = 0; i < (int)Direction::_Count; ++i) m_stencil_directions.push_back(i);
+
+	InvalidateTransmissionData();
 }
 
 // Sets the 'zero threshold', below which we consider the value to have fallen to insignificance and cease processing it
@@ -494,8 +693,26 @@ Result EnvironmentMap<T, TBlendMode>::Execute(const ComplexShipElement *elements
 		ENV_MAP_DEBUG_LOG("}\n");
 #	endif
 
+	// Determine the set of cells which need to be recalculated, if this is a dirty-region update.  Exit immediately
+	// if nothing has changed since the last update
+	m_restricted_update = false;
+	if (m_dirty_region_update && elements != NULL && !PrepareDirtyRegionUpdate(elements))
+	{
+		ENV_MAP_DEBUG_LOG("No changes since last update; no cells require recalculation\n");
+		m_dirty_cells.clear();
+		m_last_update_cell_count = 0U;
+		return ErrorCodes::NoError;
+	}
+
+	// Only pre-process the affected cells if this update is restricted to a subset of the map
+	if (m_restricted_update)
+	{
+		ENV_MAP_DEBUG_LOG(concat("Pre-processing ")(m_update_cells.size())(" cells in dirty regions\n").str().c_str());
+		for (int index : m_update_cells) Data[index] = PreProcessedCellValue(Data[index]);
+	}
+
 	// Set initial value for all cells, UNLESS we have chosen to retain the existing data
-	if (!m_preserve_existing_data)
+	else if (!m_preserve_existing_data)
 	{
 		ENV_MAP_DEBUG_LOG("Initialising all cells to starting values\n");
 		if (m_fixed_initial_value)
@@ -528,10 +745,42 @@ Result EnvironmentMap<T, TBlendMode>::Execute(const ComplexShipElement *elements
 	// have that reference, in which case all elements will simply be set to their initial values
 	if (elements == NULL) return ErrorCodes::CannotEvaluateEnvironmentMapWithoutElementRef;
 
-	// We maintain a fixed array of values to indicate when a value has been updated.  Use int rather than bool
-	// so we can quickly revert via memset on each cycle
-	int *updated = new int[m_elementcount];
-	size_t update_size = (sizeof(int) * m_elementcount);
+	// Propogate all source values through the map using the selected kernel
+	if (m_kernel == ExecutionKernel::StencilKernel)
+		ExecuteStencilKernel(elements);
+	else
+		ExecutePropagationKernel(elements);
+
+
+	// Apply any post-processing value constraints
+	if (m_restricted_update)
+		for (int index : m_update_cells) Data[index] = ConstrainedCellValue(Data[index]);
+	else if (m_value_constraints == MapValueConstraints::ValueClamped)
+		for (std::vector<T>::size_type i = 0; i < m_elementcount; ++i) Data[i] = clamp(Data[i], m_value_floor, m_value_ceiling);
+	else if (m_value_constraints == MapValueConstraints::ValueFloor)
+		for (std::vector<T>::size_type i = 0; i < m_elementcount; ++i) Data[i] = max(Data[i], m_value_floor);
+	else if (m_value_constraints == MapValueConstraints::ValueCeiling)
+		for (std::vector<T>::size_type i = 0; i < m_elementcount; ++i) Data[i] = min(Data[i], m_value_ceiling);
+
+	// All changes have now been applied.  Record the new value of any regions we recalculated
+	m_last_update_cell_count = (m_restricted_update ? m_update_cells.size() : m_elementcount);
+	m_dirty_cells.clear();
+	m_all_cells_dirty = false;
+	UpdateRegionTotals();
+
+
+	// Return success
+	ENV_MAP_DEBUG_LOG("Environment map update completed\n");
+	return ErrorCodes::NoError;
+}
+
+// Propogates source values through the map via a flood-fill outwards from each source cell in turn
+template <typename T, template<typename> class TBlendMode>
+void EnvironmentMap<T, TBlendMode>::ExecutePropagationKernel(const ComplexShipElement *elements)
+{
+	// We maintain a per-cell visit stamp to indicate when a value has been updated.  A new generation is used for each
+	// source, so that the whole array does not need to be cleared on each cycle
+	unsigned int generation;
 
 	// Process each source cell in turn
 	std::vector<std::vector<T>::size_type> queue;
@@ -541,7 +790,7 @@ Result EnvironmentMap<T, TBlendMode>::Execute(const ComplexShipElement *elements
 	{
 		// Initialise the update tracking array for this cycle
 		ENV_MAP_DEBUG_LOG(concat("> Beginning update for source ")((*it).Index)("\n").str().c_str());
-		memset(updated, 0, update_size);
+		generation = NextVisitGeneration();
 
 		// Initialise the value of the source cell
 		// TODO: this may result in source cells having a value lower than their neighbours, if they are in a range
@@ -553,7 +802,7 @@ Result EnvironmentMap<T, TBlendMode>::Execute(const ComplexShipElement *elements
 		queue.clear(); 
 		queue.push_back(index);
 		queue_index = 0U;
-		updated[index] = 1;
+		m_visit_stamp[index] = generation;
 
 		// Now calculate the recursive transmission to all neighbouring cells via non-recursive vector traversal
 		while (queue_index < queue.size())
@@ -575,8 +824,8 @@ Result EnvironmentMap<T, TBlendMode>::Execute(const ComplexShipElement *elements
 				Direction direction = (Direction)directions[i];
 				int neighbour = el.GetNeighbour(direction);
 				if (neighbour == -1) continue;									// Must be within the environment map area; -1 signifies not a valid element
-				if (updated[neighbour] != 0) continue;							// Ignore any elements we have already updated
-				updated[neighbour] = 1;											// Mark this neighbour as processed
+				if (m_visit_stamp[neighbour] == generation) continue;			// Ignore any elements we have already updated
+				m_visit_stamp[neighbour] = generation;							// Mark this neighbour as processed
 
 				// Check against both transmission and blocking element properties
 				bitstring neighbour_properties = elements[neighbour].GetProperties();
@@ -611,23 +860,492 @@ Result EnvironmentMap<T, TBlendMode>::Execute(const ComplexShipElement *elements
 		}
 
 	}
+}
 
-	// Delete any temporarily-allocate memory
-	delete[] updated;
+// Returns the value of a cell after applying any pre-processing
+template <typename T, template<typename> class TBlendMode>
+T EnvironmentMap<T, TBlendMode>::PreProcessedCellValue(T value) const
+{
+	if (!m_preserve_existing_data)
+		return (m_fixed_initial_value ? m_initial_value : (m_initial_value_min + (T)(frand() * (float)(m_initial_value_max - m_initial_value_min))));
+	else if (m_update_existing_data == ExistingDataUpdate::AdditiveUpdate)
+		return ((std::max)(m_zero, value + m_existing_data_additive_update));
+	else if (m_update_existing_data == ExistingDataUpdate::MultiplicativeUpdate)
+		return (T)((float)value * m_existing_data_multiplicative_update);
+	else
+		return value;
+}
 
+// Returns the value of a cell after applying any post-processing value constraints
+template <typename T, template<typename> class TBlendMode>
+T EnvironmentMap<T, TBlendMode>::ConstrainedCellValue(T value) const
+{
+	switch (m_value_constraints)
+	{
+		case MapValueConstraints::ValueClamped:		return clamp(value, m_value_floor, m_value_ceiling);
+		case MapValueConstraints::ValueFloor:		return max(value, m_value_floor);
+		case MapValueConstraints::ValueCeiling:		return min(value, m_value_ceiling);
+		default:									return value;
+	}
+}
 
-	// Apply any post-processing value constraints
-	if (m_value_constraints == MapValueConstraints::ValueClamped)
-		for (std::vector<T>::size_type i = 0; i < m_elementcount; ++i) Data[i] = clamp(Data[i], m_value_floor, m_value_ceiling);
-	else if (m_value_constraints == MapValueConstraints::ValueFloor)
-		for (std::vector<T>::size_type i = 0; i < m_elementcount; ++i) Data[i] = max(Data[i], m_value_floor);
-	else if (m_value_constraints == MapValueConstraints::ValueCeiling)
-		for (std::vector<T>::size_type i = 0; i < m_elementcount; ++i) Data[i] = min(Data[i], m_value_ceiling);
+// Determines the set of cells to be recalculated in a dirty-region update, and removes any source cells which cannot
+// affect them.  Returns false if no cells need to be recalculated
+template <typename T, template<typename> class TBlendMode>
+bool EnvironmentMap<T, TBlendMode>::PrepareDirtyRegionUpdate(const ComplexShipElement *elements)
+{
+	// Relabel regions if the layout may have changed.  This will mark any cells with changed transmission state as dirty
+	if (!m_regions_valid || elements != m_region_elements) BuildConnectedRegions(elements);
 
+	// Any source which has been added, removed or modified since the last update is dirty
+	auto contains_source = [](const std::vector<MapCell> & sources, const MapCell & source)
+	{
+		for (const MapCell & cell : sources) if (cell.Index == source.Index && cell.Value == source.Value) return true;
+		return false;
+	};
+	for (const MapCell & source : m_sources) if (!contains_source(m_previous_sources, source)) MarkCellDirty(source.Index);
+	for (const MapCell & source : m_previous_sources) if (!contains_source(m_sources, source)) MarkCellDirty(source.Index);
+	m_previous_sources = m_sources;
 
-	// Return success
-	ENV_MAP_DEBUG_LOG("Environment map update completed\n");
-	return ErrorCodes::NoError;
+	// Perform a full update if every cell is dirty
+	if (m_all_cells_dirty) return true;
+
+	// Determine the set of regions which need to be recalculated
+	int region_count = GetConnectedRegionCount();
+	m_region_dirty.assign(region_count, 0);
+	if (m_update_nonzero_regions)
+	{
+		for (int i = 0; i < region_count; ++i) if (m_region_totals[i] != m_zero) m_region_dirty[i] = 1;
+	}
+
+	std::vector<int> regions;
+	for (int index : m_dirty_cells)
+	{
+		GetAffectedRegions(elements, index, regions);
+		for (int region : regions) m_region_dirty[region] = 1;
+	}
+
+	// Any source which affects a dirty region must be re-propogated, and therefore also dirties every other region it
+	// affects.  Repeat until no further regions are affected
+	std::vector<unsigned char> active_sources(m_sources.size(), 0);
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+		for (std::vector<MapCell>::size_type i = 0; i < m_sources.size(); ++i)
+		{
+			if (active_sources[i] != 0) continue;
+
+			GetAffectedRegions(elements, m_sources[i].Index, regions);
+			bool affected = false;
+			for (int region : regions) if (m_region_dirty[region] != 0) { affected = true; break; }
+			if (!affected) continue;
+
+			for (int region : regions) m_region_dirty[region] = 1;
+			active_sources[i] = 1;
+			changed = true;
+		}
+	}
+
+	// Sources which do not affect any region (e.g. enclosed, non-transmissive cells) are only active if they have changed
+	unsigned int generation = NextVisitGeneration();
+	for (int index : m_dirty_cells) m_visit_stamp[index] = generation;
+	for (std::vector<MapCell>::size_type i = 0; i < m_sources.size(); ++i)
+	{
+		if (m_visit_stamp[m_sources[i].Index] == generation) active_sources[i] = 1;
+	}
+
+	// Collect every cell in each dirty region, plus any other dirty or active source cells
+	generation = NextVisitGeneration();
+	m_update_cells.clear();
+	auto add_cell = [this, generation](int index) 
+	{
+		if (m_visit_stamp[index] != generation) { m_visit_stamp[index] = generation; m_update_cells.push_back(index); }
+	};
+
+	for (int region = 0; region < region_count; ++region)
+	{
+		if (m_region_dirty[region] == 0) continue;
+		for (int i = m_region_offsets[region]; i < m_region_offsets[region + 1]; ++i) add_cell(m_region_cells[i]);
+	}
+	for (int index : m_dirty_cells) add_cell(index);
+
+	// Only sources which can affect the recalculated cells will be propogated
+	std::vector<MapCell>::size_type active_count = 0U;
+	for (std::vector<MapCell>::size_type i = 0; i < m_sources.size(); ++i)
+	{
+		if (active_sources[i] == 0) continue;
+		add_cell(m_sources[i].Index);
+		m_sources[active_count++] = m_sources[i];
+	}
+	m_sources.resize(active_count);
+
+	// Perform a full update if the entire map is affected, or skip the update entirely if nothing is affected
+	if (m_update_cells.empty()) return false;
+	m_restricted_update = (m_update_cells.size() < m_elementcount);
+	return true;
+}
+
+// Labels each connected region of transmissive cells, and marks any cells whose transmission state has changed as dirty
+template <typename T, template<typename> class TBlendMode>
+void EnvironmentMap<T, TBlendMode>::BuildConnectedRegions(const ComplexShipElement *elements)
+{
+	int count = (int)m_elementcount;
+
+	// Determine the transmission state of every cell, and compare against the state when regions were last built
+	std::vector<unsigned char> transmissive(count);
+	for (int i = 0; i < count; ++i) transmissive[i] = (IsTransmissive(elements[i]) ? 1 : 0);
+
+	if ((int)m_transmissive.size() != count)
+	{
+		MarkAllCellsDirty();
+	}
+	else
+	{
+		for (int i = 0; i < count; ++i) if (transmissive[i] != m_transmissive[i]) MarkCellDirty(i);
+	}
+	m_transmissive.swap(transmissive);
+
+	// Flood-fill each region in turn.  The cell list for each region doubles as the traversal queue
+	m_region_ids.assign(count, -1);
+	m_region_offsets.clear();
+	m_region_cells.clear();
+	for (int i = 0; i < count; ++i)
+	{
+		if (m_transmissive[i] == 0 || m_region_ids[i] != -1) continue;
+
+		int region = (int)m_region_offsets.size();
+		int start = (int)m_region_cells.size();
+		m_region_offsets.push_back(start);
+		m_region_ids[i] = region;
+		m_region_cells.push_back(i);
+
+		for (int q = start; q < (int)m_region_cells.size(); ++q)
+		{
+			const ComplexShipElement & el = elements[m_region_cells[q]];
+			for (int direction : m_stencil_directions)
+			{
+				int neighbour = el.GetNeighbour((Direction)direction);
+				if (neighbour == -1 || m_transmissive[neighbour] == 0 || m_region_ids[neighbour] != -1) continue;
+
+				m_region_ids[neighbour] = region;
+				m_region_cells.push_back(neighbour);
+			}
+		}
+	}
+
+	int region_count = (int)m_region_offsets.size();
+	m_region_offsets.push_back((int)m_region_cells.size());
+
+	// Region totals are recalculated in full, since region indices may have changed
+	m_region_totals.assign(region_count, m_zero);
+	for (int region = 0; region < region_count; ++region)
+	{
+		for (int i = m_region_offsets[region]; i < m_region_offsets[region + 1]; ++i) m_region_totals[region] += Data[m_region_cells[i]];
+	}
+
+	m_region_elements = elements;
+	m_regions_valid = true;
+}
+
+// Determines the set of connected regions which value at the given cell can propogate into
+template <typename T, template<typename> class TBlendMode>
+void EnvironmentMap<T, TBlendMode>::GetAffectedRegions(const ComplexShipElement *elements, int index, std::vector<int> & outRegions) const
+{
+	// Value can always remain in the cell's own region, and may be transmitted into the region of any neighbour
+	outRegions.clear();
+	if (m_region_ids[index] != -1) outRegions.push_back(m_region_ids[index]);
+
+	const ComplexShipElement & el = elements[index];
+	for (int direction : m_stencil_directions)
+	{
+		int neighbour = el.GetNeighbour((Direction)direction);
+		if (neighbour == -1 || m_region_ids[neighbour] == -1) continue;
+
+		int region = m_region_ids[neighbour];
+		if (std::find(outRegions.begin(), outRegions.end(), region) == outRegions.end()) outRegions.push_back(region);
+	}
+}
+
+// Recalculates the total value held in each region updated in the last cycle
+template <typename T, template<typename> class TBlendMode>
+void EnvironmentMap<T, TBlendMode>::UpdateRegionTotals(void)
+{
+	if (!m_regions_valid) return;
+
+	int region_count = GetConnectedRegionCount();
+	for (int region = 0; region < region_count; ++region)
+	{
+		if (m_restricted_update && m_region_dirty[region] == 0) continue;
+
+		T total = m_zero;
+		for (int i = m_region_offsets[region]; i < m_region_offsets[region + 1]; ++i) total += Data[m_region_cells[i]];
+		m_region_totals[region] = total;
+	}
+}
+
+// Returns a new generation value for the per-cell visit stamps, so that all cells are considered unvisited
+template <typename T, template<typename> class TBlendMode>
+unsigned int EnvironmentMap<T, TBlendMode>::NextVisitGeneration(void)
+{
+	// Reset all stamps on wraparound, or if the map has been resized
+	if (m_visit_stamp.size() != m_elementcount || ++m_visit_generation == 0U)
+	{
+		m_visit_stamp.assign(m_elementcount, 0U);
+		m_visit_generation = 1U;
+	}
+
+	return m_visit_generation;
+}
+
+// Precalculates the per-cell transmission masks used by the stencil kernel
+template <typename T, template<typename> class TBlendMode>
+void EnvironmentMap<T, TBlendMode>::BuildTransmissionMasks(const ComplexShipElement *elements)
+{
+	int count = (int)m_elementcount;
+
+	// Determine which cells are able to receive value, based on both transmission and blocking element properties
+	std::vector<unsigned char> transmissive(count);
+	for (int i = 0; i < count; ++i) transmissive[i] = (IsTransmissive(elements[i]) ? 1 : 0);
+
+	// Value can flow across a connection towards any transmissive cell, in the same way as the propagation kernel
+	m_transmission_masks.assign(count, 0U);
+	int maxdelta = 0;
+	for (int i = 0; i < count; ++i)
+	{
+		const ComplexShipElement & el = elements[i];
+		uint32_t mask = 0U;
+		for (int direction : m_stencil_directions)
+		{
+			// The stencil addresses neighbours by index delta, so only accept neighbours at the expected position
+			int neighbour = el.GetNeighbour((Direction)direction);
+			if (neighbour == -1 || neighbour != (i + m_movedelta[direction])) continue;
+
+			if (transmissive[i] != 0) mask |= InflowBit(direction);
+			if (transmissive[neighbour] != 0) mask |= OutflowBit(direction);
+		}
+		m_transmission_masks[i] = mask;
+	}
+
+	// Padding must cover the largest neighbour delta in either direction, plus a full vector beyond the last cell
+	for (int direction : m_stencil_directions) maxdelta = max(maxdelta, abs(m_movedelta[direction]));
+	m_stencil_padding = (maxdelta + 4);
+
+	m_transmission_mask_elements = elements;
+	m_transmission_masks_valid = true;
+}
+
+// Propogates source values through the map by iterating a double-buffered stencil over all map cells
+template <typename T, template<typename> class TBlendMode>
+void EnvironmentMap<T, TBlendMode>::ExecuteStencilKernel(const ComplexShipElement *elements)
+{
+	// Recalculate transmission masks if the layout has changed since they were last calculated
+	if (!m_transmission_masks_valid || elements != m_transmission_mask_elements) BuildTransmissionMasks(elements);
+
+	// Prepare the working buffers.  Padding cells are zero-initialised and are never written
+	int count = (int)m_elementcount;
+	std::vector<float>::size_type buffer_size = (std::vector<float>::size_type)(count + (2 * m_stencil_padding));
+	for (int i = 0; i < 2; ++i)
+	{
+		if (m_stencil_buffer[i].size() != buffer_size) m_stencil_buffer[i].assign(buffer_size, 0.0f);
+	}
+	m_stencil_front = 0;
+
+	float *front = &(m_stencil_buffer[0][m_stencil_padding]);
+	for (int i = 0; i < count; ++i) front[i] = (float)Data[i];
+	for (const MapCell & source : m_sources) front[source.Index] = (float)source.Value;
+
+	// Express the falloff method in each direction as (value * multiplier) + modifier
+	bool relative = m_falloff.IsRelativeFalloff();
+	for (int i = 0; i < (int)Direction::_Count; ++i)
+	{
+		m_stencil_falloff_mul[i] = (relative ? m_falloff.GetRelativeFalloffMultiplier((Direction)i) : 1.0f);
+		m_stencil_falloff_add[i] = (relative ? 0.0f : (float)m_falloff.GetAbsoluteFalloffModifier((Direction)i));
+	}
+
+	if (m_source_emission_multiplier != m_zero)
+	{
+		// Emission is removed from the source, so diffuse value between adjacent cells for a fixed number of iterations.  
+		// The exchange rate is low enough that no cell can emit more than it holds within an iteration
+		m_stencil_rate = (1.0f / (float)(m_stencil_directions.size() + 1U));
+		m_stencil_limit = ((float)m_transfer_limit / (float)m_stencil_diffusion_iterations);
+		for (unsigned int i = 0U; i < m_stencil_diffusion_iterations; ++i) ExecuteStencilIteration(true);
+	}
+	else
+	{
+		// Emission remains in the source, so spread the maximum attenuated value until the map stabilises.  No path
+		// through the map can be longer than the number of cells, so this is the upper bound on iterations
+		m_stencil_threshold = (float)m_zero_threshold;
+		for (int i = 0; i < count; ++i)
+		{
+			if (!ExecuteStencilIteration(false)) break;
+		}
+	}
+
+	// Store the final result back into the map data.  The stencil is always evaluated over the full map, but only cells
+	// within the update region are committed if this is a dirty-region update
+	const float *result = &(m_stencil_buffer[m_stencil_front][m_stencil_padding]);
+	if (m_restricted_update)
+		for (int index : m_update_cells) Data[index] = (T)result[index];
+	else
+		for (int i = 0; i < count; ++i) Data[i] = (T)result[i];
+}
+
+// Performs one stencil iteration over the full map, then swaps the front and back buffers.  Returns a flag
+// indicating whether any cell value changed
+template <typename T, template<typename> class TBlendMode>
+bool EnvironmentMap<T, TBlendMode>::ExecuteStencilIteration(bool diffusion)
+{
+	const float *src = &(m_stencil_buffer[m_stencil_front][m_stencil_padding]);
+	float *dest = &(m_stencil_buffer[1 - m_stencil_front][m_stencil_padding]);
+	int count = (int)m_elementcount;
+	bool changed;
+
+	if (m_parallel_slice_threshold != 0U && m_elementcount >= m_parallel_slice_threshold && Game::WorkerThreads.GetWorkerCount() != 0U)
+	{
+		// Each z-slice only writes to its own range of the back buffer, so slices can be evaluated concurrently
+		int slice = (m_elementsize.x * m_elementsize.y);
+		std::atomic<int> changes(0);
+		Game::WorkerThreads.ParallelFor(m_elementsize.z, 1, [this, diffusion, src, dest, slice, &changes](int z_begin, int z_end)
+		{
+			bool slice_changed = (diffusion ? StencilDiffusionRange(src, dest, z_begin * slice, z_end * slice) :
+											  StencilMaximumRange(src, dest, z_begin * slice, z_end * slice));
+			if (slice_changed) changes.fetch_add(1);
+		});
+		changed = (changes.load() != 0);
+	}
+	else
+	{
+		changed = (diffusion ? StencilDiffusionRange(src, dest, 0, count) : StencilMaximumRange(src, dest, 0, count));
+	}
+
+	m_stencil_front = (1 - m_stencil_front);
+	return changed;
+}
+
+// Evaluates the diffusion stencil over the cell range [begin, end).  Each cell exchanges a fraction of the difference
+// in value with each neighbour, subject to the transfer limit.  Value received is subject to falloff
+template <typename T, template<typename> class TBlendMode>
+bool EnvironmentMap<T, TBlendMode>::StencilDiffusionRange(const float *src, float *dest, int begin, int end) const
+{
+	const XMVECTOR zero = XMVectorZero();
+	const XMVECTOR rate = XMVectorReplicate(m_stencil_rate);
+	const XMVECTOR limit = XMVectorReplicate(m_stencil_limit);
+	const XMVECTOR neg_limit = XMVectorNegate(limit);
+
+	// Process four cells at a time.  Vectors may not span beyond the end of the range, since it may be owned by another thread
+	int i = begin;
+	for (; (i + 4) <= end; i += 4)
+	{
+		XMVECTOR cur = XMLoadFloat4((const XMFLOAT4*)&src[i]);
+		XMVECTOR masks = XMLoadInt4(&m_transmission_masks[i]);
+		XMVECTOR delta = zero;
+
+		for (int direction : m_stencil_directions)
+		{
+			XMVECTOR neighbour = XMLoadFloat4((const XMFLOAT4*)&src[i + m_movedelta[direction]]);
+			XMVECTOR flow = XMVectorClamp(XMVectorMultiply(XMVectorSubtract(neighbour, cur), rate), neg_limit, limit);
+
+			XMVECTOR gain = XMVectorMax(zero, XMVectorMultiplyAdd(XMVectorMax(flow, zero),
+				XMVectorReplicate(m_stencil_falloff_mul[direction]), XMVectorReplicate(m_stencil_falloff_add[direction])));
+			XMVECTOR loss = XMVectorMax(zero, XMVectorNegate(flow));
+
+			XMVECTOR inflow = XMVectorNotEqualInt(XMVectorAndInt(masks, XMVectorReplicateInt(InflowBit(direction))), zero);
+			XMVECTOR outflow = XMVectorNotEqualInt(XMVectorAndInt(masks, XMVectorReplicateInt(OutflowBit(direction))), zero);
+
+			delta = XMVectorAdd(delta, XMVectorSelect(zero, gain, inflow));
+			delta = XMVectorSubtract(delta, XMVectorSelect(zero, loss, outflow));
+		}
+
+		XMStoreFloat4((XMFLOAT4*)&dest[i], XMVectorAdd(cur, delta));
+	}
+
+	// Process any remaining cells individually
+	for (; i < end; ++i) dest[i] = StencilDiffusionCell(src, i);
+
+	// Diffusion runs for a fixed number of iterations, so we do not test for changes
+	return true;
+}
+
+// Evaluates the maximum-value stencil over the cell range [begin, end).  Each cell takes the maximum of its own value and 
+// the attenuated value of each neighbour that is above the zero threshold
+template <typename T, template<typename> class TBlendMode>
+bool EnvironmentMap<T, TBlendMode>::StencilMaximumRange(const float *src, float *dest, int begin, int end) const
+{
+	const XMVECTOR zero = XMVectorZero();
+	const XMVECTOR threshold = XMVectorReplicate(m_stencil_threshold);
+	bool changed = false;
+
+	// Process four cells at a time.  Vectors may not span beyond the end of the range, since it may be owned by another thread
+	int i = begin;
+	for (; (i + 4) <= end; i += 4)
+	{
+		XMVECTOR cur = XMLoadFloat4((const XMFLOAT4*)&src[i]);
+		XMVECTOR masks = XMLoadInt4(&m_transmission_masks[i]);
+		XMVECTOR best = cur;
+
+		for (int direction : m_stencil_directions)
+		{
+			XMVECTOR neighbour = XMLoadFloat4((const XMFLOAT4*)&src[i + m_movedelta[direction]]);
+			XMVECTOR value = XMVectorMultiplyAdd(neighbour, 
+				XMVectorReplicate(m_stencil_falloff_mul[direction]), XMVectorReplicate(m_stencil_falloff_add[direction]));
+
+			XMVECTOR inflow = XMVectorAndInt(
+				XMVectorNotEqualInt(XMVectorAndInt(masks, XMVectorReplicateInt(InflowBit(direction))), zero),
+				XMVectorGreater(neighbour, threshold));
+
+			best = XMVectorSelect(best, XMVectorMax(best, value), inflow);
+		}
+
+		XMStoreFloat4((XMFLOAT4*)&dest[i], best);
+		if (XMVector4NotEqual(best, cur)) changed = true;
+	}
+
+	// Process any remaining cells individually
+	for (; i < end; ++i)
+	{
+		dest[i] = StencilMaximumCell(src, i);
+		if (dest[i] != src[i]) changed = true;
+	}
+
+	return changed;
+}
+
+// Scalar evaluation of the diffusion stencil for a single cell
+template <typename T, template<typename> class TBlendMode>
+float EnvironmentMap<T, TBlendMode>::StencilDiffusionCell(const float *src, int index) const
+{
+	float cur = src[index];
+	float delta = 0.0f;
+	uint32_t mask = m_transmission_masks[index];
+
+	for (int direction : m_stencil_directions)
+	{
+		float flow = clamp((src[index + m_movedelta[direction]] - cur) * m_stencil_rate, -m_stencil_limit, m_stencil_limit);
+		if ((mask & InflowBit(direction)) != 0U) 
+			delta += max(0.0f, (max(flow, 0.0f) * m_stencil_falloff_mul[direction]) + m_stencil_falloff_add[direction]);
+		if ((mask & OutflowBit(direction)) != 0U)
+			delta -= max(0.0f, -flow);
+	}
+
+	return (cur + delta);
+}
+
+// Scalar evaluation of the maximum-value stencil for a single cell
+template <typename T, template<typename> class TBlendMode>
+float EnvironmentMap<T, TBlendMode>::StencilMaximumCell(const float *src, int index) const
+{
+	float best = src[index];
+	uint32_t mask = m_transmission_masks[index];
+
+	for (int direction : m_stencil_directions)
+	{
+		float neighbour = src[index + m_movedelta[direction]];
+		if ((mask & InflowBit(direction)) != 0U && neighbour > m_stencil_threshold)
+			best = max(best, (neighbour * m_stencil_falloff_mul[direction]) + m_stencil_falloff_add[direction]);
+	}
+
+	return best;
 }
 
 
@@ -35,6 +35,15 @@ public:
 	// Applies the falloff method to a single-cell transmission of the given source value in the specified direction
 	T														ApplyFalloff(T current_value, Direction direction);
 
+	// Indicates whether this is a relative falloff method; otherwise, the falloff is absolute
+	CMPINLINE bool											IsRelativeFalloff(void) const { return (m_falloff_type == _InternalFalloffType::_RelFalloff); }
+
+	// Returns the (non-positive) value added to a cell value by an absolute falloff in the specified direction
+	CMPINLINE T												GetAbsoluteFalloffModifier(Direction direction) const { return m_abs_falloff_dirs[(int)direction]; }
+
+	// Returns the proportion of a cell value which remains after a relative falloff in the specified direction
+	CMPINLINE float											GetRelativeFalloffMultiplier(Direction direction) const { return m_rel_falloff_dirs[(int)direction]; }
+
 
 protected:
 
@@ -206,6 +206,111 @@ TestResult EnvironmentMapTests::BasicRelativeFalloffPropogationTests()
 	return result;
 }
 
+TestResult EnvironmentMapTests::StencilKernelTests()
+{
+	TestResult result = NewResult();
+
+	// Maximum-value propogation should match the propagation kernel exactly
+	typedef EnvironmentMap<int, EnvironmentMapBlendMode::BlendMaximumValue> MaxMap;
+	INTVECTOR3 size = INTVECTOR3(7, 6, 5);
+	auto env = GenerateTestElementEnvironment(size);
+	MaxMap propagation = MaxMap(size), stencil = MaxMap(size);
+	for (MaxMap *map : { &propagation, &stencil })
+	{
+		map->SetZeroThreshold(0);
+		map->SetBlockingProperties(0U);
+		map->SetTransferProfile(MaxMap::TransferProfile::ManhattanAdjacencyTransferProfile);
+		map->SetEmissionBehaviour(MaxMap::EmissionBehaviour::EmissionRemainsInSource);
+		map->SetFalloffMethod(EnvironmentMapFalloffMethod<int>()
+			.WithAbsoluteFalloff(1)
+			.WithFalloffTransmissionType(EnvironmentMapFalloffMethod<int>::FalloffTransmissionType::Square));
+	}
+	stencil.SetExecutionKernel(MaxMap::ExecutionKernel::StencilKernel);
+
+	for (MaxMap *map : { &propagation, &stencil })
+	{
+		map->BeginUpdate()
+			.WithInitialValues(0)
+			.WithSourceCell(MaxMap::MapCell(env->GetElementIndex(INTVECTOR3(1, 2, 3)), 8))
+			.Execute(env->GetElements());
+	}
+
+	int mismatches = 0;
+	for (int i = 0; i < env->GetElementCount(); ++i) if (propagation.Data[i] != stencil.Data[i]) ++mismatches;
+	result.AssertEqual(mismatches, 0, ERR("Stencil maximum-value propogation does not match propagation kernel"));
+	result.AssertEqual(stencil.Data.at(env->GetElementIndex(INTVECTOR3(4, 2, 3))), (8 - 3), ERR("Stencil maximum-value propogation failed"));
+
+	// Diffusion with no falloff should conserve the total value in the map
+	typedef EnvironmentMap<float, EnvironmentMapBlendMode::BlendAveraged> DiffusionMap;
+	DiffusionMap diffusion = DiffusionMap(size);
+	diffusion.SetBlockingProperties(0U);
+	diffusion.SetEmissionBehaviour(DiffusionMap::EmissionBehaviour::EmissionRemovedFromSource);
+	diffusion.SetFalloffMethod(EnvironmentMapFalloffMethod<float>().WithAbsoluteFalloff(0.0f));
+	diffusion.SetExecutionKernel(DiffusionMap::ExecutionKernel::StencilKernel);
+	diffusion
+		.BeginUpdate()
+		.WithInitialValues(0.0f)
+		.WithSourceCell(DiffusionMap::MapCell(env->GetElementIndex(INTVECTOR3(3, 3, 2)), 100.0f))
+		.Execute(env->GetElements());
+
+	result.AssertTrue(fabs(diffusion.GetTotalValue() - 100.0f) < 0.01f, ERR("Stencil diffusion does not conserve value"));
+	result.AssertTrue(diffusion.Data.at(env->GetElementIndex(INTVECTOR3(4, 3, 2))) > 0.0f, ERR("Stencil diffusion failed to transfer value"));
+
+	Game::Log << LOG_INFO << (concat("\nEnvironment map stencil kernel tests:\n")(stencil.DebugStringOutput("%d"))("\n").str().c_str());
+	return result;
+}
+
+TestResult EnvironmentMapTests::DirtyRegionUpdateTests()
+{
+	TestResult result = NewResult();
+
+	// Divide the environment into two regions with a non-transmissive wall at x == 3
+	typedef EnvironmentMap<int, EnvironmentMapBlendMode::BlendMaximumValue> MaxMap;
+	INTVECTOR3 size = INTVECTOR3(7, 5, 3);
+	auto env = GenerateTestElementEnvironment(size);
+	for (int y = 0; y < size.y; ++y)
+		for (int z = 0; z < size.z; ++z)
+			env->GetElementDirect(env->GetElementIndex(INTVECTOR3(3, y, z))).ClearProperty(ComplexShipElement::PROPERTY::PROP_ACTIVE);
+
+	MaxMap map = MaxMap(size);
+	map.SetZeroThreshold(0);
+	map.SetTransmissionProperties((bitstring)ComplexShipElement::PROPERTY::PROP_ACTIVE);
+	map.SetBlockingProperties(0U);
+	map.SetTransferProfile(MaxMap::TransferProfile::ManhattanAdjacencyTransferProfile);
+	map.SetEmissionBehaviour(MaxMap::EmissionBehaviour::EmissionRemainsInSource);
+	map.SetFalloffMethod(EnvironmentMapFalloffMethod<int>()
+		.WithAbsoluteFalloff(1)
+		.WithFalloffTransmissionType(EnvironmentMapFalloffMethod<int>::FalloffTransmissionType::Square));
+
+	int left = env->GetElementIndex(INTVECTOR3(1, 2, 1)), right = env->GetElementIndex(INTVECTOR3(5, 2, 1));
+	auto update = [&](int left_value, int right_value)
+	{
+		map.BeginUpdate()
+			.WithDirtyRegionUpdate()
+			.WithInitialValues(0)
+			.WithSourceCell(MaxMap::MapCell(left, left_value))
+			.WithSourceCell(MaxMap::MapCell(right, right_value))
+			.Execute(env->GetElements());
+	};
+
+	// The first update must recalculate the entire map
+	update(10, 10);
+	result.AssertEqual((int)map.GetLastUpdateCellCount(), env->GetElementCount(), ERR("Initial dirty-region update did not recalculate all cells"));
+	result.AssertEqual(map.GetConnectedRegionCount(), 2, ERR("Incorrect number of connected regions identified"));
+
+	// No cells should be recalculated if nothing has changed
+	update(10, 10);
+	result.AssertEqual((int)map.GetLastUpdateCellCount(), 0, ERR("Dirty-region update recalculated cells with no changes"));
+
+	// Only the region containing a modified source should be recalculated
+	update(10, 6);
+	result.AssertEqual((int)map.GetLastUpdateCellCount(), (3 * size.y * size.z), ERR("Dirty-region update did not restrict recalculation to the affected region"));
+	result.AssertEqual(map.Data.at(env->GetElementIndex(INTVECTOR3(6, 2, 1))), (6 - 1), ERR("Affected region not correctly recalculated"));
+	result.AssertEqual(map.Data.at(env->GetElementIndex(INTVECTOR3(0, 2, 1))), (10 - 1), ERR("Unaffected region was not preserved"));
+
+	return result;
+}
+
 std::unique_ptr<ComplexShip> EnvironmentMapTests::GenerateTestElementEnvironment(const INTVECTOR3 & size)
 {
 	ComplexShipSection *sec = new ComplexShipSection();
@@ -18,6 +18,8 @@ public:
 		result += BasicMultiplicativePropogationTests();
 		result += BasicAveragedPropogationTests();
 		result += BasicRelativeFalloffPropogationTests();
+		result += StencilKernelTests();
+		result += DirtyRegionUpdateTests();
 
 		return result;
 	}
@@ -34,6 +36,9 @@ private:
 	TestResult BasicAveragedPropogationTests();
 	TestResult BasicRelativeFalloffPropogationTests();
 
+	TestResult StencilKernelTests();
+	TestResult DirtyRegionUpdateTests();
+
 
 	std::unique_ptr<ComplexShip> GenerateTestElementEnvironment(const INTVECTOR3 & size);
 
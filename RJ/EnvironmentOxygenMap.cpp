@@ -64,13 +64,17 @@ bool EnvironmentOxygenMap::RevalidateMap(void)
 		// Make sure there is no oxygen in any elements which cannot transmit it, or which actively block it
 		const ComplexShipElement & el = env->GetElementDirect(i);
 		bitstring element_properties = el.GetProperties();
-		if (CheckBit_Any(element_properties, transmission_properties) == false ||
-			CheckBit_Any(element_properties, blocking_properties) == true)
+		if ((CheckBit_Any(element_properties, transmission_properties) == false ||
+			 CheckBit_Any(element_properties, blocking_properties) == true) && m_map.GetCellValue(i) != (Oxygen::Type)0.0f)
 		{
 			m_map.SetCellValue(i, (Oxygen::Type)0.0f);
 		}
 	}
 
+	// Element properties may have changed, so any precalculated transmission data must be recalculated.  Regions
+	// affected by any change will be recalculated in the next update
+	m_map.InvalidateTransmissionData();
+
 	// Return success
 	return true;
 }
@@ -94,9 +98,13 @@ void EnvironmentOxygenMap::Update(float timedelta)
 		.WithAbsoluteFalloff(Oxygen::BASE_OXYGEN_FALLOFF * timedelta)
 		.WithFalloffTransmissionType(EnvironmentMapFalloffMethod<Oxygen::Type>::FalloffTransmissionType::Distance));
 	
-	// Execute the map update	
+	// Execute the map update.  Only regions which contain oxygen, or which have been affected by changes since the 
+	// last update, need to be recalculated; all other regions remain empty
+	m_map.SetExecutionKernel(Oxygen::USE_STENCIL_KERNEL ? OxygenMap::ExecutionKernel::StencilKernel : OxygenMap::ExecutionKernel::PropagationKernel);
 	m_map
 		.BeginUpdate()
+		.WithDirtyRegionUpdate()
+		.WithNonZeroRegionsUpdated()
 		.WithPreserveExistingData()
 		.WithAdditiveModifierToExistingData(-consumption * timedelta)
 		.WithTransferLimit(Oxygen::BASE_TRANSMISSION_LIMIT * timedelta)
@@ -104,9 +112,12 @@ void EnvironmentOxygenMap::Update(float timedelta)
 		.Execute(env->GetElements());
 
 
-	// Directly apply the effect of any hull breaches
+	// Directly apply the effect of any hull breaches.  These cells will be marked as dirty for the next update
 	for (const EnvironmentHullBreach & breach : env->HullBreaches.Items())
-		m_map.SetCellValue(breach.GetElementIndex(), (Oxygen::Type)0.0f);
+	{
+		if (m_map.GetCellValue(breach.GetElementIndex()) != (Oxygen::Type)0.0f)
+			m_map.SetCellValue(breach.GetElementIndex(), (Oxygen::Type)0.0f);
+	}
 }
 
 
@@ -57,10 +57,17 @@ void EnvironmentPowerMap::DeterminePowerSources(std::vector<PowerMap::MapCell> &
 // false if the environment has changed too significantly and requires a full map rebuild
 bool EnvironmentPowerMap::RevalidateMap(void)
 {
-	// Power map does not maintain state between updates.  As a result, there is no benefit in perfoming an 
-	// incremental rebuild.  Simply return false so that a full build is performed, at which point the full 
-	// power state will be recalculated
-	return false;
+	// We can only revalidate if we have an environment, and if it has not changed in size
+	const iSpaceObjectEnvironment *env = m_environment();
+	if (!env) return false;
+	if (env->GetElementSize() != m_map.GetMapSize()) return false;
+
+	// Element properties may have changed, so any precalculated transmission data must be recalculated.  Only regions
+	// affected by any change will be recalculated in the next update
+	m_map.InvalidateTransmissionData();
+
+	// Return success
+	return true;
 }
 
 // Performs an update of the power map for the specified time interval
@@ -76,9 +83,12 @@ void EnvironmentPowerMap::Update(float timedelta)
 	std::vector<PowerMap::MapCell> sources;
 	DeterminePowerSources(sources);
 
-	// Execute the map update	
+	// Execute the map update.  Power levels are fully determined by the current sources and layout, so only regions
+	// affected by a change in either need to be recalculated
+	m_map.SetExecutionKernel(Power::USE_STENCIL_KERNEL ? PowerMap::ExecutionKernel::StencilKernel : PowerMap::ExecutionKernel::PropagationKernel);
 	m_map
 		.BeginUpdate()
+		.WithDirtyRegionUpdate()
 		.WithInitialValues((Power::Type)0)
 		.WithSourceCells(sources)
 		.Execute(env->GetElements());
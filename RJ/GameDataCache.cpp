@@ -0,0 +1,492 @@
+#include <fstream>
+#include <filesystem>
+#include <system_error>
+#include <cstring>
+#include "Logging.h"
+#include "GameDataCache.h"
+
+
+// Identifier written at the start of the cache file
+const char GameDataCache::FILE_IDENTIFIER[8] = { 'R', 'J', 'G', 'D', 'C', 'A', 'C', 'H' };
+
+
+// Bounds-checked reader over serialised data.  Any attempt to read beyond the end of the data will set the failure flag
+// and return zero values, so that callers only need to check the flag at convenient points
+class GameDataCache::DataReader
+{
+public:
+
+	DataReader(const char *data, size_t size) : m_data(data), m_size(size), m_pos(0U), m_failed(false) { }
+
+	CMPINLINE bool		Failed(void) const		{ return m_failed; }
+	CMPINLINE bool		AtEnd(void) const		{ return (m_pos == m_size); }
+
+	template <typename T>
+	T Read(void)
+	{
+		T value = T();
+		if (m_failed || (m_size - m_pos) < sizeof(T)) { m_failed = true; return value; }
+
+		memcpy(&value, m_data + m_pos, sizeof(T));
+		m_pos += sizeof(T);
+		return value;
+	}
+
+	const char * ReadBytes(size_t count)
+	{
+		if (m_failed || (m_size - m_pos) < count) { m_failed = true; return NULL; }
+
+		const char *ptr = (m_data + m_pos);
+		m_pos += count;
+		return ptr;
+	}
+
+private:
+
+	const char *		m_data;
+	size_t				m_size;
+	size_t				m_pos;
+	bool				m_failed;
+};
+
+// Appends a value to the end of a serialised data buffer
+template <typename T>
+static void AppendValue(std::vector<char> & data, const T & value)
+{
+	const char *ptr = reinterpret_cast<const char*>(&value);
+	data.insert(data.end(), ptr, ptr + sizeof(T));
+}
+
+
+// Constructor
+GameDataCache::GameDataCache(void)
+	:
+	m_enabled(false),
+	m_modified(false),
+	m_hits(0U),
+	m_misses(0U),
+	m_hashed(0U)
+{
+}
+
+// Enables the cache and loads any existing entries from the given cache file.  A missing or invalid cache file is not
+// an error; the cache will simply be regenerated as data files are loaded.  Returns the number of entries loaded
+unsigned int GameDataCache::Load(const std::string & cache_file)
+{
+	Clear();
+	m_enabled = true;
+	m_filename = cache_file;
+
+	std::vector<char> data;
+	if (!ReadFileContents(cache_file, data))
+	{
+		Game::Log << LOG_INFO << "No game data cache available, cache will be generated during data load\n";
+		return 0U;
+	}
+
+	DataReader reader(data.data(), data.size());
+	const char *identifier = reader.ReadBytes(sizeof(FILE_IDENTIFIER));
+	uint32_t version = reader.Read<uint32_t>();
+	uint32_t entry_count = reader.Read<uint32_t>();
+
+	if (reader.Failed() || memcmp(identifier, FILE_IDENTIFIER, sizeof(FILE_IDENTIFIER)) != 0 || version != CURRENT_VERSION)
+	{
+		Game::Log << LOG_WARN << "Game data cache \"" << cache_file << "\" is invalid or out of date, cache will be regenerated\n";
+		m_modified = true;
+		return 0U;
+	}
+
+	for (uint32_t i = 0U; i < entry_count; ++i)
+	{
+		uint32_t path_length = reader.Read<uint32_t>();
+		const char *path = reader.ReadBytes(path_length);
+		uint64_t source_size = reader.Read<uint64_t>();
+		uint64_t source_modified = reader.Read<uint64_t>();
+		uint64_t source_hash = reader.Read<uint64_t>();
+		uint32_t data_size = reader.Read<uint32_t>();
+		const char *entry_data = reader.ReadBytes(data_size);
+
+		if (reader.Failed())
+		{
+			Game::Log << LOG_WARN << "Game data cache \"" << cache_file << "\" is truncated, cache will be regenerated\n";
+			m_entries.clear();
+			m_modified = true;
+			return 0U;
+		}
+
+		CacheEntry & entry = m_entries[std::string(path, path_length)];
+		entry.SourceSize = source_size;
+		entry.SourceModified = source_modified;
+		entry.SourceHash = source_hash;
+		entry.Data.assign(entry_data, entry_data + data_size);
+	}
+
+	Game::Log << LOG_INFO << "Loaded game data cache with " << m_entries.size() << " entries\n";
+	return (unsigned int)m_entries.size();
+}
+
+// Writes the cache back to disk if any entries have changed.  Only entries used since the cache was loaded are
+// retained, so that data for files which have been removed or renamed does not accumulate.  Returns success flag
+bool GameDataCache::Save(void)
+{
+	if (!m_enabled) return false;
+
+	// Any unused entries are also a modification, since they will be dropped from the cache
+	unsigned int used = 0U;
+	for (const auto & entry : m_entries) if (entry.second.Used) ++used;
+	if (!m_modified && used == m_entries.size()) return true;
+
+	std::ofstream file(m_filename, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		Game::Log << LOG_WARN << "Could not write game data cache \"" << m_filename << "\"\n";
+		return false;
+	}
+
+	std::vector<char> data;
+	data.insert(data.end(), FILE_IDENTIFIER, FILE_IDENTIFIER + sizeof(FILE_IDENTIFIER));
+	AppendValue(data, (uint32_t)CURRENT_VERSION);
+	AppendValue(data, (uint32_t)used);
+
+	for (const auto & entry : m_entries)
+	{
+		if (!entry.second.Used) continue;
+
+		AppendValue(data, (uint32_t)entry.first.size());
+		data.insert(data.end(), entry.first.begin(), entry.first.end());
+		AppendValue(data, entry.second.SourceSize);
+		AppendValue(data, entry.second.SourceModified);
+		AppendValue(data, entry.second.SourceHash);
+		AppendValue(data, (uint32_t)entry.second.Data.size());
+		data.insert(data.end(), entry.second.Data.begin(), entry.second.Data.end());
+	}
+
+	file.write(data.data(), data.size());
+	if (!file.good())
+	{
+		Game::Log << LOG_WARN << "Failed while writing game data cache \"" << m_filename << "\"\n";
+		return false;
+	}
+
+	Game::Log << LOG_INFO << "Game data cache saved with " << used << " entries (" << data.size() << " bytes)\n";
+	m_modified = false;
+	return true;
+}
+
+// Disables the cache and releases all entries
+void GameDataCache::Clear(void)
+{
+	m_enabled = false;
+	m_modified = false;
+	m_filename.clear();
+	m_entries.clear();
+	m_hits = m_misses = m_hashed = 0U;
+}
+
+// Loads the given XML data file, from the cache if possible and otherwise by parsing the source file.  Returns a
+// document which is owned by the caller, or NULL if the file could not be loaded.  May be called concurrently for
+// different files; the entry map is only accessed under lock, and reading or parsing is performed outside of it
+TiXmlDocument * GameDataCache::LoadDocument(const std::string & filename)
+{
+	uint64_t source_size, source_modified;
+	if (m_enabled && GetFileStamp(filename, source_size, source_modified))
+	{
+		// Entries are node-based, so the entry data remains valid outside the lock while other entries are added.  If the
+		// size and modification time of the source match the entry then it is used without reading the source at all
+		const std::vector<char> *cached = NULL;
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			auto it = m_entries.find(filename);
+			if (it != m_entries.end() && it->second.SourceSize == source_size && it->second.SourceModified == source_modified)
+				cached = &(it->second.Data);
+		}
+
+		// Otherwise the source is read and hashed.  Where only the modification time has changed, e.g. following a checkout
+		// which restores identical contents, the entry is still valid and only its size and modification time are updated
+		uint64_t source_hash = 0U;
+		bool hashed = false;
+		if (!cached)
+		{
+			std::vector<char> source;
+			if (ReadFileContents(filename, source))
+			{
+				source_hash = HashData(source.data(), source.size());
+				hashed = true;
+
+				std::lock_guard<std::mutex> lock(m_lock);
+				++m_hashed;
+
+				auto it = m_entries.find(filename);
+				if (it != m_entries.end() && it->second.SourceHash == source_hash)
+				{
+					it->second.SourceSize = source_size;
+					it->second.SourceModified = source_modified;
+					cached = &(it->second.Data);
+					m_modified = true;
+				}
+			}
+		}
+
+		if (cached)
+		{
+			TiXmlDocument *doc = DeserialiseDocument(filename, *cached);
+
+			std::lock_guard<std::mutex> lock(m_lock);
+			if (doc)
+			{
+				m_entries[filename].Used = true;
+				++m_hits;
+				return doc;
+			}
+
+			// Fall back to parsing the source and regenerating this entry if the cached data is invalid
+			Game::Log << LOG_WARN << "Game data cache entry for \"" << filename << "\" is invalid, regenerating\n";
+		}
+
+		TiXmlDocument *doc = new TiXmlDocument(filename.c_str());
+		if (!doc->LoadFile())
+		{
+			delete doc; return NULL;
+		}
+
+		// The regenerated entry requires a hash of the source, if it was not already read above
+		if (!hashed)
+		{
+			std::vector<char> source;
+			if (!ReadFileContents(filename, source)) return doc;
+			source_hash = HashData(source.data(), source.size());
+		}
+
+		std::vector<char> data;
+		SerialiseDocument(doc, data);
+
+		std::lock_guard<std::mutex> lock(m_lock);
+		CacheEntry & entry = m_entries[filename];
+		entry.SourceSize = source_size;
+		entry.SourceModified = source_modified;
+		entry.SourceHash = source_hash;
+		entry.Data = std::move(data);
+		entry.Used = true;
+
+		m_modified = true;
+		++m_misses;
+		return doc;
+	}
+
+	// Otherwise load and parse the file directly
+	TiXmlDocument *doc = new TiXmlDocument(filename.c_str());
+	if (doc->LoadFile())
+		return doc;
+	else {
+		delete doc; return NULL;
+	}
+}
+
+// Retrieves the size and modification time of a file without reading it.  Returns success flag
+bool GameDataCache::GetFileStamp(const std::string & filename, uint64_t & outSize, uint64_t & outModified)
+{
+	std::error_code error;
+	std::filesystem::path path(filename);
+
+	uintmax_t size = std::filesystem::file_size(path, error);
+	if (error) return false;
+
+	std::filesystem::file_time_type modified = std::filesystem::last_write_time(path, error);
+	if (error) return false;
+
+	outSize = (uint64_t)size;
+	outModified = (uint64_t)modified.time_since_epoch().count();
+	return true;
+}
+
+// Reads the full contents of a file into the given buffer.  Returns success flag
+bool GameDataCache::ReadFileContents(const std::string & filename, std::vector<char> & outData)
+{
+	std::ifstream file(filename, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!file.is_open()) return false;
+
+	std::streamoff size = file.tellg();
+	if (size < 0) return false;
+
+	outData.resize((size_t)size);
+	file.seekg(0, std::ios::beg);
+	if (size > 0) file.read(outData.data(), size);
+
+	return file.good();
+}
+
+// 64-bit FNV-1a hash of the given data
+uint64_t GameDataCache::HashData(const char *data, size_t size)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0U; i < size; ++i)
+	{
+		hash ^= (uint8_t)data[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+// Serialises the element tree of a document.  Strings are pooled in a table preceding the node data
+void GameDataCache::SerialiseDocument(const TiXmlDocument *doc, std::vector<char> & outData)
+{
+	std::unordered_map<std::string, uint32_t> strings;
+	std::vector<const std::string*> string_order;
+	std::vector<char> nodes;
+
+	// Top-level nodes are stored as a count followed by each node in turn; only elements are expected at this level
+	uint32_t root_count = 0U;
+	for (const TiXmlNode *child = doc->FirstChild(); child; child = child->NextSibling())
+	{
+		if (child->Type() == TiXmlNode::ELEMENT) ++root_count;
+	}
+
+	AppendValue(nodes, root_count);
+	for (const TiXmlNode *child = doc->FirstChild(); child; child = child->NextSibling())
+	{
+		if (child->Type() == TiXmlNode::ELEMENT) SerialiseNode(child, strings, string_order, nodes);
+	}
+
+	// String table, followed by the node data which references it
+	outData.clear();
+	AppendValue(outData, (uint32_t)string_order.size());
+	for (const std::string *str : string_order)
+	{
+		AppendValue(outData, (uint32_t)str->size());
+		outData.insert(outData.end(), str->begin(), str->end());
+	}
+
+	outData.insert(outData.end(), nodes.begin(), nodes.end());
+}
+
+void GameDataCache::SerialiseNode(const TiXmlNode *node, std::unordered_map<std::string, uint32_t> & strings,
+								  std::vector<const std::string*> & string_order, std::vector<char> & nodes)
+{
+	// Returns the index of a string in the string table, adding it if required
+	auto string_index = [&strings, &string_order](const char *str) -> uint32_t
+	{
+		auto result = strings.insert(std::make_pair(std::string(str ? str : ""), (uint32_t)string_order.size()));
+		if (result.second) string_order.push_back(&(result.first->first));
+		return result.first->second;
+	};
+
+	if (node->Type() == TiXmlNode::TEXT)
+	{
+		AppendValue(nodes, NodeTag::Text);
+		AppendValue(nodes, string_index(node->Value()));
+		AppendValue(nodes, (uint8_t)(node->ToText()->CDATA() ? 1U : 0U));
+		return;
+	}
+
+	const TiXmlElement *element = node->ToElement();
+	AppendValue(nodes, NodeTag::Element);
+	AppendValue(nodes, string_index(element->Value()));
+
+	uint32_t attribute_count = 0U;
+	for (const TiXmlAttribute *attr = element->FirstAttribute(); attr; attr = attr->Next()) ++attribute_count;
+
+	AppendValue(nodes, attribute_count);
+	for (const TiXmlAttribute *attr = element->FirstAttribute(); attr; attr = attr->Next())
+	{
+		AppendValue(nodes, string_index(attr->Name()));
+		AppendValue(nodes, string_index(attr->Value()));
+	}
+
+	// Only element and text children are retained
+	uint32_t child_count = 0U;
+	for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+	{
+		if (child->Type() == TiXmlNode::ELEMENT || child->Type() == TiXmlNode::TEXT) ++child_count;
+	}
+
+	AppendValue(nodes, child_count);
+	for (const TiXmlNode *child = element->FirstChild(); child; child = child->NextSibling())
+	{
+		if (child->Type() == TiXmlNode::ELEMENT || child->Type() == TiXmlNode::TEXT) SerialiseNode(child, strings, string_order, nodes);
+	}
+}
+
+// Rebuilds a document from serialised data.  Returns NULL if the data is invalid
+TiXmlDocument * GameDataCache::DeserialiseDocument(const std::string & filename, const std::vector<char> & data)
+{
+	DataReader reader(data.data(), data.size());
+
+	// Read the string table.  Strings are copied into null-terminated storage for use by the TinyXML API
+	uint32_t string_count = reader.Read<uint32_t>();
+	if (reader.Failed() || string_count > data.size()) return NULL;
+
+	std::vector<std::string> string_data(string_count);
+	std::vector<const char*> strings(string_count);
+	for (uint32_t i = 0U; i < string_count; ++i)
+	{
+		uint32_t length = reader.Read<uint32_t>();
+		const char *str = reader.ReadBytes(length);
+		if (reader.Failed()) return NULL;
+
+		string_data[i].assign(str, length);
+		strings[i] = string_data[i].c_str();
+	}
+
+	uint32_t root_count = reader.Read<uint32_t>();
+	if (reader.Failed()) return NULL;
+
+	TiXmlDocument *doc = new TiXmlDocument(filename.c_str());
+	for (uint32_t i = 0U; i < root_count; ++i)
+	{
+		TiXmlNode *node = DeserialiseNode(reader, strings, 0U);
+		if (!node) { delete doc; return NULL; }
+
+		doc->LinkEndChild(node);
+	}
+
+	// All data should have been consumed
+	if (!reader.AtEnd()) { delete doc; return NULL; }
+
+	return doc;
+}
+
+TiXmlNode * GameDataCache::DeserialiseNode(DataReader & reader, const std::vector<const char*> & strings, unsigned int depth)
+{
+	if (depth > MAX_ELEMENT_DEPTH) return NULL;
+
+	NodeTag tag = reader.Read<NodeTag>();
+	uint32_t value = reader.Read<uint32_t>();
+	if (reader.Failed() || value >= strings.size()) return NULL;
+
+	if (tag == NodeTag::Text)
+	{
+		uint8_t cdata = reader.Read<uint8_t>();
+		if (reader.Failed()) return NULL;
+
+		TiXmlText *text = new TiXmlText(strings[value]);
+		text->SetCDATA(cdata != 0U);
+		return text;
+	}
+	else if (tag != NodeTag::Element) return NULL;
+
+	TiXmlElement *element = new TiXmlElement(strings[value]);
+
+	uint32_t attribute_count = reader.Read<uint32_t>();
+	for (uint32_t i = 0U; i < attribute_count && !reader.Failed(); ++i)
+	{
+		uint32_t name = reader.Read<uint32_t>();
+		uint32_t attr_value = reader.Read<uint32_t>();
+		if (reader.Failed() || name >= strings.size() || attr_value >= strings.size()) { delete element; return NULL; }
+
+		element->SetAttribute(strings[name], strings[attr_value]);
+	}
+
+	uint32_t child_count = reader.Read<uint32_t>();
+	if (reader.Failed()) { delete element; return NULL; }
+
+	for (uint32_t i = 0U; i < child_count; ++i)
+	{
+		TiXmlNode *child = DeserialiseNode(reader, strings, depth + 1U);
+		if (!child) { delete element; return NULL; }
+
+		element->LinkEndChild(child);
+	}
+
+	return element;
+}
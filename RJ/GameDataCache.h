@@ -0,0 +1,114 @@
+#pragma once
+
+#ifndef __GameDataCacheH__
+#define __GameDataCacheH__
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <stdint.h>
+#include "CompilerSettings.h"
+#include "XML\\tinyxml.h"
+
+
+// Binary cache of the parsed game data XML.  Each data file is stored as a compact pre-parsed element tree, keyed by the size
+// and modification time of the source file and by a hash of its contents.  Where the size and modification time are unchanged
+// the document is rebuilt directly from the cached tree without reading the source at all.  Otherwise the source is read and
+// hashed; if the contents are unchanged the entry is still used, and if not the file is parsed as normal and the cache entry
+// regenerated.  Comments, declarations and any other non-data nodes are not retained.  Only the XML tree is cached, not the
+// definition objects built from it; the Load* functions operate on the resulting document exactly as if it had been parsed
+// from the source XML
+class GameDataCache
+{
+public:
+
+	// Identifier and version written at the start of the cache file.  Any mismatch will invalidate the whole cache
+	static const char								FILE_IDENTIFIER[8];
+	static const uint32_t							CURRENT_VERSION = 2U;
+
+	// Maximum depth of element nesting that will be read from a cache entry, as a guard against corrupt data
+	static const unsigned int						MAX_ELEMENT_DEPTH = 256U;
+
+	// Constructor
+	GameDataCache(void);
+
+	// Enables the cache and loads any existing entries from the given cache file.  A missing or invalid cache file is not
+	// an error; the cache will simply be regenerated as data files are loaded.  Returns the number of entries loaded
+	unsigned int									Load(const std::string & cache_file);
+
+	// Writes the cache back to disk if any entries have changed.  Only entries used since the cache was loaded are
+	// retained, so that data for files which have been removed or renamed does not accumulate.  Returns success flag
+	bool											Save(void);
+
+	// Disables the cache and releases all entries
+	void											Clear(void);
+
+	// Indicates whether the cache is enabled.  If not, documents are always parsed directly from the source XML
+	CMPINLINE bool									IsEnabled(void) const		{ return m_enabled; }
+
+	// Loads the given XML data file, from the cache if possible and otherwise by parsing the source file.  Returns a
+	// document which is owned by the caller, or NULL if the file could not be loaded.  Safe to call concurrently for
+	// different files, although the cache must not be loaded, saved or cleared at the same time
+	TiXmlDocument *									LoadDocument(const std::string & filename);
+
+	// Cache statistics since the cache was loaded.  The hash count is the number of source files which had to be read and
+	// hashed, i.e. those whose size or modification time did not match a cache entry
+	CMPINLINE unsigned int							GetEntryCount(void) const	{ return (unsigned int)m_entries.size(); }
+	CMPINLINE unsigned int							GetHitCount(void) const		{ return m_hits; }
+	CMPINLINE unsigned int							GetMissCount(void) const	{ return m_misses; }
+	CMPINLINE unsigned int							GetHashCount(void) const	{ return m_hashed; }
+
+private:
+
+	// Cached tree for a single source file
+	struct CacheEntry
+	{
+		uint64_t									SourceSize;			// Size of the source file
+		uint64_t									SourceModified;		// Modification time of the source file
+		uint64_t									SourceHash;			// Hash of the source file contents
+		std::vector<char>							Data;				// Serialised element tree
+		bool										Used;				// Flag indicating the entry was requested since load
+
+		CacheEntry(void) : SourceSize(0U), SourceModified(0U), SourceHash(0U), Used(false) { }
+	};
+
+	// Node types within the serialised tree
+	enum class NodeTag : uint8_t { Element = 1, Text = 2 };
+
+	// Retrieves the size and modification time of a file without reading it.  Returns success flag
+	static bool										GetFileStamp(const std::string & filename, uint64_t & outSize, uint64_t & outModified);
+
+	// Reads the full contents of a file into the given buffer.  Returns success flag
+	static bool										ReadFileContents(const std::string & filename, std::vector<char> & outData);
+
+	// 64-bit FNV-1a hash of the given data
+	static uint64_t									HashData(const char *data, size_t size);
+
+	// Serialises the element tree of a document.  Strings are pooled in a table preceding the node data
+	static void										SerialiseDocument(const TiXmlDocument *doc, std::vector<char> & outData);
+	static void										SerialiseNode(const TiXmlNode *node, std::unordered_map<std::string, uint32_t> & strings,
+																  std::vector<const std::string*> & string_order, std::vector<char> & nodes);
+
+	// Rebuilds a document from serialised data.  Returns NULL if the data is invalid
+	static TiXmlDocument *							DeserialiseDocument(const std::string & filename, const std::vector<char> & data);
+
+	// Bounds-checked reader over serialised data
+	class DataReader;
+	static TiXmlNode *								DeserialiseNode(DataReader & reader, const std::vector<const char*> & strings, unsigned int depth);
+
+private:
+
+	bool											m_enabled;
+	bool											m_modified;
+	std::string										m_filename;
+	std::unordered_map<std::string, CacheEntry>		m_entries;
+	std::mutex										m_lock;
+
+	unsigned int									m_hits;
+	unsigned int									m_misses;
+	unsigned int									m_hashed;
+};
+
+
+#endif
@@ -0,0 +1,275 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <filesystem>
+#include <chrono>
+#include <system_error>
+#include "XML\\tinyxml.h"
+#include "GameDataCache.h"
+
+#include "GameDataCacheTests.h"
+
+const std::string GameDataCacheTests::SOURCE_FILE = "GameDataCacheTests.xml";
+const std::string GameDataCacheTests::CACHE_FILE = "GameDataCacheTests.cache";
+
+// Includes a declaration and comments, which are not retained by the cache, alongside nested elements, repeated
+// attribute values, entity-encoded text and CDATA
+const std::string GameDataCacheTests::SOURCE_DATA =
+	"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+	"<!-- Test data -->\n"
+	"<GameData>\n"
+	"  <ShipDetails code=\"test_ship\" class=\"Simple\">\n"
+	"    <Name>Test &amp; ship</Name>\n"
+	"    <Mass>1500.5</Mass>\n"
+	"    <!-- Inline comment -->\n"
+	"    <Hardpoint code=\"hp1\" type=\"Turret\" pos=\"0.0, 1.5, -2.0\" />\n"
+	"    <Hardpoint code=\"hp2\" type=\"Turret\" pos=\"0.0, 1.5, 2.0\" />\n"
+	"    <Script><![CDATA[if (a < b) { return; }]]></Script>\n"
+	"  </ShipDetails>\n"
+	"  <Empty />\n"
+	"</GameData>\n";
+
+
+TestResult GameDataCacheTests::CachedRoundTripTests()
+{
+	TestResult result = NewResult();
+	std::remove(CACHE_FILE.c_str());
+	result.AssertTrue(WriteTestFile(SOURCE_FILE, SOURCE_DATA), ERR("Could not write test source data"));
+
+	TiXmlDocument source(SOURCE_FILE.c_str());
+	result.AssertTrue(source.LoadFile(), ERR("Could not parse test source data"));
+
+	// First load should parse the source and generate a cache entry
+	{
+		GameDataCache cache;
+		result.AssertEqual(cache.Load(CACHE_FILE), 0U, ERR("Entries loaded from a cache file which does not exist"));
+
+		TiXmlDocument *doc = cache.LoadDocument(SOURCE_FILE);
+		result.AssertTrue(doc != NULL, ERR("Document could not be loaded through uncached path"));
+		result.AssertEqual(cache.GetMissCount(), 1U, ERR("Uncached load was not recorded as a cache miss"));
+		if (doc) result.AssertTrue(ElementTreesMatch(&source, doc), ERR("Document loaded through uncached path does not match source"));
+		delete doc;
+
+		result.AssertTrue(cache.Save(), ERR("Cache could not be saved"));
+	}
+
+	// Subsequent loads should build an identical tree from the cache without parsing the source
+	{
+		GameDataCache cache;
+		result.AssertEqual(cache.Load(CACHE_FILE), 1U, ERR("Cache entry was not persisted"));
+
+		TiXmlDocument *doc = cache.LoadDocument(SOURCE_FILE);
+		result.AssertTrue(doc != NULL, ERR("Document could not be loaded through cached path"));
+		result.AssertEqual(cache.GetHitCount(), 1U, ERR("Cached load was not recorded as a cache hit"));
+		result.AssertEqual(cache.GetMissCount(), 0U, ERR("Cached load was recorded as a cache miss"));
+		if (doc) result.AssertTrue(ElementTreesMatch(&source, doc), ERR("Document loaded through cached path does not match source"));
+
+		// Text should also be restored in its original form, e.g. so that it is written back out identically
+		const TiXmlElement *script = (doc ? TiXmlHandle(doc).FirstChildElement("GameData").FirstChildElement("ShipDetails").FirstChildElement("Script").ToElement() : NULL);
+		result.AssertTrue(script && script->FirstChild() && script->FirstChild()->ToText() && script->FirstChild()->ToText()->CDATA(),
+			ERR("CDATA section was not preserved through cached path"));
+		delete doc;
+	}
+
+	std::remove(SOURCE_FILE.c_str());
+	std::remove(CACHE_FILE.c_str());
+	return result;
+}
+
+TestResult GameDataCacheTests::SourceChangeInvalidationTests()
+{
+	TestResult result = NewResult();
+	std::remove(CACHE_FILE.c_str());
+	result.AssertTrue(WriteTestFile(SOURCE_FILE, SOURCE_DATA), ERR("Could not write test source data"));
+
+	{
+		GameDataCache cache;
+		cache.Load(CACHE_FILE);
+		delete cache.LoadDocument(SOURCE_FILE);
+		cache.Save();
+	}
+
+	// Modify a single attribute value in the source.  The cache entry should be invalidated and the new data loaded
+	std::string modified = SOURCE_DATA;
+	modified.replace(modified.find("1500.5"), 6U, "2500.5");
+	result.AssertTrue(WriteTestFile(SOURCE_FILE, modified), ERR("Could not write modified test source data"));
+	result.AssertTrue(AdvanceModifiedTime(SOURCE_FILE), ERR("Could not update modification time of test source data"));
+
+	TiXmlDocument source(SOURCE_FILE.c_str());
+	result.AssertTrue(source.LoadFile(), ERR("Could not parse modified test source data"));
+	{
+		GameDataCache cache;
+		cache.Load(CACHE_FILE);
+
+		TiXmlDocument *doc = cache.LoadDocument(SOURCE_FILE);
+		result.AssertTrue(doc != NULL, ERR("Modified document could not be loaded"));
+		result.AssertEqual(cache.GetHitCount(), 0U, ERR("Stale cache entry was used following a change to the source"));
+		result.AssertEqual(cache.GetMissCount(), 1U, ERR("Change to the source was not recorded as a cache miss"));
+		if (doc) result.AssertTrue(ElementTreesMatch(&source, doc), ERR("Document loaded following a change to the source does not match the new source"));
+		delete doc;
+
+		cache.Save();
+	}
+
+	// The regenerated entry should then be used for the modified source
+	{
+		GameDataCache cache;
+		cache.Load(CACHE_FILE);
+
+		TiXmlDocument *doc = cache.LoadDocument(SOURCE_FILE);
+		result.AssertEqual(cache.GetHitCount(), 1U, ERR("Regenerated cache entry was not used"));
+		if (doc) result.AssertTrue(ElementTreesMatch(&source, doc), ERR("Regenerated cache entry does not match the new source"));
+		delete doc;
+	}
+
+	std::remove(SOURCE_FILE.c_str());
+	std::remove(CACHE_FILE.c_str());
+	return result;
+}
+
+TestResult GameDataCacheTests::SourceTimestampTests()
+{
+	TestResult result = NewResult();
+	std::remove(CACHE_FILE.c_str());
+	result.AssertTrue(WriteTestFile(SOURCE_FILE, SOURCE_DATA), ERR("Could not write test source data"));
+
+	{
+		GameDataCache cache;
+		cache.Load(CACHE_FILE);
+		delete cache.LoadDocument(SOURCE_FILE);
+		result.AssertEqual(cache.GetHashCount(), 1U, ERR("Source was not hashed when generating a new cache entry"));
+		cache.Save();
+	}
+
+	// An unchanged source should be loaded from the cache based on its size and modification time alone
+	{
+		GameDataCache cache;
+		cache.Load(CACHE_FILE);
+
+		delete cache.LoadDocument(SOURCE_FILE);
+		result.AssertEqual(cache.GetHitCount(), 1U, ERR("Unchanged source was not loaded from the cache"));
+		result.AssertEqual(cache.GetHashCount(), 0U, ERR("Unchanged source was read and hashed despite matching size and modification time"));
+	}
+
+	// Rewriting identical contents changes only the modification time.  The source should be hashed, the existing entry
+	// used, and the new modification time recorded so that it is not hashed again on the next load
+	result.AssertTrue(WriteTestFile(SOURCE_FILE, SOURCE_DATA), ERR("Could not rewrite test source data"));
+	result.AssertTrue(AdvanceModifiedTime(SOURCE_FILE), ERR("Could not update modification time of test source data"));
+	{
+		GameDataCache cache;
+		cache.Load(CACHE_FILE);
+
+		delete cache.LoadDocument(SOURCE_FILE);
+		result.AssertEqual(cache.GetHitCount(), 1U, ERR("Source with unchanged contents was not loaded from the cache"));
+		result.AssertEqual(cache.GetMissCount(), 0U, ERR("Source with unchanged contents was recorded as a cache miss"));
+		result.AssertEqual(cache.GetHashCount(), 1U, ERR("Source with a new modification time was not hashed"));
+		result.AssertTrue(cache.Save(), ERR("Cache could not be saved"));
+	}
+	{
+		GameDataCache cache;
+		cache.Load(CACHE_FILE);
+
+		delete cache.LoadDocument(SOURCE_FILE);
+		result.AssertEqual(cache.GetHitCount(), 1U, ERR("Source was not loaded from the cache after its modification time was updated"));
+		result.AssertEqual(cache.GetHashCount(), 0U, ERR("Updated modification time was not persisted in the cache"));
+	}
+
+	std::remove(SOURCE_FILE.c_str());
+	std::remove(CACHE_FILE.c_str());
+	return result;
+}
+
+TestResult GameDataCacheTests::InvalidCacheFileTests()
+{
+	TestResult result = NewResult();
+	std::remove(CACHE_FILE.c_str());
+	result.AssertTrue(WriteTestFile(SOURCE_FILE, SOURCE_DATA), ERR("Could not write test source data"));
+
+	{
+		GameDataCache cache;
+		cache.Load(CACHE_FILE);
+		delete cache.LoadDocument(SOURCE_FILE);
+		cache.Save();
+	}
+
+	// Truncate the cache file.  No entries should be loaded, and data should be loaded from the source as normal
+	std::string data;
+	{
+		std::ifstream in(CACHE_FILE.c_str(), std::ios::binary);
+		data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+	}
+	result.AssertTrue(data.size() > 16U, ERR("Cache file was not written"));
+	result.AssertTrue(WriteTestFile(CACHE_FILE, data.substr(0U, data.size() / 2U)), ERR("Could not write truncated cache file"));
+
+	TiXmlDocument source(SOURCE_FILE.c_str());
+	source.LoadFile();
+	{
+		GameDataCache cache;
+		result.AssertEqual(cache.Load(CACHE_FILE), 0U, ERR("Entries were loaded from a truncated cache file"));
+
+		TiXmlDocument *doc = cache.LoadDocument(SOURCE_FILE);
+		result.AssertTrue(doc != NULL, ERR("Document could not be loaded alongside an invalid cache file"));
+		result.AssertEqual(cache.GetMissCount(), 1U, ERR("Load alongside an invalid cache file was not recorded as a cache miss"));
+		if (doc) result.AssertTrue(ElementTreesMatch(&source, doc), ERR("Document loaded alongside an invalid cache file does not match source"));
+		delete doc;
+	}
+
+	std::remove(SOURCE_FILE.c_str());
+	std::remove(CACHE_FILE.c_str());
+	return result;
+}
+
+bool GameDataCacheTests::WriteTestFile(const std::string & filename, const std::string & data)
+{
+	std::ofstream out(filename.c_str(), std::ios::binary | std::ios::trunc);
+	if (!out.is_open()) return false;
+
+	out.write(data.data(), data.size());
+	return out.good();
+}
+
+bool GameDataCacheTests::AdvanceModifiedTime(const std::string & filename)
+{
+	std::error_code error;
+	std::filesystem::file_time_type modified = std::filesystem::last_write_time(filename, error);
+	if (error) return false;
+
+	std::filesystem::last_write_time(filename, modified + std::chrono::seconds(10), error);
+	return !error;
+}
+
+bool GameDataCacheTests::ElementTreesMatch(const TiXmlNode *expected, const TiXmlNode *actual)
+{
+	if (!expected || !actual) return (expected == actual);
+	if (expected->Type() != actual->Type() || strcmp(expected->Value(), actual->Value()) != 0) return false;
+
+	if (expected->Type() == TiXmlNode::TEXT)
+	{
+		return (expected->ToText()->CDATA() == actual->ToText()->CDATA());
+	}
+
+	if (expected->Type() == TiXmlNode::ELEMENT)
+	{
+		const TiXmlAttribute *a0 = expected->ToElement()->FirstAttribute(), *a1 = actual->ToElement()->FirstAttribute();
+		for (; a0 && a1; a0 = a0->Next(), a1 = a1->Next())
+		{
+			if (strcmp(a0->Name(), a1->Name()) != 0 || strcmp(a0->Value(), a1->Value()) != 0) return false;
+		}
+		if (a0 || a1) return false;
+	}
+
+	// Compare only the element and text children of each node
+	auto next_data_node = [](const TiXmlNode *node)
+	{
+		while (node && node->Type() != TiXmlNode::ELEMENT && node->Type() != TiXmlNode::TEXT) node = node->NextSibling();
+		return node;
+	};
+
+	const TiXmlNode *c0 = next_data_node(expected->FirstChild()), *c1 = next_data_node(actual->FirstChild());
+	for (; c0 && c1; c0 = next_data_node(c0->NextSibling()), c1 = next_data_node(c1->NextSibling()))
+	{
+		if (!ElementTreesMatch(c0, c1)) return false;
+	}
+
+	return (c0 == NULL && c1 == NULL);
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include "CompilerSettings.h"
+#include "TestBase.h"
+class TiXmlNode;
+
+class GameDataCacheTests : public TestBase
+{
+public:
+
+	CMPINLINE TestResult RunTests(void)
+	{
+		TestResult result = NewNamedResult(GameDataCacheTests);
+
+		result += CachedRoundTripTests();
+		result += SourceChangeInvalidationTests();
+		result += SourceTimestampTests();
+		result += InvalidCacheFileTests();
+
+		return result;
+	}
+
+
+private:
+
+	TestResult CachedRoundTripTests();
+	TestResult SourceChangeInvalidationTests();
+	TestResult SourceTimestampTests();
+	TestResult InvalidCacheFileTests();
+
+	// Writes the given data to a file, replacing any existing contents.  Returns success flag
+	bool WriteTestFile(const std::string & filename, const std::string & data);
+
+	// Moves the modification time of a file forward, so that a rewrite is detected regardless of timestamp resolution.  Returns success flag
+	bool AdvanceModifiedTime(const std::string & filename);
+
+	// Tests whether two element trees are identical, ignoring any comments, declarations or other non-data nodes
+	bool ElementTreesMatch(const TiXmlNode *expected, const TiXmlNode *actual);
+
+	// Source data and cache file used by each test
+	static const std::string SOURCE_FILE;
+	static const std::string CACHE_FILE;
+	static const std::string SOURCE_DATA;
+
+};
@@ -8,6 +8,7 @@
 #include "Octree.h"
 #include "GameConsoleCommand.h"
 #include "ObjectSearch.h"
+#include "GameObjects.h"
 #include "iObject.h"
 #include "iActiveObject.h"
 #include "iSpaceObject.h"
@@ -20,6 +21,7 @@
 #include "iSpaceObjectEnvironment.h"
 #include "ComplexShipSection.h"
 #include "Terrain.h"
+#include "WorkerThreadPool.h"
 
 #include "GamePhysicsEngine.h"
 
@@ -53,6 +55,15 @@ GamePhysicsEngine::GamePhysicsEngine(void)
 	// Default physics engine flags
 	m_flag_handle_diverging_collisions = false;
 
+	// Use the octree search broadphase by default
+	m_broadphase_mode = BroadphaseMode::OctreeSearch;
+
+	// Narrowphase testing is performed serially by default
+	m_narrowphase_mode = NarrowphaseMode::Serial;
+
+	// Broadphase pairs are not recorded by default
+	m_broadphase_record = NULL;
+
 	// Debug flags and data
 #ifdef RJ_ENABLE_ENTITY_PHYSICS_DEBUGGING
 	m_physics_debug_entity_id = 0U;
@@ -184,13 +195,7 @@ void GamePhysicsEngine::PerformCollisionDetection(iObject *focalobject)
 void GamePhysicsEngine::PerformSpaceCollisionDetection(iSpaceObject *focalobject, float radius)
 {
 	std::vector<iObject*> objects;			// The list of objects being considered for collision detection
-	std::vector<iObject*> candidates;		// The list of potential collisions around the object being tested
-	iSpaceObject *object, *candidate;
-	int numobjects, numcandidates;
-	bool hasexclusions;							// Flag indicating whether the current object has any collision exclusions.  For efficiency
-	bool exclude_static;						// Flag indicating whether we should exclude static/static pairs from the CD
-	OrientedBoundingBox *collider0 = NULL, *collider1 = NULL;	// Oriented bounding boxes that are colliding, determined during narrowphase testing
-	bool result;
+	int numobjects;
 
 	/* High-level process:
 		1. Use octree to determine only those objects in the search radius about the focal object
@@ -200,6 +205,9 @@ void GamePhysicsEngine::PerformSpaceCollisionDetection(iSpaceObject *focalobject
 				3. Broadphase: Use bounding sphere test (with radius = max(size.x, size.y, size.z) to eliminate all but broadphase collision pairs
 				               Record this item against the candidate as an object already tested.  Then when testing candidate we don't need to repeat.
 				4. Narrowphase: Perform OBB narrowphase collision detection where applicable
+
+	   If the sweep-and-prune broadphase is enabled then steps 2 & 3 are instead replaced by a single sweep over all objects in scope, 
+	   plus all colliders within reach of them
 	*/
 
 	// Parameter check
@@ -221,7 +229,7 @@ void GamePhysicsEngine::PerformSpaceCollisionDetection(iSpaceObject *focalobject
 		// boundaries at this point since we are just doing a coarse search of nearby objects.  We only want to return
 		// active collider objects and can ignore anything else
 		numobjects = Game::Search<iObject>().GetAllObjectsWithinDistance(focalobject, radius, objects, 
-			(Game::ObjectSearchOptions::OnlyCollidingObjects | Game::ObjectSearchOptions::OnlyActiveColliders));
+						(Game::ObjectSearchOptions::OnlyCollidingObjects | Game::ObjectSearchOptions::OnlyActiveColliders));
 
 		// Add the focal object (as long as it collides), since it will not be returned by the ObjectsWithinDistance method
 		if (focalobject->GetCollisionMode() != Game::CollisionMode::NoCollision)
@@ -231,7 +239,39 @@ void GamePhysicsEngine::PerformSpaceCollisionDetection(iSpaceObject *focalobject
 		}
 	}
 
+	// Record the set of objects in scope, so that each broadphase method can determine which side of a pair will test it
+	m_collision_scope.clear();
+	for (int i = 0; i < numobjects; ++i)
+	{
+		if (objects[i]) m_collision_scope.push_back(objects[i]->GetID());
+	}
+	std::sort(m_collision_scope.begin(), m_collision_scope.end());
+
+	// 2. Determine all potentially-colliding pairs using the selected broadphase method, and test each pair in turn
+	if (m_broadphase_mode == BroadphaseMode::SweepAndPrune)
+	{
+		// All pairs are determined in a single sweep over the objects in scope and the colliders around them
+		PerformSweepAndPruneSpaceCollisionDetection(focalobject, radius, objects);
+	}
+	else
+	{
+		// Pairs are determined by a local search around each object in scope
+		PerformOctreeSearchSpaceCollisionDetection(objects);
+	}
+
+	// Execute any narrowphase tests that were deferred for parallel execution, and apply the resulting collision responses
+	if (!m_narrowphase_pairs.empty()) ExecuteDeferredNarrowphase();
+}
+
+// Performs collision detection across the given set of objects, determining potential collision pairs by searching the 
+// spatial partitioning tree around each object in turn
+void GamePhysicsEngine::PerformOctreeSearchSpaceCollisionDetection(const std::vector<iObject*> & objects)
+{
+	iSpaceObject *object, *candidate;
+	int numcandidates;
+
 	// 2. Now we want to consider each object in turn
+	int numobjects = (int)objects.size();
 	for (int i = 0; i < numobjects; ++i)
 	{
 		// Get a reference to this object
@@ -256,97 +296,291 @@ void GamePhysicsEngine::PerformSpaceCollisionDetection(iSpaceObject *focalobject
 		{
 			// Otherwise, in the majority of cases, we will handle this object via normal, discrete collision detection
 			
-			// Get any colliding objects within the current object's collision sphere radius; quit here if there are no objects nearby
-			candidates.clear();
-			numcandidates = Game::Search<iObject>().GetAllObjectsWithinDistance(	object, object->GetCollisionSphereRadius(), candidates, 
+			// Get the ID of any colliding objects within the current object's collision sphere radius; quit here if there are no 
+			// objects nearby.  Only IDs and positions are needed to locate candidates, so we can use the vectorised search
+			numcandidates = Game::Search<iObject>().GetAllObjectIDsWithinDistance(	object, object->GetCollisionSphereRadius(), m_broadphase_candidates, 
 																						Game::ObjectSearchOptions::OnlyCollidingObjects);
 			if (numcandidates == 0) continue;
 
-			// Get basic information on the object that we will need for each comparison
-			hasexclusions = object->HasCollisionExclusions();
-			exclude_static = (!m_cd_include_static && object->IsStatic());
-
 			// 3. Now consider each candidate in the broadphase collision detection, using simple collision sphere comparisons
 			Game::ID_TYPE object_id = object->GetID();
 			for (int c = 0; c < numcandidates; ++c)
 			{
+				// The search will also return the object itself, which can be discarded before it is resolved
+				Game::ID_TYPE candidate_id = m_broadphase_candidates[c];
+				if (candidate_id == object_id) continue;
+
 				// Get a reference to the candidate object
-				candidate = (iSpaceObject*)candidates[c]; if (!candidate) continue;
+				candidate = (iSpaceObject*)Game::GetObjectByID(candidate_id); if (!candidate) continue;
 
 				// We only want to test a collision between two objects once, i.e. we don't want to test (object vs candidate) and 
 				// then (candidate vs object).  To do this efficiently we only test collisions where object.ID < candidate.ID.  The 
-				// uniqueness and sequential nature of object IDs means this will always work.  Only exception is if the candidate is
-				// a passive collider.  In this case it cannot test for collisions itself, and so we will allow it as the candidate here
-				if (object_id >= candidate->GetID() && candidate->GetColliderType() != Game::ColliderType::PassiveCollider) continue;
+				// uniqueness and sequential nature of object IDs means this will always work.  Exceptions are where the candidate is
+				// a passive collider, or is outside the collision scope.  In either case it will not test for collisions itself, and 
+				// so we will allow it as the candidate here
+				if (object_id > candidate_id && candidate->GetColliderType() != Game::ColliderType::PassiveCollider && 
+					IsInSpaceCollisionScope(candidate_id)) continue;
+
+				// Perform broadphase and (if required) narrowphase testing of the pair, and apply any collision response
+				ProcessSpaceCollisionPair(object, candidate);
+			}
+		}
+	}
+}
 
-				// Also test whether either object has an exclusion in place to prevent collision with the other
-				if ((hasexclusions && object->CollisionExcludedWithObject(candidate->GetID())) ||
-					(candidate->HasCollisionExclusions() && candidate->CollisionExcludedWithObject(object_id))) continue;
+// Performs collision detection across the given set of objects using the persistent sweep-and-prune broadphase.  Each 
+// overlapping pair is emitted exactly once by the sweep, and then passed through the standard pair testing process
+void GamePhysicsEngine::PerformSweepAndPruneSpaceCollisionDetection(iSpaceObject *focalobject, float radius, const std::vector<iObject*> & objects)
+{
+	iSpaceObject *object, *candidate;
 
-				// If the candidate is a 'fast-mover', don't test for a collision from this side.  All CCD collisions for this candidate
-				// object will be covered in the CCD method when it is the primary object
-				if (candidate->IsFastMover()) continue;
+	// The sweep will not perform any further search around each object, so passive colliders (and active colliders outside 
+	// the scope) must be gathered up-front.  The per-object search can reach candidates up to the scope extent beyond any 
+	// object in scope, so we widen the search by twice that extent to also account for the size of the candidate itself
+	if (radius <= Game::C_EPSILON)
+	{
+		// All objects in the tree are already in scope
+		m_sap_objects = objects;
+	}
+	else
+	{
+		m_sap_objects.clear();
+		float search_radius = radius + (2.0f * DetermineSpaceCollisionScopeExtent(objects));
+		Game::Search<iObject>().GetAllObjectsWithinDistance(focalobject, search_radius, m_sap_objects, Game::ObjectSearchOptions::OnlyCollidingObjects);
 
-				// If the focal object is static, test whether the candidate is as well.  Only evaluate static pairs of objects on
-				// a periodic basis, since the vast majority of the time they will not be colliding (unless they are somehow placed inside
-				// each other)
-				if (exclude_static && candidate->IsStatic()) continue;
+		// Add the focal object (as long as it collides), since it will not be returned by the ObjectsWithinDistance method
+		if (focalobject->GetCollisionMode() != Game::CollisionMode::NoCollision) m_sap_objects.push_back(focalobject);
+	}
 
-				// Record the fact that we are testing the collision pair
-				++CollisionDetectionResults.SpaceCollisions.CollisionChecks;
+	// Refresh the broadphase proxy for every object.  Fast-moving objects are handled via CCD instead, and are excluded 
+	// from the discrete broadphase entirely
+	m_sap.BeginUpdate();
+	std::vector<iObject*>::const_iterator it_end = m_sap_objects.end();
+	for (std::vector<iObject*>::const_iterator it = m_sap_objects.begin(); it != it_end; ++it)
+	{
+		object = (iSpaceObject*)(*it); if (!object) continue;
 
-				// Test the objects to see if there is a broadphase collision
-				if (CheckBroadphaseCollision(object, candidate) == false)
-				{
-					// We do NOT have a collision, so simply move on to the next candidate object
-					continue;
-				}
-				else
-				{
-					// We DO have a potential collision.  We do not currently store the broadphase collision parameters for future use, but 
-					// if needed (From NCL physics PDF, collision detection part 1):
-					//		m_penetration = r1r2 - sqrtf(distSq)
-					//		m_normal = D3DXVec3Normalize(objpos - candpos)
-					//		m_point = objpos - (m_normal * (obj.radius - m_penetration * 0.5f ));
-
-
-					// Debug control; allow breaking at collision detection for a specific object
-#					ifdef RJ_ENABLE_ENTITY_PHYSICS_DEBUGGING
-						if (IsPhysicsDebugEnabled(PhysicsDebugType::PhysicsDebugOnBroadphase) && candidate->GetID() == m_physics_debug_entity_id)
-						{
-							OutputDebugString(concat("Broadphase collision detected for physics debug entity ")(m_physics_debug_entity_id)(" at ")(Game::PersistentClockMs)("ms\n").str().c_str());
-							__debugbreak();
-						}
-#					endif
-
-					// Increment the count of broadphase collisions
-					++CollisionDetectionResults.SpaceCollisions.BroadphaseCollisions;
-
-					// 4. These two objects are potentially colliding.  We should now therefore pass them to the more computationally-expensive
-					// narrowphase collision handling (if applicable) to determine if there is a true collision between components of each object
-					result = CheckFullCollision(object, candidate, &collider0, &collider1);
-
-					if (result)
-					{
-						// Debug control; allow breaking at collision detection for a specific object
-#						ifdef RJ_ENABLE_ENTITY_PHYSICS_DEBUGGING
-							if (IsPhysicsDebugEnabled(PhysicsDebugType::PhysicsDebugOnCollision) && candidate->GetID() == m_physics_debug_entity_id)
-							{
-								OutputDebugString(concat("Full collision detected for physics debug entity ")(m_physics_debug_entity_id)(" at ")(Game::PersistentClockMs)("ms\n").str().c_str());
-								__debugbreak();
-							}
-#						endif
-
-						// These two objects are colliding.  Determine the collision response and apply it
-						HandleCollision(object, candidate, (collider0 ? &(collider0->ConstData()) : NULL), (collider1 ? &(collider1->ConstData()) : NULL));
-						++CollisionDetectionResults.SpaceCollisions.Collisions;
-					}
-				}
+		// Debug control; allow breaking at collision detection for a specific object
+#		ifdef RJ_ENABLE_ENTITY_PHYSICS_DEBUGGING
+			if (IsPhysicsDebugEnabled(PhysicsDebugType::PhysicsDebugOnTest) && object->GetID() == m_physics_debug_entity_id)
+			{
+				OutputDebugString(concat("Testing collision of physics debug entity ")(m_physics_debug_entity_id)(" at ")(Game::PersistentClockMs)("ms\n").str().c_str());
+				__debugbreak();
 			}
+#		endif
+
+		if (object->IsFastMover())
+		{
+			// Only active colliders in scope are able to initiate collision testing themselves
+			if (object->GetColliderType() == Game::ColliderType::ActiveCollider && IsInSpaceCollisionScope(object->GetID())) 
+				PerformContinuousSpaceCollisionDetection(object);
+			continue;
+		}
+
+		m_sap.UpdateObject(object, object->GetPosition(), object->GetCollisionSphereRadius());
+	}
+	m_sap.EndUpdate();
+
+	// Process each overlapping pair in turn
+	const std::vector<SweepAndPruneBroadphase::CollisionPair> & pairs = m_sap.GetPairs();
+	std::vector<SweepAndPruneBroadphase::CollisionPair>::const_iterator p_end = pairs.end();
+	for (std::vector<SweepAndPruneBroadphase::CollisionPair>::const_iterator p = pairs.begin(); p != p_end; ++p)
+	{
+		object = (iSpaceObject*)p->Object0;
+		candidate = (iSpaceObject*)p->Object1;
+
+		// Order the pair consistently with the per-object search: the primary object must be in scope and should be an active 
+		// collider, and we otherwise test from the side of the lower object ID.  Pairs with neither object in scope, or of two 
+		// passive colliders, are never tested
+		bool scope0 = IsInSpaceCollisionScope(object->GetID());
+		bool scope1 = IsInSpaceCollisionScope(candidate->GetID());
+		bool passive0 = (object->GetColliderType() == Game::ColliderType::PassiveCollider);
+		bool passive1 = (candidate->GetColliderType() == Game::ColliderType::PassiveCollider);
+		if ((!scope0 && !scope1) || (passive0 && passive1)) continue;
+
+		if (scope0 != scope1)
+		{
+			if (scope1) std::swap(object, candidate);
+		}
+		else if (passive0 || (!passive1 && object->GetID() > candidate->GetID()))
+		{
+			std::swap(object, candidate);
+		}
+
+		// Perform broadphase and (if required) narrowphase testing of the pair, and apply any collision response
+		ProcessSpaceCollisionPair(object, candidate);
+	}
+}
+
+// Determines the maximum distance from an object in scope at which the per-object search could locate a collision candidate,
+// based on the largest collision sphere in scope plus the distance it can travel in a single frame
+float GamePhysicsEngine::DetermineSpaceCollisionScopeExtent(const std::vector<iObject*> & objects) const
+{
+	// The per-object search locates candidates within twice the object collision radius (since the search radius is 
+	// extended by the object boundary), plus the candidate radius which is accounted for by the search itself
+	float extent = 0.0f;
+	std::vector<iObject*>::const_iterator it_end = objects.end();
+	for (std::vector<iObject*>::const_iterator it = objects.begin(); it != it_end; ++it)
+	{
+		const iSpaceObject *object = (const iSpaceObject*)(*it); if (!object) continue;
+
+		float travel = (XMVectorGetX(XMVector3Length(object->PhysicsState.WorldMomentum)) * Game::TimeFactor);
+		extent = max(extent, (2.0f * object->GetCollisionSphereRadius()) + travel);
+	}
+
+	return extent;
+}
+
+// Tests a single pair of space objects for collision, applying collision response if required.  Applies all standard 
+// exclusions (collision exclusions, fast-movers, static pairs) before testing.  Returns a flag indicating whether a collision occurred
+bool GamePhysicsEngine::TestAndHandleSpaceCollisionPair(iSpaceObject *object, iSpaceObject *candidate)
+{
+	OrientedBoundingBox *collider0 = NULL, *collider1 = NULL;	// Oriented bounding boxes that are colliding, determined during narrowphase testing
+
+	// Apply exclusions and test the objects to see if there is a broadphase collision
+	if (TestSpaceCollisionPairBroadphase(object, candidate, m_collisiontest) == false) return false;
+
+	// 4. These two objects are potentially colliding.  We should now therefore pass them to the more computationally-expensive
+	// narrowphase collision handling (if applicable) to determine if there is a true collision between components of each object
+	if (CheckFullCollision(object, candidate, &collider0, &collider1, m_collisiontest) == false) return false;
+
+	// These two objects are colliding.  Determine the collision response and apply it
+	ApplySpaceCollisionResponse(object, candidate, collider0, collider1);
+	return true;
+}
+
+// Applies all standard exclusions (collision exclusions, fast-movers, static pairs) to a pair of space objects and then performs a
+// broadphase test.  Returns a flag indicating whether the pair should proceed to narrowphase testing
+bool GamePhysicsEngine::TestSpaceCollisionPairBroadphase(iSpaceObject *object, iSpaceObject *candidate, CollisionDetectionResult & result)
+{
+	// Test whether either object has an exclusion in place to prevent collision with the other
+	if ((object->HasCollisionExclusions() && object->CollisionExcludedWithObject(candidate->GetID())) ||
+		(candidate->HasCollisionExclusions() && candidate->CollisionExcludedWithObject(object->GetID()))) return false;
+
+	// If the candidate is a 'fast-mover', don't test for a collision from this side.  All CCD collisions for this candidate
+	// object will be covered in the CCD method when it is the primary object
+	if (candidate->IsFastMover()) return false;
+
+	// If the focal object is static, test whether the candidate is as well.  Only evaluate static pairs of objects on
+	// a periodic basis, since the vast majority of the time they will not be colliding (unless they are somehow placed inside
+	// each other)
+	if (!m_cd_include_static && object->IsStatic() && candidate->IsStatic()) return false;
+
+	// Record the fact that we are testing the collision pair
+	++CollisionDetectionResults.SpaceCollisions.CollisionChecks;
+
+	// Test the objects to see if there is a broadphase collision
+	if (CheckBroadphaseCollision(object, candidate, result) == false)
+	{
+		// We do NOT have a collision, so simply move on to the next candidate object
+		return false;
+	}
+
+	// We DO have a potential collision.  We do not currently store the broadphase collision parameters for future use, but 
+	// if needed (From NCL physics PDF, collision detection part 1):
+	//		m_penetration = r1r2 - sqrtf(distSq)
+	//		m_normal = D3DXVec3Normalize(objpos - candpos)
+	//		m_point = objpos - (m_normal * (obj.radius - m_penetration * 0.5f ));
+
+	// Debug control; allow breaking at collision detection for a specific object
+#	ifdef RJ_ENABLE_ENTITY_PHYSICS_DEBUGGING
+		if (IsPhysicsDebugEnabled(PhysicsDebugType::PhysicsDebugOnBroadphase) && candidate->GetID() == m_physics_debug_entity_id)
+		{
+			OutputDebugString(concat("Broadphase collision detected for physics debug entity ")(m_physics_debug_entity_id)(" at ")(Game::PersistentClockMs)("ms\n").str().c_str());
+			__debugbreak();
+		}
+#	endif
+
+	// Increment the count of broadphase collisions, and record the pair if required
+	++CollisionDetectionResults.SpaceCollisions.BroadphaseCollisions;
+	if (m_broadphase_record) m_broadphase_record->push_back(std::pair<Game::ID_TYPE, Game::ID_TYPE>(object->GetID(), candidate->GetID()));
+	return true;
+}
+
+// Applies collision response to a pair of space objects which have been determined to be colliding
+void GamePhysicsEngine::ApplySpaceCollisionResponse(iSpaceObject *object, iSpaceObject *candidate, 
+													OrientedBoundingBox *collider0, OrientedBoundingBox *collider1)
+{
+	// Debug control; allow breaking at collision detection for a specific object
+#	ifdef RJ_ENABLE_ENTITY_PHYSICS_DEBUGGING
+		if (IsPhysicsDebugEnabled(PhysicsDebugType::PhysicsDebugOnCollision) && candidate->GetID() == m_physics_debug_entity_id)
+		{
+			OutputDebugString(concat("Full collision detected for physics debug entity ")(m_physics_debug_entity_id)(" at ")(Game::PersistentClockMs)("ms\n").str().c_str());
+			__debugbreak();
+		}
+#	endif
+
+	// These two objects are colliding.  Determine the collision response and apply it
+	HandleCollision(object, candidate, (collider0 ? &(collider0->ConstData()) : NULL), (collider1 ? &(collider1->ConstData()) : NULL));
+	++CollisionDetectionResults.SpaceCollisions.Collisions;
+}
+
+// Either tests and handles the pair immediately, or queues it for the deferred parallel narrowphase, depending on the narrowphase mode
+void GamePhysicsEngine::ProcessSpaceCollisionPair(iSpaceObject *object, iSpaceObject *candidate)
+{
+	if (m_narrowphase_mode == NarrowphaseMode::Serial)
+	{
+		TestAndHandleSpaceCollisionPair(object, candidate);
+	}
+	else
+	{
+		// Broadphase testing is cheap and updates shared statistics, so it is still performed serially here.  Only pairs
+		// which pass the broadphase are queued for narrowphase testing
+		NarrowphasePair pair(object, candidate);
+		if (TestSpaceCollisionPairBroadphase(object, candidate, pair.Result))
+		{
+			m_narrowphase_pairs.push_back(pair);
 		}
 	}
 }
 
+// Executes narrowphase testing for all queued pairs across the worker thread pool, and then applies collision response
+// for each colliding pair serially, in the order in which pairs were queued
+void GamePhysicsEngine::ExecuteDeferredNarrowphase(void)
+{
+	int count = (int)m_narrowphase_pairs.size();
+
+	// OBB hierarchies are lazily recalculated on first use after invalidation.  Bring every hierarchy up-to-date now, so that
+	// the narrowphase tests below only ever read OBB data and can safely share objects between threads
+	for (int i = 0; i < count; ++i)
+	{
+		m_narrowphase_pairs[i].Object->CollisionOBB.UpdateIfRequired();
+		m_narrowphase_pairs[i].Candidate->CollisionOBB.UpdateIfRequired();
+	}
+
+	// Perform narrowphase testing in parallel.  Each test writes only to its own pair data
+	Game::WorkerThreads.ParallelFor(count, NARROWPHASE_PARALLEL_GRAIN, [this](int begin, int end)
+	{
+		for (int i = begin; i < end; ++i)
+		{
+			NarrowphasePair & pair = m_narrowphase_pairs[i];
+			pair.Colliding = CheckFullCollision(pair.Object, pair.Candidate, &pair.Collider0, &pair.Collider1, pair.Result);
+		}
+	});
+
+	// Merge step: apply collision response for each colliding pair in queue order, so that results are deterministic 
+	// regardless of how the narrowphase work was distributed
+	for (int i = 0; i < count; ++i)
+	{
+		const NarrowphasePair & pair = m_narrowphase_pairs[i];
+		if (!pair.Colliding) continue;
+
+		m_collisiontest = pair.Result;
+		ApplySpaceCollisionResponse(pair.Object, pair.Candidate, pair.Collider0, pair.Collider1);
+	}
+
+	m_narrowphase_pairs.clear();
+}
+
+// Sets the broadphase method used for space collision detection.  Any persistent broadphase data is discarded when
+// switching away from sweep-and-prune, since it would otherwise become stale
+void GamePhysicsEngine::SetBroadphaseMode(BroadphaseMode mode)
+{
+	if (mode == m_broadphase_mode) return;
+	m_broadphase_mode = mode;
+	m_sap.Clear();
+}
+
 // Checks a single, isolated collision between two object.  Not part of the primary collision detection cycle
 bool GamePhysicsEngine::CheckSingleCollision(iSpaceObject *obj0, iSpaceObject *obj1)
 {
@@ -758,35 +992,35 @@ bool GamePhysicsEngine::TestAndHandleTerrainCollision(iSpaceObjectEnvironment *e
 // Broadphase collision is tested by a bounding sphere test; objects may be colliding if (d^2 < (r1 + r2)^2), where
 //		d = distance between centre of the two bounding spheres
 //		r1, r2 = the radius of each object's bounding spheres
-CMPINLINE bool GamePhysicsEngine::CheckBroadphaseCollision(const iObject *obj0, const iObject *obj1)
+CMPINLINE bool GamePhysicsEngine::CheckBroadphaseCollision(const iObject *obj0, const iObject *obj1, CollisionDetectionResult & result) const
 {
 	// Perform a simple bounding spehere test on the objects
-	//_diffpos = (obj0->GetPosition() - obj1->GetPosition());
-	//_distsq = (_diffpos.x * _diffpos.x) + (_diffpos.y * _diffpos.y) + (_diffpos.z * _diffpos.z);
-	_r1r2 = (obj0->GetCollisionSphereRadius() + obj1->GetCollisionSphereRadius());
+	float r1r2 = (obj0->GetCollisionSphereRadius() + obj1->GetCollisionSphereRadius());
 
 	// Test the values to see if there is a broadphase collision
-	m_collisiontest.BroadphasePenetrationSq = ((_r1r2 * _r1r2) - XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(obj0->GetPosition(), obj1->GetPosition()))));
-	return (m_collisiontest.BroadphasePenetrationSq > 0.0f);
+	result.BroadphasePenetrationSq = ((r1r2 * r1r2) - XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(obj0->GetPosition(), obj1->GetPosition()))));
+	return (result.BroadphasePenetrationSq > 0.0f);
 }
 
 // Checks for a broadphase collision between the two objects.  No parameter checking since this should only be called internally on pre-validated parameters
 // Broadphase collision is tested by a bounding sphere test; objects may be colliding if (d^2 < (r1 + r2)^2), where
 //		d = distance between centre of the two bounding spheres
 //		r1, r2 = the radius of each object's bounding spheres
-CMPINLINE bool GamePhysicsEngine::CheckBroadphaseCollision(const FXMVECTOR pos0, float collisionradius0, const FXMVECTOR pos1, float collisionradius1)
+CMPINLINE bool GamePhysicsEngine::CheckBroadphaseCollision(const FXMVECTOR pos0, float collisionradius0, const FXMVECTOR pos1, float collisionradius1,
+															CollisionDetectionResult & result) const
 {
 	// Perform a simple bounding sphere test on the objects
-	//_diffpos = (pos0 - pos1);
-	//_distsq = (_diffpos.x * _diffpos.x) + (_diffpos.y * _diffpos.y) + (_diffpos.z * _diffpos.z);
-	_r1r2 = (collisionradius0 + collisionradius1);
+	float r1r2 = (collisionradius0 + collisionradius1);
 
 	// Test the values to see if there is a broadphase collision
-	m_collisiontest.BroadphasePenetrationSq = ((_r1r2 * _r1r2) - XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(pos0, pos1))));
-	return (m_collisiontest.BroadphasePenetrationSq > 0.0f);
+	result.BroadphasePenetrationSq = ((r1r2 * r1r2) - XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(pos0, pos1))));
+	return (result.BroadphasePenetrationSq > 0.0f);
 }
 
-bool GamePhysicsEngine::CheckFullCollision(iObject *obj0, iObject *obj1, OrientedBoundingBox **ppOutCollider0, OrientedBoundingBox **ppOutCollider1)
+// Performs full collision detection between the two objects.  Results are written to the supplied structure and no engine state is
+// modified, so that narrowphase tests for independent pairs can be run concurrently
+bool GamePhysicsEngine::CheckFullCollision(iObject *obj0, iObject *obj1, OrientedBoundingBox **ppOutCollider0, OrientedBoundingBox **ppOutCollider1,
+									   CollisionDetectionResult & result) const
 {
 	if (obj0->GetCollisionMode() == Game::CollisionMode::BroadphaseCollisionOnly)
 	{
@@ -795,7 +1029,7 @@ bool GamePhysicsEngine::CheckFullCollision(iObject *obj0, iObject *obj1, Oriente
 			// obj0 = broadphase only, obj1 = broadphase only.  Return true automatically since we only call this method if broadphase collision was detected
 			// By setting the collision detection type to "SphereVsSphere" we tell downstream methods that they should use the broadphase penetration distance sq, 
 			// and that the "Penetration" value will not be set here for efficiency (to avoid the sqrt)
-			m_collisiontest.Type = CollisionDetectionType::SphereVsSphere;
+			result.Type = CollisionDetectionType::SphereVsSphere;
 			(*ppOutCollider0) = (*ppOutCollider1) = NULL;
 			return true;
 		}
@@ -809,7 +1043,7 @@ bool GamePhysicsEngine::CheckFullCollision(iObject *obj0, iObject *obj1, Oriente
 			//obj1->CollisionOBB.UpdateIfRequired();
 
 			// Perform the collision test
-			return TestSpherevsOBBHierarchyCollision(obj0->GetPosition(), obj0->GetCollisionSphereRadiusSq(), obj1->CollisionOBB, ppOutCollider1);
+			return TestSpherevsOBBHierarchyCollision(obj0->GetPosition(), obj0->GetCollisionSphereRadiusSq(), obj1->CollisionOBB, ppOutCollider1, result);
 		}
 	}
 	else
@@ -824,7 +1058,7 @@ bool GamePhysicsEngine::CheckFullCollision(iObject *obj0, iObject *obj1, Oriente
 			//obj0->CollisionOBB.UpdateIfRequired();
 
 			// Perform the collision test
-			return TestSpherevsOBBHierarchyCollision(obj1->GetPosition(), obj1->GetCollisionSphereRadiusSq(), obj0->CollisionOBB, ppOutCollider0);
+			return TestSpherevsOBBHierarchyCollision(obj1->GetPosition(), obj1->GetCollisionSphereRadiusSq(), obj0->CollisionOBB, ppOutCollider0, result);
 		}
 		else
 		{
@@ -836,7 +1070,7 @@ bool GamePhysicsEngine::CheckFullCollision(iObject *obj0, iObject *obj1, Oriente
 			//obj1->CollisionOBB.UpdateIfRequired();
 
 			// Perform the collision test
-			return TestOBBvsOBBHierarchy(obj0->CollisionOBB, obj1->CollisionOBB, ppOutCollider0, ppOutCollider1);
+			return TestOBBvsOBBHierarchy(obj0->CollisionOBB, obj1->CollisionOBB, ppOutCollider0, ppOutCollider1, result);
 		}
 	}
 }
@@ -1204,7 +1438,8 @@ GamePhysicsEngine::~GamePhysicsEngine(void)
 
 // Performs hierarchical collision detection between two OBB hierarchies
 bool GamePhysicsEngine::TestOBBvsOBBHierarchy(OrientedBoundingBox & obj0, OrientedBoundingBox & obj1, 
-											  OrientedBoundingBox ** ppOutCollider0, OrientedBoundingBox ** ppOutCollider1)
+											  OrientedBoundingBox ** ppOutCollider0, OrientedBoundingBox ** ppOutCollider1, 
+											  CollisionDetectionResult & result) const
 {
 #	if defined(RJ_ENABLE_ENTITY_PHYSICS_DEBUGGING) && defined(RJ_LOG_OBB_HIERARCHY_TESTING)
 		XMVECTOR pos0 = (obj0.Parent ? XMVectorSubtract(obj0.Data().Centre, obj0.Parent->GetPosition()) : obj0.Data().Centre);
@@ -1214,7 +1449,7 @@ bool GamePhysicsEngine::TestOBBvsOBBHierarchy(OrientedBoundingBox & obj0, Orient
 #	endif
 
 	// Test the two objects for overlap; if they are not colliding then early-exit immediately
-	if (TestOBBvsOBBCollision(obj0.Data(), obj1.Data()) == false) OBB_RTN_LOG(false, concat("Objects do not overlap")(data).str().c_str());
+	if (TestOBBvsOBBCollision(obj0.Data(), obj1.Data(), result) == false) OBB_RTN_LOG(false, concat("Objects do not overlap")(data).str().c_str());
 	OBB_LOG(concat("Objects are overlapping")(data).str().c_str());
 
 	// Otherwise, we have a collision
@@ -1232,7 +1467,7 @@ bool GamePhysicsEngine::TestOBBvsOBBHierarchy(OrientedBoundingBox & obj0, Orient
 			for (int i = 0; i < obj1.ChildCount; ++i)
 			{
 				// Roll up a positive result if we receive one
-				if (TestOBBvsOBBHierarchy(obj0, obj1.Children[i], ppOutCollider0, ppOutCollider1) == true) 
+				if (TestOBBvsOBBHierarchy(obj0, obj1.Children[i], ppOutCollider0, ppOutCollider1, result) == true) 
 					OBB_RTN_LOG(true, concat("Leaf/branch are colliding")(data).str().c_str());
 			}
 		}
@@ -1243,7 +1478,7 @@ bool GamePhysicsEngine::TestOBBvsOBBHierarchy(OrientedBoundingBox & obj0, Orient
 		for (int i = 0; i < obj0.ChildCount; ++i)
 		{
 			 // Roll up a positive result if we receive one
-			if (TestOBBvsOBBHierarchy(obj0.Children[i], obj1, ppOutCollider0, ppOutCollider1) == true)
+			if (TestOBBvsOBBHierarchy(obj0.Children[i], obj1, ppOutCollider0, ppOutCollider1, result) == true)
 				OBB_RTN_LOG(true, concat("Branch/")(obj1.HasChildren() ? "branch" : "leaf")(" are colliding")(data).str().c_str());
 		}
 	}
@@ -1255,7 +1490,9 @@ bool GamePhysicsEngine::TestOBBvsOBBHierarchy(OrientedBoundingBox & obj0, Orient
 
 
 // Tests for the intersection of two oriented bounding boxes (OBB)
-bool GamePhysicsEngine::TestOBBvsOBBCollision(const OrientedBoundingBox::CoreOBBData & box0, const OrientedBoundingBox::CoreOBBData & box1)
+// SAT results are written to the supplied result structure rather than engine state, so that tests can be run concurrently
+bool GamePhysicsEngine::TestOBBvsOBBCollision(const OrientedBoundingBox::CoreOBBData & box0, const OrientedBoundingBox::CoreOBBData & box1,
+											  CollisionDetectionResult & result) const
 {
 	// (Adapted from http://www.geometrictools.com/GTEngine/Include/Mathematics/GteIntrOrientedBox3OrientedBox3.h)
 
@@ -1285,7 +1522,7 @@ bool GamePhysicsEngine::TestOBBvsOBBCollision(const OrientedBoundingBox::CoreOBB
 	float r01_r;			 // (r01 - r), the penetration (+ve) or separation (-ve) distance
 
 	// Reset the SAT penetration depth, since we are looking for the axis with minimum penetration in this test
-	m_collisiontest.Penetration = FLT_MAX;
+	result.Penetration = FLT_MAX;
 
 	// Test for separation on the axis box0.Centre + t*box0.Axis[0].
     for (int i = 0; i < 3; ++i)
@@ -1297,12 +1534,12 @@ bool GamePhysicsEngine::TestOBBvsOBBCollision(const OrientedBoundingBox::CoreOBB
             parallelPairExists = true;
         }
     }
-    m_collisiontest.SATResult.AxisDist0[0] = DOT_3D(dist, box0Axis[0]);
-    r = fabs(m_collisiontest.SATResult.AxisDist0[0]);
+    result.SATResult.AxisDist0[0] = DOT_3D(dist, box0Axis[0]);
+    r = fabs(result.SATResult.AxisDist0[0]);
     r1 = box1.ExtentF.x * absDot01[0][0] + box1.ExtentF.y * absDot01[0][1] + box1.ExtentF.z * absDot01[0][2];
     r01 = box0.ExtentF.x + r1;
 	r01_r = (r01 - r); 
-	if (r01_r < m_collisiontest.Penetration && r01_r > Game::C_EPSILON) { m_collisiontest.Penetration = r01_r; m_collisiontest.SATResult.Object0Axis = 0; m_collisiontest.SATResult.Object1Axis = -1; }
+	if (r01_r < result.Penetration && r01_r > Game::C_EPSILON) { result.Penetration = r01_r; result.SATResult.Object0Axis = 0; result.SATResult.Object1Axis = -1; }
     if (r01_r < 0.0f)
     {
         return false;		// result.separating[0] = 0; result.separating[1] = -1;
@@ -1318,12 +1555,12 @@ bool GamePhysicsEngine::TestOBBvsOBBCollision(const OrientedBoundingBox::CoreOBB
             parallelPairExists = true;
         }
     }
-    m_collisiontest.SATResult.AxisDist0[1] = DOT_3D(dist, box0Axis[1]);
-    r = fabs(m_collisiontest.SATResult.AxisDist0[1]);
+    result.SATResult.AxisDist0[1] = DOT_3D(dist, box0Axis[1]);
+    r = fabs(result.SATResult.AxisDist0[1]);
     r1 = box1.ExtentF.x * absDot01[1][0] + box1.ExtentF.y * absDot01[1][1] + box1.ExtentF.z * absDot01[1][2];
     r01 = box0.ExtentF.y + r1;
 	r01_r = (r01 - r); 
-	if (r01_r < m_collisiontest.Penetration && r01_r > Game::C_EPSILON) { m_collisiontest.Penetration = r01_r; m_collisiontest.SATResult.Object0Axis = 1; m_collisiontest.SATResult.Object1Axis = -1; }
+	if (r01_r < result.Penetration && r01_r > Game::C_EPSILON) { result.Penetration = r01_r; result.SATResult.Object0Axis = 1; result.SATResult.Object1Axis = -1; }
 	if (r01_r < 0.0f)
     {
         return false;		// result.separating[0] = 1; result.separating[1] = -1;
@@ -1339,48 +1576,48 @@ bool GamePhysicsEngine::TestOBBvsOBBCollision(const OrientedBoundingBox::CoreOBB
             parallelPairExists = true;
         }
     }
-    m_collisiontest.SATResult.AxisDist0[2] = DOT_3D(dist, box0Axis[2]);
-    r = fabs(m_collisiontest.SATResult.AxisDist0[2]);
+    result.SATResult.AxisDist0[2] = DOT_3D(dist, box0Axis[2]);
+    r = fabs(result.SATResult.AxisDist0[2]);
     r1 = box1.ExtentF.x * absDot01[2][0] + box1.ExtentF.y * absDot01[2][1] + box1.ExtentF.z * absDot01[2][2];
     r01 = box0.ExtentF.z + r1;
 	r01_r = (r01 - r); 
-	if (r01_r < m_collisiontest.Penetration && r01_r > Game::C_EPSILON) { m_collisiontest.Penetration = r01_r; m_collisiontest.SATResult.Object0Axis = 2; m_collisiontest.SATResult.Object1Axis = -1; }
+	if (r01_r < result.Penetration && r01_r > Game::C_EPSILON) { result.Penetration = r01_r; result.SATResult.Object0Axis = 2; result.SATResult.Object1Axis = -1; }
 	if (r01_r < 0.0f)
     {
         return false;		// result.separating[0] = 2; result.separating[1] = -1;
     }
 
     // Test for separation on the axis box0.Centre + t*box1.Axis[0].
-	m_collisiontest.SATResult.AxisDist1[0] = DOT_3D(dist, box1Axis[0]);
-	r = fabs(m_collisiontest.SATResult.AxisDist1[0]);
+	result.SATResult.AxisDist1[0] = DOT_3D(dist, box1Axis[0]);
+	r = fabs(result.SATResult.AxisDist1[0]);
     r0 = box0.ExtentF.x * absDot01[0][0] + box0.ExtentF.y * absDot01[1][0] + box0.ExtentF.z * absDot01[2][0];
     r01 = r0 + box1.ExtentF.x;
 	r01_r = (r01 - r); 
-	if (r01_r < m_collisiontest.Penetration && r01_r > Game::C_EPSILON) { m_collisiontest.Penetration = r01_r; m_collisiontest.SATResult.Object0Axis = -1; m_collisiontest.SATResult.Object1Axis = 0; }
+	if (r01_r < result.Penetration && r01_r > Game::C_EPSILON) { result.Penetration = r01_r; result.SATResult.Object0Axis = -1; result.SATResult.Object1Axis = 0; }
 	if (r01_r < 0.0f)
     {
         return false;		// result.separating[0] = -1; result.separating[1] = 0;
     }
 
     // Test for separation on the axis box0.Centre + t*box1.Axis[1].
-	m_collisiontest.SATResult.AxisDist1[1] = DOT_3D(dist, box1Axis[1]);
-	r = fabs(m_collisiontest.SATResult.AxisDist1[1]);
+	result.SATResult.AxisDist1[1] = DOT_3D(dist, box1Axis[1]);
+	r = fabs(result.SATResult.AxisDist1[1]);
     r0 = box0.ExtentF.x * absDot01[0][1] + box0.ExtentF.y * absDot01[1][1] + box0.ExtentF.z * absDot01[2][1];
     r01 = r0 + box1.ExtentF.y;
 	r01_r = (r01 - r); 
-	if (r01_r < m_collisiontest.Penetration && r01_r > Game::C_EPSILON) { m_collisiontest.Penetration = r01_r; m_collisiontest.SATResult.Object0Axis = -1; m_collisiontest.SATResult.Object1Axis = 1; }
+	if (r01_r < result.Penetration && r01_r > Game::C_EPSILON) { result.Penetration = r01_r; result.SATResult.Object0Axis = -1; result.SATResult.Object1Axis = 1; }
 	if (r01_r < 0.0f)
     {
         return false;		// result.separating[0] = -1; result.separating[1] = 1;
     }
 
     // Test for separation on the axis box0.Centre + t*box1.Axis[2].
-	m_collisiontest.SATResult.AxisDist1[2] = DOT_3D(dist, box1Axis[2]);
-	r = fabs(m_collisiontest.SATResult.AxisDist1[2]);
+	result.SATResult.AxisDist1[2] = DOT_3D(dist, box1Axis[2]);
+	r = fabs(result.SATResult.AxisDist1[2]);
     r0 = box0.ExtentF.x * absDot01[0][2] + box0.ExtentF.y * absDot01[1][2] + box0.ExtentF.z * absDot01[2][2];
     r01 = r0 + box1.ExtentF.z;
 	r01_r = (r01 - r); 
-	if (r01_r < m_collisiontest.Penetration && r01_r > Game::C_EPSILON) { m_collisiontest.Penetration = r01_r; m_collisiontest.SATResult.Object0Axis = -1; m_collisiontest.SATResult.Object1Axis = 2; }
+	if (r01_r < result.Penetration && r01_r > Game::C_EPSILON) { result.Penetration = r01_r; result.SATResult.Object0Axis = -1; result.SATResult.Object1Axis = 2; }
 	if (r01_r < 0.0f)
     {
         return false;		// result.separating[0] = -1; result.separating[1] = 2;
@@ -1394,108 +1631,108 @@ bool GamePhysicsEngine::TestOBBvsOBBCollision(const OrientedBoundingBox::CoreOBB
     }
 	
     // Test for separation on the axis box0.Centre + t*box0.Axis[0]xA1[0].
-    r = fabs(m_collisiontest.SATResult.AxisDist0[2] * dot01[1][0] - m_collisiontest.SATResult.AxisDist0[1] * dot01[2][0]);
+    r = fabs(result.SATResult.AxisDist0[2] * dot01[1][0] - result.SATResult.AxisDist0[1] * dot01[2][0]);
     r0 = box0.ExtentF.y * absDot01[2][0] + box0.ExtentF.z * absDot01[1][0];
     r1 = box1.ExtentF.y * absDot01[0][2] + box1.ExtentF.z * absDot01[0][1];
     r01 = r0 + r1;
 	r01_r = (r01 - r); 
-	if (r01_r < m_collisiontest.Penetration && r01_r > Game::C_EPSILON) { m_collisiontest.Penetration = r01_r; m_collisiontest.SATResult.Object0Axis = 0; m_collisiontest.SATResult.Object1Axis = 0; }
+	if (r01_r < result.Penetration && r01_r > Game::C_EPSILON) { result.Penetration = r01_r; result.SATResult.Object0Axis = 0; result.SATResult.Object1Axis = 0; }
 	if (r01_r < 0.0f)
     {
         return false;		// result.separating[0] = 0; result.separating[1] = 0;
     }
 
     // Test for separation on the axis box0.Centre + t*box0.Axis[0]xA1[1].
-    r = fabs(m_collisiontest.SATResult.AxisDist0[2] * dot01[1][1] - m_collisiontest.SATResult.AxisDist0[1] * dot01[2][1]);
+    r = fabs(result.SATResult.AxisDist0[2] * dot01[1][1] - result.SATResult.AxisDist0[1] * dot01[2][1]);
     r0 = box0.ExtentF.y * absDot01[2][1] + box0.ExtentF.z * absDot01[1][1];
     r1 = box1.ExtentF.x * absDot01[0][2] + box1.ExtentF.z * absDot01[0][0];
     r01 = r0 + r1;
 	r01_r = (r01 - r); 
-	if (r01_r < m_collisiontest.Penetration && r01_r > Game::C_EPSILON) { m_collisiontest.Penetration = r01_r; m_collisiontest.SATResult.Object0Axis = 0; m_collisiontest.SATResult.Object1Axis = 1; }
+	if (r01_r < result.Penetration && r01_r > Game::C_EPSILON) { result.Penetration = r01_r; result.SATResult.Object0Axis = 0; result.SATResult.Object1Axis = 1; }
 	if (r01_r < 0.0f)
     {
         return false;		// result.separating[0] = 0; result.separating[1] = 1;
     }
 
     // Test for separation on the axis box0.Centre + t*box0.Axis[0]xA1[2].
-    r = fabs(m_collisiontest.SATResult.AxisDist0[2] * dot01[1][2] - m_collisiontest.SATResult.AxisDist0[1] * dot01[2][2]);
+    r = fabs(result.SATResult.AxisDist0[2] * dot01[1][2] - result.SATResult.AxisDist0[1] * dot01[2][2]);
     r0 = box0.ExtentF.y * absDot01[2][2] + box0.ExtentF.z * absDot01[1][2];
     r1 = box1.ExtentF.x * absDot01[0][1] + box1.ExtentF.y * absDot01[0][0];
     r01 = r0 + r1;
 	r01_r = (r01 - r); 
-	if (r01_r < m_collisiontest.Penetration && r01_r > Game::C_EPSILON) { m_collisiontest.Penetration = r01_r; m_collisiontest.SATResult.Object0Axis = 0; m_collisiontest.SATResult.Object1Axis = 2; }
+	if (r01_r < result.Penetration && r01_r > Game::C_EPSILON) { result.Penetration = r01_r; result.SATResult.Object0Axis = 0; result.SATResult.Object1Axis = 2; }
 	if (r01_r < 0.0f)
     {
         return false;		// result.separating[0] = 0; result.separating[1] = 2;
     }
 	
     // Test for separation on the axis box0.Centre + t*box0.Axis[1]xA1[0].
-    r = fabs(m_collisiontest.SATResult.AxisDist0[0] * dot01[2][0] - m_collisiontest.SATResult.AxisDist0[2] * dot01[0][0]);
+    r = fabs(result.SATResult.AxisDist0[0] * dot01[2][0] - result.SATResult.AxisDist0[2] * dot01[0][0]);
     r0 = box0.ExtentF.x * absDot01[2][0] + box0.ExtentF.z * absDot01[0][0];
     r1 = box1.ExtentF.y * absDot01[1][2] + box1.ExtentF.z * absDot01[1][1];
     r01 = r0 + r1;
 	r01_r = (r01 - r); 
-	if (r01_r < m_collisiontest.Penetration && r01_r > Game::C_EPSILON) { m_collisiontest.Penetration = r01_r; m_collisiontest.SATResult.Object0Axis = 1; m_collisiontest.SATResult.Object1Axis = 0; }
+	if (r01_r < result.Penetration && r01_r > Game::C_EPSILON) { result.Penetration = r01_r; result.SATResult.Object0Axis = 1; result.SATResult.Object1Axis = 0; }
 	if (r01_r < 0.0f)
     {
         return false;		// result.separating[0] = 1; result.separating[1] = 0;
     }
 
     // Test for separation on the axis box0.Centre + t*box0.Axis[1]xA1[1].
-    r = fabs(m_collisiontest.SATResult.AxisDist0[0] * dot01[2][1] - m_collisiontest.SATResult.AxisDist0[2] * dot01[0][1]);
+    r = fabs(result.SATResult.AxisDist0[0] * dot01[2][1] - result.SATResult.AxisDist0[2] * dot01[0][1]);
     r0 = box0.ExtentF.x * absDot01[2][1] + box0.ExtentF.z * absDot01[0][1];
     r1 = box1.ExtentF.x * absDot01[1][2] + box1.ExtentF.z * absDot01[1][0];
     r01 = r0 + r1;
 	r01_r = (r01 - r); 
-	if (r01_r < m_collisiontest.Penetration && r01_r > Game::C_EPSILON) { m_collisiontest.Penetration = r01_r; m_collisiontest.SATResult.Object0Axis = 1; m_collisiontest.SATResult.Object1Axis = 1; }
+	if (r01_r < result.Penetration && r01_r > Game::C_EPSILON) { result.Penetration = r01_r; result.SATResult.Object0Axis = 1; result.SATResult.Object1Axis = 1; }
 	if (r01_r < 0.0f)
     {
         return false;		// result.separating[0] = 1; result.separating[1] = 1;
     }
 
     // Test for separation on the axis box0.Centre + t*box0.Axis[1]xA1[2].
-    r = fabs(m_collisiontest.SATResult.AxisDist0[0] * dot01[2][2] - m_collisiontest.SATResult.AxisDist0[2] * dot01[0][2]);
+    r = fabs(result.SATResult.AxisDist0[0] * dot01[2][2] - result.SATResult.AxisDist0[2] * dot01[0][2]);
     r0 = box0.ExtentF.x * absDot01[2][2] + box0.ExtentF.z * absDot01[0][2];
     r1 = box1.ExtentF.x * absDot01[1][1] + box1.ExtentF.y * absDot01[1][0];
     r01 = r0 + r1;
 	r01_r = (r01 - r); 
-	if (r01_r < m_collisiontest.Penetration && r01_r > Game::C_EPSILON) { m_collisiontest.Penetration = r01_r; m_collisiontest.SATResult.Object0Axis = 1; m_collisiontest.SATResult.Object1Axis = 2; }
+	if (r01_r < result.Penetration && r01_r > Game::C_EPSILON) { result.Penetration = r01_r; result.SATResult.Object0Axis = 1; result.SATResult.Object1Axis = 2; }
 	if (r01_r < 0.0f)
     {
         return false;		// result.separating[0] = 1; result.separating[1] = 2;
     }
 
     // Test for separation on the axis box0.Centre + t*box0.Axis[2]xA1[0].
-    r = fabs(m_collisiontest.SATResult.AxisDist0[1] * dot01[0][0] - m_collisiontest.SATResult.AxisDist0[0] * dot01[1][0]);
+    r = fabs(result.SATResult.AxisDist0[1] * dot01[0][0] - result.SATResult.AxisDist0[0] * dot01[1][0]);
     r0 = box0.ExtentF.x * absDot01[1][0] + box0.ExtentF.y * absDot01[0][0];
     r1 = box1.ExtentF.y * absDot01[2][2] + box1.ExtentF.z * absDot01[2][1];
     r01 = r0 + r1;
 	r01_r = (r01 - r); 
-	if (r01_r < m_collisiontest.Penetration && r01_r > Game::C_EPSILON) { m_collisiontest.Penetration = r01_r; m_collisiontest.SATResult.Object0Axis = 2; m_collisiontest.SATResult.Object1Axis = 0; }
+	if (r01_r < result.Penetration && r01_r > Game::C_EPSILON) { result.Penetration = r01_r; result.SATResult.Object0Axis = 2; result.SATResult.Object1Axis = 0; }
 	if (r01_r < 0.0f)
     {
         return false;		// result.separating[0] = 2; result.separating[1] = 0;
     }
 
     // Test for separation on the axis box0.Centre + t*box0.Axis[2]xA1[1].
-    r = fabs(m_collisiontest.SATResult.AxisDist0[1] * dot01[0][1] - m_collisiontest.SATResult.AxisDist0[0] * dot01[1][1]);
+    r = fabs(result.SATResult.AxisDist0[1] * dot01[0][1] - result.SATResult.AxisDist0[0] * dot01[1][1]);
     r0 = box0.ExtentF.x * absDot01[1][1] + box0.ExtentF.y * absDot01[0][1];
     r1 = box1.ExtentF.x * absDot01[2][2] + box1.ExtentF.z * absDot01[2][0];
     r01 = r0 + r1;
 	r01_r = (r01 - r); 
-	if (r01_r < m_collisiontest.Penetration && r01_r > Game::C_EPSILON) { m_collisiontest.Penetration = r01_r; m_collisiontest.SATResult.Object0Axis = 2; m_collisiontest.SATResult.Object1Axis = 1; }
+	if (r01_r < result.Penetration && r01_r > Game::C_EPSILON) { result.Penetration = r01_r; result.SATResult.Object0Axis = 2; result.SATResult.Object1Axis = 1; }
 	if (r01_r < 0.0f)
     {
         return false;		// result.separating[0] = 2; result.separating[1] = 1;
     }
 
     // Test for separation on the axis box0.Centre + t*box0.Axis[2]xA1[2].
-    r = fabs(m_collisiontest.SATResult.AxisDist0[1] * dot01[0][2] - m_collisiontest.SATResult.AxisDist0[0] * dot01[1][2]);
+    r = fabs(result.SATResult.AxisDist0[1] * dot01[0][2] - result.SATResult.AxisDist0[0] * dot01[1][2]);
     r0 = box0.ExtentF.x * absDot01[1][2] + box0.ExtentF.y * absDot01[0][2];
     r1 = box1.ExtentF.x * absDot01[2][1] + box1.ExtentF.y * absDot01[2][0];
     r01 = r0 + r1;
 	r01_r = (r01 - r); 
-	if (r01_r < m_collisiontest.Penetration && r01_r > Game::C_EPSILON) { m_collisiontest.Penetration = r01_r; m_collisiontest.SATResult.Object0Axis = 2; m_collisiontest.SATResult.Object1Axis = 2; }
+	if (r01_r < result.Penetration && r01_r > Game::C_EPSILON) { result.Penetration = r01_r; result.SATResult.Object0Axis = 2; result.SATResult.Object1Axis = 2; }
 	if (r01_r < 0.0f)
     {
         return false;		// result.separating[0] = 2; result.separating[1] = 2;
@@ -1748,10 +1985,11 @@ bool GamePhysicsEngine::OLD_TestOBBvsOBBCollision(const tmpbox & box0, const tmp
 
 // Tests for the intersection of a bounding sphere with an OBB collision hierarchy 
 bool GamePhysicsEngine::TestSpherevsOBBHierarchyCollision(	const FXMVECTOR sphereCentre, const float sphereRadiusSq, 
-															OrientedBoundingBox & obb, OrientedBoundingBox ** ppOutOBBCollider)
+															OrientedBoundingBox & obb, OrientedBoundingBox ** ppOutOBBCollider,
+															CollisionDetectionResult & result) const
 {
 	// Test the intersection at this level of the OBB hierarchy; if it fails then return false immediately
-	if (TestSpherevsOBBCollision(sphereCentre, sphereRadiusSq, obb.Data()) == false) return false;
+	if (TestSpherevsOBBCollision(sphereCentre, sphereRadiusSq, obb.Data(), result) == false) return false;
 
 	// Now test for any children in the hierarchy
 	if (!obb.HasChildren())
@@ -1766,7 +2004,7 @@ bool GamePhysicsEngine::TestSpherevsOBBHierarchyCollision(	const FXMVECTOR spher
 		// it rolls back up and the next one is tried
 		for (int i = 0; i < obb.ChildCount; ++i)
 		{
-			if (TestSpherevsOBBHierarchyCollision(sphereCentre, sphereRadiusSq, obb.Children[i], ppOutOBBCollider) == true)
+			if (TestSpherevsOBBHierarchyCollision(sphereCentre, sphereRadiusSq, obb.Children[i], ppOutOBBCollider, result) == true)
 			{
 				// This branch succeeded all the way down to a leaf OBB which is colliding, so return success now
 				return true;
@@ -1782,10 +2020,10 @@ bool GamePhysicsEngine::TestSpherevsOBBHierarchyCollision(	const FXMVECTOR spher
 // Tests for the intersection of a bounding sphere and an oriented bounding box (OBB)
 // Input taken from http://www.gamedev.net/topic/579584-obb---sphere-collision-detection/
 bool GamePhysicsEngine::TestSpherevsOBBCollision(	const FXMVECTOR sphereCentre, const float sphereRadiusSq, 
-													const OrientedBoundingBox::CoreOBBData & obb)
+													const OrientedBoundingBox::CoreOBBData & obb, CollisionDetectionResult & result) const
 {
 	// We will update the collision detection data struct with the results of this test
-	m_collisiontest.Type = CollisionDetectionType::SphereVsOBB;
+	result.Type = CollisionDetectionType::SphereVsOBB;
 
 	// Get the closest point in/on the sphere to the OBB, and subtract the sphere centre to get a vector
 	// from the centre of the sphere to the closest/intersection point with the OBB
@@ -1793,8 +2031,8 @@ bool GamePhysicsEngine::TestSpherevsOBBCollision(	const FXMVECTOR sphereCentre,
 
 	// Dot(v,v) = v.LengthSq.  If Dot(v,v) <= SphereRadiusSq then it means the closest point to the 
 	// OBB is actually intersecting the OBB.  
-	m_collisiontest.Penetration = (sphereRadiusSq - XMVectorGetX(XMVector3Dot(v, v)));
-	return (m_collisiontest.Penetration > 0.0f);
+	result.Penetration = (sphereRadiusSq - XMVectorGetX(XMVector3Dot(v, v)));
+	return (result.Penetration > 0.0f);
 }
 
 
@@ -1825,7 +2063,7 @@ bool GamePhysicsEngine::TestRayVsAABBIntersection(const Ray & ray, const AABB &
 // took place.  If min<max then we have an intersection.  Returns a flag indicating whether the intersection took place.  If 
 // min<0 then the ray began inside the AABB.  
 // Input from http://tavianator.com/cgit/dimension.git/tree/libdimension/bvh.c#n191
-bool GamePhysicsEngine::DetermineRayVsAABBIntersection(const Ray & ray, const AABB & aabb, float t)
+bool GamePhysicsEngine::DetermineRayVsAABBIntersection(const Ray & ray, const AABB & aabb, float t, RayIntersectionTestResult & result) const
 {
 	// Perform intersection test
 	XMVECTOR t1 = XMVectorMultiply(XMVectorSubtract(aabb.P0, ray.Origin), ray.InvDirection);
@@ -1838,14 +2076,14 @@ bool GamePhysicsEngine::DetermineRayVsAABBIntersection(const Ray & ray, const AA
 	// We want to choose the largest of all min components, and the smallest of all max components, as the intersection times
 	XMFLOAT3 tminf, tmaxf;
 	XMStoreFloat3(&tminf, tmin); XMStoreFloat3(&tmaxf, tmax);
-	RayIntersectionResult.tmin = max(max(tminf.x, tminf.y), tminf.z);
-	RayIntersectionResult.tmax = min(min(tmaxf.x, tmaxf.y), tmaxf.z);
+	result.tmin = max(max(tminf.x, tminf.y), tminf.z);
+	result.tmax = min(min(tmaxf.x, tmaxf.y), tmaxf.z);
 
 	// If min<max then we have an intersection
-	return (RayIntersectionResult.tmax >= 0.0f &&						// The entire intersection must take place after t=0, i.e. not in the past
-			RayIntersectionResult.tmin < t &&							// The intersection must begin before the specified upper bound t in the future
-			RayIntersectionResult.tmax >= RayIntersectionResult.tmin &&	// The intersection must begin before it ends
-			RayIntersectionResult.tmin >= -FLT_MAX);					// Ensure tmin is not -INFINITY, i.e. avoid parallel/non-crossing intersection
+	return (result.tmax >= 0.0f &&				// The entire intersection must take place after t=0, i.e. not in the past
+			result.tmin < t &&					// The intersection must begin before the specified upper bound t in the future
+			result.tmax >= result.tmin &&		// The intersection must begin before it ends
+			result.tmin >= -FLT_MAX);			// Ensure tmin is not -INFINITY, i.e. avoid parallel/non-crossing intersection
 }
 
 /*/ Tests for the intersection of a ray with an OBB, by transforming the ray into OBB-space so that the OBB can be treated
@@ -1904,26 +2142,36 @@ bool GamePhysicsEngine::DetermineRayVsOBBIntersection(const Ray & ray, const Ori
 // intersection took place.  If min<0 then the ray began inside the OBB
 bool GamePhysicsEngine::DetermineLineVectorVsOBBHierarchyIntersection(const FXMVECTOR line_pos, const FXMVECTOR line_delta, OrientedBoundingBox & obb)
 {
-	AABB box; Ray localray; 
+	// Update the OBB with a recursive refresh if invalidated & required
+	obb.UpdateIfRequired();
+
+	// Perform the test using the engine working storage; results are returned in OBBIntersectionResult
+	return DetermineLineVectorVsOBBHierarchyIntersection(line_pos, line_delta, obb, OBBIntersectionResult, _obb_vector);
+}
+
+// Thread-safe equivalent of the line vector vs OBB hierarchy test.  Results are written to 'outResult', and 'search' is used as
+// working storage for the hierarchy traversal, so no engine state is modified.  The OBB hierarchy must already be up-to-date, 
+// since invalidated OBBs are otherwise recalculated on demand
+bool GamePhysicsEngine::DetermineLineVectorVsOBBHierarchyIntersection(const FXMVECTOR line_pos, const FXMVECTOR line_delta, OrientedBoundingBox & obb,
+																		  OBBIntersectionData & outResult, std::vector<OrientedBoundingBox*> & search) const
+{
+	AABB box; Ray localray; RayIntersectionTestResult rayresult;
 	bool intersection = false; 
 	float closest_intersection = 1.1f;		// Intersection should always be within t = [0 1], so 1.1 is fine as an unachievable maximum
 
 	// Construct a ray in world space from the line vector data provided
 	Ray worldray = Ray(line_pos, line_delta);
 
-	// Update the OBB with a recursive refresh if invalidated & required
-	obb.UpdateIfRequired();
-
 	// Push this OBB onto the search vector as the top-level node to be tested
-	_obb_vector.clear();
-	_obb_vector.push_back(&obb);
+	search.clear();
+	search.push_back(&obb);
 
 	// Process each OBB in the search vector in turn.  This allows us to perform a linear equivalent to recursive search
-	while (!_obb_vector.empty())
+	while (!search.empty())
 	{
 		// Get a reference to the OBB
-		OrientedBoundingBox & node = *(_obb_vector.back());
-		_obb_vector.pop_back();
+		OrientedBoundingBox & node = *(search.back());
+		search.pop_back();
 
 		// We will use a ray/AABB intersection test.  Treat the line vector as a ray and transform into 
 		// the OBB's coordinate frame.  Once in the OBB's frame we can treat it as an AABB
@@ -1932,8 +2180,8 @@ bool GamePhysicsEngine::DetermineLineVectorVsOBBHierarchyIntersection(const FXMV
 		localray.TransformIntoCoordinateSystem(node.ConstData().Centre, node.ConstData().Axis);
 
 		// Now test as a ray/AABB intersection, and quit if this element of the hierachy is not colliding (since then 
-		// none of its children will be colliding either).  This will populate the RayIntersectionResult if a collision occured
-		if (DetermineRayVsAABBIntersection(localray, box, 1.0f) == false) continue;
+		// none of its children will be colliding either).  This will populate the ray result if a collision occured
+		if (DetermineRayVsAABBIntersection(localray, box, 1.0f, rayresult) == false) continue;
 
 		// This OBB is colliding.  If it is a branch, we want to test its children.  If it is
 		// a leaf, we want to consider it as the final colliding OBB
@@ -1942,30 +2190,30 @@ bool GamePhysicsEngine::DetermineLineVectorVsOBBHierarchyIntersection(const FXMV
 			// Add all child nodes to the search vector
 			for (int i = 0; i < node.ChildCount; ++i)
 			{
-				_obb_vector.push_back(&node.Children[i]);
+				search.push_back(&node.Children[i]);
 			}
 		}
 		else
 		{
 			// This is a leaf node which has collided; test whether it is closer than any current collision
 			intersection = true;
-			if (RayIntersectionResult.tmin < closest_intersection)
+			if (rayresult.tmin < closest_intersection)
 			{
 				// This is closer than the current intersection, so store it
-				OBBIntersectionResult.OBB = &node;
-				OBBIntersectionResult.IntersectionTime = RayIntersectionResult.tmin;
-				OBBIntersectionResult.IntersectionTimeV = XMVectorReplicate(RayIntersectionResult.tmin);
-				OBBIntersectionResult.CollisionPoint = worldray.PositionAtTime(OBBIntersectionResult.IntersectionTimeV); 
-				OBBIntersectionResult.CollisionPointOBBLocal = localray.PositionAtTime(OBBIntersectionResult.IntersectionTimeV);
+				outResult.OBB = &node;
+				outResult.IntersectionTime = rayresult.tmin;
+				outResult.IntersectionTimeV = XMVectorReplicate(rayresult.tmin);
+				outResult.CollisionPoint = worldray.PositionAtTime(outResult.IntersectionTimeV); 
+				outResult.CollisionPointOBBLocal = localray.PositionAtTime(outResult.IntersectionTimeV);
 
 				Ray objray = worldray; 
 				objray.TransformIntoCoordinateSystem(obb.ConstData().Centre, obb.ConstData().Axis);
-				OBBIntersectionResult.CollisionPointObjectLocal = objray.PositionAtTime(OBBIntersectionResult.IntersectionTimeV);					
+				outResult.CollisionPointObjectLocal = objray.PositionAtTime(outResult.IntersectionTimeV);					
 			}
 		}
 	}
 
-	// We have processed all nodes in the OBB hierarchy, so return the intersection flag (results are returned in OBBIntersectionResult)
+	// We have processed all nodes in the OBB hierarchy, so return the intersection flag (results are returned in outResult)
 	return intersection;
 }
 
@@ -2399,7 +2647,7 @@ float GamePhysicsEngine::GetCCDTestDistance(const iActiveObject *object) const
 
 // Determines the closest point on a line segment to the specified point
 XMVECTOR GamePhysicsEngine::ClosestPointOnLineSegment(const FXMVECTOR line_ep1, const FXMVECTOR line_ep2, 
-														 const FXMVECTOR point)
+														 const FXMVECTOR point) const
 {
 	// Inputs taken from http://notmagi.me/closest-point-on-line-aabb-and-obb-to-point/
 
@@ -2418,7 +2666,7 @@ XMVECTOR GamePhysicsEngine::ClosestPointOnLineSegment(const FXMVECTOR line_ep1,
 
 // Determines the closest point on an AABB to the specified point
 XMVECTOR GamePhysicsEngine::ClosestPointOnAABB(	const FXMVECTOR AABB_min, const FXMVECTOR AABB_max, 
-												const FXMVECTOR point )
+												const FXMVECTOR point ) const
 {
 	// Inputs taken from http://notmagi.me/closest-point-on-line-aabb-and-obb-to-point/
 	
@@ -2431,7 +2679,7 @@ XMVECTOR GamePhysicsEngine::ClosestPointOnAABB(	const FXMVECTOR AABB_min, const
 
 
 // Determines the closest point on an OBB to the specified location
-XMVECTOR GamePhysicsEngine::ClosestPointOnOBB(const OrientedBoundingBox::CoreOBBData & obb, const FXMVECTOR point)
+XMVECTOR GamePhysicsEngine::ClosestPointOnOBB(const OrientedBoundingBox::CoreOBBData & obb, const FXMVECTOR point) const
 {
 	// Input taken from http://www.gamedev.net/topic/579584-obb---sphere-collision-detection/, http://notmagi.me/closest-point-on-line-aabb-and-obb-to-point/
 
@@ -2454,7 +2702,7 @@ XMVECTOR GamePhysicsEngine::ClosestPointOnOBB(const OrientedBoundingBox::CoreOBB
 
 // Determines the closest point on an OBB to the specified location.  Also returns an output parameter that indicates how close the point
 // is to the OBB centre in each of the OBB's basis axes.  Any distance < the extent in that axis means the point is inside the OBB.
-XMVECTOR GamePhysicsEngine::ClosestPointOnOBB(const OrientedBoundingBox::CoreOBBData & obb, const FXMVECTOR point, XMVECTOR & outDistance)
+XMVECTOR GamePhysicsEngine::ClosestPointOnOBB(const OrientedBoundingBox::CoreOBBData & obb, const FXMVECTOR point, XMVECTOR & outDistance) const
 {
 	// Get the vector from this point to the centre of the OBB
 	XMVECTOR d = XMVectorSubtract(point, obb.Centre);
@@ -2563,6 +2811,44 @@ bool GamePhysicsEngine::ProcessConsoleCommand(GameConsoleCommand & command)
 		return true;
 	}
 
+	/* Select the broadphase method used for space collision detection */
+	else if (command.InputCommand == "physics_broadphase")
+	{
+		std::string mode = StrLower(command.Parameter(0));
+		if (mode == "octree")		SetBroadphaseMode(BroadphaseMode::OctreeSearch);
+		else if (mode == "sap")		SetBroadphaseMode(BroadphaseMode::SweepAndPrune);
+		else if (mode != NullString) {
+			command.SetOutput(GameConsoleCommand::CommandResult::Failure, ErrorCodes::InvalidParameters,
+				"Invalid parameters.  Usage: \"physics_broadphase [octree | sap]\"");
+			return true;
+		}
+
+		const SweepAndPruneBroadphase::UpdateStatistics & stats = m_sap.GetStatistics();
+		command.SetSuccessOutput(m_broadphase_mode == BroadphaseMode::SweepAndPrune ?
+			concat("Broadphase mode: sweep-and-prune (")(stats.ProxyCount)(" proxies, ")(stats.PairsEmitted)(" pairs, ")
+				(stats.EndpointSwaps)(" swaps")(stats.FullSort ? ", full sort" : "")(")").str() :
+			"Broadphase mode: octree search");
+		return true;
+	}
+
+	/* Select whether narrowphase collision testing is distributed across the worker thread pool */
+	else if (command.InputCommand == "physics_narrowphase")
+	{
+		std::string mode = StrLower(command.Parameter(0));
+		if (mode == "serial")			m_narrowphase_mode = NarrowphaseMode::Serial;
+		else if (mode == "parallel")	m_narrowphase_mode = NarrowphaseMode::Parallel;
+		else if (mode != NullString) {
+			command.SetOutput(GameConsoleCommand::CommandResult::Failure, ErrorCodes::InvalidParameters,
+				"Invalid parameters.  Usage: \"physics_narrowphase [serial | parallel]\"");
+			return true;
+		}
+
+		command.SetSuccessOutput(m_narrowphase_mode == NarrowphaseMode::Parallel ? 
+			concat("Narrowphase mode: parallel (")(Game::WorkerThreads.GetWorkerCount())(" worker threads)").str() :
+			"Narrowphase mode: serial");
+		return true;
+	}
+
 	/* Trigger a collision check between the two specified objects */
 	else if (command.InputCommand == "test_collision")
 	{
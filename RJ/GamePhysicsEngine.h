@@ -3,6 +3,9 @@
 #ifndef __GamePhysicsEngineH__
 #define __GamePhysicsEngineH__
 
+#include <vector>
+#include <utility>
+#include <algorithm>
 #include "DX11_Core.h"
 
 #include "CompilerSettings.h"
@@ -12,6 +15,8 @@
 #include "BasicRay.h"
 #include "OrientedBoundingBox.h"
 #include "CollisionDetectionResultsStruct.h"
+#include "SweepAndPruneBroadphase.h"
+#include "AlignedAllocator.h"
 class iObject;
 class iActiveObject;
 class iSpaceObject;
@@ -44,6 +49,16 @@ public:
 	// Enumeration of the types of collision detection that may be performed
 	enum CollisionDetectionType { Unknown = 0, SphereVsSphere, SphereVsOBB, OBBvsOBB, ContinuousSphereVsSphere, ContinuousSphereVsOBB };
 
+	// Enumeration of the broadphase methods that can be used to identify potentially-colliding pairs of space objects
+	enum BroadphaseMode { OctreeSearch = 0, SweepAndPrune };
+
+	// Enumeration of the ways in which narrowphase testing can be executed.  In parallel mode, narrowphase tests are deferred until
+	// all pairs have been identified and are then distributed across the worker thread pool
+	enum NarrowphaseMode { Serial = 0, Parallel };
+
+	// Number of collision pairs processed per parallel narrowphase job
+	static const int						NARROWPHASE_PARALLEL_GRAIN = 8;
+
 	// Struct holding data on a ray intersection test
 	// Class has no special alignment requirements
 	struct RayIntersectionTestResult
@@ -297,25 +312,65 @@ public:
 	// Checks a single, isolated collision between two object.  Not part of the primary collision detection cycle
 	bool									CheckSingleCollision(iSpaceObject *obj0, iSpaceObject *obj1);
 
-	// Performs hierarchical collision detection between two OBB hierarchies, returning the two OBBs that collided (if applicable)
+	// Returns or sets the broadphase method used for space collision detection.  Default: octree search
+	CMPINLINE BroadphaseMode				GetBroadphaseMode(void) const							{ return m_broadphase_mode; }
+	void									SetBroadphaseMode(BroadphaseMode mode);
+
+	// Returns or sets the method used to execute narrowphase collision tests.  Default: serial
+	CMPINLINE NarrowphaseMode				GetNarrowphaseMode(void) const							{ return m_narrowphase_mode; }
+	CMPINLINE void							SetNarrowphaseMode(NarrowphaseMode mode)				{ m_narrowphase_mode = mode; }
+
+	// Returns a reference to the sweep-and-prune broadphase, e.g. for reporting of broadphase statistics
+	CMPINLINE const SweepAndPruneBroadphase &	GetSweepAndPruneBroadphase(void) const				{ return m_sap; }
+
+	// Sets a collection which will receive the IDs of every pair of space objects passing the broadphase, e.g. to compare the output 
+	// of each broadphase method.  The primary object ID is always first.  Pass NULL to stop recording.  Default: NULL
+	typedef std::vector<std::pair<Game::ID_TYPE, Game::ID_TYPE>>		BroadphasePairRecord;
+	CMPINLINE void							SetBroadphasePairRecord(BroadphasePairRecord *record)	{ m_broadphase_record = record; }
+
+	// Performs hierarchical collision detection between two OBB hierarchies, returning the two OBBs that collided (if applicable).  
+	// SAT results are written to 'result' and no engine state is modified, so independent pairs may be tested concurrently.  All OBBs 
+	// in both hierarchies must be up-to-date before calling concurrently, since invalidated OBBs are otherwise recalculated on demand
 	bool									TestOBBvsOBBHierarchy(	OrientedBoundingBox & obj0, OrientedBoundingBox & obj1, 
-																	OrientedBoundingBox ** ppOutCollider0, OrientedBoundingBox ** ppOutCollider1);
+																	OrientedBoundingBox ** ppOutCollider0, OrientedBoundingBox ** ppOutCollider1, 
+																	CollisionDetectionResult & result) const;
+	CMPINLINE bool							TestOBBvsOBBHierarchy(	OrientedBoundingBox & obj0, OrientedBoundingBox & obj1, 
+																	OrientedBoundingBox ** ppOutCollider0, OrientedBoundingBox ** ppOutCollider1)
+	{
+		return TestOBBvsOBBHierarchy(obj0, obj1, ppOutCollider0, ppOutCollider1, m_collisiontest);
+	}
 
-	// Tests for the intersection of two oriented bounding boxes (OBB)
-	bool									TestOBBvsOBBCollision(const OrientedBoundingBox::CoreOBBData & box0, const OrientedBoundingBox::CoreOBBData & box1);
+	// Tests for the intersection of two oriented bounding boxes (OBB).  SAT results are written to 'result'
+	bool									TestOBBvsOBBCollision(const OrientedBoundingBox::CoreOBBData & box0, const OrientedBoundingBox::CoreOBBData & box1,
+																  CollisionDetectionResult & result) const;
+	CMPINLINE bool							TestOBBvsOBBCollision(const OrientedBoundingBox::CoreOBBData & box0, const OrientedBoundingBox::CoreOBBData & box1)
+	{
+		return TestOBBvsOBBCollision(box0, box1, m_collisiontest);
+	}
 
 	// Returns the result of the last positive space collision test. 'Penetration' will represent either the degree of penetration 
 	// (in case of collision) or separation (if not).  'Penetration' & "BroadphasePenetrationSq' will be set in 
 	// all cases except where Type == SphereVsSphere, in which case only the 'BroadphasePenetrationSq' value will be populated
 	CMPINLINE const CollisionDetectionResult & LastCollisionTest(void) const				{ return m_collisiontest; }
 
-	// Tests for the intersection of a bounding sphere with an OBB collision hierarchy 
+	// Tests for the intersection of a bounding sphere with an OBB collision hierarchy.  Results are written to 'result'
 	bool									TestSpherevsOBBHierarchyCollision(	const FXMVECTOR sphereCentre, const float sphereRadiusSq, 
-																				OrientedBoundingBox & obb, OrientedBoundingBox ** ppOutOBBCollider);
+																				OrientedBoundingBox & obb, OrientedBoundingBox ** ppOutOBBCollider,
+																				CollisionDetectionResult & result) const;
+	CMPINLINE bool							TestSpherevsOBBHierarchyCollision(	const FXMVECTOR sphereCentre, const float sphereRadiusSq, 
+																				OrientedBoundingBox & obb, OrientedBoundingBox ** ppOutOBBCollider)
+	{
+		return TestSpherevsOBBHierarchyCollision(sphereCentre, sphereRadiusSq, obb, ppOutOBBCollider, m_collisiontest);
+	}
 
-	// Tests for the intersection of a bounding sphere and an oriented bounding box (OBB)
+	// Tests for the intersection of a bounding sphere and an oriented bounding box (OBB).  Results are written to 'result'
 	bool									TestSpherevsOBBCollision(const FXMVECTOR sphereCentre, const float sphereRadiusSq, 
-																 	 const OrientedBoundingBox::CoreOBBData & obb);
+																 	 const OrientedBoundingBox::CoreOBBData & obb, CollisionDetectionResult & result) const;
+	CMPINLINE bool							TestSpherevsOBBCollision(const FXMVECTOR sphereCentre, const float sphereRadiusSq, 
+																 	 const OrientedBoundingBox::CoreOBBData & obb)
+	{
+		return TestSpherevsOBBCollision(sphereCentre, sphereRadiusSq, obb, m_collisiontest);
+	}
 
 	// Tests for the intersection of a ray with a sphere.  Returns no details; only whether a collision took place
 	bool									TestRaySphereIntersection(const FXMVECTOR ray_origin, const FXMVECTOR ray_dir,
@@ -357,8 +412,12 @@ public:
 
 	// Tests for the intersection of a ray with an AABB.  Results will be populated with min/max intersection points if an intersection
 	// took place.  If min<max then we have an intersection.  Returns a flag indicating whether the intersection took place.  If 
-	// min<0 then the ray began inside the AABB
-	bool									DetermineRayVsAABBIntersection(const Ray & ray, const AABB & aabb, float t);
+	// min<0 then the ray began inside the AABB.  The overload accepting a result struct does not modify any engine state
+	bool									DetermineRayVsAABBIntersection(const Ray & ray, const AABB & aabb, float t, RayIntersectionTestResult & result) const;
+	CMPINLINE bool							DetermineRayVsAABBIntersection(const Ray & ray, const AABB & aabb, float t)
+	{
+		return DetermineRayVsAABBIntersection(ray, aabb, t, RayIntersectionResult);
+	}
 	CMPINLINE bool							DetermineRayVsAABBIntersection(const Ray & ray, const AABB & aabb)
 	{
 		return DetermineRayVsAABBIntersection(ray, aabb, 1e8f);		// By default, do not limit the extent of the ray by extending it out 100m (secs) in the future
@@ -394,6 +453,12 @@ public:
 	// intersection took place.  If min<0 then the ray began inside the OBB
 	bool									DetermineLineVectorVsOBBHierarchyIntersection(const FXMVECTOR line_pos, const FXMVECTOR line_delta, OrientedBoundingBox & obb);
 
+	// Thread-safe equivalent of the line vector vs OBB hierarchy test.  Results are written to 'outResult', and 'search' is used as
+	// working storage for the hierarchy traversal, so no engine state is modified.  The OBB hierarchy must already be up-to-date, 
+	// since invalidated OBBs are otherwise recalculated on demand
+	bool									DetermineLineVectorVsOBBHierarchyIntersection(const FXMVECTOR line_pos, const FXMVECTOR line_delta, OrientedBoundingBox & obb,
+																						  OBBIntersectionData & outResult, std::vector<OrientedBoundingBox*> & search) const;
+
 	// Debug version of line vector vs OBB hierarchy testing method.  Returns the collection of OBBs that were tested, along with the 
 	// eventual collider, in case a collision is detected
 #	ifdef _DEBUG
@@ -425,18 +490,18 @@ public:
 	
 	// Determines the closest point on a line segment to the specified point
 	XMVECTOR								ClosestPointOnLineSegment(	const FXMVECTOR line_ep1, const FXMVECTOR line_ep2, 
-																		const FXMVECTOR point );
+																		const FXMVECTOR point ) const;
 
 	// Determines the closest point on an AABB to the specified point
 	XMVECTOR								ClosestPointOnAABB(	const FXMVECTOR AABB_min, const FXMVECTOR AABB_max, 
-																const FXMVECTOR point );
+																const FXMVECTOR point ) const;
 
 	// Determines the closest point on an OBB to the specified point
-	XMVECTOR								ClosestPointOnOBB(const OrientedBoundingBox::CoreOBBData & obb, const FXMVECTOR point);
+	XMVECTOR								ClosestPointOnOBB(const OrientedBoundingBox::CoreOBBData & obb, const FXMVECTOR point) const;
 
 	// Determines the closest point on an OBB to the specified location.  Also returns an output parameter that indicates how close the point
 	// is to the OBB centre in each of the OBB's basis axes.  Any distance < the extent in that axis means the point is inside the OBB.
-	XMVECTOR								ClosestPointOnOBB(const OrientedBoundingBox::CoreOBBData & obb, const FXMVECTOR point, XMVECTOR & outDistance);
+	XMVECTOR								ClosestPointOnOBB(const OrientedBoundingBox::CoreOBBData & obb, const FXMVECTOR point, XMVECTOR & outDistance) const;
 
 	// Struct holding data on an impact between two objects
 	ImpactData								ObjectImpact;
@@ -481,11 +546,61 @@ public:
 protected:
 
 	// Checks for a broadphase collision between the two objects.  No parameter checking since this should only be called internally on pre-validated parameters
-	CMPINLINE bool							CheckBroadphaseCollision(const iObject *obj0, const iObject *obj1);
-	CMPINLINE bool							CheckBroadphaseCollision(const FXMVECTOR pos0, float collisionradius0, const FXMVECTOR pos1, float collisionradius1);
+	CMPINLINE bool							CheckBroadphaseCollision(const iObject *obj0, const iObject *obj1, CollisionDetectionResult & result) const;
+	CMPINLINE bool							CheckBroadphaseCollision(const FXMVECTOR pos0, float collisionradius0, const FXMVECTOR pos1, float collisionradius1,
+																	 CollisionDetectionResult & result) const;
+	CMPINLINE bool							CheckBroadphaseCollision(const iObject *obj0, const iObject *obj1)
+	{
+		return CheckBroadphaseCollision(obj0, obj1, m_collisiontest);
+	}
+	CMPINLINE bool							CheckBroadphaseCollision(const FXMVECTOR pos0, float collisionradius0, const FXMVECTOR pos1, float collisionradius1)
+	{
+		return CheckBroadphaseCollision(pos0, collisionradius0, pos1, collisionradius1, m_collisiontest);
+	}
+
+	// Performs collision detection across the given set of objects, searching the spatial partitioning tree around each object in turn
+	void									PerformOctreeSearchSpaceCollisionDetection(const std::vector<iObject*> & objects);
+
+	// Performs collision detection across the given set of objects using the persistent sweep-and-prune broadphase.  Passive colliders
+	// are gathered by a single search about the focal object, widened to cover everything the per-object search could reach
+	void									PerformSweepAndPruneSpaceCollisionDetection(iSpaceObject *focalobject, float radius, const std::vector<iObject*> & objects);
+
+	// Determines the maximum distance from an object in scope at which the per-object search could locate a collision candidate,
+	// based on the largest collision sphere in scope plus the distance it can travel in a single frame
+	float									DetermineSpaceCollisionScopeExtent(const std::vector<iObject*> & objects) const;
+
+	// Indicates whether the given object is one of the objects in scope for the current space collision detection cycle
+	CMPINLINE bool							IsInSpaceCollisionScope(Game::ID_TYPE id) const
+	{
+		return std::binary_search(m_collision_scope.begin(), m_collision_scope.end(), id);
+	}
+
+	// Either tests and handles the pair immediately, or queues it for the deferred parallel narrowphase, depending on the narrowphase mode
+	void									ProcessSpaceCollisionPair(iSpaceObject *object, iSpaceObject *candidate);
+
+	// Tests a single pair of space objects for collision, applying collision response if required.  Applies all standard 
+	// exclusions before testing.  Returns a flag indicating whether a collision occurred
+	bool									TestAndHandleSpaceCollisionPair(iSpaceObject *object, iSpaceObject *candidate);
+
+	// Applies all standard exclusions to a pair of space objects and then performs a broadphase test.  Returns a flag
+	// indicating whether the pair should proceed to narrowphase testing
+	bool									TestSpaceCollisionPairBroadphase(iSpaceObject *object, iSpaceObject *candidate, CollisionDetectionResult & result);
+
+	// Applies collision response to a pair of space objects which have been determined to be colliding
+	void									ApplySpaceCollisionResponse(iSpaceObject *object, iSpaceObject *candidate, 
+																		OrientedBoundingBox *collider0, OrientedBoundingBox *collider1);
+
+	// Executes narrowphase testing for all queued pairs across the worker thread pool, and then applies collision 
+	// response for each colliding pair serially, in the order in which pairs were queued
+	void									ExecuteDeferredNarrowphase(void);
 
 	// Performs full collision detection between the two objects.  No parameter checking since this should only be called internally on pre-validated parameters
-	bool									CheckFullCollision(iObject *obj0, iObject *obj1, OrientedBoundingBox ** ppOutCollider0, OrientedBoundingBox ** ppOutCollider1);
+	bool									CheckFullCollision(iObject *obj0, iObject *obj1, OrientedBoundingBox ** ppOutCollider0, OrientedBoundingBox ** ppOutCollider1,
+															   CollisionDetectionResult & result) const;
+	CMPINLINE bool							CheckFullCollision(iObject *obj0, iObject *obj1, OrientedBoundingBox ** ppOutCollider0, OrientedBoundingBox ** ppOutCollider1)
+	{
+		return CheckFullCollision(obj0, obj1, ppOutCollider0, ppOutCollider1, m_collisiontest);
+	}
 
 	// Determines collision response between two objects that we have determined are colliding.  Collider0/1 are pointers to
 	// the specific OBB within each object that is colliding; this can be NULL, in which case we consider the object as a 
@@ -530,6 +645,41 @@ protected:
 	unsigned int							m_static_cd_counter;
 	bool									m_cd_include_static;
 
+	// Broadphase method used for space collision detection, and the persistent sweep-and-prune structure if it is in use
+	BroadphaseMode							m_broadphase_mode;
+	SweepAndPruneBroadphase					m_sap;
+
+	// IDs of the candidates located around each object by the octree-search broadphase.  Retains its storage between searches
+	std::vector<Game::ID_TYPE>				m_broadphase_candidates;
+
+	// Sorted IDs of the objects in scope for the current space collision detection cycle, and the full set of colliders within reach 
+	// of those objects which is passed to the sweep-and-prune broadphase.  Both retain their storage between cycles
+	std::vector<Game::ID_TYPE>				m_collision_scope;
+	std::vector<iObject*>					m_sap_objects;
+
+	// Optional record of all pairs passing the space broadphase
+	BroadphasePairRecord *					m_broadphase_record;
+
+	// Pair of space objects queued for deferred narrowphase testing, along with the results of that test
+	// Class is 16-bit aligned to allow use of SIMD member variables
+	__declspec(align(16))
+	struct NarrowphasePair : public ALIGN16<NarrowphasePair>
+	{
+		CollisionDetectionResult			Result;
+		iSpaceObject *						Object;
+		iSpaceObject *						Candidate;
+		OrientedBoundingBox *				Collider0;
+		OrientedBoundingBox *				Collider1;
+		bool								Colliding;
+
+		NarrowphasePair(iSpaceObject *object, iSpaceObject *candidate)
+			: Object(object), Candidate(candidate), Collider0(NULL), Collider1(NULL), Colliding(false) { }
+	};
+
+	// Method used to execute narrowphase tests, and the set of pairs queued for deferred narrowphase testing
+	NarrowphaseMode							m_narrowphase_mode;
+	std::vector<NarrowphasePair, AlignedAllocator<NarrowphasePair, 16U>>	m_narrowphase_pairs;
+
 	// Fields used for collision engine debugging
 #	ifdef RJ_ENABLE_ENTITY_PHYSICS_DEBUGGING
 	enum PhysicsDebugType { PhysicsDebugDisabled = 0, PhysicsDebugOnTest = 1, PhysicsDebugOnBroadphase = 2 , PhysicsDebugOnCollision = 4, PhysicsDebugLogOBBTests = 8 };
@@ -556,8 +706,6 @@ protected:
 #	endif
 
 	// Temporary variables to avoid multiple reallocations per physics cycle
-	AXMVECTOR								_diffpos;
-	float									_distsq, _r1r2;
 	OrientedBoundingBox::CoreOBBData		_obbdata;
 	std::vector<OrientedBoundingBox*>		_obb_vector;
 	std::vector<iEnvironmentObject*>			_envobj;
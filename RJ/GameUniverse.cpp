@@ -3,6 +3,8 @@
 #include "DX11_Core.h"
 #include "Logging.h"
 #include "SpaceSystem.h"
+#include "CoreEngine.h"
+#include "GameVarsExtern.h"
 
 #include "GameUniverse.h"
 
@@ -91,6 +93,19 @@ void GameUniverse::SetCurrentSystem(SpaceSystem * sys)
 void GameUniverse::CurrentSystemChanged(SpaceSystem & old_system, SpaceSystem & new_system)
 {
 	OutputDebugString(concat("=== Current system changed from  ")(old_system.DebugString())(" to ")(new_system.DebugString())("\n").str().c_str());
+
+	// Begin streaming in the assets required by the new system, ahead of them being rendered
+	Game::Engine->GetAssetResidency().PrefetchSystem(new_system);
+}
+
+// Simulates the interior of all environments queued for batch simulation in each system
+void GameUniverse::SimulateQueuedEnvironments(void)
+{
+	SystemRegister::iterator it_end = Systems.end();
+	for (SystemRegister::iterator it = Systems.begin(); it != it_end; ++it)
+	{
+		if (it->second) it->second->SimulateQueuedEnvironments();
+	}
 }
 
 // Termination function: Clears all universe and system data
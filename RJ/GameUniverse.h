@@ -35,6 +35,9 @@ public:
 	// Event raised when the current system changes
 	void						CurrentSystemChanged(SpaceSystem & old_system, SpaceSystem & new_system);
 
+	// Simulates the interior of all environments queued for batch simulation in each system
+	void						SimulateQueuedEnvironments(void);
+
 	// Shuts down and deallocates all resources used by the universe & component systems
 	void						TerminateUniverse(void);
 
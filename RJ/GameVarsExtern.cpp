@@ -8,6 +8,7 @@
 #include "GameInput.h"
 #include "CentralScheduler.h"
 #include "GamePhysicsEngine.h"
+#include "WorkerThreadPool.h"
 #include "SimulationStateManager.h"
 #include "FactionManagerObject.h"
 #include "LogManager.h"
@@ -102,6 +103,9 @@ namespace Game {
 	// Collision manager, which performs all collision detection and response determination each cycle
 	GamePhysicsEngine				PhysicsEngine = GamePhysicsEngine();
 
+	// Pool of worker threads available for data-parallel work
+	WorkerThreadPool				WorkerThreads;
+
 	// The game universe
 	GameUniverse *					Universe;
 
@@ -33,6 +33,7 @@ class Ship;
 class Actor;
 class Player;
 class GamePhysicsEngine;
+class WorkerThreadPool;
 class SimulationStateManager;
 class FactionManagerObject;
 class LogManager;
@@ -110,6 +111,9 @@ namespace Game {
 	// Collision manager, which performs all collision detection and response determination each cycle
 	extern GamePhysicsEngine PhysicsEngine;
 
+	// Pool of worker threads available for data-parallel work
+	extern WorkerThreadPool WorkerThreads;
+
 	// The game universe
 	extern GameUniverse	*Universe;
 
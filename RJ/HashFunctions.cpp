@@ -1,7 +1,7 @@
 #include "HashFunctions.h"
 
 // Define the seed value to be used for generating standard (non-cryptographic) hashes
-const HashVal HashStandardSeed = 0xB0F57EE3;
+const HashVal HashStandardSeed = HASH_STANDARD_SEED;
 
 
 // Hash function to generate a hash from a given string input.  32-bit.  More advanced hash functions, and functions able to 
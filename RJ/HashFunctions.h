@@ -14,9 +14,11 @@ typedef uint32_t HashVal;
 
 // Define the seed value to be used for generating standard (non-cryptographic) hashes
 extern const HashVal HashStandardSeed;
+constexpr HashVal HASH_STANDARD_SEED = 0xB0F57EE3;
 
-// Macro used to define a standard hash value
-#define DefineHash(Hash, Str) const PreHashedStringType Hash = PreHashedStringType(Str);
+// Macro used to define a standard hash value.  Also defines a compile-time constant 'C<Hash>' holding the same hash 
+// value, for use in constant expressions such as case labels
+#define DefineHash(Hash, Str) const PreHashedStringType Hash = PreHashedStringType(Str); constexpr HashVal C##Hash = ConstHashString(Str);
 
 // Hash function to generate a hash from a given string input.  32-bit.  More advanced hash functions, and functions able to 
 // handle much larger input volumes, at http://code.google.com/p/smhasher/wiki/MurmurHash3
@@ -27,6 +29,58 @@ CMPINLINE HashVal HashString(const std::string & str) { return ExecuteHash(str.c
 CMPINLINE HashVal HashString(const char *str) { return ExecuteHash(str, (HashVal)strlen(str), HashStandardSeed); }
 CMPINLINE HashVal HashString(const char *str, HashVal len) { return ExecuteHash(str, len, HashStandardSeed); }
 
+// Compile-time equivalent of ExecuteHash, for use in constant expressions.  Input blocks are assembled byte-by-byte in
+// little-endian order, which matches the runtime implementation on all supported platforms
+constexpr HashVal ConstExecuteHash(const char *key, HashVal len, HashVal seed)
+{
+	uint32_t hash = seed;
+
+	const HashVal nblocks = len / 4U;
+	for (HashVal i = 0U; i < nblocks; ++i)
+	{
+		uint32_t k = ((uint32_t)(uint8_t)key[i * 4U]) | ((uint32_t)(uint8_t)key[i * 4U + 1U] << 8) |
+					 ((uint32_t)(uint8_t)key[i * 4U + 2U] << 16) | ((uint32_t)(uint8_t)key[i * 4U + 3U] << 24);
+		k *= 0xcc9e2d51U;
+		k = (k << 15) | (k >> 17);
+		k *= 0x1b873593U;
+
+		hash ^= k;
+		hash = ((hash << 13) | (hash >> 19)) * 5U + 0xe6546b64U;
+	}
+
+	const HashVal tail = (nblocks * 4U);
+	uint32_t k1 = 0U;
+
+	switch (len & 3U) {
+	case 3:
+		k1 ^= (uint32_t)(uint8_t)key[tail + 2U] << 16;
+		[[fallthrough]];
+	case 2:
+		k1 ^= (uint32_t)(uint8_t)key[tail + 1U] << 8;
+		[[fallthrough]];
+	case 1:
+		k1 ^= (uint32_t)(uint8_t)key[tail];
+
+		k1 *= 0xcc9e2d51U;
+		k1 = (k1 << 15) | (k1 >> 17);
+		k1 *= 0x1b873593U;
+		hash ^= k1;
+	}
+
+	hash ^= len;
+	hash ^= (hash >> 16);
+	hash *= 0x85ebca6bU;
+	hash ^= (hash >> 13);
+	hash *= 0xc2b2ae35U;
+	hash ^= (hash >> 16);
+
+	return hash;
+}
+
+// Compile-time hash of a null-terminated string literal, equal to HashString() of the same string at runtime
+constexpr HashVal ConstStringLength(const char *str) { HashVal n = 0U; while (str[n] != 0) ++n; return n; }
+constexpr HashVal ConstHashString(const char *str) { return ConstExecuteHash(str, ConstStringLength(str), HASH_STANDARD_SEED); }
+
 // Structure used to store pre-hashed text strings
 struct PreHashedStringType
 {
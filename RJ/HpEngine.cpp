@@ -194,7 +194,7 @@ void HpEngine::InitialiseEngineThrustEmitter()
 	if (!m_emitter->HaveParentAttachment())
 	{
 		delete m_emitter; m_emitter = NULL;
-		delete p; p = NULL;
+		Game::Engine->GetParticleEngine()->ShutdownParticleEmitter(p->GetHandle()); p = NULL;
 		return;
 	}
 	
@@ -0,0 +1,178 @@
+#include <vector>
+#include <thread>
+#include "Utility.h"
+#include "Logging.h"
+#include "WorkerThreadPool.h"
+
+#include "JobGraph.h"
+
+
+// Default constructor
+JobGraph::JobGraph(void)
+	:
+	m_jobcount(0), m_pool(NULL), m_pending_capacity(0), m_remaining(0), m_calling_thread_next(0U)
+{
+}
+
+// Adds a job to the graph, returning its ID
+JobGraph::JobID JobGraph::AddJob(const JobFunction & fn, JobAffinity affinity)
+{
+	// Reuse existing storage where possible, to avoid reallocating dependency lists each time the graph is rebuilt
+	if (m_jobcount == (int)m_jobs.size()) m_jobs.push_back(Job());
+
+	Job & job = m_jobs[m_jobcount];
+	job.Function = fn;
+	job.Affinity = affinity;
+	job.Dependents.clear();
+	job.DependencyCount = 0;
+	job.ExecutionTime = Timers::GetZeroDuration();
+
+	return (m_jobcount++);
+}
+
+// Declares that 'job' may not begin until 'prerequisite' has completed
+bool JobGraph::AddDependency(JobID job, JobID prerequisite)
+{
+	if (job < 0 || job >= m_jobcount || prerequisite < 0 || prerequisite >= m_jobcount || job == prerequisite) return false;
+
+	m_jobs[prerequisite].Dependents.push_back(job);
+	++m_jobs[job].DependencyCount;
+	return true;
+}
+
+// Tests whether the dependencies form a valid acyclic graph
+bool JobGraph::ValidateDependencies(void)
+{
+	// Topological traversal; every job will be visited if and only if there are no cycles
+	m_validation.clear();
+	std::vector<int> pending(m_jobcount);
+	for (int i = 0; i < m_jobcount; ++i)
+	{
+		pending[i] = m_jobs[i].DependencyCount;
+		if (pending[i] == 0) m_validation.push_back(i);
+	}
+
+	for (size_t i = 0U; i < m_validation.size(); ++i)
+	{
+		for (JobID dependent : m_jobs[m_validation[i]].Dependents)
+		{
+			if (--pending[dependent] == 0) m_validation.push_back(dependent);
+		}
+	}
+
+	return ((int)m_validation.size() == m_jobcount);
+}
+
+// Executes every job in the graph and blocks until all have completed
+bool JobGraph::Execute(WorkerThreadPool & pool)
+{
+	if (m_jobcount == 0) return true;
+
+	// A cyclic graph can never complete.  Fall back to serial execution so that every job still runs once
+	if (!ValidateDependencies())
+	{
+		Game::Log << LOG_ERROR << "Job graph contains a dependency cycle; executing " << m_jobcount << " jobs serially\n";
+		for (int i = 0; i < m_jobcount; ++i)
+		{
+			Timers::HRClockTime start = Timers::GetHRClockTime();
+			m_jobs[i].Function();
+			m_jobs[i].ExecutionTime = Timers::GetMillisecondDuration(start, Timers::GetHRClockTime());
+		}
+		return false;
+	}
+
+	// Initialise execution state
+	if (m_pending_capacity < m_jobcount)
+	{
+		m_pending_capacity = m_jobcount;
+		m_pending.reset(new std::atomic<int>[m_pending_capacity]);
+	}
+	for (int i = 0; i < m_jobcount; ++i) m_pending[i].store(m_jobs[i].DependencyCount);
+
+	m_pool = &pool;
+	m_remaining.store(m_jobcount);
+	m_calling_thread_ready.clear();
+	m_calling_thread_next = 0U;
+
+	// Dispatch all jobs which have no dependencies.  Pool jobs are dispatched first so that workers can begin
+	// immediately, while the calling thread works through its own jobs
+	for (int i = 0; i < m_jobcount; ++i)
+	{
+		if (m_jobs[i].DependencyCount == 0 && m_jobs[i].Affinity == JobAffinity::AnyThread) DispatchJob(i);
+	}
+	for (int i = 0; i < m_jobcount; ++i)
+	{
+		if (m_jobs[i].DependencyCount == 0 && m_jobs[i].Affinity == JobAffinity::CallingThread) DispatchJob(i);
+	}
+
+	// Execute calling-thread jobs as they become ready, and otherwise help with pool work until the graph is complete
+	while (m_remaining.load() > 0)
+	{
+		JobID job = PopCallingThreadJob();
+		if (job != INVALID_JOB)
+		{
+			RunJob(job);
+		}
+		else if (!pool.TryExecuteJob())
+		{
+			std::this_thread::yield();
+		}
+	}
+
+	m_pool = NULL;
+	return true;
+}
+
+// Executes the given job, then dispatches any dependent jobs which are now ready
+void JobGraph::RunJob(JobID id)
+{
+	Job & job = m_jobs[id];
+
+	Timers::HRClockTime start = Timers::GetHRClockTime();
+	job.Function();
+	job.ExecutionTime = Timers::GetMillisecondDuration(start, Timers::GetHRClockTime());
+
+	// The last prerequisite to complete is responsible for dispatching each dependent job
+	for (JobID dependent : job.Dependents)
+	{
+		if (m_pending[dependent].fetch_sub(1) == 1) DispatchJob(dependent);
+	}
+
+	// Completion is only signalled once all dependents are dispatched, so the graph cannot be released beneath us
+	m_remaining.fetch_sub(1);
+}
+
+// Dispatches a job which is ready to execute, either to the pool or to the calling thread queue
+void JobGraph::DispatchJob(JobID job)
+{
+	if (m_jobs[job].Affinity == JobAffinity::CallingThread)
+	{
+		std::lock_guard<std::mutex> lock(m_calling_thread_lock);
+		m_calling_thread_ready.push_back(job);
+	}
+	else
+	{
+		m_pool->Submit([this, job]() { RunJob(job); });
+	}
+}
+
+// Retrieves the next ready calling-thread job, or INVALID_JOB if none are available
+JobGraph::JobID JobGraph::PopCallingThreadJob(void)
+{
+	std::lock_guard<std::mutex> lock(m_calling_thread_lock);
+	if (m_calling_thread_next >= m_calling_thread_ready.size()) return INVALID_JOB;
+
+	return m_calling_thread_ready[m_calling_thread_next++];
+}
+
+// Removes all jobs from the graph.  Storage is retained for reuse
+void JobGraph::Clear(void)
+{
+	for (int i = 0; i < m_jobcount; ++i) m_jobs[i].Function = nullptr;
+	m_jobcount = 0;
+}
+
+// Default destructor
+JobGraph::~JobGraph(void)
+{
+}
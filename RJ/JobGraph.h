@@ -0,0 +1,113 @@
+#pragma once
+
+#ifndef __JobGraphH__
+#define __JobGraphH__
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include "CompilerSettings.h"
+#include "Timers.h"
+class WorkerThreadPool;
+
+
+// Graph of jobs with declared dependencies, executed on the worker thread pool.  A job is dispatched as soon as every job
+// it depends on has completed, so independent jobs may run concurrently and in any order while dependent jobs always
+// run in their declared order.  Jobs may also be restricted to the thread which executes the graph, for work that is
+// not safe to run elsewhere.  The graph retains its storage between executions so it can be rebuilt cheaply each frame
+// Class has no special alignment requirements
+class JobGraph
+{
+public:
+
+	// Identifier of a job within the graph
+	typedef int											JobID;
+
+	// Function executed by a job
+	typedef std::function<void(void)>					JobFunction;
+
+	// Determines which threads are permitted to execute a job
+	enum JobAffinity
+	{
+		AnyThread = 0,				// The job may execute on any worker, or on the thread executing the graph
+		CallingThread				// The job will only ever execute on the thread executing the graph
+	};
+
+	// Value returned for invalid job IDs
+	static const JobID									INVALID_JOB = -1;
+
+	// Default constructor
+	JobGraph(void);
+
+	// Adds a job to the graph, returning its ID
+	JobID												AddJob(const JobFunction & fn, JobAffinity affinity = JobAffinity::AnyThread);
+
+	// Declares that 'job' may not begin until 'prerequisite' has completed.  Returns false if either job is invalid
+	bool												AddDependency(JobID job, JobID prerequisite);
+
+	// Returns the number of jobs in the graph
+	CMPINLINE int										GetJobCount(void) const						{ return m_jobcount; }
+
+	// Executes every job in the graph and blocks until all have completed.  The calling thread executes all
+	// calling-thread jobs and otherwise helps to execute pool work.  Returns false if the dependencies contain a cycle,
+	// in which case all jobs are instead executed serially on the calling thread in the order they were added
+	bool												Execute(WorkerThreadPool & pool);
+
+	// Returns the time taken to execute the given job during the last execution of the graph
+	CMPINLINE Timers::HRClockDuration					GetJobExecutionTime(JobID job) const		{ return m_jobs[job].ExecutionTime; }
+
+	// Removes all jobs from the graph.  Storage is retained for reuse
+	void												Clear(void);
+
+	// Default destructor
+	~JobGraph(void);
+
+protected:
+
+	// Details of a single job in the graph
+	// Class has no special alignment requirements
+	struct Job
+	{
+		JobFunction										Function;
+		JobAffinity										Affinity;
+		std::vector<JobID>								Dependents;					// Jobs which are waiting on this job
+		int												DependencyCount;			// Number of jobs which this job is waiting on
+		Timers::HRClockDuration							ExecutionTime;
+	};
+
+	// Tests whether the dependencies form a valid acyclic graph
+	bool												ValidateDependencies(void);
+
+	// Executes the given job, then dispatches any dependent jobs which are now ready
+	void												RunJob(JobID job);
+
+	// Dispatches a job which is ready to execute, either to the pool or to the calling thread queue
+	void												DispatchJob(JobID job);
+
+	// Retrieves the next ready calling-thread job, or INVALID_JOB if none are available
+	JobID												PopCallingThreadJob(void);
+
+protected:
+
+	std::vector<Job>									m_jobs;						// Storage is retained between executions, so
+	int													m_jobcount;					// only the first m_jobcount entries are valid
+
+	// Execution state; only valid during a call to Execute()
+	WorkerThreadPool *									m_pool;
+	std::unique_ptr<std::atomic<int>[]>					m_pending;					// Outstanding dependencies per job
+	int													m_pending_capacity;
+	std::atomic<int>									m_remaining;				// Jobs which have not yet completed
+
+	// Ready jobs which must be executed by the calling thread, in the order they became ready
+	std::mutex											m_calling_thread_lock;
+	std::vector<JobID>									m_calling_thread_ready;
+	size_t												m_calling_thread_next;
+
+	// Working buffer used for dependency validation
+	std::vector<int>									m_validation;
+};
+
+
+#endif
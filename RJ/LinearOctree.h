@@ -0,0 +1,578 @@
+#pragma once
+
+#ifndef __LinearOctreeH__
+#define __LinearOctreeH__
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <unordered_map>
+#include <algorithm>
+#include <stdint.h>
+#include "CompilerSettings.h"
+#include "Utility.h"
+#include "GameVarsExtern.h"
+#include "RadixSort.h"
+#include "DX11_Core.h"
+
+// Linear (Morton-coded) alternative to the pointer-based Octree.  Items are bucketed into cells at a fixed leaf depth,
+// and all item data is held in contiguous SoA streams sorted by the Morton code of the containing cell.  Every node
+// of the implicit tree therefore maps to a contiguous range of items, and the whole structure can be re-bucketed in
+// a single linear pass via BatchUpdatePositions rather than by per-object ItemMoved calls.  Individual add/remove/move
+// operations are supported for API compatibility with Octree<T>, and are applied lazily at the next rebuild or query
+// T is expected to be a pointer type exposing GetID() and GetPosition(), e.g. iObject*
+// Class has no special alignment requirements
+template <typename T>
+class LinearOctree
+{
+public:
+
+	// Morton code type; 10 bits per axis are interleaved into the lowest 30 bits
+	typedef uint32_t								MortonCode;
+
+	// Maximum supported tree depth, limited by the number of bits per axis in each Morton code
+	static const unsigned int						MAXIMUM_DEPTH = 10U;
+
+	// Constructor.  Params specify the minimum position, and length of each edge of the covered area.  Leaf depth is
+	// derived from the area size so that leaf cells are no smaller than C_OCTREE_MIN_NODE_SIZE
+	LinearOctree(FXMVECTOR position, float areasize);
+
+	// Adds an item to the tree.  Returns a flag indicating whether the item was accepted; items outside the bounds
+	// of the tree are rejected, as with Octree<T>
+	bool											AddItem(T item, const FXMVECTOR pos);
+
+	// Removes an item from the tree.  Removal is deferred; the item slot is released at the next rebuild
+	void											RemoveItem(T item);
+
+	// Records the new position of an item that is already part of the tree.  Items that move outside the tree bounds
+	// are removed, consistent with the behaviour of Octree<T>.  Re-bucketing is deferred until the next rebuild
+	void											ItemMoved(T item, const FXMVECTOR pos);
+
+	// Re-reads the position of every item in the tree, then re-buckets all items in a single linear sweep
+	void											BatchUpdatePositions(void);
+
+	// Re-reads the position of only the specified items, then re-buckets all items in a single linear sweep
+	void											BatchUpdatePositions(const std::vector<T> & moved_items);
+
+	// Returns the set of all items within the tree
+	void											GetItems(std::vector<T> & outResult);
+
+	// Returns the set of items held within the specified node of the implicit tree.  'depth' is the node depth (0 == root)
+	// and 'node_code' is the Morton code of the node at that depth
+	void											GetItemsInNode(unsigned int depth, MortonCode node_code, std::vector<T> & outResult);
+
+	// Returns all items whose position lies within the specified bounds.  Returns the number of items located
+	int												GetItemsWithinBounds(const FXMVECTOR vmin, const FXMVECTOR vmax, std::vector<T> & outResult);
+
+	// Returns all items whose position lies within the specified distance of a point.  Returns the number of items located
+	int												GetItemsWithinDistance(const FXMVECTOR position, float distance, std::vector<T> & outResult);
+
+	// Returns the ID of all items whose position lies within the specified distance of a point.  Operates entirely on
+	// the SoA streams and never dereferences the items themselves.  Returns the number of items located
+	int												GetItemIDsWithinDistance(const FXMVECTOR position, float distance, std::vector<Game::ID_TYPE> & outResult);
+
+	// Applies any pending additions, removals and movements, and re-sorts the item streams if required
+	void											Rebuild(void);
+
+	// Determines whether the tree contains the specified point.  Simple comparison to tree bounds
+	CMPINLINE bool									ContainsPoint(const FXMVECTOR point) const;
+
+	// Returns the Morton code of the leaf cell containing the specified point.  Points outside the tree are clamped
+	CMPINLINE MortonCode							GetLeafCode(const FXMVECTOR point) const;
+
+	// Inline accessor methods for key properties
+	CMPINLINE float									GetAreaSize(void) const				{ return m_areasize; }
+	CMPINLINE float									GetLeafCellSize(void) const			{ return m_cellsize; }
+	CMPINLINE unsigned int							GetDepth(void) const				{ return m_depth; }
+	CMPINLINE int									GetItemCount(void) const			{ return (int)m_index.size(); }
+	CMPINLINE bool									RequiresRebuild(void) const			{ return m_dirty; }
+
+	// Returns the number of occupied leaf cells following the last rebuild
+	CMPINLINE int									GetOccupiedCellCount(void) const	{ return (int)m_cellcodes.size(); }
+
+	// Spreads the lowest 10 bits of a value so that there are two zero bits between each, for Morton interleaving
+	CMPINLINE static uint32_t						SpreadBits3(uint32_t v)
+	{
+		v &= 0x000003ff;
+		v = (v | (v << 16)) & 0xff0000ff;
+		v = (v | (v << 8)) & 0x0300f00f;
+		v = (v | (v << 4)) & 0x030c30c3;
+		v = (v | (v << 2)) & 0x09249249;
+		return v;
+	}
+
+	// Inverse of SpreadBits3; compacts every third bit back into the lowest 10 bits
+	CMPINLINE static uint32_t						CompactBits3(uint32_t v)
+	{
+		v &= 0x09249249;
+		v = (v ^ (v >> 2)) & 0x030c30c3;
+		v = (v ^ (v >> 4)) & 0x0300f00f;
+		v = (v ^ (v >> 8)) & 0xff0000ff;
+		v = (v ^ (v >> 16)) & 0x000003ff;
+		return v;
+	}
+
+	// Encodes and decodes Morton codes from integer cell coordinates
+	CMPINLINE static MortonCode						EncodeMorton(uint32_t x, uint32_t y, uint32_t z)	{ return (SpreadBits3(x) | (SpreadBits3(y) << 1) | (SpreadBits3(z) << 2)); }
+	CMPINLINE static void							DecodeMorton(MortonCode code, uint32_t & outX, uint32_t & outY, uint32_t & outZ)
+	{
+		outX = CompactBits3(code); outY = CompactBits3(code >> 1); outZ = CompactBits3(code >> 2);
+	}
+
+	// Shutdown method.  Releases all item data
+	void											Shutdown(void);
+
+	// Debug method to generate a string output of the tree and its occupied cells
+	std::string										DebugOutput(void);
+
+	// Default destructor
+	~LinearOctree(void);
+
+protected:
+
+	// Converts a world-space coordinate to a (clamped) leaf cell coordinate along one axis
+	CMPINLINE uint32_t								CellCoord(float value, float axis_min) const
+	{
+		int c = (int)((value - axis_min) * m_cellsize_recip);
+		return (uint32_t)(c < 0 ? 0 : (c > m_maxcell ? m_maxcell : c));
+	}
+
+	// Updates the stored position of the item at the given index; returns false if the item has left the tree bounds
+	CMPINLINE bool									UpdateItemPosition(uint32_t index, const FXMVECTOR pos);
+
+	// Releases the item at the given index.  Slot is compacted at the next rebuild
+	CMPINLINE void									ReleaseItem(uint32_t index);
+
+	// Core query method; invokes the supplied function for every item index whose position lies within the given bounds
+	template <typename TFunc>
+	void											_Query(const XMFLOAT3 & fmin, const XMFLOAT3 & fmax, TFunc Func);
+
+protected:
+
+	// Tree bounds, plus the total size of the grid handled by the tree.  Must be cubic
+	XMFLOAT3										m_min, m_max;
+	float											m_areasize;
+
+	// Leaf cell parameters
+	unsigned int									m_depth;
+	float											m_cellsize, m_cellsize_recip;
+	int												m_maxcell;
+
+	// SoA item streams.  Sorted by m_codes following each rebuild.  Released slots hold a NULL item until compacted
+	std::vector<T>									m_items;
+	std::vector<Game::ID_TYPE>						m_ids;
+	std::vector<float>								m_x, m_y, m_z;
+	std::vector<MortonCode>							m_codes;
+
+	// Map from item ID to its current index in the item streams
+	std::unordered_map<Game::ID_TYPE, uint32_t>		m_index;
+
+	// Occupied leaf cells, sorted by Morton code, and the starting index of each cell in the item streams.  m_cellstart
+	// holds one additional entry marking the end of the final cell
+	std::vector<MortonCode>							m_cellcodes;
+	std::vector<uint32_t>							m_cellstart;
+
+	// Flag indicating that the streams have pending changes and must be rebuilt before the next query
+	bool											m_dirty;
+	uint32_t										m_releasedcount;
+
+	// Scratch buffers retained between rebuilds to avoid per-frame allocation
+	std::vector<uint32_t>							m_sortorder, m_sortscratch;
+	std::vector<T>									m_tmpitems;
+	std::vector<Game::ID_TYPE>						m_tmpids;
+	std::vector<float>								m_tmpfloat;
+	std::vector<MortonCode>							m_tmpcodes;
+};
+
+
+
+// (Begin cpp file)
+
+
+// Constructor.  Params specify the minimum position, and length of each edge of the covered area
+template <typename T>
+LinearOctree<T>::LinearOctree(FXMVECTOR position, float areasize)
+	:
+	m_areasize(areasize), m_depth(0U), m_dirty(false), m_releasedcount(0U)
+{
+	// Store the tree bounds
+	XMStoreFloat3(&m_min, position);
+	m_max = XMFLOAT3(m_min.x + areasize, m_min.y + areasize, m_min.z + areasize);
+
+	// Determine the leaf depth; subdivide until we reach the minimum node size, or the limit of our Morton code precision
+	m_cellsize = max(areasize, 1.0f);
+	while (m_cellsize * 0.5f >= Game::C_OCTREE_MIN_NODE_SIZE && m_depth < LinearOctree<T>::MAXIMUM_DEPTH)
+	{
+		m_cellsize *= 0.5f;
+		++m_depth;
+	}
+	m_cellsize_recip = (1.0f / m_cellsize);
+	m_maxcell = ((1 << m_depth) - 1);
+
+	// Start with an empty cell table, holding only the terminating entry
+	m_cellstart.push_back(0U);
+}
+
+// Adds an item to the tree.  Returns a flag indicating whether the item was accepted
+template <typename T>
+bool LinearOctree<T>::AddItem(T item, const FXMVECTOR pos)
+{
+	// Parameter check; we also reject any items outside the bounds of the tree
+	if (!item || !ContainsPoint(pos)) return false;
+
+	// If the item already exists then simply treat this as a movement
+	std::unordered_map<Game::ID_TYPE, uint32_t>::const_iterator it = m_index.find(item->GetID());
+	if (it != m_index.end())
+	{
+		UpdateItemPosition(it->second, pos);
+		return true;
+	}
+
+	// Append the item to the end of each stream; it will be moved into sorted position at the next rebuild
+	XMFLOAT3 fpos; XMStoreFloat3(&fpos, pos);
+	uint32_t index = (uint32_t)m_items.size();
+	m_items.push_back(item);
+	m_ids.push_back(item->GetID());
+	m_x.push_back(fpos.x); m_y.push_back(fpos.y); m_z.push_back(fpos.z);
+	m_codes.push_back(EncodeMorton(CellCoord(fpos.x, m_min.x), CellCoord(fpos.y, m_min.y), CellCoord(fpos.z, m_min.z)));
+	m_index[item->GetID()] = index;
+
+	m_dirty = true;
+	return true;
+}
+
+// Removes an item from the tree.  Removal is deferred; the item slot is released at the next rebuild
+template <typename T>
+void LinearOctree<T>::RemoveItem(T item)
+{
+	if (!item) return;
+
+	std::unordered_map<Game::ID_TYPE, uint32_t>::const_iterator it = m_index.find(item->GetID());
+	if (it != m_index.end()) ReleaseItem(it->second);
+}
+
+// Records the new position of an item that is already part of the tree
+template <typename T>
+void LinearOctree<T>::ItemMoved(T item, const FXMVECTOR pos)
+{
+	if (!item) return;
+
+	std::unordered_map<Game::ID_TYPE, uint32_t>::const_iterator it = m_index.find(item->GetID());
+	if (it != m_index.end()) UpdateItemPosition(it->second, pos);
+}
+
+// Re-reads the position of every item in the tree, then re-buckets all items in a single linear sweep
+template <typename T>
+void LinearOctree<T>::BatchUpdatePositions(void)
+{
+	uint32_t n = (uint32_t)m_items.size();
+	for (uint32_t i = 0U; i < n; ++i)
+	{
+		if (m_items[i]) UpdateItemPosition(i, m_items[i]->GetPosition());
+	}
+
+	Rebuild();
+}
+
+// Re-reads the position of only the specified items, then re-buckets all items in a single linear sweep
+template <typename T>
+void LinearOctree<T>::BatchUpdatePositions(const std::vector<T> & moved_items)
+{
+	typename std::vector<T>::const_iterator it_end = moved_items.end();
+	for (typename std::vector<T>::const_iterator it = moved_items.begin(); it != it_end; ++it)
+	{
+		if (!(*it)) continue;
+
+		std::unordered_map<Game::ID_TYPE, uint32_t>::const_iterator entry = m_index.find((*it)->GetID());
+		if (entry != m_index.end()) UpdateItemPosition(entry->second, (*it)->GetPosition());
+	}
+
+	Rebuild();
+}
+
+// Updates the stored position of the item at the given index; returns false if the item has left the tree bounds
+template <typename T>
+CMPINLINE bool LinearOctree<T>::UpdateItemPosition(uint32_t index, const FXMVECTOR pos)
+{
+	// Items that leave the tree bounds are removed, consistent with Octree<T>
+	if (!ContainsPoint(pos))
+	{
+		ReleaseItem(index);
+		return false;
+	}
+
+	// Update the position streams
+	XMFLOAT3 fpos; XMStoreFloat3(&fpos, pos);
+	m_x[index] = fpos.x; m_y[index] = fpos.y; m_z[index] = fpos.z;
+
+	// We only need to re-bucket the item if it has changed leaf cell (the overwhelmingly likely case is that it has not)
+	MortonCode code = EncodeMorton(CellCoord(fpos.x, m_min.x), CellCoord(fpos.y, m_min.y), CellCoord(fpos.z, m_min.z));
+	if (code != m_codes[index])
+	{
+		m_codes[index] = code;
+		m_dirty = true;
+	}
+
+	return true;
+}
+
+// Releases the item at the given index.  Slot is compacted at the next rebuild
+template <typename T>
+CMPINLINE void LinearOctree<T>::ReleaseItem(uint32_t index)
+{
+	if (!m_items[index]) return;
+
+	m_index.erase(m_ids[index]);
+	m_items[index] = NULL;
+	++m_releasedcount;
+	m_dirty = true;
+}
+
+// Applies any pending additions, removals and movements, and re-sorts the item streams if required
+template <typename T>
+void LinearOctree<T>::Rebuild(void)
+{
+	if (!m_dirty) return;
+	uint32_t n = (uint32_t)m_items.size();
+
+	// Compact any released slots out of the streams, preserving relative order
+	if (m_releasedcount != 0U)
+	{
+		uint32_t live = 0U;
+		for (uint32_t i = 0U; i < n; ++i)
+		{
+			if (!m_items[i]) continue;
+			if (live != i)
+			{
+				m_items[live] = m_items[i]; m_ids[live] = m_ids[i]; m_codes[live] = m_codes[i];
+				m_x[live] = m_x[i]; m_y[live] = m_y[i]; m_z[live] = m_z[i];
+			}
+			++live;
+		}
+
+		n = live;
+		m_items.resize(n); m_ids.resize(n); m_codes.resize(n);
+		m_x.resize(n); m_y.resize(n); m_z.resize(n);
+		m_releasedcount = 0U;
+	}
+
+	// Test whether the streams are still sorted.  Temporal coherence means this is the common case, in which
+	// we can avoid the sort and gather passes entirely
+	bool sorted = true;
+	for (uint32_t i = 1U; i < n; ++i)
+	{
+		if (m_codes[i] < m_codes[i - 1U]) { sorted = false; break; }
+	}
+
+	if (!sorted)
+	{
+		// Determine the sorted order of items via radix sort of their leaf codes
+		RadixSort::SortIndices<MortonCode>(m_codes, m_sortorder, m_sortscratch, (3U * m_depth));
+
+		// Gather each stream into the sorted order
+		m_tmpitems.resize(n); m_tmpids.resize(n); m_tmpcodes.resize(n); m_tmpfloat.resize(n);
+		for (uint32_t i = 0U; i < n; ++i)
+		{
+			uint32_t src = m_sortorder[i];
+			m_tmpitems[i] = m_items[src]; m_tmpids[i] = m_ids[src]; m_tmpcodes[i] = m_codes[src];
+		}
+		m_items.swap(m_tmpitems); m_ids.swap(m_tmpids); m_codes.swap(m_tmpcodes);
+
+		for (uint32_t i = 0U; i < n; ++i) m_tmpfloat[i] = m_x[m_sortorder[i]];
+		m_x.swap(m_tmpfloat);
+		for (uint32_t i = 0U; i < n; ++i) m_tmpfloat[i] = m_y[m_sortorder[i]];
+		m_y.swap(m_tmpfloat);
+		for (uint32_t i = 0U; i < n; ++i) m_tmpfloat[i] = m_z[m_sortorder[i]];
+		m_z.swap(m_tmpfloat);
+	}
+
+	// Update the index of any item which has changed position in the streams
+	for (uint32_t i = 0U; i < n; ++i)
+	{
+		uint32_t & index = m_index[m_ids[i]];
+		if (index != i) index = i;
+	}
+
+	// Rebuild the table of occupied leaf cells
+	m_cellcodes.clear(); m_cellstart.clear();
+	for (uint32_t i = 0U; i < n; ++i)
+	{
+		if (i == 0U || m_codes[i] != m_codes[i - 1U])
+		{
+			m_cellcodes.push_back(m_codes[i]);
+			m_cellstart.push_back(i);
+		}
+	}
+	m_cellstart.push_back(n);
+
+	m_dirty = false;
+}
+
+// Returns the set of all items within the tree
+template <typename T>
+void LinearOctree<T>::GetItems(std::vector<T> & outResult)
+{
+	Rebuild();
+	outResult.insert(outResult.end(), m_items.begin(), m_items.end());
+}
+
+// Returns the set of items held within the specified node of the implicit tree
+template <typename T>
+void LinearOctree<T>::GetItemsInNode(unsigned int depth, MortonCode node_code, std::vector<T> & outResult)
+{
+	if (depth > m_depth) return;
+	Rebuild();
+
+	// All leaf codes beneath this node share its code as a prefix, and are therefore contiguous in the sorted streams
+	unsigned int shift = (3U * (m_depth - depth));
+	MortonCode first = (node_code << shift);
+	MortonCode last = (((node_code + 1U) << shift) - 1U);
+
+	typename std::vector<T>::const_iterator begin = m_items.cbegin();
+	std::vector<MortonCode>::const_iterator lower = std::lower_bound(m_codes.cbegin(), m_codes.cend(), first);
+	std::vector<MortonCode>::const_iterator upper = std::upper_bound(lower, m_codes.cend(), last);
+	outResult.insert(outResult.end(), begin + (lower - m_codes.cbegin()), begin + (upper - m_codes.cbegin()));
+}
+
+// Core query method; invokes the supplied function for every item index whose position lies within the given bounds
+template <typename T>
+template <typename TFunc>
+void LinearOctree<T>::_Query(const XMFLOAT3 & fmin, const XMFLOAT3 & fmax, TFunc Func)
+{
+	Rebuild();
+	if (m_cellcodes.empty()) return;
+
+	// Determine the range of leaf cells covered by the query bounds
+	uint32_t x0 = CellCoord(fmin.x, m_min.x), x1 = CellCoord(fmax.x, m_min.x);
+	uint32_t y0 = CellCoord(fmin.y, m_min.y), y1 = CellCoord(fmax.y, m_min.y);
+	uint32_t z0 = CellCoord(fmin.z, m_min.z), z1 = CellCoord(fmax.z, m_min.z);
+
+	// Every cell within the query box has a Morton code between that of the min and max corners.  Walk the occupied
+	// cells in that range, skipping those which fall outside the query box along any axis
+	MortonCode code_max = EncodeMorton(x1, y1, z1);
+	std::vector<MortonCode>::size_type cell = (std::lower_bound(m_cellcodes.begin(), m_cellcodes.end(), EncodeMorton(x0, y0, z0)) - m_cellcodes.begin());
+	std::vector<MortonCode>::size_type cell_count = m_cellcodes.size();
+
+	uint32_t cx, cy, cz;
+	for (; cell < cell_count && m_cellcodes[cell] <= code_max; ++cell)
+	{
+		DecodeMorton(m_cellcodes[cell], cx, cy, cz);
+		if (cx < x0 || cx > x1 || cy < y0 || cy > y1 || cz < z0 || cz > z1) continue;
+
+		// Test each item in the cell against the exact query bounds
+		uint32_t end = m_cellstart[cell + 1U];
+		for (uint32_t i = m_cellstart[cell]; i < end; ++i)
+		{
+			if (m_x[i] < fmin.x || m_x[i] > fmax.x || m_y[i] < fmin.y || m_y[i] > fmax.y || m_z[i] < fmin.z || m_z[i] > fmax.z) continue;
+			Func(i);
+		}
+	}
+}
+
+// Returns all items whose position lies within the specified bounds.  Returns the number of items located
+template <typename T>
+int LinearOctree<T>::GetItemsWithinBounds(const FXMVECTOR vmin, const FXMVECTOR vmax, std::vector<T> & outResult)
+{
+	XMFLOAT3 fmin, fmax;
+	XMStoreFloat3(&fmin, vmin); XMStoreFloat3(&fmax, vmax);
+
+	int found = 0;
+	_Query(fmin, fmax, [&](uint32_t i) { outResult.push_back(m_items[i]); ++found; });
+	return found;
+}
+
+// Returns all items whose position lies within the specified distance of a point.  Returns the number of items located
+template <typename T>
+int LinearOctree<T>::GetItemsWithinDistance(const FXMVECTOR position, float distance, std::vector<T> & outResult)
+{
+	XMFLOAT3 pos, fmin, fmax;
+	XMStoreFloat3(&pos, position);
+	fmin = XMFLOAT3(pos.x - distance, pos.y - distance, pos.z - distance);
+	fmax = XMFLOAT3(pos.x + distance, pos.y + distance, pos.z + distance);
+	float distsq = (distance * distance);
+
+	int found = 0;
+	_Query(fmin, fmax, [&](uint32_t i)
+	{
+		float dx = (m_x[i] - pos.x), dy = (m_y[i] - pos.y), dz = (m_z[i] - pos.z);
+		if ((dx*dx + dy*dy + dz*dz) <= distsq) { outResult.push_back(m_items[i]); ++found; }
+	});
+	return found;
+}
+
+// Returns the ID of all items whose position lies within the specified distance of a point.  Returns the number of items located
+template <typename T>
+int LinearOctree<T>::GetItemIDsWithinDistance(const FXMVECTOR position, float distance, std::vector<Game::ID_TYPE> & outResult)
+{
+	XMFLOAT3 pos, fmin, fmax;
+	XMStoreFloat3(&pos, position);
+	fmin = XMFLOAT3(pos.x - distance, pos.y - distance, pos.z - distance);
+	fmax = XMFLOAT3(pos.x + distance, pos.y + distance, pos.z + distance);
+	float distsq = (distance * distance);
+
+	int found = 0;
+	_Query(fmin, fmax, [&](uint32_t i)
+	{
+		float dx = (m_x[i] - pos.x), dy = (m_y[i] - pos.y), dz = (m_z[i] - pos.z);
+		if ((dx*dx + dy*dy + dz*dz) <= distsq) { outResult.push_back(m_ids[i]); ++found; }
+	});
+	return found;
+}
+
+// Determines whether the tree contains the specified point.  Simple comparison to tree bounds
+template <typename T>
+CMPINLINE bool LinearOctree<T>::ContainsPoint(const FXMVECTOR point) const
+{
+	XMFLOAT3 p; XMStoreFloat3(&p, point);
+	return (p.x >= m_min.x && p.x < m_max.x && p.y >= m_min.y && p.y < m_max.y && p.z >= m_min.z && p.z < m_max.z);
+}
+
+// Returns the Morton code of the leaf cell containing the specified point.  Points outside the tree are clamped
+template <typename T>
+CMPINLINE typename LinearOctree<T>::MortonCode LinearOctree<T>::GetLeafCode(const FXMVECTOR point) const
+{
+	XMFLOAT3 p; XMStoreFloat3(&p, point);
+	return EncodeMorton(CellCoord(p.x, m_min.x), CellCoord(p.y, m_min.y), CellCoord(p.z, m_min.z));
+}
+
+// Shutdown method.  Releases all item data
+template <typename T>
+void LinearOctree<T>::Shutdown(void)
+{
+	m_items.clear(); m_ids.clear(); m_codes.clear();
+	m_x.clear(); m_y.clear(); m_z.clear();
+	m_index.clear();
+	m_cellcodes.clear(); m_cellstart.clear(); m_cellstart.push_back(0U);
+	m_releasedcount = 0U;
+	m_dirty = false;
+}
+
+// Debug method to generate a string output of the tree and its occupied cells
+template <typename T>
+std::string LinearOctree<T>::DebugOutput(void)
+{
+	Rebuild();
+
+	std::ostringstream s;
+	s << "LinearOctree " << std::hex << this << std::dec << "(Depth=" << m_depth << ", Items=" << m_items.size() << ", Cells="
+	  << m_cellcodes.size() << ", CellSize=" << m_cellsize << ", Bounds=[" << m_min.x << "," << m_min.y << "," << m_min.z << "]-["
+	  << m_max.x << "," << m_max.y << "," << m_max.z << "])\n";
+
+	uint32_t x, y, z;
+	for (std::vector<MortonCode>::size_type i = 0; i < m_cellcodes.size(); ++i)
+	{
+		DecodeMorton(m_cellcodes[i], x, y, z);
+		s << "  Cell " << m_cellcodes[i] << " [" << x << "," << y << "," << z << "]: Items=" << (m_cellstart[i + 1] - m_cellstart[i]) << "\n";
+	}
+
+	return s.str();
+}
+
+// Default destructor
+template <typename T>
+LinearOctree<T>::~LinearOctree(void)
+{
+}
+
+
+#endif
@@ -0,0 +1,139 @@
+#include <set>
+#include <algorithm>
+#include "LinearOctree.h"
+#include "FastMath.h"
+
+#include "LinearOctreeTests.h"
+
+
+// Minimal spatial item for tests; exposes only the members required by LinearOctree
+struct LinearOctreeTestItem
+{
+	Game::ID_TYPE		ID;
+	XMFLOAT3			Position;
+
+	LinearOctreeTestItem(Game::ID_TYPE id, const XMFLOAT3 & pos) : ID(id), Position(pos) { }
+	CMPINLINE Game::ID_TYPE		GetID(void) const			{ return ID; }
+	CMPINLINE XMVECTOR			GetPosition(void) const		{ return XMLoadFloat3(&Position); }
+};
+
+
+TestResult LinearOctreeTests::MortonEncodingTests()
+{
+	TestResult result = NewResult();
+
+	// Encoding should interleave bits as (z, y, x) from most to least significant
+	result.AssertEqual(LinearOctree<LinearOctreeTestItem*>::EncodeMorton(1U, 0U, 0U), 1U, ERR("Incorrect Morton encoding of x-axis"));
+	result.AssertEqual(LinearOctree<LinearOctreeTestItem*>::EncodeMorton(0U, 1U, 0U), 2U, ERR("Incorrect Morton encoding of y-axis"));
+	result.AssertEqual(LinearOctree<LinearOctreeTestItem*>::EncodeMorton(0U, 0U, 1U), 4U, ERR("Incorrect Morton encoding of z-axis"));
+	result.AssertEqual(LinearOctree<LinearOctreeTestItem*>::EncodeMorton(3U, 3U, 3U), 63U, ERR("Incorrect Morton encoding of combined axes"));
+
+	// Decoding should be the exact inverse of encoding across the full coordinate range
+	uint32_t x, y, z;
+	LinearOctree<LinearOctreeTestItem*>::DecodeMorton(LinearOctree<LinearOctreeTestItem*>::EncodeMorton(1023U, 512U, 7U), x, y, z);
+	result.AssertEqual(x, 1023U, ERR("Morton decoding did not recover x coordinate"));
+	result.AssertEqual(y, 512U, ERR("Morton decoding did not recover y coordinate"));
+	result.AssertEqual(z, 7U, ERR("Morton decoding did not recover z coordinate"));
+
+	return result;
+}
+
+TestResult LinearOctreeTests::BasicItemManagementTests()
+{
+	TestResult result = NewResult();
+
+	LinearOctree<LinearOctreeTestItem*> tree(XMVectorReplicate(-10000.0f), 20000.0f);
+	LinearOctreeTestItem a(1, XMFLOAT3(0.0f, 0.0f, 0.0f));
+	LinearOctreeTestItem b(2, XMFLOAT3(5000.0f, -5000.0f, 100.0f));
+	LinearOctreeTestItem outside(3, XMFLOAT3(50000.0f, 0.0f, 0.0f));
+
+	// Items within bounds should be accepted, and items outside rejected
+	result.AssertTrue(tree.AddItem(&a, a.GetPosition()), ERR("Valid item was not added to linear octree"));
+	result.AssertTrue(tree.AddItem(&b, b.GetPosition()), ERR("Valid item was not added to linear octree"));
+	result.AssertFalse(tree.AddItem(&outside, outside.GetPosition()), ERR("Out-of-bounds item was incorrectly added to linear octree"));
+	result.AssertEqual(tree.GetItemCount(), 2, ERR("Incorrect item count following addition"));
+
+	std::vector<LinearOctreeTestItem*> items;
+	tree.GetItems(items);
+	result.AssertEqual(items.size(), (size_t)2U, ERR("Incorrect number of items returned from linear octree"));
+
+	// Removal should take effect on the next query
+	tree.RemoveItem(&a);
+	items.clear(); tree.GetItems(items);
+	result.AssertEqual(items.size(), (size_t)1U, ERR("Item was not removed from linear octree"));
+	result.Assert(items.size() == 1U && items[0] == &b, ERR("Incorrect item remained in linear octree following removal"));
+
+	// Moving an item outside the tree bounds should remove it, consistent with Octree<T>
+	b.Position = XMFLOAT3(0.0f, 0.0f, 50000.0f);
+	tree.ItemMoved(&b, b.GetPosition());
+	items.clear(); tree.GetItems(items);
+	result.AssertEqual(items.size(), (size_t)0U, ERR("Item moving outside tree bounds was not removed"));
+
+	return result;
+}
+
+TestResult LinearOctreeTests::BatchUpdateTests()
+{
+	TestResult result = NewResult();
+
+	LinearOctree<LinearOctreeTestItem*> tree(XMVectorReplicate(-100000.0f), 200000.0f);
+	std::vector<LinearOctreeTestItem> items;
+	for (int i = 0; i < 1000; ++i) items.push_back(LinearOctreeTestItem(i + 1, XMFLOAT3(frand_lh(-90000.0f, 90000.0f), frand_lh(-90000.0f, 90000.0f), frand_lh(-90000.0f, 90000.0f))));
+	for (auto & item : items) tree.AddItem(&item, item.GetPosition());
+
+	// Move every item and re-bucket in a single pass
+	for (auto & item : items) item.Position.x = -item.Position.x;
+	tree.BatchUpdatePositions();
+	result.AssertFalse(tree.RequiresRebuild(), ERR("Linear octree still requires rebuild following batch update"));
+	result.AssertEqual(tree.GetItemCount(), 1000, ERR("Items lost during linear octree batch update"));
+
+	// Every item should now be located in the leaf cell corresponding to its new position
+	std::vector<LinearOctreeTestItem*> cell;
+	bool all_located = true;
+	for (auto & item : items)
+	{
+		cell.clear();
+		tree.GetItemsInNode(tree.GetDepth(), tree.GetLeafCode(item.GetPosition()), cell);
+		if (std::find(cell.begin(), cell.end(), &item) == cell.end()) { all_located = false; break; }
+	}
+	result.AssertTrue(all_located, ERR("Item not located in correct leaf cell following batch update"));
+
+	// The root node should contain every item
+	cell.clear();
+	tree.GetItemsInNode(0U, 0U, cell);
+	result.AssertEqual(cell.size(), (size_t)1000U, ERR("Root node of linear octree does not contain all items"));
+
+	return result;
+}
+
+TestResult LinearOctreeTests::ProximitySearchTests()
+{
+	TestResult result = NewResult();
+
+	LinearOctree<LinearOctreeTestItem*> tree(XMVectorReplicate(-100000.0f), 200000.0f);
+	std::vector<LinearOctreeTestItem> items;
+	for (int i = 0; i < 2000; ++i) items.push_back(LinearOctreeTestItem(i + 1, XMFLOAT3(frand_lh(-90000.0f, 90000.0f), frand_lh(-90000.0f, 90000.0f), frand_lh(-90000.0f, 90000.0f))));
+	for (auto & item : items) tree.AddItem(&item, item.GetPosition());
+
+	// Compare the result of each search against a brute-force test of all items
+	const float distance = 20000.0f;
+	bool all_match = true;
+	for (int q = 0; q < 25; ++q)
+	{
+		XMFLOAT3 centre = XMFLOAT3(frand_lh(-90000.0f, 90000.0f), frand_lh(-90000.0f, 90000.0f), frand_lh(-90000.0f, 90000.0f));
+
+		std::vector<Game::ID_TYPE> found;
+		tree.GetItemIDsWithinDistance(XMLoadFloat3(&centre), distance, found);
+
+		std::set<Game::ID_TYPE> expected;
+		for (const auto & item : items)
+		{
+			if (Float3DistanceSq(item.Position, centre) <= (distance * distance)) expected.insert(item.ID);
+		}
+
+		if (std::set<Game::ID_TYPE>(found.begin(), found.end()) != expected) { all_match = false; break; }
+	}
+	result.AssertTrue(all_match, ERR("Linear octree proximity search results do not match brute-force search"));
+
+	return result;
+}
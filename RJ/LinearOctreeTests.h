@@ -0,0 +1,30 @@
+#pragma once
+
+#include "CompilerSettings.h"
+#include "TestBase.h"
+
+class LinearOctreeTests : public TestBase
+{
+public:
+
+	CMPINLINE TestResult RunTests(void)
+	{
+		TestResult result = NewNamedResult(LinearOctreeTests);
+
+		result += MortonEncodingTests();
+		result += BasicItemManagementTests();
+		result += BatchUpdateTests();
+		result += ProximitySearchTests();
+
+		return result;
+	}
+
+
+private:
+
+	TestResult MortonEncodingTests();
+	TestResult BasicItemManagementTests();
+	TestResult BatchUpdateTests();
+	TestResult ProximitySearchTests();
+
+};
@@ -3,6 +3,8 @@
 #include "FileUtils.h"
 #include "ByteString.h"
 #include "ModelData.h"
+#include "MemoryMappedFile.h"
+#include "BinaryModelFile.h"
 #include "CoreEngine.h"
 #include "RenderAssetsDX11.h"
 #include "VertexBufferDX11.h"
@@ -19,7 +21,10 @@ Model::ModelID Model::GlobalModelIDCount = 0U;
 Model::Model(void)
 	:
 	m_id(++Model::GlobalModelIDCount), 
-	m_component_count(0U)
+	m_component_count(0U), 
+	m_has_lods(false), 
+	m_compiled(false), 
+	m_residency_id(Model::NO_RESIDENCY_ID)
 {
 	// Derived fields will all be set to defaults when calculated for null model data
 	RecalculateDerivedData();
@@ -32,8 +37,9 @@ Model::~Model(void)
 }
 
 
-// Load a model from disk and prepare it for use
-Result Model::Initialise(const std::string & code, std::vector<ModelLoadingData> components)
+// Load a model from disk and prepare it for use.  If 'compile' is false the geometry is loaded and all derived data is 
+// available, but no rendering buffers are created until the model is compiled
+Result Model::Initialise(const std::string & code, std::vector<ModelLoadingData> components, bool compile)
 {
 	// Reset all geometry data beforehand so that we don't ever half-load a model over an existing one
 	Reset();
@@ -62,7 +68,33 @@ Result Model::Initialise(const std::string & code, std::vector<ModelLoadingData>
 			return ErrorCodes::CouldNotOpenModelFile;
 		}
 
-		// Read file contents
+		// Binary model files are mapped and used in place, with no per-element deserialization
+		std::shared_ptr<MemoryMappedFile> mapped = MemoryMappedFile::Open(item.GetFilename());
+		if (mapped && BinaryModelFile::IsBinaryModelData(mapped->GetData(), mapped->GetSize()))
+		{
+#			ifdef _DEBUG
+				bool verify_checksums = true;
+#			else
+				bool verify_checksums = false;
+#			endif
+
+			auto meshes = BinaryModelFile::Load(mapped, verify_checksums);
+			if (meshes.empty())
+			{
+				Game::Log << LOG_ERROR << "Could not load binary model \"" << code << "[" << i << "]\" data from \"" << item.GetFilename() << "\"\n";
+				return ErrorCodes::CannotDeserializeModel;
+			}
+
+			// Each mesh within the file becomes a separate component using the same material
+			for (auto & mesh : meshes)
+			{
+				Components.push_back(Model::Component(std::move(mesh), NULL, item.GetFilename(), item.GetMaterial()));
+			}
+			continue;
+		}
+		mapped.reset();
+
+		// Otherwise read the full file contents, which should be in the legacy geometry format
 		ByteString binary_data = FileUtils::ReadBinaryFile(file);
 		if (binary_data.empty())
 		{
@@ -82,11 +114,14 @@ Result Model::Initialise(const std::string & code, std::vector<ModelLoadingData>
 		Components.push_back(Model::Component(std::move(geometry), NULL, item.GetFilename(), item.GetMaterial()));
 	}
 
-	// Compile the model based upon the loaded geometry data
-	Result compile_result = CompileModel();
-	if (compile_result != ErrorCodes::NoError)
+	// Compile the model based upon the loaded geometry data, unless compilation is being deferred
+	if (compile)
 	{
-		return compile_result;
+		Result compile_result = CompileModel();
+		if (compile_result != ErrorCodes::NoError)
+		{
+			return compile_result;
+		}
 	}
 
 	// Perform a recalculation of derived data based on this newly-compiled geometry
@@ -101,6 +136,8 @@ void Model::Reset(void)
 {
 	// Release all data
 	Components.clear();
+	m_has_lods = false;
+	m_compiled = false;
 
 	// Perform a recalculation which will reset all derived data back to defaults
 	RecalculateDerivedData();
@@ -141,30 +178,70 @@ void Model::RecalculateDerivedData(void)
 // Compile a model and generate all rendering buffer data
 Result Model::CompileModel(void)
 {
-	// Compile each component in turn
+	// Make sure geometry data has been loaded for every component
 	size_t n = Components.size();
 	for (size_t i = 0U; i < n; ++i)
 	{
-		auto & component = Components[i];
-
-		// Make sure geometry data has been loaded
-		ModelData *data = component.Geometry.get();
-		if (!data)
+		if (!Components[i].Geometry.get())
 		{
 			Game::Log << LOG_WARN << "Cannot compile model \"" << m_code << "[" << i << "]\"; no geometry data available\n";
 			return ErrorCodes::CannotCompileModel;
 		}
+	}
+
+	// Build and install rendering data for all components
+	CompiledComponents data;
+	Result result = BuildCompiledData(ResolveComponentMaterials(), data);
+	if (result != ErrorCodes::NoError) return result;
 
+	InstallCompiledData(std::move(data));
+
+	// Return success
+	return ErrorCodes::NoError;
+}
+
+// Resolves the material used by each component, falling back to the default material where required
+std::vector<const MaterialDX11*> Model::ResolveComponentMaterials(void) const
+{
+	std::vector<const MaterialDX11*> materials;
+	materials.reserve(Components.size());
+
+	size_t n = Components.size();
+	for (size_t i = 0U; i < n; ++i)
+	{
 		// Attempt to resolve the model material, otherwise use a default
-		const MaterialDX11 * pMaterial = Game::Engine->GetAssets().GetMaterial(component.MaterialCode);
+		const MaterialDX11 * pMaterial = Game::Engine->GetAssets().GetMaterial(Components[i].MaterialCode);
 		if (!pMaterial)
 		{
-			Game::Log << LOG_WARN << "Cannot find material \"" << component.MaterialCode << "\" for model \"" << m_code << "[" << i << "]\"; using default\n";
+			Game::Log << LOG_WARN << "Cannot find material \"" << Components[i].MaterialCode << "\" for model \"" << m_code << "[" << i << "]\"; using default\n";
 			pMaterial = Game::Engine->GetAssets().GetDefaultMaterial();
 		}
 
-		// Refresh the buffer with this new data
-		component.Data = std::make_unique<ModelBuffer>
+		materials.push_back(pMaterial);
+	}
+
+	return materials;
+}
+
+// Builds rendering buffers for each component using the given materials, without modifying the model.  Only reads the 
+// component geometry, so may be executed on a worker thread as long as the model geometry is not modified concurrently
+Result Model::BuildCompiledData(const std::vector<const MaterialDX11*> & materials, CompiledComponents & outData)
+{
+	size_t n = Components.size();
+	if (materials.size() != n) return ErrorCodes::CannotCompileModel;
+
+	outData.clear();
+	outData.resize(n);
+	for (size_t i = 0U; i < n; ++i)
+	{
+		const ModelData *data = Components[i].Geometry.get();
+		if (!data) return ErrorCodes::CannotCompileModel;
+
+		CompiledComponent & compiled = outData[i];
+		const MaterialDX11 *pMaterial = materials[i];
+
+		// Build the primary buffer for this component
+		compiled.Data = std::make_unique<ModelBuffer>
 		(
 			VertexBufferDX11(*data),
 			IndexBufferDX11(*data),
@@ -172,14 +249,75 @@ Result Model::CompileModel(void)
 		);
 
 		// Store reference back to this model within the buffer; useful mostly for debugging
-		component.Data->SetParentModel(this);
+		compiled.Data->SetParentModel(this);
+
+		// Compile any simplified LOD geometry, which shares the material of its parent mesh
+		for (const auto & lod : data->Lods)
+		{
+			if (!lod.get()) continue;
+
+			compiled.LodData.push_back(std::make_unique<ModelBuffer>(VertexBufferDX11(*lod), IndexBufferDX11(*lod), pMaterial));
+			compiled.LodData.back()->SetParentModel(this);
+			compiled.LodError.push_back(lod->LodError);
+		}
+	}
+
+	return ErrorCodes::NoError;
+}
+
+// Installs previously-built rendering buffers into the model components
+void Model::InstallCompiledData(CompiledComponents && data)
+{
+	bool has_lods = false;
+	size_t n = (Components.size() < data.size() ? Components.size() : data.size());
+	for (size_t i = 0U; i < n; ++i)
+	{
+		auto & component = Components[i];
+		component.Data = std::move(data[i].Data);
+		component.LodData = std::move(data[i].LodData);
+		component.LodError = std::move(data[i].LodError);
+
+		has_lods |= !component.LodData.empty();
 	}
 
 	// Store total component count for render-time
-	m_component_count = n;
+	m_component_count = Components.size();
+	m_has_lods = has_lods;
+	m_compiled = true;
+}
 
-	// Return success
-	return ErrorCodes::NoError;
+// Releases all compiled rendering buffers, retaining the source geometry so that the model can be compiled again later
+void Model::ReleaseCompiledData(void)
+{
+	for (auto & component : Components)
+	{
+		component.Data.reset();
+		component.LodData.clear();
+		component.LodError.clear();
+	}
+
+	m_has_lods = false;
+	m_compiled = false;
+}
+
+// Returns the size of the rendering buffers for this model, including any LODs, in bytes
+size_t Model::CalculateCompiledDataSize(void) const
+{
+	size_t size = 0U;
+	for (const auto & component : Components)
+	{
+		const ModelData *data = component.Geometry.get();
+		if (!data) continue;
+
+		size += ((size_t)data->VertexCount * sizeof(ModelData::TVertex)) + ((size_t)data->IndexCount * sizeof(INDEX_BUFFER_TYPE));
+		for (const auto & lod : data->Lods)
+		{
+			if (!lod.get()) continue;
+			size += ((size_t)lod->VertexCount * sizeof(ModelData::TVertex)) + ((size_t)lod->IndexCount * sizeof(INDEX_BUFFER_TYPE));
+		}
+	}
+
+	return size;
 }
 
 
@@ -238,16 +376,23 @@ void Model::ReloadModel(Model *model)
 		source.push_back(ModelLoadingData(item.Filename, item.MaterialCode));
 	}
 
-	Result result = model->Initialise(model->GetCode(), source);
+	// Streamed models are evicted first, and will then be recompiled by the residency manager when next requested
+	bool streamed = (model->GetResidencyID() != Model::NO_RESIDENCY_ID);
+	if (streamed) Game::Engine->GetAssetResidency().EvictModel(model);
+
+	Result result = model->Initialise(model->GetCode(), source, false);
 	if (result != ErrorCodes::NoError)
 	{
 		Game::Log << LOG_ERROR << "Failed to re-initialise model \"" << model->GetCode() << "\"; error code " << (int)result << "\n";
 	}
 
-	result = model->CompileModel();
-	if (result != ErrorCodes::NoError)
+	if (!streamed)
 	{
-		Game::Log << LOG_ERROR << "Failed to re-compile model \"" << model->GetCode() << "\"; error code " << (int)result << "\n";
+		result = model->CompileModel();
+		if (result != ErrorCodes::NoError)
+		{
+			Game::Log << LOG_ERROR << "Failed to re-compile model \"" << model->GetCode() << "\"; error code " << (int)result << "\n";
+		}
 	}
 }
 
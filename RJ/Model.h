@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 #include <filesystem>
 #include "ModelData.h"
 #include "ModelBuffer.h"
@@ -19,6 +20,9 @@ public:
 	// Model data is stored in static unordered_map collections & indexed by unique string code
 	typedef std::unordered_map<std::string, Model*> ModelCollection;
 
+	// LOD error scale which will always select full-detail geometry
+	static constexpr float FULL_DETAIL_LOD_SCALE = FLT_MAX;
+
 public:
 
 	struct Component
@@ -30,6 +34,10 @@ public:
 		// Compiled model data and buffers
 		std::unique_ptr<ModelBuffer>		Data;
 
+		// Compiled LOD buffers in order of decreasing detail, and the error of each relative to the model bounding radius
+		std::vector<std::unique_ptr<ModelBuffer>>	LodData;
+		std::vector<float>					LodError;
+
 		// Metadata to be stored for the component
 		std::string							Filename;
 		std::string							MaterialCode;
@@ -39,19 +47,46 @@ public:
 		Component(std::unique_ptr<ModelData> && geometry, std::unique_ptr<ModelBuffer> && data, const std::string & filename, const std::string & materialcode)
 			:
 			Geometry(std::move(geometry)), Data(std::move(data)), Filename(filename), MaterialCode(materialcode) { }
+
+		// Returns the lowest level of detail whose scaled error is within tolerance (<= 1.0), where the scale converts relative
+		// error into multiples of the permitted projected error.  LODs are ordered by increasing error so the search can stop early
+		CMPINLINE ModelBuffer *				SelectLod(float error_scale) const
+		{
+			ModelBuffer *buffer = Data.get();
+			for (size_t i = 0U; i < LodData.size() && (LodError[i] * error_scale) <= 1.0f; ++i)
+			{
+				buffer = LodData[i].get();
+			}
+			return buffer;
+		}
 	};
 
 	// List of components in the model
 	typedef std::vector<Component>			ModelComponents;
 	ModelComponents							Components;
 
+	// Compiled rendering data for a single component, which can be built separately from the model and installed later
+	struct CompiledComponent
+	{
+		std::unique_ptr<ModelBuffer>				Data;
+		std::vector<std::unique_ptr<ModelBuffer>>	LodData;
+		std::vector<float>							LodError;
+	};
+
+	// Set of compiled rendering data for all model components
+	typedef std::vector<CompiledComponent>	CompiledComponents;
+
+	// Identifier used where a model is not managed by the asset residency manager
+	static const int						NO_RESIDENCY_ID = -1;
+
 public:
 
 	Model(void);
 	~Model(void);
 
-	// Load a model from disk and prepare it for use
-	Result								Initialise(const std::string & code, std::vector<ModelLoadingData> components);
+	// Load a model from disk and prepare it for use.  If 'compile' is false the geometry is loaded and all derived data is 
+	// available, but no rendering buffers are created until the model is compiled
+	Result								Initialise(const std::string & code, std::vector<ModelLoadingData> components, bool compile = true);
 
 	// Return basic data on the model
 	CMPINLINE ModelID					GetID(void) const { return m_id; }
@@ -61,6 +96,9 @@ public:
 	CMPINLINE ModelComponents::size_type	GetComponentCount(void) const { return m_component_count; }
 	CMPINLINE bool							HasData(void) const { return (m_component_count != 0U); }
 
+	// Indicates whether any component has simplified LOD geometry available; determined during model compilation
+	CMPINLINE bool							HasLods(void) const { return m_has_lods; }
+
 	// Return data derived from the model geometry
 	CMPINLINE XMFLOAT3					GetMinBounds(void) const { return m_minbounds; }
 	CMPINLINE XMFLOAT3					GetMaxBounds(void) const { return m_maxbounds; }
@@ -82,12 +120,38 @@ public:
 	// Compile a model and generate all rendering buffer data
 	Result								CompileModel(void);
 
+	// Resolves the material used by each component, falling back to the default material where required
+	std::vector<const MaterialDX11*>	ResolveComponentMaterials(void) const;
+
+	// Builds rendering buffers for each component using the given materials, without modifying the model.  Only reads the 
+	// component geometry, so may be executed on a worker thread as long as the model geometry is not modified concurrently
+	Result								BuildCompiledData(const std::vector<const MaterialDX11*> & materials, CompiledComponents & outData);
+
+	// Installs previously-built rendering buffers into the model components
+	void								InstallCompiledData(CompiledComponents && data);
+
+	// Releases all compiled rendering buffers, retaining the source geometry so that the model can be compiled again later
+	void								ReleaseCompiledData(void);
+
+	// Indicates whether rendering buffers currently exist for the model
+	CMPINLINE bool						IsCompiled(void) const { return m_compiled; }
+
+	// Returns the size of the rendering buffers for this model, including any LODs, in bytes
+	size_t								CalculateCompiledDataSize(void) const;
+
+	// Identifier of this model within the asset residency manager, or NO_RESIDENCY_ID if the model is not managed
+	CMPINLINE int						GetResidencyID(void) const { return m_residency_id; }
+	CMPINLINE void						SetResidencyID(int id) { m_residency_id = id; }
+
 
 private:
 
 	ModelID								m_id;
 	std::string							m_code;
 	ModelComponents::size_type			m_component_count;
+	bool								m_has_lods;
+	bool								m_compiled;
+	int									m_residency_id;
 
 	XMFLOAT3							m_minbounds;				// Aggregated across all components; calculated during model compilation
 	XMFLOAT3							m_maxbounds;				// Aggregated across all components; calculated during model compilation
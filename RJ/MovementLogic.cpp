@@ -7,6 +7,7 @@
 #include "Engine.h"
 #include "iSpaceObject.h"
 #include "Utility.h"
+#include "GameUniverse.h"
 #include "Actor.h" // DBG
 #include "MovementLogic.h"
 
@@ -40,6 +41,10 @@ void Game::Logic::SimulateAllObjects(void)
 		obj->RemoveCurrentVisibilityFlag();
 	}
 
+	// Simulate the interior of any environments which deferred their simulation to a parallel per-system batch.  Registers
+	// remain locked since deferred environment effects may create or destroy objects
+	Game::Universe->SimulateQueuedEnvironments();
+
 	// Unlock the central object registers following processing of the full object collection
 	Game::UnlockObjectRegisters();
 
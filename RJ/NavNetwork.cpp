@@ -1,20 +1,37 @@
+#include <algorithm>
+#include <functional>
+#include <atomic>
 #include "ErrorCodes.h"
 #include "GameVarsExtern.h"
 #include "ComplexShipElement.h"
 #include "iSpaceObjectEnvironment.h"
 #include "NavNode.h"
 #include "BinaryHeap.h"
+#include "WorkerThreadPool.h"
 
 #include "NavNetwork.h"
 
+// Static flags controlling the pathfinding method
+bool NavNetwork::USE_HIERARCHICAL_PATHFINDING = true;
+bool NavNetwork::USE_PATH_CACHE = true;
+
+// Layout versions are allocated from a single counter, so that no two layouts of any network share a version
+static std::atomic<unsigned int> s_next_layout_version(0U);
+
 NavNetwork::NavNetwork(void)
 {
 	// Initialise fields to their default values upon creation
 	m_parent = NULL;
-	OPEN_LIST = 10; CLOSED_LIST = 11;
 	m_nodes = NULL;
 	m_nodecount = 0;
 	m_elementsize = NULL_INTVECTOR3;
+	m_layout_version = ++s_next_layout_version;
+
+	// Hierarchical layer and path cache are empty until the network is initialised
+	m_clusterdims = NULL_INTVECTOR3;
+	m_clustercount = 0;
+	m_path_cache_capacity = DEFAULT_PATH_CACHE_CAPACITY;
+	m_path_cache_hits = m_path_cache_misses = 0U;
 
 	// The network is uninitialised upon creation
 	m_initialised = false;
@@ -305,8 +322,8 @@ Result NavNetwork::InitialiseNavNetwork(iSpaceObjectEnvironment *parent)
 	SafeDeleteArray(node_layout);
 	SafeDeleteArray(ccounts);
 
-	/* 6. Allocate a sufficiently-large binary heap for use as the open list in pathfinding calls */
-	m_openlist.Initialise(m_nodecount);
+	/* 6. Build the hierarchical layer used to resolve long-range paths.  This also prepares the default query context */
+	BuildHierarchicalLayer();
 
 	// We have successfully generated the nav network
 	m_initialised = true;
@@ -500,6 +517,12 @@ void NavNetwork::Shutdown(void)
 	// Release all space allocated for nodes in this network
 	SafeDeleteArray(m_nodes);
 
+	// Any existing paths and hierarchical data refer to the nodes we just released.  Discard them, and move to a new
+	// layout version so that no path from the previous layout can be mistaken for a current one
+	ClearHierarchicalLayer();
+	InvalidatePathCache();
+	m_layout_version = ++s_next_layout_version;
+
 	// Clear related fields
 	m_nodecount = 0;
 	m_initialised = false;
@@ -522,11 +545,8 @@ std::string NavNetwork::OutputAsString(void)
 		// Element reference
 		if (n->Element) s = concat(s)(", El = ")(IntVectorToString(&(n->Element->GetLocation()))).str();
 		
-		// Node cost and pathfinding field
-		s = concat(s)(", Cost = ")(n->NodeCost)(", F = ")(n->F)(", G = ")(n->G)(", H = ")(n->H).str();
-
-		// Path parent
-		if (n->PathParent) s = concat(s)(", Path parent = ")(n->PathParent->Index).str();
+		// Node cost
+		s = concat(s)(", Cost = ")(n->NodeCost).str();
 
 		// Connection count
 		s = concat(s)(", Num connections = ")(n->NumConnections).str();
@@ -559,85 +579,137 @@ Result NavNetwork::FindPath(const FXMVECTOR start, const FXMVECTOR end, std::vec
 	return FindPath(GetClosestNode(start), GetClosestNode(end), outPathReverse);
 }
 
-// Finds a path from one node to another, populating the result vector as a (reverse) set of navnodes
+// Finds a path from one node to another, populating the result vector as a (reverse) set of navnodes.  Uses the 
+// network's own query context, and so should only be called from one thread at a time
 Result NavNetwork::FindPath(NavNode *start, NavNode *end, std::vector<NavNode*> & outPathReverse)
+{
+	return FindPath(m_default_context, start, end, outPathReverse);
+}
+
+// Finds a path from one node to another, populating the result vector as a (reverse) set of navnodes.  Search state is 
+// held in the supplied context, so this method can be called concurrently from any number of threads with distinct contexts
+Result NavNetwork::FindPath(QueryContext & context, NavNode *start, NavNode *end, std::vector<NavNode*> & outPathReverse)
+{
+	// Basic efficiency checks where pathfinding is not required
+	if (!start || !end) return ErrorCodes::InvalidPathfindingParameters;
+	if (start == end) { outPathReverse.push_back(end); return ErrorCodes::NoError; }
+
+	// Both nodes must belong to this network
+	if (start < m_nodes || start >= (m_nodes + m_nodecount) || end < m_nodes || end >= (m_nodes + m_nodecount))
+		return ErrorCodes::InvalidPathfindingParameters;
+
+	// Return the result of any identical query made against the current layout
+	Result result;
+	if (USE_PATH_CACHE)
+	{
+		if (RetrieveCachedPath(start->Index, end->Index, result, outPathReverse)) return result;
+	}
+
+	// Make sure the context is ready for a search of the current layout
+	PrepareQueryContext(context);
+
+	// Paths between clusters are resolved via the hierarchical layer.  Paths within a single cluster are short enough that
+	// a search of the full network will be resolved almost immediately
+	std::vector<NavNode*>::size_type offset = outPathReverse.size();
+	if (USE_HIERARCHICAL_PATHFINDING && m_clustercount > 0 && m_node_cluster[start->Index] != m_node_cluster[end->Index])
+		result = FindPathHierarchical(context, start, end, outPathReverse);
+	else
+		result = FindPathFlat(context, start, end, outPathReverse, NO_CLUSTER);
+
+	// Store the result for use by any future identical queries
+	if (USE_PATH_CACHE) StoreCachedPath(start->Index, end->Index, result, outPathReverse.data() + offset, outPathReverse.size() - offset);
+	return result;
+}
+
+// Performs an A* search over the node network, populating the result vector as a (reverse) set of nav nodes.  Search
+// can optionally be restricted to nodes within a single cluster
+Result NavNetwork::FindPathFlat(QueryContext & context, NavNode *start, NavNode *end, std::vector<NavNode*> & outPathReverse, int cluster) const
 {
 	NavNode *node, *next;
-	int newG;
+	int index, nextindex, newG;
+
+	// Search state is held per node within the context
+	BinaryHeap<int, NavNode*> & openlist = context.m_openlist;
+	std::vector<int> & onlist = context.m_onlist;
+	std::vector<int> & F = context.m_f;
+	std::vector<int> & G = context.m_g;
+	std::vector<int> & H = context.m_h;
+	std::vector<NavNode*> & parent = context.m_parent;
 
 	// 1. Basic efficiency checks where pathfinding is not required
 	if (!start || !end) return ErrorCodes::InvalidPathfindingParameters;
 	if (start == end) { outPathReverse.push_back(end); return ErrorCodes::NoError; }
 
 	// 2. If we have reached the max values for open/closed list counters, reset all nodes and wrap around
-	if (CLOSED_LIST > 100000)
+	if (context.CLOSED_LIST > 100000)
 	{
 		// Reset all nodes to a zero value in the list flag
-		for (int i = 0; i < m_openlist.Capacity; i++) 
-			if (m_openlist.Items[i].Item) m_openlist.Items[i].Item->OnList = 0;
+		std::fill(onlist.begin(), onlist.end(), 0);
 
 		// Reset the list flag.  We will increment from here in each call to the find path method
-		CLOSED_LIST = 10;
+		context.CLOSED_LIST = 10;
 	}
 
 	// 3. Increment the open/closed list pointers, to distinguish this run from previous ones
-	CLOSED_LIST += 2; 
-	OPEN_LIST = CLOSED_LIST - 1;
+	context.CLOSED_LIST += 2; 
+	context.OPEN_LIST = context.CLOSED_LIST - 1;
+	const int OPEN_LIST = context.OPEN_LIST, CLOSED_LIST = context.CLOSED_LIST;
 
 	// 4. Clear the open list, then add the starting node to the open list and initialise its values
-	start->F = start->G = 0;
-	start->OnList = OPEN_LIST;
-	m_openlist.ClearHeap();
-	m_openlist.AddItem(0, start);
+	F[start->Index] = G[start->Index] = 0;
+	onlist[start->Index] = OPEN_LIST;
+	openlist.ClearHeap();
+	openlist.AddItem(0, start);
 
 	// 5. Now loop through the network nodes to build the path
 	while (true)
 	{
 		// If the open list is not empty, we will take the top node (which has the best F score) and add
 		// it to the closed list.  This will form part of the path.
-		if (m_openlist.Size != 0)
+		if (openlist.Size != 0)
 		{
 			// 6. Remove the top node from the open list and add it to the closed list
-			node = m_openlist.Items[1].Item;
-			node->OnList = CLOSED_LIST;
-			m_openlist.RemoveTopItem();
+			node = openlist.Items[1].Item;
+			index = node->Index;
+			onlist[index] = CLOSED_LIST;
+			openlist.RemoveTopItem();
 
 			// 7. Iterate through each node connected to this one and test to see if it should be next in the path
 			for (int i = 0; i < node->NumConnections; i++)
 			{
 				// Get a reference to the node.  Ignore it if the node is on the closed list
 				next = node->Connections[i].Target;
-				if (next->OnList == CLOSED_LIST) continue;
+				nextindex = next->Index;
+				if (onlist[nextindex] == CLOSED_LIST) continue;
+				if (cluster != NO_CLUSTER && m_node_cluster[nextindex] != cluster) continue;
 
 				// If this node is not already on the open list, calculate its values and add it to the list
-				if (next->OnList != OPEN_LIST)
+				if (onlist[nextindex] != OPEN_LIST)
 				{
 					// Calculate the F, G and H cost for this node, and link to its parent
-					next->G = node->G + node->Connections[i].ConnectionCost;	// G = parent node's G-cost plus cost of the new connection
-					next->H = abs(next->Position.x - end->Position.x) +			// H = heuristic; linear distance to the target node
-							  abs(next->Position.y - end->Position.y) + 
-							  abs(next->Position.z - end->Position.z);
-					next->F = next->G + next->H;								// F = G + H
-					next->PathParent = node;									// Parent = the previous node we last added to the closed list
+					G[nextindex] = G[index] + node->Connections[i].ConnectionCost;	// G = parent node's G-cost plus cost of the new connection
+					H[nextindex] = EstimateCost(next, end);							// H = heuristic; linear distance to the target node
+					F[nextindex] = G[nextindex] + H[nextindex];						// F = G + H
+					parent[nextindex] = node;										// Parent = the previous node we last added to the closed list
 
 					// Add the node to the open list
-					m_openlist.AddItem(next->F, next);
-					next->OnList = OPEN_LIST;
+					openlist.AddItem(F[nextindex], next);
+					onlist[nextindex] = OPEN_LIST;
 				}
 				else	/* Item is already on the open list */
 				{
 					// 8. If item is already on the open list, check to see if the current path to it is 
 					// better than the previous one that was defined.  If so, recalculate value & parent
-					newG = node->G + node->Connections[i].ConnectionCost;		// G = parent node's G-cost plus cost of the new connection			
-					if (newG < next->G)
+					newG = G[index] + node->Connections[i].ConnectionCost;			// G = parent node's G-cost plus cost of the new connection			
+					if (newG < G[nextindex])
 					{
 						// This path is better, so update the parent value, F and G scores
-						next->PathParent = node;								// Parent = the new better path parent value
-						next->G = newG;											// G = the new, better G cost reflecting a shorter path from start
-						next->F = next->G + next->H;							// F = G + H, so update based on the new G-score
+						parent[nextindex] = node;									// Parent = the new better path parent value
+						G[nextindex] = newG;										// G = the new, better G cost reflecting a shorter path from start
+						F[nextindex] = G[nextindex] + H[nextindex];					// F = G + H, so update based on the new G-score
 
 						// This could change the node's position on the open list heap.  Reassess now based on its new F-score
-						m_openlist.ReorderElement(next);
+						openlist.DecreaseItemValue(next, F[nextindex]);
 					}
 				}
 			}	// for each connection
@@ -650,7 +722,7 @@ Result NavNetwork::FindPath(NavNode *start, NavNode *end, std::vector<NavNode*>
 
 		// 10. If the path target has now been added to the open list (i.e. is one step away from being added
 		// to the closed list) then we have a complete path and can return it
-		if (end->OnList == OPEN_LIST)
+		if (onlist[end->Index] == OPEN_LIST)
 		{
 			// Push the end element as the first element in the (reverse) output path
 			outPathReverse.push_back(end);
@@ -660,7 +732,7 @@ Result NavNetwork::FindPath(NavNode *start, NavNode *end, std::vector<NavNode*>
 			while (node != start)
 			{
 				// Push this node onto the output vector and move to the next item in the list
-				node = node->PathParent;
+				node = parent[node->Index];
 				outPathReverse.push_back(node);
 			}
 
@@ -674,6 +746,427 @@ Result NavNetwork::FindPath(NavNode *start, NavNode *end, std::vector<NavNode*>
 	return ErrorCodes::UnknownPathfindingError;
 }
 
+// Searches the abstract graph of cluster entrances for a route between clusters, then refines each step of that 
+// route into a full path via searches that are restricted to a single cluster
+Result NavNetwork::FindPathHierarchical(QueryContext & context, NavNode *start, NavNode *end, std::vector<NavNode*> & outPathReverse) const
+{
+	int start_cluster = m_node_cluster[start->Index];
+	int end_cluster = m_node_cluster[end->Index];
+	int target = (int)m_entrance_nodes.size();				// Abstract index representing the path target itself
+
+	// Abstract search entries are (F, entrance) pairs; H is the estimated cost from the entrance to the target
+	auto heuristic = [this, end, target](int entrance) { return (entrance == target ? 0 : EstimateCost(&(m_nodes[m_entrance_nodes[entrance]]), end)); };
+	unsigned int generation = NextSearchGeneration(context.m_abstract_stamp, context.m_abstract_generation);
+	auto relax = [&context, generation, &heuristic](int entrance, int cost, int parent)
+	{
+		if (context.m_abstract_stamp[entrance] == generation && context.m_abstract_cost[entrance] <= cost) return;
+		context.m_abstract_stamp[entrance] = generation;
+		context.m_abstract_cost[entrance] = cost;
+		context.m_abstract_parent[entrance] = parent;
+		context.m_abstract_queue.push_back(std::pair<int, int>(cost + heuristic(entrance), entrance));
+		std::push_heap(context.m_abstract_queue.begin(), context.m_abstract_queue.end(), std::greater<std::pair<int, int>>());
+	};
+
+	// 1. Every entrance that can be reached from the start node within its own cluster is a potential first step
+	context.m_abstract_queue.clear();
+	ClusterSearch(context, start->Index, start_cluster, false);
+	for (int i = m_cluster_entrance_offsets[start_cluster]; i < m_cluster_entrance_offsets[start_cluster + 1]; ++i)
+	{
+		int entrance = m_cluster_entrances[i];
+		int cost = context.GetClusterSearchCost(m_entrance_nodes[entrance]);
+		if (cost >= 0) relax(entrance, cost, -1);
+	}
+
+	// 2. Likewise, every entrance which can reach the end node within its own cluster is a potential last step
+	ClusterSearch(context, end->Index, end_cluster, true);
+	for (int i = m_cluster_entrance_offsets[end_cluster]; i < m_cluster_entrance_offsets[end_cluster + 1]; ++i)
+	{
+		int entrance = m_cluster_entrances[i];
+		context.m_abstract_target_cost[entrance] = context.GetClusterSearchCost(m_entrance_nodes[entrance]);
+	}
+
+	// 3. A* search over the abstract graph until the target is reached
+	bool found = false;
+	while (!context.m_abstract_queue.empty())
+	{
+		std::pop_heap(context.m_abstract_queue.begin(), context.m_abstract_queue.end(), std::greater<std::pair<int, int>>());
+		std::pair<int, int> entry = context.m_abstract_queue.back();
+		context.m_abstract_queue.pop_back();
+
+		int entrance = entry.second;
+		if (entrance == target) { found = true; break; }
+
+		// Ignore any entry which has been superseded by a lower-cost route since it was added
+		int cost = context.m_abstract_cost[entrance];
+		if (entry.first != (cost + heuristic(entrance))) continue;
+
+		for (int i = m_abstract_offsets[entrance]; i < m_abstract_offsets[entrance + 1]; ++i)
+		{
+			relax(m_abstract_edges[i].Target, cost + m_abstract_edges[i].Cost, entrance);
+		}
+
+		if (context.m_abstract_target_cost[entrance] >= 0) relax(target, cost + context.m_abstract_target_cost[entrance], entrance);
+	}
+
+	// Reset the target costs so they are clear for the next search
+	for (int i = m_cluster_entrance_offsets[end_cluster]; i < m_cluster_entrance_offsets[end_cluster + 1]; ++i)
+	{
+		context.m_abstract_target_cost[m_cluster_entrances[i]] = -1;
+	}
+
+	// If the target cannot be reached via the abstract graph then there is no path at all, since any path must pass
+	// through entrances to leave the start cluster and reach the end cluster
+	if (!found) return ErrorCodes::PathDoesNotExist;
+
+	// 4. Trace back the route of entrances, which will be held in reverse (i.e. last entrance first)
+	context.m_abstract_route.clear();
+	for (int entrance = context.m_abstract_parent[target]; entrance != -1; entrance = context.m_abstract_parent[entrance])
+	{
+		context.m_abstract_route.push_back(entrance);
+	}
+
+	// 5. Refine each step of the route into a full path, working backwards from the end node.  Each step either follows a 
+	// direct connection between clusters, or is resolved by a search which is restricted to the cluster both nodes share
+	std::vector<NavNode*>::size_type offset = outPathReverse.size();
+	NavNode *to = end;
+	for (std::vector<int>::size_type i = 0U; i <= context.m_abstract_route.size(); ++i)
+	{
+		NavNode *from = (i < context.m_abstract_route.size() ? &(m_nodes[m_entrance_nodes[context.m_abstract_route[i]]]) : start);
+		if (from == to) continue;
+
+		int cluster = m_node_cluster[from->Index];
+		if (cluster != m_node_cluster[to->Index])
+		{
+			outPathReverse.push_back(to);
+		}
+		else
+		{
+			// Add every node in the path segment except its start node, which will be added by the next step
+			context.m_path_segment.clear();
+			if (FindPathFlat(context, from, to, context.m_path_segment, cluster) != ErrorCodes::NoError)
+			{
+				// This should not be possible, since the abstract graph only links nodes that are connected within the 
+				// cluster.  However resolve via a search of the full network if it does occur
+				outPathReverse.resize(offset);
+				return FindPathFlat(context, start, end, outPathReverse, NO_CLUSTER);
+			}
+			outPathReverse.insert(outPathReverse.end(), context.m_path_segment.begin(), context.m_path_segment.end() - 1);
+		}
+
+		to = from;
+	}
+
+	// The path is completed by the start node itself
+	outPathReverse.push_back(start);
+	return ErrorCodes::NoError;
+}
+
+// Builds the hierarchical layer (clusters, entrance nodes and the abstract graph between them) for the current network
+void NavNetwork::BuildHierarchicalLayer(void)
+{
+	// Remove any existing data
+	ClearHierarchicalLayer();
+	if (m_nodecount <= 0) return;
+
+	/* 1. Assign each node to a cluster.  Clusters are square regions of elements within each deck */
+	m_clusterdims = INTVECTOR3(	(m_elementsize.x + CLUSTER_SIZE - 1) / CLUSTER_SIZE, 
+								(m_elementsize.y + CLUSTER_SIZE - 1) / CLUSTER_SIZE, m_elementsize.z);
+	m_clustercount = (m_clusterdims.x * m_clusterdims.y * m_clusterdims.z);
+
+	m_node_cluster.resize(m_nodecount);
+	for (int i = 0; i < m_nodecount; ++i)
+	{
+		m_node_cluster[i] = GetClusterIndex(m_nodes[i].Element->GetLocation());
+	}
+
+	/* 2. Record the incoming connections to each node, and identify entrance nodes as those with a connection to or from 
+		  another cluster.  Entrances are initially marked with zero and then given their entrance index below */
+	m_incoming_offsets.assign(m_nodecount + 1, 0);
+	m_node_entrance.assign(m_nodecount, -1);
+	for (int i = 0; i < m_nodecount; ++i)
+	{
+		for (int c = 0; c < m_nodes[i].NumConnections; ++c)
+		{
+			int target = m_nodes[i].Connections[c].Target->Index;
+			++m_incoming_offsets[target + 1];
+
+			if (m_node_cluster[target] != m_node_cluster[i]) m_node_entrance[i] = m_node_entrance[target] = 0;
+		}
+	}
+	for (int i = 0; i < m_nodecount; ++i) m_incoming_offsets[i + 1] += m_incoming_offsets[i];
+
+	m_incoming.assign(m_incoming_offsets[m_nodecount], NavEdge(-1, 0));
+	std::vector<int> position(m_incoming_offsets.begin(), m_incoming_offsets.end() - 1);
+	for (int i = 0; i < m_nodecount; ++i)
+	{
+		for (int c = 0; c < m_nodes[i].NumConnections; ++c)
+		{
+			int target = m_nodes[i].Connections[c].Target->Index;
+			m_incoming[position[target]++] = NavEdge(i, m_nodes[i].Connections[c].ConnectionCost);
+		}
+	}
+
+	for (int i = 0; i < m_nodecount; ++i)
+	{
+		if (m_node_entrance[i] == 0) 
+		{
+			m_node_entrance[i] = (int)m_entrance_nodes.size();
+			m_entrance_nodes.push_back(i);
+		}
+	}
+	int entrance_count = (int)m_entrance_nodes.size();
+
+	/* 3. Group the entrances by cluster */
+	m_cluster_entrance_offsets.assign(m_clustercount + 1, 0);
+	for (int e = 0; e < entrance_count; ++e) ++m_cluster_entrance_offsets[m_node_cluster[m_entrance_nodes[e]] + 1];
+	for (int i = 0; i < m_clustercount; ++i) m_cluster_entrance_offsets[i + 1] += m_cluster_entrance_offsets[i];
+
+	m_cluster_entrances.resize(entrance_count);
+	position.assign(m_cluster_entrance_offsets.begin(), m_cluster_entrance_offsets.end() - 1);
+	for (int e = 0; e < entrance_count; ++e) m_cluster_entrances[position[m_node_cluster[m_entrance_nodes[e]]]++] = e;
+
+	/* 4. Build the abstract graph.  Each entrance is linked directly to any entrance in another cluster that it connects 
+		  to, and to every other entrance in its own cluster that it can reach, at the lowest cost of doing so */
+	QueryContext & context = m_default_context;
+	PrepareQueryContext(context);
+
+	m_abstract_offsets.reserve(entrance_count + 1);
+	m_abstract_offsets.push_back(0);
+	for (int e = 0; e < entrance_count; ++e)
+	{
+		const NavNode & node = m_nodes[m_entrance_nodes[e]];
+		int cluster = m_node_cluster[node.Index];
+
+		for (int c = 0; c < node.NumConnections; ++c)
+		{
+			int target = node.Connections[c].Target->Index;
+			if (m_node_cluster[target] != cluster) m_abstract_edges.push_back(NavEdge(m_node_entrance[target], node.Connections[c].ConnectionCost));
+		}
+
+		ClusterSearch(context, node.Index, cluster, false);
+		for (int i = m_cluster_entrance_offsets[cluster]; i < m_cluster_entrance_offsets[cluster + 1]; ++i)
+		{
+			int other = m_cluster_entrances[i];
+			int cost = context.GetClusterSearchCost(m_entrance_nodes[other]);
+			if (other != e && cost >= 0) m_abstract_edges.push_back(NavEdge(other, cost));
+		}
+
+		m_abstract_offsets.push_back((int)m_abstract_edges.size());
+	}
+}
+
+// Releases all data held for the hierarchical layer
+void NavNetwork::ClearHierarchicalLayer(void)
+{
+	m_clusterdims = NULL_INTVECTOR3;
+	m_clustercount = 0;
+
+	m_node_cluster.clear();
+	m_incoming_offsets.clear();			m_incoming.clear();
+	m_entrance_nodes.clear();			m_node_entrance.clear();
+	m_cluster_entrance_offsets.clear(); m_cluster_entrances.clear();
+	m_abstract_offsets.clear();			m_abstract_edges.clear();
+}
+
+// Calculates the lowest cost between the source node and every other node within the same cluster.  Costs are calculated
+// for paths away from the source, or if 'reverse' is set, for paths towards it.  Results are retrieved via context.GetClusterSearchCost
+void NavNetwork::ClusterSearch(QueryContext & context, int source, int cluster, bool reverse) const
+{
+	// Dijkstra search over (cost, node) entries.  Superseded entries are left in the queue and ignored when they are 
+	// removed, which is cheaper than reordering the queue since clusters are small
+	unsigned int generation = NextSearchGeneration(context.m_search_stamp, context.m_search_generation);
+	auto relax = [this, &context, generation, cluster](int node, int cost)
+	{
+		if (m_node_cluster[node] != cluster) return;
+		if (context.m_search_stamp[node] == generation && context.m_search_cost[node] <= cost) return;
+
+		context.m_search_stamp[node] = generation;
+		context.m_search_cost[node] = cost;
+		context.m_search_queue.push_back(std::pair<int, int>(cost, node));
+		std::push_heap(context.m_search_queue.begin(), context.m_search_queue.end(), std::greater<std::pair<int, int>>());
+	};
+
+	context.m_search_queue.clear();
+	relax(source, 0);
+	while (!context.m_search_queue.empty())
+	{
+		std::pop_heap(context.m_search_queue.begin(), context.m_search_queue.end(), std::greater<std::pair<int, int>>());
+		std::pair<int, int> entry = context.m_search_queue.back();
+		context.m_search_queue.pop_back();
+
+		int cost = entry.first, node = entry.second;
+		if (cost != context.m_search_cost[node]) continue;
+
+		if (reverse)
+		{
+			for (int i = m_incoming_offsets[node]; i < m_incoming_offsets[node + 1]; ++i)
+				relax(m_incoming[i].Target, cost + m_incoming[i].Cost);
+		}
+		else
+		{
+			const NavNode & n = m_nodes[node];
+			for (int i = 0; i < n.NumConnections; ++i)
+				relax(n.Connections[i].Target->Index, cost + n.Connections[i].ConnectionCost);
+		}
+	}
+}
+
+// Returns the next search generation, resetting all stamps in the (very rare) event that the counter wraps around
+unsigned int NavNetwork::NextSearchGeneration(std::vector<unsigned int> & stamps, unsigned int & generation)
+{
+	if (++generation == 0U)
+	{
+		std::fill(stamps.begin(), stamps.end(), 0U);
+		generation = 1U;
+	}
+	return generation;
+}
+
+// Heuristic cost estimate between two nodes; the Manhattan distance between them
+int NavNetwork::EstimateCost(const NavNode *from, const NavNode *to)
+{
+	return (abs(from->Position.x - to->Position.x) + abs(from->Position.y - to->Position.y) + abs(from->Position.z - to->Position.z));
+}
+
+// Discards all cached paths
+void NavNetwork::InvalidatePathCache(void)
+{
+	std::lock_guard<std::mutex> lock(m_path_cache_lock);
+	m_path_cache.clear();
+	m_path_cache_index.clear();
+}
+
+// Sets the maximum number of paths retained in the cache, evicting the least-recently-used paths if necessary
+void NavNetwork::SetPathCacheCapacity(size_t capacity)
+{
+	std::lock_guard<std::mutex> lock(m_path_cache_lock);
+	m_path_cache_capacity = capacity;
+	while (m_path_cache.size() > m_path_cache_capacity)
+	{
+		m_path_cache_index.erase(m_path_cache.back().Key);
+		m_path_cache.pop_back();
+	}
+}
+
+// Attempts to retrieve a path from the cache, appending it to the output vector and returning true if found
+bool NavNetwork::RetrieveCachedPath(int start, int end, Result & outResult, std::vector<NavNode*> & outPathReverse)
+{
+	std::lock_guard<std::mutex> lock(m_path_cache_lock);
+	std::unordered_map<PathCacheKey, PathCacheList::iterator, PathCacheKeyHash>::const_iterator it = 
+		m_path_cache_index.find(PathCacheKey(start, end, m_layout_version));
+	if (it == m_path_cache_index.end()) { ++m_path_cache_misses; return false; }
+	++m_path_cache_hits;
+
+	// This is now the most-recently-used path, so move it to the front of the list.  Iterators remain valid
+	m_path_cache.splice(m_path_cache.begin(), m_path_cache, it->second);
+
+	const PathCacheEntry & entry = *(it->second);
+	for (int node : entry.PathReverse) outPathReverse.push_back(&(m_nodes[node]));
+	outResult = entry.PathResult;
+	return true;
+}
+
+// Stores a path in the cache, evicting the least-recently-used path if the cache is full
+void NavNetwork::StoreCachedPath(int start, int end, Result result, const NavNode * const * path, size_t length)
+{
+	std::lock_guard<std::mutex> lock(m_path_cache_lock);
+	PathCacheKey key(start, end, m_layout_version);
+
+	// Another query may have stored the same path in the meantime, in which case there is nothing to add
+	if (m_path_cache_capacity == 0U || m_path_cache_index.count(key) != 0U) return;
+
+	if (m_path_cache.size() >= m_path_cache_capacity)
+	{
+		m_path_cache_index.erase(m_path_cache.back().Key);
+		m_path_cache.pop_back();
+	}
+
+	m_path_cache.push_front(PathCacheEntry(key, result));
+	PathCacheEntry & entry = m_path_cache.front();
+	entry.PathReverse.reserve(length);
+	for (size_t i = 0U; i < length; ++i) entry.PathReverse.push_back(path[i]->Index);
+
+	m_path_cache_index[key] = m_path_cache.begin();
+}
+
+
+// Resolves every request in the batch, distributing the requests across the worker thread pool.  Results are populated
+// within each request.  The network must not be rebuilt while a batch is being resolved
+void NavNetwork::FindPaths(std::vector<PathRequest> & requests)
+{
+	Game::WorkerThreads.ParallelFor((int)requests.size(), PATH_BATCH_GRAIN_SIZE, [this, &requests](int begin, int end)
+	{
+		// Each task resolves its share of the batch using a context of its own
+		QueryContext *context = AcquireBatchContext();
+		for (int i = begin; i < end; ++i)
+		{
+			PathRequest & request = requests[i];
+			request.PathReverse.clear();
+			request.PathResult = FindPath(*context, request.Start, request.End, request.PathReverse);
+		}
+		ReleaseBatchContext(context);
+	});
+}
+
+// Claims a free batch context, creating a new one if required
+NavNetwork::QueryContext * NavNetwork::AcquireBatchContext(void)
+{
+	std::lock_guard<std::mutex> lock(m_batch_context_lock);
+	if (m_free_batch_contexts.empty())
+	{
+		m_batch_contexts.push_back(std::unique_ptr<QueryContext>(new QueryContext()));
+		return m_batch_contexts.back().get();
+	}
+
+	QueryContext *context = m_free_batch_contexts.back();
+	m_free_batch_contexts.pop_back();
+	return context;
+}
+
+// Returns a batch context to the free list once work is complete
+void NavNetwork::ReleaseBatchContext(QueryContext *context)
+{
+	std::lock_guard<std::mutex> lock(m_batch_context_lock);
+	m_free_batch_contexts.push_back(context);
+}
+
+// Ensures that the context is sized for the current layout of this network, resetting its search state if not
+void NavNetwork::PrepareQueryContext(QueryContext & context) const
+{
+	// No action is required if the context was last used with this layout
+	if (context.m_network == this && context.m_layout_version == m_layout_version) return;
+	context.m_network = this;
+	context.m_layout_version = m_layout_version;
+
+	// Allocate a sufficiently-large binary heap for use as the open list, plus the per-node search state
+	context.m_openlist.Initialise(m_nodecount);
+	context.m_f.assign(m_nodecount, 0);
+	context.m_g.assign(m_nodecount, 0);
+	context.m_h.assign(m_nodecount, 0);
+	context.m_parent.assign(m_nodecount, NULL);
+	context.m_onlist.assign(m_nodecount, 0);
+	context.OPEN_LIST = 10; context.CLOSED_LIST = 11;
+
+	// Working storage for cluster searches
+	context.m_search_cost.assign(m_nodecount, 0);
+	context.m_search_stamp.assign(m_nodecount, 0U);
+	context.m_search_generation = 0U;
+
+	// Working storage for abstract searches, with one additional entry for the path target
+	int entrance_count = (int)m_entrance_nodes.size();
+	context.m_abstract_cost.assign(entrance_count + 1, 0);
+	context.m_abstract_parent.assign(entrance_count + 1, -1);
+	context.m_abstract_stamp.assign(entrance_count + 1, 0U);
+	context.m_abstract_generation = 0U;
+	context.m_abstract_target_cost.assign(entrance_count, -1);
+}
+
+// Default constructor for a path query context.  Storage is allocated when the context is first used with a network
+NavNetwork::QueryContext::QueryContext(void)
+	:
+	m_network(NULL), m_layout_version(0U), OPEN_LIST(10), CLOSED_LIST(11), m_search_generation(0U), m_abstract_generation(0U)
+{
+}
 
 
 // Default destructor; no action, deallocation is taken care of in the shutdown method
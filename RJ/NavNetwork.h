@@ -4,6 +4,10 @@
 #define __NavNetworkH__
 
 #include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
 #include "CompilerSettings.h"
 #include "ErrorCodes.h"
 #include "Utility.h"
@@ -17,6 +21,98 @@ class NavNode;
 class NavNetwork
 {
 public:
+
+	// Long-range queries will be resolved via the hierarchical cluster layer, if set.  Otherwise all queries use a flat A* search
+	static bool					USE_HIERARCHICAL_PATHFINDING;
+
+	// Results of previous queries will be retained and reused for identical requests, if set
+	static bool					USE_PATH_CACHE;
+
+	// Dimensions, in elements, of each cluster in the hierarchical layer.  Clusters never span more than one deck
+	static const int			CLUSTER_SIZE = 8;
+
+	// Default maximum number of paths retained in the path cache
+	static const size_t			DEFAULT_PATH_CACHE_CAPACITY = 1024U;
+
+	// Number of requests resolved by each worker task during a batched path query
+	static const int			PATH_BATCH_GRAIN_SIZE = 4;
+
+	// Search state for a single path query.  Queries never modify the network itself, so any number of queries can be
+	// resolved concurrently as long as each uses its own context.  A context is sized for the network it was last used 
+	// with, and is resized automatically if used with a different network or layout
+	// Class has no special alignment requirements
+	class QueryContext
+	{
+	public:
+
+		// Default constructor
+		QueryContext(void);
+
+	protected:
+
+		friend class NavNetwork;
+
+		// Network and layout version that the context is currently sized for
+		const NavNetwork *									m_network;
+		unsigned int										m_layout_version;
+
+		// Open list is maintained as a binary heap for efficiency
+		BinaryHeap<int, NavNode*>							m_openlist;
+
+		// Per-node search state.  F = G + H; G = cost of the path to each node; H = estimated remaining cost to the 
+		// goal, using the Manhattan distance as the heuristic.  Parent is the previous node on the path to each node
+		std::vector<int>									m_f;
+		std::vector<int>									m_g;
+		std::vector<int>									m_h;
+		std::vector<NavNode*>								m_parent;
+
+		// Flags that indicate which list each node is on.  Resets after a long time and wraps around.  For efficiency
+		std::vector<int>									m_onlist;
+		int													OPEN_LIST;
+		int													CLOSED_LIST;
+
+		// Working data for cluster searches; results are valid only for nodes stamped with the current generation
+		std::vector<int>									m_search_cost;
+		std::vector<unsigned int>							m_search_stamp;
+		unsigned int										m_search_generation;
+		std::vector<std::pair<int, int>>					m_search_queue;
+
+		// Working data for abstract graph searches, with one additional entry representing the path target
+		std::vector<int>									m_abstract_cost;
+		std::vector<int>									m_abstract_parent;
+		std::vector<unsigned int>							m_abstract_stamp;
+		unsigned int										m_abstract_generation;
+		std::vector<std::pair<int, int>>					m_abstract_queue;
+		std::vector<int>									m_abstract_target_cost;
+		std::vector<int>									m_abstract_route;
+		std::vector<NavNode*>								m_path_segment;
+
+		// Returns the cost of the given node as determined by the last cluster search, or -1 if it was not reached
+		CMPINLINE int										GetClusterSearchCost(int node) const
+		{ 
+			return (m_search_stamp[node] == m_search_generation ? m_search_cost[node] : -1); 
+		}
+
+	private:
+
+		// Contexts hold per-node state for a specific network and are not copied
+		QueryContext(const QueryContext & other);
+		QueryContext & operator=(const QueryContext & other);
+	};
+
+	// A single request within a batch of path queries.  The result and (reverse) path are populated when the batch is resolved
+	// Class has no special alignment requirements
+	struct PathRequest
+	{
+		NavNode *											Start;
+		NavNode *											End;
+		Result												PathResult;
+		std::vector<NavNode*>								PathReverse;
+
+		PathRequest(void) : Start(NULL), End(NULL), PathResult(ErrorCodes::NoError) { }
+		PathRequest(NavNode *start, NavNode *end) : Start(start), End(end), PathResult(ErrorCodes::NoError) { }
+	};
+
 	// Default constructor
 	NavNetwork(void);
 
@@ -26,17 +122,26 @@ public:
 	// Returns a value indicating whether the network has been successfully initialised
 	CMPINLINE bool				IsInitialised(void)		{ return m_initialised; }
 
-	// Finds a path from one node to another, populating the result vector as a set of nav nodes
+	// Finds a path from one node to another, populating the result vector as a set of nav nodes.  Uses the network's own
+	// query context, and so should only be called from one thread at a time
 	Result						FindPath(NavNode *start, NavNode *end, std::vector<NavNode*> & outPathReverse);
 
+	// Finds a path from one node to another, populating the result vector as a set of nav nodes.  Search state is held
+	// in the supplied context, so this method can be called concurrently from any number of threads with distinct contexts
+	Result						FindPath(QueryContext & context, NavNode *start, NavNode *end, std::vector<NavNode*> & outPathReverse);
+
+	// Resolves every request in the batch, distributing the requests across the worker thread pool.  Results are populated
+	// within each request.  The network must not be rebuilt while a batch is being resolved
+	void						FindPaths(std::vector<PathRequest> & requests);
+
 	// Finds a path from one element position ot another, populating the result vector as a set of nav nodes
 	Result						FindPath(const FXMVECTOR start, const FXMVECTOR end, std::vector<NavNode*> & outPathReverse);
 
 	// Finds the navigation node closest to the specified position
 	CMPINLINE NavNode *			GetClosestNode(const FXMVECTOR pos)
 	{
-		XMStoreFloat3(&m_float3, pos);
-		return GetClosestNode(m_float3);
+		XMFLOAT3 fpos; XMStoreFloat3(&fpos, pos);
+		return GetClosestNode(fpos);
 	}
 
 	// Finds the navigation node closest to the specified position
@@ -57,6 +162,26 @@ public:
 	// Returns a pointer to the immutable node collection for this network
 	CMPINLINE const NavNode *	GetNodes(void) const						{ return m_nodes; }
 
+	// Version of the network layout.  Incremented each time the network is rebuilt, so that any path generated from 
+	// a previous layout can be identified
+	CMPINLINE unsigned int		GetLayoutVersion(void) const				{ return m_layout_version; }
+
+	// Discards all cached paths
+	void						InvalidatePathCache(void);
+
+	// Maximum number of paths retained in the cache; the least-recently-used path is evicted once this is exceeded
+	CMPINLINE size_t			GetPathCacheCapacity(void) const			{ return m_path_cache_capacity; }
+	void						SetPathCacheCapacity(size_t capacity);
+
+	// Path cache statistics
+	CMPINLINE size_t			GetPathCacheSize(void)						{ std::lock_guard<std::mutex> lock(m_path_cache_lock); return m_path_cache.size(); }
+	CMPINLINE unsigned int		GetPathCacheHits(void) const				{ return m_path_cache_hits; }
+	CMPINLINE unsigned int		GetPathCacheMisses(void) const				{ return m_path_cache_misses; }
+
+	// Details of the hierarchical layer
+	CMPINLINE int				GetClusterCount(void) const					{ return m_clustercount; }
+	CMPINLINE int				GetEntranceNodeCount(void) const			{ return (int)m_entrance_nodes.size(); }
+
 	// Outputs a string representation of the network
 	std::string					OutputAsString(void);
 
@@ -82,16 +207,63 @@ private:
 	// Flag indicating whether the network has been initialised based on a parent object that contains elements
 	bool												m_initialised;
 
-	// Open list is maintained as a binary heap for efficiency
-	BinaryHeap<int, NavNode*>							m_openlist;
+	// Query context used for single-threaded queries and for building the hierarchical layer
+	QueryContext										m_default_context;
+
+	// Contexts used to resolve batched queries.  Each batch task claims a free context for the duration of its work
+	std::vector<std::unique_ptr<QueryContext>>			m_batch_contexts;
+	std::vector<QueryContext*>							m_free_batch_contexts;
+	std::mutex											m_batch_context_lock;
+
+	// Ensures that the context is sized for the current layout of this network, resetting its search state if not
+	void						PrepareQueryContext(QueryContext & context) const;
 
-	// Flags that indicate which list a node is on.  Resets after a long time and wraps around.  For efficiency
-	int													OPEN_LIST;
-	int													CLOSED_LIST;
+	// Claims a free batch context, creating a new one if required, and returns it to the free list once work is complete
+	QueryContext *				AcquireBatchContext(void);
+	void						ReleaseBatchContext(QueryContext *context);
 
 	// Selects one node from an array based on its proximity to the edge of its element
 	NavNode *					GetNodeNearestToEdge(NavNode **nodes, int nodecount, Direction edge);
 
+	// Value used to indicate that a search is not restricted to any cluster
+	static const int			NO_CLUSTER = -1;
+
+	// Performs an A* search over the node network, populating the result vector as a (reverse) set of nav nodes.  Search
+	// can optionally be restricted to nodes within a single cluster
+	Result						FindPathFlat(QueryContext & context, NavNode *start, NavNode *end, std::vector<NavNode*> & outPathReverse, int cluster) const;
+
+	// Searches the abstract graph of cluster entrances for a route between clusters, then refines each step of that 
+	// route into a full path via searches that are restricted to a single cluster
+	Result						FindPathHierarchical(QueryContext & context, NavNode *start, NavNode *end, std::vector<NavNode*> & outPathReverse) const;
+
+	// Builds the hierarchical layer (clusters, entrance nodes and the abstract graph between them) for the current network
+	void						BuildHierarchicalLayer(void);
+
+	// Releases all data held for the hierarchical layer
+	void						ClearHierarchicalLayer(void);
+
+	// Returns the cluster containing the given element location
+	CMPINLINE int				GetClusterIndex(const INTVECTOR3 & location) const
+	{
+		return ((location.x / CLUSTER_SIZE) + ((location.y / CLUSTER_SIZE) * m_clusterdims.x) + (location.z * m_clusterdims.x * m_clusterdims.y));
+	}
+
+	// Calculates the lowest cost between the source node and every other node within the same cluster.  Costs are calculated
+	// for paths away from the source, or if 'reverse' is set, for paths towards it.  Results are retrieved via context.GetClusterSearchCost
+	void						ClusterSearch(QueryContext & context, int source, int cluster, bool reverse) const;
+
+	// Returns the next search generation, resetting all stamps in the (very rare) event that the counter wraps around
+	static unsigned int			NextSearchGeneration(std::vector<unsigned int> & stamps, unsigned int & generation);
+
+	// Heuristic cost estimate between two nodes; the Manhattan distance between them
+	static int					EstimateCost(const NavNode *from, const NavNode *to);
+
+	// Attempts to retrieve a path from the cache, appending it to the output vector and returning true if found
+	bool						RetrieveCachedPath(int start, int end, Result & outResult, std::vector<NavNode*> & outPathReverse);
+
+	// Stores a path in the cache, evicting the least-recently-used path if the cache is full
+	void						StoreCachedPath(int start, int end, Result result, const NavNode * const * path, size_t length);
+
 
 	// Temporary structure used to hold connection data while the network is being built
 	struct tmpconndata { 
@@ -99,8 +271,86 @@ private:
 		tmpconndata(NavNode *_src, NavNode *_tgt, int _cost) { src = _src; tgt = _tgt; cost = _cost; }
 	};
 
-	// Temporary storage for local float representations of vector data
-	XMFLOAT3											m_float3;
+	// Incremented each time the network is rebuilt
+	unsigned int										m_layout_version;
+
+
+	/* Hierarchical layer */
+
+	// Edge in either the reverse node graph or the abstract entrance graph
+	struct NavEdge {
+		int Target; int Cost;
+		NavEdge(int _target, int _cost) { Target = _target; Cost = _cost; }
+	};
+
+	// Number of clusters in each dimension, and in total
+	INTVECTOR3											m_clusterdims;
+	int													m_clustercount;
+
+	// Cluster containing each node
+	std::vector<int>									m_node_cluster;
+
+	// Incoming connections for each node, held as offsets into a single edge array.  Allows cost calculations towards a node
+	std::vector<int>									m_incoming_offsets;
+	std::vector<NavEdge>								m_incoming;
+
+	// Entrance nodes are those with a connection to or from another cluster, and form the nodes of the abstract graph.  Stores 
+	// the node index of each entrance, and the entrance index of each node (or -1 for non-entrance nodes)
+	std::vector<int>									m_entrance_nodes;
+	std::vector<int>									m_node_entrance;
+
+	// Entrances within each cluster, held as offsets into a single array of entrance indices
+	std::vector<int>									m_cluster_entrance_offsets;
+	std::vector<int>									m_cluster_entrances;
+
+	// Edges of the abstract graph between entrances, held as offsets into a single edge array.  Edges are either a direct 
+	// connection to an entrance in another cluster, or the lowest-cost route to another entrance within the same cluster
+	std::vector<int>									m_abstract_offsets;
+	std::vector<NavEdge>								m_abstract_edges;
+
+
+	/* Path cache */
+
+	// Cached paths are keyed on the start and end nodes, and the network layout they were generated from
+	struct PathCacheKey
+	{
+		int Start; int End; unsigned int LayoutVersion;
+		PathCacheKey(int _start, int _end, unsigned int _version) { Start = _start; End = _end; LayoutVersion = _version; }
+		CMPINLINE bool operator==(const PathCacheKey & other) const
+		{
+			return (Start == other.Start && End == other.End && LayoutVersion == other.LayoutVersion);
+		}
+	};
+	struct PathCacheKeyHash
+	{
+		CMPINLINE size_t operator()(const PathCacheKey & key) const
+		{
+			size_t h = std::hash<int>()(key.Start);
+			h ^= std::hash<int>()(key.End) + 0x9e3779b9 + (h << 6) + (h >> 2);
+			h ^= std::hash<unsigned int>()(key.LayoutVersion) + 0x9e3779b9 + (h << 6) + (h >> 2);
+			return h;
+		}
+	};
+
+	// Cached path result, with the (reverse) path held as node indices
+	struct PathCacheEntry
+	{
+		PathCacheKey Key;
+		Result PathResult;
+		std::vector<int> PathReverse;
+		PathCacheEntry(const PathCacheKey & key, Result result) : Key(key), PathResult(result) { }
+	};
+
+	// Cached paths are held in order of use, most-recently-used first, with a lookup from each key into the list.  All
+	// access to the cache is serialised so that it can be shared by concurrent queries
+	typedef std::list<PathCacheEntry>					PathCacheList;
+	PathCacheList										m_path_cache;
+	std::unordered_map<PathCacheKey, PathCacheList::iterator, PathCacheKeyHash>	m_path_cache_index;
+	size_t												m_path_cache_capacity;
+	std::mutex											m_path_cache_lock;
+
+	unsigned int										m_path_cache_hits;
+	unsigned int										m_path_cache_misses;
 };
 
 
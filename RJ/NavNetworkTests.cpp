@@ -0,0 +1,295 @@
+#include "ErrorCodes.h"
+#include "GameObjects.h"
+#include "ComplexShip.h"
+#include "ComplexShipSection.h"
+#include "ComplexShipElement.h"
+#include "NavNetwork.h"
+#include "NavNode.h"
+#include "Order_ActorTravelToPosition.h"
+
+#include "NavNetworkTests.h"
+
+
+// Dimensions of the test environment; spans several clusters in each direction across a single deck
+static const int NAV_TEST_SIZE = (NavNetwork::CLUSTER_SIZE * 3);
+
+// Element locations used as the start and end points of test paths; spread across different clusters and either side of each wall
+static const INTVECTOR3 NAV_TEST_LOCATIONS[] = {
+	INTVECTOR3(1, 1, 0), INTVECTOR3(2, 20, 0), INTVECTOR3(9, 9, 0), INTVECTOR3(14, 2, 0), INTVECTOR3(20, 6, 0),
+	INTVECTOR3(16, 16, 0), INTVECTOR3(22, 21, 0), INTVECTOR3(6, 17, 0), INTVECTOR3(12, 22, 0), INTVECTOR3(19, 14, 0)
+};
+static const int NAV_TEST_LOCATION_COUNT = (sizeof(NAV_TEST_LOCATIONS) / sizeof(NAV_TEST_LOCATIONS[0]));
+
+
+TestResult NavNetworkTests::HierarchicalPathCostTests()
+{
+	TestResult result = NewResult();
+	bool hierarchical = NavNetwork::USE_HIERARCHICAL_PATHFINDING, cache = NavNetwork::USE_PATH_CACHE;
+	NavNetwork::USE_PATH_CACHE = false;
+
+	auto env = GenerateTestNavEnvironment();
+	NavNetwork *network = env->GetNavNetwork();
+	result.Assert(network != NULL && network->IsInitialised(), ERR("Nav network was not initialised for test environment"));
+	if (!network) return result;
+	result.AssertTrue(network->GetClusterCount() > 1, ERR("Test environment did not generate multiple clusters"));
+	result.AssertTrue(network->GetEntranceNodeCount() > 0, ERR("Test environment did not generate any cluster entrances"));
+
+	// Every path resolved via the hierarchical layer should have exactly the same cost as the equivalent flat A* search
+	int found = 0;
+	std::vector<NavNode*> hpath, fpath;
+	for (int i = 0; i < NAV_TEST_LOCATION_COUNT; ++i)
+	{
+		for (int j = 0; j < NAV_TEST_LOCATION_COUNT; ++j)
+		{
+			if (i == j) continue;
+			NavNode *start = env->GetElementDirect(NAV_TEST_LOCATIONS[i]).NavNodes[0];
+			NavNode *end = env->GetElementDirect(NAV_TEST_LOCATIONS[j]).NavNodes[0];
+
+			hpath.clear(); fpath.clear();
+			NavNetwork::USE_HIERARCHICAL_PATHFINDING = true;
+			Result hresult = network->FindPath(start, end, hpath);
+			NavNetwork::USE_HIERARCHICAL_PATHFINDING = false;
+			Result fresult = network->FindPath(start, end, fpath);
+
+			result.AssertEqual(hresult, fresult, ERR("Hierarchical and flat searches disagree on whether a path exists"));
+			if (hresult != ErrorCodes::NoError || fresult != ErrorCodes::NoError) continue;
+
+			++found;
+			result.Assert(hpath.front() == end && hpath.back() == start, ERR("Hierarchical path does not connect start and end nodes"));
+			int hcost = DeterminePathCost(hpath);
+			result.AssertTrue(hcost >= 0, ERR("Hierarchical path includes a step which does not follow a valid connection"));
+			result.AssertEqual(hcost, DeterminePathCost(fpath), ERR("Hierarchical path cost does not match flat A* path cost"));
+		}
+	}
+	result.AssertTrue(found > 0, ERR("No valid paths were generated across the test environment"));
+
+	NavNetwork::USE_HIERARCHICAL_PATHFINDING = hierarchical;
+	NavNetwork::USE_PATH_CACHE = cache;
+	return result;
+}
+
+TestResult NavNetworkTests::PathCacheInvalidationTests()
+{
+	TestResult result = NewResult();
+	bool cache = NavNetwork::USE_PATH_CACHE;
+	NavNetwork::USE_PATH_CACHE = true;
+
+	auto env = GenerateTestNavEnvironment();
+	NavNetwork *network = env->GetNavNetwork();
+	if (!network) { result.Assert(false, ERR("Nav network was not initialised for test environment")); return result; }
+	network->InvalidatePathCache();
+
+	// A repeated query should be served from the cache, and return exactly the same path
+	const INTVECTOR3 start_loc = INTVECTOR3(1, 1, 0), end_loc = INTVECTOR3(20, 6, 0), gap_loc = INTVECTOR3(11, 3, 0);
+	std::vector<NavNode*> path, cached;
+	unsigned int misses = network->GetPathCacheMisses(), hits = network->GetPathCacheHits();
+	Result first = network->FindPath(env->GetElementDirect(start_loc).NavNodes[0], env->GetElementDirect(end_loc).NavNodes[0], path);
+	result.AssertEqual(first, ErrorCodes::NoError, ERR("Failed to generate initial path for cache tests"));
+	result.AssertEqual(network->GetPathCacheMisses(), misses + 1U, ERR("Initial query was not recorded as a cache miss"));
+	result.AssertEqual(network->GetPathCacheSize(), (size_t)1U, ERR("Initial query was not stored in the path cache"));
+
+	Result second = network->FindPath(env->GetElementDirect(start_loc).NavNodes[0], env->GetElementDirect(end_loc).NavNodes[0], cached);
+	result.AssertEqual(second, first, ERR("Cached query returned a different result"));
+	result.AssertEqual(network->GetPathCacheHits(), hits + 1U, ERR("Repeated query was not served from the path cache"));
+	result.Assert(cached == path, ERR("Cached query returned a different path"));
+	int original_cost = DeterminePathCost(path);
+
+	// Close the wall gap used by the original path and rebuild the network.  This moves to a new layout version, so the
+	// cached path must be discarded and the next query must route around the closed gap
+	unsigned int version = network->GetLayoutVersion();
+	env->GetElementDirect(gap_loc).ClearProperty(ComplexShipElement::PROPERTY::PROP_WALKABLE);
+	env->UpdateNavigationNetwork();
+	network = env->GetNavNetwork();
+
+	result.Assert(network->GetLayoutVersion() != version, ERR("Layout version was not changed when network was rebuilt"));
+	result.AssertEqual(network->GetPathCacheSize(), (size_t)0U, ERR("Path cache was not invalidated when network layout changed"));
+
+	path.clear();
+	misses = network->GetPathCacheMisses();
+	Result rebuilt = network->FindPath(env->GetElementDirect(start_loc).NavNodes[0], env->GetElementDirect(end_loc).NavNodes[0], path);
+	result.AssertEqual(rebuilt, ErrorCodes::NoError, ERR("Failed to generate path following layout change"));
+	result.AssertEqual(network->GetPathCacheMisses(), misses + 1U, ERR("Query following layout change was served from a stale cache entry"));
+	result.AssertTrue(DeterminePathCost(path) > original_cost, ERR("Path following layout change was not rerouted around the closed gap"));
+	for (NavNode *node : path)
+	{
+		result.Assert(node->Element != &(env->GetElementDirect(gap_loc)), ERR("Path following layout change passes through a non-walkable element"));
+	}
+
+	NavNetwork::USE_PATH_CACHE = cache;
+	return result;
+}
+
+TestResult NavNetworkTests::BatchedQueryTests()
+{
+	TestResult result = NewResult();
+	bool cache = NavNetwork::USE_PATH_CACHE;
+	NavNetwork::USE_PATH_CACHE = false;
+
+	auto env = GenerateTestNavEnvironment();
+	NavNetwork *network = env->GetNavNetwork();
+	if (!network) { result.Assert(false, ERR("Nav network was not initialised for test environment")); return result; }
+
+	// Build a batch containing every pair of test locations, plus requests to an unreachable node
+	NavNode *isolated = env->GetElementDirect(NAV_TEST_SIZE - 1, NAV_TEST_SIZE - 1, 0).NavNodes[0];
+	std::vector<NavNetwork::PathRequest> requests;
+	for (int i = 0; i < NAV_TEST_LOCATION_COUNT; ++i)
+	{
+		NavNode *start = env->GetElementDirect(NAV_TEST_LOCATIONS[i]).NavNodes[0];
+		for (int j = 0; j < NAV_TEST_LOCATION_COUNT; ++j)
+		{
+			requests.push_back(NavNetwork::PathRequest(start, env->GetElementDirect(NAV_TEST_LOCATIONS[j]).NavNodes[0]));
+		}
+		requests.push_back(NavNetwork::PathRequest(start, isolated));
+	}
+
+	// Resolve each request serially via the network's own context
+	std::vector<Result> expected_results;
+	std::vector<std::vector<NavNode*>> expected_paths(requests.size());
+	for (std::vector<NavNetwork::PathRequest>::size_type i = 0U; i < requests.size(); ++i)
+	{
+		expected_results.push_back(network->FindPath(requests[i].Start, requests[i].End, expected_paths[i]));
+	}
+
+	// The batched query should generate exactly the same result and path for every request, both with and without
+	// the path cache shared between concurrent queries
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		NavNetwork::USE_PATH_CACHE = (pass != 0);
+		network->InvalidatePathCache();
+		network->FindPaths(requests);
+
+		for (std::vector<NavNetwork::PathRequest>::size_type i = 0U; i < requests.size(); ++i)
+		{
+			result.AssertEqual(requests[i].PathResult, expected_results[i], ERR("Batched query result does not match serial query"));
+			result.Assert(requests[i].PathReverse == expected_paths[i], ERR("Batched query path does not match serial query"));
+		}
+		result.AssertEqual(requests.back().PathResult, (Result)ErrorCodes::PathDoesNotExist, ERR("Batched query generated a path to an unreachable node"));
+	}
+
+	NavNetwork::USE_PATH_CACHE = cache;
+	return result;
+}
+
+TestResult NavNetworkTests::DeferredTravelOrderTests()
+{
+	TestResult result = NewResult();
+	bool cache = NavNetwork::USE_PATH_CACHE;
+	NavNetwork::USE_PATH_CACHE = false;
+
+	// Travel orders refer to their environment by ID, so the environment must be registered.  Unregistering the environment
+	// will also deallocate it
+	ComplexShip *env = GenerateTestNavEnvironment().release();
+	env->SetSimulationState(iObject::ObjectSimulationState::FullSimulation);
+	auto position = [](const INTVECTOR3 & location) { return XMVectorAdd(Game::ElementLocationToPhysicalPosition(location), Game::C_CS_ELEMENT_MIDPOINT_V); };
+
+	// Orders issued together are held for a single batch calculation.  An order deallocated before the batch is calculated
+	// must be removed from it
+	std::vector<Order_ActorTravelToPosition*> batched, immediate;
+	for (int i = 0; i < NAV_TEST_LOCATION_COUNT; ++i)
+	{
+		XMVECTOR start = position(NAV_TEST_LOCATIONS[i]);
+		XMVECTOR end = position(NAV_TEST_LOCATIONS[(i + 1) % NAV_TEST_LOCATION_COUNT]);
+
+		batched.push_back(new Order_ActorTravelToPosition(env, start, end, 1.0f, 1.0f, false));
+		immediate.push_back(new Order_ActorTravelToPosition(env, start, end, 1.0f, 1.0f, false, false));
+		immediate.back()->CalculateTravelPath();
+
+		if (i == 0) delete (new Order_ActorTravelToPosition(env, start, end, 1.0f, 1.0f, false));
+	}
+
+	for (Order_ActorTravelToPosition *order : batched)
+	{
+		result.AssertTrue(order->IsTravelPathPending(), ERR("Travel order path was not deferred for batch calculation"));
+		result.AssertEqual(order->PathLength, 0, ERR("Travel order path was calculated before the batch"));
+	}
+
+	// The batch should generate exactly the same path for every order as one calculated immediately
+	Order_ActorTravelToPosition::CalculatePendingTravelPaths();
+	for (std::vector<Order_ActorTravelToPosition*>::size_type i = 0U; i < batched.size(); ++i)
+	{
+		result.AssertTrue(!batched[i]->IsTravelPathPending(), ERR("Travel order path remains pending after batch calculation"));
+		result.AssertTrue(immediate[i]->PathLength > 1, ERR("Immediate travel order did not generate a path"));
+		result.AssertEqual(batched[i]->PathLength, immediate[i]->PathLength, ERR("Batched travel order path length does not match immediate calculation"));
+
+		bool identical = (batched[i]->PathLength == immediate[i]->PathLength);
+		for (int n = 0; n < batched[i]->PathLength && identical; ++n)
+		{
+			identical = (batched[i]->PathNodes[n] == immediate[i]->PathNodes[n]);
+		}
+		result.AssertTrue(identical, ERR("Batched travel order path does not match immediate calculation"));
+	}
+
+	for (Order_ActorTravelToPosition *order : batched) delete order;
+	for (Order_ActorTravelToPosition *order : immediate) delete order;
+	Game::UnregisterObject(env);
+
+	NavNetwork::USE_PATH_CACHE = cache;
+	return result;
+}
+
+std::unique_ptr<ComplexShip> NavNetworkTests::GenerateTestNavEnvironment(void)
+{
+	INTVECTOR3 size = INTVECTOR3(NAV_TEST_SIZE, NAV_TEST_SIZE, 1);
+	ComplexShipSection *sec = new ComplexShipSection();
+	sec->ResizeSection(size);
+	sec->DefaultElementState.ApplyDefaultElementState(ElementStateDefinition::ElementState(ComplexShipElement::PROPERTY::PROP_ACTIVE));
+
+	ComplexShip *env = new ComplexShip();
+	env->InitialiseElements(size);
+	env->AddShipSection(sec);
+	env->UpdateEnvironment();
+
+	// All elements are walkable, except for two walls that divide the environment and each contain two narrow gaps,
+	// and the elements surrounding the final corner element, which is therefore unreachable
+	for (int x = 0; x < size.x; ++x)
+	{
+		for (int y = 0; y < size.y; ++y)
+		{
+			ComplexShipElement & el = env->GetElementDirect(x, y, 0);
+			el.SetProperty(ComplexShipElement::PROPERTY::PROP_ACTIVE);
+
+			bool wall = ((x == 11 && y != 3 && y != 20) || (y == 13 && x != 5 && x != 18) ||
+						 (x >= (size.x - 2) && y >= (size.y - 2) && !(x == (size.x - 1) && y == (size.y - 1))));
+			if (wall)	el.ClearProperty(ComplexShipElement::PROPERTY::PROP_WALKABLE);
+			else		el.SetProperty(ComplexShipElement::PROPERTY::PROP_WALKABLE);
+		}
+	}
+
+	// Walkable elements connect to each walkable neighbour on the same deck
+	static const Direction directions[] = { Direction::Left, Direction::Up, Direction::Right, Direction::Down };
+	int n = env->GetElementCount();
+	for (int i = 0; i < n; ++i)
+	{
+		ComplexShipElement & el = env->GetElementDirect(i);
+		el.SetConnectionState(0U);
+		if (!el.IsWalkable()) continue;
+
+		for (Direction dir : directions)
+		{
+			int neighbour = el.GetNeighbour(dir);
+			el.SetConnectionStateInDirection(DirectionToBS(dir), (neighbour != ComplexShipElement::NO_ELEMENT && env->GetElementDirect(neighbour).IsWalkable()));
+		}
+	}
+
+	env->UpdateNavigationNetwork();
+	return std::unique_ptr<ComplexShip>(env);
+}
+
+int NavNetworkTests::DeterminePathCost(const std::vector<NavNode*> & path_reverse)
+{
+	int cost = 0;
+	for (std::vector<NavNode*>::size_type i = 1U; i < path_reverse.size(); ++i)
+	{
+		const NavNode *from = path_reverse[i], *to = path_reverse[i - 1];
+		int step = -1;
+		for (int c = 0; c < from->NumConnections; ++c)
+		{
+			if (from->Connections[c].Target == to) { step = from->Connections[c].ConnectionCost; break; }
+		}
+
+		if (step < 0) return -1;
+		cost += step;
+	}
+
+	return cost;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "CompilerSettings.h"
+#include "TestBase.h"
+class ComplexShip;
+class NavNode;
+
+class NavNetworkTests : public TestBase
+{
+public:
+
+	CMPINLINE TestResult RunTests(void)
+	{
+		TestResult result = NewNamedResult(NavNetworkTests);
+
+		result += HierarchicalPathCostTests();
+		result += PathCacheInvalidationTests();
+		result += BatchedQueryTests();
+		result += DeferredTravelOrderTests();
+
+		return result;
+	}
+
+
+private:
+
+	TestResult HierarchicalPathCostTests();
+	TestResult PathCacheInvalidationTests();
+	TestResult BatchedQueryTests();
+	TestResult DeferredTravelOrderTests();
+
+	// Generates a single-deck walkable environment spanning several clusters, divided by walls with narrow gaps
+	std::unique_ptr<ComplexShip> GenerateTestNavEnvironment(void);
+
+	// Returns the total connection cost of a (reverse) path, or -1 if any step does not follow a valid connection
+	int DeterminePathCost(const std::vector<NavNode*> & path_reverse);
+
+};
@@ -3,12 +3,18 @@
 #ifndef __ObjectSearchH__
 #define __ObjectSearchH__
 
+#include <sstream>
+#include <algorithm>
 #include "Utility.h"
+#include "FastMath.h"
+#include "Timers.h"
+#include "Logging.h"
 #include "Octree.h"
 #include "ObjectReference.h"
 #include "iObject.h"
 #include "ComplexShipSection.h"
 #include "CapitalShipPerimeterBeacon.h"
+#include "SpatialQueryKernels.h"
 
 // Debug options that will store or report additional data.  Only available in debug builds
 #ifdef _DEBUG
@@ -127,6 +133,31 @@ namespace Game
 			else return 0;
 		}
 
+		// Vectorised search for all items within the specified distance of an object, returning only the ID of each match.  Candidate
+		// data is gathered once into SoA streams and then tested in SIMD batches.  Does not use or populate the search cache
+		CMPINLINE int GetAllObjectIDsWithinDistance(const T *focalobject, float distance, std::vector<Game::ID_TYPE> & outResult, SearchOptions options)
+		{
+			if (focalobject) return _GetAllObjectIDsWithinDistance(focalobject->GetSpatialTreeNode(), focalobject->GetPosition(),
+				(CheckBit_Single(options, ObjectSearchOptions::IgnoreFocalObjectBoundary) ? distance : distance + focalobject->GetCollisionSphereRadius()),
+				outResult, options);
+			else return 0;
+		}
+
+		// Vectorised search for all items within the specified distance of a position, returning only the ID of each match.  Requires 
+		// us to locate the most relevant Octree node, so less efficient than the method that supplies a space object
+		CMPINLINE int GetAllObjectIDsWithinDistance(const FXMVECTOR position, Octree<T*> *sp_tree, float distance,
+			std::vector<Game::ID_TYPE> & outResult, SearchOptions options)
+		{
+			if (sp_tree) return _GetAllObjectIDsWithinDistance(sp_tree->GetNodeContainingPoint(position), position, distance, outResult, options);
+			else return 0;
+		}
+
+		// Benchmarks the vectorised ID search against the standard search, using random query points within the bounds of the
+		// given spatial tree.  Each search is timed in full, including tree traversal, and the sorted set of IDs returned by 
+		// each method is compared, both with and without target object boundaries.  The search cache is disabled during the 
+		// benchmark so that every standard search is evaluated
+		std::string RunBenchmark(Octree<T*> *sp_tree, int queries, float distance);
+
 		// Performs a custom (non-cached) search with a specified radius, based on the supplied predicate
 		template <typename UnaryPredicate>
 		CMPINLINE int CustomSearch(const T *focalobject, float distance, std::vector<T*> & outResult, UnaryPredicate Predicate)
@@ -179,6 +210,28 @@ namespace Game
 		int _GetAllObjectsWithinDistance(Octree<T*> *node, const FXMVECTOR position, float distance,
 												std::vector<T*> & outResult, SearchOptions options);
 
+		// Vectorised internal search method.  Gathers the search data held by each relevant node for its items into SoA streams,
+		// then tests them in SIMD batches and returns the ID of each match
+		int _GetAllObjectIDsWithinDistance(Octree<T*> *node, const FXMVECTOR position, float distance,
+												std::vector<Game::ID_TYPE> & outResult, SearchOptions options);
+
+		// Appends any children of the given branch node which overlap the specified bounds to the search candidate node list.  
+		// Returns the number of nodes added
+		CMPINLINE int AppendOverlappingChildNodes(Octree<T*> *node, const FXMVECTOR vmin, const FXMVECTOR vmax)
+		{
+			int added = 0;
+			for (int i = 0; i < 8; ++i)
+			{
+				Octree<T*> *child = node->m_children[i];
+				if (XMVector3Less(vmin, child->m_max) && XMVector3GreaterOrEqual(vmax, child->m_min))
+				{
+					m_search_candidate_nodes.push_back(child);
+					++added;
+				}
+			}
+			return added;
+		}
+
 		// Primary custom search method.  Searches for all items within the specified distance of a position, using a custom
 		// predicate to select results.  Accepts the appropriate Octree node as an input; this is derived or supplied 
 		// by the various publicly-invoked methods
@@ -401,9 +454,13 @@ namespace Game
 		typename std::vector<T*>::const_iterator						search_obj_end;
 		typename std::vector<T*>::const_iterator						search_obj_it;
 		std::vector<T*>													m_search_large_objects;
+		std::vector<Game::ID_TYPE>										m_search_large_object_ids;
 		T *																m_search_last_large_obj;
 		bool															m_search_found_large_object;
 
+		// SoA candidate streams populated during vectorised searches
+		SpatialQueryKernels::CandidateSet								m_search_candidates;
+
 		// Flag determining whether search caching is enabled or not
 		bool															m_cache_enabled;
 
@@ -431,6 +488,8 @@ namespace Game
 		// Pre-allocate space for the frequently used internal vectors, for runtime efficiency
 		m_search_candidate_nodes.reserve(1024);
 		m_search_large_objects.reserve(64);
+		m_search_large_object_ids.reserve(64);
+		m_search_candidates.Reserve(1024);
 
 		// Initialise the search cache and preallocate to the maximum size
 		m_cache_enabled = true;
@@ -475,6 +534,8 @@ namespace Game
 		m_searchcache.clear();
 		m_search_candidate_nodes.clear();
 		m_search_large_objects.clear();
+		m_search_large_object_ids.clear();
+		m_search_candidates.Clear();
 		m_search_found_large_object = false;
 		m_search_last_large_obj = NULL;
 	}
@@ -895,6 +956,155 @@ namespace Game
 	}
 
 
+	// Vectorised internal search method.  Gathers the search data held by each relevant node for its items into SoA streams,
+	// then tests them in SIMD batches and returns the ID of each match
+	template <class T>
+	int ObjectSearch<T>::_GetAllObjectIDsWithinDistance(Octree<T*> *node, const FXMVECTOR position, float distance,
+														std::vector<Game::ID_TYPE> & outResult, int options)
+	{
+		// We a pointer to the relevant spatial partitioning Octree to search for objects.  If we don't have one, return nothing immediately
+		if (!node) return 0;
+		bool ignore_target_boundaries = CheckBit_Single(options, ObjectSearchOptions::IgnoreTargetObjectBoundaries);
+
+		// Determine the octree bounds that we need to consider
+		XMVECTOR sdist = XMVectorReplicate(distance);
+		XMVECTOR vmin = XMVectorSubtract(position, sdist);
+		XMVECTOR vmax = XMVectorAdd(position, sdist);
+
+		// Traverse up the tree until we find a node that fully contains the search area, or we reach the root
+		while (node->m_parent && !(XMVector3GreaterOrEqual(vmin, node->m_min) && XMVector3Less(vmax, node->m_max)))
+		{
+			node = node->m_parent;
+		}
+
+		// Initialise the candidate streams and search state
+		m_search_candidates.Clear();
+		m_search_candidate_nodes.clear();
+		m_search_candidate_nodes.push_back(node);
+		m_search_large_object_ids.clear();
+
+		// Determine the item flags which exclude a candidate, based on the search options
+		uint8_t required_flags = 0U;
+		if (CheckBit_Single(options, ObjectSearchOptions::OnlyCollidingObjects)) SetBit(required_flags, OctreeSearchData::Flag::Colliding);
+		if (CheckBit_Single(options, ObjectSearchOptions::OnlyActiveColliders)) SetBit(required_flags, OctreeSearchData::Flag::ActiveCollider);
+
+		/* Phase 1: gather.  Walk all relevant nodes and copy the search data of every eligible candidate into contiguous SoA 
+		   streams.  Search data is held by each node alongside its items, so no objects are dereferenced at any point */
+		int index = -1, count = 1;
+		while (++index < count)
+		{
+			node = m_search_candidate_nodes[index]; if (!node) continue;
+			if (node->IsBranchNode())
+			{
+				count += AppendOverlappingChildNodes(node, vmin, vmax);
+				continue;
+			}
+
+			int n = node->m_itemcount;
+			for (int i = 0; i < n; ++i)
+			{
+				// Apply the same collision-based filtering as the standard search, and skip any items which can never be returned
+				uint8_t flags = node->m_item_searchflags[i];
+				if ((flags & required_flags) != required_flags || CheckBit_Any(flags, OctreeSearchData::Flag::Excluded)) continue;
+
+				// Large objects may be reachable via several nodes (through their beacons and sections); make sure each is only gathered once.
+				// As in the standard search, large objects are always tested against their collision radius, even if target object 
+				// boundaries are being ignored
+				Game::ID_TYPE id = node->m_item_searchid[i];
+				float radiussq = (ignore_target_boundaries ? 0.0f : node->m_item_radiussq[i]);
+				if (CheckBit_Any(flags, OctreeSearchData::Flag::LargeObject))
+				{
+					if (std::find(m_search_large_object_ids.begin(), m_search_large_object_ids.end(), id) != m_search_large_object_ids.end()) continue;
+					m_search_large_object_ids.push_back(id);
+					radiussq = node->m_item_radiussq[i];
+				}
+
+				m_search_candidates.Add(id, node->m_item_x[i], node->m_item_y[i], node->m_item_z[i], radiussq);
+			}
+		}
+
+		/* Phase 2: test.  Run the SIMD sphere kernel over the gathered streams, emitting only object IDs.  Any target boundaries
+		   which are to be ignored have already been zeroed in the radius stream */
+		m_search_candidates.Finalise();
+		outResult.clear();
+		return SpatialQueryKernels::SphereTest(m_search_candidates, position, distance, true, outResult);
+	}
+
+
+	// Benchmarks the vectorised ID search against the standard search, using random query points within the bounds of the
+	// given spatial tree.  Each search is timed in full, including tree traversal, and the sorted set of IDs returned by 
+	// each method is compared.  The search cache is disabled during the benchmark so that every standard search is evaluated
+	template <class T>
+	std::string ObjectSearch<T>::RunBenchmark(Octree<T*> *sp_tree, int queries, float distance)
+	{
+		std::ostringstream ss;
+		if (!sp_tree)
+		{
+			ss << "Object search benchmark requires an active spatial partitioning tree\n";
+			Game::Log << LOG_WARN << ss.str();
+			return ss.str();
+		}
+
+		// Generate query points uniformly within the bounds of the tree
+		queries = max(queries, 1);
+		Octree<T*> *root = sp_tree->GetUltimateParent();
+		std::vector<XMFLOAT3> points(queries);
+		for (auto & pt : points) pt = XMFLOAT3(frand_lh(root->m_xmin, root->m_xmax), frand_lh(root->m_ymin, root->m_ymax), frand_lh(root->m_zmin, root->m_zmax));
+
+		bool cache_enabled = m_cache_enabled;
+		m_cache_enabled = false;
+
+		// Each query is evaluated both with and without target object boundaries, since each option is handled differently
+		// for large objects
+		const SearchOptions option_sets[] = { ObjectSearchOptions::NoSearchOptions, ObjectSearchOptions::IgnoreTargetObjectBoundaries };
+
+		std::vector<T*> objects;
+		std::vector<Game::ID_TYPE> standard_ids, vectorised_ids;
+		ss << "Object search benchmark (" << queries << " queries of radius " << distance << "):\n";
+
+		for (SearchOptions options : option_sets)
+		{
+			Timers::HRClockDuration standard_time = Timers::GetZeroDuration(), vectorised_time = Timers::GetZeroDuration();
+			size_t standard_found = 0U, vectorised_found = 0U;
+			int mismatches = 0;
+
+			for (int q = 0; q < queries; ++q)
+			{
+				XMVECTOR pos = XMLoadFloat3(&(points[q]));
+
+				// Standard search, returning object pointers
+				objects.clear();
+				Timers::HRClockTime start = Timers::GetHRClockTime();
+				GetAllObjectsWithinDistance(pos, root, distance, objects, options);
+				standard_time += Timers::GetMillisecondDuration(start, Timers::GetHRClockTime());
+
+				// Vectorised search, returning object IDs
+				start = Timers::GetHRClockTime();
+				GetAllObjectIDsWithinDistance(pos, root, distance, vectorised_ids, options);
+				vectorised_time += Timers::GetMillisecondDuration(start, Timers::GetHRClockTime());
+
+				// Compare the sorted set of IDs returned by each method
+				standard_ids.clear();
+				for (T *obj : objects) standard_ids.push_back(obj->GetID());
+				std::sort(standard_ids.begin(), standard_ids.end());
+				std::sort(vectorised_ids.begin(), vectorised_ids.end());
+				if (standard_ids != vectorised_ids) ++mismatches;
+
+				standard_found += standard_ids.size();
+				vectorised_found += vectorised_ids.size();
+			}
+
+			ss << "  " << (options == ObjectSearchOptions::NoSearchOptions ? "[default]" : "[ignore target boundaries]") << " standard=" << standard_time 
+			   << "ms (" << standard_found << " results), vectorised=" << vectorised_time << "ms (" << vectorised_found << " results), speedup="
+			   << (vectorised_time > 0.0 ? (standard_time / vectorised_time) : 0.0) << "x, mismatched queries=" << mismatches << "\n";
+		}
+
+		m_cache_enabled = cache_enabled;
+
+		Game::Log << LOG_INFO << ss.str();
+		return ss.str();
+	}
+
 	// Returns a reference to the singleton search instance for the given template type
 	template <class T>
 	ObjectSearch<T> & Search(void)
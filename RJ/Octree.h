@@ -4,10 +4,13 @@
 #define __OctreeH__
 
 #include <string>
+#include <vector>
+#include <stdint.h>
 #include "CompilerSettings.h"
 #include "Utility.h"
 #include "MemoryPool.h"
 #include "DX11_Core.h"
+#include "OctreeSearchData.h"
 template <class Octree> class MemoryPool;
 
 // The index into child node pointers for each of the eight possible subdivision directions
@@ -80,6 +83,9 @@ public:
 	// Assumes that the item passed is indeed already part of this node.  'pos' is the new position of the item
 	void							ItemMoved(T item, const FXMVECTOR pos);
 
+	// Refreshes the search data held for an item in this node, following a change in any of its searchable properties
+	void							ItemDataChanged(T item);
+
 	// Returns the set of items within scope of this node.  If this is not a leaf then it will progress recursively downwards
 	void							GetItems(std::vector<T> & outResult);
 
@@ -144,12 +150,33 @@ public:
 	// Default destructor
 	~Octree(void);
 
+protected:
+
+	// Appends an item to this node, along with its search data
+	void							AppendItem(T item);
+
+	// Removes the item at the given index from this node, along with its search data.  Item order is not preserved
+	void							RemoveItemAt(int index);
+
+	// Removes all items and search data from this node
+	void							ClearItems(void);
+
+	// Populates the search data streams at the given index from the corresponding item
+	void							StoreItemSearchData(int index);
+
 public:			// We will allow public access to member variables for efficiency.  Only ever accessed by core internal methods.
 
 	// The items within this node, plus the current count of objects stored
 	std::vector<T>								m_items;
 	int											m_itemcount;
 
+	// Search data for each item, held in SoA streams parallel to m_items so that object searches can test the contents
+	// of a node without dereferencing any items.  Only maintained for leaf nodes, in the same order as m_items
+	std::vector<float>							m_item_x, m_item_y, m_item_z;
+	std::vector<float>							m_item_radiussq;
+	std::vector<Game::ID_TYPE>					m_item_searchid;
+	std::vector<uint8_t>						m_item_searchflags;
+
 	// Pointers to our parent and child nodes
 	Octree<T> *									m_parent;
 	Octree<T> *									m_children[8];
@@ -229,8 +256,9 @@ Octree<T>::Octree(FXMVECTOR position, float areasize) :	m_areasize(areasize), m_
 
 	// Initialise item storage to the desired maximum item count
 	m_items.reserve(Game::C_OCTREE_MAX_NODE_ITEMS);
-	m_itemcount = 0;
-	m_items.clear();
+	m_item_x.reserve(Game::C_OCTREE_MAX_NODE_ITEMS); m_item_y.reserve(Game::C_OCTREE_MAX_NODE_ITEMS); m_item_z.reserve(Game::C_OCTREE_MAX_NODE_ITEMS);
+	m_item_radiussq.reserve(Game::C_OCTREE_MAX_NODE_ITEMS); m_item_searchid.reserve(Game::C_OCTREE_MAX_NODE_ITEMS); m_item_searchflags.reserve(Game::C_OCTREE_MAX_NODE_ITEMS);
+	ClearItems();
 
 	// Initialise other fields to default values
 	m_pruningflag = false;
@@ -270,8 +298,9 @@ void Octree<T>::Initialise(Octree<T> *parent, float x0, float x1, float y0, floa
 
 	// Initialise item storage to the desired maximum item count, and ensure no items remain in the node from previous uses
 	m_items.reserve(Game::C_OCTREE_MAX_NODE_ITEMS);
-	m_itemcount = 0;
-	m_items.clear();
+	m_item_x.reserve(Game::C_OCTREE_MAX_NODE_ITEMS); m_item_y.reserve(Game::C_OCTREE_MAX_NODE_ITEMS); m_item_z.reserve(Game::C_OCTREE_MAX_NODE_ITEMS);
+	m_item_radiussq.reserve(Game::C_OCTREE_MAX_NODE_ITEMS); m_item_searchid.reserve(Game::C_OCTREE_MAX_NODE_ITEMS); m_item_searchflags.reserve(Game::C_OCTREE_MAX_NODE_ITEMS);
+	ClearItems();
 
 	// Initialise other fields to default values
 	m_pruningflag = false;
@@ -304,8 +333,7 @@ Octree<T> * Octree<T>::AddItem(T item, const FXMVECTOR pos)
 		if (m_itemcount < Game::C_OCTREE_MAX_NODE_ITEMS || m_size <= Game::C_OCTREE_MIN_NODE_SIZE)
 		{
 			// Add to the item collection and increment the count of items in this node
-			m_items.push_back(item);
-			++m_itemcount;
+			AppendItem(item);
 
 			// Link the object back to this node, and return this pointer as the node at which the item was successfully added
 			item->SetSpatialTreeNode(this);
@@ -348,8 +376,7 @@ Octree<T> * Octree<T>::AddItem(T item, const FXMVECTOR pos)
 			}
 			
 			// We can now clear the item storage and count for this node, since all items have been reallocated to our children
-			m_items.clear();
-			m_itemcount = 0;
+			ClearItems();
 		}
 	}
 
@@ -374,9 +401,7 @@ void Octree<T>::RemoveItem(T item)
 		if (m_items[i] == item)
 		{
 			// This is the item, so swap & pop it from the node and reduce our item count
-			if (i != ubound) std::swap(m_items[i], m_items[ubound]);
-			m_items.pop_back();
-			--m_itemcount;
+			RemoveItemAt(i);
 
 			// Break the reverse link from the object to this node
 			item->SetSpatialTreeNode(NULL);
@@ -406,9 +431,7 @@ bool Octree<T>::RemoveItemRecursive(T item)
 			if (m_items[i] == item)
 			{
 				// This is the item, so swap & pop it from the node and reduce our item count
-				if (i != ubound) std::swap(m_items[i], m_items[ubound]);
-				m_items.pop_back();
-				--m_itemcount;
+				RemoveItemAt(i);
 
 				// Break the reverse link from the object to this node
 				item->SetSpatialTreeNode(NULL);
@@ -445,8 +468,13 @@ bool Octree<T>::RemoveItemRecursive(T item)
 template <typename T> 
 void Octree<T>::ItemMoved(T item, const FXMVECTOR pos)
 {
-	// We can quit immediately if the item still fits within our bounds (the overwhelmingly likely case)
-	if (XMVector3GreaterOrEqual(pos, m_min) && XMVector3Less(pos, m_max)) return; 
+	// We can quit immediately if the item still fits within our bounds (the overwhelmingly likely case), once its search 
+	// data has been updated to reflect the new position
+	if (XMVector3GreaterOrEqual(pos, m_min) && XMVector3Less(pos, m_max))
+	{
+		ItemDataChanged(item);
+		return;
+	}
 
 	// The item no longer fits within this node; remove it
 	RemoveItem(item);
@@ -457,6 +485,74 @@ void Octree<T>::ItemMoved(T item, const FXMVECTOR pos)
 	if (m_parent) m_parent->AddItem(item, pos);	
 }
 
+// Refreshes the search data held for an item in this node, following a change in any of its searchable properties
+template <typename T>
+void Octree<T>::ItemDataChanged(T item)
+{
+	for (int i = 0; i < m_itemcount; ++i)
+	{
+		if (m_items[i] == item)
+		{
+			StoreItemSearchData(i);
+			return;
+		}
+	}
+}
+
+// Appends an item to this node, along with its search data
+template <typename T>
+void Octree<T>::AppendItem(T item)
+{
+	m_items.push_back(item);
+	m_item_x.push_back(0.0f); m_item_y.push_back(0.0f); m_item_z.push_back(0.0f);
+	m_item_radiussq.push_back(0.0f); m_item_searchid.push_back(0); m_item_searchflags.push_back(0U);
+
+	StoreItemSearchData(m_itemcount++);
+}
+
+// Removes the item at the given index from this node, along with its search data.  Item order is not preserved
+template <typename T>
+void Octree<T>::RemoveItemAt(int index)
+{
+	int ubound = (m_itemcount - 1);
+	if (index != ubound)
+	{
+		std::swap(m_items[index], m_items[ubound]);
+		m_item_x[index] = m_item_x[ubound]; m_item_y[index] = m_item_y[ubound]; m_item_z[index] = m_item_z[ubound];
+		m_item_radiussq[index] = m_item_radiussq[ubound];
+		m_item_searchid[index] = m_item_searchid[ubound];
+		m_item_searchflags[index] = m_item_searchflags[ubound];
+	}
+
+	m_items.pop_back();
+	m_item_x.pop_back(); m_item_y.pop_back(); m_item_z.pop_back();
+	m_item_radiussq.pop_back(); m_item_searchid.pop_back(); m_item_searchflags.pop_back();
+	--m_itemcount;
+}
+
+// Removes all items and search data from this node
+template <typename T>
+void Octree<T>::ClearItems(void)
+{
+	m_items.clear();
+	m_item_x.clear(); m_item_y.clear(); m_item_z.clear();
+	m_item_radiussq.clear(); m_item_searchid.clear(); m_item_searchflags.clear();
+	m_itemcount = 0;
+}
+
+// Populates the search data streams at the given index from the corresponding item
+template <typename T>
+void Octree<T>::StoreItemSearchData(int index)
+{
+	OctreeSearchData data;
+	m_items[index]->GetSpatialSearchData(data);
+
+	m_item_x[index] = data.Position.x; m_item_y[index] = data.Position.y; m_item_z[index] = data.Position.z;
+	m_item_radiussq[index] = data.CollisionRadiusSq;
+	m_item_searchid[index] = data.SearchID;
+	m_item_searchflags[index] = data.Flags;
+}
+
 // Returns the set of items within scope of this node.  If this is not a leaf then it will progress recursively downwards
 template <typename T> 
 void Octree<T>::GetItems(std::vector<T> & outResult)
@@ -646,11 +742,11 @@ void Octree<T>::PerformPruningCheck(void)
 
 		// Now add the items to this node.  Change the node link from those items so that it now points to this node
 		T item;
-		m_itemcount = (int)items.size();
-		for (int i = 0; i < m_itemcount; ++i)
+		int n = (int)items.size();
+		for (int i = 0; i < n; ++i)
 		{
 			item = items[i];
-			m_items.push_back(item);
+			AppendItem(item);
 			item->SetSpatialTreeNode(this);
 		}
 
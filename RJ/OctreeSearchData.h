@@ -0,0 +1,36 @@
+#pragma once
+
+#ifndef __OctreeSearchDataH__
+#define __OctreeSearchDataH__
+
+#include <stdint.h>
+#include "CompilerSettings.h"
+#include "GameVarsExtern.h"
+#include "DX11_Core.h"
+
+// Data describing a single spatial tree item for the purposes of object searches.  Populated by the item itself whenever
+// it is added to a node, moves, or changes any of the relevant properties, and stored by the node in SoA form so that 
+// searches can test items without dereferencing them
+// Class has no special alignment requirements
+struct OctreeSearchData
+{
+	// Flags describing the item
+	enum Flag : uint8_t
+	{
+		Colliding				= 0x01,			// Item has a collision mode other than NoCollision
+		ActiveCollider			= 0x02,			// Item is an active collider
+		LargeObject				= 0x04,			// Item (or the object it stands in for) may be present in several nodes
+		Excluded				= 0x08			// Item should never be returned from a search
+	};
+
+	XMFLOAT3					Position;			// Position of the item, or of the object it stands in for
+	float						CollisionRadiusSq;	// Squared collision radius of the item, or of the object it stands in for
+	Game::ID_TYPE				SearchID;			// ID returned by searches; may be the ID of a parent object
+	uint8_t						Flags;
+
+	// Default constructor
+	CMPINLINE OctreeSearchData(void) : Position(0.0f, 0.0f, 0.0f), CollisionRadiusSq(0.0f), SearchID(0), Flags(0U) { }
+};
+
+
+#endif
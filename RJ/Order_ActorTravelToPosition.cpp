@@ -1,12 +1,16 @@
+#include <algorithm>
 #include "NavNetwork.h"
 #include "NavNode.h"
 #include "ComplexShip.h"
 
 #include "Order_ActorTravelToPosition.h"
 
+// Initialise static fields
+std::vector<Order_ActorTravelToPosition*> Order_ActorTravelToPosition::PendingPathCalculations;
+
 // Constructor including main order parameters
 Order_ActorTravelToPosition::Order_ActorTravelToPosition(	iSpaceObjectEnvironment *environment, CXMVECTOR startpos, CXMVECTOR targetpos,
-															float getwithin, float followdistance, bool run)
+															float getwithin, float followdistance, bool run, bool calculate_path)
 	:
 	Environment(environment),
 	StartPosition(startpos),
@@ -18,18 +22,23 @@ Order_ActorTravelToPosition::Order_ActorTravelToPosition(	iSpaceObjectEnvironmen
 	Run(run),
 	PathNodes(NULL),
 	PathLength(0),
-	PathIndex(0)
+	PathIndex(0),
+	m_path_pending(calculate_path)
 {
 	// All order subclasses must set their order type on construction
 	m_ordertype = Order::OrderType::ActorTravelToPosition;
 
-	// Determine the path to be followed to reach the target position
-	CalculateTravelPath();
+	// The path to be followed will be determined on first execution, along with all other orders issued in the meantime 
+	// (which will generally be all orders issued this frame), so that every request can be resolved in a single batch
+	if (m_path_pending) PendingPathCalculations.push_back(this);
 }
 
 // Calculates the path that should be followed in order to reach the target position
 void Order_ActorTravelToPosition::CalculateTravelPath(void)
 {
+	// The path is being calculated explicitly, so it no longer needs to be included in the next batch
+	RemoveFromPendingBatch();
+
 	// Parameter check
 	iSpaceObjectEnvironment *env = Environment();
 	if (!env || !env->GetNavNetwork()) return;
@@ -42,9 +51,6 @@ void Order_ActorTravelToPosition::CalculateTravelPath(void)
 	// then terminate on its first execution
 	if (!start || !end) return;
 
-	// We shouldn't have any existing path data, but check and deallocate in case to avoid potential memory leaks
-	if (PathNodes) SafeDeleteArray(PathNodes);
-
 	// Create a vector to hold the output nodes and request a path from the nav network
 	std::vector<NavNode*> revpath;
 	Result result = env->GetNavNetwork()->FindPath(start, end, revpath);
@@ -52,6 +58,88 @@ void Order_ActorTravelToPosition::CalculateTravelPath(void)
 	// If no path is possible then return now; order will terminate on first execution since it can generate no child nodes
 	if (result != ErrorCodes::NoError) return;
 
+	// Otherwise store the path that will be followed
+	PopulateTravelPath(revpath);
+}
+
+// Calculates the travel path for a batch of orders.  Requests are grouped by environment and each group is resolved 
+// concurrently by its nav network
+void Order_ActorTravelToPosition::CalculateTravelPaths(const std::vector<Order_ActorTravelToPosition*> & orders)
+{
+	std::vector<NavNetwork::PathRequest> requests;
+	std::vector<Order_ActorTravelToPosition*> requesting;
+	std::vector<bool> resolved(orders.size(), false);
+
+	// Orders in a batch will generally share an environment, so gather all orders for the next unresolved environment in turn
+	std::vector<Order_ActorTravelToPosition*>::size_type count = orders.size();
+	for (std::vector<Order_ActorTravelToPosition*>::size_type i = 0U; i < count; ++i)
+	{
+		if (orders[i]) orders[i]->RemoveFromPendingBatch();
+	}
+
+	for (std::vector<Order_ActorTravelToPosition*>::size_type i = 0U; i < count; ++i)
+	{
+		if (resolved[i] || !orders[i]) continue;
+		iSpaceObjectEnvironment *env = orders[i]->Environment();
+
+		requests.clear(); requesting.clear();
+		for (std::vector<Order_ActorTravelToPosition*>::size_type j = i; j < count; ++j)
+		{
+			Order_ActorTravelToPosition *order = orders[j];
+			if (resolved[j] || !order || order->Environment() != env) continue;
+			resolved[j] = true;
+
+			// Orders with no valid environment or nodes will generate no path, and terminate on their first execution
+			if (!env || !env->GetNavNetwork()) continue;
+			NavNode *start = env->GetNavNetwork()->GetClosestNode(order->StartPosition);
+			NavNode *end = env->GetNavNetwork()->GetClosestNode(order->TargetPosition);
+			if (!start || !end) continue;
+
+			requests.push_back(NavNetwork::PathRequest(start, end));
+			requesting.push_back(order);
+		}
+
+		// Resolve all requests against this environment, then populate the path for each successful request
+		if (requests.empty()) continue;
+		env->GetNavNetwork()->FindPaths(requests);
+
+		std::vector<NavNetwork::PathRequest>::size_type n = requests.size();
+		for (std::vector<NavNetwork::PathRequest>::size_type r = 0U; r < n; ++r)
+		{
+			if (requests[r].PathResult == ErrorCodes::NoError) requesting[r]->PopulateTravelPath(requests[r].PathReverse);
+		}
+	}
+}
+
+// Calculates the travel path for all orders awaiting batch calculation
+void Order_ActorTravelToPosition::CalculatePendingTravelPaths(void)
+{
+	if (PendingPathCalculations.empty()) return;
+
+	// Take ownership of the pending set first, so that orders do not need to be removed from it individually
+	std::vector<Order_ActorTravelToPosition*> orders;
+	orders.swap(PendingPathCalculations);
+	for (Order_ActorTravelToPosition *order : orders) order->m_path_pending = false;
+
+	CalculateTravelPaths(orders);
+}
+
+// Removes the order from the set awaiting batch calculation, if applicable
+void Order_ActorTravelToPosition::RemoveFromPendingBatch(void)
+{
+	if (!m_path_pending) return;
+
+	m_path_pending = false;
+	std::vector<Order_ActorTravelToPosition*>::iterator it = std::find(PendingPathCalculations.begin(), PendingPathCalculations.end(), this);
+	if (it != PendingPathCalculations.end()) PendingPathCalculations.erase(it);
+}
+
+// Populates the travel path from the (reverse) set of nav nodes returned by a path query
+void Order_ActorTravelToPosition::PopulateTravelPath(const std::vector<NavNode*> & revpath)
+{
+	// We shouldn't have any existing path data, but check and deallocate in case to avoid potential memory leaks
+	if (PathNodes) SafeDeleteArray(PathNodes);
+
 	// Allocate space for the path.  There will be one additional position: the end point, which is likely different to navnode[n]
 	PathLength = (int)revpath.size() + 1;
 	PathNodes = new INTVECTOR3[PathLength];
@@ -65,10 +153,9 @@ void Order_ActorTravelToPosition::CalculateTravelPath(void)
 		++PathIndex;
 	}
 
-	// Add the final position in the path, which will be the target position itself.  We are also done with the node vector
+	// Add the final position in the path, which will be the target position itself
 	// Swap y & z since the nodes are held in element space, and our target position is in world space
 	Vector3ToIntVectorSwizzleYZ(TargetPosition, PathNodes[PathLength - 1]);
-	revpath.clear();
 
 	// Reset the path index so that the actor will begin at the first node 
 	PathIndex = 0;
@@ -78,6 +165,9 @@ void Order_ActorTravelToPosition::CalculateTravelPath(void)
 // Default destructor
 Order_ActorTravelToPosition::~Order_ActorTravelToPosition(void)
 { 
+	// Make sure the order is not left awaiting batch calculation
+	RemoveFromPendingBatch();
+
 	// Deallocate any memory currently owned by this object
 	if (PathNodes) SafeDeleteArray(PathNodes);
 }
\ No newline at end of file
@@ -7,6 +7,7 @@
 #include "Order.h"
 #include "ObjectReference.h"
 class iSpaceObjectEnvironment;
+class NavNode;
 
 // Class is 16-bit aligned to allow use of SIMD member variables
 __declspec(align(16))
@@ -20,12 +21,25 @@ public:
 	// Constructor including main order parameters
 	// CloseDistance is the distance to the target that we will attempt to reach.  FollowDistance
 	// is the distance we will get to each waypoint on the route
+	// The travel path is calculated when the order is first executed, in a single batch along with all other travel orders
+	// issued since the last batch.  If 'calculate_path' is false the order is not batched, and its path should instead be 
+	// calculated explicitly via CalculateTravelPath or CalculateTravelPaths
 	Order_ActorTravelToPosition(iSpaceObjectEnvironment *environment, CXMVECTOR startpos, CXMVECTOR targetpos, 
-								float closedistance, float followdistance, bool run);
+								float closedistance, float followdistance, bool run, bool calculate_path = true);
 
 	// Calculates the path that should be followed in order to reach the target position
 	void CalculateTravelPath(void);
 
+	// Calculates the travel path for a batch of orders.  Requests are grouped by environment and each group is resolved 
+	// concurrently by its nav network
+	static void CalculateTravelPaths(const std::vector<Order_ActorTravelToPosition*> & orders);
+
+	// Indicates whether the travel path is still awaiting calculation as part of the next batch
+	CMPINLINE bool IsTravelPathPending(void) const		{ return m_path_pending; }
+
+	// Calculates the travel path for all orders awaiting batch calculation
+	static void CalculatePendingTravelPaths(void);
+
 	// Default destructor
 	~Order_ActorTravelToPosition(void);
 
@@ -46,6 +60,20 @@ public:
 	INTVECTOR3 *								PathNodes;
 	int											PathLength, PathIndex;
 
+protected:
+
+	// Populates the travel path from the (reverse) set of nav nodes returned by a path query
+	void PopulateTravelPath(const std::vector<NavNode*> & revpath);
+
+	// Removes the order from the set awaiting batch calculation, if applicable
+	void RemoveFromPendingBatch(void);
+
+	// Flag indicating whether the order is awaiting batch calculation of its travel path
+	bool										m_path_pending;
+
+	// Orders awaiting batch calculation of their travel path
+	static std::vector<Order_ActorTravelToPosition*>	PendingPathCalculations;
+
 };
 
 
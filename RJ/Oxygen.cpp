@@ -20,6 +20,8 @@ const unsigned int Oxygen::OXYGEN_UPDATE_INTERVAL_TACTICAL_SIMULATION = 5000U;
 const unsigned int Oxygen::OXYGEN_UPDATE_INTERVAL_STRATEGIC_SIMULATION = 20000U;	// ms
 const unsigned int Oxygen::OXYGEN_UPDATE_INTERVAL_NO_SIMULATION = 60000U;			// ms
 
+bool Oxygen::USE_STENCIL_KERNEL = false;
+
 
 // Returns the oxygen update interval for a specific simulation state
 unsigned int Oxygen::GetOxygenUpdateInterval(iObject::ObjectSimulationState simulation_state)
@@ -26,6 +26,8 @@ public:
 	static const unsigned int OXYGEN_UPDATE_INTERVAL_STRATEGIC_SIMULATION;
 	static const unsigned int OXYGEN_UPDATE_INTERVAL_NO_SIMULATION;
 
+	static bool USE_STENCIL_KERNEL;								// Oxygen maps will be updated via the vectorised stencil kernel if set
+
 	// Returns the oxygen update interval for a specific simulation state
 	static unsigned int GetOxygenUpdateInterval(iObject::ObjectSimulationState simulation_state);
 };
@@ -1,6 +1,10 @@
+#include <sstream>
 #include "DX11_Core.h" // #include "FullDX11.h"
 #include "ErrorCodes.h"
 #include "FastMath.h"
+#include "Logging.h"
+#include "Timers.h"
+#include "SpatialQueryKernels.h"
 #include "TextureDX11.h"
 #include "CoreEngine.h"
 
@@ -40,52 +44,13 @@ Result ParticleEmitter::Initialise(void)
 
 Result ParticleEmitter::InitialiseParticles(void)
 {
-	int tex = 0;
-
-	// Attempt to initialise storage for the particle and vertex data
-	m_particles = new (std::nothrow) Particle		[m_particlelimit];
-	m_vertices	= new (std::nothrow) ParticleVertex	[m_vertexlimit];
-
-	// If either allocation failed then attempt to recover the memory and return; no change will have been made
-	if (!m_particles)		{ if (m_vertices) delete[] m_vertices; return ErrorCodes::CouldNotAllocateParticleDataMemory; }
-	if (!m_vertices)		{ if (m_particles) delete[] m_particles; return ErrorCodes::CouldNotAllocateParticleVertexMemory; }
-
-	// Zero all memory by default; as one effect, this sets all to Active=false and Alpha=0 by default which is desired behaviour
-	memset((void*)m_particles, 0, sizeof(Particle) * m_particlelimit);
-	memset((void*)m_vertices, 0, sizeof(ParticleVertex) * m_vertexlimit);
-
-	// Initialise the vertex texture coordinates for each particle, so we only have to perform this step once.  Each particle will
-	// take a random set of coordinates to avoid all particles having the same orientation
-	ParticleVertex *v = &m_vertices[0];
-	for (int i=0; i<m_particlelimit; i++)
-	{
-		// Identify the random set of texture coordinates that will be used for this particle
-		tex = (rand() % 4);
-
-		// Bottom left [0]
-		v->texture = ParticleEmitter::TexCoord[tex][0];
-		v++;
-
-		// Top left [1]
-		v->texture = ParticleEmitter::TexCoord[tex][1];
-		v++;
-
-		// Bottom right [2]
-		v->texture = ParticleEmitter::TexCoord[tex][3];
-		v++;
-
-		// Bottom right [3]
-		v->texture = ParticleEmitter::TexCoord[tex][3];
-		v++;
-
-		// Top left [4]
-		v->texture = ParticleEmitter::TexCoord[tex][1];
-		v++;
+	// Initialise storage for the particle data.  No particles are active initially
+	m_particles.Allocate(m_particlelimit);
+	m_numactiveparticles = 0;
+	m_vertexcount = 0;
 
-		// Top right [5]
-		v->texture = ParticleEmitter::TexCoord[tex][2];
-		v++;
-	}
+	// Start from a random point in the random value table, so that emitters do not all follow the same sequence
+	m_randomoffset = ((unsigned int)rand() * BATCH_WIDTH) & (RANDOM_TABLE_SIZE - 1U);
 
 	// Return success once all particles are set up
 	return ErrorCodes::NoError;
@@ -96,7 +61,7 @@ Result ParticleEmitter::InitialiseBuffers(void)
 	INDEXFORMAT *indices;
 	int i;
 	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
-    D3D11_SUBRESOURCE_DATA vertexData, indexData;
+    D3D11_SUBRESOURCE_DATA indexData;
 	HRESULT result;
 		
 	// Create the index array.
@@ -114,13 +79,8 @@ Result ParticleEmitter::InitialiseBuffers(void)
     vertexBufferDesc.MiscFlags = 0;
 	vertexBufferDesc.StructureByteStride = 0;
 
-	// Give the subresource structure a pointer to the vertex data.
-    vertexData.pSysMem = m_vertices;
-	vertexData.SysMemPitch = 0;
-	vertexData.SysMemSlicePitch = 0;
-
-	// Now finally create the vertex buffer.
-    result = Game::Engine->GetRenderDevice()->GetDevice()->CreateBuffer(&vertexBufferDesc, &vertexData, &m_vertexbuffer);
+	// Now finally create the vertex buffer.  No initial data is required, since vertices are generated into the buffer each frame
+    result = Game::Engine->GetRenderDevice()->GetDevice()->CreateBuffer(&vertexBufferDesc, NULL, &m_vertexbuffer);
 	if(FAILED(result))	return ErrorCodes::CouldNotCreateParticleVertexBuffer;
 
 	// Set up the description of the static index buffer.
@@ -147,155 +107,218 @@ Result ParticleEmitter::InitialiseBuffers(void)
 	return ErrorCodes::NoError;
 }
 
-void ParticleEmitter::UpdateParticles(const XMFLOAT3 & rightbasisvector, const XMFLOAT3 & upbasisvector)
+// Per-frame update of all particles.  Each batch of particles is updated with SIMD operations across the particle streams, 
+// then any particles which have expired are compacted out in the same pass so that live particles remain contiguous
+void ParticleEmitter::UpdateParticles(float timefactor)
 {
-	// Pointer to the first inactive particle, plus basis vectors to be used later
-	int inactiveid = -1;
-	XMFLOAT3 vright, vup;
-	XMFLOAT4 newcolour;
-
-	// For each particle in this emitter
-	Particle *p = m_particles;
-	ParticleVertex *v = m_vertices;
-
-	// Note we only loop to [maxparticlescreate+1], which improves efficiency while the entire buffer has not yet been used.  We
-	// still have to go to +1 to make sure that the next potential new index is included.  This counter has been constrained to
-	// only ever reach limit-1, so it is safe to do this
-	for (int i=0; i<=m_maxparticleidcreated; i++, p++, v+=6)
+	const ParticleData::FloatStream & random = GetRandomTable();
+	const unsigned int random_mask = (RANDOM_TABLE_SIZE - 1U);
+	const XMVECTOR tf = XMVectorReplicate(timefactor);
+	const XMVECTOR zero = XMVectorZero();
+
+	// Per-frame update ranges, pre-scaled by the time factor so that each update is (min + (rand * range))
+	XMVECTOR colmin[4], colrange[4], velmin[3], velrange[3], sizemin, sizerange;
+	const float *cmin = &(m_updatecolour[0].x), *cmax = &(m_updatecolour[1].x);
+	const float *vmin = &(m_updatevelocity[0].x), *vmax = &(m_updatevelocity[1].x);
+	for (int c = 0; c < 4; ++c)
+	{
+		colmin[c] = XMVectorReplicate(cmin[c] * timefactor);
+		colrange[c] = XMVectorReplicate((cmax[c] - cmin[c]) * timefactor);
+	}
+	for (int c = 0; c < 3; ++c)
 	{
-		// Reduce life of this particle and see if that kills it
-		if (p->Active && ((p->Life -= Game::TimeFactor) <= 0.0f)) {
-			p->Active = false;
-			--m_numactiveparticles;
+		velmin[c] = XMVectorReplicate(vmin[c] * timefactor);
+		velrange[c] = XMVectorReplicate((vmax[c] - vmin[c]) * timefactor);
+	}
+	sizemin = XMVectorReplicate(m_updatesize[0] * timefactor);
+	sizerange = XMVectorReplicate((m_updatesize[1] - m_updatesize[0]) * timefactor);
+
+	// Each property draws from a different region of the random table.  Offsets remain multiples of the batch width so 
+	// that random values can be loaded with aligned vector loads
+	#define PARTICLE_RANDOM(n) XMLoadFloat4A((const XMFLOAT4A*)&(random[(m_randomoffset + k + ((n) * 512U)) & random_mask]))
+
+	ParticleData & d = m_particles;
+	int count = m_numactiveparticles;
+	int write = 0;
+	for (int k = 0; k < count; k += BATCH_WIDTH)
+	{
+		// Reduce the remaining life of each particle
+		XMVECTOR life = XMVectorSubtract(XMLoadFloat4A((const XMFLOAT4A*)&(d.Life[k])), tf);
+		XMStoreFloat4A((XMFLOAT4A*)&(d.Life[k]), life);
+
+		// Update colour, if required
+		if (m_updateflag_colour)
+		{
+			float *channels[4] = { &(d.R[k]), &(d.G[k]), &(d.B[k]), &(d.A[k]) };
+			for (int c = 0; c < 4; ++c)
+			{
+				XMVECTOR col = XMVectorAdd(XMLoadFloat4A((const XMFLOAT4A*)channels[c]), XMVectorMultiplyAdd(PARTICLE_RANDOM(c), colrange[c], colmin[c]));
+				XMStoreFloat4A((XMFLOAT4A*)channels[c], XMVectorSaturate(col));
+			}
 		}
 
-		// Now process particle depending on whether it is alive or not
-		if (!p->Active)
+		// Update size, if required
+		if (m_updateflag_size)
 		{
-			// If particle is not active then simply set alpha=0 to make it invisible, wherever it is
-			v[0].colour.w = v[1].colour.w = v[2].colour.w = v[3].colour.w = v[4].colour.w = v[5].colour.w = 0.0f;
+			XMVECTOR size = XMVectorAdd(XMLoadFloat4A((const XMFLOAT4A*)&(d.Size[k])), XMVectorMultiplyAdd(PARTICLE_RANDOM(4), sizerange, sizemin));
+			XMStoreFloat4A((XMFLOAT4A*)&(d.Size[k]), size);
+		}
 
-			// Also set the inactive pointer if it is not already set
-			if (inactiveid == -1) inactiveid = i;
+		// Update velocity, if required
+		XMVECTOR vx = XMLoadFloat4A((const XMFLOAT4A*)&(d.VX[k]));
+		XMVECTOR vy = XMLoadFloat4A((const XMFLOAT4A*)&(d.VY[k]));
+		XMVECTOR vz = XMLoadFloat4A((const XMFLOAT4A*)&(d.VZ[k]));
+		if (m_updateflag_velocity)
+		{
+			vx = XMVectorAdd(vx, XMVectorMultiplyAdd(PARTICLE_RANDOM(5), velrange[0], velmin[0]));
+			vy = XMVectorAdd(vy, XMVectorMultiplyAdd(PARTICLE_RANDOM(6), velrange[1], velmin[1]));
+			vz = XMVectorAdd(vz, XMVectorMultiplyAdd(PARTICLE_RANDOM(7), velrange[2], velmin[2]));
+			XMStoreFloat4A((XMFLOAT4A*)&(d.VX[k]), vx);
+			XMStoreFloat4A((XMFLOAT4A*)&(d.VY[k]), vy);
+			XMStoreFloat4A((XMFLOAT4A*)&(d.VZ[k]), vz);
 		}
-		else	// (Particle IS active)
+
+		// Move each particle by its velocity
+		XMStoreFloat4A((XMFLOAT4A*)&(d.X[k]), XMVectorMultiplyAdd(vx, tf, XMLoadFloat4A((const XMFLOAT4A*)&(d.X[k]))));
+		XMStoreFloat4A((XMFLOAT4A*)&(d.Y[k]), XMVectorMultiplyAdd(vy, tf, XMLoadFloat4A((const XMFLOAT4A*)&(d.Y[k]))));
+		XMStoreFloat4A((XMFLOAT4A*)&(d.Z[k]), XMVectorMultiplyAdd(vz, tf, XMLoadFloat4A((const XMFLOAT4A*)&(d.Z[k]))));
+
+		// Compact all surviving particles in this batch down to the write position.  Padding lanes beyond the live range 
+		// are excluded.  In the common case where no particles have yet expired, the batch is already in place
+		int lanes = min(BATCH_WIDTH, count - k);
+		int alive = (SpatialQueryKernels::GetLaneMask(XMVectorGreater(life, zero)) & ((1 << lanes) - 1));
+		if (alive == ((1 << lanes) - 1) && write == k)
 		{
-			// Update colour, if required
-			if (m_updateflag_colour) {
-				newcolour = XMFLOAT4	(	v->colour.x + ((frand_lh(m_updatecolour[0].x, m_updatecolour[1].x) * Game::TimeFactor)), 
-											v->colour.y + ((frand_lh(m_updatecolour[0].y, m_updatecolour[1].y) * Game::TimeFactor)), 
-											v->colour.z + ((frand_lh(m_updatecolour[0].z, m_updatecolour[1].z) * Game::TimeFactor)), 
-											v->colour.w + ((frand_lh(m_updatecolour[0].w, m_updatecolour[1].w) * Game::TimeFactor)) );
-				if (newcolour.x < 0.0f) newcolour.x = 0.0f; if (newcolour.x > 1.0f) newcolour.x = 1.0f;
-				if (newcolour.y < 0.0f) newcolour.y = 0.0f; if (newcolour.y > 1.0f) newcolour.y = 1.0f;
-				if (newcolour.z < 0.0f) newcolour.z = 0.0f; if (newcolour.z > 1.0f) newcolour.z = 1.0f;
-				if (newcolour.w < 0.0f) newcolour.w = 0.0f; if (newcolour.w > 1.0f) newcolour.w = 1.0f;
-
-				v[0].colour = v[1].colour = v[2].colour = v[3].colour = v[4].colour = v[5].colour = newcolour;			
-					 
-			}
+			write += lanes;
+			continue;
+		}
 
-			// Update size, if required
-			if (m_updateflag_size) p->Size += (frand_lh(m_updatesize[0], m_updatesize[1]) * Game::TimeFactor);
+		for (int lane = 0; lane < lanes; ++lane)
+		{
+			if (alive & (1 << lane)) d.Move(k + lane, write++);
+		}
+	}
 
-			// Update velocity, if required
-			if (m_updateflag_velocity) {
-				p->Velocity = XMFLOAT3	(	p->Velocity.x + ((frand_lh(m_updatevelocity[0].x, m_updatevelocity[1].x)) * Game::TimeFactor),
-											p->Velocity.y + ((frand_lh(m_updatevelocity[0].y, m_updatevelocity[1].y)) * Game::TimeFactor),
-											p->Velocity.z + ((frand_lh(m_updatevelocity[0].z, m_updatevelocity[1].z)) * Game::TimeFactor) );
-			}
+	#undef PARTICLE_RANDOM
 
-			// Move the particle (vertex 0 position) by its velocity
-			v[0].position = Float3Add(v[0].position, Float3MultiplyScalar(p->Velocity, Game::TimeFactor));		// Vertex 0 is the bottom-left
+	// Advance through the random table so that particles receive different updates each frame
+	m_randomoffset = ((m_randomoffset + (BATCH_WIDTH * 257U)) & random_mask);
+	m_numactiveparticles = write;
 
-			// Now set the other (1-5) vertex coordinates using basis vectors and the particle size
-			vright = Float3MultiplyScalar(rightbasisvector, p->Size);
-			vup = Float3MultiplyScalar(upbasisvector, p->Size);
+	// Finally, see if we need to add a new particle following all the updates (and potentially deletions)
+	if ((m_numactiveparticles < m_particlelimit) && m_emitting && ((m_timetonextemission -= timefactor) < 0.0f))
+	{
+		// Add a new particle
+		AddParticle();
 
-			v[1].position = v[4].position = Float3Add(v[0].position, vup);			// Vertices 1 & 4 are top-left
-			v[2].position = v[3].position = Float3Add(v[0].position, vright);		// Vertices 2 & 3 are bottom-right
-			v[5].position = Float3Add(v[3].position, vup);							// Vertex 5 is the top-right; add an additional up vector to bottom right
-		}
+		// Reset the counter for the next emission to a value in the specified range
+		m_timetonextemission = frand_lh(m_emissionfreq[0], m_emissionfreq[1]);
 	}
+}
+
+// Generates six billboard vertices for each live particle.  Quad corners are calculated for a full batch of particles at 
+// a time across the SoA streams, then written out sequentially since the destination will typically be write-combined memory
+int ParticleEmitter::ExpandBillboards(ParticleVertex *dest, const XMFLOAT3 & rightbasisvector, const XMFLOAT3 & upbasisvector) const
+{
+	const ParticleData & d = m_particles;
+	const XMVECTOR rx = XMVectorReplicate(rightbasisvector.x), ry = XMVectorReplicate(rightbasisvector.y), rz = XMVectorReplicate(rightbasisvector.z);
+	const XMVECTOR ux = XMVectorReplicate(upbasisvector.x), uy = XMVectorReplicate(upbasisvector.y), uz = XMVectorReplicate(upbasisvector.z);
 
-	// Finally, see if we need to add a new particle following all the updates (and potentially deletions).  Add at the inactive ID
-	if ((m_numactiveparticles < m_particlelimit) && m_emitting && ((m_timetonextemission -= Game::TimeFactor) < 0.0f))
+	// Corner positions for one batch: bottom-left (the particle position), top-left, bottom-right and top-right
+	XMFLOAT4A tl[3], br[3], tr[3];
+
+	ParticleVertex *v = dest;
+	int count = m_numactiveparticles;
+	for (int k = 0; k < count; k += BATCH_WIDTH)
 	{
-		// Determine whether we have an available slot; either an inactive slot we located above, or the next free slot beyond our currently
-		// used range (if that range is less than the overall particle limit)
-		int id = (inactiveid != -1 ? inactiveid : m_maxparticleidcreated + 1);
-		if (id < m_particlelimit)
-		{
-			// Add a new particle
-			AddParticle(id);
+		XMVECTOR x = XMLoadFloat4A((const XMFLOAT4A*)&(d.X[k]));
+		XMVECTOR y = XMLoadFloat4A((const XMFLOAT4A*)&(d.Y[k]));
+		XMVECTOR z = XMLoadFloat4A((const XMFLOAT4A*)&(d.Z[k]));
+		XMVECTOR size = XMLoadFloat4A((const XMFLOAT4A*)&(d.Size[k]));
+
+		// Basis vectors scaled by particle size
+		XMVECTOR sux = XMVectorMultiply(ux, size), suy = XMVectorMultiply(uy, size), suz = XMVectorMultiply(uz, size);
+		XMVECTOR brx = XMVectorMultiplyAdd(rx, size, x), bry = XMVectorMultiplyAdd(ry, size, y), brz = XMVectorMultiplyAdd(rz, size, z);
 
-			// Reset the counter for the next emission to a value in the specified range
-			m_timetonextemission = frand_lh(m_emissionfreq[0], m_emissionfreq[1]);
+		XMStoreFloat4A(&tl[0], XMVectorAdd(x, sux));	XMStoreFloat4A(&tl[1], XMVectorAdd(y, suy));	XMStoreFloat4A(&tl[2], XMVectorAdd(z, suz));
+		XMStoreFloat4A(&br[0], brx);					XMStoreFloat4A(&br[1], bry);					XMStoreFloat4A(&br[2], brz);
+		XMStoreFloat4A(&tr[0], XMVectorAdd(brx, sux));	XMStoreFloat4A(&tr[1], XMVectorAdd(bry, suy));	XMStoreFloat4A(&tr[2], XMVectorAdd(brz, suz));
+
+		int lanes = min(BATCH_WIDTH, count - k);
+		for (int lane = 0; lane < lanes; ++lane)
+		{
+			int p = (k + lane);
+			const XMFLOAT2 *tex = ParticleEmitter::TexCoord[d.TexCoordSet[p]];
+			XMFLOAT3 pbl = XMFLOAT3(d.X[p], d.Y[p], d.Z[p]);
+			XMFLOAT3 ptl = XMFLOAT3((&tl[0].x)[lane], (&tl[1].x)[lane], (&tl[2].x)[lane]);
+			XMFLOAT3 pbr = XMFLOAT3((&br[0].x)[lane], (&br[1].x)[lane], (&br[2].x)[lane]);
+			XMFLOAT3 ptr = XMFLOAT3((&tr[0].x)[lane], (&tr[1].x)[lane], (&tr[2].x)[lane]);
+			XMFLOAT4 col = XMFLOAT4(d.R[p], d.G[p], d.B[p], d.A[p]);
+
+			// Two triangles; vertices 1 & 4 are top-left, 2 & 3 are bottom-right
+			v[0].position = pbl; v[0].texture = tex[0]; v[0].colour = col;
+			v[1].position = ptl; v[1].texture = tex[1]; v[1].colour = col;
+			v[2].position = pbr; v[2].texture = tex[3]; v[2].colour = col;
+			v[3].position = pbr; v[3].texture = tex[3]; v[3].colour = col;
+			v[4].position = ptl; v[4].texture = tex[1]; v[4].colour = col;
+			v[5].position = ptr; v[5].texture = tex[2]; v[5].colour = col;
+			v += 6;
 		}
 	}
+
+	return (int)(v - dest);
 }
 
-void ParticleEmitter::AddParticle(int id)
+// Adds a new particle to the end of the live particle range
+void ParticleEmitter::AddParticle(void)
 {
-	// Make sure we are adding to a valid index
-	if (id < 0 || id >= m_particlelimit) return;
-	ParticleVertex *v = &m_vertices[id * 6];
+	// Make sure we have space for the new particle
+	if (m_numactiveparticles >= m_particlelimit) return;
+	int id = m_numactiveparticles;
+	ParticleData & d = m_particles;
 
 	// Set initial properties
-	m_particles[id].Active = true;
-	m_particles[id].Life = frand_lh(m_initiallifetime[0], m_initiallifetime[1]);
-	m_particles[id].Size = frand_lh(m_initialsize[0], m_initialsize[1]);
+	d.Life[id] = frand_lh(m_initiallifetime[0], m_initiallifetime[1]);
+	d.Size[id] = frand_lh(m_initialsize[0], m_initialsize[1]);
 
-	// Initial velocity is based on world orientation
-	m_particles[id].Velocity = XMFLOAT3(	frand_lh(m_initialvelocity[0].x, m_initialvelocity[1].x), 
-											frand_lh(m_initialvelocity[0].y, m_initialvelocity[1].y), 
-											frand_lh(m_initialvelocity[0].z, m_initialvelocity[1].z) );
+	// Each particle takes a random set of texture coordinates to avoid all particles having the same orientation
+	d.TexCoordSet[id] = (unsigned char)(rand() % 4);
 
+	// Initial velocity is based on world orientation; transform the velocity vector by our world orientation matrix
+	XMFLOAT3 vel = XMFLOAT3(	frand_lh(m_initialvelocity[0].x, m_initialvelocity[1].x), 
+								frand_lh(m_initialvelocity[0].y, m_initialvelocity[1].y), 
+								frand_lh(m_initialvelocity[0].z, m_initialvelocity[1].z) );
+	XMStoreFloat3(&vel, XMVector3TransformCoord(XMLoadFloat3(&vel), m_orientmatrix));
+	d.VX[id] = vel.x; d.VY[id] = vel.y; d.VZ[id] = vel.z;
 
-	// Transform the velocity vector by our world orientation matrix
-	// D3DXVec3TransformCoord(&m_particles[id].Velocity, &m_particles[id].Velocity, &m_orientmatrix);
-	XMVECTOR vec = XMVector3TransformCoord(XMLoadFloat3(&m_particles[id].Velocity), m_orientmatrix);
-	XMStoreFloat3(&m_particles[id].Velocity, vec);	
-
-	// Set initial position.  Note we initially set all to v[0] position; will be updated properly next frame by the update method
-	v[0].position = XMFLOAT3(	frand_lh(m_initialposition[0].x, m_initialposition[1].x),
+	// Set initial position, transformed by the world matrix
+	XMFLOAT3 pos = XMFLOAT3(	frand_lh(m_initialposition[0].x, m_initialposition[1].x),
 								frand_lh(m_initialposition[0].y, m_initialposition[1].y),
 								frand_lh(m_initialposition[0].z, m_initialposition[1].z) );
-
-	// Transform initial position by the world matrix, then set all other vertices to match
-	vec = XMVector3TransformCoord(XMLoadFloat3(&v[0].position), m_worldmatrix);
-	XMStoreFloat3(&v[0].position, vec);
-	v[1].position = v[2].position = v[3].position = v[4].position = v[5].position = v[0].position;
+	XMStoreFloat3(&pos, XMVector3TransformCoord(XMLoadFloat3(&pos), m_worldmatrix));
+	d.X[id] = pos.x; d.Y[id] = pos.y; d.Z[id] = pos.z;
 
 	// Set initial colour
-	v[0].colour = v[1].colour = v[2].colour = v[3].colour = v[4].colour = v[5].colour = 
-		XMFLOAT4(	frand_lh(m_initialcolour[0].x, m_initialcolour[1].x), 
-					frand_lh(m_initialcolour[0].y, m_initialcolour[1].y), 
-					frand_lh(m_initialcolour[0].z, m_initialcolour[1].z), 
-					frand_lh(m_initialcolour[0].w, m_initialcolour[1].w) ); 
-	
-	// Increment active count.  Also, if this is the 'furthest' particle we have ever created then update that counter
-	++m_numactiveparticles;
-	if (id > m_maxparticleidcreated) m_maxparticleidcreated = id;
+	d.R[id] = frand_lh(m_initialcolour[0].x, m_initialcolour[1].x);
+	d.G[id] = frand_lh(m_initialcolour[0].y, m_initialcolour[1].y);
+	d.B[id] = frand_lh(m_initialcolour[0].z, m_initialcolour[1].z);
+	d.A[id] = frand_lh(m_initialcolour[0].w, m_initialcolour[1].w);
 
-	// Fix: set maxparticlescreated back to ubound-1 if necessary, so we can always loop to that limit + 1 in the update function
-	//if (m_maxparticleidcreated >= m_particlelimit) m_maxparticleidcreated = m_particlelimit-1;
+	// Increment active count
+	++m_numactiveparticles;
 }
 
+// Renders the emitter.  Particle data is expected to have already been updated for this frame by the particle engine
 void ParticleEmitter::Render(Rendering::RenderDeviceContextType  *devicecontext, const XMFLOAT3 & vright, const XMFLOAT3 & vup)
 {
-	// Update the particle data
-	UpdateParticles(vright, vup);
-
 	// Render all particle data to the buffers
-	RenderBuffers(devicecontext);
+	RenderBuffers(devicecontext, vright, vup);
 }
 
-void ParticleEmitter::RenderBuffers(Rendering::RenderDeviceContextType  *devicecontext)
+void ParticleEmitter::RenderBuffers(Rendering::RenderDeviceContextType  *devicecontext, const XMFLOAT3 & vright, const XMFLOAT3 & vup)
 {
 	HRESULT result;
 	D3D11_MAPPED_SUBRESOURCE mappedresource;
-	ParticleVertex *pdata = NULL;
 	unsigned int stride;
 	unsigned int offset;
 
@@ -303,9 +326,8 @@ void ParticleEmitter::RenderBuffers(Rendering::RenderDeviceContextType  *devicec
 	result = devicecontext->Map(m_vertexbuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedresource);
 	if (FAILED(result)) return;
 
-	// Get a pointer to the destination location in the vertex buffer, and copy vertex data to this location
-	pdata = (ParticleVertex*)mappedresource.pData;
-	memcpy(pdata, (void*)m_vertices, sizeof(ParticleVertex) * m_vertexlimit);
+	// Generate billboard vertices for all live particles directly into the vertex buffer
+	m_vertexcount = ExpandBillboards((ParticleVertex*)mappedresource.pData, vright, vup);
 
 	// Unlock the particle vertex buffer
 	devicecontext->Unmap(m_vertexbuffer, NULL);	
@@ -324,6 +346,105 @@ void ParticleEmitter::RenderBuffers(Rendering::RenderDeviceContextType  *devicec
     devicecontext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 }
 
+// Returns the shared table of random values in the range [0 1), used to vary per-particle updates
+const ParticleEmitter::ParticleData::FloatStream & ParticleEmitter::GetRandomTable(void)
+{
+	static const ParticleData::FloatStream table = []()
+	{
+		ParticleData::FloatStream values(RANDOM_TABLE_SIZE);
+		for (unsigned int i = 0U; i < RANDOM_TABLE_SIZE; ++i) values[i] = frand_lh(0.0f, 1.0f);
+		return values;
+	}();
+
+	return table;
+}
+
+// Allocates and zeroes storage for the given number of particles, plus padding to a full final batch
+void ParticleEmitter::ParticleData::Allocate(int capacity)
+{
+	size_t padded = (size_t)(capacity + BATCH_WIDTH);
+	X.assign(padded, 0.0f); Y.assign(padded, 0.0f); Z.assign(padded, 0.0f);
+	VX.assign(padded, 0.0f); VY.assign(padded, 0.0f); VZ.assign(padded, 0.0f);
+	R.assign(padded, 0.0f); G.assign(padded, 0.0f); B.assign(padded, 0.0f); A.assign(padded, 0.0f);
+	Size.assign(padded, 0.0f); Life.assign(padded, 0.0f);
+	TexCoordSet.assign(padded, 0U);
+}
+
+// Copies the particle at index 'src' to index 'dest'
+void ParticleEmitter::ParticleData::Move(int src, int dest)
+{
+	X[dest] = X[src]; Y[dest] = Y[src]; Z[dest] = Z[src];
+	VX[dest] = VX[src]; VY[dest] = VY[src]; VZ[dest] = VZ[src];
+	R[dest] = R[src]; G[dest] = G[src]; B[dest] = B[src]; A[dest] = A[src];
+	Size[dest] = Size[src]; Life[dest] = Life[src];
+	TexCoordSet[dest] = TexCoordSet[src];
+}
+
+// Releases all storage
+void ParticleEmitter::ParticleData::Release(void)
+{
+	X.clear(); X.shrink_to_fit(); Y.clear(); Y.shrink_to_fit(); Z.clear(); Z.shrink_to_fit();
+	VX.clear(); VX.shrink_to_fit(); VY.clear(); VY.shrink_to_fit(); VZ.clear(); VZ.shrink_to_fit();
+	R.clear(); R.shrink_to_fit(); G.clear(); G.shrink_to_fit(); B.clear(); B.shrink_to_fit(); A.clear(); A.shrink_to_fit();
+	Size.clear(); Size.shrink_to_fit(); Life.clear(); Life.shrink_to_fit();
+	TexCoordSet.clear(); TexCoordSet.shrink_to_fit();
+}
+
+// Headless benchmark of the particle update and billboard expansion passes across a range of particle counts
+std::string ParticleEmitter::RunBenchmark(const std::vector<int> & particle_counts, int frames)
+{
+	const float timefactor = (1.0f / 60.0f);
+	const XMFLOAT3 vright = XMFLOAT3(1.0f, 0.0f, 0.0f), vup = XMFLOAT3(0.0f, 1.0f, 0.0f);
+	frames = max(frames, 1);
+
+	std::ostringstream ss;
+	ss << "Particle emitter benchmark (" << frames << " frames per particle count):\n";
+
+	for (int count : particle_counts)
+	{
+		// Emitter with all per-frame updates enabled, and a short lifetime so that particles are continually expiring
+		ParticleEmitter emitter;
+		emitter.SetParticleLimit(count);
+		emitter.SetPositionAndOrientation(NULL_VECTOR, ID_QUATERNION);
+		emitter.m_initiallifetime[0] = 0.25f; emitter.m_initiallifetime[1] = 2.0f;
+		emitter.m_initialsize[0] = 1.0f; emitter.m_initialsize[1] = 5.0f;
+		emitter.m_initialcolour[0] = XMFLOAT4(0.5f, 0.5f, 0.5f, 0.5f); emitter.m_initialcolour[1] = XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f);
+		emitter.m_initialposition[0] = XMFLOAT3(-100.0f, -100.0f, -100.0f); emitter.m_initialposition[1] = XMFLOAT3(100.0f, 100.0f, 100.0f);
+		emitter.m_initialvelocity[0] = XMFLOAT3(-10.0f, -10.0f, -10.0f); emitter.m_initialvelocity[1] = XMFLOAT3(10.0f, 10.0f, 10.0f);
+		XMFLOAT4 colour_update[2] = { XMFLOAT4(-0.2f, -0.2f, -0.2f, -0.5f), XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f) };
+		XMFLOAT3 velocity_update[2] = { XMFLOAT3(-1.0f, -1.0f, -1.0f), XMFLOAT3(1.0f, 1.0f, 1.0f) };
+		emitter.SetParticleColourUpdate(Prop::MinValue, colour_update[0]); emitter.SetParticleColourUpdate(Prop::MaxValue, colour_update[1]);
+		emitter.SetParticleVelocityUpdate(Prop::MinValue, velocity_update[0]); emitter.SetParticleVelocityUpdate(Prop::MaxValue, velocity_update[1]);
+		emitter.SetParticleSizeUpdate(Prop::MinValue, -0.5f); emitter.SetParticleSizeUpdate(Prop::MaxValue, 0.5f);
+		emitter.InitialiseParticles();
+
+		std::vector<ParticleVertex> vertices(emitter.GetVertexLimit());
+		Timers::HRClockDuration update_time = 0.0, expand_time = 0.0;
+		size_t vertices_written = 0U;
+
+		for (int frame = 0; frame < frames; ++frame)
+		{
+			// Refill the emitter before each frame; not included in the timings
+			while (emitter.GetNumActiveParticles() < count) emitter.AddParticle();
+
+			Timers::HRClockTime start = Timers::GetHRClockTime();
+			emitter.UpdateParticles(timefactor);
+			Timers::HRClockTime mid = Timers::GetHRClockTime();
+			vertices_written += (size_t)emitter.ExpandBillboards(&(vertices[0]), vright, vup);
+			Timers::HRClockTime end = Timers::GetHRClockTime();
+
+			update_time += Timers::GetMillisecondDuration(start, mid);
+			expand_time += Timers::GetMillisecondDuration(mid, end);
+		}
+
+		ss << "  " << count << " particles: update=" << (update_time / frames) << "ms/frame, expansion=" << (expand_time / frames)
+		   << "ms/frame (" << (vertices_written / frames) << " vertices/frame)\n";
+	}
+
+	Game::Log << LOG_INFO << ss.str();
+	return ss.str();
+}
+
 
 ID3D11ShaderResourceView * ParticleEmitter::GetParticleTexture(void) 
 {
@@ -341,19 +462,10 @@ void ParticleEmitter::SetParticleTexture(const std::string & name)
 
 void ParticleEmitter::Shutdown(void)
 {
-	// Deallocate the particle data array
-	if (m_particles)
-	{
-		delete[] m_particles;
-		m_particles = NULL;
-	}
-
-	// Also deallocate the vertex data array
-	if (m_vertices)
-	{
-		delete[] m_vertices;
-		m_vertices = NULL;
-	}
+	// Deallocate the particle data
+	m_particles.Release();
+	m_numactiveparticles = 0;
+	m_vertexcount = 0;
 
 	// Delete and deallocate the vertex buffer
 	if (m_vertexbuffer)
@@ -388,19 +500,49 @@ ParticleEmitter *ParticleEmitter::CreateClone(void)
 	return e;
 }
 
+// Resets a previously-used instance back to the state of the prototype it was cloned from, retaining all allocated 
+// particle storage and rendering buffers
+void ParticleEmitter::ResetToPrototype(const ParticleEmitter & prototype)
+{
+	// Copy all emitter properties from the prototype
+	m_typecode = prototype.m_typecode;
+	m_texture = prototype.m_texture;
+	m_emitting = prototype.m_emitting;
+	m_exists = prototype.m_exists;
+	m_timetonextemission = prototype.m_timetonextemission;
+	m_emissionfreq[0] = prototype.m_emissionfreq[0];			m_emissionfreq[1] = prototype.m_emissionfreq[1];
+	m_initiallifetime[0] = prototype.m_initiallifetime[0];		m_initiallifetime[1] = prototype.m_initiallifetime[1];
+	m_initialposition[0] = prototype.m_initialposition[0];		m_initialposition[1] = prototype.m_initialposition[1];
+	m_initialcolour[0] = prototype.m_initialcolour[0];			m_initialcolour[1] = prototype.m_initialcolour[1];
+	m_initialsize[0] = prototype.m_initialsize[0];				m_initialsize[1] = prototype.m_initialsize[1];
+	m_initialvelocity[0] = prototype.m_initialvelocity[0];		m_initialvelocity[1] = prototype.m_initialvelocity[1];
+	m_updatecolour[0] = prototype.m_updatecolour[0];			m_updatecolour[1] = prototype.m_updatecolour[1];
+	m_updatesize[0] = prototype.m_updatesize[0];				m_updatesize[1] = prototype.m_updatesize[1];
+	m_updatevelocity[0] = prototype.m_updatevelocity[0];		m_updatevelocity[1] = prototype.m_updatevelocity[1];
+	m_updateflag_colour = prototype.m_updateflag_colour;
+	m_updateflag_size = prototype.m_updateflag_size;
+	m_updateflag_velocity = prototype.m_updateflag_velocity;
+
+	// Set the pos/orient specifically to ensure the world matrix is recalculated
+	SetPositionAndOrientation(prototype.GetPosition(), prototype.GetOrientation());
+
+	// Discard all particles; storage is retained since the particle limit is unchanged
+	m_numactiveparticles = 0;
+	m_vertexcount = 0;
+}
+
 
 ParticleEmitter::ParticleEmitter(void)
 {
 	// Initialise values to NULL or their defaults
-	m_particles = NULL;
-	m_vertices = NULL;
 	m_vertexbuffer = NULL;
 	m_indexbuffer = NULL;
+	m_vertexcount = 0;
+	m_randomoffset = 0U;
 
 	m_position = NULL_VECTOR;
 	m_orientation = ID_QUATERNION;
 	m_numactiveparticles = 0;
-	m_maxparticleidcreated = -1;
 	m_particlelimit = 0;
 	m_timetonextemission = 0.0f;
 	m_texture = NULL;
@@ -7,10 +7,30 @@
 #include "DX11_Core.h"
 #include "Rendering.h"
 #include <vector>
+#include <string>
 #include "CompilerSettings.h"
 #include "ErrorCodes.h"
+#include "AlignedAllocator.h"
 class TextureDX11;
 
+
+// Handle to a particle emitter instance held by the particle engine.  The slot generation is incremented whenever an emitter
+// is released, so that stale handles to a since-reused slot can be detected
+// Class has no special alignment requirements
+struct ParticleEmitterHandle
+{
+	static const unsigned int	INVALID_INDEX = 0xFFFFFFFF;
+
+	unsigned int				Index;
+	unsigned int				Generation;
+
+	ParticleEmitterHandle(void) : Index(INVALID_INDEX), Generation(0U) { }
+	ParticleEmitterHandle(unsigned int index, unsigned int generation) : Index(index), Generation(generation) { }
+
+	CMPINLINE bool				IsValid(void) const		{ return (Index != INVALID_INDEX); }
+};
+
+
 // Class is 16-bit aligned to allow use of SIMD member variables
 __declspec(align(16))
 class ParticleEmitter : public ALIGN16<ParticleEmitter>
@@ -18,21 +38,41 @@ class ParticleEmitter : public ALIGN16<ParticleEmitter>
 public:
 	enum Prop { MinValue = 0, MaxValue = 1 };						// Index into particle properties when setting min or max values
 
-	// Definition of a particle object
-	struct Particle
+	// Number of particles processed per SIMD iteration.  All particle streams are padded by this amount so that kernels can 
+	// always operate on full batches
+	static const int				BATCH_WIDTH = 4;
+
+	// Number of entries in the table of random values used to vary per-frame particle updates.  Must be a power of two
+	static const unsigned int		RANDOM_TABLE_SIZE = 4096U;
+
+	// SoA particle storage.  All live particles are held contiguously in [0, count), with dead particles compacted out
+	// during each update
+	// Class has no special alignment requirements
+	struct ParticleData
 	{
-		//				Position			// Is not specified here, since included within the vertex definition
-		//				Colour				// Is not specified here, since included within the vertex definition
-		bool			Active;				// Is the particle currently active?
-		float			Life;				// Remaining particle lifetime (secs)
-		XMFLOAT3		Velocity;			// Velocity of the particle
-		float			Size;				// Size of the particle
+		typedef std::vector<float, AlignedAllocator<float, 16U>>		FloatStream;
+
+		FloatStream					X, Y, Z;							// Particle position
+		FloatStream					VX, VY, VZ;							// Particle velocity
+		FloatStream					R, G, B, A;							// Particle colour
+		FloatStream					Size;								// Particle size
+		FloatStream					Life;								// Remaining particle lifetime (secs)
+		std::vector<unsigned char>	TexCoordSet;						// Index into the set of texture coordinate orientations
+
+		// Allocates and zeroes storage for the given number of particles, plus padding to a full final batch
+		void						Allocate(int capacity);
+
+		// Copies the particle at index 'src' to index 'dest'
+		void						Move(int src, int dest);
+
+		// Releases all storage
+		void						Release(void);
 	};
 
 	// Indexing data format; use UINT-16 for compatibility back to SM2.0
 	typedef UINT16 INDEXFORMAT;	
 
-	// Definition of a particle vertex; position & colour are located here and so not also in the Particle def to avoid duplication
+	// Definition of a particle vertex.  Vertices are generated directly into the vertex buffer from particle data each frame
 	struct ParticleVertex
 	{
 		XMFLOAT3 position;
@@ -46,9 +86,16 @@ public:
 	// Initialisation function
 	Result						Initialise(void);
 
-	// Methods for adding and per-frame updating of particles
-	void						AddParticle(int id);
-	void						UpdateParticles(const XMFLOAT3 & rightbasisvector, const XMFLOAT3 & upbasisvector);
+	// Adds a new particle to the emitter, if it is below its particle limit
+	void						AddParticle(void);
+
+	// Per-frame update of all particles.  Has no dependency on the rendering device, and can be executed for multiple
+	// emitters concurrently
+	void						UpdateParticles(float timefactor);
+
+	// Generates six billboard vertices for each live particle, facing along the given basis vectors, and writes them to 
+	// the destination buffer.  Destination must have space for GetVertexLimit() vertices.  Returns the number written
+	int							ExpandBillboards(ParticleVertex *dest, const XMFLOAT3 & rightbasisvector, const XMFLOAT3 & upbasisvector) const;
 
 	// Rendering method
 	void						Render(Rendering::RenderDeviceContextType  *devicecontext, const XMFLOAT3 & vright, const XMFLOAT3 & vup);
@@ -59,10 +106,18 @@ public:
 	// Clone function, for creating new instances from a prototype emitter object
 	ParticleEmitter				*CreateClone(void);
 
+	// Resets a previously-used instance back to the state of the prototype it was cloned from, retaining all allocated 
+	// particle storage and rendering buffers.  Prototype must have the same particle limit as this instance
+	void						ResetToPrototype(const ParticleEmitter & prototype);
+
 	// Methods to get & set the unique string key for this emitter
 	CMPINLINE std::string		GetCode(void) { return m_code; }
 	CMPINLINE void				SetCode(std::string code) { m_code = code; }
 
+	// Handle to this emitter within the particle engine
+	CMPINLINE ParticleEmitterHandle	GetHandle(void) const { return m_handle; }
+	CMPINLINE void				SetHandle(ParticleEmitterHandle handle) { m_handle = handle; }
+
 	// Accessor functions for emitter location properties
 	CMPINLINE XMVECTOR			GetPosition(void) const { return m_position; }
 	CMPINLINE XMVECTOR			GetOrientation(void) const { return m_orientation; }
@@ -127,6 +182,7 @@ public:
 	CMPINLINE int				GetParticleLimit(void) { return m_particlelimit; }
 	CMPINLINE int				GetVertexLimit(void) { return m_vertexlimit; }
 	CMPINLINE int				GetNumActiveParticles(void) { return m_numactiveparticles; }
+	CMPINLINE int				GetVertexCount(void) const { return m_vertexcount; }
 	CMPINLINE float				GetParticleEmissionFrequency(Prop prop) { return m_emissionfreq[(int)prop]; }
 	CMPINLINE void				SetParticleEmissionFrequency(Prop prop, float freq) { m_emissionfreq[(int)prop] = freq; }
 
@@ -150,6 +206,10 @@ public:
 	CMPINLINE XMFLOAT3			GetParticleVelocityUpdate(Prop prop) { return m_updatevelocity[(int)prop]; }
 	CMPINLINE void				SetParticleVelocityUpdate(Prop prop, XMFLOAT3 & vel) { m_updatevelocity[(int)prop] = vel; m_updateflag_velocity = true; }
 
+	// Headless benchmark of the particle update and billboard expansion passes across a range of particle counts.  Requires 
+	// no rendering device.  Returns a summary of the results, which is also written to the debug log
+	static std::string			RunBenchmark(const std::vector<int> & particle_counts, int frames);
+
 	ParticleEmitter(void);
 	~ParticleEmitter(void);
 
@@ -161,15 +221,20 @@ private:
 	Result						InitialiseBuffers(void);
 
 	// Rendering methods
-	void						RenderBuffers(Rendering::RenderDeviceContextType  *devicecontext);
+	void						RenderBuffers(Rendering::RenderDeviceContextType  *devicecontext, const XMFLOAT3 & vright, const XMFLOAT3 & vup);
+
+	// Returns the shared table of random values in the range [0 1), used to vary per-particle updates
+	static const ParticleData::FloatStream &	GetRandomTable(void);
 
-	// Memory allocated for storage of particle & vertex data, plus buffers required for rendering
-	Particle					*m_particles;						// The array of Particle objects
-	ParticleVertex				*m_vertices;						// The array of vertices (6n, where n is number of particles)
+	// Particle data, plus buffers required for rendering
+	ParticleData				m_particles;						// SoA particle data
 	ID3D11Buffer				*m_vertexbuffer, *m_indexbuffer;	// Vertex and index buffers for rendering the particle data
+	int							m_vertexcount;						// Number of vertices written to the vertex buffer in the last frame
+	unsigned int				m_randomoffset;						// Current offset into the random value table
 
 	// Emitter properties
 	std::string					m_code;								// String key of the unique emitter object
+	ParticleEmitterHandle		m_handle;							// Handle to this emitter within the particle engine
 	std::string					m_typecode;							// String key of the prototype, or the prototye this instance is based on
 	AXMVECTOR					m_position;							// Position of this emitter
 	AXMVECTOR					m_orientation;						// Orientation of this emitter
@@ -181,7 +246,6 @@ private:
 	bool						m_exists;							// Determines whether the emitter even exists (i.e. whether to even render)
 
 	int							m_numactiveparticles;				// The number of particles that are currently active
-	int							m_maxparticleidcreated;				// The highest index of particle we have ever created (and thus upper bound we have to process)
 
 	int							m_particlelimit;					// Maximum number of particles that can exist at any one time
 	int							m_vertexlimit;						// Similar limit for vertices; always equal to 6*particle limit
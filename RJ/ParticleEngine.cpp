@@ -8,7 +8,9 @@
 #include "ParticleEmitter.h"
 #include "ParticleShader.h"
 #include "ParticleEngine.h"
+#include "GameVarsExtern.h"
 #include "FastMath.h"
+#include "WorkerThreadPool.h"
 #include <vector>
 
 Result ParticleEngine::Initialise(void)
@@ -29,84 +31,187 @@ Result ParticleEngine::LinkParticleShader(ParticleShader *pshader)
 	return ErrorCodes::NoError;
 }
 
-Result ParticleEngine::AddEmitterPrototype(std::string key, ParticleEmitter *prototype)
+Result ParticleEngine::AddEmitterPrototype(const std::string & key, ParticleEmitter *prototype)
 {
 	// Check parameters
 	if (!prototype || key == NullString) return ErrorCodes::ReceivedNullParticleEmitterKey;
 
 	// Make sure this emitter doesn't already exist
-	if (m_prototypes.count(key) > 0) return ErrorCodes::ParticleEmitterKeyAlreadyAssigned;
+	if (m_prototype_index.count(key) > 0) return ErrorCodes::ParticleEmitterKeyAlreadyAssigned;
 
-	// Add to the collection and return success
-	m_prototypes[key] = prototype;
+	// Add to the collection
+	PrototypeID id = (PrototypeID)m_prototypes.size();
+	m_prototypes.push_back(PrototypeEntry(key, prototype));
+	m_prototype_index[key] = id;
+
+	// Pre-allocate a small number of instances so that the first emitters of this type do not require any allocation
+	PreallocateEmitters(id, DEFAULT_POOL_PREALLOCATION);
+
+	// Return success
 	return ErrorCodes::NoError;
 }
 
-Result ParticleEngine::RemoveEmitterPrototype(std::string key)
+Result ParticleEngine::RemoveEmitterPrototype(const std::string & key)
 {
 	// Parameter check
 	if (key == NullString) return ErrorCodes::ReceivedNullParticleEmitterKey;
 
 	// Make sure this key exists
-	if (m_prototypes.count(key) == 0) return ErrorCodes::CannotRemoveParticleEmitterThatDoesNotExist;
+	PrototypeID id = GetPrototypeID(key);
+	if (id == NO_PROTOTYPE || !m_prototypes[id].Prototype) return ErrorCodes::CannotRemoveParticleEmitterThatDoesNotExist;
+	PrototypeEntry & entry = m_prototypes[id];
+
+	// Release all pooled instances, then call the emitter shutdown method and delete the prototype
+	ReleasePool(entry);
+	entry.Prototype->Shutdown();
+	delete entry.Prototype;
+
+	// Remove the emitter prototype key and return success.  The prototype ID itself is not reused, so that any live 
+	// emitters of this type will simply be deallocated when they are shut down
+	entry.Prototype = NULL;
+	m_prototype_index.erase(key);
+	return ErrorCodes::NoError;
+}
 
-	// Get a handle to the prototype emitter
-	ParticleEmitter *emit = m_prototypes[key];
-	if (!emit) return ErrorCodes::CannotRemoveParticleEmitterThatDoesNotExist;
+ParticleEngine::PrototypeID ParticleEngine::GetPrototypeID(const std::string & key) const
+{
+	std::unordered_map<std::string, PrototypeID>::const_iterator it = m_prototype_index.find(key);
+	return (it == m_prototype_index.end() ? NO_PROTOTYPE : it->second);
+}
 
-	// Call the emitter shutdown method and delete the prototype
-	emit->Shutdown();
-	delete emit;
+// Ensures that at least the given number of unused instances of a prototype are available for immediate use
+void ParticleEngine::PreallocateEmitters(PrototypeID prototype, unsigned int count)
+{
+	ParticleEmitter *src = GetEmitterPrototype(prototype);
+	if (!src) return;
 
-	// Remove the emitter prototype key and return success
-	m_prototypes[key] = NULL;
-	return ErrorCodes::NoError;
+	std::vector<ParticleEmitter*> & pool = m_prototypes[prototype].Pool;
+	while (pool.size() < count) pool.push_back(src->CreateClone());
 }
 
-ParticleEmitter *ParticleEngine::CreateNewParticleEmitter(std::string key, std::string prototype)
+ParticleEmitter *ParticleEngine::CreateNewParticleEmitter(const std::string & code, PrototypeID prototype)
 {
 	// Parameter check
-	if (key == NullString || prototype == NullString) return NULL;
+	if (code == NullString) return NULL;
 
-	// Make sure this prototype exists, and that the target key doesn't exist
-	if (m_prototypes.count(prototype) == 0) return NULL;
-	if (m_emitters.count(key) > 0) return NULL;
+	// Obtain a new emitter based on this source prototype, if it is valid
+	ParticleEmitter *e = AcquireEmitter(prototype);
+	if (!e) return NULL;
 
-	// Make sure the source prototype is valid
-	ParticleEmitter *src = m_prototypes[prototype];
-	if (!src) return NULL;
-
-	// Create a new emitter based on this source prototype
-	ParticleEmitter *e = m_prototypes[prototype]->CreateClone();
+	// Take a slot in the emitter collection, reusing a free slot where possible
+	unsigned int index;
+	if (m_freeslots.empty())
+	{
+		index = (unsigned int)m_emitters.size();
+		m_emitters.push_back(EmitterSlot());
+	}
+	else
+	{
+		index = m_freeslots.back();
+		m_freeslots.pop_back();
+	}
 
-	// Set the unique string key of this emitter.  This must be unique & match the key used to index it into the collection
-	e->SetCode(key);
+	EmitterSlot & slot = m_emitters[index];
+	slot.Emitter = e;
+	slot.Prototype = prototype;
+	++m_emittercount;
 
-	// Add emitter to the collection and return a reference
-	m_emitters[key] = e;
+	// Set the string key and handle of this emitter, and return a reference
+	e->SetCode(code);
+	e->SetHandle(ParticleEmitterHandle(index, slot.Generation));
 	return e;
 }
 
-// Shuts down a specific emitter and releases all resources
-void ParticleEngine::ShutdownParticleEmitter(std::string key)
+// Shuts down a specific emitter and returns it to the pool for its prototype
+void ParticleEngine::ShutdownParticleEmitter(ParticleEmitterHandle handle)
 {
 	// Make sure this is a valid object
-	if (m_emitters.count(key) == 0) return;
-
-	// Get a handle to the emitter in question
-	ParticleEmitter *emit = m_emitters[key];
+	ParticleEmitter *emit = GetEmitter(handle);
 	if (!emit) return;
 
-	// Call the emitter shutdown method and then delete the object
-	emit->Shutdown();
-	delete emit; 
-	
-	// Finally set the emitter key to NULL to signify that the object no longer exists
-	m_emitters[key] = NULL;
+	// Release the emitter, then free the slot.  Incrementing the generation invalidates any outstanding handles to the slot
+	EmitterSlot & slot = m_emitters[handle.Index];
+	ReleaseEmitter(emit, slot.Prototype);
+
+	slot.Emitter = NULL;
+	slot.Prototype = NO_PROTOTYPE;
+	++slot.Generation;
+	m_freeslots.push_back(handle.Index);
+	--m_emittercount;
+}
+
+// Returns an emitter instance of the given prototype, from the pool if possible or otherwise by cloning the prototype
+ParticleEmitter *ParticleEngine::AcquireEmitter(PrototypeID prototype)
+{
+	ParticleEmitter *src = GetEmitterPrototype(prototype);
+	if (!src) return NULL;
+
+	std::vector<ParticleEmitter*> & pool = m_prototypes[prototype].Pool;
+	if (pool.empty()) return src->CreateClone();
+
+	// Pooled instances already hold their storage & buffers, so only need their properties resetting
+	ParticleEmitter *e = pool.back();
+	pool.pop_back();
+	e->ResetToPrototype(*src);
+	return e;
+}
+
+// Returns an emitter instance to the pool for its prototype, or deallocates it if the prototype no longer exists
+void ParticleEngine::ReleaseEmitter(ParticleEmitter *emitter, PrototypeID prototype)
+{
+	if (GetEmitterPrototype(prototype))
+	{
+		emitter->SetExists(false);
+		emitter->SetEmitting(false);
+		emitter->SetHandle(ParticleEmitterHandle());
+		m_prototypes[prototype].Pool.push_back(emitter);
+	}
+	else
+	{
+		emitter->Shutdown();
+		delete emitter;
+	}
+}
+
+// Deallocates all instances held in the pool for a prototype
+void ParticleEngine::ReleasePool(PrototypeEntry & entry)
+{
+	for (ParticleEmitter *e : entry.Pool)
+	{
+		e->Shutdown();
+		delete e;
+	}
+	entry.Pool.clear();
+}
+
+// Per-frame update of all active emitters.  Emitters are fully independent, so can be updated concurrently
+void ParticleEngine::UpdateEmitters(float timefactor)
+{
+	int count = (int)m_emitters.size();
+	auto update = [this, timefactor](int begin, int end)
+	{
+		for (int i = begin; i < end; ++i)
+		{
+			ParticleEmitter *e = m_emitters[i].Emitter;
+			if (e && e->Exists()) e->UpdateParticles(timefactor);
+		}
+	};
+
+	if (m_emittercount >= PARALLEL_MINIMUM_EMITTERS && Game::WorkerThreads.GetWorkerCount() != 0U)
+	{
+		Game::WorkerThreads.ParallelFor(count, 1, update);
+	}
+	else
+	{
+		update(0, count);
+	}
 }
 
 void RJ_XM_CALLCONV ParticleEngine::Render(const FXMMATRIX view, const CXMMATRIX proj, D3DMain *D3D, CameraClass *camera)
 {
+	// Update all particle data before rendering
+	UpdateEmitters(Game::TimeFactor);
+
 	/* TODO: Disabled since this does not work within the deferred rendering engine; replace with compliant implementation */
 
 	// Enable alpha blending and disable writing to the depth buffer (for correct alpha rendering) before rendering any particles
@@ -119,11 +224,10 @@ void RJ_XM_CALLCONV ParticleEngine::Render(const FXMMATRIX view, const CXMMATRIX
 	XMFLOAT3 vup = camera->GetViewUpBasisVectorF();
 
 	// Operate on each particle emitter in turn
-	ParticleEmitterCollection::const_iterator it_end = m_emitters.end();
-	for (ParticleEmitterCollection::const_iterator it = m_emitters.begin(); it != it_end; ++it) 
+	for (const EmitterSlot & slot : m_emitters)
 	{
 		// Get a reference to this particle emitter, and make sure it is active
-		ParticleEmitter *e = it->second;
+		ParticleEmitter *e = slot.Emitter;
 		if (!e || !e->Exists()) continue;
 
 		// TODO: Perform distance/view/frustrum test to see if we should actually render it
@@ -133,7 +237,7 @@ void RJ_XM_CALLCONV ParticleEngine::Render(const FXMMATRIX view, const CXMMATRIX
 		e->Render(D3D->GetDeviceContext(), vright, vup);
 
 		// Render particles using the particle shader
-		m_pshader->Render( D3D->GetDeviceContext(), e->GetVertexLimit(), ID_MATRIX,
+		m_pshader->Render( D3D->GetDeviceContext(), e->GetVertexCount(), ID_MATRIX,
 						   view, proj, e->GetParticleTexture() );
 	}
 
@@ -147,11 +251,10 @@ void RJ_XM_CALLCONV ParticleEngine::Render(const FXMMATRIX view, const CXMMATRIX
 void ParticleEngine::Shutdown(void)
 {
 	// Loop through each particle emitter in turn and dispose of it
-	ParticleEmitterCollection::const_iterator it_end = m_emitters.end();
-	for (ParticleEmitterCollection::const_iterator it = m_emitters.begin(); it != it_end; ++it) 
+	for (EmitterSlot & slot : m_emitters)
 	{
 		// Get a reference to this particle emitter
-		ParticleEmitter *e = it->second;
+		ParticleEmitter *e = slot.Emitter;
 		if (!e) continue;
 
 		// Call the emitter shutdown method
@@ -159,11 +262,16 @@ void ParticleEngine::Shutdown(void)
 
 		// Delete and deallocate the object
 		delete e;
-		e = NULL;
+		slot.Emitter = NULL;
 	}
 
+	// Also dispose of all pooled emitter instances
+	for (PrototypeEntry & entry : m_prototypes) ReleasePool(entry);
+
 	// Clear out the emitter collection
 	m_emitters.clear();
+	m_freeslots.clear();
+	m_emittercount = 0U;
 }
 
 
@@ -171,6 +279,7 @@ ParticleEngine::ParticleEngine(void)
 {
 	// Set all key pointers to NULL
 	m_pshader = NULL;
+	m_emittercount = 0U;
 }
 
 ParticleEngine::~ParticleEngine(void)
@@ -20,44 +20,111 @@ class ParticleShader;
 class ParticleEngine
 {
 public:
-	typedef std::unordered_map<std::string, ParticleEmitter*> ParticleEmitterCollection;
 
-	// Initialisation methods
-	Result Initialise(void);
-	Result LinkParticleShader(ParticleShader *pshader);
+	// Identifier of an emitter prototype.  Prototype IDs are stable for the lifetime of the engine, so callers which create
+	// emitters frequently can resolve a prototype once and avoid any string lookups thereafter
+	typedef int												PrototypeID;
+	static const PrototypeID								NO_PROTOTYPE = -1;
 
-	// Methods to add/retrieve/remove a particle emitter prototype
-	CMPINLINE ParticleEmitterCollection *GetEmitterPrototypes(void) { return &m_prototypes; }
-	CMPINLINE ParticleEmitter *GetEmitterPrototype(std::string key) { return m_prototypes[key]; }
-	Result AddEmitterPrototype(std::string key, ParticleEmitter *prototype);
-	Result RemoveEmitterPrototype(std::string key);
+	// Number of emitter instances that are pre-allocated for each prototype when it is registered
+	static const unsigned int								DEFAULT_POOL_PREALLOCATION = 4U;
+
+	// Minimum number of emitters before per-frame updates will be distributed across the worker thread pool
+	static const unsigned int								PARALLEL_MINIMUM_EMITTERS = 8U;
 
-	// Methods to add/retrieve/remove a particle emitter, based on a prototype object
-	CMPINLINE ParticleEmitterCollection *	GetEmitters(void) { return &m_emitters; }
-	CMPINLINE ParticleEmitter *				GetEmitter(std::string key) { return m_emitters[key]; }
-	ParticleEmitter *						CreateNewParticleEmitter(std::string key, std::string prototype);
-	void									ShutdownParticleEmitter(std::string key);
+	// Initialisation methods
+	Result													Initialise(void);
+	Result													LinkParticleShader(ParticleShader *pshader);
 
+	// Methods to add/retrieve/remove a particle emitter prototype
+	Result													AddEmitterPrototype(const std::string & key, ParticleEmitter *prototype);
+	Result													RemoveEmitterPrototype(const std::string & key);
+	PrototypeID												GetPrototypeID(const std::string & key) const;
+	CMPINLINE ParticleEmitter *								GetEmitterPrototype(PrototypeID id)
+	{
+		return ((id >= 0 && id < (PrototypeID)m_prototypes.size()) ? m_prototypes[id].Prototype : NULL);
+	}
+	CMPINLINE ParticleEmitter *								GetEmitterPrototype(const std::string & key) { return GetEmitterPrototype(GetPrototypeID(key)); }
+
+	// Ensures that at least the given number of unused instances of a prototype are available for immediate use
+	void													PreallocateEmitters(PrototypeID prototype, unsigned int count);
+
+	// Methods to create/retrieve/remove a particle emitter, based on a prototype object.  Emitters are taken from the pool
+	// for their prototype where possible, and returned to it on shutdown
+	ParticleEmitter *										CreateNewParticleEmitter(const std::string & code, PrototypeID prototype);
+	CMPINLINE ParticleEmitter *								CreateNewParticleEmitter(const std::string & code, const std::string & prototype)
+	{
+		return CreateNewParticleEmitter(code, GetPrototypeID(prototype));
+	}
+	CMPINLINE ParticleEmitter *								GetEmitter(ParticleEmitterHandle handle)
+	{
+		return ((handle.Index < m_emitters.size() && m_emitters[handle.Index].Generation == handle.Generation) ? m_emitters[handle.Index].Emitter : NULL);
+	}
+	void													ShutdownParticleEmitter(ParticleEmitterHandle handle);
+
+	// Returns the number of emitters currently in use
+	CMPINLINE unsigned int									GetEmitterCount(void) const		{ return m_emittercount; }
+
+	// Returns the number of unused instances currently held in the pool for a prototype
+	CMPINLINE unsigned int									GetPooledEmitterCount(PrototypeID prototype) const
+	{
+		return ((prototype >= 0 && prototype < (PrototypeID)m_prototypes.size()) ? (unsigned int)m_prototypes[prototype].Pool.size() : 0U);
+	}
+
+	// Per-frame update of all active emitters, distributed across the worker thread pool where there are sufficient emitters
+	void													UpdateEmitters(float timefactor);
 
 	// Rendering methods
-	void RJ_XM_CALLCONV Render(const FXMMATRIX view, const CXMMATRIX proj, D3DMain *D3D, CameraClass *camera);
+	void RJ_XM_CALLCONV										Render(const FXMMATRIX view, const CXMMATRIX proj, D3DMain *D3D, CameraClass *camera);
 
 	// Shutdown methods
-	void Shutdown(void);
+	void													Shutdown(void);
 
 	ParticleEngine(void);
 	~ParticleEngine(void);
 
 private:
 
-	// Collection of particle emitter prototypes, that are used to create new instances of particle emitter
-	std::unordered_map<std::string, ParticleEmitter*> m_prototypes;
+	// Slot in the dense emitter array.  Unused slots are held in a free list and reused by later emitters
+	struct EmitterSlot
+	{
+		ParticleEmitter *									Emitter;
+		unsigned int										Generation;
+		PrototypeID											Prototype;
+
+		EmitterSlot(void) : Emitter(NULL), Generation(0U), Prototype(NO_PROTOTYPE) { }
+	};
+
+	// Emitter prototype, plus the pool of unused emitter instances created from it
+	struct PrototypeEntry
+	{
+		std::string											Code;
+		ParticleEmitter *									Prototype;
+		std::vector<ParticleEmitter*>						Pool;
+
+		PrototypeEntry(const std::string & code, ParticleEmitter *prototype) : Code(code), Prototype(prototype) { }
+	};
+
+	// Returns an emitter instance of the given prototype, from the pool if possible or otherwise by cloning the prototype
+	ParticleEmitter *										AcquireEmitter(PrototypeID prototype);
+
+	// Returns an emitter instance to the pool for its prototype, or deallocates it if the prototype no longer exists
+	void													ReleaseEmitter(ParticleEmitter *emitter, PrototypeID prototype);
+
+	// Deallocates all instances held in the pool for a prototype
+	void													ReleasePool(PrototypeEntry & entry);
+
+	// Collection of particle emitter prototypes, that are used to create new instances of particle emitter, indexed by code
+	std::vector<PrototypeEntry>								m_prototypes;
+	std::unordered_map<std::string, PrototypeID>			m_prototype_index;
 
-	// Collection of particle emitters maintained by this particle engine
-	std::unordered_map<std::string, ParticleEmitter*> m_emitters;
+	// Dense collection of particle emitters maintained by this particle engine, plus the free list of unused slots
+	std::vector<EmitterSlot>								m_emitters;
+	std::vector<unsigned int>								m_freeslots;
+	unsigned int											m_emittercount;
 
 	// Particle shader used for rendering
-	ParticleShader *m_pshader;
+	ParticleShader *										m_pshader;
 };
 
 
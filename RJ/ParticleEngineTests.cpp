@@ -0,0 +1,129 @@
+#include "ErrorCodes.h"
+#include "ParticleEmitter.h"
+#include "ParticleEngine.h"
+
+#include "ParticleEngineTests.h"
+
+const std::string ParticleEngineTests::PROTOTYPE_CODE = "ParticleEngineTests";
+
+
+TestResult ParticleEngineTests::StaleHandleTests()
+{
+	TestResult result = NewResult();
+	ParticleEngine engine;
+	result.AssertEqual(engine.AddEmitterPrototype(PROTOTYPE_CODE, CreateTestPrototype()), ErrorCodes::NoError, ERR("Could not register test emitter prototype"));
+
+	ParticleEmitter *e0 = engine.CreateNewParticleEmitter("e0", PROTOTYPE_CODE);
+	result.AssertTrue(e0 != NULL, ERR("Could not create emitter"));
+	if (!e0) { engine.RemoveEmitterPrototype(PROTOTYPE_CODE); engine.Shutdown(); return result; }
+
+	ParticleEmitterHandle h0 = e0->GetHandle();
+	result.AssertTrue(h0.IsValid(), ERR("Emitter was not assigned a valid handle"));
+	result.AssertTrue(engine.GetEmitter(h0) == e0, ERR("Handle does not resolve to its emitter"));
+
+	// Once the emitter is shut down its handle should no longer resolve, even after the slot is reused by a new emitter
+	engine.ShutdownParticleEmitter(h0);
+	result.AssertTrue(engine.GetEmitter(h0) == NULL, ERR("Handle still resolves after its emitter was shut down"));
+
+	ParticleEmitter *e1 = engine.CreateNewParticleEmitter("e1", PROTOTYPE_CODE);
+	result.AssertTrue(e1 != NULL, ERR("Could not create emitter"));
+	if (e1)
+	{
+		ParticleEmitterHandle h1 = e1->GetHandle();
+		result.AssertEqual(h1.Index, h0.Index, ERR("Emitter slot was not reused"));
+		result.AssertTrue(h1.Generation != h0.Generation, ERR("Slot generation did not change when the slot was reused"));
+		result.AssertTrue(engine.GetEmitter(h0) == NULL, ERR("Stale handle resolves to the emitter which reused its slot"));
+		result.AssertTrue(engine.GetEmitter(h1) == e1, ERR("Handle to the reused slot does not resolve to its emitter"));
+
+		// Shutting down via the stale handle should have no effect on the new emitter
+		engine.ShutdownParticleEmitter(h0);
+		result.AssertTrue(engine.GetEmitter(h1) == e1, ERR("Stale handle shut down the emitter which reused its slot"));
+		result.AssertEqual(engine.GetEmitterCount(), 1U, ERR("Incorrect emitter count after shutdown via a stale handle"));
+	}
+
+	engine.RemoveEmitterPrototype(PROTOTYPE_CODE);
+	engine.Shutdown();
+	return result;
+}
+
+TestResult ParticleEngineTests::PooledEmitterResetTests()
+{
+	TestResult result = NewResult();
+	ParticleEngine engine;
+	result.AssertEqual(engine.AddEmitterPrototype(PROTOTYPE_CODE, CreateTestPrototype()), ErrorCodes::NoError, ERR("Could not register test emitter prototype"));
+	ParticleEngine::PrototypeID prototype = engine.GetPrototypeID(PROTOTYPE_CODE);
+
+	ParticleEmitter *e0 = engine.CreateNewParticleEmitter("e0", prototype);
+	result.AssertTrue(e0 != NULL, ERR("Could not create emitter"));
+	if (!e0) { engine.RemoveEmitterPrototype(PROTOTYPE_CODE); engine.Shutdown(); return result; }
+
+	// Modify the emitter state before returning it to the pool
+	for (int i = 0; i < 8; ++i) e0->AddParticle();
+	result.AssertEqual(e0->GetNumActiveParticles(), 8, ERR("Particles were not added to emitter"));
+	e0->SetPosition(XMVectorSet(100.0f, 200.0f, 300.0f, 0.0f));
+	e0->SetEmitting(false);
+
+	unsigned int pooled = engine.GetPooledEmitterCount(prototype);
+	engine.ShutdownParticleEmitter(e0->GetHandle());
+	result.AssertEqual(engine.GetPooledEmitterCount(prototype), pooled + 1U, ERR("Emitter was not returned to the pool on shutdown"));
+
+	// The next emitter should be the same pooled instance, restored to the state of the prototype
+	ParticleEmitter *e1 = engine.CreateNewParticleEmitter("e1", prototype);
+	result.AssertTrue(e1 == e0, ERR("Pooled emitter instance was not reused"));
+	if (e1)
+	{
+		result.AssertEqual(e1->GetNumActiveParticles(), 0, ERR("Pooled emitter retained active particles"));
+		result.AssertEqual(e1->GetVertexCount(), 0, ERR("Pooled emitter retained vertex data"));
+		result.AssertTrue(e1->Exists() && e1->IsEmitting(), ERR("Pooled emitter state was not reset to the prototype"));
+		result.AssertTrue(XMVector3Equal(e1->GetPosition(), engine.GetEmitterPrototype(prototype)->GetPosition()), ERR("Pooled emitter position was not reset to the prototype"));
+		result.AssertEqual(e1->GetCode(), std::string("e1"), ERR("Pooled emitter was not assigned its new code"));
+	}
+
+	engine.RemoveEmitterPrototype(PROTOTYPE_CODE);
+	engine.Shutdown();
+	return result;
+}
+
+TestResult ParticleEngineTests::RemovedPrototypeTests()
+{
+	TestResult result = NewResult();
+	ParticleEngine engine;
+	result.AssertEqual(engine.AddEmitterPrototype(PROTOTYPE_CODE, CreateTestPrototype()), ErrorCodes::NoError, ERR("Could not register test emitter prototype"));
+	ParticleEngine::PrototypeID prototype = engine.GetPrototypeID(PROTOTYPE_CODE);
+
+	ParticleEmitter *e0 = engine.CreateNewParticleEmitter("e0", prototype);
+	result.AssertTrue(e0 != NULL, ERR("Could not create emitter"));
+	if (!e0) { engine.RemoveEmitterPrototype(PROTOTYPE_CODE); engine.Shutdown(); return result; }
+	ParticleEmitterHandle h0 = e0->GetHandle();
+
+	// Removing the prototype should release its pool, but leave live emitters of that type in place
+	result.AssertEqual(engine.RemoveEmitterPrototype(PROTOTYPE_CODE), ErrorCodes::NoError, ERR("Could not remove emitter prototype"));
+	result.AssertEqual(engine.GetPooledEmitterCount(prototype), 0U, ERR("Pool was not released when its prototype was removed"));
+	result.AssertTrue(engine.GetEmitter(h0) == e0, ERR("Live emitter was removed along with its prototype"));
+	result.AssertTrue(engine.CreateNewParticleEmitter("e1", prototype) == NULL, ERR("Emitter was created from a removed prototype"));
+
+	// A live emitter of the removed type should then be deallocated when shut down, rather than returned to the pool
+	engine.ShutdownParticleEmitter(h0);
+	result.AssertTrue(engine.GetEmitter(h0) == NULL, ERR("Emitter of removed prototype was not shut down"));
+	result.AssertEqual(engine.GetPooledEmitterCount(prototype), 0U, ERR("Emitter of removed prototype was returned to the pool"));
+	result.AssertEqual(engine.GetEmitterCount(), 0U, ERR("Incorrect emitter count after shutdown of all emitters"));
+
+	engine.Shutdown();
+	return result;
+}
+
+ParticleEmitter * ParticleEngineTests::CreateTestPrototype(void)
+{
+	ParticleEmitter *prototype = new ParticleEmitter();
+	prototype->SetTypeCode(PROTOTYPE_CODE);
+	prototype->SetParticleLimit(16);
+	prototype->SetParticleEmissionFrequency(ParticleEmitter::Prop::MinValue, 0.1f);
+	prototype->SetParticleEmissionFrequency(ParticleEmitter::Prop::MaxValue, 0.2f);
+	prototype->SetInitialParticleLifetime(ParticleEmitter::Prop::MinValue, 5.0f);
+	prototype->SetInitialParticleLifetime(ParticleEmitter::Prop::MaxValue, 10.0f);
+	prototype->SetInitialParticleSize(ParticleEmitter::Prop::MinValue, 1.0f);
+	prototype->SetInitialParticleSize(ParticleEmitter::Prop::MaxValue, 2.0f);
+	prototype->Activate();
+
+	return prototype;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include "CompilerSettings.h"
+#include "TestBase.h"
+class ParticleEmitter;
+
+class ParticleEngineTests : public TestBase
+{
+public:
+
+	CMPINLINE TestResult RunTests(void)
+	{
+		TestResult result = NewNamedResult(ParticleEngineTests);
+
+		result += StaleHandleTests();
+		result += PooledEmitterResetTests();
+		result += RemovedPrototypeTests();
+
+		return result;
+	}
+
+
+private:
+
+	TestResult StaleHandleTests();
+	TestResult PooledEmitterResetTests();
+	TestResult RemovedPrototypeTests();
+
+	// Creates a new emitter prototype which exists and is emitting, with a small particle limit
+	ParticleEmitter * CreateTestPrototype(void);
+
+	// Code of the emitter prototype registered by each test
+	static const std::string PROTOTYPE_CODE;
+
+};
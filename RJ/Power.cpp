@@ -9,6 +9,8 @@ const unsigned int Power::POWER_UPDATE_INTERVAL_TACTICAL_SIMULATION = 5000U;	//
 const unsigned int Power::POWER_UPDATE_INTERVAL_STRATEGIC_SIMULATION = 20000U;	// ms
 const unsigned int Power::POWER_UPDATE_INTERVAL_NO_SIMULATION = 60000U;			// ms
 
+bool Power::USE_STENCIL_KERNEL = false;
+
 
 // Returns the oxygen update interval for a specific simulation state
 unsigned int Power::GetPowerUpdateInterval(iObject::ObjectSimulationState simulation_state)
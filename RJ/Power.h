@@ -19,6 +19,8 @@ public:
 	static const unsigned int POWER_UPDATE_INTERVAL_STRATEGIC_SIMULATION;
 	static const unsigned int POWER_UPDATE_INTERVAL_NO_SIMULATION;
 
+	static bool USE_STENCIL_KERNEL;															// Power maps will be updated via the vectorised stencil kernel if set
+
 	// Returns the power update interval for a specific simulation state
 	static unsigned int GetPowerUpdateInterval(iObject::ObjectSimulationState simulation_state);
 };
\ No newline at end of file
@@ -49,6 +49,7 @@
 #include "CentralScheduler.h"
 #include "CollisionDetectionResultsStruct.h"
 #include "GamePhysicsEngine.h"
+#include "WorkerThreadPool.h"
 #include "ObjectSearch.h"
 #include "LightingManagerObject.h"
 #include "FactionManagerObject.h"
@@ -462,6 +463,9 @@ void RJMain::TerminateApplication()
 	// Terminate all objects in the game
 	//Game::ShutdownObjectRegisters();
 
+	// Wait for any streaming operations to complete and release residency data before the underlying assets are released
+	Game::Engine->GetAssetResidency().Shutdown();
+
 	// Release all standard model/geometry data
 	Model::TerminateAllModelData();
 
@@ -1668,8 +1672,13 @@ Result RJMain::InitialiseCoreDataStructures(void)
 #	endif
 
 	// Schedule the central tree-pruning component to run on a regular basis.  It will maintain the tree for 
-	// each system that is added to the universe
-	Game::Scheduler.ScheduleInfrequentUpdates(&(Game::TreePruner), 2000);
+	// each system that is added to the universe.  Pruning restructures the spatial trees, which are also modified by 
+	// any object that moves during its own update, so it must run on the main thread
+	Game::Scheduler.ScheduleInfrequentUpdates(&(Game::TreePruner), 2000, CentralScheduler::ExecutionAffinity::MainThread);
+
+	// Start the pool of worker threads used for data-parallel work, sized to the available hardware concurrency
+	Game::WorkerThreads.Initialise();
+	Game::Log << LOG_INFO << "Worker thread pool initialised with " << Game::WorkerThreads.GetWorkerCount() << " threads\n";
 
 	// We have initialised all core data structures so return success
 	Game::Log << LOG_INFO << "Core data structured initialised\n";
@@ -1695,7 +1704,8 @@ Result RJMain::InitialiseLogging(void)
 	// Logging is initialised upon construction of the log component, so simply check here that it was successful
 	if (!Game::Log.LoggingActive()) return ErrorCodes::CouldNotInitialiseCentralLoggingComponent;
 
-	// Schedule a periodic update for the log, to ensure it is always flushed at regular intervals
+	// Schedule a periodic update for the log, to ensure it is always flushed at regular intervals.  The log stream is written 
+	// without synchronisation from the main thread, so the flush must also run on the main thread
 	Game::Scheduler.ScheduleInfrequentUpdates(&Game::Log, Game::C_LOG_FLUSH_INTERVAL);
 
 	// Output a log message that the component was successfully initialised
@@ -1749,6 +1759,9 @@ void RJMain::TerminateCoreDataStructures(void)
 	// pools must therefore be one of the final shutdown methods to ensure it incorporates items returned in other shutdown methods
 	/*Game::SpatialPartitioningTree->Shutdown();
 	Game::SpatialPartitioningTree = NULL;*/
+
+	// Terminate and join all worker threads
+	Game::WorkerThreads.Shutdown();
 }
 
 // Shutdown all object search components and any associated cache data
@@ -1848,14 +1861,29 @@ Result RJMain::LoadAllGameData()
 	// Record a log event when we begin loading game data files
 	Game::Log << "\n" << LOG_INFO << "Loading game data hierarchy...\n";
 
+	// Load the binary cache of game data files, so that any unchanged files do not need to be parsed
+	IO::Data::Cache.Load(D::DATA_S + "\\GameDataCache.bin");
+
+	// Read and parse all game data files in parallel ahead of time.  Objects are still constructed serially below, in 
+	// the same deterministic order, from the prefetched documents
+	IO::Data::PrefetchGameDataFiles("\\GameData.xml");
+
 	// Start at the primary index file that should already exist and work recursively outwards
 	res = IO::Data::LoadGameDataFile("\\GameData.xml");
+	IO::Data::ReleasePrefetchedDocuments();
 	if (res != ErrorCodes::NoError)
 	{
 		Game::Log << LOG_ERROR << "*** ERROR during load of game data hierarchy [" << res << "]\n\n";
+		IO::Data::Cache.Clear();
 		return res;
 	}
 
+	// Write back any regenerated cache entries, then release the cache since it is only required during initial load
+	Game::Log << LOG_INFO << "Game data cache: " << IO::Data::Cache.GetHitCount() << " files loaded from cache, " 
+			  << IO::Data::Cache.GetMissCount() << " files parsed\n";
+	IO::Data::Cache.Save();
+	IO::Data::Cache.Clear();
+
 	// We have reached this point without a fatal error
 	Game::Log << LOG_INFO << "All game data files loaded successfully\n\n";
 	return ErrorCodes::NoError;
@@ -83,7 +83,8 @@ struct RM_Instance
 
 	CMPINLINE RM_Instance(const FXMMATRIX world) noexcept
 		:
-		Flags(InstanceFlags::DEFAULT_INSTANCE_FLAGS)
+		Flags(InstanceFlags::DEFAULT_INSTANCE_FLAGS), 
+		SortKey(SORT_KEY_RENDER_FIRST)
 	{
 		XMStoreFloat4x4(&Transform, world);
 		LastTransform = Transform;
@@ -91,7 +92,8 @@ struct RM_Instance
 
 	CMPINLINE RM_Instance(const FXMMATRIX world, InstanceFlags::Type flags) noexcept
 		:
-		Flags(flags)
+		Flags(flags), 
+		SortKey(SORT_KEY_RENDER_FIRST)
 	{
 		XMStoreFloat4x4(&Transform, world);
 		LastTransform = Transform;
@@ -99,7 +101,8 @@ struct RM_Instance
 
 	CMPINLINE RM_Instance(const FXMMATRIX world, const CXMMATRIX lastworld, InstanceFlags::Type flags) noexcept
 		:
-		Flags(flags)
+		Flags(flags), 
+		SortKey(SORT_KEY_RENDER_FIRST)
 	{
 		XMStoreFloat4x4(&Transform, world);
 		XMStoreFloat4x4(&LastTransform, lastworld);
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "CompilerSettings.h"
+class ModelBuffer;
+class MaterialDX11;
+
+
+// Contiguous range of instances in the sorted render queue which share the same shader, model and material, and which
+// can therefore be rendered through instanced draw calls without any change in state
+struct RM_RenderBatch
+{
+	ModelBuffer *								Model;
+	const MaterialDX11 *						Material;
+	size_t										InstanceStart;		// Index of the first instance in the sorted instance data
+	size_t										InstanceCount;
+	size_t										ShadowCasterCount;	// Number of instances in the batch which are shadow casters
+
+	// Constructor
+	CMPINLINE RM_RenderBatch(ModelBuffer *model, const MaterialDX11 *material, size_t instance_start) noexcept
+		:
+		Model(model), Material(material), InstanceStart(instance_start), InstanceCount(0U), ShadowCasterCount(0U)
+	{
+	}
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "DX11_Core.h"
+#include "CompilerSettings.h"
+#include "ShaderFlags.h"
+
+
+// Per-shader section of the render queue.  Holds the shader rendering state, and the range of render batches for the
+// shader within the sorted render queue for the current frame
+struct RM_ShaderQueue
+{
+	D3D_PRIMITIVE_TOPOLOGY						PrimitiveTopology;
+	ShaderFlags									Flags;
+	size_t										BatchStart;			// Index of the first batch for this shader
+	size_t										BatchEnd;			// Index one past the last batch for this shader
+
+	// Default constructor
+	CMPINLINE RM_ShaderQueue(void) noexcept
+		:
+		PrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY::D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST), Flags(0U), BatchStart(0U), BatchEnd(0U)
+	{
+	}
+
+	// Indicates whether any instances were submitted for this shader
+	CMPINLINE bool								Empty(void) const { return (BatchStart == BatchEnd); }
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#ifndef __RadixSortH__
+#define __RadixSortH__
+
+#include <vector>
+#include <utility>
+#include <cstring>
+#include <stdint.h>
+#include "CompilerSettings.h"
+
+// Least-significant-digit radix sort over unsigned integral keys.  Sorts an index permutation rather than the keys
+// themselves, so that callers holding SoA data can gather every stream once the order is known.  Sort is stable
+// and linear in the number of keys; passes in which every key shares the same digit are skipped entirely
+// Class has no special alignment requirements
+class RadixSort
+{
+public:
+
+	// Number of bits processed per pass, and the resulting histogram size
+	static const unsigned int			RADIX_BITS = 8U;
+	static const unsigned int			RADIX_SIZE = (1U << RADIX_BITS);
+	static const unsigned int			RADIX_MASK = (RADIX_SIZE - 1U);
+
+	// Sorts the supplied keys and returns the resulting permutation in 'outIndices', i.e. keys[outIndices[0]] is the
+	// smallest key.  'scratch' is used as a working buffer and can be retained by the caller between calls to avoid
+	// reallocation.  Only the lowest 'key_bits' bits of each key are considered
+	template <typename TKey>
+	static void							SortIndices(const TKey *keys, uint32_t count, std::vector<uint32_t> & outIndices,
+													std::vector<uint32_t> & scratch, unsigned int key_bits = (sizeof(TKey) * 8U));
+
+	// Convenience overload accepting a vector of keys
+	template <typename TKey>
+	CMPINLINE static void				SortIndices(const std::vector<TKey> & keys, std::vector<uint32_t> & outIndices, std::vector<uint32_t> & scratch,
+													unsigned int key_bits = (sizeof(TKey) * 8U))
+	{
+		SortIndices<TKey>((keys.empty() ? NULL : &(keys[0])), (uint32_t)keys.size(), outIndices, scratch, key_bits);
+	}
+
+};
+
+
+// Sorts the supplied keys and returns the resulting permutation in 'outIndices'
+template <typename TKey>
+void RadixSort::SortIndices(const TKey *keys, uint32_t count, std::vector<uint32_t> & outIndices, std::vector<uint32_t> & scratch, unsigned int key_bits)
+{
+	// Initialise the output permutation to the identity ordering
+	outIndices.resize(count);
+	for (uint32_t i = 0U; i < count; ++i) outIndices[i] = i;
+	if (count < 2U || !keys) return;
+
+	// Working buffer for each scatter pass
+	scratch.resize(count);
+	uint32_t *src = &(outIndices[0]);
+	uint32_t *dst = &(scratch[0]);
+	uint32_t histogram[RADIX_SIZE];
+
+	// Process each digit in turn, from least to most significant
+	for (unsigned int shift = 0U; shift < key_bits; shift += RADIX_BITS)
+	{
+		// Build the histogram for this digit
+		memset(histogram, 0, sizeof(histogram));
+		for (uint32_t i = 0U; i < count; ++i)
+		{
+			++histogram[(uint32_t)((keys[i] >> shift) & RADIX_MASK)];
+		}
+
+		// If every key shares the same digit then this pass would be an identity permutation; skip it
+		if (histogram[(uint32_t)((keys[0] >> shift) & RADIX_MASK)] == count) continue;
+
+		// Convert to an exclusive prefix sum, giving the output offset of each bucket
+		uint32_t offset = 0U;
+		for (unsigned int b = 0U; b < RADIX_SIZE; ++b)
+		{
+			uint32_t n = histogram[b];
+			histogram[b] = offset;
+			offset += n;
+		}
+
+		// Scatter indices into their buckets, maintaining stability
+		for (uint32_t i = 0U; i < count; ++i)
+		{
+			uint32_t index = src[i];
+			dst[histogram[(uint32_t)((keys[index] >> shift) & RADIX_MASK)]++] = index;
+		}
+
+		// Swap buffers for the next pass
+		std::swap(src, dst);
+	}
+
+	// If the final pass left the result in the scratch buffer then copy it back to the output
+	if (src != &(outIndices[0]))
+	{
+		memcpy(&(outIndices[0]), src, sizeof(uint32_t) * count);
+	}
+}
+
+
+#endif
@@ -1,29 +1,239 @@
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include "Utility.h"
+#include "Logging.h"
+#include "Timers.h"
+#include "InstanceFlags.h"
 #include "ModelBuffer.h"
+#include "MaterialDX11.h"
+
 #include "RenderQueue.h"
 
+// Shader index must fit within the shader component of the sort key
+static_assert(RenderQueueShader::RM_RENDERQUEUESHADERCOUNT <= (1U << RenderQueue::KEY_SHADER_BITS), "Render queue shader count exceeds sort key capacity");
+
 
-// Constructor that will pre-initialise the given number of elements
-RenderQueue::RenderQueue(const size_type count)
+// Default constructor
+RenderQueue::RenderQueue(void)
 	:
-	std::vector<RM_ModelDataCollection>(count)
+	m_instancecount(0U), m_prepared(true)
+{
+}
+
+// Initialises the queue with one section per shader, taking rendering state from each shader definition
+void RenderQueue::Initialise(const RM_ShaderCollection & shaders)
 {
+	Clear();
+
+	m_shaders = std::vector<RM_ShaderQueue>(shaders.size());
+	m_models = std::vector<std::vector<ModelBuffer*>>(shaders.size());
+
+	for (size_t i = 0U; i < shaders.size(); ++i)
+	{
+		m_shaders[i].PrimitiveTopology = shaders[i].PrimitiveTopology;
+		m_shaders[i].Flags = shaders[i].Flags;
+	}
 }
 
-// Assign an instance to the given model buffer
-void RenderQueue::RegisterModelBuffer(size_t shader, size_t slot, ModelBuffer *model)
+// Submits an instance for rendering.  Instances with no material are rendered with the default model material
+void RenderQueue::Submit(size_t shader, ModelBuffer *model, const MaterialDX11 *material, RM_Instance && instance, RM_InstanceMetadata && metadata)
 {
 	assert(model != NULL);
+	assert(shader < m_shaders.size());
+
+	if (!material) material = model->Material;
+
+	// Assign a frame-local render slot to the model if it has not yet been submitted for this shader.  The slot forms part 
+	// of the sort key, so that all instances of the model are grouped together
+	size_t slot = model->GetAssignedRenderSlot(shader);
+	if (slot == ModelBuffer::NO_RENDER_SLOT)
+	{
+		slot = m_models[shader].size();
+		assert(slot < (1U << KEY_MODEL_BITS));
+
+		m_models[shader].push_back(model);
+		model->AssignRenderSlot(shader, slot);
+	}
+
+	// Append the instance to the arena, reusing any elements retained from previous frames
+	RM_SortKey depth = instance.SortKey;
+	if (m_instancecount == m_instances.size())
+	{
+		m_instances.emplace_back(std::move(instance));
+		m_metadata.emplace_back(std::move(metadata));
+		m_materials.push_back(material);
+	}
+	else
+	{
+		m_instances[m_instancecount] = std::move(instance);
+		m_metadata[m_instancecount] = std::move(metadata);
+		m_materials[m_instancecount] = material;
+	}
+
+	// Record the sort key for this instance, at the same index as the instance in the arena
+	m_keys.push_back(BuildSortKey(shader, (material ? material->GetID() : 0U), slot, depth));
 
-	model->AssignRenderSlot(shader, slot);
-	Get(shader).ModelData[slot].AssignModel(model);
+	++m_instancecount;
+	m_prepared = false;
 }
 
-// Clears the specified model data following a successful render, unregistering any 
-// relevant model buffer data and returning to a state ready for next frame
-void RenderQueue::UnregisterModelBuffer(size_t shader, size_t slot)
+// Sorts and batches all submitted instances.  Has no effect if the queue has not changed since it was last prepared
+void RenderQueue::Prepare(void)
 {
-	assert(Get(shader).ModelData[slot].ModelBufferInstance != NULL);
+	if (m_prepared) return;
 
-	Get(shader).ModelData[slot].ModelBufferInstance->ClearRenderSlot(shader);
-	Get(shader).ModelData[slot].ClearModel();
+	// Keys are held in submission order and the sort is stable, so instances with identical keys are always rendered in 
+	// submission order
+	RadixSort::SortIndices(m_keys, m_sortorder, m_sortscratch, KEY_BITS);
+	BuildBatches();
+
+	m_prepared = true;
+}
+
+// Builds the sorted instance data and render batches from the current sort keys
+void RenderQueue::BuildBatches(void)
+{
+	size_t count = m_keys.size();
+
+	// Gather instance data into sorted order
+	while (m_sorted_instances.size() < count)
+	{
+		m_sorted_instances.emplace_back(std::move(RM_Instance()));
+		m_sorted_metadata.emplace_back(std::move(RM_InstanceMetadata()));
+	}
+
+	for (size_t i = 0U; i < count; ++i)
+	{
+		uint32_t index = m_sortorder[i];
+		m_sorted_instances[i] = RM_Instance(m_instances[index]);
+		m_sorted_metadata[i] = RM_InstanceMetadata(m_metadata[index]);
+	}
+
+	// Reset the batch range of each shader
+	for (auto & shader : m_shaders)
+	{
+		shader.BatchStart = shader.BatchEnd = 0U;
+	}
+
+	// Split the sorted instances into batches wherever the { shader, material, model } key prefix changes.  Material IDs are 
+	// truncated within the key, so also split on any change in material to ensure that colliding IDs are never merged
+	m_batches.clear();
+	size_t i = 0U;
+	while (i < count)
+	{
+		SortKey prefix = (m_keys[m_sortorder[i]] >> KEY_MODEL_SHIFT);
+		size_t shader = static_cast<size_t>(m_keys[m_sortorder[i]] >> KEY_SHADER_SHIFT);
+		size_t slot = static_cast<size_t>(prefix & ((1U << KEY_MODEL_BITS) - 1U));
+		const MaterialDX11 *material = m_materials[m_sortorder[i]];
+
+		RM_RenderBatch batch(m_models[shader][slot], material, i);
+		while (i < count && (m_keys[m_sortorder[i]] >> KEY_MODEL_SHIFT) == prefix && m_materials[m_sortorder[i]] == material)
+		{
+			if (CheckBit_Single(m_sorted_instances[i].Flags, InstanceFlags::INSTANCE_FLAG_SHADOW_CASTER)) ++batch.ShadowCasterCount;
+			++i;
+		}
+		batch.InstanceCount = (i - batch.InstanceStart);
+
+		// Batches are generated in shader order, so each shader covers a contiguous range of batches
+		if (m_shaders[shader].Empty()) m_shaders[shader].BatchStart = m_batches.size();
+		m_batches.push_back(batch);
+		m_shaders[shader].BatchEnd = m_batches.size();
+	}
+}
+
+// Clears the queue following rendering, ready for the next frame.  Allocated capacity is retained
+void RenderQueue::Clear(void)
+{
+	// Release the render slots assigned to each model this frame
+	for (size_t shader = 0U; shader < m_models.size(); ++shader)
+	{
+		for (ModelBuffer *model : m_models[shader]) model->ClearRenderSlot(shader);
+		m_models[shader].clear();
+	}
+
+	for (auto & shader : m_shaders)
+	{
+		shader.BatchStart = shader.BatchEnd = 0U;
+	}
+
+	m_keys.clear();
+	m_sortorder.clear();
+	m_batches.clear();
+	m_instancecount = 0U;
+	m_prepared = true;
+}
+
+// Clears the queue and releases all allocated storage
+void RenderQueue::Deallocate(void)
+{
+	Clear();
+
+	std::vector<RM_Instance>().swap(m_instances);
+	std::vector<RM_InstanceMetadata>().swap(m_metadata);
+	std::vector<const MaterialDX11*>().swap(m_materials);
+	std::vector<SortKey>().swap(m_keys);
+	std::vector<uint32_t>().swap(m_sortorder);
+	std::vector<uint32_t>().swap(m_sortscratch);
+	std::vector<RM_Instance>().swap(m_sorted_instances);
+	std::vector<RM_InstanceMetadata>().swap(m_sorted_metadata);
+	std::vector<RM_RenderBatch>().swap(m_batches);
+	for (auto & models : m_models) std::vector<ModelBuffer*>().swap(models);
+}
+
+// Benchmarks the radix sort against a comparison sort over randomly-generated keys.  Returns the results, which
+// are also written to the log
+std::string RenderQueue::RunBenchmark(const std::vector<size_t> & instance_counts, int iterations)
+{
+	iterations = max(iterations, 1);
+
+	std::mt19937_64 rng(12345U);
+	std::vector<SortKey> keys;
+	std::vector<uint32_t> radix, comparison, scratch;
+
+	std::ostringstream ss;
+	ss << "Render queue sort benchmark (" << iterations << " iterations per instance count):\n";
+
+	for (size_t count : instance_counts)
+	{
+		// Generate keys with a realistic distribution; few shaders, a moderate number of materials and models, random depth
+		keys.clear();
+		for (size_t i = 0U; i < count; ++i)
+		{
+			keys.push_back(BuildSortKey((size_t)(rng() % RenderQueueShader::RM_RENDERQUEUESHADERCOUNT), (unsigned int)(rng() % 64U),
+										(size_t)(rng() % 512U), (RM_SortKey)rng()));
+		}
+
+		// Radix sort
+		Timers::HRClockTime start = Timers::GetHRClockTime();
+		for (int it = 0; it < iterations; ++it)
+		{
+			RadixSort::SortIndices(keys, radix, scratch, KEY_BITS);
+		}
+		Timers::HRClockDuration radix_time = Timers::GetMillisecondDuration(start, Timers::GetHRClockTime());
+
+		// Comparison sort
+		start = Timers::GetHRClockTime();
+		for (int it = 0; it < iterations; ++it)
+		{
+			comparison.resize(count);
+			for (size_t i = 0U; i < count; ++i) comparison[i] = (uint32_t)i;
+			std::stable_sort(comparison.begin(), comparison.end(), [&keys](uint32_t a, uint32_t b) { return (keys[a] < keys[b]); });
+		}
+		Timers::HRClockDuration comparison_time = Timers::GetMillisecondDuration(start, Timers::GetHRClockTime());
+
+		// Both sorts are stable, so the resulting permutations should be identical
+		bool match = (radix == comparison);
+
+		ss << "  " << count << " instances: radix=" << radix_time << "ms, std::stable_sort=" << comparison_time << "ms, speedup="
+		   << (radix_time > 0.0 ? (comparison_time / radix_time) : 0.0) << "x" << (match ? "" : " [RESULT MISMATCH]") << "\n";
+	}
+
+	Game::Log << LOG_INFO << ss.str();
+	return ss.str();
+}
+
+// Default destructor
+RenderQueue::~RenderQueue(void)
+{
 }
@@ -1,30 +1,113 @@
 #pragma once
 
 #include <vector>
-#include "RM_ModelDataCollection.h"
+#include <string>
+#include <stdint.h>
+#include "CompilerSettings.h"
+#include "RadixSort.h"
+#include "RenderQueueShaders.h"
+#include "RM_Instance.h"
+#include "RM_InstanceMetadata.h"
+#include "RM_ShaderQueue.h"
+#include "RM_RenderBatch.h"
+class ModelBuffer;
+class MaterialDX11;
 
-class RenderQueue : public std::vector<RM_ModelDataCollection>
+
+// Persistent render queue.  All instances submitted in a frame are appended to a single linear arena, alongside a 64-bit
+// sort key built from { shader, material, model, depth }.  Keys are radix-sorted into an index permutation before the queue
+// is first processed, after which instances are gathered into sorted order and grouped into render batches.  All storage
+// retains its capacity between frames, so submission performs no allocation once the queue has reached its steady-state size
+class RenderQueue
 {
 public:
 
+	typedef uint64_t							SortKey;
+
+	// Sort key layout, from most- to least-significant bits: { shader | material | model | depth }
+	static const unsigned int					KEY_DEPTH_BITS = 24U;
+	static const unsigned int					KEY_MODEL_BITS = 20U;
+	static const unsigned int					KEY_MATERIAL_BITS = 16U;
+	static const unsigned int					KEY_SHADER_BITS = 4U;
+	static const unsigned int					KEY_MODEL_SHIFT = KEY_DEPTH_BITS;
+	static const unsigned int					KEY_MATERIAL_SHIFT = (KEY_MODEL_SHIFT + KEY_MODEL_BITS);
+	static const unsigned int					KEY_SHADER_SHIFT = (KEY_MATERIAL_SHIFT + KEY_MATERIAL_BITS);
+	static const unsigned int					KEY_BITS = (KEY_SHADER_SHIFT + KEY_SHADER_BITS);
+
 	// Default constructor
-	CMPINLINE RenderQueue(void) { }
+	RenderQueue(void);
 
-	// Constructor that will pre-initialise the given number of elements
-	RenderQueue(const size_type count);
+	// Initialises the queue with one section per shader, taking rendering state from each shader definition
+	void										Initialise(const RM_ShaderCollection & shaders);
 
-	// Retrieve an element from the queue; no bounds checking
-	CMPINLINE RM_ModelDataCollection &			Get(size_type index) { return operator[](index); }
+	// Submits an instance for rendering.  Instances with no material are rendered with the default model material
+	void										Submit(size_t shader, ModelBuffer *model, const MaterialDX11 *material, RM_Instance && instance, RM_InstanceMetadata && metadata);
 
-	// Assign this instance to the given model buffer
-	void										RegisterModelBuffer(size_t shader, size_t slot, ModelBuffer *model);
+	// Sorts and batches all submitted instances.  Has no effect if the queue has not changed since it was last prepared
+	void										Prepare(void);
 
-	// Clears the specified model data following a successful render, unregistering any 
-	// relevant model buffer data and returning to a state ready for next frame
-	void										UnregisterModelBuffer(size_t shader, size_t slot);
+	// Clears the queue following rendering, ready for the next frame.  Allocated capacity is retained
+	void										Clear(void);
 
+	// Clears the queue and releases all allocated storage
+	void										Deallocate(void);
 
+	// Accessors for the prepared queue data.  Only valid following a call to Prepare()
+	CMPINLINE size_t							GetShaderCount(void) const						{ return m_shaders.size(); }
+	CMPINLINE const RM_ShaderQueue &			GetShaderQueue(size_t shader) const				{ return m_shaders[shader]; }
+	CMPINLINE size_t							GetBatchCount(void) const						{ return m_batches.size(); }
+	CMPINLINE const RM_RenderBatch &			GetBatch(size_t batch) const					{ return m_batches[batch]; }
+	CMPINLINE const RM_Instance &				GetInstance(size_t index) const					{ return m_sorted_instances[index]; }
+	CMPINLINE const RM_InstanceMetadata &		GetInstanceMetadata(size_t index) const			{ return m_sorted_metadata[index]; }
+	CMPINLINE SortKey							GetInstanceSortKey(size_t index) const			{ return m_keys[m_sortorder[index]]; }
 
+	// Number of instances submitted to the queue this frame
+	CMPINLINE size_t							GetInstanceCount(void) const					{ return m_instancecount; }
 
-};
+	// Builds the sort key for an instance.  Depth is taken from the most significant bits of the instance sort key
+	CMPINLINE static SortKey					BuildSortKey(size_t shader, unsigned int material_id, size_t model_slot, RM_SortKey depth)
+	{
+		return ((static_cast<SortKey>(shader) << KEY_SHADER_SHIFT) |
+				(static_cast<SortKey>(material_id & ((1U << KEY_MATERIAL_BITS) - 1U)) << KEY_MATERIAL_SHIFT) |
+				(static_cast<SortKey>(model_slot) << KEY_MODEL_SHIFT) |
+				static_cast<SortKey>(depth >> ((sizeof(RM_SortKey) * 8U) - KEY_DEPTH_BITS)));
+	}
+
+	// Benchmarks the radix sort against a comparison sort over randomly-generated keys.  Returns the results, which
+	// are also written to the log
+	static std::string							RunBenchmark(const std::vector<size_t> & instance_counts, int iterations);
+
+	// Default destructor
+	~RenderQueue(void);
+
+private:
+
+	// Builds the sorted instance data and render batches from the current sort keys
+	void										BuildBatches(void);
 
+private:
+
+	std::vector<RM_ShaderQueue>					m_shaders;
+
+	// Models that have been assigned a render slot this frame, indexed by shader and then by slot
+	std::vector<std::vector<ModelBuffer*>>		m_models;
+
+	// Instance arena, in submission order
+	std::vector<RM_Instance>					m_instances;
+	std::vector<RM_InstanceMetadata>			m_metadata;
+	std::vector<const MaterialDX11*>			m_materials;
+	size_t										m_instancecount;
+
+	// Sort keys in submission order, the sorted permutation of arena indices, and working storage for the radix sort
+	std::vector<SortKey>						m_keys;
+	std::vector<uint32_t>						m_sortorder;
+	std::vector<uint32_t>						m_sortscratch;
+
+	// Instance data gathered into sorted order, and the render batches covering it
+	std::vector<RM_Instance>					m_sorted_instances;
+	std::vector<RM_InstanceMetadata>			m_sorted_metadata;
+	std::vector<RM_RenderBatch>					m_batches;
+
+	// Flag indicating whether the sorted data is up-to-date with all submissions
+	bool										m_prepared;
+};
@@ -0,0 +1,252 @@
+#include <random>
+#include "Utility.h"
+#include "FastMath.h"
+#include "InstanceFlags.h"
+#include "ModelBuffer.h"
+#include "MaterialDX11.h"
+#include "RenderQueue.h"
+
+#include "RenderQueueTests.h"
+
+// Number of low-order instance sort key bits which are discarded when building the queue sort key
+static const unsigned int RENDERQUEUE_TEST_DEPTH_SHIFT = ((sizeof(RM_SortKey) * 8U) - RenderQueue::KEY_DEPTH_BITS);
+
+
+TestResult RenderQueueTests::KeyOrderingTests()
+{
+	TestResult result = NewResult();
+	RenderQueue queue;
+	InitialiseTestQueue(queue, 2U);
+
+	ModelBuffer a, b;
+	MaterialDX11 m0("m0"), m1("m1");
+	const MaterialDX11 *low, *high;
+	DetermineMaterialKeyOrder(&m0, &m1, low, high);
+
+	SubmitOrderingScenario(queue, &a, &b, low, high);
+	queue.Prepare();
+
+	// Instances should be ordered by shader, then material, then model slot, then depth.  Depths are unique so fully identify
+	// each instance:   { s0, b, low, 7 }, { s0, a, low, 4 }, { s0, b, high, 1 }, { s0, b, high, 3 },
+	//					{ s0, a, high, 2 }, { s0, a, high, 9 }, { s1, a, low, 5 }
+	const unsigned int expected_depth[] = { 7U, 4U, 1U, 3U, 2U, 9U, 5U };
+	const size_t expected_shader[] = { 0U, 0U, 0U, 0U, 0U, 0U, 1U };
+	const size_t count = (sizeof(expected_depth) / sizeof(expected_depth[0]));
+
+	result.AssertEqual(queue.GetInstanceCount(), count, ERR("Incorrect number of instances in render queue"));
+	if (queue.GetInstanceCount() != count) { queue.Clear(); return result; }
+
+	bool depth_order = true, shader_order = true, key_order = true;
+	for (size_t i = 0U; i < count; ++i)
+	{
+		if (DetermineInstanceDepth(queue.GetInstance(i)) != expected_depth[i]) depth_order = false;
+		if ((size_t)(queue.GetInstanceSortKey(i) >> RenderQueue::KEY_SHADER_SHIFT) != expected_shader[i]) shader_order = false;
+		if (i != 0U && queue.GetInstanceSortKey(i) < queue.GetInstanceSortKey(i - 1U)) key_order = false;
+	}
+
+	result.AssertTrue(depth_order, ERR("Instances were not sorted by { shader, material, model, depth }"));
+	result.AssertTrue(shader_order, ERR("Sort key shader component does not match the submitted shader"));
+	result.AssertTrue(key_order, ERR("Sort keys are not in ascending order"));
+
+	// Instances with identical keys should retain their submission order
+	queue.Clear();
+	SubmitTestInstance(queue, 0U, &a, low, 6U, false);
+	SubmitTestInstance(queue, 0U, &a, low, 6U, true);
+	SubmitTestInstance(queue, 0U, &a, low, 6U, false);
+	queue.Prepare();
+	result.AssertTrue(queue.GetInstanceCount() == 3U && CheckBit_Single(queue.GetInstance(1U).Flags, InstanceFlags::INSTANCE_FLAG_SHADOW_CASTER) &&
+		!CheckBit_Single(queue.GetInstance(0U).Flags | queue.GetInstance(2U).Flags, InstanceFlags::INSTANCE_FLAG_SHADOW_CASTER),
+		ERR("Sort is not stable for instances with identical keys"));
+
+	queue.Clear();
+	return result;
+}
+
+TestResult RenderQueueTests::BatchBoundaryTests()
+{
+	TestResult result = NewResult();
+	RenderQueue queue;
+	InitialiseTestQueue(queue, 3U);
+
+	ModelBuffer a, b;
+	MaterialDX11 m0("m0"), m1("m1");
+	const MaterialDX11 *low, *high;
+	DetermineMaterialKeyOrder(&m0, &m1, low, high);
+
+	SubmitOrderingScenario(queue, &a, &b, low, high);
+	queue.Prepare();
+
+	// A new batch should begin at every change in { shader, material, model }, with shadow casters counted per batch
+	struct ExpectedBatch { ModelBuffer *Model; const MaterialDX11 *Material; size_t Start; size_t Count; size_t ShadowCasters; };
+	const ExpectedBatch expected[] = {
+		{ &b, low, 0U, 1U, 0U }, { &a, low, 1U, 1U, 0U }, { &b, high, 2U, 2U, 1U }, { &a, high, 4U, 2U, 1U }, { &a, low, 6U, 1U, 1U } };
+	const size_t count = (sizeof(expected) / sizeof(expected[0]));
+
+	result.AssertEqual(queue.GetBatchCount(), count, ERR("Incorrect number of render batches"));
+	if (queue.GetBatchCount() == count)
+	{
+		bool models = true, materials = true, ranges = true, shadow_casters = true;
+		for (size_t i = 0U; i < count; ++i)
+		{
+			const RM_RenderBatch & batch = queue.GetBatch(i);
+			if (batch.Model != expected[i].Model) models = false;
+			if (batch.Material != expected[i].Material) materials = false;
+			if (batch.InstanceStart != expected[i].Start || batch.InstanceCount != expected[i].Count) ranges = false;
+			if (batch.ShadowCasterCount != expected[i].ShadowCasters) shadow_casters = false;
+		}
+
+		result.AssertTrue(models, ERR("Render batch was assigned the wrong model"));
+		result.AssertTrue(materials, ERR("Render batch was assigned the wrong material"));
+		result.AssertTrue(ranges, ERR("Render batch does not cover the expected instance range"));
+		result.AssertTrue(shadow_casters, ERR("Incorrect shadow caster count for render batch"));
+	}
+
+	// Each shader should cover a contiguous range of batches, and unused shaders should be empty
+	result.AssertTrue(queue.GetShaderQueue(0U).BatchStart == 0U && queue.GetShaderQueue(0U).BatchEnd == 4U, ERR("Incorrect batch range for shader 0"));
+	result.AssertTrue(queue.GetShaderQueue(1U).BatchStart == 4U && queue.GetShaderQueue(1U).BatchEnd == 5U, ERR("Incorrect batch range for shader 1"));
+	result.AssertTrue(queue.GetShaderQueue(2U).Empty(), ERR("Batches were assigned to a shader with no instances"));
+
+	// Clearing the queue should remove all batches and release the render slot assigned to each model
+	queue.Clear();
+	result.AssertEqual(queue.GetBatchCount(), (size_t)0U, ERR("Render batches remain after clearing queue"));
+	result.AssertTrue(queue.GetShaderQueue(0U).Empty() && queue.GetShaderQueue(1U).Empty(), ERR("Shader batch ranges remain after clearing queue"));
+	result.AssertTrue(!a.HasAssignedRenderSlot(0U) && !a.HasAssignedRenderSlot(1U) && !b.HasAssignedRenderSlot(0U), ERR("Model render slots were not released on clearing queue"));
+
+	return result;
+}
+
+TestResult RenderQueueTests::InstanceCoverageTests()
+{
+	TestResult result = NewResult();
+	const size_t shader_count = 3U;
+	const size_t instance_count = 1000U;
+	RenderQueue queue;
+	InitialiseTestQueue(queue, shader_count);
+
+	std::vector<ModelBuffer> models(4U);
+	std::vector<MaterialDX11> materials(3U);
+
+	// Submit instances with random parameters and unique depths, preparing the queue part-way through submission to ensure that
+	// later submissions are merged correctly with those already sorted
+	std::mt19937 rng(12345U);
+	std::vector<size_t> submitted_shader;
+	std::vector<const ModelBuffer*> submitted_model;
+	std::vector<const MaterialDX11*> submitted_material;
+	for (size_t i = 0U; i < instance_count; ++i)
+	{
+		if (i == (instance_count / 2U)) queue.Prepare();
+
+		size_t shader = (rng() % shader_count);
+		ModelBuffer *model = &(models[rng() % models.size()]);
+		const MaterialDX11 *material = &(materials[rng() % materials.size()]);
+
+		submitted_shader.push_back(shader);
+		submitted_model.push_back(model);
+		submitted_material.push_back(material);
+		SubmitTestInstance(queue, shader, model, material, (unsigned int)(instance_count - i), ((rng() % 2U) == 0U));
+	}
+	queue.Prepare();
+	result.AssertEqual(queue.GetInstanceCount(), instance_count, ERR("Incorrect number of instances in render queue"));
+
+	// Batches should be contiguous and non-empty, and every instance should appear in exactly one batch with the model, material
+	// and shader it was submitted with
+	std::vector<unsigned int> occurrences(instance_count, 0U);
+	bool contiguous = true, non_empty = true, valid_depth = true, consistent = true, key_order = true, shadow_casters = true;
+	size_t next = 0U;
+	for (size_t b = 0U; b < queue.GetBatchCount(); ++b)
+	{
+		const RM_RenderBatch & batch = queue.GetBatch(b);
+		if (batch.InstanceStart != next) contiguous = false;
+		if (batch.InstanceCount == 0U) non_empty = false;
+
+		size_t shader = (size_t)(queue.GetInstanceSortKey(batch.InstanceStart) >> RenderQueue::KEY_SHADER_SHIFT);
+		if (b < queue.GetShaderQueue(shader).BatchStart || b >= queue.GetShaderQueue(shader).BatchEnd) consistent = false;
+
+		size_t casters = 0U;
+		for (size_t i = batch.InstanceStart; i < batch.InstanceStart + batch.InstanceCount && i < instance_count; ++i)
+		{
+			if (i != 0U && queue.GetInstanceSortKey(i) < queue.GetInstanceSortKey(i - 1U)) key_order = false;
+			if (CheckBit_Single(queue.GetInstance(i).Flags, InstanceFlags::INSTANCE_FLAG_SHADOW_CASTER)) ++casters;
+
+			unsigned int depth = DetermineInstanceDepth(queue.GetInstance(i));
+			if (depth == 0U || depth > instance_count) { valid_depth = false; continue; }
+
+			size_t index = (instance_count - depth);
+			++occurrences[index];
+			if (submitted_shader[index] != shader || submitted_model[index] != batch.Model || submitted_material[index] != batch.Material) consistent = false;
+		}
+		if (casters != batch.ShadowCasterCount) shadow_casters = false;
+
+		next = (batch.InstanceStart + batch.InstanceCount);
+	}
+
+	size_t missing = 0U, duplicated = 0U;
+	for (unsigned int n : occurrences)
+	{
+		if (n == 0U) ++missing;
+		else if (n > 1U) ++duplicated;
+	}
+
+	result.AssertTrue(contiguous, ERR("Render batches do not cover a contiguous range of instances"));
+	result.AssertTrue(non_empty, ERR("Empty render batch was generated"));
+	result.AssertEqual(next, instance_count, ERR("Render batches do not cover all instances"));
+	result.AssertTrue(valid_depth, ERR("Sorted instance does not correspond to any submitted instance"));
+	result.AssertEqual(missing, (size_t)0U, ERR("Submitted instances are missing from all render batches"));
+	result.AssertEqual(duplicated, (size_t)0U, ERR("Submitted instances appear in more than one render batch"));
+	result.AssertTrue(consistent, ERR("Instance was batched with a different shader, model or material than it was submitted with"));
+	result.AssertTrue(key_order, ERR("Sort keys are not in ascending order"));
+	result.AssertTrue(shadow_casters, ERR("Incorrect shadow caster count for render batch"));
+
+	// Shader batch ranges should partition the full set of batches, in shader order
+	size_t shader_next = 0U;
+	for (size_t s = 0U; s < shader_count; ++s)
+	{
+		const RM_ShaderQueue & shader = queue.GetShaderQueue(s);
+		if (shader.Empty()) continue;
+
+		result.AssertEqual(shader.BatchStart, shader_next, ERR("Shader batch ranges are not contiguous"));
+		shader_next = shader.BatchEnd;
+	}
+	result.AssertEqual(shader_next, queue.GetBatchCount(), ERR("Shader batch ranges do not cover all batches"));
+
+	queue.Clear();
+	return result;
+}
+
+void RenderQueueTests::InitialiseTestQueue(RenderQueue & queue, size_t shader_count)
+{
+	queue.Initialise(RM_ShaderCollection(shader_count));
+}
+
+void RenderQueueTests::SubmitTestInstance(RenderQueue & queue, size_t shader, ModelBuffer *model, const MaterialDX11 *material, unsigned int depth, bool shadow_caster)
+{
+	InstanceFlags::Type flags = (shadow_caster ? InstanceFlags::INSTANCE_FLAG_SHADOW_CASTER : InstanceFlags::DEFAULT_INSTANCE_FLAGS);
+	RM_SortKey sort_key = (static_cast<RM_SortKey>(depth) << RENDERQUEUE_TEST_DEPTH_SHIFT);
+
+	queue.Submit(shader, model, material, RM_Instance(XMFLOAT4X4(ID_MATRIX_F), sort_key, flags), RM_InstanceMetadata(NULL_VECTOR, 1.0f));
+}
+
+unsigned int RenderQueueTests::DetermineInstanceDepth(const RM_Instance & instance)
+{
+	return static_cast<unsigned int>(instance.SortKey >> RENDERQUEUE_TEST_DEPTH_SHIFT);
+}
+
+void RenderQueueTests::SubmitOrderingScenario(RenderQueue & queue, ModelBuffer *a, ModelBuffer *b, const MaterialDX11 *low, const MaterialDX11 *high)
+{
+	SubmitTestInstance(queue, 1U, a, low, 5U, true);
+	SubmitTestInstance(queue, 0U, b, high, 3U, true);
+	SubmitTestInstance(queue, 0U, a, high, 9U, true);
+	SubmitTestInstance(queue, 0U, b, low, 7U, false);
+	SubmitTestInstance(queue, 0U, b, high, 1U, false);
+	SubmitTestInstance(queue, 0U, a, high, 2U, false);
+	SubmitTestInstance(queue, 0U, a, low, 4U, false);
+}
+
+void RenderQueueTests::DetermineMaterialKeyOrder(const MaterialDX11 *m0, const MaterialDX11 *m1, const MaterialDX11 *& outLow, const MaterialDX11 *& outHigh)
+{
+	const unsigned int mask = ((1U << RenderQueue::KEY_MATERIAL_BITS) - 1U);
+	bool ordered = ((m0->GetID() & mask) < (m1->GetID() & mask));
+
+	outLow = (ordered ? m0 : m1);
+	outHigh = (ordered ? m1 : m0);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include "CompilerSettings.h"
+#include "TestBase.h"
+#include "RenderQueue.h"
+class ModelBuffer;
+class MaterialDX11;
+
+class RenderQueueTests : public TestBase
+{
+public:
+
+	CMPINLINE TestResult RunTests(void)
+	{
+		TestResult result = NewNamedResult(RenderQueueTests);
+
+		result += KeyOrderingTests();
+		result += BatchBoundaryTests();
+		result += InstanceCoverageTests();
+
+		return result;
+	}
+
+
+private:
+
+	TestResult KeyOrderingTests();
+	TestResult BatchBoundaryTests();
+	TestResult InstanceCoverageTests();
+
+	// Initialises the queue with the given number of default shader sections
+	void InitialiseTestQueue(RenderQueue & queue, size_t shader_count);
+
+	// Submits an instance to the queue.  The instance depth is stored in the bits of the instance sort key that are retained
+	// in the queue sort key, so that each instance can be identified by its depth once sorted
+	void SubmitTestInstance(RenderQueue & queue, size_t shader, ModelBuffer *model, const MaterialDX11 *material, unsigned int depth, bool shadow_caster);
+
+	// Returns the depth with which a sorted instance was submitted
+	unsigned int DetermineInstanceDepth(const RM_Instance & instance);
+
+	// Submits a fixed scenario in which the submission order differs from the expected order in every component of the sort key.
+	// Model 'b' is the first submitted for shader 0 and so is assigned the lower render slot.  'low' must be the material with
+	// the lower material component in the sort key
+	void SubmitOrderingScenario(RenderQueue & queue, ModelBuffer *a, ModelBuffer *b, const MaterialDX11 *low, const MaterialDX11 *high);
+
+	// Returns the two materials in order of their material component within the sort key
+	void DetermineMaterialKeyOrder(const MaterialDX11 *m0, const MaterialDX11 *m1, const MaterialDX11 *& outLow, const MaterialDX11 *& outHigh);
+
+};
@@ -3,7 +3,7 @@
 #include "CompilerSettings.h"
 #include "Utility.h"
 #include "ShaderFlags.h"
-#include "RM_ModelDataCollection.h"
+#include "RM_ShaderQueue.h"
 
 
 class ShaderRenderPredicate
@@ -14,21 +14,21 @@ public:
 	class RenderAll
 	{
 	public:
-		CMPINLINE const bool operator()(const RM_ModelDataCollection & shader) const { return true; }
+		CMPINLINE const bool operator()(const RM_ShaderQueue & shader) const { return true; }
 	};
 
 	/* Renders only geometry; i.e. all input to the primary engine render process */
 	class RenderGeometry
 	{
 	public:
-		CMPINLINE const bool operator()(const RM_ModelDataCollection & shader) const { return CheckBit_Any(shader.Flags, static_cast<ShaderFlags>(ShaderFlag::ShaderTypeGeometry)); }
+		CMPINLINE const bool operator()(const RM_ShaderQueue & shader) const { return CheckBit_Any(shader.Flags, static_cast<ShaderFlags>(ShaderFlag::ShaderTypeGeometry)); }
 	};
 
 	/* Renders only UI and other orthographic/textured quad data */
 	class RenderUI
 	{
 	public:
-		CMPINLINE const bool operator()(const RM_ModelDataCollection & shader) const { return CheckBit_Any(shader.Flags, static_cast<ShaderFlags>(ShaderFlag::ShaderTypeUI)); }
+		CMPINLINE const bool operator()(const RM_ShaderQueue & shader) const { return CheckBit_Any(shader.Flags, static_cast<ShaderFlags>(ShaderFlag::ShaderTypeUI)); }
 	};
 
 
@@ -36,7 +36,7 @@ public:
 	class RenderVolumetricLine
 	{
 	public:
-		CMPINLINE const bool operator()(const RM_ModelDataCollection & shader) const { return CheckBit_Any(shader.Flags, static_cast<ShaderFlags>(ShaderFlag::ShaderTypeVolumetricLine)); }
+		CMPINLINE const bool operator()(const RM_ShaderQueue & shader) const { return CheckBit_Any(shader.Flags, static_cast<ShaderFlags>(ShaderFlag::ShaderTypeVolumetricLine)); }
 	};
 
 };
\ No newline at end of file
@@ -2,9 +2,6 @@
 #include "CoreEngine.h"
 #include "RenderProcessDX11.h"
 #include "RenderQueue.h"
-#include "RM_ModelDataCollection.h"
-#include "RM_MaterialInstanceMapping.h"
-#include "RM_InstanceData.h"
 #include "InstanceFlags.h"
 #include "Light.h"
 #include "CameraView.h"
@@ -459,75 +456,60 @@ void ShadowManagerComponent::ExecuteLightSpaceRenderPass(unsigned int light_inde
 	ActivateLightSpaceShadowmapPipeline(light);
 	++m_active_shadow_map_count;
 
-	// For each shader
-	for (auto i = 0; i < RenderQueueShader::RM_RENDERQUEUESHADERCOUNT; ++i)
+	// For each batch of { shader, model, material } instances in the render queue
+	size_t batchcount = renderqueue.GetBatchCount();
+	for (size_t b = 0U; b < batchcount; ++b)
 	{
-		const auto & shadermodels = renderqueue[i];
-		size_t shadermodelcount = shadermodels.CurrentSlotCount;
+		const RM_RenderBatch & batch = renderqueue.GetBatch(b);
 
-		// For each model being rendered by the shader
-		for (size_t modelix = 0U; modelix < shadermodelcount; ++modelix)
-		{
-			const auto & modeldata = shadermodels.ModelData[modelix];
-			size_t materialcount = modeldata.CurrentMaterialCount;
-
-			// For each material variation of this model
-			for (size_t matix = 0; matix < materialcount; ++matix)
-			{
-				const auto & matdata = modeldata.Data[matix];
-
-				// Skip if none of the instances are shadow-casters (or tf also if there are no instances)
-				size_t shadowercount = matdata.InstanceCollection.ShadowCasterCount;
-				if (shadowercount == 0U) continue;
-				size_t instancecount = matdata.InstanceCollection.CurrentInstanceCount;
-
-				// Debug assertion
-				assert(instancecount < 2048U);
-				assert(shadowercount < 2048U);
-				assert(shadowercount <= instancecount);
-
-				// Make sure there is enough space to hold all potential shadow-casters
-				if (shadowercount > m_instance_capacity)
-				{
-					int required = static_cast<int>(shadowercount - m_instance_capacity);
-					assert(required < 2048U);
+		// Skip if none of the instances are shadow-casters (or tf also if there are no instances)
+		size_t shadowercount = batch.ShadowCasterCount;
+		if (shadowercount == 0U) continue;
+		size_t instancecount = batch.InstanceCount;
 
-					for (int i = 0; i < required; ++i) m_instances.push_back(std::move(RM_Instance()));
-					m_instance_capacity = shadowercount;
-				}
+		// Debug assertion
+		assert(instancecount < 2048U);
+		assert(shadowercount < 2048U);
+		assert(shadowercount <= instancecount);
 
-				// Collect the set of shadow-casters to be rendered, based on shadow caster state and light details
-				size_t rendercount = 0U;
-				const RM_Instance *instances = &(m_instances[0]);
+		// Make sure there is enough space to hold all potential shadow-casters
+		if (shadowercount > m_instance_capacity)
+		{
+			size_t required = (shadowercount - m_instance_capacity);
+			for (size_t i = 0U; i < required; ++i) m_instances.push_back(std::move(RM_Instance()));
+			m_instance_capacity = shadowercount;
+		}
 
-				// Optimisation: if this is a directional light, and all instances are shadow-casters, we can use the actual instance vector directly
-				if (directional_light && shadowercount == instancecount)
-				{
-					rendercount = shadowercount;
-					instances = &(matdata.InstanceCollection.InstanceData[0]);
-				}
-				else
-				{
-					// Otherwise, we need to check each instance in turn
-					for (size_t ix = 0U; ix < instancecount; ++ix)
-					{
-						const auto & inst = matdata.InstanceCollection.InstanceData[ix];
-						
-						if (!CheckBit_Single(inst.Flags, InstanceFlags::INSTANCE_FLAG_SHADOW_CASTER)) continue;
-						if (!InstanceIntersectsLightFrustum(matdata.InstanceCollection.InstanceMetadata[ix], light)) continue;
+		// Collect the set of shadow-casters to be rendered, based on shadow caster state and light details
+		size_t rendercount = 0U;
+		const RM_Instance *instances = &(m_instances[0]);
 
-						m_instances[rendercount] = RM_Instance(inst);
-						++rendercount;
-					}
-				}
+		// Optimisation: if this is a directional light, and all instances are shadow-casters, we can use the sorted instance data directly
+		if (directional_light && shadowercount == instancecount)
+		{
+			rendercount = shadowercount;
+			instances = &(renderqueue.GetInstance(batch.InstanceStart));
+		}
+		else
+		{
+			// Otherwise, we need to check each instance in turn
+			for (size_t ix = batch.InstanceStart; ix < (batch.InstanceStart + instancecount); ++ix)
+			{
+				const auto & inst = renderqueue.GetInstance(ix);
 
-				// Make sure we have some renderable instances
-				if (rendercount == 0U) continue;
+				if (!CheckBit_Single(inst.Flags, InstanceFlags::INSTANCE_FLAG_SHADOW_CASTER)) continue;
+				if (!InstanceIntersectsLightFrustum(renderqueue.GetInstanceMetadata(ix), light)) continue;
 
-				// Submit the instances for rendering
-				Game::Engine->RenderInstanced(*m_pipeline_lightspace_shadowmap, *modeldata.ModelBufferInstance, matdata.Material, *instances, static_cast<UINT>(rendercount));
+				m_instances[rendercount] = RM_Instance(inst);
+				++rendercount;
 			}
 		}
+
+		// Make sure we have some renderable instances
+		if (rendercount == 0U) continue;
+
+		// Submit the instances for rendering
+		Game::Engine->RenderInstanced(*m_pipeline_lightspace_shadowmap, *batch.Model, batch.Material, *instances, static_cast<UINT>(rendercount));
 	}
 
 	// Perform a resource copy of this shadow map data if we have the debug capture enabled
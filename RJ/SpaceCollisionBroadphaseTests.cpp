@@ -0,0 +1,132 @@
+#include <algorithm>
+#include "GameVarsExtern.h"
+#include "GameObjects.h"
+#include "SimpleShip.h"
+
+#include "SpaceCollisionBroadphaseTests.h"
+
+
+// Size of the spatial partitioning tree containing the test objects, which is centred on the origin
+static const float BROADPHASE_TEST_TREE_SIZE = 2000.0f;
+
+// Radius of the collision scope about the focal object, and the collision radius of every test object
+static const float BROADPHASE_TEST_SCOPE = 200.0f;
+static const float BROADPHASE_TEST_RADIUS = 10.0f;
+
+// Time factor for the simulated frame, and the momentum of every test object.  Objects must be moving, since pairs of
+// static objects are excluded from the broadphase
+static const float BROADPHASE_TEST_FRAME_TIME = 0.1f;
+static const XMFLOAT3 BROADPHASE_TEST_MOMENTUM = XMFLOAT3(1.0f, 0.0f, 0.0f);
+
+
+TestResult SpaceCollisionBroadphaseTests::ScopeBoundaryEquivalenceTests()
+{
+	TestResult result = NewResult();
+	float timefactor = Game::TimeFactor;
+	XMVECTOR timefactorv = Game::TimeFactorV;
+
+	Game::TimeFactor = BROADPHASE_TEST_FRAME_TIME;
+	Game::TimeFactorV = XMVectorReplicate(BROADPHASE_TEST_FRAME_TIME);
+
+	Octree<iObject*> sp_tree(XMVectorReplicate(BROADPHASE_TEST_TREE_SIZE * -0.5f), BROADPHASE_TEST_TREE_SIZE);
+	std::vector<SimpleShip*> objects;
+
+	// Objects are in scope if their collision sphere is within the scope radius, extended by the focal object radius.  Objects
+	// at 205 units are therefore in scope, and those at 220 units are not.  Object IDs are assigned in order of creation
+	const float r = BROADPHASE_TEST_RADIUS;
+	SimpleShip *focal = AddTestObject(sp_tree, objects, XMFLOAT3(0.0f, 0.0f, 0.0f), Game::ColliderType::ActiveCollider);
+
+	// An active collider outside the scope overlaps one inside, and has the lower ID.  It will not test for collisions itself
+	SimpleShip *outside_active = AddTestObject(sp_tree, objects, XMFLOAT3(-(BROADPHASE_TEST_SCOPE + 2.0f * r), 0.0f, 0.0f), Game::ColliderType::ActiveCollider);
+	SimpleShip *edge_active_0 = AddTestObject(sp_tree, objects, XMFLOAT3(-(BROADPHASE_TEST_SCOPE + 0.5f * r), 0.0f, 0.0f), Game::ColliderType::ActiveCollider);
+
+	// A passive collider outside the scope overlaps an active collider inside it
+	SimpleShip *edge_active_1 = AddTestObject(sp_tree, objects, XMFLOAT3(BROADPHASE_TEST_SCOPE + 0.5f * r, 0.0f, 0.0f), Game::ColliderType::ActiveCollider);
+	SimpleShip *outside_passive = AddTestObject(sp_tree, objects, XMFLOAT3(BROADPHASE_TEST_SCOPE + 2.0f * r, 0.0f, 0.0f), Game::ColliderType::PassiveCollider);
+
+	// Overlapping pairs well within the scope
+	AddTestObject(sp_tree, objects, XMFLOAT3(0.0f, 50.0f, 0.0f), Game::ColliderType::PassiveCollider);
+	AddTestObject(sp_tree, objects, XMFLOAT3(0.0f, 50.0f + 1.5f * r, 0.0f), Game::ColliderType::ActiveCollider);
+	AddTestObject(sp_tree, objects, XMFLOAT3(0.0f, -50.0f, 0.0f), Game::ColliderType::ActiveCollider);
+	AddTestObject(sp_tree, objects, XMFLOAT3(0.0f, -50.0f - 1.5f * r, 0.0f), Game::ColliderType::ActiveCollider);
+
+	// An overlapping pair outside the scope, but within the widened search performed by the sweep-and-prune broadphase, which
+	// should not be tested by either method.  Also an isolated object within the scope, which should not be part of any pair
+	AddTestObject(sp_tree, objects, XMFLOAT3(0.0f, 0.0f, BROADPHASE_TEST_SCOPE + 4.0f * r), Game::ColliderType::ActiveCollider);
+	AddTestObject(sp_tree, objects, XMFLOAT3(0.0f, 0.0f, BROADPHASE_TEST_SCOPE + 5.0f * r), Game::ColliderType::ActiveCollider);
+	AddTestObject(sp_tree, objects, XMFLOAT3(0.0f, 0.0f, 100.0f), Game::ColliderType::ActiveCollider);
+
+	GamePhysicsEngine::BroadphasePairRecord octree_pairs, sap_pairs;
+	RunBroadphase(GamePhysicsEngine::BroadphaseMode::OctreeSearch, focal, objects, octree_pairs);
+	RunBroadphase(GamePhysicsEngine::BroadphaseMode::SweepAndPrune, focal, objects, sap_pairs);
+
+	result.AssertEqual(octree_pairs.size(), (size_t)4U, ERR("Incorrect number of pairs passing the octree search broadphase"));
+	result.AssertTrue(std::adjacent_find(octree_pairs.begin(), octree_pairs.end()) == octree_pairs.end(), ERR("Octree search broadphase tested a pair more than once"));
+	result.AssertTrue(std::adjacent_find(sap_pairs.begin(), sap_pairs.end()) == sap_pairs.end(), ERR("Sweep-and-prune broadphase tested a pair more than once"));
+	result.AssertTrue(sap_pairs == octree_pairs, ERR("Sweep-and-prune and octree search broadphase methods emitted different pairs"));
+
+	// Pairs which straddle the scope boundary must be tested from the side of the object in scope
+	std::pair<Game::ID_TYPE, Game::ID_TYPE> active_pair(edge_active_0->GetID(), outside_active->GetID());
+	std::pair<Game::ID_TYPE, Game::ID_TYPE> passive_pair(edge_active_1->GetID(), outside_passive->GetID());
+	result.AssertTrue(std::binary_search(octree_pairs.begin(), octree_pairs.end(), active_pair), ERR("Octree search broadphase missed an active collider outside the scope"));
+	result.AssertTrue(std::binary_search(octree_pairs.begin(), octree_pairs.end(), passive_pair), ERR("Octree search broadphase missed a passive collider outside the scope"));
+	result.AssertTrue(std::binary_search(sap_pairs.begin(), sap_pairs.end(), active_pair), ERR("Sweep-and-prune broadphase missed an active collider outside the scope"));
+	result.AssertTrue(std::binary_search(sap_pairs.begin(), sap_pairs.end(), passive_pair), ERR("Sweep-and-prune broadphase missed a passive collider outside the scope"));
+
+	ReleaseTestObjects(objects);
+
+	Game::TimeFactor = timefactor;
+	Game::TimeFactorV = timefactorv;
+	return result;
+}
+
+SimpleShip * SpaceCollisionBroadphaseTests::AddTestObject(Octree<iObject*> & sp_tree, std::vector<SimpleShip*> & objects, const XMFLOAT3 & position, Game::ColliderType type)
+{
+	SimpleShip *object = new SimpleShip();
+	object->SetSize(XMVectorReplicate(BROADPHASE_TEST_RADIUS));
+	object->SetCollisionSphereRadius(BROADPHASE_TEST_RADIUS);
+	object->SetCollisionMode(Game::CollisionMode::BroadphaseCollisionOnly);
+	object->SetColliderType(type);
+
+	object->SetPosition(position);
+	object->SetOrientation(ID_QUATERNION);
+	object->RefreshPositionImmediate();
+
+	// Candidates located by the octree search are resolved by object ID, so each object must be registered
+	object->SetSimulationState(iObject::ObjectSimulationState::FullSimulation);
+	sp_tree.AddItem(object, object->GetPosition());
+
+	objects.push_back(object);
+	return object;
+}
+
+void SpaceCollisionBroadphaseTests::ReleaseTestObjects(std::vector<SimpleShip*> & objects)
+{
+	for (SimpleShip *object : objects)
+	{
+		if (object->GetSpatialTreeNode()) object->GetSpatialTreeNode()->RemoveItem(object);
+		Game::UnregisterObject(object);
+	}
+
+	objects.clear();
+}
+
+void SpaceCollisionBroadphaseTests::RunBroadphase(GamePhysicsEngine::BroadphaseMode mode, SimpleShip *focal, const std::vector<SimpleShip*> & objects,
+												  GamePhysicsEngine::BroadphasePairRecord & outPairs)
+{
+	// Collision response from a previous run will have altered object momentum
+	for (SimpleShip *object : objects)
+	{
+		object->SetWorldMomentum(XMLoadFloat3(&BROADPHASE_TEST_MOMENTUM));
+	}
+
+	GamePhysicsEngine *engine = new GamePhysicsEngine();
+	engine->SetBroadphaseMode(mode);
+	engine->SetBroadphasePairRecord(&outPairs);
+
+	outPairs.clear();
+	engine->PerformSpaceCollisionDetection(focal, BROADPHASE_TEST_SCOPE);
+	std::sort(outPairs.begin(), outPairs.end());
+
+	delete engine;
+}
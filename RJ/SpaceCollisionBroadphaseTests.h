@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+#include "CompilerSettings.h"
+#include "TestBase.h"
+#include "Octree.h"
+#include "GamePhysicsEngine.h"
+class iObject;
+class SimpleShip;
+
+class SpaceCollisionBroadphaseTests : public TestBase
+{
+public:
+
+	CMPINLINE TestResult RunTests(void)
+	{
+		TestResult result = NewNamedResult(SpaceCollisionBroadphaseTests);
+
+		result += ScopeBoundaryEquivalenceTests();
+
+		return result;
+	}
+
+
+private:
+
+	TestResult ScopeBoundaryEquivalenceTests();
+
+	// Creates a registered test object of uniform collision radius at the given position, and adds it to the spatial partitioning tree
+	SimpleShip * AddTestObject(Octree<iObject*> & sp_tree, std::vector<SimpleShip*> & objects, const XMFLOAT3 & position, Game::ColliderType type);
+
+	// Removes all test objects from their spatial partitioning tree and unregisters them, which also deallocates each object
+	void ReleaseTestObjects(std::vector<SimpleShip*> & objects);
+
+	// Runs a single cycle of space collision detection about the focal object using the given broadphase method.  Returns every pair
+	// which passed the broadphase, with the primary object first, in sorted order
+	void RunBroadphase(GamePhysicsEngine::BroadphaseMode mode, SimpleShip *focal, const std::vector<SimpleShip*> & objects,
+					   GamePhysicsEngine::BroadphasePairRecord & outPairs);
+
+};
@@ -29,8 +29,8 @@ void SpaceEmitter::InitialiseCopiedObject(SpaceEmitter *source)
 void SpaceEmitter::Shutdown(void)
 {
 	// Shut down the associated particle emitter within the game engine
-	if (m_emitter && m_emittercode != NullString) 
-		Game::Engine->GetParticleEngine()->ShutdownParticleEmitter(m_emittercode);
+	if (m_emitter) 
+		Game::Engine->GetParticleEngine()->ShutdownParticleEmitter(m_emitterhandle);
 
 	// Pass control back to the base class
 	iSpaceObject::Shutdown();
@@ -48,11 +48,12 @@ SpaceEmitter::SpaceEmitter(void)
 void SpaceEmitter::SetEmitter(ParticleEmitter *emitter)
 { 
 	// Parameter check; if NULL is provided then we want to remove the emitter entirely
-	if (!emitter) { m_emitter = NULL; m_emittercode = ""; return; }
+	if (!emitter) { m_emitter = NULL; m_emittercode = ""; m_emitterhandle = ParticleEmitterHandle(); return; }
 
-	// Store the emitter, and also the unique code of the emitter for later deallocation
+	// Store the emitter, and also the code and handle of the emitter for later deallocation
 	m_emitter = emitter; 
 	m_emittercode = emitter->GetCode();
+	m_emitterhandle = emitter->GetHandle();
 
 	// Set an object code based on the underlying emitter definition
 	SetCode(concat("SpaceEmitter-")(m_emittercode).str());
@@ -59,6 +59,7 @@ public:
 private:
 	ParticleEmitter*				m_emitter;					// The particle emitter encapsulated by this space object
 	std::string						m_emittercode;				// String code of the emitter assigned to this object
+	ParticleEmitterHandle			m_emitterhandle;			// Handle to the emitter within the particle engine
 
 
 };
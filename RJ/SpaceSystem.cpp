@@ -10,6 +10,9 @@
 #include "LightSource.h"
 #include "CoreEngine.h"
 #include "TextureDX11.h"
+#include "GameObjects.h"
+#include "iSpaceObjectEnvironment.h"
+#include "WorkerThreadPool.h"
 
 #include "SpaceSystem.h"
 
@@ -217,6 +220,50 @@ void SpaceSystem::RemoveFromObjectCollection(iObject *object)
 }
 
 
+// Simulates the interior of every queued environment concurrently across the worker thread pool
+void SpaceSystem::SimulateQueuedEnvironments(void)
+{
+	m_batch_environments.clear();
+	m_batch_ids.clear();
+	if (m_queued_environments.empty()) return;
+
+	// Resolve each queued environment, skipping any which have been destroyed since they were queued
+	std::vector<Game::ID_TYPE>::const_iterator it_end = m_queued_environments.end();
+	for (std::vector<Game::ID_TYPE>::const_iterator it = m_queued_environments.begin(); it != it_end; ++it)
+	{
+		iObject *object = Game::GetObjectByID(*it);
+		if (object && object->IsEnvironment())
+		{
+			m_batch_environments.push_back((iSpaceObjectEnvironment*)object);
+			m_batch_ids.push_back(*it);
+		}
+	}
+	m_queued_environments.clear();
+
+	int count = (int)m_batch_environments.size();
+	if (count == 0) return;
+	if ((int)m_batch_effects.size() < count) m_batch_effects.resize(count);
+
+	// Simulate each environment interior in parallel.  Each environment only modifies its own state, and defers any effect 
+	// on external objects into its own buffer, so no synchronisation is required between environments
+	Game::WorkerThreads.ParallelFor(count, 1, [this](int begin, int end)
+	{
+		for (int i = begin; i < end; ++i)
+		{
+			m_batch_environments[i]->SimulateInterior(&(m_batch_effects[i]));
+		}
+	});
+
+	// All environments have completed.  Apply the deferred effects serially, in queue order, so that results are deterministic
+	// regardless of the order in which environments were simulated.  An earlier effect may destroy a later environment, in 
+	// which case the effects of that environment are discarded
+	for (int i = 0; i < count; ++i)
+	{
+		if (Game::ObjectExists(m_batch_ids[i]))		m_batch_effects[i].Execute();
+		else										m_batch_effects[i].Clear();
+	}
+}
+
 // Set the size of the system.  Cannot be changed post-initialisation.
 void SpaceSystem::SetSize(const FXMVECTOR size)
 {
@@ -13,7 +13,9 @@
 #include "iSpaceObject.h"
 #include "BasicProjectileSet.h"
 #include "LightSource.h"
+#include "DeferredCommandBuffer.h"
 class TextureDX11;
+class iSpaceObjectEnvironment;
 
 
 // Class is 16-bit aligned to allow use of SIMD member variables
@@ -73,6 +75,16 @@ public:
 	// Methods to retrieve objects in the system
 	CMPINLINE std::vector<ObjectReference<iSpaceObject>> * 	GetObjects(void)					{ return &Objects; }
 
+	// Queues an environment for interior simulation in the batch executed at the end of the current simulation cycle
+	CMPINLINE void				QueueEnvironmentSimulation(Game::ID_TYPE environment_id)	{ m_queued_environments.push_back(environment_id); }
+
+	// Simulates the interior of every queued environment concurrently across the worker thread pool.  Once all environments
+	// have completed, any external effects they deferred are applied serially in the order the environments were queued
+	void						SimulateQueuedEnvironments(void);
+
+	// Returns the number of environments simulated in the most recent batch
+	CMPINLINE size_t			GetLastEnvironmentBatchSize(void) const		{ return m_batch_environments.size(); }
+
 	// Methods to get or change the system backdrop texture
 	CMPINLINE std::string					GetBackdropLocation(void) { return m_backdroplocation; }
 	CMPINLINE void							SetBackdropLocation(std::string loc) { m_backdroplocation = loc; }
@@ -105,6 +117,13 @@ protected:
 	// Set of directional lights in this system
 	std::vector<ObjectReference<LightSource>> 	m_directional_lights;
 
+	// Environments queued for interior simulation in the current cycle.  Held by ID since objects may be destroyed before
+	// the batch is executed.  The batch collections retain their storage between cycles
+	std::vector<Game::ID_TYPE>					m_queued_environments;
+	std::vector<iSpaceObjectEnvironment*>		m_batch_environments;
+	std::vector<Game::ID_TYPE>					m_batch_ids;
+	std::vector<DeferredCommandBuffer>			m_batch_effects;
+
 	// Inserts an object into the system object collection, assuming it exists in Game::Objects and is not already in our collection
 	void						InsertIntoObjectCollection(iObject *object);
 
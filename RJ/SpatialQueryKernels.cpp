@@ -0,0 +1,204 @@
+#include <vector>
+#include <algorithm>
+#include "Utility.h"
+#include "FastMath.h"
+#include "Logging.h"
+#include "Timers.h"
+
+#include "SpatialQueryKernels.h"
+
+
+// Reserves space for the specified number of candidates
+void SpatialQueryKernels::CandidateSet::Reserve(size_t count)
+{
+	size_t padded = (count + BATCH_WIDTH);
+	X.reserve(padded); Y.reserve(padded); Z.reserve(padded); RadiusSq.reserve(padded);
+	IDs.reserve(count);
+}
+
+// Pads each position stream to a multiple of BATCH_WIDTH.  Must be called after all candidates have been added
+void SpatialQueryKernels::CandidateSet::Finalise(void)
+{
+	size_t padded = ((IDs.size() + (BATCH_WIDTH - 1U)) & ~(BATCH_WIDTH - 1U));
+	X.resize(padded, 0.0f); Y.resize(padded, 0.0f); Z.resize(padded, 0.0f); RadiusSq.resize(padded, 0.0f);
+}
+
+// Emits the ID of each candidate in the given batch whose lane is set in the comparison mask
+CMPINLINE int SpatialQueryKernels::EmitBatchResults(const FXMVECTOR mask, const Game::ID_TYPE *ids, size_t remaining, std::vector<Game::ID_TYPE> & outResult)
+{
+	// Collapse the comparison result to a bitmask, one bit per lane
+	int bits = GetLaneMask(mask);
+
+	// Mask out any padding lanes beyond the end of the real candidate data
+	if (remaining < BATCH_WIDTH) bits &= ((1 << remaining) - 1);
+	if (bits == 0) return 0;
+
+	int found = 0;
+	for (size_t lane = 0U; lane < BATCH_WIDTH; ++lane)
+	{
+		if (bits & (1 << lane)) { outResult.push_back(ids[lane]); ++found; }
+	}
+	return found;
+}
+
+// Tests every candidate against a sphere.  Returns number of passes
+int SpatialQueryKernels::SphereTest(const CandidateSet & candidates, const FXMVECTOR position, float search_distance,
+									bool include_radius, std::vector<Game::ID_TYPE> & outResult)
+{
+	size_t count = candidates.Count();
+	if (count == 0U) return 0;
+
+	// Replicate the query parameters across all lanes
+	XMVECTOR px = XMVectorSplatX(position);
+	XMVECTOR py = XMVectorSplatY(position);
+	XMVECTOR pz = XMVectorSplatZ(position);
+	XMVECTOR distsq = XMVectorReplicate(search_distance * search_distance);
+
+	const float *x = &(candidates.X[0]), *y = &(candidates.Y[0]), *z = &(candidates.Z[0]), *rsq = &(candidates.RadiusSq[0]);
+	const Game::ID_TYPE *ids = &(candidates.IDs[0]);
+
+	int found = 0;
+	XMVECTOR dx, dy, dz, d2, threshold;
+	for (size_t i = 0U; i < count; i += BATCH_WIDTH)
+	{
+		// Squared distance from the query position to each of the four candidates
+		dx = XMVectorSubtract(XMLoadFloat4((const XMFLOAT4*)&(x[i])), px);
+		dy = XMVectorSubtract(XMLoadFloat4((const XMFLOAT4*)&(y[i])), py);
+		dz = XMVectorSubtract(XMLoadFloat4((const XMFLOAT4*)&(z[i])), pz);
+		d2 = XMVectorMultiplyAdd(dx, dx, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dz, dz)));
+
+		// Compare against the search threshold, optionally expanded by each candidate's collision radius
+		threshold = (include_radius ? XMVectorAdd(distsq, XMLoadFloat4((const XMFLOAT4*)&(rsq[i]))) : distsq);
+		found += EmitBatchResults(XMVectorLessOrEqual(d2, threshold), &(ids[i]), (count - i), outResult);
+	}
+
+	return found;
+}
+
+// Tests every candidate sphere against an axis-aligned bounding box.  Returns number of passes
+int SpatialQueryKernels::AABBTest(const CandidateSet & candidates, const FXMVECTOR aabb_min, const FXMVECTOR aabb_max,
+								  std::vector<Game::ID_TYPE> & outResult)
+{
+	size_t count = candidates.Count();
+	if (count == 0U) return 0;
+
+	// Replicate the box bounds across all lanes
+	XMVECTOR minx = XMVectorSplatX(aabb_min), miny = XMVectorSplatY(aabb_min), minz = XMVectorSplatZ(aabb_min);
+	XMVECTOR maxx = XMVectorSplatX(aabb_max), maxy = XMVectorSplatY(aabb_max), maxz = XMVectorSplatZ(aabb_max);
+
+	const float *x = &(candidates.X[0]), *y = &(candidates.Y[0]), *z = &(candidates.Z[0]), *rsq = &(candidates.RadiusSq[0]);
+	const Game::ID_TYPE *ids = &(candidates.IDs[0]);
+
+	int found = 0;
+	XMVECTOR vx, vy, vz, dx, dy, dz, d2;
+	for (size_t i = 0U; i < count; i += BATCH_WIDTH)
+	{
+		vx = XMLoadFloat4((const XMFLOAT4*)&(x[i]));
+		vy = XMLoadFloat4((const XMFLOAT4*)&(y[i]));
+		vz = XMLoadFloat4((const XMFLOAT4*)&(z[i]));
+
+		// Distance from each sphere centre to the box along each axis; zero if the centre lies within the box extent
+		dx = XMVectorAdd(XMVectorMax(XMVectorSubtract(minx, vx), g_XMZero), XMVectorMax(XMVectorSubtract(vx, maxx), g_XMZero));
+		dy = XMVectorAdd(XMVectorMax(XMVectorSubtract(miny, vy), g_XMZero), XMVectorMax(XMVectorSubtract(vy, maxy), g_XMZero));
+		dz = XMVectorAdd(XMVectorMax(XMVectorSubtract(minz, vz), g_XMZero), XMVectorMax(XMVectorSubtract(vz, maxz), g_XMZero));
+		d2 = XMVectorMultiplyAdd(dx, dx, XMVectorMultiplyAdd(dy, dy, XMVectorMultiply(dz, dz)));
+
+		// The sphere intersects the box if the squared distance to the box is within its squared radius
+		found += EmitBatchResults(XMVectorLessOrEqual(d2, XMLoadFloat4((const XMFLOAT4*)&(rsq[i]))), &(ids[i]), (count - i), outResult);
+	}
+
+	return found;
+}
+
+// Scalar reference implementation of SphereTest, used for validation and benchmarking
+int SpatialQueryKernels::SphereTestScalar(const CandidateSet & candidates, const FXMVECTOR position, float search_distance,
+										  bool include_radius, std::vector<Game::ID_TYPE> & outResult)
+{
+	XMFLOAT3 pos; XMStoreFloat3(&pos, position);
+	float distsq = (search_distance * search_distance);
+
+	int found = 0;
+	size_t count = candidates.Count();
+	for (size_t i = 0U; i < count; ++i)
+	{
+		float dx = (candidates.X[i] - pos.x), dy = (candidates.Y[i] - pos.y), dz = (candidates.Z[i] - pos.z);
+		float threshold = (include_radius ? (distsq + candidates.RadiusSq[i]) : distsq);
+		if ((dx*dx + dy*dy + dz*dz) <= threshold)
+		{
+			outResult.push_back(candidates.IDs[i]);
+			++found;
+		}
+	}
+
+	return found;
+}
+
+// Micro-benchmark comparing the scalar and SIMD sphere kernels across a range of candidate counts
+std::string SpatialQueryKernels::RunBenchmark(const std::vector<size_t> & candidate_counts, int queries_per_count)
+{
+	const float extent = 100000.0f;
+	const float search_distance = 10000.0f;
+	queries_per_count = max(queries_per_count, 1);
+
+	CandidateSet candidates;
+	std::vector<Game::ID_TYPE> result;
+	std::vector<XMFLOAT3> queries(queries_per_count);
+
+	std::ostringstream ss;
+	ss << "Object search kernel benchmark (" << queries_per_count << " queries per candidate count):\n";
+
+	for (size_t count : candidate_counts)
+	{
+		// Generate a uniform random distribution of candidates and query points
+		candidates.Clear();
+		candidates.Reserve(count);
+		for (size_t i = 0U; i < count; ++i)
+		{
+			float radius = frand_lh(1.0f, 500.0f);
+			candidates.Add((Game::ID_TYPE)i, XMFLOAT3(frand_lh(-extent, extent), frand_lh(-extent, extent), frand_lh(-extent, extent)), (radius * radius));
+		}
+		candidates.Finalise();
+		for (int q = 0; q < queries_per_count; ++q) queries[q] = XMFLOAT3(frand_lh(-extent, extent), frand_lh(-extent, extent), frand_lh(-extent, extent));
+		result.reserve(count);
+
+		// Scalar kernel
+		size_t scalar_found = 0U;
+		Timers::HRClockTime start = Timers::GetHRClockTime();
+		for (int q = 0; q < queries_per_count; ++q)
+		{
+			result.clear();
+			scalar_found += SphereTestScalar(candidates, XMLoadFloat3(&(queries[q])), search_distance, true, result);
+		}
+		Timers::HRClockDuration scalar_time = Timers::GetMillisecondDuration(start, Timers::GetHRClockTime());
+
+		// SIMD kernel
+		size_t simd_found = 0U;
+		start = Timers::GetHRClockTime();
+		for (int q = 0; q < queries_per_count; ++q)
+		{
+			result.clear();
+			simd_found += SphereTest(candidates, XMLoadFloat3(&(queries[q])), search_distance, true, result);
+		}
+		Timers::HRClockDuration simd_time = Timers::GetMillisecondDuration(start, Timers::GetHRClockTime());
+
+		// Verify that both kernels return the same set of IDs for every query
+		int mismatches = 0;
+		std::vector<Game::ID_TYPE> scalar_result;
+		for (int q = 0; q < queries_per_count; ++q)
+		{
+			scalar_result.clear(); result.clear();
+			SphereTestScalar(candidates, XMLoadFloat3(&(queries[q])), search_distance, true, scalar_result);
+			SphereTest(candidates, XMLoadFloat3(&(queries[q])), search_distance, true, result);
+			std::sort(scalar_result.begin(), scalar_result.end());
+			std::sort(result.begin(), result.end());
+			if (scalar_result != result) ++mismatches;
+		}
+
+		ss << "  " << count << " candidates: scalar=" << scalar_time << "ms, simd=" << simd_time << "ms, speedup="
+		   << (simd_time > 0.0 ? (scalar_time / simd_time) : 0.0) << "x, results=" << simd_found 
+		   << (mismatches == 0 ? "" : concat(" [RESULT MISMATCH IN ")(mismatches)(" QUERIES]").str()) << "\n";
+	}
+
+	Game::Log << LOG_INFO << ss.str();
+	return ss.str();
+}
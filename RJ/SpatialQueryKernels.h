@@ -0,0 +1,96 @@
+#pragma once
+
+#ifndef __SpatialQueryKernelsH__
+#define __SpatialQueryKernelsH__
+
+#include <vector>
+#include <string>
+#include "CompilerSettings.h"
+#include "GameVarsExtern.h"
+#include "AlignedAllocator.h"
+#include "DX11_Core.h"
+
+// Batch proximity-test kernels operating on SoA candidate data.  Candidates are gathered once into contiguous
+// position / radius streams, and then tested four at a time using SIMD comparisons.  Kernels only ever emit the ID
+// of passing candidates and never dereference the underlying objects
+// Class has no special alignment requirements
+class SpatialQueryKernels
+{
+public:
+
+	// Number of candidates processed per SIMD iteration
+	static const size_t							BATCH_WIDTH = 4U;
+
+	// SoA candidate buffer.  Position streams are padded to a multiple of BATCH_WIDTH so that kernels can always load
+	// full batches without a scalar remainder loop; padding lanes are masked out of the results
+	// Class has no special alignment requirements
+	struct CandidateSet
+	{
+		typedef std::vector<float, AlignedAllocator<float, 16U>>		FloatStream;
+
+		FloatStream								X, Y, Z;
+		FloatStream								RadiusSq;
+		std::vector<Game::ID_TYPE>				IDs;
+
+		// Clears all candidate data, retaining allocated capacity
+		CMPINLINE void							Clear(void)					{ X.clear(); Y.clear(); Z.clear(); RadiusSq.clear(); IDs.clear(); }
+
+		// Reserves space for the specified number of candidates
+		void									Reserve(size_t count);
+
+		// Adds a new candidate to the set
+		CMPINLINE void							Add(Game::ID_TYPE id, const XMFLOAT3 & pos, float radiussq)
+		{
+			X.push_back(pos.x); Y.push_back(pos.y); Z.push_back(pos.z); RadiusSq.push_back(radiussq); IDs.push_back(id);
+		}
+
+		// Adds a new candidate to the set from individual position components
+		CMPINLINE void							Add(Game::ID_TYPE id, float x, float y, float z, float radiussq)
+		{
+			X.push_back(x); Y.push_back(y); Z.push_back(z); RadiusSq.push_back(radiussq); IDs.push_back(id);
+		}
+
+		// Returns the number of (real) candidates in the set
+		CMPINLINE size_t						Count(void) const			{ return IDs.size(); }
+
+		// Pads each position stream to a multiple of BATCH_WIDTH.  Must be called after all candidates have been added
+		void									Finalise(void);
+	};
+
+	// Tests every candidate against a sphere.  A candidate passes if (distsq <= (search_distsq + candidate_radiussq)),
+	// consistent with ObjectSearch; pass 'include_radius' = false to ignore candidate radii.  Returns number of passes
+	static int									SphereTest(const CandidateSet & candidates, const FXMVECTOR position, float search_distance,
+														   bool include_radius, std::vector<Game::ID_TYPE> & outResult);
+
+	// Tests every candidate sphere against an axis-aligned bounding box.  Returns number of passes
+	static int									AABBTest(const CandidateSet & candidates, const FXMVECTOR aabb_min, const FXMVECTOR aabb_max,
+														 std::vector<Game::ID_TYPE> & outResult);
+
+	// Scalar reference implementation of SphereTest, used for validation and benchmarking
+	static int									SphereTestScalar(const CandidateSet & candidates, const FXMVECTOR position, float search_distance,
+																 bool include_radius, std::vector<Game::ID_TYPE> & outResult);
+
+	// Collapses a SIMD comparison result to a bitmask, with one bit set for each lane that passed the comparison
+	CMPINLINE static int						GetLaneMask(const FXMVECTOR mask)
+	{
+#		if defined(_XM_SSE_INTRINSICS_)
+			return _mm_movemask_ps(mask);
+#		else
+			XMUINT4 lanes; XMStoreUInt4(&lanes, mask);
+			return ((lanes.x ? 1 : 0) | (lanes.y ? 2 : 0) | (lanes.z ? 4 : 0) | (lanes.w ? 8 : 0));
+#		endif
+	}
+
+	// Micro-benchmark comparing the scalar and SIMD sphere kernels across a range of candidate counts.  Returns a
+	// summary of the results, which is also written to the debug log
+	static std::string							RunBenchmark(const std::vector<size_t> & candidate_counts, int queries_per_count);
+
+protected:
+
+	// Emits the ID of each candidate in the given batch whose lane is set in the comparison mask
+	CMPINLINE static int						EmitBatchResults(const FXMVECTOR mask, const Game::ID_TYPE *ids, size_t remaining, std::vector<Game::ID_TYPE> & outResult);
+
+};
+
+
+#endif
@@ -0,0 +1,230 @@
+#include <vector>
+#include <algorithm>
+#include "Utility.h"
+#include "iObject.h"
+
+#include "SweepAndPruneBroadphase.h"
+
+// Initialise static fields
+const float SweepAndPruneBroadphase::FULL_SORT_THRESHOLD = 0.25f;
+
+
+// Default constructor
+SweepAndPruneBroadphase::SweepAndPruneBroadphase(void)
+	: m_updateid(0U), m_new_endpoints(0U)
+{
+}
+
+// Begins a new update cycle
+void SweepAndPruneBroadphase::BeginUpdate(void)
+{
+	++m_updateid;
+	m_new_endpoints = 0U;
+	m_stats = UpdateStatistics();
+}
+
+// Adds or refreshes the proxy for an object, using a box of the given half-extent about its position
+void SweepAndPruneBroadphase::UpdateObject(iObject *object, const FXMVECTOR position, float radius)
+{
+	if (!object) return;
+
+	XMFLOAT3 pos;
+	XMStoreFloat3(&pos, position);
+
+	// Locate the existing proxy for this object, or create a new one if required
+	Proxy *proxy;
+	Game::ID_TYPE id = object->GetID();
+	std::unordered_map<Game::ID_TYPE, uint32_t>::const_iterator it = m_index.find(id);
+	if (it != m_index.end())
+	{
+		proxy = &(m_proxies[it->second]);
+	}
+	else
+	{
+		uint32_t index = (uint32_t)m_proxies.size();
+		m_proxies.push_back(Proxy());
+		m_index[id] = index;
+
+		// New endpoints are appended and will be moved into position by the next sort
+		Endpoint ep;
+		ep.Value = 0.0f;
+		ep.Data = (index | ENDPOINT_MIN_FLAG);	m_endpoints.push_back(ep);
+		ep.Data = index;						m_endpoints.push_back(ep);
+		m_new_endpoints += 2U;
+		++m_stats.ProxiesAdded;
+
+		proxy = &(m_proxies[index]);
+		proxy->ID = id;
+	}
+
+	// Update the proxy bounds.  The object pointer is also refreshed since it is only guaranteed valid for this cycle
+	proxy->Object = object;
+	proxy->Min[0] = (pos.x - radius); proxy->Max[0] = (pos.x + radius);
+	proxy->Min[1] = (pos.y - radius); proxy->Max[1] = (pos.y + radius);
+	proxy->Min[2] = (pos.z - radius); proxy->Max[2] = (pos.z + radius);
+	proxy->UpdateID = m_updateid;
+}
+
+// Completes the update cycle; discards stale proxies, restores the endpoint ordering and performs the sweep
+void SweepAndPruneBroadphase::EndUpdate(void)
+{
+	// Remove any proxies that were not refreshed this cycle.  Their object pointers may no longer be valid
+	RemoveStaleProxies();
+
+	// Copy the latest proxy bounds into each endpoint
+	std::vector<Endpoint>::iterator it_end = m_endpoints.end();
+	for (std::vector<Endpoint>::iterator it = m_endpoints.begin(); it != it_end; ++it)
+	{
+		const Proxy & proxy = m_proxies[it->ProxyIndex()];
+		it->Value = (it->IsMin() ? proxy.Min[SWEEP_AXIS] : proxy.Max[SWEEP_AXIS]);
+	}
+
+	// Restore ordering of the endpoint list and then sweep to determine all overlapping pairs
+	SortEndpoints();
+	Sweep();
+
+	m_stats.ProxyCount = (int)m_proxies.size();
+	m_stats.PairsEmitted = (int)m_pairs.size();
+}
+
+// Removes all proxies that were not refreshed in the current update cycle
+void SweepAndPruneBroadphase::RemoveStaleProxies(void)
+{
+	// Build a remapping from old to new proxy indices, compacting the proxy list as we go
+	uint32_t count = (uint32_t)m_proxies.size();
+	uint32_t live = 0U;
+	m_remap.resize(count);
+	for (uint32_t i = 0U; i < count; ++i)
+	{
+		if (m_proxies[i].UpdateID == m_updateid)
+		{
+			m_remap[i] = live;
+			if (live != i) m_proxies[live] = m_proxies[i];
+			++live;
+		}
+		else
+		{
+			m_remap[i] = ENDPOINT_MIN_FLAG;
+			m_index.erase(m_proxies[i].ID);
+		}
+	}
+
+	// Nothing more to do if every proxy was refreshed
+	if (live == count) return;
+	m_stats.ProxiesRemoved = (int)(count - live);
+	m_proxies.resize(live);
+
+	// Remove endpoints belonging to stale proxies and remap the remainder.  This is order-preserving, so any
+	// existing ordering of the endpoint list is retained
+	size_t n = 0U, epcount = m_endpoints.size();
+	for (size_t i = 0U; i < epcount; ++i)
+	{
+		Endpoint ep = m_endpoints[i];
+		uint32_t index = m_remap[ep.ProxyIndex()];
+		if (index == ENDPOINT_MIN_FLAG) continue;
+
+		ep.Data = (index | (ep.Data & ENDPOINT_MIN_FLAG));
+		m_endpoints[n++] = ep;
+	}
+	m_endpoints.resize(n);
+
+	// Rebuild the ID index for any proxies which have moved
+	for (uint32_t i = 0U; i < live; ++i) m_index[m_proxies[i].ID] = i;
+
+	// New endpoints may have been removed in the process; the count is only used as a heuristic so clamp it
+	m_new_endpoints = min(m_new_endpoints, m_endpoints.size());
+}
+
+// Restores the ordering of the endpoint list following an update of endpoint values
+void SweepAndPruneBroadphase::SortEndpoints(void)
+{
+	size_t count = m_endpoints.size();
+	if (count < 2U) return;
+
+	// If a significant proportion of the list is new then the list is far from sorted, and a full sort will be cheaper
+	if ((float)m_new_endpoints > ((float)count * FULL_SORT_THRESHOLD))
+	{
+		std::sort(m_endpoints.begin(), m_endpoints.end());
+		m_stats.FullSort = true;
+		return;
+	}
+
+	// Otherwise, perform an insertion sort.  Objects typically move only a small distance each frame, so the
+	// number of swaps required is proportional to the number of endpoints that have passed each other
+	Endpoint *ep = &(m_endpoints[0]);
+	int swaps = 0;
+	for (size_t i = 1U; i < count; ++i)
+	{
+		Endpoint key = ep[i];
+		size_t j = i;
+		while (j > 0U && key < ep[j - 1U])
+		{
+			ep[j] = ep[j - 1U];
+			--j;
+		}
+
+		ep[j] = key;
+		swaps += (int)(i - j);
+	}
+
+	m_stats.EndpointSwaps = swaps;
+}
+
+// Sweeps the sorted endpoint list and emits every overlapping pair
+void SweepAndPruneBroadphase::Sweep(void)
+{
+	m_pairs.clear();
+	m_active.clear();
+
+	std::vector<Endpoint>::const_iterator it_end = m_endpoints.end();
+	for (std::vector<Endpoint>::const_iterator it = m_endpoints.begin(); it != it_end; ++it)
+	{
+		uint32_t index = it->ProxyIndex();
+		if (it->IsMin())
+		{
+			// This proxy overlaps every other open proxy on the sweep axis; test the remaining axes and
+			// emit a pair for each full overlap.  Each pair can only be emitted once, when the later of
+			// the two min endpoints is reached
+			const Proxy & proxy = m_proxies[index];
+			std::vector<uint32_t>::const_iterator a_end = m_active.end();
+			for (std::vector<uint32_t>::const_iterator a = m_active.begin(); a != a_end; ++a)
+			{
+				const Proxy & other = m_proxies[*a];
+				if (OverlapOnTestAxes(proxy, other))
+				{
+					m_pairs.push_back(CollisionPair(other.Object, proxy.Object));
+				}
+			}
+
+			m_active.push_back(index);
+		}
+		else
+		{
+			// Close the proxy by removing it from the active set
+			std::vector<uint32_t>::iterator a = std::find(m_active.begin(), m_active.end(), index);
+			if (a != m_active.end())
+			{
+				(*a) = m_active.back();
+				m_active.pop_back();
+			}
+		}
+	}
+}
+
+// Removes all proxies and endpoint data
+void SweepAndPruneBroadphase::Clear(void)
+{
+	m_proxies.clear();
+	m_endpoints.clear();
+	m_index.clear();
+	m_pairs.clear();
+	m_active.clear();
+	m_remap.clear();
+	m_new_endpoints = 0U;
+	m_stats = UpdateStatistics();
+}
+
+// Default destructor
+SweepAndPruneBroadphase::~SweepAndPruneBroadphase(void)
+{
+}
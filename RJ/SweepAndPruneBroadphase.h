@@ -0,0 +1,153 @@
+#pragma once
+
+#ifndef __SweepAndPruneBroadphaseH__
+#define __SweepAndPruneBroadphaseH__
+
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+#include "CompilerSettings.h"
+#include "GameVarsExtern.h"
+#include "DX11_Core.h"
+class iObject;
+
+
+// Persistent sort-and-sweep broadphase.  Each object in scope is represented by an axis-aligned box around its collision
+// sphere.  The min/max endpoints of every box along the sweep axis are retained between frames, so that the list is
+// already almost sorted each time it is updated and can be re-sorted by insertion sort in close to linear time.  The
+// sweep then emits each overlapping pair exactly once
+// Class has no special alignment requirements
+class SweepAndPruneBroadphase
+{
+public:
+
+	// A potentially-colliding pair emitted by the sweep.  Ordering of the two objects is not significant
+	// Class has no special alignment requirements
+	struct CollisionPair
+	{
+		iObject *								Object0;
+		iObject *								Object1;
+
+		CollisionPair(void) : Object0(NULL), Object1(NULL) { }
+		CollisionPair(iObject *obj0, iObject *obj1) : Object0(obj0), Object1(obj1) { }
+	};
+
+	// Statistics on the most recent update
+	// Class has no special alignment requirements
+	struct UpdateStatistics
+	{
+		int										ProxyCount;				// Number of proxies in the broadphase after the update
+		int										ProxiesAdded;			// Number of proxies added this update
+		int										ProxiesRemoved;			// Number of proxies removed this update, since they were not refreshed
+		int										EndpointSwaps;			// Number of endpoint swaps performed by the incremental sort
+		bool									FullSort;				// Indicates whether a full re-sort was required instead of the incremental sort
+		int										PairsEmitted;			// Number of overlapping pairs emitted by the sweep
+
+		UpdateStatistics(void) : ProxyCount(0), ProxiesAdded(0), ProxiesRemoved(0), EndpointSwaps(0), FullSort(false), PairsEmitted(0) { }
+	};
+
+	// Default constructor
+	SweepAndPruneBroadphase(void);
+
+	// Begins a new update cycle.  Every object that should remain in the broadphase must be refreshed via UpdateObject()
+	// before the following call to EndUpdate(); any proxy that is not refreshed will be discarded
+	void										BeginUpdate(void);
+
+	// Adds or refreshes the proxy for an object, using a box of the given half-extent about its position
+	void										UpdateObject(iObject *object, const FXMVECTOR position, float radius);
+
+	// Completes the update cycle; discards stale proxies, restores the endpoint ordering and performs the sweep.  The resulting
+	// set of overlapping pairs is then available via GetPairs()
+	void										EndUpdate(void);
+
+	// Returns the set of overlapping pairs determined during the last update
+	CMPINLINE const std::vector<CollisionPair> &	GetPairs(void) const					{ return m_pairs; }
+
+	// Returns statistics on the last update
+	CMPINLINE const UpdateStatistics &			GetStatistics(void) const				{ return m_stats; }
+
+	// Returns the number of proxies currently held in the broadphase
+	CMPINLINE size_t							GetProxyCount(void) const				{ return m_proxies.size(); }
+
+	// Removes all proxies and endpoint data
+	void										Clear(void);
+
+	// Default destructor
+	~SweepAndPruneBroadphase(void);
+
+protected:
+
+	// Proxy representing one object in the broadphase
+	// Class has no special alignment requirements
+	struct Proxy
+	{
+		iObject *								Object;
+		Game::ID_TYPE							ID;
+		float									Min[3];
+		float									Max[3];
+		uint32_t								UpdateID;				// Update cycle in which the proxy was last refreshed
+	};
+
+	// Single endpoint on the sweep axis.  Value is duplicated from the proxy so that the sort remains cache-friendly
+	// Class has no special alignment requirements
+	struct Endpoint
+	{
+		float									Value;
+		uint32_t								Data;					// Proxy index in the low 31 bits, (1 << 31) set for min endpoints
+
+		CMPINLINE uint32_t						ProxyIndex(void) const	{ return (Data & ~ENDPOINT_MIN_FLAG); }
+		CMPINLINE bool							IsMin(void) const		{ return ((Data & ENDPOINT_MIN_FLAG) != 0U); }
+
+		// Ordering of endpoints along the sweep axis.  Min endpoints sort before max endpoints at the same value, so that
+		// touching boxes are still reported as a potential pair
+		CMPINLINE bool							operator<(const Endpoint & other) const
+		{
+			return (Value < other.Value || (Value == other.Value && IsMin() && !other.IsMin()));
+		}
+	};
+
+	// Flag used to denote min endpoints
+	static const uint32_t						ENDPOINT_MIN_FLAG = (1U << 31);
+
+	// Axis used for the sweep, and the two remaining axes used for overlap rejection
+	static const int							SWEEP_AXIS = 0;
+	static const int							TEST_AXIS_0 = 1;
+	static const int							TEST_AXIS_1 = 2;
+
+	// If more than this proportion of endpoints are new in a single update then a full sort is cheaper than insertion
+	static const float							FULL_SORT_THRESHOLD;
+
+	// Removes all proxies that were not refreshed in the current update cycle
+	void										RemoveStaleProxies(void);
+
+	// Restores the ordering of the endpoint list following an update of endpoint values
+	void										SortEndpoints(void);
+
+	// Sweeps the sorted endpoint list and emits every overlapping pair
+	void										Sweep(void);
+
+	// Tests whether two proxies overlap on the non-sweep axes
+	CMPINLINE bool								OverlapOnTestAxes(const Proxy & p0, const Proxy & p1) const
+	{
+		return (p0.Min[TEST_AXIS_0] <= p1.Max[TEST_AXIS_0] && p1.Min[TEST_AXIS_0] <= p0.Max[TEST_AXIS_0] &&
+				p0.Min[TEST_AXIS_1] <= p1.Max[TEST_AXIS_1] && p1.Min[TEST_AXIS_1] <= p0.Max[TEST_AXIS_1]);
+	}
+
+protected:
+
+	std::vector<Proxy>							m_proxies;
+	std::vector<Endpoint>						m_endpoints;
+	std::unordered_map<Game::ID_TYPE, uint32_t>	m_index;				// Maps object ID to proxy index
+
+	uint32_t									m_updateid;
+	size_t										m_new_endpoints;		// Number of endpoints appended (unsorted) during this update
+
+	std::vector<CollisionPair>					m_pairs;
+	std::vector<uint32_t>						m_active;				// Working set of proxies open during the sweep
+	std::vector<uint32_t>						m_remap;				// Working buffer used when compacting the proxy list
+
+	UpdateStatistics							m_stats;
+};
+
+
+#endif
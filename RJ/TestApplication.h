@@ -9,6 +9,14 @@
 #include "SequenceGenerationTests.h"
 #include "DataPortTests.h"
 #include "CompoundElementModelTests.h"
+#include "LinearOctreeTests.h"
+#include "NavNetworkTests.h"
+#include "BinaryModelFileTests.h"
+#include "GameDataCacheTests.h"
+#include "BasicProjectileSetTests.h"
+#include "ParticleEngineTests.h"
+#include "RenderQueueTests.h"
+#include "SpaceCollisionBroadphaseTests.h"
 
 #define RUN(test) { tester.Run<test>();}
 
@@ -32,6 +40,14 @@ public:
 		tester.Run<SequenceGenerationTests>();
 		tester.Run<DataPortTests>();
 		tester.Run<CompoundElementModelTests>();
+		tester.Run<LinearOctreeTests>();
+		tester.Run<NavNetworkTests>();
+		tester.Run<BinaryModelFileTests>();
+		tester.Run<GameDataCacheTests>();
+		tester.Run<BasicProjectileSetTests>();
+		tester.Run<ParticleEngineTests>();
+		tester.Run<RenderQueueTests>();
+		tester.Run<SpaceCollisionBroadphaseTests>();
 			
 
 
@@ -0,0 +1,222 @@
+#include "Utility.h"
+
+#include "WorkerThreadPool.h"
+
+// The pool and queue index owned by the current thread, if it is a pool worker
+static thread_local const WorkerThreadPool * t_worker_pool = NULL;
+static thread_local unsigned int t_worker_index = 0U;
+
+
+// Default constructor; no threads are created until the pool is initialised
+WorkerThreadPool::WorkerThreadPool(void)
+	:
+	m_queued_jobs(0), m_shutdown(false)
+{
+	// The shared queue is always available, so that jobs can be submitted and executed inline without any workers
+	InitialiseQueues(0U);
+}
+
+// Creates the worker threads
+void WorkerThreadPool::Initialise(unsigned int worker_count)
+{
+	// Make sure any existing threads are terminated first
+	Shutdown();
+
+	if (worker_count == 0U)
+	{
+		unsigned int hw = std::thread::hardware_concurrency();
+		worker_count = (hw > 1U ? (hw - 1U) : 0U);
+	}
+
+	InitialiseQueues(worker_count);
+
+	m_shutdown = false;
+	m_threads.reserve(worker_count);
+	for (unsigned int i = 0U; i < worker_count; ++i)
+	{
+		m_threads.push_back(std::thread(&WorkerThreadPool::WorkerThreadMain, this, i));
+	}
+}
+
+// Terminates and joins all worker threads
+void WorkerThreadPool::Shutdown(void)
+{
+	if (m_threads.empty()) return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_shutdown = true;
+	}
+	m_work_available.notify_all();
+
+	for (std::thread & thread : m_threads)
+	{
+		if (thread.joinable()) thread.join();
+	}
+	m_threads.clear();
+
+	// Revert to the shared queue only.  No jobs should remain at this point since every submitter waits on its own work
+	InitialiseQueues(0U);
+}
+
+// Recreates the set of job queues for the given number of workers
+void WorkerThreadPool::InitialiseQueues(unsigned int worker_count)
+{
+	m_queues.clear();
+	for (unsigned int i = 0U; i <= worker_count; ++i)
+	{
+		m_queues.push_back(std::unique_ptr<JobQueue>(new JobQueue()));
+	}
+	m_queued_jobs.store(0);
+}
+
+// Returns the index of the queue owned by the calling thread; the shared queue if the caller is not a worker of this pool
+unsigned int WorkerThreadPool::GetLocalQueueIndex(void) const
+{
+	return (t_worker_pool == this ? t_worker_index : (unsigned int)(m_queues.size() - 1U));
+}
+
+// Submits a job for asynchronous execution
+void WorkerThreadPool::Submit(Job && job)
+{
+	JobQueue & queue = *(m_queues[GetLocalQueueIndex()]);
+	{
+		std::lock_guard<std::mutex> lock(queue.Lock);
+		queue.Jobs.push_back(std::move(job));
+	}
+	m_queued_jobs.fetch_add(1);
+
+	// Wake an idle worker.  The lock ensures a worker cannot miss the notification between testing for work and waiting
+	if (!m_threads.empty())
+	{
+		{ std::lock_guard<std::mutex> lock(m_mutex); }
+		m_work_available.notify_one();
+	}
+}
+
+// Attempts to remove one job from the queues, first from the local queue and then by stealing from the others
+bool WorkerThreadPool::TryAcquireJob(Job & outJob)
+{
+	if (m_queued_jobs.load() <= 0) return false;
+
+	// Take the most recently-submitted local job, since its data is most likely to still be in cache
+	unsigned int n = (unsigned int)m_queues.size();
+	unsigned int local = GetLocalQueueIndex();
+	{
+		JobQueue & queue = *(m_queues[local]);
+		std::lock_guard<std::mutex> lock(queue.Lock);
+		if (!queue.Jobs.empty())
+		{
+			outJob = std::move(queue.Jobs.back());
+			queue.Jobs.pop_back();
+			m_queued_jobs.fetch_sub(1);
+			return true;
+		}
+	}
+
+	// Otherwise steal the oldest job from another queue, starting from our neighbour to spread contention
+	for (unsigned int i = 1U; i < n; ++i)
+	{
+		JobQueue & queue = *(m_queues[(local + i) % n]);
+		std::lock_guard<std::mutex> lock(queue.Lock);
+		if (!queue.Jobs.empty())
+		{
+			outJob = std::move(queue.Jobs.front());
+			queue.Jobs.pop_front();
+			m_queued_jobs.fetch_sub(1);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+// Attempts to acquire and execute one outstanding job
+bool WorkerThreadPool::TryExecuteJob(void)
+{
+	Job job;
+	if (!TryAcquireJob(job)) return false;
+
+	job();
+	return true;
+}
+
+// Executes outstanding jobs until the given counter reaches zero
+void WorkerThreadPool::WaitForCompletion(const std::atomic<int> & counter)
+{
+	while (counter.load() > 0)
+	{
+		// Help with any outstanding work.  If there is none then the remaining jobs are in progress on other threads
+		if (!TryExecuteJob()) std::this_thread::yield();
+	}
+}
+
+// Executes the given function over the range [0, count), split into chunks of at most 'grain_size' elements
+void WorkerThreadPool::ParallelFor(int count, int grain_size, const RangeFunction & fn)
+{
+	if (count <= 0) return;
+	grain_size = max(grain_size, 1);
+	int chunks = ((count + grain_size - 1) / grain_size);
+
+	// Execute inline if there is nothing to gain from distributing the work
+	if (m_threads.empty() || chunks == 1)
+	{
+		fn(0, count);
+		return;
+	}
+
+	// Rather than one job per chunk, submit a small number of helper jobs which each claim chunks until none remain.
+	// This keeps the number of job allocations bounded while still balancing load across threads
+	std::atomic<int> next_chunk(0);
+	std::atomic<int> helpers_outstanding(0);
+	auto execute_chunks = [&fn, &next_chunk, count, grain_size, chunks]()
+	{
+		int chunk;
+		while ((chunk = next_chunk.fetch_add(1)) < chunks)
+		{
+			int begin = (chunk * grain_size);
+			fn(begin, min(begin + grain_size, count));
+		}
+	};
+
+	int helpers = min(chunks - 1, (int)m_threads.size());
+	helpers_outstanding.store(helpers);
+	for (int i = 0; i < helpers; ++i)
+	{
+		Submit([&execute_chunks, &helpers_outstanding]() { execute_chunks(); helpers_outstanding.fetch_sub(1); });
+	}
+
+	// The calling thread also participates, and then waits for any helper still processing a chunk
+	execute_chunks();
+	WaitForCompletion(helpers_outstanding);
+}
+
+// Entry point for each worker thread
+void WorkerThreadPool::WorkerThreadMain(unsigned int worker_index)
+{
+	t_worker_pool = this;
+	t_worker_index = worker_index;
+
+	Job job;
+	while (true)
+	{
+		// Execute work for as long as any is available
+		if (TryAcquireJob(job))
+		{
+			job();
+			job = nullptr;
+			continue;
+		}
+
+		// Otherwise wait until more work is submitted, or the pool is shut down
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_work_available.wait(lock, [this]() { return (m_shutdown || m_queued_jobs.load() > 0); });
+		if (m_shutdown) return;
+	}
+}
+
+// Default destructor
+WorkerThreadPool::~WorkerThreadPool(void)
+{
+	Shutdown();
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#ifndef __WorkerThreadPoolH__
+#define __WorkerThreadPoolH__
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include "CompilerSettings.h"
+
+
+// Fixed pool of worker threads used to execute both individual jobs and data-parallel work.  Each worker owns a job
+// queue; workers execute their own jobs in LIFO order and steal from the other queues in FIFO order when idle.  Jobs
+// submitted from outside the pool are placed on a shared queue which is available to every thread.  Any thread waiting
+// on pool work will help to execute outstanding jobs rather than blocking.  If the pool has not been initialised, or
+// has no workers, all work is executed by the waiting thread
+// Class has no special alignment requirements
+class WorkerThreadPool
+{
+public:
+
+	// Function executed for each chunk of a parallel range, accepting the half-open index range [begin, end)
+	typedef std::function<void(int begin, int end)>		RangeFunction;
+
+	// A single unit of work submitted to the pool
+	typedef std::function<void(void)>					Job;
+
+	// Default constructor; no threads are created until the pool is initialised
+	WorkerThreadPool(void);
+
+	// Creates the worker threads.  A worker count of zero will size the pool to the available hardware concurrency,
+	// less one thread to account for the caller
+	void									Initialise(unsigned int worker_count = 0U);
+
+	// Terminates and joins all worker threads
+	void									Shutdown(void);
+
+	// Returns the number of worker threads in the pool, excluding the calling thread
+	CMPINLINE unsigned int					GetWorkerCount(void) const			{ return (unsigned int)m_threads.size(); }
+
+	// Submits a job for asynchronous execution.  Jobs submitted from a worker are pushed to that worker's own queue,
+	// otherwise they are pushed to the shared queue.  The caller is responsible for tracking completion, and must
+	// not rely on the job being executed unless it subsequently waits via WaitForCompletion() or TryExecuteJob()
+	void									Submit(Job && job);
+
+	// Attempts to acquire and execute one outstanding job, preferring the calling thread's own queue and otherwise
+	// stealing from another.  Returns a flag indicating whether any job was executed
+	bool									TryExecuteJob(void);
+
+	// Executes outstanding jobs until the given counter reaches zero.  Used to wait on a set of submitted jobs that
+	// each decrement the counter upon completion
+	void									WaitForCompletion(const std::atomic<int> & counter);
+
+	// Executes the given function over the range [0, count), split into chunks of at most 'grain_size' elements.  Blocks
+	// until all chunks have completed.  Chunks may execute in any order and on any thread, so the function must only
+	// write to data owned by its own index range.  May be called from within a pool job
+	void									ParallelFor(int count, int grain_size, const RangeFunction & fn);
+
+	// Default destructor
+	~WorkerThreadPool(void);
+
+protected:
+
+	// Queue of jobs owned by a single worker, or the shared queue for jobs submitted from outside the pool
+	// Class has no special alignment requirements
+	struct JobQueue
+	{
+		std::mutex							Lock;
+		std::deque<Job>						Jobs;
+	};
+
+	// Entry point for each worker thread
+	void									WorkerThreadMain(unsigned int worker_index);
+
+	// Returns the index of the queue owned by the calling thread; the shared queue if the caller is not a worker of this pool
+	unsigned int							GetLocalQueueIndex(void) const;
+
+	// Attempts to remove one job from the queues, first from the local queue and then by stealing from the others
+	bool									TryAcquireJob(Job & outJob);
+
+	// Recreates the set of job queues for the given number of workers
+	void									InitialiseQueues(unsigned int worker_count);
+
+protected:
+
+	std::vector<std::thread>				m_threads;
+
+	// One queue per worker, followed by the shared queue.  The set of queues is fixed while any worker is running
+	std::vector<std::unique_ptr<JobQueue>>	m_queues;
+	std::atomic<int>						m_queued_jobs;
+
+	// Synchronisation for idle workers
+	std::mutex								m_mutex;
+	std::condition_variable					m_work_available;
+	bool									m_shutdown;
+};
+
+
+#endif
@@ -449,6 +449,9 @@ void iObject::SetCollisionSphereRadius(float radius)
 
 	// Also calculate a collision sphere including margin, to catch edge cases that could potentially otherwise be missed
 	m_collisionspheremarginradius = (m_collisionsphereradius * iObject::COLLISION_SPHERE_MARGIN);
+
+	// Refresh the search data held by our spatial tree node
+	if (m_treenode) m_treenode->ItemDataChanged(this);
 }
 
 // Set a new squared collision sphere radius, recalcuating all derived fieds
@@ -459,6 +462,44 @@ void iObject::SetCollisionSphereRadiusSq(float radius_sq)
 
 	// Also calculate a collision sphere including margin, to catch edge cases that could potentially otherwise be missed
 	m_collisionspheremarginradius = (m_collisionsphereradius * iObject::COLLISION_SPHERE_MARGIN);
+
+	// Refresh the search data held by our spatial tree node
+	if (m_treenode) m_treenode->ItemDataChanged(this);
+}
+
+// Populates the data held for this object by its spatial partitioning tree node, for use in object searches.  Capital ship
+// perimeter beacons and ship sections report the position, radius and ID of their parent ship, which they stand in for
+void iObject::GetSpatialSearchData(OctreeSearchData & outData)
+{
+	// Collision filtering is always based on the properties of this object
+	outData.Flags = 0U;
+	if (m_collisionmode != Game::CollisionMode::NoCollision) SetBit(outData.Flags, OctreeSearchData::Flag::Colliding);
+	if (m_collidertype == Game::ColliderType::ActiveCollider) SetBit(outData.Flags, OctreeSearchData::Flag::ActiveCollider);
+
+	// Determine the object which will be returned by searches in place of this one
+	iObject *target = this;
+	if (m_objecttype == iObject::ObjectType::CapitalShipPerimeterBeaconObject)
+	{
+		target = ((CapitalShipPerimeterBeacon*)this)->GetParentShip();
+	}
+	else if (m_objecttype == iObject::ObjectType::ComplexShipSectionObject)
+	{
+		target = ((ComplexShipSection*)this)->GetParent();
+	}
+
+	// Items without a valid parent are never returned by searches
+	if (!target)
+	{
+		SetBit(outData.Flags, OctreeSearchData::Flag::Excluded);
+		target = this;
+	}
+
+	// Capital ships can be reached via any of their beacons and sections, so must be de-duplicated during searches
+	if (target->GetObjectType() == iObject::ObjectType::ComplexShipObject) SetBit(outData.Flags, OctreeSearchData::Flag::LargeObject);
+
+	XMStoreFloat3(&outData.Position, target->GetPosition());
+	outData.CollisionRadiusSq = target->GetCollisionSphereRadiusSq();
+	outData.SearchID = target->GetID();
 }
 
 // Set the ambient audio item for this object
@@ -330,9 +330,9 @@ public:
 	
 	// Collision detection data
 	CMPINLINE Game::CollisionMode			GetCollisionMode(void) const					{ return m_collisionmode; }	
-	CMPINLINE void							SetCollisionMode(Game::CollisionMode mode)		{ m_collisionmode = mode; }	
+	CMPINLINE void							SetCollisionMode(Game::CollisionMode mode)		{ m_collisionmode = mode; if (m_treenode) m_treenode->ItemDataChanged(this); }	
 	CMPINLINE Game::ColliderType			GetColliderType(void) const						{ return m_collidertype; }
-	CMPINLINE void							SetColliderType(Game::ColliderType type)		{ m_collidertype = type; }
+	CMPINLINE void							SetColliderType(Game::ColliderType type)		{ m_collidertype = type; if (m_treenode) m_treenode->ItemDataChanged(this); }
 
 	// We store the collision sphere data per object for runtime access efficiency, considering it only requires a few floating point values
 	float									GetCollisionSphereRadius(void) const			{ return m_collisionsphereradius; }
@@ -358,6 +358,10 @@ public:
 	CMPINLINE Octree<iObject*> *			GetSpatialTreeNode(void) const						{ return m_treenode; }
 	CMPINLINE void							SetSpatialTreeNode(Octree<iObject*> * node)			{ m_treenode = node; }
 
+	// Populates the data held for this object by its spatial partitioning tree node, for use in object searches.  Capital ship
+	// perimeter beacons and ship sections report the position, radius and ID of their parent ship, which they stand in for
+	void									GetSpatialSearchData(OctreeSearchData & outData);
+
 	// Returns the disposition of this object towards the target object, based on our respective factions and 
 	// any other modifiers (e.g. if the objects have individually attacked each other)
 	Faction::FactionDisposition				GetDispositionTowardsObject(const iObject *obj) const;
@@ -33,6 +33,7 @@
 #include "DynamicTerrain.h"
 #include "DynamicTerrainDefinition.h"
 #include "DataEnabledEnvironmentObject.h"
+#include "SpaceSystem.h"
 
 #include "iSpaceObjectEnvironment.h"
 
@@ -41,7 +42,10 @@
 const iSpaceObjectEnvironment::DeckInfo iSpaceObjectEnvironment::NULL_DECK = iSpaceObjectEnvironment::DeckInfo();
 
 // Initialise static working vector for environment object search; holds nodes being considered in the search
-std::vector<EnvironmentTree*> iSpaceObjectEnvironment::m_search_nodes;
+thread_local std::vector<EnvironmentTree*> iSpaceObjectEnvironment::m_search_nodes;
+
+// Environment interiors are simulated inline with each environment by default
+iSpaceObjectEnvironment::InteriorSimulationMode iSpaceObjectEnvironment::m_interior_simulation_mode = iSpaceObjectEnvironment::InteriorSimulationMode::Serial;
 SimulatedEnvironmentCollision iSpaceObjectEnvironment::EnvironmentCollisionSimulationResults;;
 
 // Default constructor
@@ -61,6 +65,7 @@ iSpaceObjectEnvironment::iSpaceObjectEnvironment(void)
 	SetElementSize(NULL_INTVECTOR3);
 	m_updatesuspended = false;
 	m_containssimulationhubs = false;
+	m_deferred_effects = NULL;
 	m_navnetwork = NULL;
 	SpatialPartitioningTree = NULL;
 	m_zeropointtranslation = NULL_VECTOR;
@@ -109,6 +114,22 @@ void iSpaceObjectEnvironment::InitialiseCopiedObject(iSpaceObjectEnvironment *so
 // Standard object simulation method, used to simulate the contents of this object environment
 void iSpaceObjectEnvironment::SimulateObject(void)
 {
+	// In parallel mode, hand the interior simulation to our system so it can be batched with all other environments
+	if (m_interior_simulation_mode == InteriorSimulationMode::Parallel && m_spaceenvironment)
+	{
+		m_spaceenvironment->QueueEnvironmentSimulation(m_id);
+		return;
+	}
+
+	// Otherwise simulate the interior immediately
+	SimulateInterior();
+}
+
+// Simulates the environment interior; tiles, gravity, power, oxygen and environment collisions
+void iSpaceObjectEnvironment::SimulateInterior(DeferredCommandBuffer *deferred_effects)
+{
+	m_deferred_effects = deferred_effects;
+
 	// Simulate all ship tiles within the environment that require simulation
 	ComplexShipTile *tile;
 	iContainsComplexShipTiles::ComplexShipTileCollection::iterator t_it_end = m_tiles[0].end();
@@ -132,11 +153,14 @@ void iSpaceObjectEnvironment::SimulateObject(void)
 	// Properties which are updated on a periodic basis
 	if (OxygenUpdateRequired())			PerformOxygenUpdate();
 
-	// Process any active collision events
+	// Process any active collision events.  These affect the colliding objects as well as the environment, so are
+	// treated as an external effect
 	if (HaveActiveEnvironmentCollisionEvents())
 	{
-		ProcessAllEnvironmentCollisions();
+		ApplyExternalEffect([this]() { ProcessAllEnvironmentCollisions(); });
 	}
+
+	m_deferred_effects = NULL;
 }
 
 // Virtual method implementation from iObject to handle a change in simulation state.  We are guaranteed that prevstate != newstate
@@ -890,7 +914,8 @@ void iSpaceObjectEnvironment::UpdateNavigationNetwork(void)
 	// Make sure the network exists.  If it doesn't, create the network object first
 	if (!m_navnetwork) m_navnetwork = new NavNetwork();
 
-	// Initialise the nav network with data from this complex ship
+	// Initialise the nav network with data from this complex ship.  This rebuilds the hierarchical pathfinding layer, and 
+	// moves the network to a new layout version so that no path cached against the previous layout will be reused
 	m_navnetwork->InitialiseNavNetwork(this);
 
 	// TODO: Find any actors currently following a path provided by the previous network, and have them recalculate their paths
@@ -965,6 +990,7 @@ Result iSpaceObjectEnvironment::RevalidateEnvironmentMaps(void)
 	// Revalidate each map in turn.  Perform a full build if any cannot be incrementally rebuilt
 	if (!m_oxygenmap.RevalidateMap())		BuildEnvironmentOxygenMap();
 	if (!m_powermap.RevalidateMap())		BuildEnvironmentPowerMap();
+	else									UpdatePower();
 
 	// Return success
 	return ErrorCodes::NoError;
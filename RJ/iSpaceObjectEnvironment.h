@@ -17,6 +17,7 @@
 #include "EnvironmentPowerMap.h"
 #include "EnvironmentHullBreaches.h"
 #include "PortalRenderingSupport.h"
+#include "DeferredCommandBuffer.h"
 
 // Environment overlays
 #include "EnvironmentHealthOverlay.h"
@@ -139,9 +140,21 @@ public:
 	// Rebuilds the spatial partitioning tree, populating with all existing objects if relevant
 	void							BuildSpatialPartitioningTree(void);
 
-	// Standard object simulation method, used to simulate the contents of this object environment
+	// Standard object simulation method, used to simulate the contents of this object environment.  In parallel interior
+	// simulation mode the interior is not simulated here; the environment is instead queued with its space system, which 
+	// simulates all queued environments concurrently at the end of the simulation cycle
 	void							SimulateObject(void);
 
+	// Simulates the environment interior; tiles, gravity, power, oxygen and environment collisions.  If a deferred effect
+	// buffer is supplied, any effects on objects outside the environment are added to the buffer rather than being applied 
+	// immediately, so that multiple environments can be simulated concurrently
+	void							SimulateInterior(DeferredCommandBuffer *deferred_effects = NULL);
+
+	// Determines whether environment interiors are simulated inline with each environment, or concurrently in a per-system batch
+	enum InteriorSimulationMode { Serial = 0, Parallel };
+	CMPINLINE static InteriorSimulationMode	GetInteriorSimulationMode(void)							{ return m_interior_simulation_mode; }
+	CMPINLINE static void					SetInteriorSimulationMode(InteriorSimulationMode mode)	{ m_interior_simulation_mode = mode; }
+
 	// Perform the post-simulation update.  Pure virtual inherited from iObject base class
 	void							PerformPostSimulationUpdate(void);
 
@@ -671,6 +684,20 @@ protected:
 	// Indicates whether there are any collision events currently taking place in the environment
 	CMPINLINE bool					HaveActiveEnvironmentCollisionEvents(void) const		{ return !m_collision_events.empty(); }
 
+	// Applies an effect which may modify objects outside of this environment.  The effect is executed immediately unless
+	// the interior is being simulated concurrently, in which case it is deferred until all environments have completed
+	CMPINLINE void					ApplyExternalEffect(DeferredCommandBuffer::Command && effect)
+	{
+		if (m_deferred_effects)		m_deferred_effects->Defer(std::move(effect));
+		else						effect();
+	}
+
+	// Buffer receiving external effects during concurrent interior simulation; NULL at all other times
+	DeferredCommandBuffer *			m_deferred_effects;
+
+	// Mode used for all environment interior simulation
+	static InteriorSimulationMode	m_interior_simulation_mode;
+
 	// Updates a tile following a change to its connection state, i.e. where it now connects to new or fewer
 	// neighbouring tiles.  Accepts the address of a tile pointer and will adjust that tile pointer if
 	// the tile is updated as part of the analysis.  TODO: May wish to replace with more general methods in future
@@ -730,8 +757,9 @@ protected:
 	// Recursively builds each node of the OBB that matches the supplied hierarchical region structure
 	void								BuildOBBNodeFromRegionData(OrientedBoundingBox & obb, const EnvironmentOBBRegion & region);
 
-	// Static working vector for environment object search; holds nodes being considered in the search
-	static std::vector<EnvironmentTree*>		m_search_nodes;
+	// Static working vector for environment object search; holds nodes being considered in the search.  Per-thread since
+	// environments may be simulated concurrently
+	static thread_local std::vector<EnvironmentTree*>		m_search_nodes;
 	
 };
 
@@ -10,8 +10,13 @@ namespace fs = std::filesystem;
 // Initialise static variables
 const std::string ResourceBuilder::DEFAULT_MODEL_PIPELINE_CONFIG = "./ResourceBuilderDefaultModelPipelineConfig.txt";
 const std::string ResourceBuilder::MODEL_PIPELINE_CONFIG = "./ModelBuilderConfig.txt";
+const std::string ResourceBuilder::MODEL_PIPELINE_MANIFEST = "./ModelBuilderManifest.txt";
+const std::string ResourceBuilder::MODEL_PIPELINE_SUMMARY = "./ModelBuilderSummary.txt";
+const std::string ResourceBuilder::MODEL_PIPELINE_CACHE = "./ModelBuilderCache.txt";
 
 const std::string ResourceBuilder::ARG_LOG = "log:";
+const std::string ResourceBuilder::ARG_THREADS = "threads:";
+const std::string ResourceBuilder::ARG_REBUILD = "rebuild";
 
 // Entry point
 int main(int argc, const char **argv)
@@ -39,6 +44,14 @@ int main(int argc, const char **argv)
 			{
 				resource_builder.SetLogging(arg);
 			}
+			else if (arg.substr(0U, ResourceBuilder::ARG_THREADS.size()) == ResourceBuilder::ARG_THREADS)
+			{
+				resource_builder.SetThreadCount(arg);
+			}
+			else if (arg == ResourceBuilder::ARG_REBUILD)
+			{
+				resource_builder.SetFullRebuild(true);
+			}
 
 		}
 	}
@@ -52,7 +65,9 @@ int main(int argc, const char **argv)
 
 ResourceBuilder::ResourceBuilder(void)
 	:
-	m_logging("normal")
+	m_logging("normal"), 
+	m_threads(0U), 
+	m_rebuild(false)
 {
 }
 
@@ -112,15 +127,29 @@ void ResourceBuilder::ExecuteModelPipeline(void)
 
 	std::cout << "Found " << files.size() << " input files for model pipeline\n";
 
-	// Build input configuration for the model pipeline
-	std::ostringstream str;
-	str << "-args \"" << DEFAULT_MODEL_PIPELINE_CONFIG << "\"";
-	if (m_logging != "normal") str << " -log " << m_logging;
+	// Input files are passed to the model pipeline via a manifest, so that they can be transformed as a single parallel batch
+	std::ostringstream manifest;
 	for (auto & file : files)
 	{
-		str << " " << "-i \"" << fs::absolute(file).string() << "\"";
+		manifest << fs::absolute(file).string() << "\n";
 	}
 
+	fs::path manifest_path(fs::absolute(fs::path(MODEL_PIPELINE_MANIFEST)));
+	ResourceBuilderUtil::WriteDataTofile(manifest_path, manifest.str());
+	std::cout << "Model pipeline manifest generated (" << manifest_path.string() << ")\n";
+
+	// Build input configuration for the model pipeline.  Models which are unchanged since the last build are skipped via the build cache
+	fs::path summary_path(fs::absolute(fs::path(MODEL_PIPELINE_SUMMARY)));
+	fs::path cache_path(fs::absolute(fs::path(MODEL_PIPELINE_CACHE)));
+	std::ostringstream str;
+	str << "-args \"" << DEFAULT_MODEL_PIPELINE_CONFIG << "\"";
+	if (m_logging != "normal") str << " -log " << m_logging;
+	str << " -threads " << m_threads;
+	str << " -manifest \"" << manifest_path.string() << "\"";
+	str << " -summary \"" << summary_path.string() << "\"";
+	str << " -cache \"" << cache_path.string() << "\"";
+	if (m_rebuild) str << " -rebuild true";
+
 	// Save configuration to file
 	fs::path config_path(fs::absolute(fs::path(MODEL_PIPELINE_CONFIG)));
 	ResourceBuilderUtil::WriteDataTofile(config_path, str.str());
@@ -136,7 +165,7 @@ void ResourceBuilder::ExecuteModelPipeline(void)
 	system(commandline.c_str());
 	
 	// Return success
-	std::cout << "\nModel pipeline execution completed\n";
+	std::cout << "\nModel pipeline execution completed; full results are available in \"" << summary_path.string() << "\"\n";
 	return;
 }
 
@@ -157,8 +186,10 @@ void ResourceBuilder::GenerateDefaultConfiguration(fs::path path)
 		<< "-op fix-invalid "
 		<< "-op fix-inward-norm "
 		<< "-op improve-cache-local "
+		<< "-op optimise-overdraw "
 		<< "-op remove-degen "
-		<< "-op minimise-mats";
+		<< "-op minimise-mats "
+		<< "-lods 3";
 
 	ResourceBuilderUtil::WriteDataTofile(path, str.str());
 }
@@ -182,6 +213,22 @@ void ResourceBuilder::SetLogging(const std::string & log_arg)
 	std::cout << "Setting logging level to \"" << m_logging << "\"\n";
 }
 
+void ResourceBuilder::SetThreadCount(const std::string & threads_arg)
+{
+	std::string val = ResourceBuilderUtil::StringReplace(threads_arg, ResourceBuilder::ARG_THREADS, "");
+	int threads = std::atoi(val.c_str());
+	m_threads = (unsigned int)(threads > 0 ? threads : 0);
+
+	if (m_threads == 0U)	std::cout << "Model pipeline will use one thread per hardware thread\n";
+	else					std::cout << "Setting model pipeline thread count to " << m_threads << "\n";
+}
+
+void ResourceBuilder::SetFullRebuild(bool rebuild)
+{
+	m_rebuild = rebuild;
+	if (m_rebuild) std::cout << "Performing full rebuild; all cached build outputs will be ignored\n";
+}
+
 unsigned int ResourceBuilder::GetBuildStage(const std::string & stage_name)
 {
 	static const std::vector<std::tuple<std::string, ResourceBuilder::BuildStage>> build_stages =
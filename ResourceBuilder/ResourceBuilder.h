@@ -9,8 +9,13 @@ public:
 
 	static const std::string DEFAULT_MODEL_PIPELINE_CONFIG;
 	static const std::string MODEL_PIPELINE_CONFIG;
+	static const std::string MODEL_PIPELINE_MANIFEST;
+	static const std::string MODEL_PIPELINE_SUMMARY;
+	static const std::string MODEL_PIPELINE_CACHE;
 
 	static const std::string ARG_LOG;
+	static const std::string ARG_THREADS;
+	static const std::string ARG_REBUILD;
 
 	enum BuildStage
 	{
@@ -24,6 +29,8 @@ public:
 	void									Execute(unsigned int build_stages = 0U);
 
 	void									SetLogging(const std::string & log_arg);
+	void									SetThreadCount(const std::string & threads_arg);
+	void									SetFullRebuild(bool rebuild);
 
 	static unsigned int						GetBuildStage(const std::string & stage_name);
 	static bool								BuildStageActive(ResourceBuilder::BuildStage stage, unsigned int stage_config);
@@ -37,6 +44,8 @@ private:
 private:
 
 	std::string								m_logging;
+	unsigned int							m_threads;			// Concurrent model transforms; zero uses one per hardware thread
+	bool									m_rebuild;			// Ignores the build cache and rebuilds every model
 
 
 };
\ No newline at end of file